@@ -0,0 +1,281 @@
+#include "autotuner.hpp"
+#include "optimization_engine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+std::string ProfileKey(const std::string& kernel) {
+  return "autotune." + kernel;
+}
+
+TuningPoint PointAt(const TunableKernel& kernel, const std::vector<size_t>& index) {
+  TuningPoint point;
+  for (size_t d = 0; d < kernel.parameters.size(); ++d) {
+    point[kernel.parameters[d].name] = kernel.parameters[d].values[index[d]];
+  }
+  return point;
+}
+
+/**
+ * @brief Индексы сетки по оси: 0, stride, 2*stride, ... и последний
+ */
+std::vector<size_t> GridAxis(size_t count, size_t stride) {
+  std::vector<size_t> axis;
+  for (size_t i = 0; i < count; i += stride) {
+    axis.push_back(i);
+  }
+  if (axis.back() != count - 1) {
+    axis.push_back(count - 1);
+  }
+  return axis;
+}
+
+}  // namespace
+
+// ============================================================================
+// TunableParameter
+// ============================================================================
+
+TunableParameter TunableParameter::Range(const std::string& name, int64_t min, int64_t max,
+                                         int64_t step) {
+  TunableParameter parameter{name, {}};
+  for (int64_t value = min; value <= max; value += std::max<int64_t>(step, 1)) {
+    parameter.values.push_back(value);
+  }
+  return parameter;
+}
+
+TunableParameter TunableParameter::PowersOfTwo(const std::string& name, int64_t min,
+                                               int64_t max) {
+  TunableParameter parameter{name, {}};
+  for (int64_t value = 1; value <= max; value *= 2) {
+    if (value >= min) {
+      parameter.values.push_back(value);
+    }
+  }
+  return parameter;
+}
+
+// ============================================================================
+// Autotuner
+// ============================================================================
+
+Autotuner::Autotuner(const AutotuneConfig& config) : config_(config) {
+  config_.repetitions = std::max<size_t>(config_.repetitions, 1);
+  config_.grid_stride = std::max<size_t>(config_.grid_stride, 1);
+}
+
+TrialStats Autotuner::Measure(const TunableKernel& kernel, const TuningPoint& point) const {
+  for (size_t i = 0; i < config_.warmup; ++i) {
+    kernel.run(point);
+  }
+
+  std::vector<double> seconds;
+  double work = 0.0;
+  for (size_t i = 0; i < config_.repetitions; ++i) {
+    auto started = std::chrono::steady_clock::now();
+    work = kernel.run(point);
+    seconds.push_back(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+  }
+  std::sort(seconds.begin(), seconds.end());
+
+  TrialStats stats;
+  stats.point = point;
+  size_t middle = seconds.size() / 2;
+  stats.median_seconds = seconds.size() % 2 ? seconds[middle]
+                                            : 0.5 * (seconds[middle - 1] + seconds[middle]);
+  stats.min_seconds = seconds.front();
+  double mean = 0.0;
+  for (double value : seconds) {
+    mean += value / seconds.size();
+  }
+  for (double value : seconds) {
+    stats.stddev_seconds += (value - mean) * (value - mean) / seconds.size();
+  }
+  stats.stddev_seconds = std::sqrt(stats.stddev_seconds);
+  stats.throughput = stats.median_seconds > 0.0 ? work / stats.median_seconds : 0.0;
+  return stats;
+}
+
+AutotuneResult Autotuner::Tune(const TunableKernel& kernel, const TuningPoint* baseline) const {
+  if (kernel.parameters.empty()) {
+    throw std::invalid_argument("Kernel " + kernel.name + " has no tunable parameters");
+  }
+  for (const auto& parameter : kernel.parameters) {
+    if (parameter.values.empty()) {
+      throw std::invalid_argument("Parameter " + parameter.name + " has no values");
+    }
+  }
+
+  AutotuneResult result;
+  result.kernel = kernel.name;
+  std::set<TuningPoint> measured;
+  bool have_best = false;
+  std::vector<size_t> best_index;
+
+  // Измерение точки, если она допустима, новая и бюджет не исчерпан
+  auto evaluate = [&](const std::vector<size_t>& index) {
+    TuningPoint point = PointAt(kernel, index);
+    if (measured.count(point) || measured.size() >= config_.max_evaluations ||
+        (kernel.valid && !kernel.valid(point))) {
+      return false;
+    }
+    measured.insert(point);
+    result.trials.push_back(Measure(kernel, point));
+    if (!have_best || result.trials.back().throughput > result.best_stats.throughput) {
+      result.best_stats = result.trials.back();
+      best_index = index;
+      have_best = true;
+      return true;
+    }
+    return false;
+  };
+
+  // Сетка: декартово произведение прореженных осей
+  const size_t dims = kernel.parameters.size();
+  std::vector<std::vector<size_t>> axes;
+  for (const auto& parameter : kernel.parameters) {
+    axes.push_back(GridAxis(parameter.values.size(), config_.grid_stride));
+  }
+  std::vector<size_t> cursor(dims, 0);
+  while (true) {
+    std::vector<size_t> index(dims);
+    for (size_t d = 0; d < dims; ++d) {
+      index[d] = axes[d][cursor[d]];
+    }
+    evaluate(index);
+    size_t d = 0;
+    while (d < dims && ++cursor[d] == axes[d].size()) {
+      cursor[d++] = 0;
+    }
+    if (d == dims) {
+      break;
+    }
+  }
+  result.grid_evaluations = result.trials.size();
+  if (!have_best) {
+    throw std::invalid_argument("Kernel " + kernel.name + " has no valid grid point");
+  }
+
+  // Уточнение: лучший сосед по каждой оси, пока есть улучшение
+  if (config_.refine) {
+    bool improved = true;
+    while (improved && measured.size() < config_.max_evaluations) {
+      improved = false;
+      std::vector<size_t> center = best_index;
+      for (size_t d = 0; d < dims; ++d) {
+        for (int step : {-1, 1}) {
+          if ((step < 0 && center[d] == 0) ||
+              (step > 0 && center[d] + 1 >= kernel.parameters[d].values.size())) {
+            continue;
+          }
+          std::vector<size_t> neighbor = center;
+          neighbor[d] += step;
+          improved = evaluate(neighbor) || improved;
+        }
+      }
+    }
+  }
+  result.refine_evaluations = result.trials.size() - result.grid_evaluations;
+
+  if (baseline != nullptr) {
+    result.baseline_stats = Measure(kernel, *baseline);
+    if (result.baseline_stats.throughput > result.best_stats.throughput) {
+      result.best_stats = result.baseline_stats;
+    }
+  }
+  result.best = result.best_stats.point;
+  return result;
+}
+
+void Autotuner::StoreInProfile(const AutotuneResult& result, const std::string& cache_signature,
+                               MachineProfile& profile) {
+  boost::property_tree::ptree section;
+  section.put("cache_signature", cache_signature);
+  for (const auto& entry : result.best) {
+    section.put("params." + entry.first, entry.second);
+  }
+  section.put("throughput", result.best_stats.throughput);
+  section.put("median_seconds", result.best_stats.median_seconds);
+  section.put("stddev_seconds", result.best_stats.stddev_seconds);
+  section.put("baseline_throughput", result.baseline_stats.throughput);
+  section.put("evaluations", result.trials.size());
+  profile.Data().put_child(ProfileKey(result.kernel), section);
+}
+
+bool Autotuner::LoadFromProfile(const MachineProfile& profile, const std::string& kernel,
+                                const std::string& cache_signature, TuningPoint* point) {
+  auto section = profile.Data().get_child_optional(ProfileKey(kernel));
+  if (!section || section->get<std::string>("cache_signature", "") != cache_signature) {
+    return false;
+  }
+  auto params = section->get_child_optional("params");
+  if (!params || params->empty()) {
+    return false;
+  }
+  point->clear();
+  for (const auto& entry : *params) {
+    (*point)[entry.first] = entry.second.get_value<int64_t>(0);
+  }
+  return true;
+}
+
+// ============================================================================
+// Ядра OptimizationEngine
+// ============================================================================
+
+TunableKernel MakeGemmKernel(OptimizationEngine& engine, size_t n) {
+  n = std::max<size_t>(n, 1);
+  auto a = std::make_shared<std::vector<double>>(n * n, 1.0);
+  auto b = std::make_shared<std::vector<double>>(n * n, 0.5);
+  auto c = std::make_shared<std::vector<double>>(n * n, 0.0);
+  int64_t limit = std::max<int64_t>(static_cast<int64_t>(n), 8);
+
+  TunableKernel kernel;
+  kernel.name = "gemm";
+  kernel.parameters = {TunableParameter::PowersOfTwo("block_m", 8, std::min<int64_t>(limit, 512)),
+                       TunableParameter::PowersOfTwo("block_k", 32, std::max<int64_t>(limit, 32)),
+                       TunableParameter::PowersOfTwo("block_n", 32, std::max<int64_t>(limit, 32))};
+  kernel.run = [&engine, a, b, c, n](const TuningPoint& point) {
+    GemmBlocking blocking;
+    blocking.block_m = static_cast<size_t>(point.at("block_m"));
+    blocking.block_k = static_cast<size_t>(point.at("block_k"));
+    blocking.block_n = static_cast<size_t>(point.at("block_n"));
+    engine.SetGemmBlocking(blocking);
+    engine.MatrixMultiply_AVX2(a->data(), b->data(), c->data(), n, n, n);
+    return 2.0 * n * n * n;   // flop
+  };
+  return kernel;
+}
+
+TunableKernel MakeReductionKernel(OptimizationEngine& engine, size_t size, size_t max_threads) {
+  size = std::max<size_t>(size, 1);
+  auto data = std::make_shared<std::vector<double>>(size, 1.0);
+
+  TunableKernel kernel;
+  kernel.name = "reduction";
+  kernel.parameters = {
+      TunableParameter::Range("threads", 1, static_cast<int64_t>(std::max<size_t>(max_threads, 1)),
+                              1),
+      TunableParameter::PowersOfTwo("chunk", 1 << 12, 1 << 22)};
+  kernel.run = [&engine, data](const TuningPoint& point) {
+    ReductionParallelism parallelism;
+    parallelism.threads = static_cast<size_t>(point.at("threads"));
+    parallelism.chunk = static_cast<size_t>(point.at("chunk"));
+    engine.SetReductionParallelism(parallelism);
+    volatile double sum = engine.ParallelSum(data->data(), data->size());
+    (void)sum;
+    return static_cast<double>(data->size() * sizeof(double));   // байты
+  };
+  return kernel;
+}
+
+}  // namespace hardware_analysis
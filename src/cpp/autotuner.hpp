@@ -0,0 +1,143 @@
+#ifndef AUTOTUNER_HPP
+#define AUTOTUNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "machine_profile.hpp"
+
+namespace hardware_analysis {
+
+class OptimizationEngine;
+
+/**
+ * @brief Настраиваемый параметр ядра и его допустимые значения (по возрастанию)
+ */
+struct TunableParameter {
+  std::string name;
+  std::vector<int64_t> values;
+
+  /**
+   * @brief min, min + step, ... <= max
+   */
+  static TunableParameter Range(const std::string& name, int64_t min, int64_t max, int64_t step);
+
+  /**
+   * @brief Степени двойки в [min, max]
+   */
+  static TunableParameter PowersOfTwo(const std::string& name, int64_t min, int64_t max);
+};
+
+/**
+ * @brief Точка пространства параметров: имя -> значение
+ */
+using TuningPoint = std::map<std::string, int64_t>;
+
+/**
+ * @brief Ядро для настройки
+ *
+ * run выполняет один проход с параметрами point и возвращает объём работы
+ * (байты, flop - любые единицы, одинаковые для всех точек); время
+ * измеряет Autotuner.
+ */
+struct TunableKernel {
+  std::string name;
+  std::vector<TunableParameter> parameters;
+  std::function<double(const TuningPoint& point)> run;
+  std::function<bool(const TuningPoint& point)> valid;   // Ограничения; пусто - все точки
+};
+
+/**
+ * @brief Параметры поиска
+ */
+struct AutotuneConfig {
+  size_t warmup = 1;               // Прогоны без измерения перед каждой точкой
+  size_t repetitions = 5;          // Измеряемые прогоны, сравнивается медиана
+  size_t grid_stride = 2;          // Сетка: каждое grid_stride-е значение параметра
+  size_t max_evaluations = 256;    // Бюджет точек (сетка + уточнение)
+  bool refine = true;              // Локальное уточнение от лучшей точки сетки
+};
+
+/**
+ * @brief Статистика повторов одной точки
+ */
+struct TrialStats {
+  TuningPoint point;
+  double median_seconds = 0.0;
+  double min_seconds = 0.0;
+  double stddev_seconds = 0.0;
+  double throughput = 0.0;         // Работа / медианное время
+};
+
+struct AutotuneResult {
+  std::string kernel;
+  TuningPoint best;
+  TrialStats best_stats;
+  TrialStats baseline_stats;       // Точка по умолчанию (если задана)
+  std::vector<TrialStats> trials;  // В порядке измерения
+  size_t grid_evaluations = 0;
+  size_t refine_evaluations = 0;
+};
+
+/**
+ * @brief Автонастройка ядер: сетка, затем покоординатный спуск
+ *
+ * Сетка берёт каждое grid_stride-е значение каждого параметра (и последнее).
+ * Уточнение от лучшей точки пробует соседние значения по каждой оси в
+ * полном списке и переходит к лучшему соседу, пока есть улучшение. Уже
+ * измеренные точки не повторяются.
+ *
+ * В профиле результат хранится под autotune.<ядро> вместе с сигнатурой
+ * кэшей: настройка с другой иерархией кэшей (другой SKU той же модели,
+ * ВМ) не загружается.
+ */
+class Autotuner {
+ public:
+  explicit Autotuner(const AutotuneConfig& config = {});
+
+  /**
+   * @param baseline Точка по умолчанию для сравнения (nullptr - без неё)
+   * @throws std::invalid_argument если у параметра нет значений или нет допустимых точек
+   */
+  AutotuneResult Tune(const TunableKernel& kernel, const TuningPoint* baseline = nullptr) const;
+
+  /**
+   * @brief Измерение одной точки (warmup + repetitions)
+   */
+  TrialStats Measure(const TunableKernel& kernel, const TuningPoint& point) const;
+
+  static void StoreInProfile(const AutotuneResult& result, const std::string& cache_signature,
+                             MachineProfile& profile);
+
+  /**
+   * @brief Настроенные параметры ядра
+   * @return false если ядро не настраивалось или сигнатура кэшей другая
+   */
+  static bool LoadFromProfile(const MachineProfile& profile, const std::string& kernel,
+                              const std::string& cache_signature, TuningPoint* point);
+
+ private:
+  AutotuneConfig config_;
+};
+
+// ============================================================================
+// Ядра OptimizationEngine
+// ============================================================================
+
+/**
+ * @brief GEMM n x n x n: block_m, block_k, block_n
+ */
+TunableKernel MakeGemmKernel(OptimizationEngine& engine, size_t n);
+
+/**
+ * @brief ParallelSum по size элементам: threads, chunk
+ */
+TunableKernel MakeReductionKernel(OptimizationEngine& engine, size_t size, size_t max_threads);
+
+}  // namespace hardware_analysis
+
+#endif  // AUTOTUNER_HPP
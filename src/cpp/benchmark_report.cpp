@@ -0,0 +1,170 @@
+#include "benchmark_report.hpp"
+#include "cache_topology.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace hardware_analysis {
+
+DistributionSummary DistributionSummary::FromSamples(std::vector<double> values) {
+  DistributionSummary summary;
+  if (values.empty()) {
+    return summary;
+  }
+
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (double value : values) {
+    sum += value;
+  }
+
+  summary.count = values.size();
+  summary.min = values.front();
+  summary.p50 = Quantile(values, 0.50);
+  summary.p90 = Quantile(values, 0.90);
+  summary.p99 = Quantile(values, 0.99);
+  summary.max = values.back();
+  summary.mean = sum / values.size();
+  return summary;
+}
+
+double DistributionSummary::Quantile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  double position = std::max(0.0, std::min(1.0, q)) * (sorted.size() - 1);
+  size_t lower = static_cast<size_t>(position);
+  size_t upper = std::min(lower + 1, sorted.size() - 1);
+  double fraction = position - lower;
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * fraction;
+}
+
+void DistributionSummary::Store(boost::property_tree::ptree& tree) const {
+  tree.put("count", count);
+  tree.put("min", min);
+  tree.put("p50", p50);
+  tree.put("p90", p90);
+  tree.put("p99", p99);
+  tree.put("max", max);
+  tree.put("mean", mean);
+}
+
+DistributionSummary DistributionSummary::Load(const boost::property_tree::ptree& tree) {
+  DistributionSummary summary;
+  summary.count = tree.get<size_t>("count", 0);
+  summary.min = tree.get<double>("min", 0.0);
+  summary.p50 = tree.get<double>("p50", 0.0);
+  summary.p90 = tree.get<double>("p90", 0.0);
+  summary.p99 = tree.get<double>("p99", 0.0);
+  summary.max = tree.get<double>("max", 0.0);
+  summary.mean = tree.get<double>("mean", 0.0);
+  return summary;
+}
+
+std::string DistributionSummary::Format(int precision) const {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(precision)
+      << p50 << '/' << p90 << '/' << p99 << '/' << max;
+  return out.str();
+}
+
+// ============================================================================
+// JSON отчёт
+// ============================================================================
+
+std::string JsonString(const std::string& value) {
+  std::ostringstream out;
+  out << '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+  return out.str();
+}
+
+std::string JsonNumber(double value) {
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  std::ostringstream out;
+  out << std::setprecision(10) << value;
+  return out.str();
+}
+
+void WriteBenchmarkJson(std::ostream& out, const std::vector<BenchmarkRecord>& records,
+                        const CacheTopology& caches, const std::string& executable) {
+  char date[64] = "";
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+  char host[256] = "";
+  gethostname(host, sizeof(host) - 1);
+
+  out << "{\n  \"context\": {\n"
+      << "    \"date\": " << JsonString(date) << ",\n"
+      << "    \"host_name\": " << JsonString(host) << ",\n"
+      << "    \"executable\": " << JsonString(executable) << ",\n"
+      << "    \"num_cpus\": " << std::max(1u, std::thread::hardware_concurrency()) << ",\n"
+      << "    \"caches\": [";
+  // Как в Google Benchmark: кэши, видимые cpu0
+  bool first = true;
+  for (const CacheInfo& cache : caches.caches) {
+    if (!cache.SharedWith(0)) {
+      continue;
+    }
+    const char* type = cache.type == CacheType::kData          ? "Data"
+                       : cache.type == CacheType::kInstruction ? "Instruction"
+                                                               : "Unified";
+    out << (first ? "" : ",") << "\n      {\"type\": \"" << type << "\", \"level\": "
+        << cache.level << ", \"size\": " << cache.size_bytes
+        << ", \"num_sharing\": " << cache.shared_cpus.size() << "}";
+    first = false;
+  }
+  out << (first ? "" : "\n    ") << "],\n"
+#ifdef NDEBUG
+      << "    \"library_build_type\": \"release\"\n"
+#else
+      << "    \"library_build_type\": \"debug\"\n"
+#endif
+      << "  },\n  \"benchmarks\": [";
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    const BenchmarkRecord& record = records[i];
+    out << (i ? "," : "") << "\n    {\n"
+        << "      \"name\": " << JsonString(record.name) << ",\n"
+        << "      \"run_name\": " << JsonString(record.name) << ",\n"
+        << "      \"run_type\": \"iteration\",\n"
+        << "      \"iterations\": " << record.iterations << ",\n"
+        << "      \"real_time\": " << JsonNumber(record.real_time) << ",\n"
+        << "      \"cpu_time\": " << JsonNumber(record.real_time) << ",\n"
+        << "      \"time_unit\": " << JsonString(record.time_unit);
+    for (const auto& counter : record.counters) {
+      out << ",\n      " << JsonString(counter.first) << ": " << JsonNumber(counter.second);
+    }
+    out << "\n    }";
+  }
+  out << (records.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+}  // namespace hardware_analysis
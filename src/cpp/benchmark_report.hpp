@@ -0,0 +1,95 @@
+#ifndef BENCHMARK_REPORT_HPP
+#define BENCHMARK_REPORT_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+namespace hardware_analysis {
+
+struct CacheTopology;
+
+/**
+ * @brief Распределение измерений бенчмарка (латентности, пропускные способности)
+ */
+struct DistributionSummary {
+  size_t count = 0;
+  double min = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+  double mean = 0.0;
+
+  /**
+   * @brief Сводка по выборке (копия сортируется, исходник не меняется)
+   * @param values Измерения; пустая выборка даёт count = 0
+   */
+  static DistributionSummary FromSamples(std::vector<double> values);
+
+  /**
+   * @brief Квантиль отсортированной выборки (линейная интерполяция)
+   * @param sorted Выборка по возрастанию
+   * @param q Квантиль 0..1
+   */
+  static double Quantile(const std::vector<double>& sorted, double q);
+
+  /**
+   * @brief Запись в дерево профиля: count, min, p50, p90, p99, max, mean
+   */
+  void Store(boost::property_tree::ptree& tree) const;
+
+  /**
+   * @brief Чтение из дерева профиля (отсутствующие поля = 0)
+   */
+  static DistributionSummary Load(const boost::property_tree::ptree& tree);
+
+  /**
+   * @brief Строка "p50/p90/p99/max" для консольных отчётов
+   * @param precision Знаков после запятой
+   */
+  std::string Format(int precision = 1) const;
+};
+
+/**
+ * @brief Одна строка отчёта в формате JSON Google Benchmark
+ */
+struct BenchmarkRecord {
+  std::string name;                                   // "memory/latency/ws:32768/page:4k"
+  size_t iterations = 0;
+  double real_time = 0.0;                             // На итерацию, в time_unit
+  std::string time_unit = "ns";
+  std::vector<std::pair<std::string, double>> counters;   // bytes_per_second и т.п.
+};
+
+/**
+ * @brief Отчёт, совместимый с --benchmark_format=json Google Benchmark
+ *
+ * {"context": {date, host_name, executable, num_cpus, caches[]...},
+ *  "benchmarks": [{name, run_name, run_type, iterations, real_time,
+ *  cpu_time, time_unit, <счётчики>}]} - читается tools/compare.py и
+ * загрузчиками stage6.
+ *
+ * @param caches Кэши для context.caches
+ * @param executable Имя программы для context.executable
+ */
+void WriteBenchmarkJson(std::ostream& out, const std::vector<BenchmarkRecord>& records,
+                        const CacheTopology& caches, const std::string& executable);
+
+/**
+ * @brief Строка JSON в кавычках с экранированием
+ */
+std::string JsonString(const std::string& value);
+
+/**
+ * @brief Число JSON; NaN и бесконечность - null
+ */
+std::string JsonNumber(double value);
+
+}  // namespace hardware_analysis
+
+#endif  // BENCHMARK_REPORT_HPP
@@ -0,0 +1,524 @@
+#include "cache_simulator.hpp"
+#include "cache_topology.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr uint64_t kInvalidTag = ~0ull;   // Номер строки не бывает ~0 (адрес >> 6)
+constexpr uint64_t kDirtyBit = 1ull << 63;
+constexpr unsigned kSourceShift = 60;
+constexpr uint64_t kSourceMask = 7ull << kSourceShift;      // Источник предвыборки
+constexpr uint64_t kValueMask = ~(kDirtyBit | kSourceMask);  // Метка или счётчик политики
+constexpr size_t kTagGroup = 4;           // Тегов в одном сравнении AVX2
+
+bool IsPowerOfTwo(size_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+/**
+ * @brief "48K", "2M", "1G" или число байт (0 при ошибке)
+ */
+size_t ParseSize(const std::string& text) {
+  size_t pos = 0;
+  unsigned long long value = 0;
+  try {
+    value = std::stoull(text, &pos);
+  } catch (const std::exception&) {
+    return 0;
+  }
+  if (pos + 1 < text.size()) {
+    return 0;
+  }
+  switch (pos < text.size() ? text[pos] : ' ') {
+    case 'K':
+    case 'k':
+      return value << 10;
+    case 'M':
+    case 'm':
+      return value << 20;
+    case 'G':
+    case 'g':
+      return value << 30;
+    case ' ':
+      return value;
+    default:
+      return 0;
+  }
+}
+
+std::vector<std::string> Split(const std::string& text, char separator) {
+  std::vector<std::string> fields;
+  std::stringstream stream(text);
+  std::string field;
+  while (std::getline(stream, field, separator)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+int FindTagScalar(const uint64_t* tags, size_t ways, size_t stride, uint64_t tag,
+                  int* free) {
+  *free = -1;
+  for (size_t way = 0; way < stride; ++way) {
+    if (tags[way] == tag) {
+      return static_cast<int>(way);
+    }
+    if (*free < 0 && tags[way] == kInvalidTag && way < ways) {
+      *free = static_cast<int>(way);
+    }
+  }
+  return -1;
+}
+
+__attribute__((target("avx2"))) int FindTagAvx2(const uint64_t* tags, size_t ways,
+                                                size_t stride, uint64_t tag, int* free) {
+  const __m256i needle = _mm256_set1_epi64x(static_cast<long long>(tag));
+  const __m256i invalid = _mm256_set1_epi64x(-1);
+  unsigned free_mask = 0;
+  for (size_t way = 0; way < stride; way += kTagGroup) {
+    __m256i group = _mm256_load_si256(reinterpret_cast<const __m256i*>(tags + way));
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(group, needle)));
+    if (mask != 0) {
+      *free = -1;
+      return static_cast<int>(way) + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    if (free_mask == 0) {
+      free_mask = static_cast<unsigned>(
+          _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(group, invalid))));
+      free_mask = free_mask != 0 ? static_cast<unsigned>(way) + __builtin_ctz(free_mask) + 1 : 0;
+    }
+  }
+  // Пути выравнивания (>= ways) тоже хранят ~0, но стоят после рабочих
+  *free = free_mask != 0 && free_mask - 1 < ways ? static_cast<int>(free_mask) - 1 : -1;
+  return -1;
+}
+
+/**
+ * @brief Путь с наименьшими метаданными без переходов по данным
+ *
+ * Метаданные без старших битов меньше 2^60, поэтому знаковое сравнение
+ * AVX2 годится; пути выравнивания хранят максимум и не выбираются.
+ */
+__attribute__((target("avx2"))) size_t MinWayAvx2(const uint64_t* meta, size_t stride) {
+  const __m256i value_mask = _mm256_set1_epi64x(static_cast<long long>(kValueMask));
+  __m256i best = value_mask;
+  for (size_t way = 0; way < stride; way += kTagGroup) {
+    __m256i group = _mm256_and_si256(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(meta + way)), value_mask);
+    best = _mm256_blendv_epi8(best, group, _mm256_cmpgt_epi64(best, group));
+  }
+  // Горизонтальный минимум: пары 128-битных половин, затем соседние слова
+  __m256i swapped = _mm256_permute4x64_epi64(best, 0x4E);
+  best = _mm256_blendv_epi8(best, swapped, _mm256_cmpgt_epi64(best, swapped));
+  swapped = _mm256_shuffle_epi32(best, 0x4E);
+  best = _mm256_blendv_epi8(best, swapped, _mm256_cmpgt_epi64(best, swapped));
+  for (size_t way = 0; way < stride; way += kTagGroup) {
+    __m256i group = _mm256_and_si256(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(meta + way)), value_mask);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(group, best)));
+    if (mask != 0) {
+      return way + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+  return 0;
+}
+
+bool HasAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+}  // namespace
+
+// ============================================================================
+// Политики
+// ============================================================================
+
+const char* ReplacementPolicyName(ReplacementPolicy policy) {
+  switch (policy) {
+    case ReplacementPolicy::kFifo:
+      return "fifo";
+    case ReplacementPolicy::kLfu:
+      return "lfu";
+    case ReplacementPolicy::kRandom:
+      return "random";
+    case ReplacementPolicy::kLru:
+    default:
+      return "lru";
+  }
+}
+
+ReplacementPolicy ParseReplacementPolicy(const std::string& name) {
+  for (ReplacementPolicy policy : {ReplacementPolicy::kLru, ReplacementPolicy::kFifo,
+                                   ReplacementPolicy::kLfu, ReplacementPolicy::kRandom}) {
+    if (name == ReplacementPolicyName(policy)) {
+      return policy;
+    }
+  }
+  throw std::invalid_argument("Unknown replacement policy: " + name);
+}
+
+// ============================================================================
+// SetAssociativeCache
+// ============================================================================
+
+SetAssociativeCache::SetAssociativeCache(const CacheLevelConfig& config, bool use_simd)
+    : config_(config),
+      sets_(0),
+      stride_(0),
+      sets_pow2_(false),
+      use_simd_(use_simd && HasAvx2()),
+      blocks_(nullptr, std::free),
+      clock_(0),
+      random_state_(0x9E3779B97F4A7C15ull) {
+  if (!IsPowerOfTwo(config.line_bytes)) {
+    throw std::invalid_argument(config.name + ": line size must be a power of two");
+  }
+  if (config.ways == 0 || config.size_bytes == 0 ||
+      config.size_bytes % (config.ways * config.line_bytes) != 0) {
+    throw std::invalid_argument(config.name + ": size must be a multiple of ways * line size");
+  }
+  sets_ = config.size_bytes / (config.ways * config.line_bytes);
+  sets_pow2_ = IsPowerOfTwo(sets_);
+  stride_ = (config.ways + kTagGroup - 1) / kTagGroup * kTagGroup;
+
+  size_t bytes = (sets_ * 2 * stride_ * sizeof(uint64_t) + 63) / 64 * 64;
+  blocks_.reset(static_cast<uint64_t*>(std::aligned_alloc(64, bytes)));
+  if (!blocks_) {
+    throw std::bad_alloc();
+  }
+  Reset();
+}
+
+void SetAssociativeCache::Reset() {
+  for (size_t set = 0; set < sets_; ++set) {
+    uint64_t* tags = blocks_.get() + set * 2 * stride_;
+    std::fill(tags, tags + stride_, kInvalidTag);
+    std::fill(tags + stride_, tags + stride_ + config_.ways, 0);
+    std::fill(tags + stride_ + config_.ways, tags + 2 * stride_, ~kDirtyBit);
+  }
+  clock_ = 0;
+  stats_ = CacheStats{};
+  std::fill(unused_prefetches_, unused_prefetches_ + kPrefetchSources, 0);
+}
+
+int SetAssociativeCache::FindWay(const uint64_t* tags, uint64_t tag, int* free) const {
+  return use_simd_ ? FindTagAvx2(tags, config_.ways, stride_, tag, free)
+                   : FindTagScalar(tags, config_.ways, stride_, tag, free);
+}
+
+size_t SetAssociativeCache::Victim(const uint64_t* meta) {
+  if (config_.policy == ReplacementPolicy::kRandom) {
+    // xorshift64: детерминированно между запусками
+    random_state_ ^= random_state_ << 13;
+    random_state_ ^= random_state_ >> 7;
+    random_state_ ^= random_state_ << 17;
+    return static_cast<size_t>(random_state_ % config_.ways);
+  }
+  // LRU и FIFO: наименьшая метка времени, LFU: наименьший счётчик
+  if (use_simd_) {
+    return MinWayAvx2(meta, stride_);
+  }
+  size_t victim = 0;
+  uint64_t best = std::numeric_limits<uint64_t>::max();
+  for (size_t way = 0; way < config_.ways; ++way) {
+    uint64_t value = meta[way] & kValueMask;
+    if (value < best) {
+      best = value;
+      victim = way;
+    }
+  }
+  return victim;
+}
+
+void SetAssociativeCache::Insert(uint64_t* tags, int free_way, uint64_t line,
+                                 uint64_t meta_bits) {
+  uint64_t* meta = tags + stride_;
+  size_t slot;
+  if (free_way >= 0) {
+    slot = static_cast<size_t>(free_way);
+  } else {
+    slot = Victim(meta);
+    ++stats_.evictions;
+    stats_.writebacks += meta[slot] >> 63;
+    unused_prefetches_[(meta[slot] & kSourceMask) >> kSourceShift] += 1;
+  }
+  tags[slot] = line;
+  meta[slot] = meta_bits | (config_.policy == ReplacementPolicy::kLfu ? 1 : ++clock_);
+}
+
+bool SetAssociativeCache::Access(uint64_t line, bool write, unsigned* prefetched) {
+  ++stats_.accesses;
+  uint64_t* tags = blocks_.get() + SetOf(line) * 2 * stride_;
+  uint64_t* meta = tags + stride_;
+  uint64_t dirty = write ? kDirtyBit : 0;
+  int free_way = -1;
+  int way = FindWay(tags, line, &free_way);
+  if (way >= 0) {
+    ++stats_.hits;
+    // Первое обращение к строке предвыборки снимает отметку источника
+    if (prefetched != nullptr) {
+      *prefetched = static_cast<unsigned>((meta[way] & kSourceMask) >> kSourceShift);
+    }
+    meta[way] &= ~kSourceMask;
+    if (config_.policy == ReplacementPolicy::kLru) {
+      meta[way] = (meta[way] & kDirtyBit) | ++clock_;
+    } else if (config_.policy == ReplacementPolicy::kLfu) {
+      ++meta[way];
+    }
+    meta[way] |= dirty;
+    return true;
+  }
+
+  ++stats_.misses;
+  if (prefetched != nullptr) {
+    *prefetched = 0;
+  }
+  Insert(tags, free_way, line, dirty);
+  return false;
+}
+
+bool SetAssociativeCache::Fill(uint64_t line, unsigned source) {
+  uint64_t* tags = blocks_.get() + SetOf(line) * 2 * stride_;
+  int free_way = -1;
+  if (FindWay(tags, line, &free_way) >= 0) {
+    return false;
+  }
+  Insert(tags, free_way, line, static_cast<uint64_t>(source & 7u) << kSourceShift);
+  return true;
+}
+
+bool SetAssociativeCache::Contains(uint64_t line) const {
+  int free_way = -1;
+  return FindWay(blocks_.get() + SetOf(line) * 2 * stride_, line, &free_way) >= 0;
+}
+
+// ============================================================================
+// CacheHierarchy
+// ============================================================================
+
+CacheHierarchy::CacheHierarchy(const std::vector<CacheLevelConfig>& levels, bool use_simd)
+    : line_shift_(0),
+      records_(0),
+      prefetch_sources_(1),
+      prefetch_latency_(kDefaultPrefetchLatency) {
+  if (levels.empty()) {
+    throw std::invalid_argument("Cache hierarchy needs at least one level");
+  }
+  for (const CacheLevelConfig& level : levels) {
+    if (level.line_bytes != levels.front().line_bytes) {
+      throw std::invalid_argument("All cache levels must use the same line size");
+    }
+    levels_.emplace_back(level, use_simd);
+  }
+  line_shift_ = static_cast<unsigned>(__builtin_ctzll(levels.front().line_bytes));
+}
+
+void CacheHierarchy::AddPrefetcher(std::unique_ptr<Prefetcher> prefetcher, size_t level) {
+  if (!prefetcher || level >= levels_.size()) {
+    throw std::invalid_argument("Prefetcher needs a model and an existing cache level");
+  }
+  if (PrefetcherCount() >= kMaxPrefetchers) {
+    throw std::invalid_argument("Too many prefetchers (at most " +
+                                std::to_string(kMaxPrefetchers) + ")");
+  }
+  PrefetchSource source;
+  source.model = std::move(prefetcher);
+  source.level = level;
+  prefetch_sources_.push_back(std::move(source));
+}
+
+void CacheHierarchy::Access(const TraceRecord& record) {
+  uint64_t first = record.address >> line_shift_;
+  uint64_t last = record.size > 1 ? (record.address + record.size - 1) >> line_shift_ : first;
+  if (!in_flight_.empty()) {
+    ExpireInFlight();
+  }
+  if (record.type == static_cast<uint8_t>(AccessType::kPrefetch)) {
+    for (uint64_t line = first; line <= last; ++line) {
+      Issue(0, line);
+    }
+    ++records_;
+    return;
+  }
+  bool write = record.type == static_cast<uint8_t>(AccessType::kWrite);
+  for (uint64_t line = first; line <= last; ++line) {
+    // Запись помечает строку грязной в L1; нижние уровни видят загрузку строки
+    unsigned prefetched = 0;
+    size_t hit_level = 0;
+    bool hit = levels_[0].Access(line, write, &prefetched);
+    while (!hit && ++hit_level < levels_.size()) {
+      hit = levels_[hit_level].Access(line, false, &prefetched);
+    }
+    if (prefetched != 0) {
+      Credit(prefetched, line);
+    }
+    if (prefetch_sources_.size() > 1) {
+      Train(line, record.pc, hit_level, prefetched != 0);
+    }
+  }
+  ++records_;
+}
+
+void CacheHierarchy::Train(uint64_t line, uint32_t pc, size_t hit_level, bool hit_prefetched) {
+  for (size_t source = 1; source < prefetch_sources_.size(); ++source) {
+    size_t level = prefetch_sources_[source].level;
+    if (level > hit_level) {
+      continue;   // Обращение обслужил верхний уровень
+    }
+    bool trigger = level < hit_level || hit_prefetched;
+    candidates_.clear();
+    prefetch_sources_[source].model->Observe(line, pc, trigger, candidates_);
+    for (uint64_t candidate : candidates_) {
+      Issue(source, candidate);
+    }
+  }
+}
+
+void CacheHierarchy::Issue(size_t source, uint64_t line) {
+  PrefetchSource& prefetch = prefetch_sources_[source];
+  if (!levels_[prefetch.level].Fill(line, static_cast<unsigned>(source + 1))) {
+    ++prefetch.stats.redundant;
+    return;
+  }
+  ++prefetch.stats.issued;
+  // Строка идёт сверху вниз до уровня, где она уже есть
+  for (size_t level = prefetch.level + 1; level < levels_.size(); ++level) {
+    if (!levels_[level].Fill(line, 0)) {
+      break;
+    }
+  }
+  in_flight_.emplace_back(records_, line);
+  in_flight_lines_[line] = records_;
+}
+
+void CacheHierarchy::Credit(unsigned source, uint64_t line) {
+  PrefetchStats& stats = prefetch_sources_[source - 1].stats;
+  ++stats.useful;
+  auto it = in_flight_lines_.find(line);
+  if (it != in_flight_lines_.end()) {
+    ++stats.late;
+    in_flight_lines_.erase(it);
+  }
+}
+
+void CacheHierarchy::ExpireInFlight() {
+  while (!in_flight_.empty() && in_flight_.front().first + prefetch_latency_ <= records_) {
+    auto it = in_flight_lines_.find(in_flight_.front().second);
+    if (it != in_flight_lines_.end() && it->second == in_flight_.front().first) {
+      in_flight_lines_.erase(it);
+    }
+    in_flight_.pop_front();
+  }
+}
+
+PrefetchStats CacheHierarchy::SourceStats(size_t source) const {
+  PrefetchStats stats = prefetch_sources_[source].stats;
+  stats.useless = levels_[prefetch_sources_[source].level].UnusedPrefetches(
+      static_cast<unsigned>(source + 1));
+  return stats;
+}
+
+void CacheHierarchy::Simulate(const TraceRecord* records, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (i + kLookahead < count) {
+      uint64_t line = records[i + kLookahead].address >> line_shift_;
+      // Массив L1 мал и и так лежит в кэше хоста
+      for (size_t level = 1; level < levels_.size(); ++level) {
+        levels_[level].Prefetch(line);
+      }
+    }
+    Access(records[i]);
+  }
+}
+
+void CacheHierarchy::Run(const MappedTrace& trace) {
+  Simulate(trace.begin(), trace.size());
+}
+
+void CacheHierarchy::Reset() {
+  for (SetAssociativeCache& level : levels_) {
+    level.Reset();
+  }
+  for (PrefetchSource& source : prefetch_sources_) {
+    if (source.model) {
+      source.model->Reset();
+    }
+    source.stats = PrefetchStats{};
+  }
+  in_flight_.clear();
+  in_flight_lines_.clear();
+  records_ = 0;
+}
+
+std::vector<CacheLevelConfig> CacheHierarchy::FromTopology(const CacheTopology& topology,
+                                                           ReplacementPolicy policy) {
+  std::vector<CacheLevelConfig> levels;
+  for (int level = 1; level <= topology.LastLevel(); ++level) {
+    const CacheInfo* info = nullptr;
+    for (const CacheInfo& cache : topology.caches) {
+      if (cache.level == level && cache.HoldsData() && cache.size_bytes > 0) {
+        info = &cache;
+        break;
+      }
+    }
+    if (info == nullptr) {
+      continue;
+    }
+    CacheLevelConfig config;
+    config.name = "L" + std::to_string(level);
+    config.line_bytes = info->line_bytes > 0 ? info->line_bytes : 64;
+    config.ways = info->ways > 0 ? info->ways : 8;
+    size_t sets = info->size_bytes / (config.ways * config.line_bytes);
+    if (sets == 0 || !IsPowerOfTwo(config.line_bytes)) {
+      continue;
+    }
+    // Размер, не кратный ways * line, округляется вниз до целого числа множеств
+    config.size_bytes = sets * config.ways * config.line_bytes;
+    config.policy = policy;
+    levels.push_back(config);
+  }
+  return levels;
+}
+
+std::vector<CacheLevelConfig> CacheHierarchy::ParseLevels(const std::string& spec,
+                                                          ReplacementPolicy policy,
+                                                          size_t line_bytes) {
+  std::vector<CacheLevelConfig> levels;
+  for (const std::string& item : Split(spec, ',')) {
+    std::vector<std::string> fields = Split(item, ':');
+    if (fields.size() < 2 || fields.size() > 3) {
+      throw std::invalid_argument(
+          "Invalid cache level (expected size:ways[:policy]): " + item);
+    }
+    CacheLevelConfig config;
+    config.name = "L" + std::to_string(levels.size() + 1);
+    config.size_bytes = ParseSize(fields[0]);
+    config.line_bytes = line_bytes;
+    config.policy = fields.size() > 2 ? ParseReplacementPolicy(fields[2]) : policy;
+    try {
+      config.ways = std::stoul(fields[1]);
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument("Invalid number of ways in cache level: " + item);
+    }
+    if (config.size_bytes == 0) {
+      throw std::invalid_argument("Invalid size in cache level: " + item);
+    }
+    levels.push_back(config);
+  }
+  if (levels.empty()) {
+    throw std::invalid_argument("Empty cache level list");
+  }
+  return levels;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,241 @@
+#ifndef CACHE_SIMULATOR_HPP
+#define CACHE_SIMULATOR_HPP
+
+#include "memory_trace.hpp"
+#include "prefetcher.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hardware_analysis {
+
+struct CacheTopology;
+
+/**
+ * @brief Политика замещения (как ReplacementPolicy в stage5_cache_simulator.py)
+ */
+enum class ReplacementPolicy {
+  kLru = 0,
+  kFifo,
+  kLfu,
+  kRandom
+};
+
+const char* ReplacementPolicyName(ReplacementPolicy policy);
+
+/**
+ * @brief Разбор "lru", "fifo", "lfu", "random"
+ * @throws std::invalid_argument для неизвестного имени
+ */
+ReplacementPolicy ParseReplacementPolicy(const std::string& name);
+
+struct CacheLevelConfig {
+  std::string name = "L1";
+  size_t size_bytes = 32u << 10;
+  size_t line_bytes = 64;
+  size_t ways = 8;                   // ways * line_bytes == size_bytes - полностью ассоциативный
+  ReplacementPolicy policy = ReplacementPolicy::kLru;
+};
+
+/**
+ * @brief Обращения по требованию (загрузки предвыборкой сюда не входят,
+ *        а вызванные ими вытеснения входят)
+ */
+struct CacheStats {
+  uint64_t accesses = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;            // Вытеснения валидных строк
+  uint64_t writebacks = 0;           // Из них грязных
+
+  double HitRate() const {
+    return accesses > 0 ? static_cast<double>(hits) / static_cast<double>(accesses) : 0.0;
+  }
+};
+
+/**
+ * @brief Один уровень множественно-ассоциативного кэша
+ *
+ * Все множества лежат в одном выровненном массиве: ways (с округлением до 4)
+ * тегов uint64, сразу за ними столько же слов метаданных политики (метка
+ * LRU, метка вставки FIFO или счётчик LFU, старший бит - грязная строка).
+ * Поиск - сравнение четырёх тегов одной инструкцией AVX2 без указателей и
+ * аллокаций на обращение, а метаданные множества лежат в соседних с тегами
+ * строках, так что на больших уровнях обращение стоит одного промаха
+ * хост-кэша, а не трёх. Невалидный путь хранит тег ~0: свободный путь
+ * находится тем же проходом, что и тег. Биты 60-62 метаданных - источник
+ * предвыборки, загрузившей строку и ещё не использованной.
+ */
+class SetAssociativeCache {
+ public:
+  static constexpr unsigned kPrefetchSources = 8;   // 0 - строка загружена по требованию
+
+  /**
+   * @param use_simd false - скалярное сравнение тегов (для сверки в тестах)
+   * @throws std::invalid_argument если строка не степень двойки или размер
+   *         не делится на ways * line_bytes
+   */
+  explicit SetAssociativeCache(const CacheLevelConfig& config, bool use_simd = true);
+
+  /**
+   * @brief Обращение к строке line = address / line_bytes
+   * @param prefetched Источник предвыборки при первом попадании в загруженную
+   *        ею строку, иначе 0 (nullptr - не нужен)
+   * @return true при попадании; при промахе строка загружается
+   */
+  bool Access(uint64_t line, bool write, unsigned* prefetched = nullptr);
+
+  /**
+   * @brief Загрузка строки предвыборкой из источника source без учёта обращения
+   * @return false если строка уже в кэше (состояние не меняется)
+   */
+  bool Fill(uint64_t line, unsigned source);
+
+  /**
+   * @brief Есть ли строка в кэше (без изменения состояния политики)
+   */
+  bool Contains(uint64_t line) const;
+
+  /**
+   * @brief Программная предвыборка множества строки в кэш хоста
+   */
+  void Prefetch(uint64_t line) const {
+    const uint64_t* tags = blocks_.get() + SetOf(line) * 2 * stride_;
+    __builtin_prefetch(tags);
+    __builtin_prefetch(tags + stride_);
+  }
+
+  void Reset();
+
+  const CacheLevelConfig& config() const { return config_; }
+  const CacheStats& stats() const { return stats_; }
+  uint64_t UnusedPrefetches(unsigned source) const { return unused_prefetches_[source]; }
+  size_t sets() const { return sets_; }
+  bool simd() const { return use_simd_; }
+
+ private:
+  size_t SetOf(uint64_t line) const {
+    return sets_pow2_ ? static_cast<size_t>(line & (sets_ - 1))
+                      : static_cast<size_t>(line % sets_);
+  }
+  /**
+   * @brief Путь с тегом tag или -1; *free - первый свободный путь или -1
+   */
+  int FindWay(const uint64_t* tags, uint64_t tag, int* free) const;
+  size_t Victim(const uint64_t* meta);
+  void Insert(uint64_t* tags, int free_way, uint64_t line, uint64_t meta_bits);
+
+  CacheLevelConfig config_;
+  size_t sets_;
+  size_t stride_;                    // ways, округлённое до 4
+  bool sets_pow2_;                   // Иначе индекс множества - остаток (L3 105M/15)
+  bool use_simd_;
+  std::unique_ptr<uint64_t[], void (*)(void*)> blocks_;   // [множество][теги | метаданные]
+  uint64_t clock_;
+  uint64_t random_state_;
+  CacheStats stats_;
+  uint64_t unused_prefetches_[kPrefetchSources];
+};
+
+/**
+ * @brief Иерархия кэшей, прогоняющая трассу
+ *
+ * Неинклюзивная модель с записью с выделением строки: обращение идёт вниз до
+ * первого попадания, строка загружается во все промахнувшиеся уровни.
+ * Грязные вытеснения учитываются как writebacks своего уровня, но не
+ * записываются в нижний. Обращение, пересекающее границу строки, даёт
+ * обращение к каждой строке. Simulate заранее подтягивает множества нижних
+ * уровней для записей на kLookahead вперёд: их массивы не помещаются в кэш
+ * хоста, и без предвыборки каждый промах L1 ждёт память.
+ *
+ * Записи AccessType::kPrefetch - программная предвыборка: строка загружается
+ * в L1 без обращения по требованию. Модели аппаратной предвыборки
+ * (AddPrefetcher) подключаются к уровню, видят дошедшие до него обращения и
+ * загружают строки в него (и в нижние уровни без строки). Время в модели -
+ * номер записи трассы: строка, запрошенная раньше чем через
+ * SetPrefetchLatency записей после загрузки, считается опоздавшей.
+ */
+class CacheHierarchy {
+ public:
+  /**
+   * @throws std::invalid_argument без уровней или при неверном уровне
+   */
+  explicit CacheHierarchy(const std::vector<CacheLevelConfig>& levels, bool use_simd = true);
+
+  static constexpr size_t kLookahead = 16;
+  static constexpr size_t kMaxPrefetchers = SetAssociativeCache::kPrefetchSources - 2;
+  static constexpr uint64_t kDefaultPrefetchLatency = 32;
+
+  void Access(const TraceRecord& record);
+  void Simulate(const TraceRecord* records, size_t count);
+  void Run(const MappedTrace& trace);
+  void Reset();
+
+  /**
+   * @brief Подключение модели предвыборки к уровню level (0 - L1)
+   * @throws std::invalid_argument при неверном уровне или больше kMaxPrefetchers моделей
+   */
+  void AddPrefetcher(std::unique_ptr<Prefetcher> prefetcher, size_t level = 0);
+  void SetPrefetchLatency(uint64_t records) { prefetch_latency_ = records; }
+
+  size_t PrefetcherCount() const { return prefetch_sources_.size() - 1; }
+  const Prefetcher& PrefetcherAt(size_t index) const {
+    return *prefetch_sources_[index + 1].model;
+  }
+  size_t PrefetcherLevel(size_t index) const { return prefetch_sources_[index + 1].level; }
+  PrefetchStats PrefetcherStats(size_t index) const { return SourceStats(index + 1); }
+  PrefetchStats SoftwarePrefetchStats() const { return SourceStats(0); }
+
+  size_t LevelCount() const { return levels_.size(); }
+  const SetAssociativeCache& Level(size_t index) const { return levels_[index]; }
+  uint64_t records() const { return records_; }
+
+  /**
+   * @brief Уровни по кэшам данных машины (размер, строка, ассоциативность)
+   */
+  static std::vector<CacheLevelConfig> FromTopology(const CacheTopology& topology,
+                                                    ReplacementPolicy policy);
+
+  /**
+   * @brief Разбор "32K:8[:policy],1M:16,..." (размер:ways[:политика] на уровень)
+   * @throws std::invalid_argument при неверной записи
+   */
+  static std::vector<CacheLevelConfig> ParseLevels(const std::string& spec,
+                                                   ReplacementPolicy policy,
+                                                   size_t line_bytes = 64);
+
+ private:
+  /**
+   * @brief Источник предвыборки: 0 - записи трассы, далее модели
+   *        (в метаданных кэша - номер + 1)
+   */
+  struct PrefetchSource {
+    std::unique_ptr<Prefetcher> model;
+    size_t level = 0;
+    PrefetchStats stats;
+  };
+
+  void Issue(size_t source, uint64_t line);
+  void Credit(unsigned source, uint64_t line);
+  void Train(uint64_t line, uint32_t pc, size_t hit_level, bool hit_prefetched);
+  void ExpireInFlight();
+  PrefetchStats SourceStats(size_t source) const;
+
+  std::vector<SetAssociativeCache> levels_;
+  unsigned line_shift_;
+  uint64_t records_;
+  std::vector<PrefetchSource> prefetch_sources_;
+  std::vector<uint64_t> candidates_;
+  uint64_t prefetch_latency_;
+  std::deque<std::pair<uint64_t, uint64_t>> in_flight_;      // (запись, строка) по времени
+  std::unordered_map<uint64_t, uint64_t> in_flight_lines_;   // Строка -> запись загрузки
+};
+
+}  // namespace hardware_analysis
+
+#endif  // CACHE_SIMULATOR_HPP
@@ -0,0 +1,261 @@
+#include "cache_topology.hpp"
+#include "hardware_monitor.hpp"
+#include <cpuid.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace hardware_analysis {
+
+namespace {
+
+/**
+ * @brief "48K", "2048K", "32M" -> байты (0 если не разобрано)
+ */
+size_t ParseCacheSize(const std::string& text) {
+  size_t pos = 0;
+  unsigned long long value = 0;
+  try {
+    value = std::stoull(text, &pos);
+  } catch (const std::exception&) {
+    return 0;
+  }
+  switch (pos < text.size() ? text[pos] : ' ') {
+    case 'K':
+      return value << 10;
+    case 'M':
+      return value << 20;
+    case 'G':
+      return value << 30;
+    default:
+      return value;
+  }
+}
+
+size_t ReadSizeOr(const std::string& path, size_t fallback) {
+  try {
+    return utils::ReadSysfsU64(path);
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+
+bool DataFirst(const CacheInfo& a, const CacheInfo& b) {
+  return std::tie(a.level, a.type, a.shared_cpus) < std::tie(b.level, b.type, b.shared_cpus);
+}
+
+}  // namespace
+
+bool CacheInfo::SharedWith(int cpu) const {
+  return std::binary_search(shared_cpus.begin(), shared_cpus.end(), cpu);
+}
+
+// ============================================================================
+// Чтение
+// ============================================================================
+
+CacheTopology CacheTopology::Read(const std::string& sysfs_cpu_root,
+                                  const std::vector<int>& cpus) {
+  CacheTopology topology = ReadSysfs(sysfs_cpu_root, cpus);
+  if (topology.caches.empty()) {
+    topology = ReadCpuid(cpus.empty() ? std::vector<int>{0} : cpus);
+  }
+  return topology;
+}
+
+CacheTopology CacheTopology::ReadSysfs(const std::string& sysfs_cpu_root,
+                                       const std::vector<int>& cpus) {
+  CacheTopology topology;
+  std::set<std::tuple<int, CacheType, std::vector<int>>> seen;
+
+  for (int cpu : cpus.empty() ? std::vector<int>{0} : cpus) {
+    for (int index = 0;; ++index) {
+      std::string base = sysfs_cpu_root + "/cpu" + std::to_string(cpu) + "/cache/index" +
+                         std::to_string(index) + "/";
+      CacheInfo info;
+      std::string type;
+      try {
+        info.level = static_cast<int>(utils::ReadSysfsU64(base + "level"));
+        info.size_bytes = ParseCacheSize(utils::ReadSysfsString(base + "size"));
+        type = utils::ReadSysfsString(base + "type");
+      } catch (const std::exception&) {
+        break;
+      }
+      info.type = type == "Data"          ? CacheType::kData
+                  : type == "Instruction" ? CacheType::kInstruction
+                                          : CacheType::kUnified;
+      info.line_bytes = ReadSizeOr(base + "coherency_line_size", 64);
+      info.ways = ReadSizeOr(base + "ways_of_associativity", 0);
+      info.sets = ReadSizeOr(base + "number_of_sets", 0);
+      if (info.sets == 0 && info.ways > 0 && info.line_bytes > 0) {
+        info.sets = info.size_bytes / (info.ways * info.line_bytes);
+      }
+      try {
+        info.shared_cpus = utils::ParseCpuList(utils::ReadSysfsString(base + "shared_cpu_list"));
+      } catch (const std::exception&) {
+        info.shared_cpus = {cpu};
+      }
+      std::sort(info.shared_cpus.begin(), info.shared_cpus.end());
+
+      if (seen.insert({info.level, info.type, info.shared_cpus}).second) {
+        topology.caches.push_back(std::move(info));
+      }
+    }
+  }
+
+  std::sort(topology.caches.begin(), topology.caches.end(), DataFirst);
+  if (!topology.caches.empty()) {
+    topology.source = "sysfs";
+  }
+  return topology;
+}
+
+bool CacheTopology::DecodeCpuidLeaf(uint32_t eax, uint32_t ebx, uint32_t ecx, CacheInfo* info,
+                                    size_t* sharing) {
+  uint32_t type = eax & 0x1f;
+  if (type == 0) {
+    return false;
+  }
+  info->type = type == 1 ? CacheType::kData
+               : type == 2 ? CacheType::kInstruction
+                           : CacheType::kUnified;
+  info->level = static_cast<int>((eax >> 5) & 0x7);
+  info->line_bytes = (ebx & 0xfff) + 1;
+  size_t partitions = ((ebx >> 12) & 0x3ff) + 1;
+  info->ways = ((ebx >> 22) & 0x3ff) + 1;
+  info->sets = static_cast<size_t>(ecx) + 1;
+  info->size_bytes = info->ways * partitions * info->line_bytes * info->sets;
+  *sharing = ((eax >> 14) & 0xfff) + 1;
+  return true;
+}
+
+CacheTopology CacheTopology::ReadCpuid(const std::vector<int>& cpus) {
+  CacheTopology topology;
+  std::vector<int> sorted = cpus;
+  std::sort(sorted.begin(), sorted.end());
+
+  // Лист 4 (Intel), иначе 0x8000001D (AMD с TOPOEXT) - формат одинаковый
+  unsigned int leaf = 4;
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, nullptr) < 4 || !__get_cpuid_count(4, 0, &eax, &ebx, &ecx, &edx) ||
+      (eax & 0x1f) == 0) {
+    leaf = 0x8000001D;
+    if (__get_cpuid_max(0x80000000, nullptr) < leaf) {
+      return topology;
+    }
+  }
+
+  for (unsigned int subleaf = 0; subleaf < 16; ++subleaf) {
+    if (!__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx)) {
+      break;
+    }
+    CacheInfo info;
+    size_t sharing = 1;
+    if (!DecodeCpuidLeaf(eax, ebx, ecx, &info, &sharing)) {
+      break;
+    }
+    // Соседние номера CPU как приближение общего кэша
+    sharing = std::max<size_t>(1, std::min(sharing, sorted.size()));
+    for (size_t begin = 0; begin < sorted.size(); begin += sharing) {
+      CacheInfo instance = info;
+      size_t end = std::min(begin + sharing, sorted.size());
+      instance.shared_cpus.assign(sorted.begin() + begin, sorted.begin() + end);
+      topology.caches.push_back(std::move(instance));
+    }
+  }
+
+  std::sort(topology.caches.begin(), topology.caches.end(), DataFirst);
+  if (!topology.caches.empty()) {
+    topology.source = "cpuid";
+  }
+  return topology;
+}
+
+// ============================================================================
+// Запросы
+// ============================================================================
+
+const CacheInfo* CacheTopology::Find(int cpu, int level) const {
+  for (const auto& cache : caches) {
+    if (cache.level == level && cache.HoldsData() && cache.SharedWith(cpu)) {
+      return &cache;
+    }
+  }
+  return nullptr;
+}
+
+size_t CacheTopology::DataCacheBytes(int level) const {
+  for (const auto& cache : caches) {
+    if (cache.level == level && cache.HoldsData()) {
+      return cache.size_bytes;
+    }
+  }
+  return 0;
+}
+
+int CacheTopology::LastLevel() const {
+  int level = 0;
+  for (const auto& cache : caches) {
+    if (cache.HoldsData()) {
+      level = std::max(level, cache.level);
+    }
+  }
+  return level;
+}
+
+size_t CacheTopology::LineBytes() const {
+  for (const auto& cache : caches) {
+    if (cache.level == 1 && cache.HoldsData() && cache.line_bytes > 0) {
+      return cache.line_bytes;
+    }
+  }
+  return 64;
+}
+
+std::vector<std::vector<int>> CacheTopology::LastLevelGroups() const {
+  std::vector<std::vector<int>> groups;
+  int level = LastLevel();
+  for (const auto& cache : caches) {
+    if (cache.level == level && cache.HoldsData()) {
+      groups.push_back(cache.shared_cpus);
+    }
+  }
+  return groups;
+}
+
+int CacheTopology::LastLevelId(int cpu) const {
+  std::vector<std::vector<int>> groups = LastLevelGroups();
+  for (size_t id = 0; id < groups.size(); ++id) {
+    if (std::binary_search(groups[id].begin(), groups[id].end(), cpu)) {
+      return static_cast<int>(id);
+    }
+  }
+  return -1;
+}
+
+std::string CacheTopology::Signature() const {
+  std::string signature;
+  for (const auto& cache : caches) {
+    if (!cache.SharedWith(0)) {
+      continue;
+    }
+    const char* suffix = cache.type == CacheType::kData          ? "d"
+                         : cache.type == CacheType::kInstruction ? "i"
+                                                                 : "";
+    signature += (signature.empty() ? "L" : " L") + std::to_string(cache.level) + suffix + ":" +
+                 std::to_string(cache.size_bytes >> 10) + "K";
+  }
+  return signature.empty() ? "unknown" : signature;
+}
+
+size_t CacheLineSize() {
+  static const size_t line = [] {
+    size_t bytes = CacheTopology::Read().LineBytes();
+    // Выравнивание posix_memalign: степень двойки, не меньше указателя
+    return (bytes & (bytes - 1)) == 0 && bytes >= sizeof(void*) ? bytes : size_t{64};
+  }();
+  return line;
+}
+
+}  // namespace hardware_analysis
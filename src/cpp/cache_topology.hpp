@@ -0,0 +1,113 @@
+#ifndef CACHE_TOPOLOGY_HPP
+#define CACHE_TOPOLOGY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+enum class CacheType {
+  kData = 0,
+  kInstruction,
+  kUnified
+};
+
+/**
+ * @brief Один экземпляр кэша и CPU, которые его делят
+ */
+struct CacheInfo {
+  int level = 0;
+  CacheType type = CacheType::kUnified;
+  size_t size_bytes = 0;
+  size_t line_bytes = 0;
+  size_t ways = 0;                  // 0 - неизвестно
+  size_t sets = 0;
+  std::vector<int> shared_cpus;     // По возрастанию
+
+  bool HoldsData() const { return type != CacheType::kInstruction; }
+  bool SharedWith(int cpu) const;
+};
+
+/**
+ * @brief Иерархия кэшей машины
+ *
+ * Основной источник - /sys/devices/system/cpu/cpu<N>/cache/index<M>. Без
+ * sysfs (контейнеры, старые ядра) используется CPUID лист 4 (Intel) или
+ * 0x8000001D (AMD): размеры точные, а состав CPU, делящих кэш, берётся
+ * приближённо - подряд идущими номерами по числу "logical processors
+ * sharing this cache".
+ */
+struct CacheTopology {
+  std::vector<CacheInfo> caches;    // Различные экземпляры: (уровень, тип, CPU)
+  std::string source = "none";      // "sysfs", "cpuid" или "none"
+
+  /**
+   * @brief sysfs, затем CPUID
+   * @param sysfs_cpu_root Корень /sys/devices/system/cpu (для тестов - фейковое дерево)
+   * @param cpus CPU для опроса (пусто - только cpu0)
+   */
+  static CacheTopology Read(const std::string& sysfs_cpu_root = "/sys/devices/system/cpu",
+                            const std::vector<int>& cpus = {});
+
+  static CacheTopology ReadSysfs(const std::string& sysfs_cpu_root, const std::vector<int>& cpus);
+
+  /**
+   * @brief Кэши по CPUID текущего ядра
+   * @param cpus Логические CPU для приближённого разбиения на группы
+   */
+  static CacheTopology ReadCpuid(const std::vector<int>& cpus);
+
+  /**
+   * @brief Разбор одного подлиста CPUID 4 / 0x8000001D
+   * @return false для подлиста "кэшей больше нет" (тип 0)
+   */
+  static bool DecodeCpuidLeaf(uint32_t eax, uint32_t ebx, uint32_t ecx, CacheInfo* info,
+                              size_t* sharing);
+
+  /**
+   * @brief Кэш данных (или общий) уровня level, доступный cpu
+   * @return nullptr если такого нет
+   */
+  const CacheInfo* Find(int cpu, int level) const;
+
+  /**
+   * @brief Размер кэша данных уровня (по первому экземпляру), 0 если неизвестен
+   */
+  size_t DataCacheBytes(int level) const;
+
+  /**
+   * @brief Наибольший уровень кэша данных (0 если кэши неизвестны)
+   */
+  int LastLevel() const;
+
+  /**
+   * @brief Размер строки L1D (64 если неизвестен)
+   */
+  size_t LineBytes() const;
+
+  /**
+   * @brief Группы CPU, делящих последний уровень кэша
+   */
+  std::vector<std::vector<int>> LastLevelGroups() const;
+
+  /**
+   * @brief Номер группы LastLevelGroups(), в которую входит cpu (-1 если нет)
+   */
+  int LastLevelId(int cpu) const;
+
+  /**
+   * @brief Сигнатура cpu0 в формате MachineProfile::DetectCacheSignature()
+   */
+  std::string Signature() const;
+};
+
+/**
+ * @brief Размер кэш-линии текущей машины (читается один раз)
+ */
+size_t CacheLineSize();
+
+}  // namespace hardware_analysis
+
+#endif  // CACHE_TOPOLOGY_HPP
@@ -0,0 +1,381 @@
+#include "core_latency.hpp"
+#include "benchmark_report.hpp"
+#include "hardware_monitor.hpp"
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+// После стольких холостых проверок поток уступает CPU: при переподписке
+// (оба потока на одном CPU) обмен иначе ждал бы конца кванта
+constexpr size_t kSpinsBeforeYield = 1u << 10;
+
+/**
+ * @brief Счётчик в отдельной кэш-линии
+ */
+struct alignas(64) PingPongLine {
+  std::atomic<uint64_t> value{0};
+};
+
+void WaitFor(const std::atomic<uint64_t>& value, uint64_t expected) {
+  size_t spins = 0;
+  while (value.load(std::memory_order_acquire) != expected) {
+    if (++spins % kSpinsBeforeYield == 0) {
+      sched_yield();
+    } else {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+  }
+}
+
+std::string FormatGroups(const std::vector<std::vector<int>>& groups) {
+  std::ostringstream out;
+  for (size_t g = 0; g < groups.size(); ++g) {
+    out << (g ? ";" : "");
+    for (size_t i = 0; i < groups[g].size(); ++i) {
+      out << (i ? "," : "") << groups[g][i];
+    }
+  }
+  return out.str();
+}
+
+/**
+ * @brief Группы топологии, ограниченные CPU матрицы
+ */
+std::vector<std::vector<int>> Restrict(const std::vector<std::vector<int>>& groups,
+                                       const std::vector<int>& cpus) {
+  std::vector<std::vector<int>> restricted;
+  for (const auto& group : groups) {
+    std::vector<int> kept;
+    for (int cpu : group) {
+      if (std::binary_search(cpus.begin(), cpus.end(), cpu)) {
+        kept.push_back(cpu);
+      }
+    }
+    if (!kept.empty()) {
+      std::sort(kept.begin(), kept.end());
+      restricted.push_back(std::move(kept));
+    }
+  }
+  std::sort(restricted.begin(), restricted.end());
+  return restricted;
+}
+
+template <typename Key>
+std::vector<std::vector<int>> GroupBy(const TopologySnapshot& topology,
+                                      Key (*key)(const CpuTopologyInfo&)) {
+  std::map<Key, std::vector<int>> by_key;
+  for (const auto& cpu : topology.cpus) {
+    by_key[key(cpu)].push_back(cpu.cpu_id);
+  }
+  std::vector<std::vector<int>> groups;
+  for (auto& entry : by_key) {
+    groups.push_back(std::move(entry.second));
+  }
+  return groups;
+}
+
+/**
+ * @brief Имена уровней, известные из топологии
+ *
+ * При совпадении групп берётся первое имя: узел, равный пакету, - "socket";
+ * при sub-NUMA clustering узлы мельче пакета и получают "numa".
+ */
+std::vector<std::pair<std::string, std::vector<std::vector<int>>>> NamedTopologyLevels(
+    const TopologySnapshot& topology, const std::vector<int>& cpus) {
+  auto core = +[](const CpuTopologyInfo& cpu) {
+    return std::make_pair(cpu.package_id, cpu.core_id);
+  };
+  auto node = +[](const CpuTopologyInfo& cpu) { return cpu.numa_node; };
+  auto package = +[](const CpuTopologyInfo& cpu) { return cpu.package_id; };
+  return {{"smt", Restrict(GroupBy(topology, core), cpus)},
+          {"llc", Restrict(topology.LastLevelCacheGroups(), cpus)},
+          {"socket", Restrict(GroupBy(topology, package), cpus)},
+          {"numa", Restrict(GroupBy(topology, node), cpus)}};
+}
+
+}  // namespace
+
+double CoreLatencyMatrix::Between(int cpu_a, int cpu_b) const {
+  auto a = std::find(cpus.begin(), cpus.end(), cpu_a);
+  auto b = std::find(cpus.begin(), cpus.end(), cpu_b);
+  if (a == cpus.end() || b == cpus.end()) {
+    return -1.0;
+  }
+  return At(a - cpus.begin(), b - cpus.begin());
+}
+
+CoreLatencyBenchmark::CoreLatencyBenchmark(const CoreLatencyConfig& config) : config_(config) {
+  if (config_.round_trips == 0 || config_.samples == 0) {
+    throw std::invalid_argument("Round trips and samples must be positive");
+  }
+  if (config_.cpus.empty()) {
+    for (const auto& cpu : TopologySnapshot::Read().cpus) {
+      config_.cpus.push_back(cpu.cpu_id);
+    }
+  }
+  std::sort(config_.cpus.begin(), config_.cpus.end());
+  config_.cpus.erase(std::unique(config_.cpus.begin(), config_.cpus.end()), config_.cpus.end());
+}
+
+// ============================================================================
+// Измерение
+// ============================================================================
+
+double CoreLatencyBenchmark::MeasurePair(int cpu_a, int cpu_b) const {
+  if (cpu_a == cpu_b) {
+    throw std::invalid_argument("Ping-pong needs two different CPUs");
+  }
+  PingPongLine line;
+  const uint64_t warmup = std::min<size_t>(config_.round_trips, 1000);
+  const uint64_t total = warmup + config_.samples * config_.round_trips;
+
+  // Ответчик: ждёт нечётное значение и отвечает следующим чётным
+  std::thread responder([&] {
+    ScopedAffinity affinity;
+    PinOrWarn(affinity, cpu_b, "ping-pong");
+    for (uint64_t i = 0; i < total; ++i) {
+      WaitFor(line.value, 2 * i + 1);
+      line.value.store(2 * i + 2, std::memory_order_release);
+    }
+  });
+
+  std::vector<double> samples;
+  {
+    ScopedAffinity affinity;
+    PinOrWarn(affinity, cpu_a, "ping-pong");
+    uint64_t next = 0;
+    auto round_trip = [&] {
+      line.value.store(2 * next + 1, std::memory_order_release);
+      WaitFor(line.value, 2 * next + 2);
+      ++next;
+    };
+    for (uint64_t i = 0; i < warmup; ++i) {
+      round_trip();
+    }
+    for (size_t sample = 0; sample < config_.samples; ++sample) {
+      auto begin = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < config_.round_trips; ++i) {
+        round_trip();
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+      samples.push_back(elapsed.count() / config_.round_trips);
+    }
+  }
+  responder.join();
+  return DistributionSummary::FromSamples(std::move(samples)).p50;
+}
+
+std::vector<std::vector<std::pair<size_t, size_t>>> CoreLatencyBenchmark::PairRounds(
+    size_t count) {
+  std::vector<std::vector<std::pair<size_t, size_t>>> rounds;
+  if (count < 2) {
+    return rounds;
+  }
+  // Нечётное число: фиктивный участник, пара с ним - пропуск раунда
+  size_t slots = count + (count % 2);
+  std::vector<size_t> order(slots);
+  std::iota(order.begin(), order.end(), 0);
+
+  for (size_t round = 0; round + 1 < slots; ++round) {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < slots / 2; ++i) {
+      size_t a = order[i];
+      size_t b = order[slots - 1 - i];
+      if (a < count && b < count) {
+        pairs.push_back({std::min(a, b), std::max(a, b)});
+      }
+    }
+    rounds.push_back(std::move(pairs));
+    // Первый остаётся на месте, остальные сдвигаются по кругу
+    std::rotate(order.begin() + 1, order.end() - 1, order.end());
+  }
+  return rounds;
+}
+
+CoreLatencyMatrix CoreLatencyBenchmark::Run() const {
+  CoreLatencyMatrix matrix;
+  matrix.cpus = config_.cpus;
+  const size_t n = matrix.cpus.size();
+  matrix.round_trip_ns.assign(n * n, 0.0);
+
+  for (const auto& round : PairRounds(n)) {
+    auto measure = [&](const std::pair<size_t, size_t>& pair) {
+      double ns = MeasurePair(matrix.cpus[pair.first], matrix.cpus[pair.second]);
+      matrix.round_trip_ns[pair.first * n + pair.second] = ns;
+      matrix.round_trip_ns[pair.second * n + pair.first] = ns;
+    };
+    if (!config_.parallel) {
+      for (const auto& pair : round) {
+        measure(pair);
+      }
+      continue;
+    }
+    // Пары раунда не делят CPU и пишут в разные ячейки матрицы
+    std::vector<std::thread> initiators;
+    for (const auto& pair : round) {
+      initiators.emplace_back(measure, pair);
+    }
+    for (auto& initiator : initiators) {
+      initiator.join();
+    }
+  }
+  return matrix;
+}
+
+// ============================================================================
+// Кластеризация
+// ============================================================================
+
+std::vector<LatencyDomainLevel> CoreLatencyBenchmark::Cluster(const CoreLatencyMatrix& matrix,
+                                                              const TopologySnapshot* topology,
+                                                              double gap_ratio) {
+  std::vector<LatencyDomainLevel> levels;
+  const size_t n = matrix.cpus.size();
+  if (n < 2) {
+    return levels;
+  }
+
+  std::vector<double> values;
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      values.push_back(matrix.At(i, j));
+    }
+  }
+  std::sort(values.begin(), values.end());
+  std::vector<double> thresholds;
+  for (size_t k = 0; k + 1 < values.size(); ++k) {
+    if (values[k + 1] > values[k] * gap_ratio) {
+      thresholds.push_back(values[k]);
+    }
+  }
+  thresholds.push_back(values.back());
+
+  std::vector<int> sorted_cpus = matrix.cpus;
+  std::sort(sorted_cpus.begin(), sorted_cpus.end());
+  std::vector<std::pair<std::string, std::vector<std::vector<int>>>> named;
+  if (topology != nullptr) {
+    named = NamedTopologyLevels(*topology, sorted_cpus);
+  }
+
+  for (double threshold : thresholds) {
+    // Компоненты связности по рёбрам не длиннее порога
+    std::vector<size_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&](size_t x) {
+      while (parent[x] != x) {
+        x = parent[x] = parent[parent[x]];
+      }
+      return x;
+    };
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = i + 1; j < n; ++j) {
+        if (matrix.At(i, j) <= threshold) {
+          parent[root(i)] = root(j);
+        }
+      }
+    }
+    std::map<size_t, std::vector<int>> components;
+    for (size_t i = 0; i < n; ++i) {
+      components[root(i)].push_back(matrix.cpus[i]);
+    }
+    std::vector<std::vector<int>> groups;
+    for (auto& entry : components) {
+      std::sort(entry.second.begin(), entry.second.end());
+      groups.push_back(std::move(entry.second));
+    }
+    std::sort(groups.begin(), groups.end());
+    if (!levels.empty() && levels.back().groups == groups) {
+      levels.back().max_round_trip_ns = threshold;
+      continue;
+    }
+
+    LatencyDomainLevel level;
+    level.name = "tier" + std::to_string(levels.size() + 1);
+    for (const auto& candidate : named) {
+      bool used = std::any_of(levels.begin(), levels.end(), [&](const LatencyDomainLevel& l) {
+        return l.name == candidate.first;
+      });
+      if (!used && candidate.second == groups) {
+        level.name = candidate.first;
+        break;
+      }
+    }
+    level.max_round_trip_ns = threshold;
+    level.groups = std::move(groups);
+    levels.push_back(std::move(level));
+  }
+  return levels;
+}
+
+// ============================================================================
+// Профиль
+// ============================================================================
+
+void CoreLatencyBenchmark::StoreInProfile(const CoreLatencyMatrix& matrix,
+                                          const std::vector<LatencyDomainLevel>& domains,
+                                          MachineProfile& profile) {
+  boost::property_tree::ptree section;
+  section.put("cpus", FormatGroups({matrix.cpus}));
+  const size_t n = matrix.cpus.size();
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      section.put("round_trip_ns." + std::to_string(matrix.cpus[i]) + "-" +
+                      std::to_string(matrix.cpus[j]),
+                  matrix.At(i, j));
+    }
+  }
+  for (size_t level = 0; level < domains.size(); ++level) {
+    std::string key = "domains." + std::to_string(level);
+    section.put(key + ".name", domains[level].name);
+    section.put(key + ".max_round_trip_ns", domains[level].max_round_trip_ns);
+    section.put(key + ".groups", FormatGroups(domains[level].groups));
+  }
+  profile.Data().put_child("core_to_core", section);
+}
+
+bool CoreLatencyBenchmark::LoadFromProfile(const MachineProfile& profile,
+                                           CoreLatencyMatrix* matrix) {
+  auto section = profile.Data().get_child_optional("core_to_core");
+  if (!section) {
+    return false;
+  }
+  CoreLatencyMatrix loaded;
+  try {
+    loaded.cpus = utils::ParseCpuList(section->get<std::string>("cpus", ""));
+  } catch (const std::exception&) {
+    return false;
+  }
+  const size_t n = loaded.cpus.size();
+  if (n < 2) {
+    return false;
+  }
+  loaded.round_trip_ns.assign(n * n, 0.0);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      auto value = section->get_optional<double>(
+          "round_trip_ns." + std::to_string(loaded.cpus[i]) + "-" + std::to_string(loaded.cpus[j]));
+      if (!value) {
+        return false;
+      }
+      loaded.round_trip_ns[i * n + j] = *value;
+      loaded.round_trip_ns[j * n + i] = *value;
+    }
+  }
+  *matrix = std::move(loaded);
+  return true;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,114 @@
+#ifndef CORE_LATENCY_HPP
+#define CORE_LATENCY_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cpu_topology.hpp"
+#include "machine_profile.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Параметры измерения задержек между ядрами
+ */
+struct CoreLatencyConfig {
+  std::vector<int> cpus;           // Пусто - все online CPU
+  size_t round_trips = 4000;       // Обменов строкой на одну выборку
+  size_t samples = 5;              // Выборок на пару, берётся медиана
+  bool parallel = true;            // Непересекающиеся пары измеряются одновременно
+};
+
+/**
+ * @brief Симметричная матрица времени обмена кэш-линией туда и обратно
+ */
+struct CoreLatencyMatrix {
+  std::vector<int> cpus;
+  std::vector<double> round_trip_ns;   // cpus.size()^2 по строкам, диагональ 0
+
+  double At(size_t i, size_t j) const { return round_trip_ns[i * cpus.size() + j]; }
+
+  /**
+   * @brief Задержка по номерам CPU (-1 если пары нет в матрице)
+   */
+  double Between(int cpu_a, int cpu_b) const;
+};
+
+/**
+ * @brief Уровень иерархии задержек: CPU, обменивающиеся строкой не дольше порога
+ */
+struct LatencyDomainLevel {
+  std::string name;                          // "smt", "llc", "socket", "numa" или "tier<N>"
+  double max_round_trip_ns;
+  std::vector<std::vector<int>> groups;      // Разбиение cpus, группы по возрастанию
+};
+
+/**
+ * @brief Матрица задержек передачи кэш-линии между логическими CPU
+ *
+ * Два потока, привязанные к CPU пары, по очереди увеличивают счётчик в
+ * общей кэш-линии: каждый обмен переносит линию в Modified-состоянии в
+ * чужой L1 и обратно. В отличие от NumaNode это видит SMT-соседей, общий
+ * L3 (CCX) и межсокетную шину. Пары разбиваются на раунды круговым
+ * методом, пары раунда не пересекаются по CPU и в режиме parallel
+ * измеряются одновременно - N-1 раунд вместо N(N-1)/2 измерений.
+ *
+ * Результат хранится в MachineProfile под core_to_core.{cpus,
+ * round_trip_ns.<a>-<b>, domains.<уровень>}.
+ */
+class CoreLatencyBenchmark {
+ public:
+  explicit CoreLatencyBenchmark(const CoreLatencyConfig& config = {});
+
+  /**
+   * @brief Полная матрица по config.cpus
+   */
+  CoreLatencyMatrix Run() const;
+
+  /**
+   * @brief Медиана времени обмена туда-обратно, нс
+   * @throws std::invalid_argument если cpu_a == cpu_b
+   */
+  double MeasurePair(int cpu_a, int cpu_b) const;
+
+  /**
+   * @brief Раунды непересекающихся пар индексов 0..count-1 (круговой метод)
+   *
+   * Каждая пара встречается ровно один раз; раундов count-1 (count при нечётном).
+   */
+  static std::vector<std::vector<std::pair<size_t, size_t>>> PairRounds(size_t count);
+
+  /**
+   * @brief Кластеризация CPU по уровням задержки
+   *
+   * Отсортированные задержки пар режутся на ярусы там, где соседние
+   * значения отличаются больше чем в gap_ratio раз. Для каждого яруса
+   * группы - компоненты связности по рёбрам не длиннее его границы.
+   * Уровни называются по совпадению с топологией (SMT-соседи, группы LLC,
+   * пакеты, узлы NUMA), иначе "tier<N>".
+   *
+   * @param topology Для имён уровней (nullptr - только "tier<N>")
+   */
+  static std::vector<LatencyDomainLevel> Cluster(const CoreLatencyMatrix& matrix,
+                                                 const TopologySnapshot* topology = nullptr,
+                                                 double gap_ratio = 1.3);
+
+  static void StoreInProfile(const CoreLatencyMatrix& matrix,
+                             const std::vector<LatencyDomainLevel>& domains,
+                             MachineProfile& profile);
+
+  /**
+   * @brief Матрица из профиля
+   * @return false если в профиле нет полной матрицы
+   */
+  static bool LoadFromProfile(const MachineProfile& profile, CoreLatencyMatrix* matrix);
+
+ private:
+  CoreLatencyConfig config_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // CORE_LATENCY_HPP
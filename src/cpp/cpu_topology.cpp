@@ -0,0 +1,173 @@
+#include "cpu_topology.hpp"
+#include "hardware_monitor.hpp"
+#include <dirent.h>
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+int ReadSysfsIntOr(const std::string& path, int fallback) {
+  try {
+    return static_cast<int>(utils::ReadSysfsU64(path));
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+
+}  // namespace
+
+TopologySnapshot TopologySnapshot::Read(const std::string& sysfs_root) {
+  TopologySnapshot snapshot;
+
+  std::vector<int> online;
+  try {
+    online = utils::ParseCpuList(utils::ReadSysfsString(sysfs_root + "/cpu/online"));
+  } catch (const std::exception&) {
+    // Нет sysfs: считаем все CPU на одном пакете
+    int count = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < std::max(count, 1); ++cpu) {
+      online.push_back(cpu);
+    }
+  }
+
+  // Узлы NUMA: node<N>/cpulist
+  std::vector<int> cpu_to_node;
+  if (DIR* dir = opendir((sysfs_root + "/node").c_str())) {
+    while (struct dirent* entry = readdir(dir)) {
+      std::string name(entry->d_name);
+      if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+          !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        continue;
+      }
+      int node_id = std::stoi(name.substr(4));
+      try {
+        for (int cpu : utils::ParseCpuList(utils::ReadSysfsString(
+                 sysfs_root + "/node/" + name + "/cpulist"))) {
+          if (cpu >= static_cast<int>(cpu_to_node.size())) {
+            cpu_to_node.resize(cpu + 1, 0);
+          }
+          cpu_to_node[cpu] = node_id;
+        }
+      } catch (const std::exception&) {
+        // Узел без CPU
+      }
+      snapshot.numa_node_count = std::max(snapshot.numa_node_count, node_id + 1);
+    }
+    closedir(dir);
+  }
+  snapshot.numa_node_count = std::max(snapshot.numa_node_count, 1);
+
+  for (int cpu : online) {
+    std::string base = sysfs_root + "/cpu/cpu" + std::to_string(cpu) + "/topology/";
+
+    CpuTopologyInfo info;
+    info.cpu_id = cpu;
+    info.package_id = ReadSysfsIntOr(base + "physical_package_id", 0);
+    info.core_id = ReadSysfsIntOr(base + "core_id", cpu);
+    info.numa_node = cpu < static_cast<int>(cpu_to_node.size()) ? cpu_to_node[cpu] : 0;
+
+    snapshot.package_count = std::max(snapshot.package_count, info.package_id + 1);
+    snapshot.cpus.push_back(info);
+  }
+
+  snapshot.caches = CacheTopology::Read(sysfs_root + "/cpu", online);
+  return snapshot;
+}
+
+std::vector<int> TopologySnapshot::PackageCpus(int package_id) const {
+  std::vector<int> result;
+  for (const auto& cpu : cpus) {
+    if (cpu.package_id == package_id) {
+      result.push_back(cpu.cpu_id);
+    }
+  }
+  return result;
+}
+
+std::vector<int> TopologySnapshot::NodeCpus(int numa_node) const {
+  std::vector<int> result;
+  for (const auto& cpu : cpus) {
+    if (cpu.numa_node == numa_node) {
+      result.push_back(cpu.cpu_id);
+    }
+  }
+  return result;
+}
+
+int TopologySnapshot::MaxCpuId() const {
+  int max_id = -1;
+  for (const auto& cpu : cpus) {
+    max_id = std::max(max_id, cpu.cpu_id);
+  }
+  return max_id;
+}
+
+const CpuTopologyInfo* TopologySnapshot::Find(int cpu_id) const {
+  for (const auto& cpu : cpus) {
+    if (cpu.cpu_id == cpu_id) {
+      return &cpu;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<std::vector<int>> TopologySnapshot::LastLevelCacheGroups() const {
+  std::vector<std::vector<int>> groups = caches.LastLevelGroups();
+  if (!groups.empty()) {
+    return groups;
+  }
+  for (int package = 0; package < package_count; ++package) {
+    std::vector<int> package_cpus = PackageCpus(package);
+    if (!package_cpus.empty()) {
+      groups.push_back(std::move(package_cpus));
+    }
+  }
+  return groups;
+}
+
+int TopologySnapshot::LastLevelCacheId(int cpu_id) const {
+  std::vector<std::vector<int>> groups = LastLevelCacheGroups();
+  for (size_t id = 0; id < groups.size(); ++id) {
+    if (std::find(groups[id].begin(), groups[id].end(), cpu_id) != groups[id].end()) {
+      return static_cast<int>(id);
+    }
+  }
+  return -1;
+}
+
+// ============================================================================
+// Привязка потоков
+// ============================================================================
+
+ScopedAffinity::ScopedAffinity() : saved_(sched_getaffinity(0, sizeof(mask_), &mask_) == 0) {}
+
+ScopedAffinity::~ScopedAffinity() {
+  if (saved_) {
+    sched_setaffinity(0, sizeof(mask_), &mask_);
+  }
+}
+
+bool ScopedAffinity::Pin(int cpu_id) {
+  return PinCurrentThread(cpu_id);
+}
+
+bool PinCurrentThread(int cpu_id) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu_id, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+bool PinOrWarn(ScopedAffinity& affinity, int cpu_id, const std::string& what) {
+  if (affinity.Pin(cpu_id)) {
+    return true;
+  }
+  std::cerr << "Warning: failed to pin " << what << " thread to cpu" << cpu_id << "\n";
+  return false;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,110 @@
+#ifndef CPU_TOPOLOGY_HPP
+#define CPU_TOPOLOGY_HPP
+
+#include <sched.h>
+#include <string>
+#include <vector>
+
+#include "cache_topology.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Положение логического CPU в топологии
+ */
+struct CpuTopologyInfo {
+  int cpu_id;
+  int core_id;       // topology/core_id
+  int package_id;    // topology/physical_package_id
+  int numa_node;     // 0 если NUMA не поддерживается
+};
+
+/**
+ * @brief Снимок топологии процессоров из sysfs
+ */
+struct TopologySnapshot {
+  std::vector<CpuTopologyInfo> cpus;   // Только online CPU, по возрастанию id
+  int package_count = 0;
+  int numa_node_count = 0;
+  CacheTopology caches;                // Кэши online CPU
+
+  /**
+   * @brief Чтение топологии
+   * @param sysfs_root Корень /sys/devices/system (для тестов - фейковое дерево)
+   * @return Снимок; при отсутствии sysfs - один CPU на пакете 0
+   */
+  static TopologySnapshot Read(const std::string& sysfs_root = "/sys/devices/system");
+
+  /**
+   * @brief CPU указанного пакета
+   */
+  std::vector<int> PackageCpus(int package_id) const;
+
+  /**
+   * @brief CPU указанного NUMA узла
+   */
+  std::vector<int> NodeCpus(int numa_node) const;
+
+  /**
+   * @brief Максимальный номер CPU (для массивов, индексируемых cpu_id)
+   */
+  int MaxCpuId() const;
+
+  /**
+   * @brief Поиск CPU по номеру
+   * @return nullptr если CPU нет в снимке
+   */
+  const CpuTopologyInfo* Find(int cpu_id) const;
+
+  /**
+   * @brief Группы CPU с общим последним уровнем кэша
+   *
+   * Без данных о кэшах группой считается пакет.
+   */
+  std::vector<std::vector<int>> LastLevelCacheGroups() const;
+
+  /**
+   * @brief Номер группы LastLevelCacheGroups() для cpu (-1 если CPU нет)
+   */
+  int LastLevelCacheId(int cpu_id) const;
+};
+
+// ============================================================================
+// Привязка потоков
+// ============================================================================
+
+/**
+ * @brief Закрепление текущего потока за CPU с восстановлением маски в деструкторе
+ */
+class ScopedAffinity {
+ public:
+  ScopedAffinity();
+  ~ScopedAffinity();
+
+  ScopedAffinity(const ScopedAffinity&) = delete;
+  ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+
+  /**
+   * @return false если sched_setaffinity отказал (CPU offline или вне cpuset)
+   */
+  bool Pin(int cpu_id);
+
+ private:
+  cpu_set_t mask_;
+  bool saved_;
+};
+
+/**
+ * @brief Закрепление текущего потока за CPU без восстановления маски
+ */
+bool PinCurrentThread(int cpu_id);
+
+/**
+ * @brief Pin с предупреждением в stderr при отказе
+ * @param what Назначение потока для сообщения ("ping-pong" и т.п.)
+ */
+bool PinOrWarn(ScopedAffinity& affinity, int cpu_id, const std::string& what);
+
+}  // namespace hardware_analysis
+
+#endif  // CPU_TOPOLOGY_HPP
@@ -0,0 +1,249 @@
+#include "cpufreq_actuator.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+const char* const kControlFiles[] = {
+    "scaling_setspeed",
+    "scaling_max_freq",
+    "scaling_min_freq",
+    "energy_performance_preference",
+};
+
+/**
+ * @brief Десятичная запись числа с '\n' (без snprintf в горячем пути)
+ * @return Длина записи
+ */
+size_t FormatDecimalLine(uint64_t value, char* buffer) {
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  for (size_t i = 0; i < count; ++i) {
+    buffer[i] = digits[count - 1 - i];
+  }
+  buffer[count] = '\n';
+  return count + 1;
+}
+
+}  // namespace
+
+CpufreqActuator::CpufreqActuator(const std::string& sysfs_cpu_root)
+    : root_(sysfs_cpu_root), stats_() {}
+
+CpufreqActuator::~CpufreqActuator() {
+  for (auto& files : cpus_) {
+    for (int fd : files.fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    if (files.cur_freq_fd >= 0) {
+      close(files.cur_freq_fd);
+    }
+  }
+}
+
+CpufreqActuator::CpuFiles& CpufreqActuator::Files(int cpu_id) {
+  if (static_cast<size_t>(cpu_id) >= cpus_.size()) {
+    CpuFiles empty;
+    std::fill(std::begin(empty.fds), std::end(empty.fds), kNotOpened);
+    std::fill(std::begin(empty.last_khz), std::end(empty.last_khz), 0);
+    empty.cur_freq_fd = kNotOpened;
+    cpus_.resize(cpu_id + 1, empty);
+  }
+  return cpus_[cpu_id];
+}
+
+int CpufreqActuator::Descriptor(int cpu_id, CpufreqControl control) {
+  CpuFiles& files = Files(cpu_id);
+  int& fd = files.fds[static_cast<size_t>(control)];
+  if (fd == kNotOpened) {
+    std::string path = root_ + "/cpu" + std::to_string(cpu_id) + "/cpufreq/" +
+                       kControlFiles[static_cast<size_t>(control)];
+    fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+      std::cerr << "Failed to open " << path << ": " << std::strerror(errno)
+                << " (root and a matching cpufreq driver required)\n";
+      fd = kOpenFailed;
+    }
+  }
+  return fd;
+}
+
+bool CpufreqActuator::Write(int fd, const char* data, size_t length) {
+  auto started = std::chrono::steady_clock::now();
+  ssize_t written = pwrite(fd, data, length, 0);
+  uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - started).count());
+
+  if (written != static_cast<ssize_t>(length)) {
+    ++stats_.failures;
+    return false;
+  }
+  ++stats_.writes;
+  stats_.total_write_ns += elapsed;
+  stats_.max_write_ns = std::max(stats_.max_write_ns, elapsed);
+  return true;
+}
+
+bool CpufreqActuator::SetFrequency(int cpu_id, uint64_t frequency_mhz, CpufreqControl control) {
+  if (cpu_id < 0 || control == CpufreqControl::kEpp || control == CpufreqControl::kCount) {
+    return false;
+  }
+
+  uint64_t khz = frequency_mhz * 1000;
+  uint64_t& last = Files(cpu_id).last_khz[static_cast<size_t>(control)];
+  if (last == khz) {
+    ++stats_.skipped;
+    return true;
+  }
+
+  int fd = Descriptor(cpu_id, control);
+  if (fd < 0) {
+    ++stats_.failures;
+    return false;
+  }
+
+  char buffer[24];
+  if (!Write(fd, buffer, FormatDecimalLine(khz, buffer))) {
+    last = 0;   // Состояние файла неизвестно
+    return false;
+  }
+  last = khz;
+  return true;
+}
+
+bool CpufreqActuator::SetEnergyPerformancePreference(int cpu_id, const std::string& preference) {
+  if (cpu_id < 0) {
+    return false;
+  }
+
+  std::string& last = Files(cpu_id).last_epp;
+  if (last == preference) {
+    ++stats_.skipped;
+    return true;
+  }
+
+  int fd = Descriptor(cpu_id, CpufreqControl::kEpp);
+  if (fd < 0) {
+    ++stats_.failures;
+    return false;
+  }
+
+  std::string line = preference + "\n";
+  if (!Write(fd, line.data(), line.size())) {
+    last.clear();
+    return false;
+  }
+  last = preference;
+  return true;
+}
+
+size_t CpufreqActuator::SetAll(const std::vector<uint64_t>& frequency_mhz,
+                               std::vector<int>* failed_cpus, CpufreqControl control) {
+  if (failed_cpus != nullptr) {
+    failed_cpus->clear();
+  }
+
+  size_t writes_before = stats_.writes;
+  for (size_t cpu = 0; cpu < frequency_mhz.size(); ++cpu) {
+    if (frequency_mhz[cpu] == 0) {
+      continue;
+    }
+    if (!SetFrequency(static_cast<int>(cpu), frequency_mhz[cpu], control) &&
+        failed_cpus != nullptr) {
+      failed_cpus->push_back(static_cast<int>(cpu));
+    }
+  }
+  return stats_.writes - writes_before;
+}
+
+uint64_t CpufreqActuator::ReadCurrentFrequency(int cpu_id) {
+  if (cpu_id < 0) {
+    return 0;
+  }
+
+  CpuFiles& files = Files(cpu_id);
+  if (files.cur_freq_fd == kNotOpened) {
+    std::string path = root_ + "/cpu" + std::to_string(cpu_id) + "/cpufreq/scaling_cur_freq";
+    files.cur_freq_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (files.cur_freq_fd < 0) {
+      files.cur_freq_fd = kOpenFailed;
+    }
+  }
+  if (files.cur_freq_fd < 0) {
+    return 0;
+  }
+
+  char buffer[32];
+  ssize_t length = pread(files.cur_freq_fd, buffer, sizeof(buffer) - 1, 0);
+  if (length <= 0) {
+    return 0;
+  }
+
+  uint64_t khz = 0;
+  for (ssize_t i = 0; i < length && buffer[i] >= '0' && buffer[i] <= '9'; ++i) {
+    khz = khz * 10 + static_cast<uint64_t>(buffer[i] - '0');
+  }
+  return khz / 1000;
+}
+
+int64_t CpufreqActuator::MeasureTimeToObserve(int cpu_id, uint64_t frequency_mhz,
+                                              uint64_t tolerance_mhz, uint64_t timeout_us,
+                                              CpufreqControl control) {
+  Invalidate(cpu_id);   // Запись обязательна
+  auto started = std::chrono::steady_clock::now();
+  if (!SetFrequency(cpu_id, frequency_mhz, control)) {
+    return -1;
+  }
+
+  while (true) {
+    uint64_t current = ReadCurrentFrequency(cpu_id);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    bool reached = false;
+    if (current != 0) {
+      switch (control) {
+        case CpufreqControl::kMaxFrequency:
+          reached = current <= frequency_mhz + tolerance_mhz;
+          break;
+        case CpufreqControl::kMinFrequency:
+          reached = current + tolerance_mhz >= frequency_mhz;
+          break;
+        default:
+          reached = (current > frequency_mhz ? current - frequency_mhz
+                                             : frequency_mhz - current) <= tolerance_mhz;
+          break;
+      }
+    }
+    if (reached) {
+      return elapsed;
+    }
+    if (static_cast<uint64_t>(elapsed) >= timeout_us) {
+      return -1;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+}
+
+void CpufreqActuator::Invalidate(int cpu_id) {
+  if (cpu_id < 0 || static_cast<size_t>(cpu_id) >= cpus_.size()) {
+    return;
+  }
+  std::fill(std::begin(cpus_[cpu_id].last_khz), std::end(cpus_[cpu_id].last_khz), 0);
+  cpus_[cpu_id].last_epp.clear();
+}
+
+}  // namespace hardware_analysis
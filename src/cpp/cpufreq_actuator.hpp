@@ -0,0 +1,135 @@
+#ifndef CPUFREQ_ACTUATOR_HPP
+#define CPUFREQ_ACTUATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Управляющие файлы cpufreq
+ */
+enum class CpufreqControl {
+  kSetSpeed = 0,    // scaling_setspeed (governor userspace)
+  kMaxFrequency,    // scaling_max_freq
+  kMinFrequency,    // scaling_min_freq
+  kEpp,             // energy_performance_preference (intel_pstate/amd-pstate)
+  kCount
+};
+
+/**
+ * @brief Статистика записей актуатора
+ */
+struct ActuatorStats {
+  uint64_t writes;          // Выполненные pwrite
+  uint64_t skipped;         // Пропущено: значение не изменилось
+  uint64_t failures;
+  uint64_t total_write_ns;  // Суммарная длительность pwrite
+  uint64_t max_write_ns;
+};
+
+/**
+ * @brief Запись частоты cpufreq через постоянно открытые дескрипторы
+ *
+ * Файлы управления открываются при первом обращении и остаются открытыми;
+ * значение форматируется в буфер на стеке и пишется одним pwrite. Если
+ * значение совпадает с последним записанным, запись пропускается. Ошибка
+ * открытия выводится в stderr один раз на файл, дальше возвращается false.
+ */
+class CpufreqActuator {
+ public:
+  /**
+   * @brief Конструктор
+   * @param sysfs_cpu_root Корень sysfs cpu (для тестов - фейковое дерево)
+   */
+  explicit CpufreqActuator(const std::string& sysfs_cpu_root = "/sys/devices/system/cpu");
+  ~CpufreqActuator();
+
+  CpufreqActuator(const CpufreqActuator&) = delete;
+  CpufreqActuator& operator=(const CpufreqActuator&) = delete;
+
+  /**
+   * @brief Запись частоты в файл управления
+   * @param cpu_id ID процессора
+   * @param control Файл (kSetSpeed, kMaxFrequency или kMinFrequency)
+   * @param frequency_mhz Частота
+   * @return true если записано или значение не изменилось
+   */
+  bool SetFrequency(int cpu_id, uint64_t frequency_mhz,
+                    CpufreqControl control = CpufreqControl::kSetSpeed);
+
+  /**
+   * @brief Запись energy_performance_preference
+   * @param cpu_id ID процессора
+   * @param preference "performance", "balance_power", ... или число 0-255
+   * @return true если записано или значение не изменилось
+   */
+  bool SetEnergyPerformancePreference(int cpu_id, const std::string& preference);
+
+  /**
+   * @brief Запись частот всех CPU за один вызов
+   * @param frequency_mhz Частота по cpu_id (0 - не трогать CPU)
+   * @param failed_cpus [out] CPU, запись которых не удалась (может быть nullptr)
+   * @param control Файл управления
+   * @return Количество CPU, для которых выполнен pwrite
+   */
+  size_t SetAll(const std::vector<uint64_t>& frequency_mhz, std::vector<int>* failed_cpus,
+                CpufreqControl control = CpufreqControl::kSetSpeed);
+
+  /**
+   * @brief Текущая частота из scaling_cur_freq
+   * @return Частота в МГц или 0 при ошибке
+   */
+  uint64_t ReadCurrentFrequency(int cpu_id);
+
+  /**
+   * @brief Время от записи частоты до её появления в scaling_cur_freq
+   *
+   * Для kSetSpeed ждём частоту в пределах допуска, для kMaxFrequency -
+   * не выше потолка, для kMinFrequency - не ниже пола.
+   *
+   * @param cpu_id ID процессора
+   * @param frequency_mhz Новая частота
+   * @param tolerance_mhz Допуск сравнения
+   * @param timeout_us Максимальное ожидание
+   * @param control Файл управления (кроме kEpp)
+   * @return Микросекунды или -1 (запись не удалась / не дождались)
+   */
+  int64_t MeasureTimeToObserve(int cpu_id, uint64_t frequency_mhz, uint64_t tolerance_mhz,
+                               uint64_t timeout_us,
+                               CpufreqControl control = CpufreqControl::kSetSpeed);
+
+  /**
+   * @brief Забыть закэшированные значения CPU (частоту изменил кто-то ещё)
+   */
+  void Invalidate(int cpu_id);
+
+  const ActuatorStats& GetStats() const { return stats_; }
+  void ResetStats() { stats_ = {}; }
+
+ private:
+  static constexpr size_t kControlCount = static_cast<size_t>(CpufreqControl::kCount);
+  static constexpr int kNotOpened = -1;
+  static constexpr int kOpenFailed = -2;
+
+  struct CpuFiles {
+    int fds[kControlCount];
+    uint64_t last_khz[kControlCount - 1];   // Для частотных файлов, 0 = неизвестно
+    std::string last_epp;
+    int cur_freq_fd;
+  };
+
+  CpuFiles& Files(int cpu_id);
+  int Descriptor(int cpu_id, CpufreqControl control);
+  bool Write(int fd, const char* data, size_t length);
+
+  std::string root_;
+  std::vector<CpuFiles> cpus_;
+  ActuatorStats stats_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // CPUFREQ_ACTUATOR_HPP
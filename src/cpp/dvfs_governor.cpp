@@ -0,0 +1,384 @@
+#include "dvfs_governor.hpp"
+#include "cpufreq_actuator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace hardware_analysis {
+
+DvfsGovernor::DvfsGovernor(OptimizationEngine& engine, const GovernorConfig& config)
+    : engine_(engine),
+      config_(config),
+      topology_(TopologySnapshot::Read(config.sysfs_root)),
+      load_sampler_(config.proc_root),
+      classifier_(config.classifier),
+      log_head_(0),
+      log_count_(0),
+      dropped_decisions_(0),
+      tick_(0) {
+  if (config_.power_enforcement != "software" && config_.power_enforcement != "rapl" &&
+      config_.power_enforcement != "auto") {
+    throw std::invalid_argument("Unknown power enforcement: " + config_.power_enforcement +
+                                " (expected software, rapl or auto)");
+  }
+  engine_.SetSysfsCpuRoot(config_.sysfs_root + "/cpu");
+
+  int max_cpu = topology_.MaxCpuId();
+  cpu_package_index_.assign(max_cpu + 1, -1);
+  load_percent_.assign(max_cpu + 1, 0.0);
+  applied_mhz_.assign(max_cpu + 1, 0);
+  target_mhz_.assign(max_cpu + 1, 0);
+  pending_mhz_.assign(max_cpu + 1, 0);
+  failed_cpus_.reserve(max_cpu + 1);
+  cpu_weight_.assign(max_cpu + 1, 1.0);
+  for (const auto& entry : config_.cpu_priority) {
+    if (entry.first >= 0 && entry.first <= max_cpu) {
+      cpu_weight_[entry.first] = entry.second;
+    }
+  }
+
+  for (int package = 0; package < topology_.package_count; ++package) {
+    std::vector<int> cpus = topology_.PackageCpus(package);
+    if (cpus.empty()) {
+      continue;
+    }
+
+    PackageState state(package, cpus, config_.power_step_mhz);
+    state.thermal = MakeThermalController(config_.thermal_controller);
+    state.temperature_celsius = std::numeric_limits<double>::quiet_NaN();
+    state.power_watts = std::numeric_limits<double>::quiet_NaN();
+    try {
+      state.msr = std::make_unique<MSRReader>(cpus.front(), config_.msr_root);
+    } catch (const MSRException& e) {
+      std::cerr << "Warning: no MSR access for package " << package
+                << ", thermal/power inputs disabled: " << e.what() << "\n";
+    }
+
+    for (int cpu : cpus) {
+      cpu_package_index_[cpu] = static_cast<int>(packages_.size());
+    }
+    packages_.push_back(std::move(state));
+  }
+
+  log_.resize(std::max<size_t>(1, config_.decision_log_ticks * topology_.cpus.size()));
+  decisions_.resize(topology_.cpus.size());
+
+  if (config_.dvfs.power_limit_watts > 0.0) {
+    EnforcePowerLimitInHardware();
+  }
+
+  features_.assign(max_cpu + 1, PhaseFeatures::Unknown());
+  if (config_.classify_workload) {
+    std::vector<int> cpu_ids;
+    for (const auto& cpu : topology_.cpus) {
+      cpu_ids.push_back(cpu.cpu_id);
+    }
+    counter_source_ = MakeWorkloadCounterSource(cpu_ids, config_.sysfs_root + "/cpu",
+                                                config_.resctrl_root);
+  }
+
+  // Первая выборка задаёт базу для расчёта загрузки
+  load_sampler_.Sample(load_percent_);
+  last_tick_time_ = std::chrono::steady_clock::now() -
+                    std::chrono::milliseconds(config_.tick_interval_ms);
+}
+
+DvfsGovernor::~DvfsGovernor() {
+  if (powercap_) {
+    powercap_->RestoreAll();
+  }
+}
+
+void DvfsGovernor::SetCounterSource(std::unique_ptr<WorkloadCounterSource> source) {
+  counter_source_ = std::move(source);
+  if (counter_source_) {
+    counter_source_->Sample(features_);   // База для первого интервала
+  }
+}
+
+void DvfsGovernor::EnforcePowerLimitInHardware() {
+  const std::string& mode = config_.power_enforcement;
+  if (mode == "software" || config_.dry_run) {
+    return;
+  }
+
+  std::vector<int> package_msr_cpu(topology_.package_count, -1);
+  for (const auto& package : packages_) {
+    if (package.package_id < topology_.package_count) {
+      package_msr_cpu[package.package_id] = package.cpus.front();
+    }
+  }
+
+  auto powercap = std::make_unique<PowercapActuator>(config_.powercap_root, config_.msr_root,
+                                                     package_msr_cpu);
+  bool enforced = !packages_.empty();
+  for (const auto& package : packages_) {
+    if (!powercap->EnforcePowerLimit(package.package_id, config_.dvfs.power_limit_watts,
+                                     config_.power_window_seconds)) {
+      enforced = false;
+      break;
+    }
+  }
+
+  if (!enforced) {
+    powercap->RestoreAll();
+    if (mode == "rapl") {
+      throw std::runtime_error("RAPL power limit could not be programmed");
+    }
+    std::cerr << "Warning: RAPL power limit unavailable, enforcing the budget in software\n";
+    return;
+  }
+  powercap_ = std::move(powercap);
+}
+
+void DvfsGovernor::SamplePackages() {
+  for (auto& package : packages_) {
+    if (!package.msr) {
+      continue;
+    }
+    try {
+      package.temperature_celsius = package.msr->ReadPackageTemperature();
+      package.power_watts = package.msr->ReadPackagePower();
+    } catch (const MSRException&) {
+      package.temperature_celsius = std::numeric_limits<double>::quiet_NaN();
+      package.power_watts = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+}
+
+void DvfsGovernor::RecordDecision(const GovernorDecision& decision) {
+  size_t index = (log_head_ + log_count_) % log_.size();
+  if (log_count_ == log_.size()) {
+    // Журнал переполнен: перезаписываем самое старое решение
+    log_head_ = (log_head_ + 1) % log_.size();
+    ++dropped_decisions_;
+  } else {
+    ++log_count_;
+  }
+  log_[index] = decision;
+}
+
+void DvfsGovernor::CalibratePowerModel(PackageState& package) {
+  if (!std::isfinite(package.power_watts)) {
+    return;
+  }
+
+  // Мощность измерена за прошедший интервал: частоты прошлого тика и
+  // загрузка, только что посчитанная за тот же интервал
+  for (size_t i = 0; i < package.cpus.size(); ++i) {
+    int cpu = package.cpus[i];
+    if (applied_mhz_[cpu] == 0) {
+      return;
+    }
+    package.sample_mhz[i] = applied_mhz_[cpu];
+    package.sample_load[i] = load_percent_[cpu];
+  }
+
+  package.calibrator.AddSample(package.power_watts, package.sample_mhz, package.sample_load);
+  package.calibrator.Fit();
+}
+
+size_t DvfsGovernor::ApplyPowerBudget(PackageState& package) {
+  for (size_t i = 0; i < package.cpus.size(); ++i) {
+    int cpu = package.cpus[i];
+    package.demands[i] = {config_.dvfs.min_frequency_mhz, target_mhz_[cpu],
+                          load_percent_[cpu], cpu_weight_[cpu]};
+  }
+
+  package.allocator.Allocate(package.demands, package.calibrator.GetModel(),
+                             config_.dvfs.power_limit_watts, package.allocated_mhz);
+
+  size_t capped = 0;
+  for (size_t i = 0; i < package.cpus.size(); ++i) {
+    int cpu = package.cpus[i];
+    if (package.allocated_mhz[i] < target_mhz_[cpu]) {
+      target_mhz_[cpu] = package.allocated_mhz[i];
+      ++capped;
+    }
+  }
+  return capped;
+}
+
+double DvfsGovernor::GetThermalScale(size_t package_index) const {
+  return packages_.at(package_index).thermal_scale;
+}
+
+const CorePowerModel& DvfsGovernor::GetPowerModel(size_t package_index) const {
+  return packages_.at(package_index).calibrator.GetModel();
+}
+
+GovernorTickStats DvfsGovernor::Tick() {
+  auto started = std::chrono::steady_clock::now();
+
+  GovernorTickStats stats = {};
+  stats.tick = ++tick_;
+
+  double dt_seconds = std::chrono::duration<double>(started - last_tick_time_).count();
+  last_tick_time_ = started;
+
+  load_sampler_.Sample(load_percent_);
+  SamplePackages();
+  bool classify = counter_source_ && counter_source_->Sample(features_);
+
+  for (auto& package : packages_) {
+    package.thermal_scale = package.thermal->Update(
+        {package.temperature_celsius, package.power_watts, dt_seconds},
+        config_.dvfs.target_temperature_celsius);
+  }
+
+  // Желаемая частота по загрузке, ограниченная потолком терморегулятора.
+  // Температура в CalculateOptimalFrequency не передаётся: её линейный
+  // троттлинг заменён регулятором (LinearThrottleController воспроизводит его)
+  const double no_temperature = std::numeric_limits<double>::quiet_NaN();
+  for (const auto& cpu : topology_.cpus) {
+    uint64_t target = engine_.CalculateOptimalFrequency(
+        load_percent_[cpu.cpu_id], no_temperature, config_.dvfs);
+
+    int index = cpu_package_index_[cpu.cpu_id];
+    if (index >= 0) {
+      uint64_t ceiling = std::max(config_.dvfs.min_frequency_mhz, static_cast<uint64_t>(
+          packages_[index].thermal_scale * config_.dvfs.max_frequency_mhz));
+      target = std::min(target, ceiling);
+    }
+
+    // Фаза памяти почти не ускоряется частотой: ограничиваем её потолком
+    if (classify) {
+      double scale = classifier_.Update(cpu.cpu_id, features_[cpu.cpu_id]);
+      uint64_t ceiling = std::max(config_.dvfs.min_frequency_mhz, static_cast<uint64_t>(
+          std::llround(scale * config_.dvfs.max_frequency_mhz)));
+      if (ceiling < target) {
+        target = ceiling;
+        ++stats.memory_capped_cpus;
+      }
+    }
+    target_mhz_[cpu.cpu_id] = target;
+  }
+
+  // Бюджет мощности пакета делится между его CPU
+  // При аппаратном PL1 распределитель нужен только для приоритетов CPU
+  if (config_.dvfs.power_limit_watts > 0.0 && (!powercap_ || !config_.cpu_priority.empty())) {
+    for (auto& package : packages_) {
+      CalibratePowerModel(package);
+      stats.budget_capped_cpus += ApplyPowerBudget(package);
+    }
+  }
+
+  // Решения по всем CPU, затем одна пакетная запись через актуатор
+  uint64_t timestamp_us = utils::GetTimestampUs();
+  std::fill(pending_mhz_.begin(), pending_mhz_.end(), 0);
+  for (size_t i = 0; i < topology_.cpus.size(); ++i) {
+    int cpu_id = topology_.cpus[i].cpu_id;
+    const PackageState* package = cpu_package_index_[cpu_id] >= 0
+        ? &packages_[cpu_package_index_[cpu_id]] : nullptr;
+
+    GovernorDecision& decision = decisions_[i];
+    decision.tick = tick_;
+    decision.timestamp_us = timestamp_us;
+    decision.cpu_id = cpu_id;
+    decision.load_percent = load_percent_[cpu_id];
+    decision.temperature_celsius = package ? package->temperature_celsius
+                                           : std::numeric_limits<double>::quiet_NaN();
+    decision.package_power_watts = package ? package->power_watts
+                                           : std::numeric_limits<double>::quiet_NaN();
+    decision.current_mhz = applied_mhz_[cpu_id];
+    decision.target_mhz = target_mhz_[cpu_id];
+
+    uint64_t delta = decision.target_mhz > decision.current_mhz
+        ? decision.target_mhz - decision.current_mhz
+        : decision.current_mhz - decision.target_mhz;
+    decision.applied = decision.current_mhz == 0 || delta >= config_.hysteresis_mhz;
+    if (decision.applied) {
+      pending_mhz_[cpu_id] = decision.target_mhz;
+    }
+  }
+
+  if (!config_.dry_run) {
+    engine_.GetCpufreqActuator().SetAll(pending_mhz_, &failed_cpus_);
+    for (int cpu_id : failed_cpus_) {
+      pending_mhz_[cpu_id] = 0;
+    }
+  }
+
+  for (size_t i = 0; i < topology_.cpus.size(); ++i) {
+    GovernorDecision& decision = decisions_[i];
+    if (decision.applied) {
+      if (pending_mhz_[decision.cpu_id] != 0) {
+        applied_mhz_[decision.cpu_id] = decision.target_mhz;
+        ++stats.frequency_changes;
+      } else {
+        decision.applied = false;
+        ++stats.apply_failures;
+      }
+    }
+
+    RecordDecision(decision);
+    ++stats.cpus;
+  }
+
+  stats.duration_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - started).count());
+  return stats;
+}
+
+const char* DvfsGovernor::DecisionLogHeader() {
+  return "tick,timestamp_us,cpu,load_percent,temperature_c,package_power_w,"
+         "current_mhz,target_mhz,applied";
+}
+
+size_t DvfsGovernor::DrainDecisionLog(std::ostream& out) {
+  size_t written = 0;
+  if (dropped_decisions_ > 0) {
+    out << "# dropped " << dropped_decisions_ << " decisions (log overflow)\n";
+    dropped_decisions_ = 0;
+  }
+
+  while (log_count_ > 0) {
+    const GovernorDecision& d = log_[log_head_];
+    out << d.tick << ',' << d.timestamp_us << ',' << d.cpu_id << ','
+        << d.load_percent << ',' << d.temperature_celsius << ','
+        << d.package_power_watts << ',' << d.current_mhz << ','
+        << d.target_mhz << ',' << (d.applied ? 1 : 0) << '\n';
+    log_head_ = (log_head_ + 1) % log_.size();
+    --log_count_;
+    ++written;
+  }
+
+  return written;
+}
+
+uint64_t DvfsGovernor::GetAppliedFrequency(int cpu_id) const {
+  if (cpu_id < 0 || cpu_id >= static_cast<int>(applied_mhz_.size())) {
+    return 0;
+  }
+  return applied_mhz_[cpu_id];
+}
+
+void DvfsGovernor::Run(const std::atomic<bool>& stop, std::ostream* log) {
+  if (log != nullptr) {
+    *log << DecisionLogHeader() << "\n";
+  }
+
+  auto next_tick = std::chrono::steady_clock::now();
+  while (!stop.load()) {
+    GovernorTickStats stats = Tick();
+
+    if (log != nullptr) {
+      DrainDecisionLog(*log);
+      log->flush();
+    }
+    if (stats.apply_failures > 0) {
+      std::cerr << "Warning: tick " << stats.tick << ": " << stats.apply_failures
+                << " frequency writes failed\n";
+    }
+
+    next_tick += std::chrono::milliseconds(config_.tick_interval_ms);
+    std::this_thread::sleep_until(next_tick);
+  }
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,235 @@
+#ifndef DVFS_GOVERNOR_HPP
+#define DVFS_GOVERNOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "cpu_topology.hpp"
+#include "hardware_monitor.hpp"
+#include "optimization_engine.hpp"
+#include "power_allocator.hpp"
+#include "powercap_actuator.hpp"
+#include "thermal_controller.hpp"
+#include "workload_classifier.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Параметры замкнутого DVFS контура
+ */
+struct GovernorConfig {
+  DVFSConfig dvfs = {1000, 4000, 85.0, 0.0};
+  uint64_t tick_interval_ms = 100;
+  uint64_t hysteresis_mhz = 100;        // Частота меняется только при выходе из полосы
+  size_t decision_log_ticks = 64;       // Ёмкость журнала решений (в тиках)
+  bool dry_run = false;                 // Решения без записи в cpufreq
+  std::map<int, double> cpu_priority;   // cpu_id -> вес при делении бюджета (по умолчанию 1)
+  uint64_t power_step_mhz = 100;        // Шаг частоты распределителя бюджета
+  std::string thermal_controller = "pid";  // Терморегулятор пакета: linear, pid, mpc
+  // Бюджет мощности: software (распределитель частот), rapl (PL1 пакета), auto (rapl если есть)
+  std::string power_enforcement = "auto";
+  double power_window_seconds = 1.0;    // Окно усреднения PL1
+  bool classify_workload = false;       // Потолок частоты для фаз, упирающихся в память
+  WorkloadClassifierConfig classifier;
+  std::string resctrl_root = "/sys/fs/resctrl";
+  std::string proc_root = "/proc";
+  std::string sysfs_root = "/sys/devices/system";
+  std::string msr_root = "/dev/cpu";
+  std::string powercap_root = "/sys/class/powercap";
+};
+
+/**
+ * @brief Решение контура для одного CPU вместе с входными данными
+ */
+struct GovernorDecision {
+  uint64_t tick;
+  uint64_t timestamp_us;
+  int cpu_id;
+  double load_percent;
+  double temperature_celsius;   // Температура пакета (NaN если MSR недоступны)
+  double package_power_watts;   // Мощность пакета по RAPL (NaN если недоступна)
+  uint64_t current_mhz;         // Последняя применённая частота (0 = неизвестна)
+  uint64_t target_mhz;
+  bool applied;
+};
+
+/**
+ * @brief Статистика одного тика
+ */
+struct GovernorTickStats {
+  uint64_t tick;
+  size_t cpus;
+  size_t frequency_changes;
+  size_t apply_failures;
+  size_t budget_capped_cpus;    // CPU, получившие меньше желаемой частоты из-за бюджета
+  size_t memory_capped_cpus;    // CPU, ограниченные классификатором фазы памяти
+  uint64_t duration_ns;         // Выборка + решение + применение
+};
+
+/**
+ * @brief Замкнутый DVFS контур: загрузка/температура/мощность -> частота
+ *
+ * Каждый тик читает загрузку CPU из /proc/stat, температуру и мощность
+ * каждого пакета через MSR, вычисляет целевую частоту для каждого CPU
+ * через OptimizationEngine::CalculateOptimalFrequency, ограничивает её
+ * потолком терморегулятора пакета (ThermalController) и применяет
+ * только если она вышла из полосы гистерезиса. При dvfs.power_limit_watts > 0
+ * бюджет пакета по возможности программируется в RAPL PL1 (PowercapActuator)
+ * и удерживается аппаратно; иначе (или при заданных приоритетах CPU)
+ * желаемые частоты пакета проходят через PowerBudgetAllocator: бюджет
+ * пакета делится между CPU по модели мощности, калибруемой по RAPL. При
+ * classify_workload цель CPU в фазе памяти (WorkloadClassifier по счётчикам
+ * perf или resctrl MBM) дополнительно ограничивается. Все решения пишутся в
+ * кольцевой журнал фиксированного размера без выделений памяти в тике;
+ * журнал сбрасывается в поток отдельно через DrainDecisionLog().
+ */
+class DvfsGovernor {
+ public:
+  /**
+   * @brief Конструктор
+   * @param engine Движок оптимизации (расчёт и установка частоты)
+   * @param config Параметры
+   * @throws std::runtime_error если /proc/stat недоступен
+   * @throws std::invalid_argument для неизвестного терморегулятора или power_enforcement
+   * @throws std::runtime_error если power_enforcement = "rapl", а RAPL недоступен
+   */
+  DvfsGovernor(OptimizationEngine& engine, const GovernorConfig& config);
+
+  /**
+   * @brief Возвращает исходные RAPL ограничения, если они менялись
+   */
+  ~DvfsGovernor();
+
+  /**
+   * @brief Одна итерация контура
+   * @return Статистика тика
+   */
+  GovernorTickStats Tick();
+
+  /**
+   * @brief Режим демона: Tick() каждые tick_interval_ms до stop
+   * @param stop Флаг остановки
+   * @param log Поток для журнала решений (nullptr - без журнала)
+   */
+  void Run(const std::atomic<bool>& stop, std::ostream* log);
+
+  /**
+   * @brief Запись накопленных решений в поток (CSV) и очистка журнала
+   * @return Количество записанных решений
+   */
+  size_t DrainDecisionLog(std::ostream& out);
+
+  /**
+   * @brief Накопленные, но ещё не сброшенные решения
+   */
+  size_t PendingDecisions() const { return log_count_; }
+
+  /**
+   * @brief Последняя применённая частота CPU (0 = не применялась)
+   */
+  uint64_t GetAppliedFrequency(int cpu_id) const;
+
+  const TopologySnapshot& GetTopology() const { return topology_; }
+
+  /**
+   * @brief Замена источника признаков классификатора (например, для тестов)
+   * @param source Источник (nullptr - классификация отключается)
+   */
+  void SetCounterSource(std::unique_ptr<WorkloadCounterSource> source);
+
+  /**
+   * @brief Устойчивая фаза CPU по классификатору
+   */
+  WorkloadPhase GetWorkloadPhase(int cpu_id) const { return classifier_.GetPhase(cpu_id); }
+
+  /**
+   * @brief Бюджет мощности удерживается аппаратно (RAPL PL1 пакетов)
+   */
+  bool IsPowerLimitInHardware() const { return powercap_ != nullptr; }
+
+  /**
+   * @brief Текущий потолок терморегулятора пакета (доля max частоты)
+   * @param package_index Индекс пакета в порядке топологии
+   */
+  double GetThermalScale(size_t package_index) const;
+
+  /**
+   * @brief Текущая (калиброванная) модель мощности ядра пакета
+   * @param package_index Индекс пакета в порядке топологии
+   */
+  const CorePowerModel& GetPowerModel(size_t package_index) const;
+
+  /**
+   * @brief Заголовок CSV журнала решений
+   */
+  static const char* DecisionLogHeader();
+
+ private:
+  struct PackageState {
+    int package_id;
+    std::unique_ptr<MSRReader> msr;   // Читатель первого CPU пакета
+    double temperature_celsius;
+    double power_watts;
+    std::unique_ptr<ThermalController> thermal;
+    double thermal_scale;                 // Потолок частоты (доля max)
+
+    // Распределение бюджета (буферы выделены заранее)
+    std::vector<int> cpus;
+    PowerModelCalibrator calibrator;
+    PowerBudgetAllocator allocator;
+    std::vector<CoreDemand> demands;
+    std::vector<uint64_t> allocated_mhz;
+    std::vector<uint64_t> sample_mhz;
+    std::vector<double> sample_load;
+
+    PackageState(int id, const std::vector<int>& package_cpus, uint64_t step_mhz)
+        : package_id(id), temperature_celsius(0.0), power_watts(0.0), thermal_scale(1.0),
+          cpus(package_cpus),
+          calibrator(package_cpus.size()), allocator(step_mhz),
+          demands(package_cpus.size()), allocated_mhz(package_cpus.size()),
+          sample_mhz(package_cpus.size()), sample_load(package_cpus.size()) {}
+  };
+
+  void SamplePackages();
+  void EnforcePowerLimitInHardware();
+  void CalibratePowerModel(PackageState& package);
+  size_t ApplyPowerBudget(PackageState& package);
+  void RecordDecision(const GovernorDecision& decision);
+
+  OptimizationEngine& engine_;
+  GovernorConfig config_;
+  TopologySnapshot topology_;
+  CpuLoadSampler load_sampler_;
+
+  std::vector<PackageState> packages_;
+  std::unique_ptr<PowercapActuator> powercap_;   // nullptr - бюджет держит распределитель
+  std::vector<int> cpu_package_index_;   // cpu_id -> индекс в packages_
+  std::vector<double> load_percent_;
+  std::vector<uint64_t> applied_mhz_;    // cpu_id -> частота
+  std::vector<uint64_t> target_mhz_;     // cpu_id -> цель текущего тика
+  std::vector<double> cpu_weight_;       // cpu_id -> приоритет
+  std::vector<uint64_t> pending_mhz_;    // cpu_id -> запись тика (0 = без изменений)
+  std::vector<int> failed_cpus_;
+  std::vector<GovernorDecision> decisions_;   // Решения текущего тика
+
+  WorkloadClassifier classifier_;
+  std::unique_ptr<WorkloadCounterSource> counter_source_;   // nullptr - без классификации
+  std::vector<PhaseFeatures> features_;  // cpu_id -> признаки тика
+
+  std::vector<GovernorDecision> log_;    // Кольцевой буфер
+  size_t log_head_;
+  size_t log_count_;
+  uint64_t dropped_decisions_;
+  uint64_t tick_;
+  std::chrono::steady_clock::time_point last_tick_time_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // DVFS_GOVERNOR_HPP
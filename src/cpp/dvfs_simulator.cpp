@@ -0,0 +1,181 @@
+#include "dvfs_simulator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace hardware_analysis {
+
+DvfsSimulator::DvfsSimulator(const std::vector<ThermalTracePoint>& trace,
+                             const SimulationModels& models)
+    : models_(models),
+      initial_temperature_(models.thermal.ambient_celsius) {
+  if (!trace.empty() && std::isfinite(trace.front().temperature_celsius)) {
+    initial_temperature_ = trace.front().temperature_celsius;
+  }
+
+  load_percent_.reserve(trace.size());
+  dt_seconds_.reserve(trace.size());
+  decay_.reserve(trace.size());
+  for (size_t k = 1; k < trace.size(); ++k) {
+    double dt = trace[k].time_seconds - trace[k - 1].time_seconds;
+    if (dt <= 0.0) {
+      continue;
+    }
+    load_percent_.push_back(std::max(0.0, std::min(100.0, trace[k].load_percent)));
+    dt_seconds_.push_back(dt);
+    decay_.push_back(std::exp(-dt / models_.thermal.time_constant_seconds));
+  }
+}
+
+DvfsSimulator DvfsSimulator::FromTrace(const std::vector<ThermalTracePoint>& trace,
+                                       uint64_t reference_mhz) {
+  ThermalSimulator fitted = ThermalSimulator::FromTrace(trace);
+  SimulationModels models;
+  models.thermal = fitted.GetPlant();
+  models.power = fitted.GetPowerModel();
+  models.reference_mhz = reference_mhz;
+  return DvfsSimulator(trace, models);
+}
+
+SimulationResult DvfsSimulator::Run(const PolicyCandidate& candidate) const {
+  SimulationResult result;
+  RunBatch(&candidate, 1, &result);
+  return result;
+}
+
+void DvfsSimulator::RunBatch(const PolicyCandidate* candidates, size_t count,
+                             SimulationResult* results) const {
+  // Состояние прогона одной политики
+  struct RunState {
+    double temperature;
+    double observed_load;
+    double backlog;
+    double demanded;
+    double delivered;
+    double frequency_time;
+  };
+
+  const RcThermalModel& thermal = models_.thermal;
+  const PackagePowerModel& power_model = models_.power;
+  const double inverse_reference = 1.0 / static_cast<double>(models_.reference_mhz);
+  const double sensitivity = models_.frequency_sensitivity;
+
+  RunState state[kBatchSize];
+  for (size_t j = 0; j < count; ++j) {
+    state[j] = {initial_temperature_, load_percent_.empty() ? 0.0 : load_percent_.front(),
+                0.0, 0.0, 0.0, 0.0};
+    results[j] = {};
+    results[j].name = candidates[j].name;
+    results[j].config = candidates[j].config;
+    results[j].max_temperature_celsius = initial_temperature_;
+  }
+
+  double duration = 0.0;
+  for (size_t k = 0; k < load_percent_.size(); ++k) {
+    const double dt = dt_seconds_[k];
+    const double demand = load_percent_[k] / 100.0 * dt;
+    const double decay = decay_[k];
+    duration += dt;
+
+    // Политики пакета независимы: их цепочки зависимостей перекрываются
+    for (size_t j = 0; j < count; ++j) {
+      RunState& run = state[j];
+      SimulationResult& result = results[j];
+      const PolicyCandidate& candidate = candidates[j];
+
+      // Решение по измерениям прошлого интервала, как в DvfsGovernor
+      double frequency = static_cast<double>(std::max<uint64_t>(
+          1, candidate.policy(run.observed_load, run.temperature, candidate.config)));
+      double scale = frequency * inverse_reference;
+
+      // Работа в CPU-секундах на эталонной частоте
+      double capacity = ((1.0 - sensitivity) + sensitivity * scale) * dt;
+      double pending = run.backlog + demand;
+      double done = std::min(pending, capacity);
+      run.backlog = std::min(pending - done, models_.max_backlog_seconds);
+      run.observed_load = capacity > 0.0 ? done / capacity * 100.0 : 100.0;
+      run.demanded += demand;
+      run.delivered += done;
+
+      double watts = power_model.Power(run.observed_load, scale);
+      result.energy_joules += watts * dt;
+
+      double steady = thermal.ambient_celsius + thermal.resistance_c_per_watt * watts;
+      run.temperature = steady + (run.temperature - steady) * decay;
+      if (run.temperature > candidate.config.target_temperature_celsius) {
+        result.violation_seconds += dt;
+      }
+      result.max_temperature_celsius = std::max(result.max_temperature_celsius, run.temperature);
+      run.frequency_time += frequency * dt;
+    }
+  }
+
+  for (size_t j = 0; j < count; ++j) {
+    SimulationResult& result = results[j];
+    if (duration > 0.0) {
+      result.average_power_watts = result.energy_joules / duration;
+      result.mean_frequency_mhz = state[j].frequency_time / duration;
+    }
+    // Невыполненный хвост и отброшенная сверх max_backlog работа - потери
+    result.throughput = state[j].demanded > 0.0 ? state[j].delivered / state[j].demanded : 1.0;
+  }
+}
+
+std::vector<SimulationResult> DvfsSimulator::Sweep(
+    const std::vector<PolicyCandidate>& candidates, size_t threads) const {
+  std::vector<SimulationResult> results(candidates.size());
+  size_t batches = (candidates.size() + kBatchSize - 1) / kBatchSize;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min(threads, batches);
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t batch = next.fetch_add(1); batch < batches; batch = next.fetch_add(1)) {
+      size_t begin = batch * kBatchSize;
+      size_t count = std::min(kBatchSize, candidates.size() - begin);
+      RunBatch(&candidates[begin], count, &results[begin]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : pool) {
+    thread.join();
+  }
+  return results;
+}
+
+std::vector<size_t> DvfsSimulator::ParetoFront(const std::vector<SimulationResult>& results,
+                                               double max_violation_seconds) {
+  std::vector<size_t> order;
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (results[i].violation_seconds <= max_violation_seconds) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (results[a].energy_joules != results[b].energy_joules) {
+      return results[a].energy_joules < results[b].energy_joules;
+    }
+    return results[a].throughput > results[b].throughput;
+  });
+
+  // Точка на фронте, если производительность выше, чем у всех более экономных
+  std::vector<size_t> front;
+  double best_throughput = -1.0;
+  for (size_t index : order) {
+    if (results[index].throughput > best_throughput) {
+      front.push_back(index);
+      best_throughput = results[index].throughput;
+    }
+  }
+  return front;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,130 @@
+#ifndef DVFS_SIMULATOR_HPP
+#define DVFS_SIMULATOR_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "optimization_engine.hpp"
+#include "thermal_simulator.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief DVFS политика в форме CalculateOptimalFrequency: (загрузка, T, конфиг) -> МГц
+ *
+ * Вызывается из нескольких потоков одновременно, поэтому не должна
+ * менять общее состояние.
+ */
+using DvfsPolicy = std::function<uint64_t(double load_percent, double temperature_celsius,
+                                          const DVFSConfig& config)>;
+
+/**
+ * @brief Политика и её параметры для прогона
+ */
+struct PolicyCandidate {
+  std::string name;
+  DvfsPolicy policy;
+  DVFSConfig config;
+};
+
+/**
+ * @brief Модели пакета для симуляции
+ */
+struct SimulationModels {
+  RcThermalModel thermal;
+  PackagePowerModel power;              // Масштаб частоты = f / reference_mhz
+  uint64_t reference_mhz = 4000;        // Частота, на которой записан трейс
+  double frequency_sensitivity = 1.0;   // 1 - вычислительная нагрузка, 0 - упор в память
+  double max_backlog_seconds = 5.0;     // Невыполненная работа сверх этого теряется
+};
+
+/**
+ * @brief Итог прогона политики по трейсу
+ */
+struct SimulationResult {
+  std::string name;
+  DVFSConfig config;
+  double energy_joules;
+  double average_power_watts;
+  double throughput;                  // Выполненная / запрошенная работа (0..1)
+  double mean_frequency_mhz;
+  double violation_seconds;           // Время выше target_temperature_celsius
+  double max_temperature_celsius;
+};
+
+/**
+ * @brief Офлайн-симулятор DVFS политик на записанном трейсе пакета
+ *
+ * Нагрузка трейса трактуется как спрос на работу (CPU-секунды на частоте
+ * reference_mhz). Частота политики задаёт скорость выполнения
+ * (1 - b) + b * f / f_ref; невыполненная работа переносится в следующий
+ * интервал, поэтому политика видит загрузку, вызванную её же решениями.
+ * Мощность - PackagePowerModel от фактической загрузки и частоты,
+ * температура - RcThermalModel. Модели калибруются по тому же трейсу.
+ *
+ * Прогон - один проход по трейсу без выделений памяти. Sweep() ведёт
+ * пачки по kBatchSize политик за один проход (их независимые цепочки
+ * вычислений перекрываются в конвейере, трейс читается один раз на
+ * пачку) и распределяет пачки по потокам.
+ */
+class DvfsSimulator {
+ public:
+  DvfsSimulator(const std::vector<ThermalTracePoint>& trace, const SimulationModels& models);
+
+  /**
+   * @brief Симулятор с RC и power моделями, подогнанными по трейсу
+   * @param trace Трейс пакета
+   * @param reference_mhz Частота, на которой записан трейс
+   * @throws std::runtime_error если трейс не позволяет оценить модели
+   */
+  static DvfsSimulator FromTrace(const std::vector<ThermalTracePoint>& trace,
+                                 uint64_t reference_mhz);
+
+  /**
+   * @brief Прогон одной политики
+   */
+  SimulationResult Run(const PolicyCandidate& candidate) const;
+
+  /**
+   * @brief Параллельный прогон многих политик
+   * @param candidates Политики с параметрами
+   * @param threads Число потоков (0 - по числу CPU)
+   * @return Результаты в порядке candidates
+   */
+  std::vector<SimulationResult> Sweep(const std::vector<PolicyCandidate>& candidates,
+                                      size_t threads = 0) const;
+
+  /**
+   * @brief Парето-фронт энергия/производительность среди результатов без перегрева
+   * @param results Результаты Sweep()
+   * @param max_violation_seconds Допустимое время выше цели
+   * @return Индексы результатов по возрастанию энергии
+   */
+  static std::vector<size_t> ParetoFront(const std::vector<SimulationResult>& results,
+                                         double max_violation_seconds = 0.0);
+
+  size_t TraceSize() const { return load_percent_.size(); }
+  const SimulationModels& GetModels() const { return models_; }
+
+ private:
+  static constexpr size_t kBatchSize = 8;
+
+  /**
+   * @brief Совместный прогон до kBatchSize политик за один проход трейса
+   */
+  void RunBatch(const PolicyCandidate* candidates, size_t count,
+                SimulationResult* results) const;
+
+  SimulationModels models_;
+  double initial_temperature_;
+  // Трейс в виде структуры массивов + предвычисленные exp(-dt/tau)
+  std::vector<double> load_percent_;
+  std::vector<double> dt_seconds_;
+  std::vector<double> decay_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // DVFS_SIMULATOR_HPP
@@ -0,0 +1,496 @@
+#include "energy_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "synthetic_workloads.hpp"
+
+namespace hardware_analysis {
+
+EnergyAwareScheduler::EnergyAwareScheduler(const TopologySnapshot& topology,
+                                           const SchedulerConfig& config)
+    : config_(config), total_cpus_(0) {
+  if (config_.frequencies_mhz.empty()) {
+    throw std::invalid_argument("Scheduler needs at least one frequency");
+  }
+  std::sort(config_.frequencies_mhz.begin(), config_.frequencies_mhz.end());
+
+  std::set<int> allowed(config_.cpus.begin(), config_.cpus.end());
+  std::map<int, std::vector<const CpuTopologyInfo*>> by_node;
+  std::set<int> packages;
+  for (const auto& cpu : topology.cpus) {
+    if (allowed.empty() || allowed.count(cpu.cpu_id)) {
+      by_node[cpu.numa_node].push_back(&cpu);
+      packages.insert(cpu.package_id);
+    }
+  }
+
+  for (const auto& node : by_node) {
+    // Сначала по одному CPU на физическое ядро, затем SMT соседи
+    std::vector<int> primary;
+    std::vector<int> siblings;
+    std::set<std::pair<int, int>> seen_cores;
+    for (const CpuTopologyInfo* cpu : node.second) {
+      if (seen_cores.insert({cpu->package_id, cpu->core_id}).second) {
+        primary.push_back(cpu->cpu_id);
+      } else {
+        siblings.push_back(cpu->cpu_id);
+      }
+    }
+    if (config_.use_smt_siblings) {
+      primary.insert(primary.end(), siblings.begin(), siblings.end());
+    }
+    total_cpus_ += primary.size();
+    std::vector<int> llc;
+    for (int cpu : primary) {
+      llc.push_back(topology.LastLevelCacheId(cpu));
+    }
+    node_llc_.push_back(std::move(llc));
+    node_ids_.push_back(node.first);
+    node_cpus_.push_back(std::move(primary));
+  }
+  package_count_ = static_cast<int>(packages.size());
+
+  if (total_cpus_ == 0) {
+    throw std::invalid_argument("Scheduler has no CPUs to run on");
+  }
+}
+
+double EnergyAwareScheduler::PredictDuration(const JobProfile& job, size_t cores,
+                                             uint64_t frequency_mhz) const {
+  double p = job.parallel_fraction;
+  double b = job.frequency_sensitivity;
+  double slowdown = (1.0 - b) + b * static_cast<double>(config_.reference_mhz) / frequency_mhz;
+  return job.work_seconds * ((1.0 - p) + p / static_cast<double>(cores)) * slowdown;
+}
+
+double EnergyAwareScheduler::PredictEnergy(const JobProfile& job, size_t cores,
+                                           uint64_t frequency_mhz) const {
+  double duration = PredictDuration(job, cores, frequency_mhz);
+  if (duration <= 0.0) {
+    return 0.0;
+  }
+  // Занятые ядро-секунды не зависят от числа ядер, остальное - ожидание последовательной части
+  double b = job.frequency_sensitivity;
+  double busy = job.work_seconds *
+                ((1.0 - b) + b * static_cast<double>(config_.reference_mhz) / frequency_mhz);
+  double reserved = static_cast<double>(cores) * duration;
+  double utilization = std::min(1.0, busy / reserved);
+  return reserved * config_.core_power.Power(frequency_mhz, 100.0 * utilization);
+}
+
+std::vector<EnergyAwareScheduler::Option> EnergyAwareScheduler::Options(
+    const JobProfile& job) const {
+  size_t limit = 0;
+  for (size_t i = 0; i < node_ids_.size(); ++i) {
+    if (job.numa_node < 0 || node_ids_[i] == job.numa_node) {
+      limit = std::max(limit, node_cpus_[i].size());
+    }
+  }
+  if (limit == 0) {
+    // Узла задания нет среди доступных - размещаем на любом
+    for (const auto& cpus : node_cpus_) {
+      limit = std::max(limit, cpus.size());
+    }
+  }
+  if (job.max_cores > 0) {
+    limit = std::min(limit, job.max_cores);
+  }
+
+  std::vector<size_t> core_counts;
+  for (size_t cores = 1; cores < limit; cores *= 2) {
+    core_counts.push_back(cores);
+  }
+  core_counts.push_back(limit);
+
+  std::vector<Option> options;
+  for (size_t cores : core_counts) {
+    for (uint64_t mhz : config_.frequencies_mhz) {
+      options.push_back({cores, mhz, PredictDuration(job, cores, mhz),
+                         PredictEnergy(job, cores, mhz)});
+    }
+  }
+  return options;
+}
+
+SchedulePlan EnergyAwareScheduler::Schedule(const std::vector<JobProfile>& jobs,
+                                            const std::vector<Option>& chosen) const {
+  // LPT: сначала задания с наибольшей площадью
+  std::vector<size_t> order(jobs.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&chosen](size_t a, size_t b) {
+    return chosen[a].cores * chosen[a].duration > chosen[b].cores * chosen[b].duration;
+  });
+
+  std::vector<std::vector<double>> free_at(node_cpus_.size());
+  for (size_t node = 0; node < node_cpus_.size(); ++node) {
+    free_at[node].assign(node_cpus_[node].size(), 0.0);
+  }
+
+  SchedulePlan plan;
+  double busy_core_seconds = 0.0;
+  std::vector<size_t> slots;
+  for (size_t job : order) {
+    const Option& option = chosen[job];
+    bool any_preferred = false;
+    for (size_t node = 0; node < node_ids_.size(); ++node) {
+      any_preferred |= node_ids_[node] == jobs[job].numa_node &&
+                       node_cpus_[node].size() >= option.cores;
+    }
+
+    size_t best_node = node_cpus_.size();
+    double best_start = 0.0;
+    for (size_t node = 0; node < node_cpus_.size(); ++node) {
+      if (node_cpus_[node].size() < option.cores ||
+          (any_preferred && node_ids_[node] != jobs[job].numa_node)) {
+        continue;
+      }
+      std::vector<double> sorted = free_at[node];
+      std::nth_element(sorted.begin(), sorted.begin() + (option.cores - 1), sorted.end());
+      double start = sorted[option.cores - 1];
+      if (best_node == node_cpus_.size() || start < best_start) {
+        best_node = node;
+        best_start = start;
+      }
+    }
+
+    // Свободные к best_start ядра узла; потоки задания собираются в
+    // группах LLC с наибольшим числом свободных ядер, чтобы делить кэш
+    slots.clear();
+    std::map<int, size_t> free_in_llc;
+    for (size_t i = 0; i < node_cpus_[best_node].size(); ++i) {
+      if (free_at[best_node][i] <= best_start) {
+        slots.push_back(i);
+        ++free_in_llc[node_llc_[best_node][i]];
+      }
+    }
+    const std::vector<int>& llc = node_llc_[best_node];
+    std::stable_sort(slots.begin(), slots.end(), [&](size_t a, size_t b) {
+      if (llc[a] != llc[b]) {
+        size_t free_a = free_in_llc[llc[a]];
+        size_t free_b = free_in_llc[llc[b]];
+        return free_a != free_b ? free_a > free_b : llc[a] < llc[b];
+      }
+      return free_at[best_node][a] < free_at[best_node][b];
+    });
+
+    JobPlacement placement;
+    placement.job = job;
+    placement.numa_node = node_ids_[best_node];
+    placement.frequency_mhz = option.frequency_mhz;
+    placement.start_seconds = best_start;
+    placement.duration_seconds = option.duration;
+    placement.energy_joules = option.energy;
+    for (size_t i = 0; i < option.cores; ++i) {
+      placement.cpus.push_back(node_cpus_[best_node][slots[i]]);
+      free_at[best_node][slots[i]] = best_start + option.duration;
+    }
+
+    plan.makespan_seconds = std::max(plan.makespan_seconds, best_start + option.duration);
+    plan.energy_joules += option.energy;
+    busy_core_seconds += option.cores * option.duration;
+    plan.placements.push_back(std::move(placement));
+  }
+
+  std::stable_sort(plan.placements.begin(), plan.placements.end(),
+                   [](const JobPlacement& a, const JobPlacement& b) {
+                     return a.start_seconds < b.start_seconds;
+                   });
+
+  // Простаивающие ядра и uncore до конца пакета
+  double idle_core_seconds =
+      std::max(0.0, total_cpus_ * plan.makespan_seconds - busy_core_seconds);
+  plan.energy_joules +=
+      idle_core_seconds * config_.core_power.Power(config_.frequencies_mhz.front(), 0.0) +
+      package_count_ * config_.uncore_watts * plan.makespan_seconds;
+  plan.meets_deadline = config_.deadline_seconds <= 0.0 ||
+                        plan.makespan_seconds <= config_.deadline_seconds;
+  return plan;
+}
+
+SchedulePlan EnergyAwareScheduler::Plan(const std::vector<JobProfile>& jobs) const {
+  if (jobs.empty()) {
+    return SchedulePlan();
+  }
+
+  std::vector<std::vector<Option>> options(jobs.size());
+  std::vector<Option> chosen(jobs.size());
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    options[j] = Options(jobs[j]);
+    chosen[j] = *std::min_element(options[j].begin(), options[j].end(),
+                                  [](const Option& a, const Option& b) {
+                                    return a.energy < b.energy ||
+                                           (a.energy == b.energy && a.duration < b.duration);
+                                  });
+  }
+
+  const double deadline = config_.deadline_seconds;
+  SchedulePlan fastest;
+  fastest.makespan_seconds = std::numeric_limits<double>::infinity();
+  size_t max_steps = 1;
+  for (const auto& job_options : options) {
+    max_steps += job_options.size();
+  }
+
+  for (size_t step = 0; step < max_steps; ++step) {
+    SchedulePlan plan = Schedule(jobs, chosen);
+    if (plan.meets_deadline) {
+      return plan;
+    }
+    if (plan.makespan_seconds < fastest.makespan_seconds) {
+      fastest = plan;
+    }
+
+    // Не хватает ёмкости - сокращаем площадь, иначе длительность опоздавших
+    double area = 0.0;
+    for (const Option& option : chosen) {
+      area += option.cores * option.duration;
+    }
+    std::vector<bool> late(jobs.size(), false);
+    for (const JobPlacement& placement : plan.placements) {
+      late[placement.job] = placement.start_seconds + placement.duration_seconds > deadline;
+    }
+
+    bool upgraded = false;
+    for (int pass = 0; pass < 2 && !upgraded; ++pass) {
+      bool reduce_area = (area / total_cpus_ > deadline) == (pass == 0);
+      size_t best_job = jobs.size();
+      Option best_option = {};
+      double best_price = std::numeric_limits<double>::infinity();
+      for (size_t j = 0; j < jobs.size(); ++j) {
+        if (!reduce_area && !late[j]) {
+          continue;
+        }
+        for (const Option& option : options[j]) {
+          double gain = reduce_area
+              ? chosen[j].cores * chosen[j].duration - option.cores * option.duration
+              : chosen[j].duration - option.duration;
+          if (gain <= 1e-12) {
+            continue;
+          }
+          double price = (option.energy - chosen[j].energy) / gain;
+          if (price < best_price) {
+            best_price = price;
+            best_job = j;
+            best_option = option;
+          }
+        }
+      }
+      if (best_job < jobs.size()) {
+        chosen[best_job] = best_option;
+        upgraded = true;
+      }
+    }
+    if (!upgraded) {
+      break;
+    }
+  }
+
+  SchedulePlan baseline = PlanBaseline(jobs);
+  if (baseline.meets_deadline || baseline.makespan_seconds < fastest.makespan_seconds) {
+    return baseline;
+  }
+  return fastest;
+}
+
+SchedulePlan EnergyAwareScheduler::PlanBaseline(const std::vector<JobProfile>& jobs) const {
+  std::vector<Option> chosen;
+  chosen.reserve(jobs.size());
+  for (const JobProfile& job : jobs) {
+    std::vector<Option> options = Options(job);
+    chosen.push_back(*std::min_element(options.begin(), options.end(),
+                                       [](const Option& a, const Option& b) {
+                                         return a.duration < b.duration;
+                                       }));
+  }
+  return Schedule(jobs, chosen);
+}
+
+// ============================================================================
+// PinnedWorkerPool
+// ============================================================================
+
+PinnedWorkerPool::PinnedWorkerPool(const std::vector<int>& cpus,
+                                   const std::string& sysfs_cpu_root, CpufreqControl control)
+    : control_(control), generation_(0), running_(0), restore_mhz_(0), shutdown_(false) {
+  for (int cpu : cpus) {
+    workers_.push_back(std::make_unique<Worker>(cpu, sysfs_cpu_root));
+  }
+  for (auto& worker : workers_) {
+    Worker* raw = worker.get();
+    worker->thread = std::thread([this, raw]() { WorkerLoop(*raw); });
+  }
+}
+
+PinnedWorkerPool::~PinnedWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+size_t PinnedWorkerPool::PinnedWorkers() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() {
+    return std::all_of(workers_.begin(), workers_.end(),
+                       [](const std::unique_ptr<Worker>& w) { return w->started; });
+  });
+  return static_cast<size_t>(std::count_if(
+      workers_.begin(), workers_.end(),
+      [](const std::unique_ptr<Worker>& w) { return w->pinned; }));
+}
+
+void PinnedWorkerPool::WorkerLoop(Worker& worker) {
+  bool pinned = PinCurrentThread(worker.cpu);
+  uint64_t seen_generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker.pinned = pinned;
+    worker.started = true;
+  }
+  done_cv_.notify_all();
+
+  while (true) {
+    uint64_t restore_mhz = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&]() { return shutdown_ || generation_ != seen_generation; });
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = generation_;
+      restore_mhz = restore_mhz_;
+    }
+
+    for (const Task& task : worker.tasks) {
+      if (task.frequency_mhz > 0 &&
+          !worker.actuator.SetFrequency(worker.cpu, task.frequency_mhz, control_)) {
+        ++worker.frequency_failures;
+      }
+      (*task.run)(task.shard, task.shards);
+    }
+    if (restore_mhz > 0 && !worker.tasks.empty()) {
+      worker.actuator.SetFrequency(worker.cpu, restore_mhz, control_);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --running_;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+ExecutionReport PinnedWorkerPool::Execute(const SchedulePlan& plan,
+                                          const std::vector<BatchJob>& jobs,
+                                          RaplEnergyMeter* meter, uint64_t restore_mhz) {
+  std::map<int, Worker*> by_cpu;
+  for (auto& worker : workers_) {
+    worker->tasks.clear();
+    worker->frequency_failures = 0;
+    by_cpu[worker->cpu] = worker.get();
+  }
+
+  ExecutionReport report = {};
+  for (const JobPlacement& placement : plan.placements) {
+    if (placement.job >= jobs.size()) {
+      throw std::invalid_argument("Plan refers to an unknown job");
+    }
+    for (size_t shard = 0; shard < placement.cpus.size(); ++shard) {
+      auto worker = by_cpu.find(placement.cpus[shard]);
+      if (worker == by_cpu.end()) {
+        throw std::invalid_argument("CPU " + std::to_string(placement.cpus[shard]) +
+                                    " of the plan is not in the worker pool");
+      }
+      worker->second->tasks.push_back({&jobs[placement.job].run, shard, placement.cpus.size(),
+                                       placement.frequency_mhz});
+      ++report.shards;
+    }
+  }
+
+  if (meter != nullptr) {
+    meter->Start();
+  }
+  auto started = std::chrono::steady_clock::now();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = workers_.size();
+    restore_mhz_ = restore_mhz;
+    ++generation_;
+    start_cv_.notify_all();
+    // Счётчики RAPL переполняются за минуты - опрашиваем во время выполнения
+    while (!done_cv_.wait_for(lock, std::chrono::seconds(1), [this]() { return running_ == 0; })) {
+      if (meter != nullptr) {
+        meter->Sample();
+      }
+    }
+  }
+  report.wall_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  report.energy_joules = meter != nullptr ? meter->Sample() : NAN;
+
+  for (auto& worker : workers_) {
+    report.frequency_failures += worker->frequency_failures;
+  }
+  return report;
+}
+
+// ============================================================================
+// Синтетические задания
+// ============================================================================
+
+std::vector<BatchJob> MakeSyntheticJobs(size_t count, double mean_work_seconds, uint32_t seed,
+                                        size_t stream_array_bytes) {
+  // Темп ядра на текущей частоте
+  synthetic::WorkloadRun compute = synthetic::RunCompute(0.05);
+  synthetic::WorkloadRun stream = synthetic::RunStream(0.2, stream_array_bytes);
+  double iterations_per_second = compute.iterations / compute.seconds;
+  double passes_per_second = stream.iterations / stream.seconds;
+
+  std::vector<BatchJob> jobs;
+  uint32_t state = seed != 0 ? seed : 1;
+  for (size_t i = 0; i < count; ++i) {
+    state = state * 1664525u + 1013904223u;
+    double work = mean_work_seconds * (0.5 + (state >> 8) / static_cast<double>(1u << 24));
+
+    BatchJob job;
+    job.profile.work_seconds = work;
+    if (i % 2 == 0) {
+      job.profile.name = "compute-" + std::to_string(i);
+      job.profile.parallel_fraction = 0.98;
+      job.profile.frequency_sensitivity = 1.0;
+      double total = work * iterations_per_second;
+      double serial = 1.0 - job.profile.parallel_fraction;
+      job.run = [total, serial](size_t shard, size_t shards) {
+        double share = (shard == 0 ? serial : 0.0) + (1.0 - serial) / shards;
+        synthetic::RunComputeIterations(static_cast<uint64_t>(total * share));
+      };
+    } else {
+      job.profile.name = "stream-" + std::to_string(i);
+      job.profile.parallel_fraction = 0.9;
+      job.profile.frequency_sensitivity = 0.3;
+      double total = work * passes_per_second;
+      double serial = 1.0 - job.profile.parallel_fraction;
+      job.run = [total, serial, stream_array_bytes](size_t shard, size_t shards) {
+        double share = (shard == 0 ? serial : 0.0) + (1.0 - serial) / shards;
+        synthetic::RunStreamPasses(static_cast<uint64_t>(std::ceil(total * share)),
+                                   stream_array_bytes);
+      };
+    }
+    jobs.push_back(std::move(job));
+  }
+  return jobs;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,245 @@
+#ifndef ENERGY_SCHEDULER_HPP
+#define ENERGY_SCHEDULER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cpu_topology.hpp"
+#include "cpufreq_actuator.hpp"
+#include "power_allocator.hpp"
+#include "powercap_actuator.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Профиль производительности задания
+ *
+ * Время на c ядрах при частоте f:
+ * T = work * ((1 - p) + p / c) * ((1 - b) + b * f_ref / f).
+ */
+struct JobProfile {
+  std::string name;
+  double work_seconds = 1.0;            // Время на одном ядре при reference_mhz
+  double parallel_fraction = 0.95;      // p (закон Амдала)
+  double frequency_sensitivity = 1.0;   // b: 1 - вычисления, ~0.3 - упор в память
+  size_t max_cores = 0;                 // 0 - без ограничения
+  int numa_node = -1;                   // Узел с данными задания (-1 - любой)
+};
+
+/**
+ * @brief Часть задания на одном ядре: shard из shards (shard 0 несёт последовательную часть)
+ */
+using JobShard = std::function<void(size_t shard, size_t shards)>;
+
+/**
+ * @brief Задание пакета: профиль и код
+ */
+struct BatchJob {
+  JobProfile profile;
+  JobShard run;
+};
+
+/**
+ * @brief Параметры планировщика
+ */
+struct SchedulerConfig {
+  double deadline_seconds = 0.0;        // Ограничение makespan (0 - только минимум энергии)
+  uint64_t reference_mhz = 4000;        // Частота, к которой отнесены work_seconds
+  std::vector<uint64_t> frequencies_mhz = {1000, 2000, 3000, 4000};
+  CorePowerModel core_power;            // Мощность ядра (калибруется governor'ом по RAPL)
+  double uncore_watts = 5.0;            // Мощность пакета вне ядер, всё время пакета
+  bool use_smt_siblings = false;        // Занимать ли второй поток физического ядра
+  std::vector<int> cpus;                // Доступные CPU (пусто - все)
+};
+
+/**
+ * @brief Размещение задания (прогноз модели)
+ */
+struct JobPlacement {
+  size_t job;                   // Индекс в списке заданий
+  int numa_node;
+  std::vector<int> cpus;        // Shard i выполняется на cpus[i]
+  uint64_t frequency_mhz;
+  double start_seconds;
+  double duration_seconds;
+  double energy_joules;         // Энергия ядер задания
+};
+
+/**
+ * @brief План выполнения пакета
+ */
+struct SchedulePlan {
+  std::vector<JobPlacement> placements;   // В порядке запуска
+  double makespan_seconds = 0.0;
+  double energy_joules = 0.0;             // Задания + простаивающие ядра + uncore
+  bool meets_deadline = true;
+};
+
+/**
+ * @brief Выбор числа ядер, NUMA узла и частоты каждого задания пакета
+ *
+ * Начинает с варианта минимальной энергии для каждого задания и, пока
+ * makespan больше deadline, ускоряет задания с наименьшей ценой в джоулях
+ * за выигранную секунду: если не хватает суммарной ёмкости ядер - уменьшает
+ * площадь (ядро-секунды), иначе - длительность заданий, завершающихся после
+ * deadline. Расписание строится списком (LPT) по пулам ядер NUMA узлов;
+ * задание занимает свои ядра целиком. Сначала берутся разные физические ядра.
+ */
+class EnergyAwareScheduler {
+ public:
+  /**
+   * @throws std::invalid_argument если нет доступных CPU или частот
+   */
+  EnergyAwareScheduler(const TopologySnapshot& topology, const SchedulerConfig& config);
+
+  /**
+   * @brief План минимальной энергии при makespan <= deadline
+   * @return План; meets_deadline = false если deadline недостижим (тогда - самый быстрый)
+   */
+  SchedulePlan Plan(const std::vector<JobProfile>& jobs) const;
+
+  /**
+   * @brief Базовый план "быстрее и в простой": максимум ядер на максимальной частоте
+   */
+  SchedulePlan PlanBaseline(const std::vector<JobProfile>& jobs) const;
+
+  double PredictDuration(const JobProfile& job, size_t cores, uint64_t frequency_mhz) const;
+  double PredictEnergy(const JobProfile& job, size_t cores, uint64_t frequency_mhz) const;
+
+  /**
+   * @brief Пулы ядер по узлам (индексы соответствуют NodeIds())
+   */
+  const std::vector<std::vector<int>>& NodeCpus() const { return node_cpus_; }
+  const std::vector<int>& NodeIds() const { return node_ids_; }
+
+ private:
+  struct Option {
+    size_t cores;
+    uint64_t frequency_mhz;
+    double duration;
+    double energy;
+  };
+
+  std::vector<Option> Options(const JobProfile& job) const;
+  SchedulePlan Schedule(const std::vector<JobProfile>& jobs,
+                        const std::vector<Option>& chosen) const;
+
+  SchedulerConfig config_;
+  std::vector<int> node_ids_;
+  std::vector<std::vector<int>> node_cpus_;
+  std::vector<std::vector<int>> node_llc_;   // Группа LLC каждого CPU из node_cpus_
+  size_t total_cpus_;
+  int package_count_;
+};
+
+// ============================================================================
+// Выполнение
+// ============================================================================
+
+/**
+ * @brief Итог выполнения плана
+ */
+struct ExecutionReport {
+  double wall_seconds;
+  double energy_joules;         // RAPL пакетов (NaN если недоступен)
+  size_t shards;
+  size_t frequency_failures;    // Неудачные записи частоты
+};
+
+/**
+ * @brief Пул рабочих потоков, закреплённых по одному на CPU
+ *
+ * Каждый поток держит свой CpufreqActuator и перед каждой частью задания
+ * выставляет частоту своего CPU (запись пропускается, если частота не
+ * изменилась). Части заданий выполняются в порядке плана без барьеров
+ * между заданиями.
+ */
+class PinnedWorkerPool {
+ public:
+  /**
+   * @param cpus CPU пула
+   * @param sysfs_cpu_root Корень sysfs cpu
+   * @param control Файл управления частотой
+   */
+  explicit PinnedWorkerPool(const std::vector<int>& cpus,
+                            const std::string& sysfs_cpu_root = "/sys/devices/system/cpu",
+                            CpufreqControl control = CpufreqControl::kSetSpeed);
+  ~PinnedWorkerPool();
+
+  PinnedWorkerPool(const PinnedWorkerPool&) = delete;
+  PinnedWorkerPool& operator=(const PinnedWorkerPool&) = delete;
+
+  /**
+   * @brief Выполнение плана
+   * @param plan План (все CPU плана должны быть в пуле)
+   * @param jobs Задания (индексы как в плане)
+   * @param meter Счётчик энергии (nullptr - без измерения)
+   * @param restore_mhz Частота, выставляемая после выполнения (0 - не менять)
+   * @throws std::invalid_argument если CPU плана нет в пуле
+   */
+  ExecutionReport Execute(const SchedulePlan& plan, const std::vector<BatchJob>& jobs,
+                          RaplEnergyMeter* meter, uint64_t restore_mhz = 0);
+
+  /**
+   * @brief Количество потоков, которые удалось закрепить
+   */
+  size_t PinnedWorkers();
+
+ private:
+  struct Task {
+    const JobShard* run;
+    size_t shard;
+    size_t shards;
+    uint64_t frequency_mhz;
+  };
+
+  struct Worker {
+    int cpu;
+    std::thread thread;
+    std::vector<Task> tasks;
+    CpufreqActuator actuator;
+    size_t frequency_failures = 0;
+    bool pinned = false;
+    bool started = false;
+
+    Worker(int cpu_id, const std::string& sysfs_cpu_root)
+        : cpu(cpu_id), actuator(sysfs_cpu_root) {}
+  };
+
+  void WorkerLoop(Worker& worker);
+
+  CpufreqControl control_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_;
+  size_t running_;
+  uint64_t restore_mhz_;
+  bool shutdown_;
+};
+
+/**
+ * @brief Локальные синтетические задания: вычислительные (FMA) и потоковые (triad)
+ *
+ * Темп ядер калибруется при создании на текущей частоте, поэтому
+ * reference_mhz планировщика должна быть этой частотой.
+ *
+ * @param count Количество заданий (чередуются вычислительные и потоковые)
+ * @param mean_work_seconds Средний объём задания (секунды на одном ядре)
+ * @param seed Зерно разброса объёмов (0.5-1.5 от среднего)
+ * @param stream_array_bytes Размер массивов потокового задания на ядро
+ */
+std::vector<BatchJob> MakeSyntheticJobs(size_t count, double mean_work_seconds, uint32_t seed,
+                                        size_t stream_array_bytes = 16u << 20);
+
+}  // namespace hardware_analysis
+
+#endif  // ENERGY_SCHEDULER_HPP
@@ -0,0 +1,2086 @@
+// ============================================================================
+// Stage 7: Hardware Integration
+//
+// Замыкает мониторинг (Stage 2) и оптимизацию (Stage 4) в работающие
+// на живой системе контуры управления.
+// ============================================================================
+
+#include "autotuner.hpp"
+#include "cache_simulator.hpp"
+#include "core_latency.hpp"
+#include "cpufreq_actuator.hpp"
+#include "dvfs_governor.hpp"
+#include "dvfs_simulator.hpp"
+#include "energy_scheduler.hpp"
+#include "hardware_monitor.hpp"
+#include "indirect_access.hpp"
+#include "machine_profile.hpp"
+#include "memory_benchmark.hpp"
+#include "optimization_engine.hpp"
+#include "page_tracer.hpp"
+#include "powercap_actuator.hpp"
+#include "prefetch_tuner.hpp"
+#include "roofline.hpp"
+#include "stack_distance.hpp"
+#include "stress_engine.hpp"
+#include "synthetic_workloads.hpp"
+#include "thermal_simulator.hpp"
+#include "transition_benchmark.hpp"
+#include "workload_classifier.hpp"
+#include "wss_estimator.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<bool> g_stop_requested(false);
+
+void HandleStopSignal(int) {
+  g_stop_requested.store(true);
+}
+
+void PrintUsage(const char* program) {
+  std::cout << "Usage: " << program << " <mode> [options]\n\n"
+            << "Modes:\n"
+            << "  governor   Closed-loop DVFS governor (requires root)\n"
+            << "             --interval-ms N   tick period (default 100)\n"
+            << "             --min-mhz N       lower frequency bound\n"
+            << "             --max-mhz N       upper frequency bound\n"
+            << "             --target-temp C   thermal target (default 85)\n"
+            << "             --power-limit W   package power budget shared across cores\n"
+            << "             --priority CPU=W  budget weight of a latency-critical CPU\n"
+            << "             --power-enforcement MODE  rapl (PL1 in hardware), software\n"
+            << "                               (frequency allocator) or auto (default)\n"
+            << "             --power-window S  PL1 averaging window (default 1)\n"
+            << "             --hysteresis N    minimal change in MHz (default 100)\n"
+            << "             --log PATH        decision log (CSV, '-' = stdout)\n"
+            << "             --thermal NAME    thermal controller: linear, pid (default), mpc\n"
+            << "             --profile PATH    machine profile (default: see freq-transition)\n"
+            << "             --classify        cap frequency of memory-bound CPUs (perf or\n"
+            << "                               resctrl counters)\n"
+            << "             --max-slowdown F  allowed slowdown of memory-bound phases (0.10)\n"
+            << "             --dry-run         decide without writing cpufreq\n"
+            << "  thermal-sim Score thermal controllers on a recorded governor log\n"
+            << "             --log PATH        decision log written by 'governor --log'\n"
+            << "             --target-temp C   thermal target (default 85)\n"
+            << "             --cpus LIST       CPUs of one package, e.g. 0-7 (default: all)\n"
+            << "  dvfs-sim   Sweep DVFS policy parameters over a recorded governor log\n"
+            << "             --log PATH        decision log written by 'governor --log'\n"
+            << "             --reference-mhz N frequency the log was recorded at (default: max)\n"
+            << "             --cpus LIST       CPUs of one package (default: all)\n"
+            << "             --threads N       worker threads (default: all CPUs)\n"
+            << "  cpufreq-latency Measure cpufreq write latency and time to observe (root)\n"
+            << "             --cpus LIST       CPUs to measure (default: 0)\n"
+            << "             --low-mhz N       first frequency (default: cpuinfo_min_freq)\n"
+            << "             --high-mhz N      second frequency (default: cpuinfo_max_freq)\n"
+            << "             --iterations N    transitions per CPU (default 20)\n"
+            << "             --control NAME    setspeed (default) or max (intel_pstate)\n"
+            << "  powercap   Show or set RAPL power limits (root to set)\n"
+            << "             --package N       package (default: all for show, 0 for set)\n"
+            << "             --domain NAME     package (default) or dram\n"
+            << "             --pl1 W           long-term limit\n"
+            << "             --window S        PL1 time window (default 1)\n"
+            << "             --pl2 W           short-term limit (package domain)\n"
+            << "             --window2 S       PL2 time window (default 0.01)\n"
+            << "  freq-transition Frequency transition latency benchmark (root)\n"
+            << "             --cpus LIST       CPUs to measure (default: 0)\n"
+            << "             --freqs LIST      frequencies in MHz, e.g. 1200,2400,3600\n"
+            << "                               (default: min, mid, max)\n"
+            << "             --repetitions N   transitions per pair (default 10)\n"
+            << "             --window-us N     effective frequency sample window (default 20)\n"
+            << "             --msr-root PATH   msr devices (default /dev/cpu)\n"
+            << "             --profile PATH    machine profile to update\n"
+            << "                               (default $HARDWARE_ANALYSIS_PROFILE or\n"
+            << "                               ~/.config/hardware_analysis/machine_profile.json)\n"
+            << "  classify-bench Classify synthetic compute and memory workloads\n"
+            << "             --seconds S       duration of each workload (default 1)\n"
+            << "             --array-mb N      stream array size (default 64)\n"
+            << "  batch-schedule Energy-aware schedule of synthetic batch jobs (root for\n"
+            << "             DVFS and RAPL)\n"
+            << "             --jobs N          number of jobs (default 8)\n"
+            << "             --work S          mean single-core work per job (default 0.5)\n"
+            << "             --deadline S      makespan limit (default 1.5x baseline)\n"
+            << "             --cpus LIST       CPUs to use (default: all)\n"
+            << "             --freqs LIST      frequency levels in MHz (default: min, mid, max)\n"
+            << "             --control NAME    setspeed (default) or max (intel_pstate)\n"
+            << "             --seed N          job size seed (default 1)\n"
+            << "             --no-baseline     skip the max-cores/max-frequency baseline run\n"
+            << "  prefetch-tune Tune software prefetch distance and locality hint\n"
+            << "             --patterns LIST   sequential,strided,indirect (default: all)\n"
+            << "             --array-mb N      working set, larger than LLC (default 64)\n"
+            << "             --repetitions N   runs per candidate, best kept (default 3)\n"
+            << "             --profile PATH    machine profile to update (see freq-transition)\n"
+            << "             --dry-run         do not update the profile\n"
+            << "  indirect-bench Random-index gather and hash probe microbenchmark\n"
+            << "             --table-mb N      table size, larger than LLC (default 256)\n"
+            << "             --lookups N       random lookups per run (default 4194304)\n"
+            << "             --distance N      gather prefetch distance (default: tuned\n"
+            << "                               indirect distance from the profile, else 16)\n"
+            << "             --group N         hash probe batch size (default 16)\n"
+            << "             --profile PATH    machine profile (default: see freq-transition)\n"
+            << "  autotune   Tune OptimizationEngine kernels (grid + local refinement)\n"
+            << "             --kernels LIST    gemm,reduction (default: all)\n"
+            << "             --gemm-n N        GEMM matrix size (default 384)\n"
+            << "             --reduce-mb N     reduction array size (default 128)\n"
+            << "             --repetitions N   measured runs per point, median kept (default 5)\n"
+            << "             --max-evals N     points per kernel (default 256)\n"
+            << "             --profile PATH    machine profile to update (see freq-transition)\n"
+            << "             --dry-run         do not update the profile\n"
+            << "  cache-topology Show cache sizes, geometry and CPUs sharing each cache\n"
+            << "  memory-bench Latency, bandwidth, stride and TLB reach of the memory system\n"
+            << "             --suites LIST     latency,bandwidth,stride,tlb (default: all)\n"
+            << "             --cpu N           CPU of single-threaded tests (default 0)\n"
+            << "             --cpus LIST       bandwidth threads, one per CPU (default: --cpu)\n"
+            << "             --node N          bind buffers to NUMA node (default: first touch)\n"
+            << "             --max-ws-mb N     largest latency working set (default 256)\n"
+            << "             --json PATH       write Google Benchmark JSON ('-' = stdout)\n"
+            << "  memory-saturation Bandwidth and loaded latency vs thread count per NUMA node\n"
+            << "             --nodes LIST      NUMA nodes to sweep (default: all)\n"
+            << "             --kinds LIST      read,write,mixed (default: all)\n"
+            << "             --max-threads N   largest thread count (default: CPUs of the node)\n"
+            << "             --seconds S       duration of one point (default 0.2)\n"
+            << "             --json PATH       write Google Benchmark JSON ('-' = stdout)\n"
+            << "             --profile PATH    machine profile to update (see freq-transition)\n"
+            << "             --dry-run         do not update the profile\n"
+            << "  core-latency Cache-line ping-pong latency between every pair of CPUs\n"
+            << "             --cpus LIST       CPUs to measure (default: all)\n"
+            << "             --round-trips N   round trips per sample (default 4000)\n"
+            << "             --samples N       samples per pair, median kept (default 5)\n"
+            << "             --serial          measure one pair at a time\n"
+            << "             --profile PATH    machine profile to update (see freq-transition)\n"
+            << "             --dry-run         do not update the profile\n"
+            << "  roofline     Measured FMA peaks, L1..DRAM bandwidth and engine kernels on them\n"
+            << "             --cpu N           CPU of single-threaded tests (default 0)\n"
+            << "             --gemm-n N        GEMM matrix size (default 512)\n"
+            << "             --reduce-mb N     reduction array size (default 256)\n"
+            << "             --json PATH       write roofline JSON ('-' = stdout)\n"
+            << "             --profile PATH    tuned kernel parameters (see autotune)\n"
+            << "  stress       Phased synthetic load with its own throughput counters\n"
+            << "             --phase SPEC      kind:seconds[:duty[:period_ms]], repeatable;\n"
+            << "                               kind = compute|stream|chase|mixed|idle\n"
+            << "                               (default compute:10)\n"
+            << "             --cpus LIST       one pinned thread per CPU (default 0)\n"
+            << "             --node N          bind buffers to NUMA node (default: first touch)\n"
+            << "             --ws-mb N         working set per thread (default 64)\n"
+            << "             --fma N           FMAs per element in mixed phases (default 8)\n"
+            << "             --cycles N        repeat the phase sequence (default 1)\n"
+            << "             --interval-ms N   counter report interval (default 500)\n"
+            << "  cache-sim    Replay a binary memory trace through a cache hierarchy\n"
+            << "             --trace PATH      trace file (stage5_cache_simulator.write_trace)\n"
+            << "             --levels SPEC     size:ways[:policy],... (default: this machine)\n"
+            << "             --policy P        lru|fifo|lfu|random (default lru)\n"
+            << "             --scalar          disable SIMD tag compare\n"
+            << "             --prefetch SPEC   hardware prefetcher KIND[:N][@LEVEL], repeatable;\n"
+            << "                               next-line[:degree], stride[:degree] (needs pc),\n"
+            << "                               stream[:distance]; LEVEL 1 = L1 (default)\n"
+            << "             --prefetch-latency N  records before a prefetched line arrives\n"
+            << "  mrc          LRU miss-ratio curve of a trace for every cache size (one pass)\n"
+            << "             --trace PATH      trace file (stage5_cache_simulator.write_trace)\n"
+            << "             --shards N        address-space shards, approximate when > 1\n"
+            << "                               (default 1 = exact)\n"
+            << "             --threads N       threads for the shards (default: all CPUs)\n"
+            << "             --line B          line size in bytes (default 64)\n"
+            << "             --target R        also report the capacity for miss ratio R\n"
+            << "             --json PATH       write the curve as JSON ('-' = stdout)\n"
+            << "             --rate R          SHARDS: sample a fraction R of the lines\n"
+            << "             --max-samples N   SHARDS: keep at most N sampled lines (constant\n"
+            << "                               memory, the rate shrinks as needed)\n"
+            << "             --adjust          SHARDS_adj correction of the sample count\n"
+            << "             --validate        compare a sampled curve with the exact one\n"
+            << "  page-trace   Record the page-level access stream of a live process\n"
+            << "             --pid PID         process to trace\n"
+            << "             --out PATH        trace file (for cache-sim / mrc --line 4096)\n"
+            << "             --tracking T      idle (reads+writes, root) | soft-dirty (writes)\n"
+            << "             --interval MS     pause between scans (default 100)\n"
+            << "             --duration S      stop after S seconds (default: Ctrl+C)\n"
+            << "             --max-pages N     pages checked per scan (default 262144)\n"
+            << "             --max-cpu F       cap tracer CPU share, stretching pauses (0.05)\n"
+            << "             --min-region B    skip mappings smaller than B bytes\n"
+            << "             --anon-only       trace anonymous memory only\n"
+            << "             --log             print one line per scan\n"
+            << "  wss          Working-set size of processes over time (page_idle/clear_refs)\n"
+            << "             --pid PID         process to watch (repeatable)\n"
+            << "             --tracking T      idle (default) | soft-dirty (write set only)\n"
+            << "             --interval MS     pause between scans (default 1000)\n"
+            << "             --duration S      stop after S seconds (default: Ctrl+C)\n"
+            << "             --max-pages N     pages checked per scan (default 262144)\n"
+            << "             --csv PATH        write the WSS curve as CSV ('-' = stdout)\n";
+}
+
+/**
+ * @brief Частота из cpufreq cpu0 (kHz -> MHz) или значение по умолчанию
+ */
+uint64_t ReadCpufreqMhz(const std::string& name, uint64_t fallback) {
+  try {
+    return hardware_analysis::utils::ReadSysfsU64(
+        "/sys/devices/system/cpu/cpu0/cpufreq/" + name) / 1000;
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+
+/**
+ * @brief Список частот в МГц через запятую, например "1200,2400,3600"
+ *
+ * Диапазоны, как в списках CPU, не принимаются: "1200-3600" дал бы
+ * 2401 частоту вместо двух.
+ * @throws std::invalid_argument при пустом списке, диапазоне или частоте <= 0
+ */
+std::vector<uint64_t> ParseMhzList(const std::string& list) {
+  std::vector<uint64_t> frequencies;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    char* end = nullptr;
+    long long mhz = std::strtoll(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0' || mhz <= 0) {
+      throw std::invalid_argument("--freqs needs comma-separated positive MHz values, got '" +
+                                  item + "'");
+    }
+    frequencies.push_back(static_cast<uint64_t>(mhz));
+  }
+  if (frequencies.empty()) {
+    throw std::invalid_argument("--freqs needs at least one frequency");
+  }
+  return frequencies;
+}
+
+int RunGovernor(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  GovernorConfig config;
+  config.dvfs.min_frequency_mhz = ReadCpufreqMhz("cpuinfo_min_freq", 1000);
+  config.dvfs.max_frequency_mhz = ReadCpufreqMhz("cpuinfo_max_freq", 4000);
+  std::string log_path;
+  std::string profile_path = MachineProfile::DefaultPath();
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--dry-run") {
+      config.dry_run = true;
+    } else if (arg == "--interval-ms" && has_value) {
+      config.tick_interval_ms = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--min-mhz" && has_value) {
+      config.dvfs.min_frequency_mhz = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--max-mhz" && has_value) {
+      config.dvfs.max_frequency_mhz = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--target-temp" && has_value) {
+      config.dvfs.target_temperature_celsius = std::atof(argv[++i]);
+    } else if (arg == "--power-limit" && has_value) {
+      config.dvfs.power_limit_watts = std::atof(argv[++i]);
+    } else if (arg == "--priority" && has_value) {
+      std::string spec = argv[++i];
+      size_t eq = spec.find('=');
+      if (eq == std::string::npos) {
+        std::cerr << "Invalid --priority (expected CPU=WEIGHT): " << spec << "\n";
+        return 1;
+      }
+      config.cpu_priority[std::atoi(spec.substr(0, eq).c_str())] =
+          std::atof(spec.c_str() + eq + 1);
+    } else if (arg == "--hysteresis" && has_value) {
+      config.hysteresis_mhz = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--thermal" && has_value) {
+      config.thermal_controller = argv[++i];
+    } else if (arg == "--power-enforcement" && has_value) {
+      config.power_enforcement = argv[++i];
+    } else if (arg == "--power-window" && has_value) {
+      config.power_window_seconds = std::atof(argv[++i]);
+    } else if (arg == "--log" && has_value) {
+      log_path = argv[++i];
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else if (arg == "--classify") {
+      config.classify_workload = true;
+    } else if (arg == "--max-slowdown" && has_value) {
+      config.classifier.max_slowdown = std::atof(argv[++i]);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Тик короче установления частоты только дёргает cpufreq
+  try {
+    MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+    uint64_t min_interval_ms =
+        profile.Get<uint64_t>("frequency_transition.min_governor_interval_ms", 0);
+    if (min_interval_ms > config.tick_interval_ms) {
+      std::cerr << "Warning: tick " << config.tick_interval_ms << " ms is shorter than the "
+                << "measured frequency transition time, using " << min_interval_ms << " ms\n";
+      config.tick_interval_ms = min_interval_ms;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Warning: " << e.what() << "\n";
+  }
+
+  std::ofstream log_file;
+  std::ostream* log = nullptr;
+  if (log_path == "-") {
+    log = &std::cout;
+  } else if (!log_path.empty()) {
+    log_file.open(log_path);
+    if (!log_file.is_open()) {
+      std::cerr << "Failed to open log " << log_path << "\n";
+      return 1;
+    }
+    log = &log_file;
+  }
+
+  std::signal(SIGINT, HandleStopSignal);
+  std::signal(SIGTERM, HandleStopSignal);
+
+  OptimizationEngine engine;
+  DvfsGovernor governor(engine, config);
+  std::cerr << "DVFS governor: " << governor.GetTopology().cpus.size() << " CPUs, "
+            << config.dvfs.min_frequency_mhz << "-" << config.dvfs.max_frequency_mhz
+            << " MHz, tick " << config.tick_interval_ms << " ms"
+            << (config.dry_run ? " (dry run)" : "") << "\n";
+
+  governor.Run(g_stop_requested, log);
+  return 0;
+}
+
+int RunThermalSimulation(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  std::string log_path;
+  double target_celsius = 85.0;
+  std::vector<int> cpus;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--log" && has_value) {
+      log_path = argv[++i];
+    } else if (arg == "--target-temp" && has_value) {
+      target_celsius = std::atof(argv[++i]);
+    } else if (arg == "--cpus" && has_value) {
+      cpus = utils::ParseCpuList(argv[++i]);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (log_path.empty()) {
+    std::cerr << "thermal-sim requires --log PATH\n";
+    return 1;
+  }
+
+  std::vector<ThermalTracePoint> trace = ThermalSimulator::LoadGovernorLog(log_path, cpus);
+  ThermalSimulator simulator = ThermalSimulator::FromTrace(trace);
+  const RcThermalModel& plant = simulator.GetPlant();
+  std::cout << "Trace: " << trace.size() << " ticks, RC model: T_amb "
+            << plant.ambient_celsius << " C, R " << plant.resistance_c_per_watt
+            << " C/W, tau " << plant.time_constant_seconds << " s\n\n";
+
+  std::cout << std::left << std::setw(10) << "controller" << std::right
+            << std::setw(14) << "overshoot_C" << std::setw(14) << "over_C*s"
+            << std::setw(14) << "oscillation" << std::setw(11) << "reversals"
+            << std::setw(12) << "lost_perf" << "\n";
+  for (const char* name : {"linear", "pid", "mpc"}) {
+    auto controller = MakeThermalController(name);
+    ThermalScore score = simulator.Run(*controller, trace, target_celsius);
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(14) << score.max_overshoot_celsius
+              << std::setw(14) << score.overshoot_integral << std::setw(14)
+              << score.oscillation << std::setw(11) << score.reversals
+              << std::setw(11) << score.lost_performance * 100.0 << "%\n";
+  }
+  return 0;
+}
+
+int RunDvfsSimulation(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  std::string log_path;
+  uint64_t max_mhz = ReadCpufreqMhz("cpuinfo_max_freq", 4000);
+  uint64_t min_mhz = ReadCpufreqMhz("cpuinfo_min_freq", 800);
+  uint64_t reference_mhz = max_mhz;
+  std::vector<int> cpus;
+  size_t threads = 0;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--log" && has_value) {
+      log_path = argv[++i];
+    } else if (arg == "--reference-mhz" && has_value) {
+      reference_mhz = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--cpus" && has_value) {
+      cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--threads" && has_value) {
+      threads = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (log_path.empty()) {
+    std::cerr << "dvfs-sim requires --log PATH\n";
+    return 1;
+  }
+
+  std::vector<ThermalTracePoint> trace = ThermalSimulator::LoadGovernorLog(log_path, cpus);
+  DvfsSimulator simulator = DvfsSimulator::FromTrace(trace, reference_mhz);
+
+  // Политика CalculateOptimalFrequency на сетке параметров + базовые линии
+  OptimizationEngine engine;
+  DvfsPolicy load_linear = [&engine](double load, double temperature, const DVFSConfig& c) {
+    return engine.CalculateOptimalFrequency(load, temperature, c);
+  };
+  DvfsPolicy fixed_max = [](double, double, const DVFSConfig& c) {
+    return c.max_frequency_mhz;
+  };
+
+  std::vector<PolicyCandidate> candidates;
+  candidates.push_back({"performance", fixed_max, {min_mhz, max_mhz, 85.0, 0.0}});
+  candidates.push_back({"powersave", fixed_max, {min_mhz, min_mhz, 85.0, 0.0}});
+  for (uint64_t low = min_mhz; low < max_mhz; low += 200) {
+    for (uint64_t high = low + 200; high <= max_mhz; high += 200) {
+      for (double target = 65.0; target <= 95.0; target += 5.0) {
+        candidates.push_back({"load-linear", load_linear, {low, high, target, 0.0}});
+      }
+    }
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  std::vector<SimulationResult> results = simulator.Sweep(candidates, threads);
+  double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - started).count();
+  std::cout << candidates.size() << " configurations x " << simulator.TraceSize()
+            << " ticks simulated in " << std::fixed << std::setprecision(2) << seconds
+            << " s\n\nEnergy/throughput Pareto front (no thermal violations):\n";
+
+  std::cout << std::left << std::setw(13) << "policy" << std::right << std::setw(8) << "min"
+            << std::setw(8) << "max" << std::setw(8) << "target" << std::setw(14) << "energy_kJ"
+            << std::setw(10) << "avg_W" << std::setw(13) << "throughput" << "\n";
+  for (size_t index : DvfsSimulator::ParetoFront(results)) {
+    const SimulationResult& r = results[index];
+    std::cout << std::left << std::setw(13) << r.name << std::right
+              << std::setw(8) << r.config.min_frequency_mhz
+              << std::setw(8) << r.config.max_frequency_mhz << std::setw(8)
+              << std::setprecision(0) << r.config.target_temperature_celsius
+              << std::setw(14) << std::setprecision(2) << r.energy_joules / 1000.0
+              << std::setw(10) << r.average_power_watts << std::setw(12)
+              << r.throughput * 100.0 << "%\n";
+  }
+  return 0;
+}
+
+int RunCpufreqLatency(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  std::vector<int> cpus = {0};
+  uint64_t low_mhz = ReadCpufreqMhz("cpuinfo_min_freq", 800);
+  uint64_t high_mhz = ReadCpufreqMhz("cpuinfo_max_freq", 4000);
+  size_t iterations = 20;
+  CpufreqControl control = CpufreqControl::kSetSpeed;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--cpus" && has_value) {
+      cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--low-mhz" && has_value) {
+      low_mhz = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--high-mhz" && has_value) {
+      high_mhz = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--iterations" && has_value) {
+      iterations = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--control" && has_value) {
+      std::string name = argv[++i];
+      if (name != "setspeed" && name != "max") {
+        std::cerr << "Unknown control: " << name << "\n";
+        return 1;
+      }
+      control = name == "max" ? CpufreqControl::kMaxFrequency : CpufreqControl::kSetSpeed;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  CpufreqActuator actuator;
+  std::cout << std::left << std::setw(6) << "cpu" << std::right << std::setw(14)
+            << "write_avg_us" << std::setw(14) << "write_max_us" << std::setw(14)
+            << "observe_avg_us" << std::setw(10) << "observed" << "\n";
+
+  for (int cpu : cpus) {
+    actuator.ResetStats();
+    int64_t observe_total_us = 0;
+    size_t observed = 0;
+    for (size_t k = 0; k < iterations; ++k) {
+      uint64_t target = k % 2 == 0 ? low_mhz : high_mhz;
+      int64_t elapsed_us = actuator.MeasureTimeToObserve(cpu, target, 50, 100000, control);
+      if (elapsed_us >= 0) {
+        observe_total_us += elapsed_us;
+        ++observed;
+      }
+    }
+    if (control == CpufreqControl::kMaxFrequency) {
+      actuator.SetFrequency(cpu, high_mhz, control);   // Вернуть полный диапазон
+    }
+
+    const ActuatorStats& stats = actuator.GetStats();
+    std::cout << std::left << std::setw(6) << cpu << std::right << std::fixed
+              << std::setprecision(1) << std::setw(14)
+              << (stats.writes ? stats.total_write_ns / 1000.0 / stats.writes : 0.0)
+              << std::setw(14) << stats.max_write_ns / 1000.0 << std::setw(14)
+              << (observed ? static_cast<double>(observe_total_us) / observed : 0.0)
+              << std::setw(7) << observed << "/" << std::left << iterations
+              << (stats.failures ? "  (write failures)" : "") << "\n";
+  }
+  return 0;
+}
+
+/**
+ * @brief Первый CPU каждого пакета (для MSR доступа к RAPL)
+ */
+std::vector<int> PackageMsrCpus(const hardware_analysis::TopologySnapshot& topology) {
+  std::vector<int> cpus(topology.package_count, -1);
+  for (int package = 0; package < topology.package_count; ++package) {
+    std::vector<int> package_cpus = topology.PackageCpus(package);
+    if (!package_cpus.empty()) {
+      cpus[package] = package_cpus.front();
+    }
+  }
+  return cpus;
+}
+
+void PrintPowerLimit(const char* label, const hardware_analysis::PowerLimit& limit) {
+  std::cout << "  " << label << ": " << std::fixed << std::setprecision(3) << limit.watts
+            << " W / " << limit.time_window_seconds << " s"
+            << (limit.enabled ? "" : " (disabled)") << "\n";
+}
+
+int RunPowercap(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  int package = -1;
+  RaplDomain domain = RaplDomain::kPackage;
+  RaplLimits requested;
+  bool set_pl1 = false;
+  requested.long_term = {0.0, 1.0, true};
+  requested.short_term = {0.0, 0.01, true};
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--package" && has_value) {
+      package = std::atoi(argv[++i]);
+    } else if (arg == "--domain" && has_value) {
+      std::string name = argv[++i];
+      if (name != "package" && name != "dram") {
+        std::cerr << "Unknown domain: " << name << "\n";
+        return 1;
+      }
+      domain = name == "dram" ? RaplDomain::kDram : RaplDomain::kPackage;
+    } else if (arg == "--pl1" && has_value) {
+      requested.long_term.watts = std::atof(argv[++i]);
+      set_pl1 = true;
+    } else if (arg == "--window" && has_value) {
+      requested.long_term.time_window_seconds = std::atof(argv[++i]);
+    } else if (arg == "--pl2" && has_value) {
+      requested.short_term.watts = std::atof(argv[++i]);
+      requested.has_short_term = true;
+    } else if (arg == "--window2" && has_value) {
+      requested.short_term.time_window_seconds = std::atof(argv[++i]);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  PowercapActuator actuator("/sys/class/powercap", "/dev/cpu",
+                            PackageMsrCpus(TopologySnapshot::Read()));
+
+  if (set_pl1 || requested.has_short_term) {
+    package = std::max(package, 0);
+    RaplLimits limits;
+    if (!actuator.ReadLimits(package, domain, &limits)) {
+      std::cerr << "No RAPL domain for package " << package << "\n";
+      return 1;
+    }
+    if (set_pl1) {
+      limits.long_term = requested.long_term;
+    }
+    limits.has_short_term = requested.has_short_term;
+    limits.short_term = requested.short_term;
+    if (!actuator.SetLimits(package, domain, limits)) {
+      return 1;
+    }
+  }
+
+  const char* domain_name = domain == RaplDomain::kDram ? "dram" : "package";
+  std::vector<int> packages = package >= 0 ? std::vector<int>{package} : actuator.Packages();
+  if (packages.empty()) {
+    std::cout << "No RAPL domains found (powercap driver or msr module required)\n";
+  }
+  for (int id : packages) {
+    RaplLimits limits;
+    if (!actuator.ReadLimits(id, domain, &limits)) {
+      std::cout << "package " << id << ": no RAPL " << domain_name << " domain\n";
+      continue;
+    }
+    std::cout << "package " << id << " (" << actuator.Backend(id, domain) << ")"
+              << (limits.locked ? " [locked]" : "") << "\n";
+    PrintPowerLimit("PL1", limits.long_term);
+    if (limits.has_short_term) {
+      PrintPowerLimit("PL2", limits.short_term);
+    }
+  }
+  return 0;
+}
+
+int RunTransitionBenchmark(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  TransitionBenchmarkConfig config;
+  std::string profile_path = MachineProfile::DefaultPath();
+  std::string msr_root = "/dev/cpu";
+  uint64_t window_us = 20;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--cpus" && has_value) {
+      config.cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--freqs" && has_value) {
+      config.frequencies_mhz = ParseMhzList(argv[++i]);
+    } else if (arg == "--repetitions" && has_value) {
+      config.repetitions = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--window-us" && has_value) {
+      window_us = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--msr-root" && has_value) {
+      msr_root = argv[++i];
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (config.frequencies_mhz.empty()) {
+    uint64_t min_mhz = ReadCpufreqMhz("cpuinfo_min_freq", 800);
+    uint64_t max_mhz = ReadCpufreqMhz("cpuinfo_max_freq", 4000);
+    config.frequencies_mhz = {min_mhz, (min_mhz + max_mhz) / 200 * 100, max_mhz};
+  }
+
+  OptimizationEngine engine;
+  TransitionBenchmark benchmark(engine, TransitionBenchmark::DefaultProbes(msr_root, window_us),
+                                config);
+  std::vector<TransitionResult> results = benchmark.Run();
+
+  std::cout << std::left << std::setw(6) << "cpu" << std::right << std::setw(8) << "from"
+            << std::setw(8) << "to" << std::setw(30) << "latency_us p50/p90/p99/max"
+            << std::setw(10) << "timeouts" << "\n";
+  for (const auto& r : results) {
+    std::cout << std::left << std::setw(6) << r.cpu_id << std::right << std::setw(8)
+              << r.from_mhz << std::setw(8) << r.to_mhz << std::setw(30)
+              << (r.latency_us.count ? r.latency_us.Format() : "-")
+              << std::setw(7) << r.timeouts << "/" << std::left << config.repetitions << "\n";
+  }
+
+  MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+  TransitionBenchmark::StoreInProfile(results, profile);
+  profile.Save(profile_path);
+  std::cout << "\nProfile for '" << profile.GetCpuModel() << "' updated: " << profile_path
+            << " (min governor interval "
+            << profile.Get<uint64_t>("frequency_transition.min_governor_interval_ms", 0)
+            << " ms)\n";
+  return 0;
+}
+
+std::string FormatFeature(double value, int precision) {
+  if (!std::isfinite(value)) {
+    return "n/a";
+  }
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(precision) << value;
+  return out.str();
+}
+
+int RunClassifyBench(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  double seconds = 1.0;
+  size_t array_mb = 64;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--seconds" && has_value) {
+      seconds = std::atof(argv[++i]);
+    } else if (arg == "--array-mb" && has_value) {
+      array_mb = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Счётчики только этого потока: не требуют perf_event_paranoid <= 0
+  std::unique_ptr<WorkloadCounterSource> source;
+  try {
+    source = std::make_unique<PerfEventCounterSource>(std::vector<int>{0}, 0);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+
+  WorkloadClassifier classifier;
+  std::vector<PhaseFeatures> features(1, PhaseFeatures::Unknown());
+  source->Sample(features);
+
+  std::cout << std::left << std::setw(10) << "workload" << std::right << std::setw(10) << "GIPS"
+            << std::setw(8) << "IPC" << std::setw(10) << "LLC MPKI" << std::setw(8) << "stall"
+            << std::setw(10) << "GB/s" << std::setw(10) << "phase" << std::setw(8) << "cap"
+            << "\n";
+  for (const char* name : {"compute", "stream"}) {
+    synthetic::WorkloadRun run = std::string(name) == "compute"
+        ? synthetic::RunCompute(seconds)
+        : synthetic::RunStream(seconds, array_mb << 20);
+    source->Sample(features);
+
+    const PhaseFeatures& f = features[0];
+    WorkloadPhase phase = classifier.Classify(f);
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(10)
+              << FormatFeature(f.instructions_per_second / 1e9, 2) << std::setw(8)
+              << FormatFeature(f.ipc, 2) << std::setw(10) << FormatFeature(f.llc_mpki, 2)
+              << std::setw(8) << FormatFeature(f.stall_ratio, 2) << std::setw(10)
+              << FormatFeature(run.bytes / run.seconds / 1e9, 2) << std::setw(10)
+              << WorkloadPhaseName(phase) << std::setw(8)
+              << FormatFeature(classifier.FrequencyScale(phase, f), 2) << "\n";
+  }
+  return 0;
+}
+
+void PrintExecution(const char* label, const hardware_analysis::SchedulePlan& plan,
+                    const hardware_analysis::ExecutionReport& report) {
+  std::cout << std::left << std::setw(10) << label << std::right << std::fixed
+            << std::setprecision(2) << std::setw(12) << plan.makespan_seconds << std::setw(12)
+            << report.wall_seconds << std::setw(12) << plan.energy_joules << std::setw(12)
+            << (std::isfinite(report.energy_joules) ? FormatFeature(report.energy_joules, 2)
+                                                    : "n/a")
+            << (report.frequency_failures ? "  (frequency not applied)" : "") << "\n";
+}
+
+int RunBatchSchedule(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  size_t job_count = 8;
+  double work_seconds = 0.5;
+  uint32_t seed = 1;
+  bool run_baseline = true;
+  CpufreqControl control = CpufreqControl::kSetSpeed;
+  SchedulerConfig config;
+  config.reference_mhz = ReadCpufreqMhz("cpuinfo_max_freq", 4000);
+  uint64_t min_mhz = ReadCpufreqMhz("cpuinfo_min_freq", config.reference_mhz / 2);
+  config.frequencies_mhz = {min_mhz, (min_mhz + config.reference_mhz) / 200 * 100,
+                            config.reference_mhz};
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--jobs" && has_value) {
+      job_count = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--work" && has_value) {
+      work_seconds = std::atof(argv[++i]);
+    } else if (arg == "--deadline" && has_value) {
+      config.deadline_seconds = std::atof(argv[++i]);
+    } else if (arg == "--cpus" && has_value) {
+      config.cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--freqs" && has_value) {
+      config.frequencies_mhz = ParseMhzList(argv[++i]);
+    } else if (arg == "--control" && has_value) {
+      std::string name = argv[++i];
+      if (name != "setspeed" && name != "max") {
+        std::cerr << "Unknown control: " << name << "\n";
+        return 1;
+      }
+      control = name == "max" ? CpufreqControl::kMaxFrequency : CpufreqControl::kSetSpeed;
+    } else if (arg == "--seed" && has_value) {
+      seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--no-baseline") {
+      run_baseline = false;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  TopologySnapshot topology = TopologySnapshot::Read();
+  std::vector<BatchJob> jobs = MakeSyntheticJobs(job_count, work_seconds, seed);
+  std::vector<JobProfile> profiles;
+  for (const auto& job : jobs) {
+    profiles.push_back(job.profile);
+  }
+
+  EnergyAwareScheduler baseline_scheduler(topology, config);
+  SchedulePlan baseline = baseline_scheduler.PlanBaseline(profiles);
+  if (config.deadline_seconds <= 0.0) {
+    config.deadline_seconds = 1.5 * baseline.makespan_seconds;
+  }
+  EnergyAwareScheduler scheduler(topology, config);
+  SchedulePlan plan = scheduler.Plan(profiles);
+
+  std::cout << "Deadline " << std::fixed << std::setprecision(2) << config.deadline_seconds
+            << " s" << (plan.meets_deadline ? "" : " (not reachable, fastest plan used)")
+            << "\n\n"
+            << std::left << std::setw(12) << "job" << std::right << std::setw(6) << "node"
+            << std::setw(7) << "cores" << std::setw(8) << "MHz" << std::setw(10) << "start_s"
+            << std::setw(10) << "time_s" << std::setw(10) << "energy_J" << "\n";
+  for (const auto& placement : plan.placements) {
+    std::cout << std::left << std::setw(12) << profiles[placement.job].name << std::right
+              << std::setw(6) << placement.numa_node << std::setw(7) << placement.cpus.size()
+              << std::setw(8) << placement.frequency_mhz << std::setw(10)
+              << placement.start_seconds << std::setw(10) << placement.duration_seconds
+              << std::setw(10) << placement.energy_joules << "\n";
+  }
+
+  std::vector<int> pool_cpus;
+  for (const auto& node : scheduler.NodeCpus()) {
+    pool_cpus.insert(pool_cpus.end(), node.begin(), node.end());
+  }
+  PinnedWorkerPool pool(pool_cpus, "/sys/devices/system/cpu", control);
+  if (pool.PinnedWorkers() < pool_cpus.size()) {
+    std::cerr << "Warning: only " << pool.PinnedWorkers() << " of " << pool_cpus.size()
+              << " workers could be pinned\n";
+  }
+  RaplEnergyMeter meter("/sys/class/powercap", "/dev/cpu", PackageMsrCpus(topology));
+  RaplEnergyMeter* energy = meter.IsAvailable() ? &meter : nullptr;
+
+  std::cout << "\n" << std::left << std::setw(10) << "run" << std::right << std::setw(12)
+            << "model_s" << std::setw(12) << "wall_s" << std::setw(12) << "model_J"
+            << std::setw(12) << "RAPL_J" << "\n";
+  if (run_baseline) {
+    PrintExecution("baseline", baseline,
+                   pool.Execute(baseline, jobs, energy, config.reference_mhz));
+  }
+  PrintExecution("planned", plan, pool.Execute(plan, jobs, energy, config.reference_mhz));
+  if (energy == nullptr) {
+    std::cout << "RAPL energy counters unavailable (powercap or msr access required)\n";
+  }
+  return 0;
+}
+
+int RunPrefetchTune(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  PrefetchTunerConfig config;
+  std::vector<AccessPattern> patterns = {AccessPattern::kSequential, AccessPattern::kStrided,
+                                         AccessPattern::kIndirect};
+  std::string profile_path = MachineProfile::DefaultPath();
+  bool dry_run = false;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--patterns" && has_value) {
+      patterns.clear();
+      std::stringstream list(argv[++i]);
+      std::string name;
+      while (std::getline(list, name, ',')) {
+        AccessPattern pattern = AccessPattern::kCount;
+        for (size_t p = 0; p < static_cast<size_t>(AccessPattern::kCount); ++p) {
+          if (name == AccessPatternName(static_cast<AccessPattern>(p))) {
+            pattern = static_cast<AccessPattern>(p);
+          }
+        }
+        if (pattern == AccessPattern::kCount) {
+          std::cerr << "Unknown pattern: " << name << "\n";
+          return 1;
+        }
+        patterns.push_back(pattern);
+      }
+    } else if (arg == "--array-mb" && has_value) {
+      config.array_bytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+    } else if (arg == "--repetitions" && has_value) {
+      config.repetitions = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else if (arg == "--dry-run") {
+      dry_run = true;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+  PrefetchTuner tuner(config);
+  std::cout << std::left << std::setw(12) << "pattern" << std::right << std::setw(14)
+            << "no_pf_GB/s" << std::setw(14) << "before_GB/s" << std::setw(14) << "tuned_GB/s"
+            << std::setw(10) << "distance" << std::setw(6) << "hint" << "\n";
+  for (AccessPattern pattern : patterns) {
+    PrefetchTuneResult result = tuner.TuneScale(pattern);
+    std::cout << std::left << std::setw(12) << AccessPatternName(pattern) << std::right
+              << std::fixed << std::setprecision(2) << std::setw(14) << result.no_prefetch_gbs
+              << std::setw(14) << result.before_gbs << std::setw(14) << result.tuned_gbs
+              << std::setw(10) << result.best.distance << std::setw(6) << result.best.hint
+              << (result.best.Enabled() ? "" : "  (prefetch off)") << "\n";
+    PrefetchTuner::StoreInProfile(result, profile);
+  }
+
+  if (!dry_run) {
+    profile.Save(profile_path);
+    std::cout << "\nProfile for '" << profile.GetCpuModel() << "' updated: " << profile_path
+              << "\n";
+  }
+  return 0;
+}
+
+int RunIndirectBench(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  IndirectBenchConfig config;
+  std::string profile_path = MachineProfile::DefaultPath();
+  bool distance_set = false;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--table-mb" && has_value) {
+      config.table_bytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+    } else if (arg == "--lookups" && has_value) {
+      config.lookups = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--distance" && has_value) {
+      config.distance = std::strtoull(argv[++i], nullptr, 10);
+      distance_set = true;
+    } else if (arg == "--group" && has_value) {
+      config.group = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!distance_set) {
+    MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+    PrefetchSetting tuned = PrefetchTuner::Lookup(profile, "scale", AccessPattern::kIndirect,
+                                                  {config.distance, 0});
+    if (tuned.Enabled()) {
+      config.distance = tuned.distance;
+    }
+  }
+
+  std::cout << "Table " << (config.table_bytes >> 20) << " MB, " << config.lookups
+            << " random lookups, best of " << config.repetitions << "\n\n"
+            << std::left << std::setw(28) << "variant" << std::right << std::setw(12)
+            << "ns/lookup" << std::setw(10) << "speedup" << "\n";
+  for (const auto& result : RunIndirectBenchmark(config)) {
+    std::cout << std::left << std::setw(28) << result.name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(12) << result.ns_per_lookup << std::setw(9)
+              << result.speedup << "x\n";
+  }
+  return 0;
+}
+
+std::string FormatPoint(const hardware_analysis::TuningPoint& point) {
+  std::ostringstream out;
+  for (const auto& entry : point) {
+    out << (out.tellp() > 0 ? " " : "") << entry.first << "=" << entry.second;
+  }
+  return out.str();
+}
+
+int RunAutotune(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  AutotuneConfig config;
+  std::vector<std::string> kernels = {"gemm", "reduction"};
+  size_t gemm_n = 384;
+  size_t reduce_bytes = 128u << 20;
+  std::string profile_path = MachineProfile::DefaultPath();
+  bool dry_run = false;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--kernels" && has_value) {
+      kernels.clear();
+      std::stringstream list(argv[++i]);
+      std::string name;
+      while (std::getline(list, name, ',')) {
+        if (name != "gemm" && name != "reduction") {
+          std::cerr << "Unknown kernel: " << name << "\n";
+          return 1;
+        }
+        kernels.push_back(name);
+      }
+    } else if (arg == "--gemm-n" && has_value) {
+      gemm_n = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--reduce-mb" && has_value) {
+      reduce_bytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+    } else if (arg == "--repetitions" && has_value) {
+      config.repetitions = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--max-evals" && has_value) {
+      config.max_evaluations = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else if (arg == "--dry-run") {
+      dry_run = true;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+  std::string cache_signature = MachineProfile::DetectCacheSignature();
+  std::cout << "Cache signature: " << cache_signature << "\n\n";
+
+  OptimizationEngine engine;
+  Autotuner tuner(config);
+  for (const auto& name : kernels) {
+    TunableKernel kernel;
+    TuningPoint baseline;
+    const char* unit = "GFLOP/s";
+    if (name == "gemm") {
+      GemmBlocking blocking = engine.GetGemmBlocking();
+      kernel = MakeGemmKernel(engine, gemm_n);
+      baseline = {{"block_m", static_cast<int64_t>(blocking.block_m)},
+                  {"block_k", static_cast<int64_t>(blocking.block_k)},
+                  {"block_n", static_cast<int64_t>(blocking.block_n)}};
+    } else {
+      ReductionParallelism parallelism = engine.GetReductionParallelism();
+      kernel = MakeReductionKernel(engine, reduce_bytes / sizeof(double),
+                                   std::max(1u, std::thread::hardware_concurrency()));
+      baseline = {{"threads", static_cast<int64_t>(parallelism.threads)},
+                  {"chunk", static_cast<int64_t>(parallelism.chunk)}};
+      unit = "GB/s";
+    }
+
+    AutotuneResult result = tuner.Tune(kernel, &baseline);
+    std::cout << name << ": " << result.grid_evaluations << " grid + "
+              << result.refine_evaluations << " refinement points\n"
+              << std::fixed << std::setprecision(2) << "  default " << FormatPoint(baseline)
+              << ": " << result.baseline_stats.throughput / 1e9 << " " << unit << "\n"
+              << "  tuned   " << FormatPoint(result.best) << ": "
+              << result.best_stats.throughput / 1e9 << " " << unit << " (median of "
+              << config.repetitions << ", stddev "
+              << 100.0 * result.best_stats.stddev_seconds /
+                     std::max(result.best_stats.median_seconds, 1e-12)
+              << "%)\n";
+    Autotuner::StoreInProfile(result, cache_signature, profile);
+  }
+
+  if (!dry_run) {
+    profile.Save(profile_path);
+    std::cout << "\nProfile for '" << profile.GetCpuModel() << "' updated: " << profile_path
+              << "\n";
+  }
+  return 0;
+}
+
+int RunCacheTopology(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  if (argc > 2) {
+    std::cerr << "Unknown option: " << argv[2] << "\n";
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  TopologySnapshot topology = TopologySnapshot::Read();
+  const CacheTopology& caches = topology.caches;
+  std::cout << "Source: " << caches.source << ", signature: " << caches.Signature() << "\n\n"
+            << std::left << std::setw(8) << "cache" << std::right << std::setw(10) << "size_KB"
+            << std::setw(7) << "line" << std::setw(6) << "ways" << std::setw(8) << "sets"
+            << "  shared CPUs\n";
+  for (const auto& cache : caches.caches) {
+    const char* type = cache.type == CacheType::kData          ? "d"
+                       : cache.type == CacheType::kInstruction ? "i"
+                                                               : "";
+    std::ostringstream cpus;
+    for (size_t i = 0; i < cache.shared_cpus.size(); ++i) {
+      cpus << (i ? "," : "") << cache.shared_cpus[i];
+    }
+    std::cout << std::left << std::setw(8) << ("L" + std::to_string(cache.level) + type)
+              << std::right << std::setw(10) << (cache.size_bytes >> 10) << std::setw(7)
+              << cache.line_bytes << std::setw(6) << cache.ways << std::setw(8) << cache.sets
+              << "  " << cpus.str() << "\n";
+  }
+
+  std::vector<std::vector<int>> groups = topology.LastLevelCacheGroups();
+  std::cout << "\n" << groups.size() << " last-level cache group(s)\n";
+  return 0;
+}
+
+int RunMemoryBenchmark(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  MemoryBenchConfig config;
+  std::vector<std::string> suites = {"latency", "bandwidth", "stride", "tlb"};
+  std::string json_path;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--suites" && has_value) {
+      suites.clear();
+      std::stringstream list(argv[++i]);
+      std::string name;
+      while (std::getline(list, name, ',')) {
+        suites.push_back(name);
+      }
+    } else if (arg == "--cpu" && has_value) {
+      config.cpu = std::atoi(argv[++i]);
+    } else if (arg == "--cpus" && has_value) {
+      config.cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--node" && has_value) {
+      config.numa_node = std::atoi(argv[++i]);
+    } else if (arg == "--max-ws-mb" && has_value) {
+      config.max_working_set = std::strtoull(argv[++i], nullptr, 10) << 20;
+    } else if (arg == "--json" && has_value) {
+      json_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  MemoryBenchmark benchmark(config);
+  std::vector<BenchmarkRecord> records = benchmark.Run(suites);
+  CacheTopology caches = CacheTopology::Read();
+
+  if (!json_path.empty()) {
+    if (json_path == "-") {
+      WriteBenchmarkJson(std::cout, records, caches, argv[0]);
+      return 0;
+    }
+    std::ofstream file(json_path);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open " << json_path << "\n";
+      return 1;
+    }
+    WriteBenchmarkJson(file, records, caches, argv[0]);
+    std::cout << "Wrote " << records.size() << " results to " << json_path << "\n";
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::vector<LatencyPoint> curve;
+  for (const auto& record : records) {
+    std::cout << std::left << std::setw(40) << record.name << std::right << std::setw(12)
+              << record.real_time << " ns";
+    for (const auto& counter : record.counters) {
+      if (counter.first == "bytes_per_second") {
+        std::cout << std::setw(10) << counter.second / 1e9 << " GB/s";
+      } else if (counter.first == "working_set_bytes") {
+        curve.push_back({static_cast<size_t>(counter.second), PageSize::k4K, record.real_time});
+      }
+    }
+    std::cout << "\n";
+  }
+
+  std::vector<std::pair<std::string, double>> levels =
+      MemoryBenchmark::LevelLatencies(curve, caches);
+  if (!levels.empty()) {
+    std::cout << "\nLoad-to-use latency:";
+    for (const auto& level : levels) {
+      std::cout << " " << level.first << " " << level.second << " ns";
+    }
+    std::cout << "\n";
+  }
+  return 0;
+}
+
+int RunMemorySaturation(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  MemoryBenchConfig config;
+  std::vector<int> nodes;
+  std::vector<std::string> kinds = {"read", "write", "mixed"};
+  size_t max_threads = 0;
+  std::string json_path;
+  std::string profile_path = MachineProfile::DefaultPath();
+  bool dry_run = false;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--nodes" && has_value) {
+      nodes = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--kinds" && has_value) {
+      kinds.clear();
+      std::stringstream list(argv[++i]);
+      std::string name;
+      while (std::getline(list, name, ',')) {
+        kinds.push_back(name);
+      }
+    } else if (arg == "--max-threads" && has_value) {
+      max_threads = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--seconds" && has_value) {
+      config.saturation_seconds = std::atof(argv[++i]);
+    } else if (arg == "--json" && has_value) {
+      json_path = argv[++i];
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else if (arg == "--dry-run") {
+      dry_run = true;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  TopologySnapshot topology = TopologySnapshot::Read();
+  if (nodes.empty()) {
+    for (int node = 0; node < std::max(1, topology.numa_node_count); ++node) {
+      nodes.push_back(node);
+    }
+  }
+
+  std::ostream& out = json_path == "-" ? std::cerr : std::cout;
+  MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+  std::vector<BenchmarkRecord> records;
+  out << std::fixed << std::setprecision(1);
+  for (int node : nodes) {
+    std::vector<int> cpus = topology.NodeCpus(node);
+    if (cpus.empty()) {
+      std::cerr << "Warning: NUMA node " << node << " has no online CPUs\n";
+      continue;
+    }
+    if (max_threads > 0 && cpus.size() > max_threads) {
+      cpus.resize(max_threads);
+    }
+    config.cpu = cpus.front();
+    config.cpus = cpus;
+    config.numa_node = topology.numa_node_count > 1 ? node : -1;
+    MemoryBenchmark benchmark(config);
+
+    for (const auto& kind : kinds) {
+      std::vector<SaturationPoint> curve = benchmark.SaturationCurve(kind);
+      size_t knee = MemoryBenchmark::SaturationKnee(curve);
+      out << "Node " << node << ", " << kind << " (knee at " << knee << " threads)\n";
+      for (const auto& point : curve) {
+        out << std::setw(8) << point.threads << std::setw(10) << point.gbs << " GB/s";
+        if (point.loaded_latency_ns > 0.0) {
+          out << std::setw(10) << point.loaded_latency_ns << " ns loaded latency";
+        }
+        out << (point.threads == knee ? "  <- knee" : "") << "\n";
+      }
+      MemoryBenchmark::StoreSaturationInProfile(node, curve, profile);
+      for (auto& record : MemoryBenchmark::SaturationRecords(curve, node)) {
+        records.push_back(std::move(record));
+      }
+    }
+  }
+
+  if (json_path == "-") {
+    WriteBenchmarkJson(std::cout, records, CacheTopology::Read(), argv[0]);
+  } else if (!json_path.empty()) {
+    std::ofstream file(json_path);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open " << json_path << "\n";
+      return 1;
+    }
+    WriteBenchmarkJson(file, records, CacheTopology::Read(), argv[0]);
+    out << "Wrote " << records.size() << " results to " << json_path << "\n";
+  }
+
+  if (!dry_run) {
+    profile.Save(profile_path);
+    out << "Profile updated: " << profile_path << "\n";
+  }
+  return 0;
+}
+
+int RunCoreLatency(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  CoreLatencyConfig config;
+  std::string profile_path = MachineProfile::DefaultPath();
+  bool dry_run = false;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--cpus" && has_value) {
+      config.cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--round-trips" && has_value) {
+      config.round_trips = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--samples" && has_value) {
+      config.samples = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--serial") {
+      config.parallel = false;
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else if (arg == "--dry-run") {
+      dry_run = true;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  CoreLatencyBenchmark benchmark(config);
+  CoreLatencyMatrix matrix = benchmark.Run();
+  if (matrix.cpus.size() < 2) {
+    std::cerr << "Core-to-core latency needs at least two CPUs\n";
+    return 1;
+  }
+
+  std::cout << "Round-trip latency, ns\n" << std::setw(6) << "";
+  for (int cpu : matrix.cpus) {
+    std::cout << std::setw(7) << cpu;
+  }
+  std::cout << "\n" << std::fixed << std::setprecision(1);
+  for (size_t i = 0; i < matrix.cpus.size(); ++i) {
+    std::cout << std::setw(6) << matrix.cpus[i];
+    for (size_t j = 0; j < matrix.cpus.size(); ++j) {
+      if (i == j) {
+        std::cout << std::setw(7) << "-";
+      } else {
+        std::cout << std::setw(7) << matrix.At(i, j);
+      }
+    }
+    std::cout << "\n";
+  }
+
+  TopologySnapshot topology = TopologySnapshot::Read();
+  std::vector<LatencyDomainLevel> domains = CoreLatencyBenchmark::Cluster(matrix, &topology);
+  std::cout << "\nLatency domains:\n";
+  for (const auto& level : domains) {
+    std::cout << "  " << std::left << std::setw(8) << level.name << std::right << "<= "
+              << level.max_round_trip_ns << " ns:";
+    for (const auto& group : level.groups) {
+      std::cout << " {";
+      for (size_t i = 0; i < group.size(); ++i) {
+        std::cout << (i ? "," : "") << group[i];
+      }
+      std::cout << "}";
+    }
+    std::cout << "\n";
+  }
+
+  if (!dry_run) {
+    MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+    CoreLatencyBenchmark::StoreInProfile(matrix, domains, profile);
+    profile.Save(profile_path);
+    std::cout << "\nProfile updated: " << profile_path << "\n";
+  }
+  return 0;
+}
+
+int RunRoofline(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  RooflineConfig config;
+  std::string json_path;
+  std::string profile_path = MachineProfile::DefaultPath();
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--cpu" && has_value) {
+      config.cpu = std::atoi(argv[++i]);
+    } else if (arg == "--gemm-n" && has_value) {
+      config.gemm_n = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--reduce-mb" && has_value) {
+      config.reduce_bytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+    } else if (arg == "--json" && has_value) {
+      json_path = argv[++i];
+    } else if (arg == "--profile" && has_value) {
+      profile_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Ядра измеряются с настройками, подобранными prefetch-tune и autotune
+  OptimizationEngine engine;
+  try {
+    MachineProfile profile = MachineProfile::Load(profile_path, MachineProfile::DetectCpuModel());
+    engine.LoadPrefetchSettings(profile);
+    engine.LoadTunedParameters(profile, MachineProfile::DetectCacheSignature());
+  } catch (const std::exception& e) {
+    std::cerr << "Warning: " << e.what() << "\n";
+  }
+
+  CacheTopology caches = CacheTopology::Read();
+  RooflineModel model(config);
+  RooflineReport report = model.Run(engine, caches);
+
+  if (json_path == "-") {
+    RooflineModel::WriteJson(std::cout, report);
+    return 0;
+  }
+  if (!json_path.empty()) {
+    std::ofstream file(json_path);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open " << json_path << "\n";
+      return 1;
+    }
+    RooflineModel::WriteJson(file, report);
+  }
+
+  std::cout << std::fixed << std::setprecision(1) << "Compute ceilings, GFLOP/s\n";
+  for (const auto& ceiling : report.compute) {
+    std::cout << "  " << PrecisionName(ceiling.precision) << " " << std::left << std::setw(8)
+              << SimdIsaName(ceiling.isa) << std::right << std::setw(10)
+              << ceiling.gflops_per_core << " per core" << std::setw(10)
+              << ceiling.gflops_per_socket << " per socket (" << ceiling.socket_threads
+              << " threads)\n";
+  }
+  std::cout << "Bandwidth ceilings, GB/s\n";
+  for (const auto& ceiling : report.bandwidth) {
+    std::cout << "  " << std::left << std::setw(6) << ceiling.level << std::right
+              << std::setw(10) << (ceiling.working_set >> 10) << " KiB" << std::setw(10)
+              << ceiling.gbs_per_core << " per core";
+    if (ceiling.gbs_per_socket > 0.0) {
+      std::cout << std::setw(10) << ceiling.gbs_per_socket << " per socket";
+    }
+    std::cout << "\n";
+  }
+
+  std::cout << "\n" << std::left << std::setw(20) << "Kernel" << std::right << std::setw(8)
+            << "Threads" << std::setw(10) << "FLOP/B" << std::setw(10) << "GFLOP/s"
+            << std::setw(12) << "Attainable" << std::setw(8) << "Eff%" << "  Bound    Served\n";
+  for (const auto& point : report.kernels) {
+    std::cout << std::left << std::setw(20) << point.name << std::right << std::setw(8)
+              << point.threads << std::setprecision(3) << std::setw(10) << point.intensity
+              << std::setprecision(1) << std::setw(10) << point.gflops << std::setw(12)
+              << point.attainable_gflops << std::setw(8) << 100.0 * point.efficiency << "  "
+              << std::left << std::setw(9) << point.bound << std::setw(6) << point.served_from
+              << std::right << (point.bytes_source == "model" ? " (model bytes)" : "") << "\n";
+  }
+  if (!json_path.empty()) {
+    std::cout << "\nWrote " << json_path << "\n";
+  }
+  return 0;
+}
+
+int RunStress(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  StressConfig config;
+  size_t working_set = 64u << 20;
+  size_t fma_per_element = 8;
+  uint64_t interval_ms = 500;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--phase" && has_value) {
+      config.phases.push_back(StressPhase::Parse(argv[++i]));
+    } else if (arg == "--cpus" && has_value) {
+      config.cpus = utils::ParseCpuList(argv[++i]);
+    } else if (arg == "--node" && has_value) {
+      config.numa_node = std::atoi(argv[++i]);
+    } else if (arg == "--ws-mb" && has_value) {
+      working_set = std::strtoull(argv[++i], nullptr, 10) << 20;
+    } else if (arg == "--fma" && has_value) {
+      fma_per_element = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--cycles" && has_value) {
+      config.cycles = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--interval-ms" && has_value) {
+      interval_ms = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (config.phases.empty()) {
+    config.phases.push_back(StressPhase::Parse("compute:10"));
+  }
+  for (auto& phase : config.phases) {
+    phase.working_set = working_set;
+    phase.fma_per_element = fma_per_element;
+  }
+
+  StressEngine engine(config);
+  std::cout << "Stress on " << engine.config().cpus.size() << " thread(s), "
+            << engine.TotalSeconds() << " s\n"
+            << std::setw(8) << "Time" << std::setw(10) << "Phase" << std::setw(10) << "GFLOP/s"
+            << std::setw(10) << "GB/s" << std::setw(10) << "Macc/s" << std::setw(8) << "Busy%"
+            << "\n";
+  std::signal(SIGINT, HandleStopSignal);
+  std::signal(SIGTERM, HandleStopSignal);
+  engine.Start();
+  double elapsed = 0.0;
+  while (!engine.Finished() && !g_stop_requested.load()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    StressRates rates = engine.Sample();
+    elapsed += rates.seconds;
+    std::string phase = rates.phase < config.phases.size()
+                            ? StressKindName(config.phases[rates.phase].kind)
+                            : "done";
+    std::cout << std::fixed << std::setprecision(2) << std::setw(8) << elapsed << std::setw(10)
+              << phase << std::setw(10) << rates.gflops << std::setw(10) << rates.gbs
+              << std::setw(10) << rates.maccesses_per_second << std::setw(8) << std::setprecision(1)
+              << 100.0 * rates.busy_fraction << "\n";
+  }
+  engine.Stop();
+
+  std::cout << "\nPer phase:\n";
+  for (size_t p = 0; p < config.phases.size(); ++p) {
+    // Фактическое время фазы: после SIGINT фаза короче номинальной
+    StressRates rates = StressRates::From(engine.PhaseTotals(p), engine.PhaseSeconds(p),
+                                          engine.config().cpus.size(), p);
+    std::cout << std::setw(4) << p << std::setw(10) << StressKindName(config.phases[p].kind)
+              << std::setprecision(2) << std::setw(10) << rates.gflops << " GFLOP/s"
+              << std::setw(10) << rates.gbs << " GB/s" << std::setw(10)
+              << rates.maccesses_per_second << " Macc/s" << std::setprecision(1) << std::setw(8)
+              << 100.0 * rates.busy_fraction << "% busy\n";
+  }
+  return 0;
+}
+
+int RunCacheSim(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  std::string trace_path;
+  std::string levels_spec;
+  ReplacementPolicy policy = ReplacementPolicy::kLru;
+  bool use_simd = true;
+  std::vector<std::string> prefetch_specs;
+  uint64_t prefetch_latency = CacheHierarchy::kDefaultPrefetchLatency;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--trace" && has_value) {
+      trace_path = argv[++i];
+    } else if (arg == "--levels" && has_value) {
+      levels_spec = argv[++i];
+    } else if (arg == "--policy" && has_value) {
+      policy = ParseReplacementPolicy(argv[++i]);
+    } else if (arg == "--scalar") {
+      use_simd = false;
+    } else if (arg == "--prefetch" && has_value) {
+      prefetch_specs.push_back(argv[++i]);
+    } else if (arg == "--prefetch-latency" && has_value) {
+      prefetch_latency = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (trace_path.empty()) {
+    std::cerr << "cache-sim needs --trace PATH\n";
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::vector<CacheLevelConfig> levels =
+      levels_spec.empty() ? CacheHierarchy::FromTopology(CacheTopology::Read(), policy)
+                          : CacheHierarchy::ParseLevels(levels_spec, policy);
+  if (levels.empty()) {
+    std::cerr << "Cache sizes are unknown on this machine, pass --levels\n";
+    return 1;
+  }
+  MappedTrace trace(trace_path);
+  CacheHierarchy hierarchy(levels, use_simd);
+  hierarchy.SetPrefetchLatency(prefetch_latency);
+  for (const std::string& spec : prefetch_specs) {
+    size_t at = spec.find('@');
+    size_t level = 0;
+    if (at != std::string::npos) {
+      std::string name = spec.substr(at + 1);
+      level = std::strtoull(name.c_str() + (name[0] == 'L' ? 1 : 0), nullptr, 10) - 1;
+    }
+    hierarchy.AddPrefetcher(MakePrefetcher(spec.substr(0, at)), level);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  hierarchy.Run(trace);
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << trace.size() << " records in " << std::fixed << std::setprecision(3) << seconds
+            << " s (" << std::setprecision(1)
+            << (seconds > 0.0 ? trace.size() / seconds / 1e6 : 0.0) << " M accesses/s, "
+            << (hierarchy.Level(0).simd() ? "AVX2" : "scalar") << " tag compare)\n\n"
+            << std::left << std::setw(6) << "level" << std::right << std::setw(10) << "size_KB"
+            << std::setw(6) << "ways" << std::setw(8) << "policy" << std::setw(14) << "accesses"
+            << std::setw(14) << "misses" << std::setw(9) << "hit%" << std::setw(12)
+            << "writebacks" << "\n";
+  for (size_t i = 0; i < hierarchy.LevelCount(); ++i) {
+    const SetAssociativeCache& level = hierarchy.Level(i);
+    const CacheStats& stats = level.stats();
+    std::cout << std::left << std::setw(6) << level.config().name << std::right << std::setw(10)
+              << (level.config().size_bytes >> 10) << std::setw(6) << level.config().ways
+              << std::setw(8) << ReplacementPolicyName(level.config().policy) << std::setw(14)
+              << stats.accesses << std::setw(14) << stats.misses << std::setw(9)
+              << std::setprecision(2) << 100.0 * stats.HitRate() << std::setw(12)
+              << stats.writebacks << "\n";
+  }
+
+  PrefetchStats software = hierarchy.SoftwarePrefetchStats();
+  bool has_software = software.issued + software.redundant > 0;
+  if (hierarchy.PrefetcherCount() == 0 && !has_software) {
+    return 0;
+  }
+  std::cout << "\n"
+            << std::left << std::setw(11) << "prefetcher" << std::setw(6) << "level"
+            << std::right << std::setw(12) << "issued" << std::setw(12) << "redundant"
+            << std::setw(12) << "useful" << std::setw(12) << "useless" << std::setw(11)
+            << "accuracy%" << std::setw(11) << "coverage%" << std::setw(10) << "timely%"
+            << "\n";
+  auto print_row = [&](const std::string& name, size_t level, const PrefetchStats& stats) {
+    std::cout << std::left << std::setw(11) << name << std::setw(6)
+              << hierarchy.Level(level).config().name << std::right << std::setw(12)
+              << stats.issued << std::setw(12) << stats.redundant << std::setw(12)
+              << stats.useful << std::setw(12) << stats.useless << std::setw(11)
+              << 100.0 * stats.Accuracy() << std::setw(11)
+              << 100.0 * stats.Coverage(hierarchy.Level(level).stats().misses) << std::setw(10)
+              << 100.0 * stats.Timeliness() << "\n";
+  };
+  if (has_software) {
+    print_row("software", 0, software);
+  }
+  for (size_t i = 0; i < hierarchy.PrefetcherCount(); ++i) {
+    print_row(hierarchy.PrefetcherAt(i).Name(), hierarchy.PrefetcherLevel(i),
+              hierarchy.PrefetcherStats(i));
+  }
+  return 0;
+}
+
+int RunMissRatioCurve(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  std::string trace_path;
+  std::string json_path;
+  size_t shards = 1;
+  size_t threads = 0;
+  size_t line_bytes = 64;
+  double target = -1.0;
+  ShardsConfig sampling;
+  bool sampled = false;
+  bool rate_given = false;
+  bool validate = false;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--trace" && has_value) {
+      trace_path = argv[++i];
+    } else if (arg == "--rate" && has_value) {
+      sampling.rate = std::atof(argv[++i]);
+      sampled = true;
+      rate_given = true;
+    } else if (arg == "--max-samples" && has_value) {
+      sampling.max_samples = std::strtoull(argv[++i], nullptr, 10);
+      sampled = true;
+    } else if (arg == "--adjust") {
+      sampling.adjust = true;
+    } else if (arg == "--validate") {
+      validate = true;
+    } else if (arg == "--shards" && has_value) {
+      shards = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--threads" && has_value) {
+      threads = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--line" && has_value) {
+      line_bytes = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--target" && has_value) {
+      target = std::atof(argv[++i]);
+    } else if (arg == "--json" && has_value) {
+      json_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (trace_path.empty()) {
+    std::cerr << "mrc needs --trace PATH\n";
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  if (sampled && shards > 1) {
+    std::cerr << "--shards cannot be combined with --rate or --max-samples\n";
+    return 1;
+  }
+  if (validate && !sampled) {
+    std::cerr << "--validate needs --rate or --max-samples\n";
+    return 1;
+  }
+  if (sampling.max_samples > 0 && !rate_given) {
+    sampling.rate = 1.0;   // Фиксированный размер без --rate: выборка сужается от всех строк
+  }
+
+  MappedTrace trace(trace_path);
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<ShardsAnalyzer> sampler;
+  MissRatioCurve curve;
+  if (sampled) {
+    sampling.line_bytes = line_bytes;
+    sampler.reset(new ShardsAnalyzer(sampling));
+    sampler->Simulate(trace.begin(), trace.size());
+    curve = sampler->Curve();
+  } else {
+    curve =
+        StackDistanceAnalyzer::Analyze(trace.begin(), trace.size(), line_bytes, shards, threads);
+  }
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<size_t> lines = curve.LogCapacities(4);
+  if (json_path == "-") {
+    curve.WriteJson(std::cout, lines);
+    return 0;
+  }
+  if (!json_path.empty()) {
+    std::ofstream file(json_path);
+    if (!file) {
+      std::cerr << "Failed to open " << json_path << "\n";
+      return 1;
+    }
+    curve.WriteJson(file, lines);
+  }
+
+  std::cout << trace.size() << " records, " << std::fixed << std::setprecision(0)
+            << curve.accesses << " line accesses, " << curve.cold << " distinct lines ("
+            << (sampled ? "sampled " + std::to_string(sampler->SampledLines()) +
+                              " lines at rate " + std::to_string(sampler->Rate())
+                : shards > 1 ? std::to_string(shards) + " shards"
+                             : std::string("exact"))
+            << ", " << std::setprecision(3) << seconds << " s)\n\n"
+            << std::setw(12) << "lines" << std::setw(14) << "capacity_KB" << std::setw(10)
+            << "miss%" << (sampled ? "   95% interval" : "") << "\n";
+  for (size_t capacity : curve.LogCapacities(1)) {
+    std::cout << std::setw(12) << capacity << std::setw(14) << std::setprecision(2)
+              << static_cast<double>(capacity * line_bytes) / 1024.0 << std::setw(10)
+              << 100.0 * curve.MissRatio(capacity);
+    if (sampled) {
+      MissRatioEstimate estimate = sampler->Estimate(capacity);
+      std::cout << "   " << 100.0 * estimate.lower << " - " << 100.0 * estimate.upper;
+    }
+    std::cout << "\n";
+  }
+
+  if (validate) {
+    // Сверка с точным анализом: имеет смысл на трассах, которые он ещё тянет
+    MissRatioCurve exact = StackDistanceAnalyzer::Analyze(trace.begin(), trace.size(), line_bytes);
+    std::vector<size_t> points = exact.LogCapacities(4);
+    std::vector<double> truth = exact.MissRatios(points);
+    std::vector<double> approx = curve.MissRatios(points);
+    double total_error = 0.0;
+    double max_error = 0.0;
+    size_t inside = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+      double error = std::abs(approx[i] - truth[i]);
+      total_error += error;
+      max_error = std::max(max_error, error);
+      MissRatioEstimate estimate = sampler->Estimate(points[i]);
+      inside += truth[i] >= estimate.lower && truth[i] <= estimate.upper;
+    }
+    std::cout << "\nAgainst the exact curve (" << points.size() << " sizes): mean abs error "
+              << std::setprecision(4) << total_error / points.size() << ", max " << max_error
+              << ", exact inside the interval at " << inside << "/" << points.size() << "\n";
+  }
+
+  CacheTopology caches = CacheTopology::Read();
+  std::cout << "\nThis machine (fully associative LRU of the same size):\n";
+  for (int level = 1; level <= caches.LastLevel(); ++level) {
+    size_t bytes = caches.DataCacheBytes(level);
+    if (bytes > 0) {
+      std::cout << "  L" << level << std::setw(10) << (bytes >> 10) << " KB" << std::setw(10)
+                << std::setprecision(2) << 100.0 * curve.MissRatioAtBytes(bytes) << "% misses\n";
+    }
+  }
+  if (target >= 0.0) {
+    size_t capacity = curve.CapacityFor(target);
+    std::cout << "\nMiss ratio " << target << ": ";
+    if (capacity == 0) {
+      std::cout << "unreachable (cold misses alone are "
+                << 100.0 * curve.cold / std::max(curve.accesses, 1.0) << "%)\n";
+    } else {
+      std::cout << std::setprecision(1) << static_cast<double>(capacity * line_bytes) / 1024.0
+                << " KB\n";
+    }
+  }
+  if (!json_path.empty()) {
+    std::cout << "\nWrote " << lines.size() << " points to " << json_path << "\n";
+  }
+  return 0;
+}
+
+int RunPageTrace(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  pid_t pid = 0;
+  std::string out_path;
+  bool verbose = false;
+  PageTracerConfig config;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--pid" && has_value) {
+      pid = static_cast<pid_t>(std::atoi(argv[++i]));
+    } else if (arg == "--out" && has_value) {
+      out_path = argv[++i];
+    } else if (arg == "--tracking" && has_value) {
+      config.scan.tracking = ParsePageTracking(argv[++i]);
+    } else if (arg == "--interval" && has_value) {
+      config.interval_ms = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--duration" && has_value) {
+      config.duration_ms = static_cast<uint64_t>(std::atof(argv[++i]) * 1000.0);
+    } else if (arg == "--max-pages" && has_value) {
+      config.scan.max_pages_per_scan = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--max-cpu" && has_value) {
+      config.max_cpu_fraction = std::atof(argv[++i]);
+    } else if (arg == "--min-region" && has_value) {
+      config.scan.min_region_bytes = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--anon-only") {
+      config.scan.anonymous_only = true;
+    } else if (arg == "--log") {
+      verbose = true;
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (pid <= 0 || out_path.empty()) {
+    std::cerr << "page-trace needs --pid PID and --out PATH\n";
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::signal(SIGINT, HandleStopSignal);
+  std::signal(SIGTERM, HandleStopSignal);
+
+  PageTracer tracer(pid, out_path, config);
+  std::cerr << "Tracing pages of " << pid << " (" << PageTrackingName(config.scan.tracking)
+            << ", " << config.interval_ms << " ms interval, up to "
+            << config.scan.max_pages_per_scan << " pages per scan)\n";
+  auto start = std::chrono::steady_clock::now();
+  tracer.Run(g_stop_requested, verbose ? &std::cerr : nullptr);
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << tracer.records() << " page accesses in " << tracer.scans() << " scans over "
+            << std::fixed << std::setprecision(1) << seconds << " s, tracer CPU "
+            << std::setprecision(2)
+            << (seconds > 0.0 ? 100.0 * tracer.cpu_seconds() / seconds : 0.0) << "%\n";
+  if (tracer.records() == 0 && config.scan.tracking == PageTracking::kSoftDirty &&
+      tracer.scans() > 1) {
+    // Ядро без CONFIG_MEM_SOFT_DIRTY принимает clear_refs, но бит 55 не ставит
+    std::cerr << "No soft-dirty pages were seen: the process did not write, or the kernel "
+                 "lacks CONFIG_MEM_SOFT_DIRTY\n";
+  }
+  return 0;
+}
+
+int RunWorkingSetSize(int argc, char** argv) {
+  using namespace hardware_analysis;
+
+  std::vector<pid_t> pids;
+  PageScanConfig scan;
+  uint64_t interval_ms = 1000;
+  double duration_seconds = 0.0;
+  std::string csv_path;
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--pid" && has_value) {
+      pids.push_back(utils::ParsePid(argv[++i], "--pid"));
+    } else if (arg == "--tracking" && has_value) {
+      scan.tracking = ParsePageTracking(argv[++i]);
+    } else if (arg == "--interval" && has_value) {
+      interval_ms = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--duration" && has_value) {
+      duration_seconds = std::atof(argv[++i]);
+    } else if (arg == "--max-pages" && has_value) {
+      scan.max_pages_per_scan = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--csv" && has_value) {
+      csv_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (pids.empty()) {
+    std::cerr << "wss needs at least one --pid PID\n";
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<WorkingSetEstimator>> estimators;
+  for (pid_t pid : pids) {
+    estimators.push_back(std::make_unique<WorkingSetEstimator>(pid, scan));
+  }
+  std::signal(SIGINT, HandleStopSignal);
+  std::signal(SIGTERM, HandleStopSignal);
+
+  std::cout << std::left << std::setw(8) << "pid" << std::right << std::setw(10) << "time_s"
+            << std::setw(10) << "window_s" << std::setw(12) << "wss_MB" << std::setw(12)
+            << "rss_MB" << std::setw(8) << "wss%" << "\n";
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&start]() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  while (!g_stop_requested.load() && (duration_seconds <= 0.0 || elapsed() < duration_seconds)) {
+    bool any_alive = false;
+    for (auto& estimator : estimators) {
+      WssSample sample;
+      if (estimator->Sample(sample)) {
+        std::cout << std::left << std::setw(8) << sample.pid << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << sample.time_seconds
+                  << std::setw(10) << sample.window_seconds << std::setw(12)
+                  << sample.WssBytes() / 1048576.0 << std::setw(12)
+                  << sample.RssBytes() / 1048576.0 << std::setw(8)
+                  << (sample.present_pages > 0
+                          ? 100.0 * sample.accessed_pages / sample.present_pages
+                          : 0.0)
+                  << std::endl;
+      }
+      any_alive = any_alive || estimator->alive();
+    }
+    if (!any_alive) {
+      break;
+    }
+    for (uint64_t slept = 0; slept < interval_ms && !g_stop_requested.load(); slept += 50) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(std::min<uint64_t>(
+          50, interval_ms - slept)));
+    }
+  }
+
+  double cpu_seconds = 0.0;
+  for (const auto& estimator : estimators) {
+    cpu_seconds += estimator->cpu_seconds();
+  }
+  std::cerr << "Scanner CPU " << std::fixed << std::setprecision(2)
+            << (elapsed() > 0.0 ? 100.0 * cpu_seconds / elapsed() : 0.0) << "%\n";
+
+  if (!csv_path.empty()) {
+    std::ofstream file;
+    if (csv_path != "-") {
+      file.open(csv_path);
+      if (!file.is_open()) {
+        std::cerr << "Failed to open " << csv_path << "\n";
+        return 1;
+      }
+    }
+    std::ostream& out = csv_path == "-" ? std::cout : file;
+    for (size_t i = 0; i < estimators.size(); ++i) {
+      std::ostringstream csv;
+      estimators[i]->WriteCsv(csv);
+      std::string text = csv.str();
+      // Заголовок - один раз на файл
+      out << (i == 0 ? text : text.substr(text.find('\n') + 1));
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::string mode = argv[1];
+  try {
+    if (mode == "governor") {
+      return RunGovernor(argc, argv);
+    }
+    if (mode == "thermal-sim") {
+      return RunThermalSimulation(argc, argv);
+    }
+    if (mode == "dvfs-sim") {
+      return RunDvfsSimulation(argc, argv);
+    }
+    if (mode == "cpufreq-latency") {
+      return RunCpufreqLatency(argc, argv);
+    }
+    if (mode == "powercap") {
+      return RunPowercap(argc, argv);
+    }
+    if (mode == "freq-transition") {
+      return RunTransitionBenchmark(argc, argv);
+    }
+    if (mode == "classify-bench") {
+      return RunClassifyBench(argc, argv);
+    }
+    if (mode == "batch-schedule") {
+      return RunBatchSchedule(argc, argv);
+    }
+    if (mode == "prefetch-tune") {
+      return RunPrefetchTune(argc, argv);
+    }
+    if (mode == "indirect-bench") {
+      return RunIndirectBench(argc, argv);
+    }
+    if (mode == "autotune") {
+      return RunAutotune(argc, argv);
+    }
+    if (mode == "cache-topology") {
+      return RunCacheTopology(argc, argv);
+    }
+    if (mode == "memory-bench") {
+      return RunMemoryBenchmark(argc, argv);
+    }
+    if (mode == "memory-saturation") {
+      return RunMemorySaturation(argc, argv);
+    }
+    if (mode == "core-latency") {
+      return RunCoreLatency(argc, argv);
+    }
+    if (mode == "roofline") {
+      return RunRoofline(argc, argv);
+    }
+    if (mode == "stress") {
+      return RunStress(argc, argv);
+    }
+    if (mode == "cache-sim") {
+      return RunCacheSim(argc, argv);
+    }
+    if (mode == "mrc") {
+      return RunMissRatioCurve(argc, argv);
+    }
+    if (mode == "page-trace") {
+      return RunPageTrace(argc, argv);
+    }
+    if (mode == "wss") {
+      return RunWorkingSetSize(argc, argv);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cerr << "Unknown mode: " << mode << "\n";
+  PrintUsage(argv[0]);
+  return 1;
+}
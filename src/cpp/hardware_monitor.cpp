@@ -1,4 +1,5 @@
 #include "hardware_monitor.hpp"
+#include "wss_estimator.hpp"
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/time.h>
@@ -7,6 +8,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
 #include <algorithm>
 
@@ -16,13 +18,15 @@ namespace hardware_analysis {
 // MSRReader Implementation
 // ============================================================================
 
-MSRReader::MSRReader(int cpu_id) 
+MSRReader::MSRReader(int cpu_id, const std::string& device_root) 
     : cpu_id_(cpu_id), 
       msr_fd_(-1), 
       last_energy_sample_(0),
-      last_sample_time_us_(0) {
+      last_sample_time_us_(0),
+      tj_max_(-1),
+      energy_unit_joules_(0.0) {
   
-  std::string msr_path = "/dev/cpu/" + std::to_string(cpu_id) + "/msr";
+  std::string msr_path = device_root + "/" + std::to_string(cpu_id) + "/msr";
   
   msr_fd_ = open(msr_path.c_str(), O_RDONLY);
   if (msr_fd_ < 0) {
@@ -49,10 +53,25 @@ uint64_t MSRReader::Read(uint32_t msr_addr) const {
   return value;
 }
 
+int MSRReader::ReadTjMax() const {
+  if (tj_max_ < 0) {
+    // Читаем целевую температуру (Tj_max)
+    uint64_t target = Read(MSR_TEMPERATURE_TARGET);
+    tj_max_ = (target >> 16) & 0xFF;
+  }
+  return tj_max_;
+}
+
+double MSRReader::ReadEnergyUnit() const {
+  if (energy_unit_joules_ == 0.0) {
+    uint64_t power_unit = Read(MSR_RAPL_POWER_UNIT);
+    energy_unit_joules_ = 1.0 / (1 << ((power_unit >> 8) & 0x1F));
+  }
+  return energy_unit_joules_;
+}
+
 double MSRReader::ReadTemperature() const {
-  // Читаем целевую температуру (Tj_max)
-  uint64_t target = Read(MSR_TEMPERATURE_TARGET);
-  int tj_max = (target >> 16) & 0xFF;
+  int tj_max = ReadTjMax();
   
   // Читаем текущее значение температуры
   uint64_t status = Read(MSR_IA32_THERM_STATUS);
@@ -62,6 +81,15 @@ double MSRReader::ReadTemperature() const {
   return static_cast<double>(tj_max - digital_readout);
 }
 
+double MSRReader::ReadPackageTemperature() const {
+  int tj_max = ReadTjMax();
+  
+  uint64_t status = Read(MSR_IA32_PACKAGE_THERM_STATUS);
+  int digital_readout = (status >> 16) & 0x7F;
+  
+  return static_cast<double>(tj_max - digital_readout);
+}
+
 uint64_t MSRReader::ReadFrequency() const {
   uint64_t perf_status = Read(MSR_IA32_PERF_STATUS);
   
@@ -75,9 +103,8 @@ uint64_t MSRReader::ReadFrequency() const {
 }
 
 double MSRReader::ReadPackagePower() const {
-  // Читаем единицы измерения энергии
-  uint64_t power_unit = Read(MSR_RAPL_POWER_UNIT);
-  double energy_unit = 1.0 / (1 << ((power_unit >> 8) & 0x1F));  // в Джоулях
+  // Единицы измерения энергии (в Джоулях)
+  double energy_unit = ReadEnergyUnit();
   
   // Читаем текущее значение энергии
   uint64_t current_energy = Read(MSR_PKG_ENERGY_STATUS) & 0xFFFFFFFF;
@@ -265,22 +292,7 @@ NumaNode SystemMonitor::ParseNumaNode(int node_id) const {
   try {
     std::string cpulist_path = base_path + "/cpulist";
     std::string cpulist = utils::ReadSysfsString(cpulist_path);
-    
-    // Парсинг формата "0-3,8-11" -> {0,1,2,3,8,9,10,11}
-    std::istringstream iss(cpulist);
-    std::string range;
-    while (std::getline(iss, range, ',')) {
-      size_t dash_pos = range.find('-');
-      if (dash_pos != std::string::npos) {
-        int start = std::stoi(range.substr(0, dash_pos));
-        int end = std::stoi(range.substr(dash_pos + 1));
-        for (int cpu = start; cpu <= end; ++cpu) {
-          node.cpu_list.push_back(cpu);
-        }
-      } else {
-        node.cpu_list.push_back(std::stoi(range));
-      }
-    }
+    node.cpu_list = utils::ParseCpuList(cpulist);
   } catch (...) {
     // Ошибка парсинга
   }
@@ -291,6 +303,89 @@ NumaNode SystemMonitor::ParseNumaNode(int node_id) const {
   return node;
 }
 
+// ============================================================================
+// CpuLoadSampler Implementation
+// ============================================================================
+
+CpuLoadSampler::CpuLoadSampler(const std::string& proc_root)
+    : fd_(-1), buffer_(64 * 1024) {
+  std::string path = proc_root + "/stat";
+  fd_ = open(path.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+  }
+}
+
+CpuLoadSampler::~CpuLoadSampler() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+bool CpuLoadSampler::Sample(std::vector<double>& load_percent) {
+  ssize_t length = 0;
+  for (;;) {
+    length = pread(fd_, buffer_.data(), buffer_.size() - 1, 0);
+    if (length < 0) {
+      return false;
+    }
+    if (static_cast<size_t>(length) < buffer_.size() - 1) {
+      break;
+    }
+    buffer_.resize(buffer_.size() * 2);  // Много CPU - увеличиваем буфер
+  }
+  buffer_[length] = '\0';
+
+  // Строки вида "cpuN user nice system idle iowait irq softirq steal ..."
+  // Разбираем вручную: istringstream слишком медленный для частого опроса
+  const char* p = buffer_.data();
+  const char* end = p + length;
+  while (p < end) {
+    const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+
+    if (line_end - p > 3 && p[0] == 'c' && p[1] == 'p' && p[2] == 'u' &&
+        p[3] >= '0' && p[3] <= '9') {
+      char* cursor = nullptr;
+      size_t cpu = std::strtoul(p + 3, &cursor, 10);
+
+      uint64_t fields[8] = {0};
+      for (int i = 0; i < 8 && cursor < line_end; ++i) {
+        fields[i] = std::strtoull(cursor, &cursor, 10);
+      }
+      uint64_t idle = fields[3] + fields[4];  // idle + iowait
+      uint64_t total = 0;
+      for (uint64_t value : fields) {
+        total += value;
+      }
+      uint64_t busy = total - idle;
+
+      if (cpu >= prev_total_.size()) {
+        prev_total_.resize(cpu + 1, 0);
+        prev_busy_.resize(cpu + 1, 0);
+      }
+      if (cpu >= load_percent.size()) {
+        load_percent.resize(cpu + 1, 0.0);
+      }
+
+      uint64_t delta_total = total - prev_total_[cpu];
+      uint64_t delta_busy = busy - prev_busy_[cpu];
+      load_percent[cpu] = delta_total > 0
+          ? 100.0 * static_cast<double>(delta_busy) / static_cast<double>(delta_total)
+          : 0.0;
+
+      prev_total_[cpu] = total;
+      prev_busy_[cpu] = busy;
+    }
+
+    p = line_end + 1;
+  }
+
+  return true;
+}
+
 // ============================================================================
 // Utility Functions
 // ============================================================================
@@ -325,6 +420,40 @@ std::string ReadSysfsString(const std::string& path) {
   return value;
 }
 
+std::vector<int> ParseCpuList(const std::string& cpulist) {
+  std::vector<int> cpus;
+  
+  // Парсинг формата "0-3,8-11" -> {0,1,2,3,8,9,10,11}
+  std::istringstream iss(cpulist);
+  std::string range;
+  while (std::getline(iss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash_pos = range.find('-');
+    if (dash_pos != std::string::npos) {
+      int start = std::stoi(range.substr(0, dash_pos));
+      int end = std::stoi(range.substr(dash_pos + 1));
+      for (int cpu = start; cpu <= end; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } else {
+      cpus.push_back(std::stoi(range));
+    }
+  }
+  
+  return cpus;
+}
+
+pid_t ParsePid(const std::string& text, const std::string& option) {
+  char* end = nullptr;
+  long pid = std::strtol(text.c_str(), &end, 10);
+  if (text.empty() || *end != '\0' || pid <= 0 || pid > INT32_MAX) {
+    throw std::invalid_argument(option + " needs a positive PID");
+  }
+  return static_cast<pid_t>(pid);
+}
+
 uint64_t GetTimestampUs() {
   struct timeval tv;
   gettimeofday(&tv, nullptr);
@@ -349,13 +478,34 @@ bool LoadMSRModule() {
 // Main (Example Usage)
 // ============================================================================
 
-int main() {
+#ifndef HARDWARE_ANALYSIS_NO_MAIN
+int main(int argc, char** argv) {
   try {
+    // Рабочие наборы процессов: --wss PID (можно несколько)
+    std::vector<pid_t> wss_pids;
+    for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--wss") != 0) {
+        continue;
+      }
+      wss_pids.push_back(
+          hardware_analysis::utils::ParsePid(i + 1 < argc ? argv[i + 1] : "", "--wss"));
+      ++i;
+    }
+
     std::cout << "=== Hardware Monitor (C++ Low-level Access) ===\n\n";
     
     hardware_analysis::SystemMonitor monitor;
     
     std::cout << "Detected " << monitor.GetCpuCount() << " CPU cores\n\n";
+
+    std::vector<std::unique_ptr<hardware_analysis::WorkingSetEstimator>> wss;
+    for (pid_t pid : wss_pids) {
+      try {
+        wss.push_back(std::make_unique<hardware_analysis::WorkingSetEstimator>(pid));
+      } catch (const std::exception& e) {
+        std::cout << "WSS of " << pid << " unavailable: " << e.what() << "\n";
+      }
+    }
     
     // Мониторинг в течение 5 секунд
     std::cout << "Monitoring for 5 seconds (1 sample/sec)...\n\n";
@@ -370,6 +520,16 @@ int main() {
                   << m.frequency_mhz << " MHz, "
                   << m.power_watts << " W\n";
       }
+      for (auto& estimator : wss) {
+        hardware_analysis::WssSample sample;
+        if (estimator->Sample(sample)) {
+          std::cout << "  PID " << sample.pid << ": WSS " << (sample.WssBytes() >> 20)
+                    << " MB of " << (sample.RssBytes() >> 20) << " MB resident over "
+                    << sample.window_seconds << " s\n";
+        } else if (estimator->alive() && estimator->history().empty()) {
+          std::cout << "  PID " << estimator->pid() << ": WSS window open\n";
+        }
+      }
       std::cout << "\n";
       
       sleep(1);
@@ -414,3 +574,4 @@ int main() {
   
   return 0;
 }
+#endif  // HARDWARE_ANALYSIS_NO_MAIN
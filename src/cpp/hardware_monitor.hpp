@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <sys/types.h>
 
 namespace hardware_analysis {
 
@@ -64,9 +65,10 @@ class MSRReader {
   /**
    * @brief Конструктор для указанного CPU
    * @param cpu_id Номер процессора (0-based)
+   * @param device_root Каталог устройств msr (для тестов - фейковое дерево)
    * @throws MSRException если не удалось открыть /dev/cpu/X/msr
    */
-  explicit MSRReader(int cpu_id);
+  explicit MSRReader(int cpu_id, const std::string& device_root = "/dev/cpu");
   
   /**
    * @brief Деструктор, закрывает файловый дескриптор
@@ -92,6 +94,13 @@ class MSRReader {
    */
   double ReadTemperature() const;
 
+  /**
+   * @brief Чтение температуры всего пакета (сокета)
+   * @return Температура в градусах Цельсия
+   * @note Использует MSR_TEMPERATURE_TARGET (0x1A2) и IA32_PACKAGE_THERM_STATUS (0x1B1)
+   */
+  double ReadPackageTemperature() const;
+
   /**
    * @brief Чтение текущей частоты процессора
    * @return Частота в МГц
@@ -118,6 +127,7 @@ class MSRReader {
 
   // MSR адреса для Intel процессоров
   static constexpr uint32_t MSR_IA32_THERM_STATUS = 0x19C;
+  static constexpr uint32_t MSR_IA32_PACKAGE_THERM_STATUS = 0x1B1;
   static constexpr uint32_t MSR_TEMPERATURE_TARGET = 0x1A2;
   static constexpr uint32_t MSR_IA32_PERF_STATUS = 0x198;
   static constexpr uint32_t MSR_PKG_ENERGY_STATUS = 0x611;
@@ -126,6 +136,46 @@ class MSRReader {
   // Кэшированные значения для расчёта мощности
   mutable uint64_t last_energy_sample_;
   mutable uint64_t last_sample_time_us_;
+
+  // Tj_max и единицы RAPL не меняются - читаем один раз
+  int ReadTjMax() const;
+  double ReadEnergyUnit() const;
+  mutable int tj_max_;
+  mutable double energy_unit_joules_;
+};
+
+/**
+ * @brief Загрузка процессоров по /proc/stat
+ *
+ * Держит файл открытым и перечитывает его через pread в заранее
+ * выделенный буфер, поэтому пригоден для частого опроса.
+ */
+class CpuLoadSampler {
+ public:
+  /**
+   * @brief Конструктор
+   * @param proc_root Корень procfs (для тестов - фейковое дерево)
+   * @throws std::runtime_error если /proc/stat недоступен
+   */
+  explicit CpuLoadSampler(const std::string& proc_root = "/proc");
+  ~CpuLoadSampler();
+
+  CpuLoadSampler(const CpuLoadSampler&) = delete;
+  CpuLoadSampler& operator=(const CpuLoadSampler&) = delete;
+
+  /**
+   * @brief Загрузка каждого CPU с момента предыдущего вызова
+   * @param load_percent Выход: индекс - номер CPU, значение 0-100
+   * @return false при ошибке чтения
+   * @note Первый вызов возвращает среднюю загрузку с момента загрузки системы
+   */
+  bool Sample(std::vector<double>& load_percent);
+
+ private:
+  int fd_;
+  std::vector<char> buffer_;
+  std::vector<uint64_t> prev_busy_;
+  std::vector<uint64_t> prev_total_;
 };
 
 /**
@@ -201,6 +251,21 @@ namespace utils {
    */
   std::string ReadSysfsString(const std::string& path);
 
+  /**
+   * @brief Парсинг списка CPU в формате sysfs ("0-3,8-11")
+   * @param cpulist Строка со списком
+   * @return Номера процессоров по возрастанию
+   */
+  std::vector<int> ParseCpuList(const std::string& cpulist);
+
+  /**
+   * @brief Разбор PID из аргумента командной строки
+   * @param text Значение аргумента
+   * @param option Имя опции для сообщения об ошибке ("--wss", "--pid")
+   * @throws std::invalid_argument если значение не положительное целое
+   */
+  pid_t ParsePid(const std::string& text, const std::string& option);
+
   /**
    * @brief Получение текущего времени в микросекундах
    * @return Timestamp в мкс
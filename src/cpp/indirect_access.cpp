@@ -0,0 +1,509 @@
+#include "indirect_access.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace hardware_analysis {
+
+namespace {
+
+/**
+ * @brief Вызов f(std::integral_constant<int, Hint>) для уровня времени выполнения
+ */
+template <typename F>
+void DispatchHint(int hint, F&& f) {
+  switch (hint) {
+    case 0:
+      f(std::integral_constant<int, 0>());
+      break;
+    case 1:
+      f(std::integral_constant<int, 1>());
+      break;
+    case 2:
+      f(std::integral_constant<int, 2>());
+      break;
+    default:
+      f(std::integral_constant<int, 3>());
+      break;
+  }
+}
+
+/**
+ * @brief Предвыборка элементов table для индексов [ahead, ahead + width)
+ */
+template <int Hint, typename T>
+inline void PrefetchBlock(const T* table, const uint32_t* indices, size_t ahead, size_t width,
+                          size_t count) {
+  if (ahead + width <= count) {
+    for (size_t j = 0; j < width; ++j) {
+      prefetch::Touch<Hint>(table + indices[ahead + j]);
+    }
+  }
+}
+
+// ============================================================================
+// Скалярные ядра
+// ============================================================================
+
+template <int Hint, typename T>
+void GatherScalar(const T* table, const uint32_t* indices, size_t count, T* out,
+                  size_t distance) {
+  size_t i = 0;
+  if (distance > 0 && count > distance) {
+    for (size_t end = count - distance; i < end; ++i) {
+      prefetch::Touch<Hint>(table + indices[i + distance]);
+      out[i] = table[indices[i]];
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = table[indices[i]];
+  }
+}
+
+template <int Hint>
+int64_t GatherSumScalar(const int32_t* table, const uint32_t* indices, size_t count,
+                        size_t distance) {
+  int64_t sum = 0;
+  size_t i = 0;
+  if (distance > 0 && count > distance) {
+    for (size_t end = count - distance; i < end; ++i) {
+      prefetch::Touch<Hint>(table + indices[i + distance]);
+      sum += table[indices[i]];
+    }
+  }
+  for (; i < count; ++i) {
+    sum += table[indices[i]];
+  }
+  return sum;
+}
+
+// ============================================================================
+// AVX2
+// ============================================================================
+
+template <int Hint>
+__attribute__((target("avx2"))) void GatherAvx2(const int32_t* table, const uint32_t* indices,
+                                                size_t count, int32_t* out, size_t distance) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    if (distance > 0) {
+      PrefetchBlock<Hint>(table, indices, i + distance, 8, count);
+    }
+    __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+    __m256i value = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), table, index,
+                                                _mm256_set1_epi32(-1), 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+  }
+  for (; i < count; ++i) {
+    out[i] = table[indices[i]];
+  }
+}
+
+template <int Hint>
+__attribute__((target("avx2"))) void GatherAvx2(const double* table, const uint32_t* indices,
+                                                size_t count, double* out, size_t distance) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    if (distance > 0) {
+      PrefetchBlock<Hint>(table, indices, i + distance, 4, count);
+    }
+    __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+    __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    _mm256_storeu_pd(out + i, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), table, index, all, 8));
+  }
+  for (; i < count; ++i) {
+    out[i] = table[indices[i]];
+  }
+}
+
+template <int Hint>
+__attribute__((target("avx2"))) int64_t GatherSumAvx2(const int32_t* table,
+                                                      const uint32_t* indices, size_t count,
+                                                      size_t distance) {
+  __m256i low = _mm256_setzero_si256();
+  __m256i high = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    if (distance > 0) {
+      PrefetchBlock<Hint>(table, indices, i + distance, 8, count);
+    }
+    __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+    __m256i value = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), table, index,
+                                                _mm256_set1_epi32(-1), 4);
+    // Сумма в int64: int32 переполняется уже на нескольких тысячах элементов
+    low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(value)));
+    high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(value, 1)));
+  }
+  alignas(32) int64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(low, high));
+  int64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < count; ++i) {
+    sum += table[indices[i]];
+  }
+  return sum;
+}
+
+// ============================================================================
+// AVX-512
+// ============================================================================
+
+template <int Hint>
+__attribute__((target("avx512f"))) void GatherAvx512(const int32_t* table,
+                                                     const uint32_t* indices, size_t count,
+                                                     int32_t* out, size_t distance) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    if (distance > 0) {
+      PrefetchBlock<Hint>(table, indices, i + distance, 16, count);
+    }
+    __m512i index = _mm512_loadu_si512(indices + i);
+    __m512i value = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, table, 4);
+    _mm512_storeu_si512(out + i, value);
+  }
+  for (; i < count; ++i) {
+    out[i] = table[indices[i]];
+  }
+}
+
+template <int Hint>
+__attribute__((target("avx512f"))) void GatherAvx512(const double* table,
+                                                     const uint32_t* indices, size_t count,
+                                                     double* out, size_t distance) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    if (distance > 0) {
+      PrefetchBlock<Hint>(table, indices, i + distance, 8, count);
+    }
+    __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+    _mm512_storeu_pd(out + i, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, index, table, 8));
+  }
+  for (; i < count; ++i) {
+    out[i] = table[indices[i]];
+  }
+}
+
+template <int Hint>
+__attribute__((target("avx512f"))) int64_t GatherSumAvx512(const int32_t* table,
+                                                           const uint32_t* indices, size_t count,
+                                                           size_t distance) {
+  __m512i acc = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    if (distance > 0) {
+      PrefetchBlock<Hint>(table, indices, i + distance, 16, count);
+    }
+    __m512i index = _mm512_loadu_si512(indices + i);
+    __m512i value = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, index, table, 4);
+    __m256i low = _mm512_maskz_extracti64x4_epi64(0xF, value, 0);
+    __m256i high = _mm512_maskz_extracti64x4_epi64(0xF, value, 1);
+    acc = _mm512_add_epi64(acc, _mm512_maskz_cvtepi32_epi64(0xFF, low));
+    acc = _mm512_add_epi64(acc, _mm512_maskz_cvtepi32_epi64(0xFF, high));
+  }
+  alignas(64) int64_t lanes[8];
+  _mm512_store_si512(lanes, acc);
+  int64_t sum = 0;
+  for (int64_t lane : lanes) {
+    sum += lane;
+  }
+  for (; i < count; ++i) {
+    sum += table[indices[i]];
+  }
+  return sum;
+}
+
+template <typename T>
+void GatherImpl(const T* table, const uint32_t* indices, size_t count, T* out,
+                const PrefetchSetting& setting, GatherIsa isa) {
+  size_t distance = setting.distance;
+  switch (ResolveGatherIsa(isa)) {
+    case GatherIsa::kAvx512:
+      DispatchHint(setting.hint, [&](auto hint) {
+        GatherAvx512<decltype(hint)::value>(table, indices, count, out, distance);
+      });
+      break;
+    case GatherIsa::kAvx2:
+      DispatchHint(setting.hint, [&](auto hint) {
+        GatherAvx2<decltype(hint)::value>(table, indices, count, out, distance);
+      });
+      break;
+    default:
+      DispatchHint(setting.hint, [&](auto hint) {
+        GatherScalar<decltype(hint)::value>(table, indices, count, out, distance);
+      });
+      break;
+  }
+}
+
+}  // namespace
+
+const char* GatherIsaName(GatherIsa isa) {
+  switch (isa) {
+    case GatherIsa::kAuto:
+      return "auto";
+    case GatherIsa::kScalar:
+      return "scalar";
+    case GatherIsa::kAvx2:
+      return "avx2";
+    case GatherIsa::kAvx512:
+      return "avx512";
+    default:
+      return "unknown";
+  }
+}
+
+bool GatherIsaSupported(GatherIsa isa) {
+  switch (isa) {
+    case GatherIsa::kAvx2:
+      return __builtin_cpu_supports("avx2");
+    case GatherIsa::kAvx512:
+      return __builtin_cpu_supports("avx512f");
+    default:
+      return true;
+  }
+}
+
+GatherIsa ResolveGatherIsa(GatherIsa isa) {
+  if (isa == GatherIsa::kAuto) {
+    // На многих ядрах gather не быстрее скалярных загрузок, но
+    // при промахах в DRAM важна только параллельность запросов
+    if (GatherIsaSupported(GatherIsa::kAvx512)) {
+      return GatherIsa::kAvx512;
+    }
+    return GatherIsaSupported(GatherIsa::kAvx2) ? GatherIsa::kAvx2 : GatherIsa::kScalar;
+  }
+  return GatherIsaSupported(isa) ? isa : GatherIsa::kScalar;
+}
+
+void Gather(const int32_t* table, const uint32_t* indices, size_t count, int32_t* out,
+            const PrefetchSetting& setting, GatherIsa isa) {
+  GatherImpl(table, indices, count, out, setting, isa);
+}
+
+void Gather(const double* table, const uint32_t* indices, size_t count, double* out,
+            const PrefetchSetting& setting, GatherIsa isa) {
+  GatherImpl(table, indices, count, out, setting, isa);
+}
+
+int64_t GatherSum(const int32_t* table, const uint32_t* indices, size_t count,
+                  const PrefetchSetting& setting, GatherIsa isa) {
+  int64_t sum = 0;
+  size_t distance = setting.distance;
+  switch (ResolveGatherIsa(isa)) {
+    case GatherIsa::kAvx512:
+      DispatchHint(setting.hint, [&](auto hint) {
+        sum = GatherSumAvx512<decltype(hint)::value>(table, indices, count, distance);
+      });
+      break;
+    case GatherIsa::kAvx2:
+      DispatchHint(setting.hint, [&](auto hint) {
+        sum = GatherSumAvx2<decltype(hint)::value>(table, indices, count, distance);
+      });
+      break;
+    default:
+      DispatchHint(setting.hint, [&](auto hint) {
+        sum = GatherSumScalar<decltype(hint)::value>(table, indices, count, distance);
+      });
+      break;
+  }
+  return sum;
+}
+
+// ============================================================================
+// FlatHashMap
+// ============================================================================
+
+FlatHashMap::FlatHashMap(size_t expected_keys, double max_load) : size_(0) {
+  if (!(max_load > 0.0 && max_load < 1.0)) {
+    throw std::invalid_argument("max_load must be in (0, 1)");
+  }
+  size_t capacity = 16;
+  while (capacity * max_load < static_cast<double>(expected_keys)) {
+    capacity *= 2;
+  }
+  slots_.assign(capacity, {kEmptyKey, 0});
+  mask_ = capacity - 1;
+  max_size_ = std::max<size_t>(1, static_cast<size_t>(capacity * max_load));
+}
+
+uint64_t FlatHashMap::Hash(uint64_t key) {
+  // Финализатор MurmurHash3: соседние ключи расходятся по всей таблице
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+size_t FlatHashMap::Probe(uint64_t key, size_t slot) const {
+  while (slots_[slot].key != key && slots_[slot].key != kEmptyKey) {
+    slot = (slot + 1) & mask_;
+  }
+  return slot;
+}
+
+bool FlatHashMap::Insert(uint64_t key, uint64_t value) {
+  if (key == kEmptyKey) {
+    throw std::invalid_argument("Key is reserved for empty slots");
+  }
+  size_t slot = Probe(key, Hash(key) & mask_);
+  if (slots_[slot].key == key) {
+    slots_[slot].value = value;
+    return false;
+  }
+  if (size_ >= max_size_) {
+    throw std::length_error("FlatHashMap is full");
+  }
+  slots_[slot] = {key, value};
+  ++size_;
+  return true;
+}
+
+bool FlatHashMap::Find(uint64_t key, uint64_t* value) const {
+  const Slot& slot = slots_[Probe(key, Hash(key) & mask_)];
+  if (slot.key != key || key == kEmptyKey) {
+    return false;
+  }
+  if (value != nullptr) {
+    *value = slot.value;
+  }
+  return true;
+}
+
+size_t FlatHashMap::FindBatch(const uint64_t* keys, size_t count, uint64_t* values,
+                              uint8_t* found, size_t group) const {
+  constexpr size_t kMaxGroup = 64;
+  group = std::min(std::max<size_t>(group, 1), kMaxGroup);
+  size_t start[kMaxGroup];
+  size_t hits = 0;
+
+  for (size_t base = 0; base < count; base += group) {
+    size_t n = std::min(group, count - base);
+    // Фаза 1: хеши и запросы слотов всей группы
+    for (size_t j = 0; j < n; ++j) {
+      start[j] = Hash(keys[base + j]) & mask_;
+      __builtin_prefetch(&slots_[start[j]], 0, 3);
+    }
+    // Фаза 2: пробирование - слоты уже в пути или в кэше
+    for (size_t j = 0; j < n; ++j) {
+      uint64_t key = keys[base + j];
+      const Slot& slot = slots_[Probe(key, start[j])];
+      bool hit = slot.key == key && key != kEmptyKey;
+      if (hit) {
+        values[base + j] = slot.value;
+        ++hits;
+      }
+      if (found != nullptr) {
+        found[base + j] = hit;
+      }
+    }
+  }
+  return hits;
+}
+
+// ============================================================================
+// Микробенчмарк
+// ============================================================================
+
+namespace {
+
+uint64_t SplitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+template <typename F>
+double BestNsPerLookup(size_t repetitions, size_t lookups, F&& run) {
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t r = 0; r < std::max<size_t>(repetitions, 1); ++r) {
+    auto started = std::chrono::steady_clock::now();
+    run();
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    best = std::min(best, seconds);
+  }
+  return best * 1e9 / static_cast<double>(std::max<size_t>(lookups, 1));
+}
+
+}  // namespace
+
+std::vector<IndirectBenchResult> RunIndirectBenchmark(const IndirectBenchConfig& config) {
+  std::vector<IndirectBenchResult> results;
+  uint64_t state = config.seed;
+  size_t lookups = std::max<size_t>(config.lookups, 1);
+  volatile int64_t sink = 0;
+
+  // Gather по таблице int32
+  size_t elements = std::min<size_t>(std::max<size_t>(config.table_bytes / sizeof(int32_t), 1),
+                                     size_t{1} << 31);
+  std::vector<int32_t> table(elements);
+  for (size_t i = 0; i < elements; ++i) {
+    table[i] = static_cast<int32_t>(i);
+  }
+  std::vector<uint32_t> indices(lookups);
+  for (auto& index : indices) {
+    index = static_cast<uint32_t>(SplitMix64(state) % elements);
+  }
+  std::vector<int32_t> out(lookups);
+
+  double gather_base = 0.0;
+  for (GatherIsa isa : {GatherIsa::kScalar, GatherIsa::kAvx2, GatherIsa::kAvx512}) {
+    if (!GatherIsaSupported(isa)) {
+      continue;
+    }
+    for (size_t distance : {size_t{0}, config.distance}) {
+      PrefetchSetting setting = {distance, 0};
+      double ns = BestNsPerLookup(config.repetitions, lookups, [&]() {
+        Gather(table.data(), indices.data(), lookups, out.data(), setting, isa);
+        sink = sink + out[lookups - 1];
+      });
+      if (gather_base == 0.0) {
+        gather_base = ns;
+      }
+      std::string name = std::string("gather ") + GatherIsaName(isa) +
+                         (distance > 0 ? " +prefetch " + std::to_string(distance) : "");
+      results.push_back({name, ns, gather_base / ns});
+      if (config.distance == 0) {
+        break;
+      }
+    }
+  }
+  table = std::vector<int32_t>();
+
+  // Поиск в хеш-таблице того же объёма
+  size_t keys_count = std::max<size_t>(config.table_bytes / 16 / 2, 1);
+  FlatHashMap map(keys_count);
+  std::vector<uint64_t> keys(keys_count);
+  for (size_t i = 0; i < keys_count; ++i) {
+    keys[i] = SplitMix64(state) & ~(1ULL << 63);   // Не совпадает с kEmptyKey
+    map.Insert(keys[i], i);
+  }
+  std::vector<uint64_t> probes(lookups);
+  for (auto& probe : probes) {
+    probe = keys[SplitMix64(state) % keys_count];
+  }
+  std::vector<uint64_t> values(lookups);
+
+  double single = BestNsPerLookup(config.repetitions, lookups, [&]() {
+    size_t hits = 0;
+    for (size_t i = 0; i < lookups; ++i) {
+      hits += map.Find(probes[i], &values[i]);
+    }
+    sink = sink + static_cast<int64_t>(hits);
+  });
+  results.push_back({"hash probe", single, 1.0});
+  double batched = BestNsPerLookup(config.repetitions, lookups, [&]() {
+    sink = sink + static_cast<int64_t>(
+                      map.FindBatch(probes.data(), lookups, values.data(), nullptr, config.group));
+  });
+  results.push_back({"hash probe batch " + std::to_string(config.group), batched,
+                     single / batched});
+  return results;
+}
+
+}  // namespace hardware_analysis
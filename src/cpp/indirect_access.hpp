@@ -0,0 +1,147 @@
+#ifndef INDIRECT_ACCESS_HPP
+#define INDIRECT_ACCESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "prefetch_loops.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Набор инструкций для gather
+ */
+enum class GatherIsa {
+  kAuto = 0,   // Лучший поддерживаемый процессором
+  kScalar,
+  kAvx2,
+  kAvx512
+};
+
+const char* GatherIsaName(GatherIsa isa);
+
+/**
+ * @brief Поддерживает ли процессор (и сборка) данный вариант
+ */
+bool GatherIsaSupported(GatherIsa isa);
+
+/**
+ * @brief kAuto -> конкретный вариант; неподдерживаемый -> kScalar
+ */
+GatherIsa ResolveGatherIsa(GatherIsa isa);
+
+// ============================================================================
+// Gather: out[i] = table[indices[i]]
+// ============================================================================
+
+/**
+ * @brief Выборка по индексам с программной предвыборкой table[indices[i + distance]]
+ *
+ * Векторные варианты используют vpgatherdd/vgatherdpd: индексы знаковые
+ * 32-битные, поэтому indices[i] < 2^31.
+ *
+ * @param setting Дистанция предвыборки в элементах (0 - без предвыборки)
+ */
+void Gather(const int32_t* table, const uint32_t* indices, size_t count, int32_t* out,
+            const PrefetchSetting& setting = {}, GatherIsa isa = GatherIsa::kAuto);
+void Gather(const double* table, const uint32_t* indices, size_t count, double* out,
+            const PrefetchSetting& setting = {}, GatherIsa isa = GatherIsa::kAuto);
+
+/**
+ * @brief Сумма table[indices[i]] без промежуточного буфера
+ */
+int64_t GatherSum(const int32_t* table, const uint32_t* indices, size_t count,
+                  const PrefetchSetting& setting = {}, GatherIsa isa = GatherIsa::kAuto);
+
+// ============================================================================
+// Хеш-таблица с пакетным поиском
+// ============================================================================
+
+/**
+ * @brief Хеш-таблица uint64 -> uint64 с открытой адресацией (линейное пробирование)
+ *
+ * Слот - 16 байт, четыре на кэш-линию. FindBatch() сначала считает хеши
+ * группы ключей и запрашивает их слоты, затем пробирует: промахи группы
+ * обслуживаются памятью параллельно, а не по одному.
+ */
+class FlatHashMap {
+ public:
+  static constexpr uint64_t kEmptyKey = ~0ULL;
+
+  /**
+   * @param expected_keys Ожидаемое число ключей
+   * @param max_load Максимальная заполненность (0, 1)
+   * @throws std::invalid_argument при недопустимом max_load
+   */
+  explicit FlatHashMap(size_t expected_keys, double max_load = 0.5);
+
+  /**
+   * @brief Вставка или замена значения
+   * @return true если ключ новый
+   * @throws std::invalid_argument для kEmptyKey
+   * @throws std::length_error если таблица заполнена
+   */
+  bool Insert(uint64_t key, uint64_t value);
+
+  bool Find(uint64_t key, uint64_t* value) const;
+
+  /**
+   * @brief Поиск массива ключей группами по group с предвыборкой слотов
+   * @param values Значения (не изменяются для отсутствующих ключей)
+   * @param found Признаки найденных ключей (может быть nullptr)
+   * @return Число найденных ключей
+   */
+  size_t FindBatch(const uint64_t* keys, size_t count, uint64_t* values, uint8_t* found,
+                   size_t group = 16) const;
+
+  size_t Size() const { return size_; }
+  size_t Capacity() const { return slots_.size(); }
+
+  static uint64_t Hash(uint64_t key);
+
+ private:
+  struct Slot {
+    uint64_t key;
+    uint64_t value;
+  };
+
+  size_t Probe(uint64_t key, size_t slot) const;
+
+  std::vector<Slot> slots_;
+  size_t mask_;
+  size_t size_;
+  size_t max_size_;
+};
+
+// ============================================================================
+// Микробенчмарк
+// ============================================================================
+
+struct IndirectBenchConfig {
+  size_t table_bytes = 256u << 20;   // Больше LLC: каждый доступ - промах в DRAM
+  size_t lookups = 1u << 22;
+  size_t distance = 16;              // Дистанция предвыборки для gather
+  size_t group = 16;                 // Размер группы FindBatch
+  size_t repetitions = 3;
+  uint64_t seed = 1;
+};
+
+struct IndirectBenchResult {
+  std::string name;
+  double ns_per_lookup;
+  double speedup;                    // Относительно первого варианта своей группы
+};
+
+/**
+ * @brief Gather (int32) и поиск в FlatHashMap на случайном потоке индексов
+ *
+ * Каждый вариант - лучший из repetitions прогонов. Для gather базой служит
+ * скалярный цикл без предвыборки, для хеш-таблицы - поиск по одному ключу.
+ */
+std::vector<IndirectBenchResult> RunIndirectBenchmark(const IndirectBenchConfig& config);
+
+}  // namespace hardware_analysis
+
+#endif  // INDIRECT_ACCESS_HPP
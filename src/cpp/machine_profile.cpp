@@ -0,0 +1,131 @@
+#include "machine_profile.hpp"
+#include "cache_topology.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/property_tree/json_parser.hpp>
+
+namespace hardware_analysis {
+
+namespace {
+
+using boost::property_tree::ptree;
+
+/**
+ * @brief Путь к профилю модели: названия моделей содержат '.', поэтому разделитель '/'
+ */
+ptree::path_type MachinePath(const std::string& cpu_model) {
+  return ptree::path_type("machines/" + cpu_model, '/');
+}
+
+/**
+ * @brief Чтение всего файла профиля без проверки версии (пустое дерево, если файла нет)
+ */
+ptree ReadProfileTree(const std::string& path) {
+  ptree root;
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return root;
+  }
+
+  try {
+    boost::property_tree::read_json(file, root);
+  } catch (const boost::property_tree::json_parser_error& e) {
+    throw std::runtime_error("Malformed machine profile " + path + ": " + e.what());
+  }
+  return root;
+}
+
+/**
+ * @brief Чтение файла профиля; файл другой версии формата игнорируется
+ */
+ptree ReadProfileFile(const std::string& path) {
+  ptree root = ReadProfileTree(path);
+  int version = root.get<int>("version", 0);
+  if (!root.empty() && version != MachineProfile::kFormatVersion) {
+    std::cerr << "Warning: machine profile " << path << " has format version " << version
+              << " (expected " << MachineProfile::kFormatVersion << "), ignoring it\n";
+    return ptree();
+  }
+  return root;
+}
+
+}  // namespace
+
+MachineProfile::MachineProfile(const std::string& cpu_model) : cpu_model_(cpu_model) {}
+
+std::string MachineProfile::DetectCpuModel(const std::string& proc_root) {
+  std::ifstream cpuinfo(proc_root + "/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") != 0) {
+      continue;
+    }
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    size_t begin = line.find_first_not_of(" \t", colon + 1);
+    size_t end = line.find_last_not_of(" \t");
+    if (begin != std::string::npos) {
+      return line.substr(begin, end - begin + 1);
+    }
+  }
+  return "unknown";
+}
+
+std::string MachineProfile::DetectCacheSignature(const std::string& sysfs_cpu_root) {
+  return CacheTopology::ReadSysfs(sysfs_cpu_root, {0}).Signature();
+}
+
+std::string MachineProfile::DefaultPath() {
+  if (const char* path = std::getenv("HARDWARE_ANALYSIS_PROFILE")) {
+    return path;
+  }
+  const char* home = std::getenv("HOME");
+  return std::string(home ? home : ".") + "/.config/hardware_analysis/machine_profile.json";
+}
+
+MachineProfile MachineProfile::Load(const std::string& path, const std::string& cpu_model) {
+  MachineProfile profile(cpu_model);
+  ptree root = ReadProfileFile(path);
+  if (auto machine = root.get_child_optional(MachinePath(cpu_model))) {
+    profile.data_ = *machine;
+  }
+  return profile;
+}
+
+void MachineProfile::Save(const std::string& path) const {
+  // Файл другой версии хранит профили других моделей: перезапись их бы стёрла
+  ptree root = ReadProfileTree(path);
+  int version = root.get<int>("version", 0);
+  if (!root.empty() && version != kFormatVersion) {
+    throw std::runtime_error("Machine profile " + path + " has format version " +
+                             std::to_string(version) + " (expected " +
+                             std::to_string(kFormatVersion) +
+                             "); move it away to save a new profile");
+  }
+  root.put("version", kFormatVersion);
+  root.put_child(MachinePath(cpu_model_), data_);
+
+  std::filesystem::path directory = std::filesystem::path(path).parent_path();
+  std::error_code error;
+  if (!directory.empty() && !std::filesystem::create_directories(directory, error) && error) {
+    throw std::runtime_error("Failed to create " + directory.string() + ": " + error.message());
+  }
+
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path + " for writing");
+  }
+  boost::property_tree::write_json(file, root);
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path);
+  }
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,101 @@
+#ifndef MACHINE_PROFILE_HPP
+#define MACHINE_PROFILE_HPP
+
+#include <string>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Профиль машины: результаты калибровочных бенчмарков
+ *
+ * JSON файл хранит профили нескольких моделей CPU (ключ - "model name" из
+ * /proc/cpuinfo), так что один файл можно раздавать на разнородный парк:
+ *
+ *   {"version": 1, "machines": {"<cpu model>": {"frequency_transition": {...}}}}
+ *
+ * Ключи внутри профиля - пути property_tree через '.'. Файл другой версии
+ * формата не читается: результаты бенчмарков дешевле перемерить, чем
+ * мигрировать.
+ */
+class MachineProfile {
+ public:
+  static constexpr int kFormatVersion = 1;
+
+  /**
+   * @brief Пустой профиль для модели CPU
+   */
+  explicit MachineProfile(const std::string& cpu_model);
+
+  /**
+   * @brief Модель CPU из /proc/cpuinfo ("unknown", если не найдена)
+   * @param proc_root Корень procfs (для тестов - фейковое дерево)
+   */
+  static std::string DetectCpuModel(const std::string& proc_root = "/proc");
+
+  /**
+   * @brief Сигнатура иерархии кэшей cpu0, например "L1d:48K L1i:32K L2:2048K L3:36864K"
+   *
+   * Одна модель CPU встречается с разным объёмом LLC (SKU, ВМ), а настройки
+   * блоков зависят именно от него. "unknown", если sysfs недоступен.
+   *
+   * @param sysfs_cpu_root Корень /sys/devices/system/cpu (для тестов - фейковое дерево)
+   */
+  static std::string DetectCacheSignature(
+      const std::string& sysfs_cpu_root = "/sys/devices/system/cpu");
+
+  /**
+   * @brief Путь по умолчанию: $HARDWARE_ANALYSIS_PROFILE или
+   *        ~/.config/hardware_analysis/machine_profile.json
+   */
+  static std::string DefaultPath();
+
+  /**
+   * @brief Загрузка профиля модели из файла
+   * @param path JSON файл; отсутствующий файл даёт пустой профиль
+   * @param cpu_model Модель CPU
+   * @throws std::runtime_error если файл не является корректным JSON
+   */
+  static MachineProfile Load(const std::string& path, const std::string& cpu_model);
+
+  /**
+   * @brief Сохранение с сохранением профилей других моделей в том же файле
+   * @throws std::runtime_error при ошибке записи или если файл другой версии
+   *         формата (он не перезаписывается)
+   */
+  void Save(const std::string& path) const;
+
+  const std::string& GetCpuModel() const { return cpu_model_; }
+
+  /**
+   * @brief Данные профиля (для записи поддеревьев бенчмарками)
+   */
+  boost::property_tree::ptree& Data() { return data_; }
+  const boost::property_tree::ptree& Data() const { return data_; }
+
+  /**
+   * @brief Значение по пути или fallback
+   */
+  template <typename T>
+  T Get(const std::string& key, const T& fallback) const {
+    return data_.get<T>(key, fallback);
+  }
+
+  template <typename T>
+  void Put(const std::string& key, const T& value) {
+    data_.put(key, value);
+  }
+
+  bool Has(const std::string& key) const {
+    return data_.get_child_optional(key).has_value();
+  }
+
+ private:
+  std::string cpu_model_;
+  boost::property_tree::ptree data_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // MACHINE_PROFILE_HPP
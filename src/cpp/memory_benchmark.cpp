@@ -0,0 +1,714 @@
+#include "memory_benchmark.hpp"
+#include "cpu_topology.hpp"
+#include "machine_profile.hpp"
+#include <numa.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr size_t kLineBytes = 64;
+constexpr size_t kSmallPage = 4096;
+constexpr size_t kHugePage = 2u << 20;
+
+// Приёмник результатов, чтобы компилятор не выбросил циклы
+volatile uintptr_t g_sink;
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+size_t RoundUp(size_t value, size_t align) {
+  return (value + align - 1) / align * align;
+}
+
+/**
+ * @brief Барьер на атомиках для синхронного старта проходов
+ */
+class SpinBarrier {
+ public:
+  explicit SpinBarrier(size_t count) : count_(count), waiting_(0), generation_(0) {}
+
+  void Wait() {
+    size_t generation = generation_.load(std::memory_order_acquire);
+    if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+      waiting_.store(0, std::memory_order_relaxed);
+      generation_.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    // yield: потоков может быть больше, чем свободных CPU
+    while (generation_.load(std::memory_order_acquire) == generation) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  const size_t count_;
+  std::atomic<size_t> waiting_;
+  std::atomic<size_t> generation_;
+};
+
+/**
+ * @brief Выброс первого исключения рабочих потоков после join
+ */
+void RethrowFirst(const std::vector<std::exception_ptr>& errors) {
+  for (const std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+/**
+ * @brief Связывание узлов цепочки: узел i лежит по offsets[i], ведёт к next[i]
+ */
+char* LinkChain(char* base, const std::vector<uint32_t>& next,
+                const std::vector<size_t>& offsets) {
+  for (size_t i = 0; i < next.size(); ++i) {
+    *reinterpret_cast<char**>(base + offsets[i]) = base + offsets[next[i]];
+  }
+  return base + offsets[0];
+}
+
+/**
+ * @brief Лучшее время перехода по цепочке, нс
+ *
+ * Каждая загрузка зависит от предыдущей, поэтому время перехода равно
+ * латентности уровня, где лежит рабочий набор.
+ */
+double ChaseNs(char* start, size_t nodes, size_t accesses, size_t repetitions) {
+  accesses = std::max<size_t>(8, RoundUp(accesses, 8));
+  char* p = start;
+  // Прогрев: один обход кладёт набор в кэш и TLB
+  for (size_t i = 0; i < nodes; ++i) {
+    p = *reinterpret_cast<char**>(p);
+  }
+
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t rep = 0; rep < repetitions; ++rep) {
+    auto begin = Clock::now();
+    for (size_t i = 0; i < accesses; i += 8) {
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+      p = *reinterpret_cast<char**>(p);
+    }
+    best = std::min(best, Seconds(begin, Clock::now()) * 1e9 / static_cast<double>(accesses));
+  }
+  g_sink = reinterpret_cast<uintptr_t>(p);
+  return best;
+}
+
+uint64_t ReadKernel(const char* data, size_t bytes) {
+  const uint64_t* words = reinterpret_cast<const uint64_t*>(data);
+  size_t count = bytes / sizeof(uint64_t);
+  uint64_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    sum0 += words[i];
+    sum1 += words[i + 1];
+    sum2 += words[i + 2];
+    sum3 += words[i + 3];
+  }
+  for (; i < count; ++i) {
+    sum0 += words[i];
+  }
+  return sum0 + sum1 + sum2 + sum3;
+}
+
+/**
+ * @brief Один проход ядра пропускной способности
+ * @return Байты, переданные через память (copy: чтение + запись)
+ */
+size_t BandwidthPass(const std::string& kind, char* data, size_t bytes, size_t pass) {
+  if (kind == "read") {
+    g_sink = ReadKernel(data, bytes);
+    return bytes;
+  }
+  if (kind == "write") {
+    std::fill(reinterpret_cast<uint64_t*>(data), reinterpret_cast<uint64_t*>(data + bytes),
+              pass + 1);
+    return bytes;
+  }
+  if (kind == "mixed") {
+    // Пропорции STREAM triad: два потока чтения на один поток записи
+    uint64_t* words = reinterpret_cast<uint64_t*>(data);
+    size_t third = bytes / sizeof(uint64_t) / 3;
+    const uint64_t* a = words;
+    const uint64_t* b = words + third;
+    uint64_t* c = words + 2 * third;
+    for (size_t i = 0; i < third; ++i) {
+      c[i] = a[i] + b[i];
+    }
+    return 3 * third * sizeof(uint64_t);
+  }
+  size_t half = bytes / 2;
+  std::memcpy(data + half, data, half);
+  return 2 * half;
+}
+
+int NodeOfCpu(int cpu) {
+  if (numa_available() == -1) {
+    return 0;
+  }
+  return std::max(0, numa_node_of_cpu(cpu));
+}
+
+}  // namespace
+
+const char* PageSizeName(PageSize page) {
+  return page == PageSize::k2M ? "2m" : "4k";
+}
+
+// ============================================================================
+// BenchmarkBuffer
+// ============================================================================
+
+BenchmarkBuffer::BenchmarkBuffer(size_t bytes, PageSize page, int numa_node)
+    : data_(nullptr), bytes_(bytes), mapped_bytes_(0), backing_("4k") {
+  if (bytes == 0) {
+    throw std::invalid_argument("Benchmark buffer size must be positive");
+  }
+  const int prot = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void* ptr = MAP_FAILED;
+
+  if (page == PageSize::k2M) {
+    mapped_bytes_ = RoundUp(bytes, kHugePage);
+    ptr = mmap(nullptr, mapped_bytes_, prot, flags | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      backing_ = "hugetlb";
+    } else {
+      // Пул hugetlbfs пуст: выровненная область под THP, хвосты отрезаются
+      size_t reserve = mapped_bytes_ + kHugePage;
+      void* raw = mmap(nullptr, reserve, prot, flags, -1, 0);
+      if (raw == MAP_FAILED) {
+        throw std::runtime_error("mmap of " + std::to_string(reserve) + " bytes failed");
+      }
+      uintptr_t begin = RoundUp(reinterpret_cast<uintptr_t>(raw), kHugePage);
+      size_t head = begin - reinterpret_cast<uintptr_t>(raw);
+      if (head > 0) {
+        munmap(raw, head);
+      }
+      if (reserve - head > mapped_bytes_) {
+        munmap(reinterpret_cast<char*>(begin) + mapped_bytes_, reserve - head - mapped_bytes_);
+      }
+      ptr = reinterpret_cast<void*>(begin);
+      backing_ = madvise(ptr, mapped_bytes_, MADV_HUGEPAGE) == 0 ? "thp" : "4k";
+    }
+  } else {
+    mapped_bytes_ = RoundUp(bytes, kSmallPage);
+    ptr = mmap(nullptr, mapped_bytes_, prot, flags, -1, 0);
+    if (ptr == MAP_FAILED) {
+      throw std::runtime_error("mmap of " + std::to_string(mapped_bytes_) + " bytes failed");
+    }
+    madvise(ptr, mapped_bytes_, MADV_NOHUGEPAGE);
+  }
+
+  data_ = static_cast<char*>(ptr);
+  if (numa_node >= 0 && numa_available() != -1) {
+    numa_tonode_memory(data_, mapped_bytes_, numa_node);
+  }
+  std::memset(data_, 0, mapped_bytes_);
+}
+
+BenchmarkBuffer::~BenchmarkBuffer() {
+  munmap(data_, mapped_bytes_);
+}
+
+// ============================================================================
+// MemoryBenchmark
+// ============================================================================
+
+MemoryBenchmark::MemoryBenchmark(const MemoryBenchConfig& config) : config_(config) {
+  if (config_.repetitions == 0) {
+    config_.repetitions = 1;
+  }
+  if (config_.steps_per_octave == 0) {
+    config_.steps_per_octave = 1;
+  }
+  if (config_.min_working_set < 2 * kLineBytes ||
+      config_.max_working_set < config_.min_working_set) {
+    throw std::invalid_argument("Invalid working set range");
+  }
+  if (config_.bandwidth_bytes < kSmallPage || config_.stride_buffer_bytes < kSmallPage) {
+    throw std::invalid_argument("Bandwidth and stride buffers must hold at least one page");
+  }
+  if (config_.min_tlb_pages < 2 || config_.max_tlb_pages < config_.min_tlb_pages) {
+    throw std::invalid_argument("Invalid TLB page range");
+  }
+  if (config_.cpus.empty()) {
+    config_.cpus = {config_.cpu};
+  }
+}
+
+std::vector<size_t> MemoryBenchmark::WorkingSetSizes(size_t min_bytes, size_t max_bytes,
+                                                     size_t steps_per_octave) {
+  std::vector<size_t> sizes;
+  steps_per_octave = std::max<size_t>(1, steps_per_octave);
+  for (size_t octave = min_bytes; octave <= max_bytes; octave *= 2) {
+    for (size_t step = 0; step < steps_per_octave; ++step) {
+      double scale = std::pow(2.0, static_cast<double>(step) / steps_per_octave);
+      size_t size = RoundUp(static_cast<size_t>(octave * scale), kLineBytes);
+      if (size <= max_bytes && (sizes.empty() || size > sizes.back())) {
+        sizes.push_back(size);
+      }
+    }
+    if (octave > max_bytes / 2) {
+      break;
+    }
+  }
+  return sizes;
+}
+
+std::vector<uint32_t> MemoryBenchmark::ChaseOrder(size_t count, uint64_t seed) {
+  if (count > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Chase too long");
+  }
+  // Sattolo: перестановка из одного цикла, без коротких петель
+  std::vector<uint32_t> items(count);
+  for (size_t i = 0; i < count; ++i) {
+    items[i] = static_cast<uint32_t>(i);
+  }
+  std::mt19937_64 rng(seed);
+  for (size_t i = count; i > 1; --i) {
+    std::uniform_int_distribution<size_t> pick(0, i - 2);
+    std::swap(items[i - 1], items[pick(rng)]);
+  }
+  std::vector<uint32_t> next(count);
+  for (size_t i = 0; i < count; ++i) {
+    next[items[i]] = items[(i + 1) % count];
+  }
+  return next;
+}
+
+double MemoryBenchmark::MeasureLatency(size_t working_set, PageSize page) const {
+  ScopedAffinity affinity;
+  PinOrWarn(affinity, config_.cpu, "memory benchmark");
+
+  size_t nodes = std::max<size_t>(2, working_set / kLineBytes);
+  BenchmarkBuffer buffer(nodes * kLineBytes, page, config_.numa_node);
+  std::vector<size_t> offsets(nodes);
+  for (size_t i = 0; i < nodes; ++i) {
+    offsets[i] = i * kLineBytes;
+  }
+  char* start = LinkChain(buffer.data(), ChaseOrder(nodes, nodes), offsets);
+  return ChaseNs(start, nodes, config_.chase_accesses, config_.repetitions);
+}
+
+std::vector<LatencyPoint> MemoryBenchmark::LatencyCurve(PageSize page) const {
+  std::vector<LatencyPoint> curve;
+  for (size_t size : WorkingSetSizes(config_.min_working_set, config_.max_working_set,
+                                     config_.steps_per_octave)) {
+    curve.push_back({size, page, MeasureLatency(size, page)});
+  }
+  return curve;
+}
+
+double MemoryBenchmark::ReadBandwidth(size_t working_set) const {
+  ScopedAffinity affinity;
+  PinOrWarn(affinity, config_.cpu, "memory benchmark");
+  BenchmarkBuffer buffer(std::max(working_set, kLineBytes), PageSize::k4K, config_.numa_node);
+  const size_t passes = std::max<size_t>(1, config_.bandwidth_bytes / buffer.size());
+
+  g_sink = ReadKernel(buffer.data(), buffer.size());
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t rep = 0; rep < config_.repetitions; ++rep) {
+    uint64_t sum = 0;
+    auto begin = Clock::now();
+    for (size_t pass = 0; pass < passes; ++pass) {
+      sum += ReadKernel(buffer.data(), buffer.size());
+    }
+    best = std::min(best, Seconds(begin, Clock::now()));
+    g_sink = sum;
+  }
+  return best > 0.0 ? static_cast<double>(passes) * buffer.size() / best / 1e9 : 0.0;
+}
+
+std::vector<BandwidthResult> MemoryBenchmark::Bandwidth() const {
+  std::vector<BandwidthResult> results;
+  const size_t threads = config_.cpus.size();
+  const size_t passes = std::max<size_t>(1, config_.bandwidth_passes);
+
+  for (const char* kind : {"read", "write", "copy"}) {
+    // seconds[поток][проход]
+    std::vector<std::vector<double>> seconds(threads, std::vector<double>(passes, 0.0));
+    std::vector<size_t> moved(threads, 0);
+    SpinBarrier barrier(threads);
+    std::vector<std::exception_ptr> errors(threads);
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        ScopedAffinity affinity;
+        PinOrWarn(affinity, config_.cpus[t], "memory benchmark");
+        // Буфер создаётся уже на своём CPU: first touch кладёт его на локальный узел
+        std::unique_ptr<BenchmarkBuffer> buffer;
+        try {
+          buffer.reset(new BenchmarkBuffer(config_.bandwidth_bytes, PageSize::k4K,
+                                           config_.numa_node));
+          BandwidthPass(kind, buffer->data(), buffer->size(), 0);
+        } catch (...) {
+          errors[t] = std::current_exception();
+          buffer.reset();
+        }
+        // Поток без буфера всё равно проходит барьеры, иначе остальные ждут вечно
+        for (size_t pass = 0; pass < passes; ++pass) {
+          barrier.Wait();
+          if (!buffer) {
+            continue;
+          }
+          auto begin = Clock::now();
+          moved[t] = BandwidthPass(kind, buffer->data(), buffer->size(), pass);
+          seconds[t][pass] = Seconds(begin, Clock::now());
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    RethrowFirst(errors);
+
+    // Проход длится до конца самого медленного потока
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t pass = 0; pass < passes; ++pass) {
+      double slowest = 0.0;
+      for (size_t t = 0; t < threads; ++t) {
+        slowest = std::max(slowest, seconds[t][pass]);
+      }
+      best = std::min(best, slowest);
+    }
+    size_t total = 0;
+    for (size_t bytes : moved) {
+      total += bytes;
+    }
+    results.push_back({kind, threads, best > 0.0 ? total / best / 1e9 : 0.0, best});
+  }
+  return results;
+}
+
+std::vector<SaturationPoint> MemoryBenchmark::SaturationCurve(const std::string& kind) const {
+  if (kind != "read" && kind != "write" && kind != "mixed") {
+    throw std::invalid_argument("Unknown saturation stream: " + kind);
+  }
+  const size_t max_threads = config_.cpus.size();
+
+  // Цепочка зонда строится один раз на кривую, на узле памяти теста
+  size_t nodes = std::max<size_t>(2, config_.saturation_chase_bytes / kLineBytes);
+  BenchmarkBuffer chase(nodes * kLineBytes, PageSize::k4K, config_.numa_node);
+  std::vector<size_t> offsets(nodes);
+  for (size_t i = 0; i < nodes; ++i) {
+    offsets[i] = i * kLineBytes;
+  }
+  char* start = LinkChain(chase.data(), ChaseOrder(nodes, nodes), offsets);
+
+  std::vector<SaturationPoint> curve;
+  for (size_t threads = 1; threads <= max_threads; ++threads) {
+    const bool probe = threads < max_threads;
+    std::vector<size_t> moved(threads, 0);
+    std::vector<double> seconds(threads, 0.0);
+    // Без свободного CPU задержка не измеряется: NaN, а не правдоподобный ноль
+    double probe_ns = std::numeric_limits<double>::quiet_NaN();
+    std::atomic<bool> stop(false);
+    // Потоки, зонд и управляющий поток стартуют вместе
+    SpinBarrier barrier(threads + (probe ? 1 : 0) + 1);
+    std::vector<std::exception_ptr> errors(threads);
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        ScopedAffinity affinity;
+        PinOrWarn(affinity, config_.cpus[t], "memory benchmark");
+        std::unique_ptr<BenchmarkBuffer> buffer;
+        try {
+          buffer.reset(new BenchmarkBuffer(config_.bandwidth_bytes, PageSize::k4K,
+                                           config_.numa_node));
+          BandwidthPass(kind, buffer->data(), buffer->size(), 0);
+        } catch (...) {
+          errors[t] = std::current_exception();
+          buffer.reset();
+        }
+        barrier.Wait();
+        if (!buffer) {
+          return;
+        }
+        auto begin = Clock::now();
+        size_t bytes = 0;
+        size_t pass = 1;
+        do {
+          bytes += BandwidthPass(kind, buffer->data(), buffer->size(), pass++);
+        } while (!stop.load(std::memory_order_relaxed));
+        seconds[t] = Seconds(begin, Clock::now());
+        moved[t] = bytes;
+      });
+    }
+    if (probe) {
+      workers.emplace_back([&] {
+        ScopedAffinity affinity;
+        PinOrWarn(affinity, config_.cpus[threads], "memory benchmark");
+        char* p = start;
+        size_t accesses = 0;
+        barrier.Wait();
+        auto begin = Clock::now();
+        while (!stop.load(std::memory_order_relaxed)) {
+          for (int i = 0; i < 64; ++i) {
+            p = *reinterpret_cast<char**>(p);
+          }
+          accesses += 64;
+        }
+        probe_ns = Seconds(begin, Clock::now()) * 1e9 / static_cast<double>(accesses);
+        g_sink = reinterpret_cast<uintptr_t>(p);
+      });
+    }
+    barrier.Wait();
+    std::this_thread::sleep_for(std::chrono::duration<double>(config_.saturation_seconds));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    RethrowFirst(errors);
+
+    // Последний проход потока может закончиться после остановки: скорость - по каждому потоку
+    double gbs = 0.0;
+    for (size_t t = 0; t < threads; ++t) {
+      if (seconds[t] > 0.0) {
+        gbs += moved[t] / seconds[t] / 1e9;
+      }
+    }
+    curve.push_back({kind, threads, gbs, probe_ns});
+  }
+  return curve;
+}
+
+std::vector<StridePoint> MemoryBenchmark::StrideSweep() const {
+  ScopedAffinity affinity;
+  PinOrWarn(affinity, config_.cpu, "memory benchmark");
+  BenchmarkBuffer buffer(config_.stride_buffer_bytes, PageSize::k4K, config_.numa_node);
+  const char* data = buffer.data();
+  const size_t bytes = buffer.size();
+
+  std::vector<StridePoint> points;
+  for (size_t stride : config_.strides) {
+    if (stride < sizeof(uint64_t) || stride > bytes) {
+      continue;
+    }
+    size_t accesses = bytes / stride;
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t rep = 0; rep < config_.repetitions; ++rep) {
+      auto begin = Clock::now();
+      uint64_t sum = 0;
+      for (size_t offset = 0; offset + sizeof(uint64_t) <= bytes; offset += stride) {
+        sum += *reinterpret_cast<const uint64_t*>(data + offset);
+      }
+      best = std::min(best, Seconds(begin, Clock::now()));
+      g_sink = sum;
+    }
+    // Шаг меньше линии всё равно читает каждую линию целиком
+    double lines = static_cast<double>(bytes) / std::max(stride, kLineBytes);
+    points.push_back({stride, best * 1e9 / accesses, lines * kLineBytes / best / 1e9});
+  }
+  return points;
+}
+
+std::vector<TlbPoint> MemoryBenchmark::TlbReach(PageSize page) const {
+  ScopedAffinity affinity;
+  PinOrWarn(affinity, config_.cpu, "memory benchmark");
+
+  std::vector<TlbPoint> points;
+  for (size_t pages = config_.min_tlb_pages; pages <= config_.max_tlb_pages; pages *= 2) {
+    BenchmarkBuffer buffer(pages * kSmallPage, page, config_.numa_node);
+    // Одна линия на страницу; сдвиг линии внутри страницы разводит их по
+    // наборам кэша, иначе все узлы попали бы в один набор L1
+    std::vector<size_t> offsets(pages);
+    for (size_t i = 0; i < pages; ++i) {
+      offsets[i] = i * kSmallPage + (i % (kSmallPage / kLineBytes)) * kLineBytes;
+    }
+    char* start = LinkChain(buffer.data(), ChaseOrder(pages, pages), offsets);
+    points.push_back({pages, page,
+                      ChaseNs(start, pages, config_.chase_accesses, config_.repetitions),
+                      buffer.backing()});
+  }
+  return points;
+}
+
+std::vector<std::pair<std::string, double>> MemoryBenchmark::LevelLatencies(
+    const std::vector<LatencyPoint>& curve, const CacheTopology& caches) {
+  std::vector<std::pair<std::string, double>> levels;
+  int last_level = caches.LastLevel();
+  for (int level = 1; level <= last_level; ++level) {
+    size_t limit = caches.DataCacheBytes(level) / 2;
+    const LatencyPoint* plateau = nullptr;
+    for (const auto& point : curve) {
+      if (point.working_set <= limit) {
+        plateau = &point;
+      }
+    }
+    if (plateau != nullptr) {
+      levels.push_back({"L" + std::to_string(level), plateau->ns_per_access});
+    }
+  }
+  size_t llc = last_level > 0 ? caches.DataCacheBytes(last_level) : 0;
+  if (llc > 0 && !curve.empty() && curve.back().working_set >= 2 * llc) {
+    levels.push_back({"DRAM", curve.back().ns_per_access});
+  }
+  return levels;
+}
+
+size_t MemoryBenchmark::SaturationKnee(const std::vector<SaturationPoint>& curve,
+                                      double fraction) {
+  double peak = 0.0;
+  for (const auto& point : curve) {
+    peak = std::max(peak, point.gbs);
+  }
+  for (const auto& point : curve) {
+    if (point.gbs >= fraction * peak) {
+      return point.threads;
+    }
+  }
+  return 0;
+}
+
+std::vector<BenchmarkRecord> MemoryBenchmark::SaturationRecords(
+    const std::vector<SaturationPoint>& curve, int numa_node) {
+  std::vector<BenchmarkRecord> records;
+  const double knee = static_cast<double>(SaturationKnee(curve));
+  for (const auto& point : curve) {
+    records.push_back({"memory/saturation/" + point.kind + "/node:" + std::to_string(numa_node) +
+                           "/threads:" + std::to_string(point.threads),
+                       1,
+                       point.loaded_latency_ns,
+                       "ns",
+                       {{"bytes_per_second", point.gbs * 1e9},
+                        {"threads", static_cast<double>(point.threads)},
+                        {"knee_threads", knee},
+                        {"numa_node", static_cast<double>(numa_node)}}});
+  }
+  return records;
+}
+
+void MemoryBenchmark::StoreSaturationInProfile(int numa_node,
+                                               const std::vector<SaturationPoint>& curve,
+                                               MachineProfile& profile) {
+  if (curve.empty()) {
+    return;
+  }
+  // Поддерево заменяется целиком: точки прошлого прогона с большим числом потоков не остаются
+  boost::property_tree::ptree tree;
+  double peak = 0.0;
+  for (const auto& point : curve) {
+    std::string prefix = "threads." + std::to_string(point.threads) + ".";
+    tree.put(prefix + "gbs", point.gbs);
+    if (std::isfinite(point.loaded_latency_ns)) {
+      tree.put(prefix + "loaded_latency_ns", point.loaded_latency_ns);
+    }
+    peak = std::max(peak, point.gbs);
+  }
+  tree.put("knee_threads", SaturationKnee(curve));
+  tree.put("peak_gbs", peak);
+  profile.Data().put_child(
+      "memory_saturation.node" + std::to_string(numa_node) + "." + curve.front().kind, tree);
+}
+
+size_t MemoryBenchmark::LoadSaturationKnee(const MachineProfile& profile, int numa_node,
+                                           const std::string& kind) {
+  return profile.Get<size_t>(
+      "memory_saturation.node" + std::to_string(numa_node) + "." + kind + ".knee_threads", 0);
+}
+
+std::vector<BenchmarkRecord> MemoryBenchmark::Run(const std::vector<std::string>& suites) const {
+  for (const auto& suite : suites) {
+    if (suite != "latency" && suite != "bandwidth" && suite != "stride" && suite != "tlb" &&
+        suite != "saturation") {
+      throw std::invalid_argument("Unknown memory benchmark suite: " + suite);
+    }
+  }
+  auto wanted = [&](const char* suite) {
+    return std::find(suites.begin(), suites.end(), suite) != suites.end();
+  };
+  const double cpu = config_.cpu;
+  const double node = config_.numa_node >= 0 ? config_.numa_node : NodeOfCpu(config_.cpu);
+
+  std::vector<BenchmarkRecord> records;
+  if (wanted("latency")) {
+    for (const auto& point : LatencyCurve(PageSize::k4K)) {
+      records.push_back({"memory/latency/ws:" + std::to_string(point.working_set),
+                         config_.chase_accesses,
+                         point.ns_per_access,
+                         "ns",
+                         {{"working_set_bytes", static_cast<double>(point.working_set)},
+                          {"cpu", cpu},
+                          {"numa_node", node}}});
+    }
+  }
+  if (wanted("bandwidth")) {
+    double bandwidth_node = config_.numa_node >= 0 ? config_.numa_node
+                                                   : NodeOfCpu(config_.cpus.front());
+    for (const auto& result : Bandwidth()) {
+      records.push_back({"memory/bandwidth/" + result.kind + "/threads:" +
+                             std::to_string(result.threads),
+                         config_.bandwidth_passes,
+                         result.seconds_per_pass * 1e9,
+                         "ns",
+                         {{"bytes_per_second", result.gbs * 1e9},
+                          {"threads", static_cast<double>(result.threads)},
+                          {"numa_node", bandwidth_node}}});
+    }
+  }
+  if (wanted("saturation")) {
+    int saturation_node = config_.numa_node >= 0 ? config_.numa_node
+                                                 : NodeOfCpu(config_.cpus.front());
+    for (const char* kind : {"read", "write", "mixed"}) {
+      for (auto& record : SaturationRecords(SaturationCurve(kind), saturation_node)) {
+        records.push_back(std::move(record));
+      }
+    }
+  }
+  if (wanted("stride")) {
+    for (const auto& point : StrideSweep()) {
+      records.push_back({"memory/stride/" + std::to_string(point.stride),
+                         config_.stride_buffer_bytes / point.stride,
+                         point.ns_per_access,
+                         "ns",
+                         {{"bytes_per_second", point.line_gbs * 1e9},
+                          {"stride_bytes", static_cast<double>(point.stride)},
+                          {"cpu", cpu},
+                          {"numa_node", node}}});
+    }
+  }
+  if (wanted("tlb")) {
+    for (PageSize page : {PageSize::k4K, PageSize::k2M}) {
+      for (const auto& point : TlbReach(page)) {
+        records.push_back({"memory/tlb/pages:" + std::to_string(point.pages) + "/page:" +
+                               PageSizeName(point.page),
+                           config_.chase_accesses,
+                           point.ns_per_access,
+                           "ns",
+                           {{"pages", static_cast<double>(point.pages)},
+                            {"huge_pages", point.backing == "4k" ? 0.0 : 1.0},
+                            {"cpu", cpu},
+                            {"numa_node", node}}});
+      }
+    }
+  }
+  return records;
+}
+
+}  // namespace hardware_analysis
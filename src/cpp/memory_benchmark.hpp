@@ -0,0 +1,225 @@
+#ifndef MEMORY_BENCHMARK_HPP
+#define MEMORY_BENCHMARK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark_report.hpp"
+#include "cache_topology.hpp"
+
+namespace hardware_analysis {
+
+class MachineProfile;
+
+enum class PageSize {
+  k4K = 0,
+  k2M
+};
+
+const char* PageSizeName(PageSize page);
+
+/**
+ * @brief Буфер mmap с выбранным размером страниц и привязкой к узлу NUMA
+ *
+ * k2M: сначала MAP_HUGETLB (пул hugetlbfs), иначе выровненный буфер с
+ * MADV_HUGEPAGE (THP). k4K: MADV_NOHUGEPAGE, чтобы THP не подменил страницы.
+ * Память заполняется нулями сразу - с привязкой к узлу через mbind или
+ * first touch на CPU вызывающего потока.
+ */
+class BenchmarkBuffer {
+ public:
+  /**
+   * @param numa_node Узел памяти (-1 - локальный для текущего потока)
+   * @throws std::runtime_error если mmap не удался
+   */
+  BenchmarkBuffer(size_t bytes, PageSize page, int numa_node = -1);
+  ~BenchmarkBuffer();
+
+  BenchmarkBuffer(const BenchmarkBuffer&) = delete;
+  BenchmarkBuffer& operator=(const BenchmarkBuffer&) = delete;
+
+  char* data() const { return data_; }
+  size_t size() const { return bytes_; }
+
+  /**
+   * @brief Чем фактически обеспечены страницы: "4k", "hugetlb" или "thp"
+   */
+  const std::string& backing() const { return backing_; }
+
+ private:
+  char* data_;
+  size_t bytes_;
+  size_t mapped_bytes_;
+  std::string backing_;
+};
+
+/**
+ * @brief Параметры набора тестов памяти
+ */
+struct MemoryBenchConfig {
+  int cpu = 0;                               // CPU однопоточных тестов
+  std::vector<int> cpus;                     // CPU теста пропускной способности (пусто - cpu)
+  int numa_node = -1;                        // Узел памяти (-1 - first touch)
+  size_t min_working_set = 4u << 10;
+  size_t max_working_set = 256u << 20;       // Заметно больше LLC
+  size_t steps_per_octave = 2;               // Точек кривой латентности на удвоение
+  size_t chase_accesses = 1u << 22;          // Переходов по цепочке на точку
+  size_t bandwidth_bytes = 64u << 20;        // Буфер на поток
+  size_t bandwidth_passes = 3;
+  size_t stride_buffer_bytes = 64u << 20;
+  std::vector<size_t> strides = {8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+  size_t min_tlb_pages = 16;
+  size_t max_tlb_pages = 16384;              // 64 МБ адресного пространства при 4K
+  size_t repetitions = 3;                    // Лучший из повторов
+  double saturation_seconds = 0.2;           // Длительность точки кривой насыщения
+  size_t saturation_chase_bytes = 256u << 20;  // Цепочка зонда латентности под нагрузкой
+};
+
+struct LatencyPoint {
+  size_t working_set;
+  PageSize page;
+  double ns_per_access;
+};
+
+struct BandwidthResult {
+  std::string kind;                          // "read", "write", "copy"
+  size_t threads;
+  double gbs;                                // copy считает чтение и запись (как STREAM)
+  double seconds_per_pass;
+};
+
+struct SaturationPoint {
+  std::string kind;                          // "read", "write", "mixed" (2 чтения : 1 запись)
+  size_t threads;
+  double gbs;
+  double loaded_latency_ns;                  // Зонд на свободном CPU узла; NaN - свободного нет
+};
+
+struct StridePoint {
+  size_t stride;
+  double ns_per_access;
+  double line_gbs;                           // Кэш-линии, реально прочитанные из памяти
+};
+
+struct TlbPoint {
+  size_t pages;                              // 4K-страниц, по одной линии на страницу
+  PageSize page;
+  double ns_per_access;
+  std::string backing;                       // BenchmarkBuffer::backing()
+};
+
+/**
+ * @brief Набор микробенчмарков подсистемы памяти
+ *
+ * Заменяет измерения Stage1_AdvancedMemorySimulator.cs: в управляемом коде
+ * цифры определяются GC и проверками границ, здесь - только памятью.
+ *  - латентность: pointer chasing по случайному циклу (Sattolo) из линий по
+ *    64 байта, кривая по размеру рабочего набора показывает плато L1/L2/L3/DRAM;
+ *  - пропускная способность: чтение/запись/копирование, по потоку на CPU,
+ *    буфер каждого потока размещается на его узле;
+ *  - шаг: чтение одного слова через stride байт;
+ *  - охват TLB: одна линия на 4K-страницу в случайном порядке, страницы 4K
+ *    против 2M - рост латентности при числе страниц больше записей TLB.
+ * Однопоточные тесты выполняются на config.cpu, маска потока
+ * восстанавливается. Результаты сводятся в BenchmarkRecord для JSON отчёта.
+ */
+class MemoryBenchmark {
+ public:
+  explicit MemoryBenchmark(const MemoryBenchConfig& config = {});
+
+  const MemoryBenchConfig& config() const { return config_; }
+
+  /**
+   * @brief Латентность одного размера рабочего набора, нс на переход
+   */
+  double MeasureLatency(size_t working_set, PageSize page) const;
+
+  std::vector<LatencyPoint> LatencyCurve(PageSize page = PageSize::k4K) const;
+
+  /**
+   * @brief Пропускная способность чтения рабочего набора одним потоком, ГБ/с
+   *
+   * Набор читается повторно, пока не наберётся bandwidth_bytes: набор
+   * размером с половину кэша даёт пропускную способность этого уровня.
+   */
+  double ReadBandwidth(size_t working_set) const;
+
+  /**
+   * @brief read/write/copy на config.cpus
+   */
+  std::vector<BandwidthResult> Bandwidth() const;
+
+  /**
+   * @brief Кривая насыщения: 1..cpus.size() потоков потока kind на config.cpus
+   *
+   * Потоки точки работают saturation_seconds, каждый со своим буфером
+   * bandwidth_bytes на узле numa_node. Пока они идут, зонд pointer chasing
+   * на следующем CPU списка измеряет латентность под нагрузкой (loaded
+   * latency). Для последней точки свободного CPU нет, латентность 0.
+   *
+   * @throws std::invalid_argument для неизвестного kind
+   */
+  std::vector<SaturationPoint> SaturationCurve(const std::string& kind) const;
+
+  std::vector<StridePoint> StrideSweep() const;
+
+  std::vector<TlbPoint> TlbReach(PageSize page) const;
+
+  /**
+   * @brief Запуск выбранных наборов: "latency", "bandwidth", "stride", "tlb",
+   *        "saturation" (не входит в набор по умолчанию stage7)
+   * @throws std::invalid_argument для неизвестного набора
+   */
+  std::vector<BenchmarkRecord> Run(const std::vector<std::string>& suites) const;
+
+  /**
+   * @brief Размеры рабочих наборов: степени двойки и steps_per_octave точек между ними
+   */
+  static std::vector<size_t> WorkingSetSizes(size_t min_bytes, size_t max_bytes,
+                                             size_t steps_per_octave);
+
+  /**
+   * @brief Случайная перестановка-цикл (алгоритм Sattolo)
+   * @return next[i] - следующий элемент; обход из 0 посещает все count элементов
+   */
+  static std::vector<uint32_t> ChaseOrder(size_t count, uint64_t seed);
+
+  /**
+   * @brief Латентность плато каждого уровня: точка кривой с рабочим набором
+   *        не больше половины кэша, "DRAM" - последняя точка за 2x LLC
+   */
+  static std::vector<std::pair<std::string, double>> LevelLatencies(
+      const std::vector<LatencyPoint>& curve, const CacheTopology& caches);
+
+  /**
+   * @brief Колено кривой: наименьшее число потоков, дающее fraction пика
+   * @return 0 для пустой кривой
+   */
+  static size_t SaturationKnee(const std::vector<SaturationPoint>& curve, double fraction = 0.9);
+
+  static std::vector<BenchmarkRecord> SaturationRecords(const std::vector<SaturationPoint>& curve,
+                                                        int numa_node);
+
+  /**
+   * @brief Кривая и колено в профиль: memory_saturation.node<N>.<kind>.{knee_threads,
+   *        peak_gbs, threads.<T>.{gbs,loaded_latency_ns}}; задержка без зонда не пишется
+   */
+  static void StoreSaturationInProfile(int numa_node, const std::vector<SaturationPoint>& curve,
+                                       MachineProfile& profile);
+
+  /**
+   * @brief Колено узла из профиля (0 если не измерено)
+   */
+  static size_t LoadSaturationKnee(const MachineProfile& profile, int numa_node,
+                                   const std::string& kind = "read");
+
+ private:
+  MemoryBenchConfig config_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // MEMORY_BENCHMARK_HPP
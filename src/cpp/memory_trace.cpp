@@ -0,0 +1,130 @@
+#include "memory_trace.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr size_t kWriteBatch = 1u << 16;   // Записей в буфере TraceWriter
+
+}  // namespace
+
+// ============================================================================
+// TraceWriter
+// ============================================================================
+
+TraceWriter::TraceWriter(const std::string& path) : file_(nullptr), records_(0) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw std::runtime_error("Failed to create trace " + path);
+  }
+  char header[trace_format::kHeaderBytes] = {};
+  std::memcpy(header, trace_format::kMagic, sizeof(trace_format::kMagic));
+  uint32_t version = trace_format::kVersion;
+  uint32_t record_bytes = sizeof(TraceRecord);
+  std::memcpy(header + 8, &version, sizeof(version));
+  std::memcpy(header + 12, &record_bytes, sizeof(record_bytes));
+  if (std::fwrite(header, sizeof(header), 1, file_) != 1) {
+    std::fclose(file_);
+    file_ = nullptr;
+    throw std::runtime_error("Failed to write trace header to " + path);
+  }
+  buffer_.reserve(kWriteBatch);
+}
+
+TraceWriter::~TraceWriter() {
+  try {
+    Close();
+  } catch (const std::exception&) {
+    // Ошибка записи в деструкторе не пробрасывается
+  }
+}
+
+void TraceWriter::Write(const TraceRecord& record) {
+  buffer_.push_back(record);
+  ++records_;
+  if (buffer_.size() >= kWriteBatch) {
+    Flush();
+  }
+}
+
+void TraceWriter::Write(uint64_t address, AccessType type, uint8_t size, uint32_t pc) {
+  Write(TraceRecord{address, pc, static_cast<uint8_t>(type), size, 0});
+}
+
+void TraceWriter::Flush() {
+  if (file_ == nullptr || buffer_.empty()) {
+    return;
+  }
+  if (std::fwrite(buffer_.data(), sizeof(TraceRecord), buffer_.size(), file_) !=
+      buffer_.size()) {
+    throw std::runtime_error("Failed to write trace records");
+  }
+  buffer_.clear();
+}
+
+void TraceWriter::Close() {
+  if (file_ == nullptr) {
+    return;
+  }
+  Flush();
+  bool failed = std::fclose(file_) != 0;
+  file_ = nullptr;
+  if (failed) {
+    throw std::runtime_error("Failed to close trace");
+  }
+}
+
+// ============================================================================
+// MappedTrace
+// ============================================================================
+
+MappedTrace::MappedTrace(const std::string& path)
+    : mapping_(nullptr), mapped_bytes_(0), records_(nullptr), count_(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open trace " + path);
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < trace_format::kHeaderBytes) {
+    close(fd);
+    throw std::runtime_error("Not a memory trace: " + path);
+  }
+  mapped_bytes_ = static_cast<size_t>(info.st_size);
+  mapping_ = mmap(nullptr, mapped_bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw std::runtime_error("Failed to map trace " + path);
+  }
+
+  const char* bytes = static_cast<const char*>(mapping_);
+  uint32_t version = 0;
+  uint32_t record_bytes = 0;
+  std::memcpy(&version, bytes + 8, sizeof(version));
+  std::memcpy(&record_bytes, bytes + 12, sizeof(record_bytes));
+  if (std::memcmp(bytes, trace_format::kMagic, sizeof(trace_format::kMagic)) != 0 ||
+      version != trace_format::kVersion || record_bytes != sizeof(TraceRecord)) {
+    munmap(mapping_, mapped_bytes_);
+    mapping_ = nullptr;
+    throw std::runtime_error("Not a version " + std::to_string(trace_format::kVersion) +
+                             " memory trace: " + path);
+  }
+  madvise(mapping_, mapped_bytes_, MADV_SEQUENTIAL);
+  // Недописанная последняя запись (трасса ещё пишется) отбрасывается
+  records_ = reinterpret_cast<const TraceRecord*>(bytes + trace_format::kHeaderBytes);
+  count_ = (mapped_bytes_ - trace_format::kHeaderBytes) / sizeof(TraceRecord);
+}
+
+MappedTrace::~MappedTrace() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapped_bytes_);
+  }
+}
+
+}  // namespace hardware_analysis
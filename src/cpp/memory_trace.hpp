@@ -0,0 +1,113 @@
+#ifndef MEMORY_TRACE_HPP
+#define MEMORY_TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Вид обращения в записи трассы
+ */
+enum class AccessType : uint8_t {
+  kRead = 0,
+  kWrite = 1,
+  kInstruction = 2,
+  kPrefetch = 3          // Программная предвыборка: подсказка, а не обращение
+};
+
+/**
+ * @brief Запись трассы: 16 байт, массив записей читается прямо из mmap
+ */
+struct TraceRecord {
+  uint64_t address;      // Байтовый адрес
+  uint32_t pc;           // Младшие 32 бита адреса инструкции (0 если неизвестен)
+  uint8_t type;          // AccessType
+  uint8_t size;          // Байт в обращении (0 - одна строка)
+  uint16_t reserved;
+};
+
+static_assert(sizeof(TraceRecord) == 16, "trace record must stay 16 bytes");
+
+/**
+ * @brief Двоичная трасса обращений к памяти
+ *
+ * Формат: заголовок 16 байт {magic "HATRACE1", version u32, record_bytes u32},
+ * затем записи TraceRecord в порядке обращений, little-endian. Тот же формат
+ * пишет stage5_cache_simulator.write_trace().
+ */
+namespace trace_format {
+
+constexpr char kMagic[8] = {'H', 'A', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = 16;
+
+}  // namespace trace_format
+
+/**
+ * @brief Буферизованная запись трассы
+ */
+class TraceWriter {
+ public:
+  /**
+   * @throws std::runtime_error если файл не открывается
+   */
+  explicit TraceWriter(const std::string& path);
+  ~TraceWriter();
+
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  void Write(const TraceRecord& record);
+  void Write(uint64_t address, AccessType type, uint8_t size = 0, uint32_t pc = 0);
+
+  /**
+   * @brief Сброс буфера и закрытие (повторный вызов ничего не делает)
+   * @throws std::runtime_error при ошибке записи
+   */
+  void Close();
+
+  uint64_t records() const { return records_; }
+
+ private:
+  void Flush();
+
+  std::FILE* file_;
+  std::vector<TraceRecord> buffer_;
+  uint64_t records_;
+};
+
+/**
+ * @brief Трасса, отображённая в память только для чтения
+ *
+ * Записи не копируются: симулятор идёт по массиву страниц файла, ядро
+ * подкачивает их с опережением (MADV_SEQUENTIAL).
+ */
+class MappedTrace {
+ public:
+  /**
+   * @throws std::runtime_error если файл не открывается или не является трассой
+   */
+  explicit MappedTrace(const std::string& path);
+  ~MappedTrace();
+
+  MappedTrace(const MappedTrace&) = delete;
+  MappedTrace& operator=(const MappedTrace&) = delete;
+
+  const TraceRecord* begin() const { return records_; }
+  const TraceRecord* end() const { return records_ + count_; }
+  size_t size() const { return count_; }
+
+ private:
+  void* mapping_;
+  size_t mapped_bytes_;
+  const TraceRecord* records_;
+  size_t count_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // MEMORY_TRACE_HPP
@@ -0,0 +1,468 @@
+#include "numa_rebalancer.hpp"
+#include "hardware_monitor.hpp"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+std::string ReadWholeFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return "";
+  }
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  return oss.str();
+}
+
+}  // namespace
+
+// ============================================================================
+// NumaMapsRegion
+// ============================================================================
+
+uint64_t NumaMapsRegion::TotalPages() const {
+  uint64_t total = 0;
+  for (const auto& [node, pages] : pages_per_node) {
+    total += pages;
+  }
+  return total;
+}
+
+uint64_t NumaMapsRegion::RemotePages(int target_node) const {
+  uint64_t remote = 0;
+  for (const auto& [node, pages] : pages_per_node) {
+    if (node != target_node) {
+      remote += pages;
+    }
+  }
+  return remote;
+}
+
+// ============================================================================
+// NumaRebalancer
+// ============================================================================
+
+NumaRebalancer::NumaRebalancer(pid_t pid, OptimizationEngine& engine,
+                               const NumaRebalancerConfig& config)
+    : pid_(pid),
+      engine_(engine),
+      config_(config),
+      node_count_(0),
+      target_node_(-1),
+      candidate_node_(-1),
+      candidate_streak_(0),
+      tick_(0) {
+  if (config_.batch_pages == 0) {
+    config_.batch_pages = 1;
+  }
+  LoadCpuToNodeMap();
+}
+
+void NumaRebalancer::LoadCpuToNodeMap() {
+  struct stat st;
+  if (stat(config_.sysfs_node_root.c_str(), &st) != 0) {
+    throw std::runtime_error("NUMA topology not found at " + config_.sysfs_node_root);
+  }
+
+  // Узлы могут идти с пропусками (node0, node2), поэтому обходим каталог
+  DIR* dir = opendir(config_.sysfs_node_root.c_str());
+  if (dir == nullptr) {
+    throw std::runtime_error("Failed to open " + config_.sysfs_node_root);
+  }
+
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+        !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+      continue;
+    }
+
+    int node_id = std::stoi(name.substr(4));
+    std::vector<int> cpus;
+    try {
+      cpus = utils::ParseCpuList(utils::ReadSysfsString(
+          config_.sysfs_node_root + "/" + name + "/cpulist"));
+    } catch (const std::exception&) {
+      continue;  // Узел без CPU (например, только память)
+    }
+
+    for (int cpu : cpus) {
+      if (cpu >= static_cast<int>(cpu_to_node_.size())) {
+        cpu_to_node_.resize(cpu + 1, -1);
+      }
+      cpu_to_node_[cpu] = node_id;
+    }
+    node_count_ = std::max(node_count_, node_id + 1);
+  }
+  closedir(dir);
+
+  if (node_count_ == 0) {
+    throw std::runtime_error("No NUMA nodes found at " + config_.sysfs_node_root);
+  }
+}
+
+std::vector<ThreadPlacement> NumaRebalancer::SampleThreads() const {
+  std::vector<ThreadPlacement> threads;
+  std::string task_dir = config_.proc_root + "/" + std::to_string(pid_) + "/task";
+
+  DIR* dir = opendir(task_dir.c_str());
+  if (dir == nullptr) {
+    return threads;  // Процесс завершился
+  }
+
+  while (struct dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+
+    std::string stat_line;
+    std::ifstream stat_file(task_dir + "/" + entry->d_name + "/stat");
+    if (!std::getline(stat_file, stat_line)) {
+      continue;  // Поток завершился между readdir и open
+    }
+
+    int cpu = ParseStatProcessor(stat_line);
+    if (cpu < 0) {
+      continue;
+    }
+
+    ThreadPlacement placement;
+    placement.tid = static_cast<pid_t>(std::atoi(entry->d_name));
+    placement.cpu_id = cpu;
+    placement.numa_node = cpu < static_cast<int>(cpu_to_node_.size())
+                              ? cpu_to_node_[cpu] : -1;
+    threads.push_back(placement);
+  }
+  closedir(dir);
+
+  return threads;
+}
+
+std::vector<NumaMapsRegion> NumaRebalancer::SampleRegions() const {
+  std::string base = config_.proc_root + "/" + std::to_string(pid_);
+  return ParseNumaMaps(ReadWholeFile(base + "/numa_maps"),
+                       ReadWholeFile(base + "/maps"));
+}
+
+std::vector<NumaMapsRegion> NumaRebalancer::ParseNumaMaps(const std::string& numa_maps,
+                                                          const std::string& maps) {
+  // Границы регионов: "start-end perms offset dev inode path"
+  std::map<uint64_t, uint64_t> region_ends;
+  std::istringstream maps_stream(maps);
+  std::string line;
+  while (std::getline(maps_stream, line)) {
+    size_t dash = line.find('-');
+    size_t space = line.find(' ');
+    if (dash == std::string::npos || space == std::string::npos || dash > space) {
+      continue;
+    }
+    try {
+      uint64_t start = std::stoull(line.substr(0, dash), nullptr, 16);
+      uint64_t end = std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+      region_ends[start] = end;
+    } catch (const std::exception&) {
+      continue;  // Регион без границы PlanMigrations пропустит
+    }
+  }
+
+  // "7f0000000000 default anon=3 dirty=3 N0=2 N1=1 kernelpagesize_kB=4"
+  std::vector<NumaMapsRegion> regions;
+  std::istringstream numa_stream(numa_maps);
+  while (std::getline(numa_stream, line)) {
+    std::istringstream fields(line);
+    std::string address, token;
+    if (!(fields >> address)) {
+      continue;
+    }
+
+    NumaMapsRegion region;
+    try {
+      region.start_address = std::stoull(address, nullptr, 16);
+    } catch (const std::exception&) {
+      continue;
+    }
+    region.end_address = 0;
+    region.page_size_bytes = 4096;
+    region.anonymous = false;
+
+    auto end_it = region_ends.find(region.start_address);
+    if (end_it != region_ends.end()) {
+      region.end_address = end_it->second;
+    }
+
+    // Повреждённое или обрезанное значение: строка пропускается целиком, как и адрес
+    try {
+      while (fields >> token) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+          continue;  // Политика размещения ("default", "bind:0", ...)
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+
+        if (key.size() > 1 && key[0] == 'N' &&
+            std::all_of(key.begin() + 1, key.end(), ::isdigit)) {
+          region.pages_per_node[std::stoi(key.substr(1))] = std::stoull(value);
+        } else if (key == "kernelpagesize_kB") {
+          region.page_size_bytes = std::stoull(value) * 1024;
+        } else if (key == "anon" || key == "heap" || key == "stack") {
+          region.anonymous = true;
+        }
+      }
+    } catch (const std::exception&) {
+      continue;
+    }
+
+    regions.push_back(region);
+  }
+
+  return regions;
+}
+
+int NumaRebalancer::ParseStatProcessor(const std::string& stat_line) {
+  // Имя потока в скобках может содержать пробелы, поэтому считаем поля
+  // после последней ')': поле 3 (state) имеет индекс 0, поле 39 (processor) - 36
+  size_t paren = stat_line.rfind(')');
+  if (paren == std::string::npos) {
+    return -1;
+  }
+
+  std::istringstream fields(stat_line.substr(paren + 1));
+  std::string token;
+  for (int index = 0; fields >> token; ++index) {
+    if (index == 36) {
+      try {
+        return std::stoi(token);
+      } catch (const std::exception&) {
+        return -1;
+      }
+    }
+  }
+
+  return -1;
+}
+
+std::vector<MigrationBatch> NumaRebalancer::PlanMigrations(
+    const std::vector<NumaMapsRegion>& regions, int target_node,
+    uint64_t scan_budget, uint64_t min_remote_pages,
+    const std::map<uint64_t, uint64_t>& cursors) {
+  std::vector<MigrationBatch> plan;
+  if (target_node < 0) {
+    return plan;
+  }
+
+  std::vector<const NumaMapsRegion*> candidates;
+  for (const auto& region : regions) {
+    if (region.end_address > region.start_address &&
+        region.RemotePages(target_node) >= min_remote_pages) {
+      candidates.push_back(&region);
+    }
+  }
+
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [target_node](const NumaMapsRegion* a, const NumaMapsRegion* b) {
+                     return a->RemotePages(target_node) > b->RemotePages(target_node);
+                   });
+
+  for (const NumaMapsRegion* region : candidates) {
+    if (scan_budget == 0) {
+      break;
+    }
+
+    uint64_t page_count =
+        (region->end_address - region->start_address) / region->page_size_bytes;
+    if (page_count == 0) {
+      continue;
+    }
+
+    uint64_t first = 0;
+    auto cursor_it = cursors.find(region->start_address);
+    if (cursor_it != cursors.end() && cursor_it->second < page_count) {
+      first = cursor_it->second;
+    }
+
+    MigrationBatch batch;
+    batch.region_start = region->start_address;
+    batch.first_page_index = first;
+    batch.region_page_count = page_count;
+
+    uint64_t take = std::min(scan_budget, page_count - first);
+    batch.pages.reserve(take);
+    for (uint64_t i = 0; i < take; ++i) {
+      batch.pages.push_back(reinterpret_cast<void*>(
+          region->start_address + (first + i) * region->page_size_bytes));
+    }
+
+    scan_budget -= take;
+    plan.push_back(std::move(batch));
+  }
+
+  return plan;
+}
+
+int NumaRebalancer::UpdateTargetNode(const std::vector<size_t>& threads_per_node) {
+  size_t total = 0;
+  int majority = -1;
+  size_t majority_count = 0;
+  for (size_t node = 0; node < threads_per_node.size(); ++node) {
+    total += threads_per_node[node];
+    if (threads_per_node[node] > majority_count) {
+      majority_count = threads_per_node[node];
+      majority = static_cast<int>(node);
+    }
+  }
+
+  if (total == 0 ||
+      static_cast<double>(majority_count) / total < config_.thread_majority_ratio) {
+    // Нет устойчивого большинства - цель не меняем
+    candidate_node_ = -1;
+    candidate_streak_ = 0;
+    return -1;
+  }
+
+  if (majority == target_node_) {
+    candidate_node_ = -1;
+    candidate_streak_ = 0;
+    return majority;
+  }
+
+  if (majority == candidate_node_) {
+    ++candidate_streak_;
+  } else {
+    candidate_node_ = majority;
+    candidate_streak_ = 1;
+  }
+
+  if (candidate_streak_ >= config_.stable_samples_required) {
+    target_node_ = candidate_node_;
+    candidate_node_ = -1;
+    candidate_streak_ = 0;
+  }
+
+  return majority;
+}
+
+uint64_t NumaRebalancer::ExecuteBatch(const MigrationBatch& batch) {
+  uint64_t migrated = 0;
+
+  for (size_t offset = 0; offset < batch.pages.size(); offset += config_.batch_pages) {
+    size_t end = std::min(batch.pages.size(),
+                          offset + static_cast<size_t>(config_.batch_pages));
+    std::vector<void*> chunk(batch.pages.begin() + offset, batch.pages.begin() + end);
+
+    // Отсеиваем уже локальные и нерезидентные страницы (status < 0)
+    std::vector<int> nodes;
+    if (!engine_.QueryPageNodes(pid_, chunk, nodes)) {
+      continue;
+    }
+    std::vector<void*> remote;
+    for (size_t i = 0; i < chunk.size(); ++i) {
+      if (nodes[i] >= 0 && nodes[i] != target_node_) {
+        remote.push_back(chunk[i]);
+      }
+    }
+
+    long moved = engine_.MovePagesToNode(pid_, remote, target_node_);
+    if (moved > 0) {
+      migrated += static_cast<uint64_t>(moved);
+    }
+  }
+
+  return migrated;
+}
+
+RebalanceTickStats NumaRebalancer::Tick() {
+  RebalanceTickStats stats = {};
+  stats.tick = ++tick_;
+
+  std::vector<ThreadPlacement> threads = SampleThreads();
+  std::vector<size_t> threads_per_node(node_count_, 0);
+  for (const auto& thread : threads) {
+    if (thread.numa_node >= 0 && thread.numa_node < node_count_) {
+      ++threads_per_node[thread.numa_node];
+    }
+  }
+
+  int previous_target = target_node_;
+  stats.majority_node = UpdateTargetNode(threads_per_node);
+  stats.target_node = target_node_;
+  stats.target_changed = target_node_ != previous_target;
+  stats.threads_sampled = threads.size();
+
+  if (target_node_ < 0) {
+    return stats;
+  }
+
+  std::vector<NumaMapsRegion> regions = SampleRegions();
+  stats.regions_sampled = regions.size();
+
+  // Фильтрация: файловые страницы и регионы, недавно перенесённые на другой узел
+  std::vector<NumaMapsRegion> eligible;
+  for (const auto& region : regions) {
+    stats.remote_pages += region.RemotePages(target_node_);
+    if (config_.anonymous_only && !region.anonymous) {
+      continue;
+    }
+    auto history = region_history_.find(region.start_address);
+    if (history != region_history_.end() &&
+        history->second.last_moved_node != target_node_ &&
+        tick_ - history->second.last_moved_tick < config_.region_cooldown_ticks) {
+      continue;
+    }
+    eligible.push_back(region);
+  }
+
+  std::vector<MigrationBatch> plan = PlanMigrations(
+      eligible, target_node_, config_.max_scan_pages_per_tick,
+      config_.min_remote_pages, region_cursors_);
+
+  for (const auto& batch : plan) {
+    stats.pages_planned += batch.pages.size();
+
+    uint64_t next = batch.first_page_index + batch.pages.size();
+    region_cursors_[batch.region_start] = next >= batch.region_page_count ? 0 : next;
+
+    if (config_.dry_run) {
+      continue;
+    }
+
+    uint64_t migrated = ExecuteBatch(batch);
+    if (migrated > 0) {
+      region_history_[batch.region_start] = {tick_, target_node_};
+      stats.pages_migrated += migrated;
+    }
+  }
+
+  return stats;
+}
+
+void NumaRebalancer::Run(const std::atomic<bool>& stop) {
+  while (!stop.load()) {
+    auto started = std::chrono::steady_clock::now();
+    RebalanceTickStats stats = Tick();
+
+    if (stats.target_changed || stats.pages_migrated > 0) {
+      std::cout << "NUMA rebalance pid " << pid_ << ": target node "
+                << stats.target_node << ", remote pages " << stats.remote_pages
+                << ", migrated " << stats.pages_migrated << "\n";
+    }
+
+    // Спим короткими интервалами, чтобы быстро реагировать на stop
+    auto deadline = started + std::chrono::milliseconds(config_.sample_interval_ms);
+    while (!stop.load() && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,200 @@
+#ifndef NUMA_REBALANCER_HPP
+#define NUMA_REBALANCER_HPP
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "optimization_engine.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Регион адресного пространства процесса из /proc/pid/numa_maps
+ */
+struct NumaMapsRegion {
+  uint64_t start_address;
+  uint64_t end_address;       // Из /proc/pid/maps (0 если неизвестен)
+  uint64_t page_size_bytes;
+  bool anonymous;
+  std::map<int, uint64_t> pages_per_node;  // N<node>=<pages>
+
+  uint64_t TotalPages() const;
+  uint64_t RemotePages(int target_node) const;
+};
+
+/**
+ * @brief Размещение потока процесса
+ */
+struct ThreadPlacement {
+  pid_t tid;
+  int cpu_id;      // Поле processor из /proc/pid/task/tid/stat
+  int numa_node;   // -1 если узел неизвестен
+};
+
+/**
+ * @brief Параметры ребалансировщика
+ */
+struct NumaRebalancerConfig {
+  uint64_t sample_interval_ms = 1000;
+  uint64_t max_scan_pages_per_tick = 8192;  // Адресов, проверяемых за тик (миграций не больше)
+  uint64_t batch_pages = 512;            // Страниц на один вызов move_pages
+  uint64_t min_remote_pages = 16;        // Мелкие регионы не трогаем
+  double thread_majority_ratio = 0.6;    // Доля потоков на узле для смены цели
+  int stable_samples_required = 3;       // Гистерезис: выборок подряд до смены цели
+  uint64_t region_cooldown_ticks = 10;   // Защита от ping-pong для региона
+  bool anonymous_only = true;            // Файловые страницы (page cache) не трогаем
+  bool dry_run = false;                  // Только планирование, без move_pages
+  std::string proc_root = "/proc";
+  std::string sysfs_node_root = "/sys/devices/system/node";
+};
+
+/**
+ * @brief План миграции одного региона
+ */
+struct MigrationBatch {
+  uint64_t region_start;
+  uint64_t first_page_index;   // Смещение в регионе (в страницах)
+  uint64_t region_page_count;
+  std::vector<void*> pages;
+};
+
+/**
+ * @brief Статистика одной итерации ребалансировщика
+ */
+struct RebalanceTickStats {
+  uint64_t tick;
+  int majority_node;          // Узел большинства потоков в этой выборке
+  int target_node;            // Цель после применения гистерезиса
+  size_t threads_sampled;
+  size_t regions_sampled;
+  uint64_t remote_pages;      // Страниц вне целевого узла (по numa_maps)
+  uint64_t pages_planned;
+  uint64_t pages_migrated;
+  bool target_changed;
+};
+
+/**
+ * @brief Пользовательский аналог autonuma для одного процесса
+ *
+ * Периодически читает /proc/pid/numa_maps и размещение потоков, выбирает
+ * узел, на котором работает большинство потоков, и переносит на него
+ * удалённые страницы через move_pages порциями с ограничением скорости.
+ * Смена целевого узла требует устойчивого большинства в нескольких
+ * выборках подряд, а недавно перенесённые регионы временно не трогаются.
+ */
+class NumaRebalancer {
+ public:
+  /**
+   * @brief Конструктор
+   * @param pid Обслуживаемый процесс
+   * @param engine Движок оптимизации (NUMA функции)
+   * @param config Параметры
+   * @throws std::runtime_error если не удалось определить NUMA топологию
+   */
+  NumaRebalancer(pid_t pid, OptimizationEngine& engine,
+                 const NumaRebalancerConfig& config = NumaRebalancerConfig());
+
+  /**
+   * @brief Одна итерация: выборка, выбор цели, миграция
+   * @return Статистика итерации
+   */
+  RebalanceTickStats Tick();
+
+  /**
+   * @brief Режим демона: Tick() с интервалом sample_interval_ms до stop
+   * @param stop Флаг остановки
+   */
+  void Run(const std::atomic<bool>& stop);
+
+  /**
+   * @brief Текущий целевой узел (-1 пока не выбран)
+   */
+  int GetTargetNode() const { return target_node_; }
+
+  /**
+   * @brief Чтение размещения потоков процесса
+   * @return Поток -> CPU -> NUMA узел
+   */
+  std::vector<ThreadPlacement> SampleThreads() const;
+
+  /**
+   * @brief Чтение регионов памяти процесса
+   * @return Регионы с распределением страниц по узлам
+   */
+  std::vector<NumaMapsRegion> SampleRegions() const;
+
+  /**
+   * @brief Парсинг содержимого numa_maps с границами регионов из maps
+   * @param numa_maps Содержимое /proc/pid/numa_maps
+   * @param maps Содержимое /proc/pid/maps (может быть пустым)
+   * @return Регионы
+   */
+  static std::vector<NumaMapsRegion> ParseNumaMaps(const std::string& numa_maps,
+                                                   const std::string& maps);
+
+  /**
+   * @brief Извлечение номера CPU (поле processor) из строки /proc/.../stat
+   * @return CPU или -1 при ошибке разбора
+   */
+  static int ParseStatProcessor(const std::string& stat_line);
+
+  /**
+   * @brief Планирование миграций с учётом бюджета обхода
+   *
+   * Регионы упорядочиваются по числу удалённых страниц (самые «тяжёлые»
+   * первыми). Большой регион обходится по частям: cursors хранит позицию,
+   * с которой продолжается обход на следующей итерации. Регионы без
+   * границы из /proc/pid/maps пропускаются; уже локальные страницы
+   * отсеиваются при исполнении.
+   * @param scan_budget Адресов в плане за тик: узел страницы известен только
+   *        при исполнении, поэтому перенесено будет не больше этого числа
+   * @param cursors Начало региона -> индекс следующей страницы
+   */
+  static std::vector<MigrationBatch> PlanMigrations(
+      const std::vector<NumaMapsRegion>& regions, int target_node,
+      uint64_t scan_budget, uint64_t min_remote_pages,
+      const std::map<uint64_t, uint64_t>& cursors);
+
+ private:
+  /**
+   * @brief Обновление целевого узла с гистерезисом
+   * @param threads_per_node Число потоков на каждом узле
+   * @return Узел большинства в текущей выборке (-1 если его нет)
+   */
+  int UpdateTargetNode(const std::vector<size_t>& threads_per_node);
+
+  /**
+   * @brief Исполнение одного пакета: фильтрация локальных и move_pages
+   * @return Число перенесённых страниц
+   */
+  uint64_t ExecuteBatch(const MigrationBatch& batch);
+
+  void LoadCpuToNodeMap();
+
+  pid_t pid_;
+  OptimizationEngine& engine_;
+  NumaRebalancerConfig config_;
+
+  std::vector<int> cpu_to_node_;
+  int node_count_;
+
+  int target_node_;
+  int candidate_node_;
+  int candidate_streak_;
+  uint64_t tick_;
+
+  struct RegionHistory {
+    uint64_t last_moved_tick;
+    int last_moved_node;
+  };
+  std::map<uint64_t, RegionHistory> region_history_;
+  std::map<uint64_t, uint64_t> region_cursors_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // NUMA_REBALANCER_HPP
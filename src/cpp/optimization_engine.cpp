@@ -1,23 +1,45 @@
 #include "optimization_engine.hpp"
+#include "cpufreq_actuator.hpp"
+#include "autotuner.hpp"
+#include "machine_profile.hpp"
+#include "memory_benchmark.hpp"
+#include "prefetch_tuner.hpp"
 #include <cpuid.h>
 #include <numa.h>
+#include <numaif.h>
 #include <sched.h>
 #include <cmath>
-#include <fstream>
+#include <cstdlib>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace hardware_analysis {
 
-OptimizationEngine::OptimizationEngine() {
+OptimizationEngine::OptimizationEngine()
+    : sysfs_cpu_root_("/sys/devices/system/cpu"), min_memory_thread_cap_(0) {
   avx2_supported_ = CheckAVX2Support();
   avx512_supported_ = CheckAVX512Support();
+  for (size_t p = 0; p < static_cast<size_t>(AccessPattern::kCount); ++p) {
+    prefetch_settings_[p] =
+        PrefetchTuner::DefaultSetting(static_cast<AccessPattern>(p), sizeof(int));
+  }
+  reduction_.threads = std::max(1u, std::thread::hardware_concurrency());
+  caches_ = CacheTopology::Read(sysfs_cpu_root_);
+  gemm_blocking_ = GemmBlocking::ForCaches(caches_);
+  if (size_t l2 = caches_.DataCacheBytes(2)) {
+    // Порция редукции - половина L2
+    reduction_.chunk = std::max<size_t>(l2 / 2 / sizeof(double), 4096);
+  }
   
   std::cout << "Optimization Engine initialized\n";
   std::cout << "  AVX2: " << (avx2_supported_ ? "supported" : "not supported") << "\n";
   std::cout << "  AVX-512: " << (avx512_supported_ ? "supported" : "not supported") << "\n";
 }
 
+OptimizationEngine::~OptimizationEngine() = default;
+
 // ============================================================================
 // DVFS оптимизация
 // ============================================================================
@@ -47,19 +69,19 @@ uint64_t OptimizationEngine::CalculateOptimalFrequency(
 
 bool OptimizationEngine::SetCpuFrequency(int cpu_id, uint64_t frequency_mhz) {
   // Запись в sysfs для управления частотой (требует root)
-  std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu_id) + 
-                     "/cpufreq/scaling_setspeed";
-  
-  std::ofstream file(path);
-  if (!file.is_open()) {
-    std::cerr << "Failed to open " << path << " (root required)\n";
-    return false;
+  return GetCpufreqActuator().SetFrequency(cpu_id, frequency_mhz);
+}
+
+void OptimizationEngine::SetSysfsCpuRoot(const std::string& root) {
+  sysfs_cpu_root_ = root;
+  cpufreq_.reset();   // Дескрипторы старого дерева больше не нужны
+}
+
+CpufreqActuator& OptimizationEngine::GetCpufreqActuator() {
+  if (!cpufreq_) {
+    cpufreq_ = std::make_unique<CpufreqActuator>(sysfs_cpu_root_);
   }
-  
-  file << frequency_mhz * 1000;  // В kHz
-  file.close();
-  
-  return true;
+  return *cpufreq_;
 }
 
 // ============================================================================
@@ -107,6 +129,57 @@ int OptimizationEngine::FindBestNumaNode() {
   return best_node;
 }
 
+int OptimizationEngine::GetNumaNodeOfCpu(int cpu_id) {
+  if (numa_available() == -1) {
+    return -1;
+  }
+  
+  return numa_node_of_cpu(cpu_id);
+}
+
+bool OptimizationEngine::QueryPageNodes(pid_t pid, const std::vector<void*>& pages,
+                                        std::vector<int>& nodes) {
+  nodes.assign(pages.size(), -1);
+  if (pages.empty()) {
+    return true;
+  }
+  if (numa_available() == -1) {
+    return false;
+  }
+  
+  // nodes == nullptr: ядро только заполняет status текущим узлом страницы
+  std::vector<void*> addresses(pages);
+  int ret = numa_move_pages(pid, addresses.size(), addresses.data(), nullptr,
+                            nodes.data(), 0);
+  return ret == 0;
+}
+
+long OptimizationEngine::MovePagesToNode(pid_t pid, const std::vector<void*>& pages,
+                                         int numa_node) {
+  if (pages.empty()) {
+    return 0;
+  }
+  if (numa_available() == -1) {
+    std::cerr << "NUMA not available\n";
+    return -1;
+  }
+  
+  std::vector<void*> addresses(pages);
+  std::vector<int> target_nodes(pages.size(), numa_node);
+  std::vector<int> status(pages.size(), -1);
+  
+  int ret = numa_move_pages(pid, addresses.size(), addresses.data(),
+                            target_nodes.data(), status.data(), MPOL_MF_MOVE);
+  if (ret < 0) {
+    std::cerr << "move_pages to node " << numa_node << " failed\n";
+    return -1;
+  }
+  
+  // ret > 0 означает число страниц, которые не удалось перенести,
+  // поэтому считаем фактически оказавшиеся на целевом узле
+  return std::count(status.begin(), status.end(), numa_node);
+}
+
 // ============================================================================
 // Векторизация (AVX2)
 // ============================================================================
@@ -146,33 +219,143 @@ double OptimizationEngine::VectorizedSum_AVX2(const double* array, size_t size)
 void OptimizationEngine::MatrixMultiply_AVX2(
     const double* A, const double* B, double* C,
     size_t M, size_t K, size_t N) {
-  
-  if (!avx2_supported_) {
-    // Наивная реализация без векторизации
-    for (size_t i = 0; i < M; ++i) {
-      for (size_t j = 0; j < N; ++j) {
-        double sum = 0.0;
-        for (size_t k = 0; k < K; ++k) {
-          sum += A[i * K + k] * B[k * N + j];
+  std::fill(C, C + M * N, 0.0);
+
+  // Порядок i-k-j внутри блоков: строки B и C читаются последовательно,
+  // панель B (block_k x block_n) переиспользуется всеми строками A
+  const GemmBlocking& blocking = gemm_blocking_;
+  for (size_t kk = 0; kk < K; kk += blocking.block_k) {
+    size_t k_end = std::min(kk + blocking.block_k, K);
+    for (size_t jj = 0; jj < N; jj += blocking.block_n) {
+      size_t j_end = std::min(jj + blocking.block_n, N);
+      for (size_t ii = 0; ii < M; ii += blocking.block_m) {
+        size_t i_end = std::min(ii + blocking.block_m, M);
+        for (size_t i = ii; i < i_end; ++i) {
+          double* c_row = C + i * N;
+          for (size_t k = kk; k < k_end; ++k) {
+            double a = A[i * K + k];
+            const double* b_row = B + k * N;
+            size_t j = jj;
+            if (avx2_supported_) {
+              __m256d a_vec = _mm256_set1_pd(a);
+              for (; j + 4 <= j_end; j += 4) {
+                __m256d c_vec = _mm256_loadu_pd(c_row + j);
+                c_vec = _mm256_add_pd(c_vec, _mm256_mul_pd(a_vec, _mm256_loadu_pd(b_row + j)));
+                _mm256_storeu_pd(c_row + j, c_vec);
+              }
+            }
+            // Остаток N % 4 (прежняя версия писала за границу строки C)
+            for (; j < j_end; ++j) {
+              c_row[j] += a * b_row[j];
+            }
+          }
         }
-        C[i * N + j] = sum;
       }
     }
+  }
+}
+
+GemmBlocking GemmBlocking::ForCaches(const CacheTopology& caches) {
+  auto floor_pow2 = [](size_t value) {
+    size_t result = 1;
+    while (result * 2 <= value) {
+      result *= 2;
+    }
+    return result;
+  };
+  GemmBlocking blocking;
+  size_t l1 = caches.DataCacheBytes(1);
+  size_t l2 = caches.DataCacheBytes(2);
+  if (l1 == 0 || l2 == 0) {
+    return blocking;
+  }
+  blocking.block_n = std::min<size_t>(std::max<size_t>(floor_pow2(l1 / 2 / sizeof(double)), 64),
+                                      1024);
+  blocking.block_k = std::min<size_t>(
+      std::max<size_t>(floor_pow2(l2 / 2 / sizeof(double) / blocking.block_n), 16), 1024);
+  return blocking;
+}
+
+size_t OptimizationEngine::ParallelSumThreads(size_t size, int numa_node) const {
+  size_t chunk = reduction_.chunk;
+  size_t threads = std::min(reduction_.threads, (size + chunk - 1) / chunk);
+  // Редукция упирается в память: потоки сверх колена узла ничего не добавляют.
+  // Потолки разрешены при загрузке профиля - на вызов ни одного системного вызова
+  if (!memory_thread_caps_.empty()) {
+    size_t cap = numa_node >= 0 ? GetMemoryThreadCap(numa_node) : min_memory_thread_cap_;
+    if (cap > 0) {
+      threads = std::min(threads, cap);
+    }
+  }
+  return threads;
+}
+
+double OptimizationEngine::ParallelSum(const double* array, size_t size, int numa_node) {
+  size_t chunk = reduction_.chunk;
+  size_t threads = ParallelSumThreads(size, numa_node);
+  if (threads <= 1) {
+    return VectorizedSum_AVX2(array, size);
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<double> partial(threads, 0.0);
+  auto worker = [&](size_t id) {
+    double sum = 0.0;
+    for (size_t begin = next.fetch_add(chunk); begin < size; begin = next.fetch_add(chunk)) {
+      sum += VectorizedSum_AVX2(array + begin, std::min(chunk, size - begin));
+    }
+    partial[id] = sum;
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t id = 1; id < threads; ++id) {
+    pool.emplace_back(worker, id);
+  }
+  worker(0);
+  for (auto& thread : pool) {
+    thread.join();
+  }
+  double sum = 0.0;
+  for (double value : partial) {
+    sum += value;
+  }
+  return sum;
+}
+
+void OptimizationEngine::SetGemmBlocking(const GemmBlocking& blocking) {
+  gemm_blocking_.block_m = std::max<size_t>(blocking.block_m, 1);
+  gemm_blocking_.block_k = std::max<size_t>(blocking.block_k, 1);
+  gemm_blocking_.block_n = std::max<size_t>(blocking.block_n, 1);
+}
+
+void OptimizationEngine::SetReductionParallelism(const ReductionParallelism& parallelism) {
+  reduction_.threads = std::max<size_t>(parallelism.threads, 1);
+  reduction_.chunk = std::max<size_t>(parallelism.chunk, 1);
+}
+
+size_t OptimizationEngine::GetMemoryThreadCap(int numa_node) const {
+  if (numa_node < 0) {
+    numa_node = 0;
+  }
+  return static_cast<size_t>(numa_node) < memory_thread_caps_.size()
+             ? memory_thread_caps_[numa_node]
+             : 0;
+}
+
+void OptimizationEngine::SetMemoryThreadCap(int numa_node, size_t threads) {
+  if (numa_node < 0) {
     return;
   }
-  
-  // Векторизованная версия (упрощённая)
-  for (size_t i = 0; i < M; ++i) {
-    for (size_t j = 0; j < N; j += 4) {
-      __m256d sum_vec = _mm256_setzero_pd();
-      
-      for (size_t k = 0; k < K; ++k) {
-        __m256d a_vec = _mm256_set1_pd(A[i * K + k]);
-        __m256d b_vec = _mm256_loadu_pd(&B[k * N + j]);
-        sum_vec = _mm256_add_pd(sum_vec, _mm256_mul_pd(a_vec, b_vec));
-      }
-      
-      _mm256_storeu_pd(&C[i * N + j], sum_vec);
+  if (static_cast<size_t>(numa_node) >= memory_thread_caps_.size()) {
+    memory_thread_caps_.resize(numa_node + 1, 0);
+  }
+  memory_thread_caps_[numa_node] = threads;
+
+  // Без узла данных берётся самый низкий потолок: колено не превышается ни на одном узле
+  min_memory_thread_cap_ = 0;
+  for (size_t cap : memory_thread_caps_) {
+    if (cap > 0 && (min_memory_thread_cap_ == 0 || cap < min_memory_thread_cap_)) {
+      min_memory_thread_cap_ = cap;
     }
   }
 }
@@ -182,22 +365,104 @@ void OptimizationEngine::MatrixMultiply_AVX2(
 // ============================================================================
 
 void OptimizationEngine::Prefetch(const void* ptr, int hint) {
-  // __builtin_prefetch доступен в GCC/Clang
-  __builtin_prefetch(ptr, 0, hint);
+  // __builtin_prefetch доступен в GCC/Clang; локальность должна быть
+  // константой времени компиляции (3 = L1 ... 0 = без сохранения в кэше)
+  switch (hint) {
+    case 0:
+      __builtin_prefetch(ptr, 0, 3);
+      break;
+    case 1:
+      __builtin_prefetch(ptr, 0, 2);
+      break;
+    case 2:
+      __builtin_prefetch(ptr, 0, 1);
+      break;
+    default:
+      __builtin_prefetch(ptr, 0, 0);
+      break;
+  }
 }
 
 void OptimizationEngine::ProcessArrayWithPrefetch(int* array, size_t size) {
-  constexpr size_t PREFETCH_DISTANCE = 8;  // Prefetch 8 элементов вперёд
-  
-  for (size_t i = 0; i < size; ++i) {
-    // Предзагрузка данных
-    if (i + PREFETCH_DISTANCE < size) {
-      Prefetch(&array[i + PREFETCH_DISTANCE]);
+  // Одна предвыборка на кэш-линию на настроенной дистанции: прежние
+  // 8 элементов (32 байта) не покрывали латентность DRAM
+  ForEachSequential(array, size, GetPrefetchSetting(AccessPattern::kSequential),
+                    [](int& x) { x = x * 2 + 1; });
+}
+
+PrefetchSetting OptimizationEngine::GetPrefetchSetting(AccessPattern pattern) const {
+  size_t index = static_cast<size_t>(pattern);
+  if (index >= static_cast<size_t>(AccessPattern::kCount)) {
+    return PrefetchSetting();
+  }
+  return prefetch_settings_[index];
+}
+
+void OptimizationEngine::SetPrefetchSetting(AccessPattern pattern,
+                                            const PrefetchSetting& setting) {
+  size_t index = static_cast<size_t>(pattern);
+  if (index < static_cast<size_t>(AccessPattern::kCount)) {
+    prefetch_settings_[index] = setting;
+  }
+}
+
+size_t OptimizationEngine::LoadPrefetchSettings(const MachineProfile& profile) {
+  size_t loaded = 0;
+  for (size_t p = 0; p < static_cast<size_t>(AccessPattern::kCount); ++p) {
+    AccessPattern pattern = static_cast<AccessPattern>(p);
+    if (profile.Has("prefetch.scale." + std::string(AccessPatternName(pattern)) + ".distance")) {
+      prefetch_settings_[p] =
+          PrefetchTuner::Lookup(profile, "scale", pattern, prefetch_settings_[p]);
+      ++loaded;
     }
-    
-    // Обработка текущего элемента
-    array[i] = array[i] * 2 + 1;
   }
+  return loaded;
+}
+
+size_t OptimizationEngine::LoadTunedParameters(const MachineProfile& profile,
+                                               const std::string& cache_signature) {
+  size_t loaded = LoadPrefetchSettings(profile);
+  TuningPoint point;
+  if (Autotuner::LoadFromProfile(profile, "gemm", cache_signature, &point)) {
+    GemmBlocking blocking;
+    blocking.block_m = static_cast<size_t>(point["block_m"]);
+    blocking.block_k = static_cast<size_t>(point["block_k"]);
+    blocking.block_n = static_cast<size_t>(point["block_n"]);
+    SetGemmBlocking(blocking);
+    ++loaded;
+  }
+  if (Autotuner::LoadFromProfile(profile, "reduction", cache_signature, &point)) {
+    ReductionParallelism parallelism;
+    parallelism.threads = static_cast<size_t>(point["threads"]);
+    parallelism.chunk = static_cast<size_t>(point["chunk"]);
+    SetReductionParallelism(parallelism);
+    ++loaded;
+  }
+  if (LoadMemorySaturation(profile) > 0) {
+    ++loaded;
+  }
+  return loaded;
+}
+
+size_t OptimizationEngine::LoadMemorySaturation(const MachineProfile& profile) {
+  memory_thread_caps_.clear();
+  min_memory_thread_cap_ = 0;
+  auto nodes = profile.Data().get_child_optional("memory_saturation");
+  if (!nodes) {
+    return 0;
+  }
+  size_t loaded = 0;
+  for (const auto& child : *nodes) {
+    if (child.first.compare(0, 4, "node") != 0) {
+      continue;
+    }
+    int node = std::atoi(child.first.c_str() + 4);
+    if (size_t knee = MemoryBenchmark::LoadSaturationKnee(profile, node)) {
+      SetMemoryThreadCap(node, knee);
+      ++loaded;
+    }
+  }
+  return loaded;
 }
 
 // ============================================================================
@@ -211,7 +476,8 @@ bool OptimizationEngine::CheckAVX2Support() {
     // Бит 28 в ECX - AVX
     bool avx = (ecx & (1 << 28)) != 0;
     
-    if (avx && __get_cpuid(7, &eax, &ebx, &ecx, &edx)) {
+    // Лист 7 требует подлиста 0 в ECX: __get_cpuid оставляет там мусор
+    if (avx && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
       // Бит 5 в EBX - AVX2
       return (ebx & (1 << 5)) != 0;
     }
@@ -223,7 +489,7 @@ bool OptimizationEngine::CheckAVX2Support() {
 bool OptimizationEngine::CheckAVX512Support() {
   unsigned int eax, ebx, ecx, edx;
   
-  if (__get_cpuid(7, &eax, &ebx, &ecx, &edx)) {
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
     // Бит 16 в EBX - AVX-512F (Foundation)
     return (ebx & (1 << 16)) != 0;
   }
@@ -237,9 +503,62 @@ bool OptimizationEngine::CheckAVX512Support() {
 // Пример использования
 // ============================================================================
 
-int main() {
+#ifndef HARDWARE_ANALYSIS_NO_MAIN
+#include "numa_rebalancer.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstring>
+
+namespace {
+
+std::atomic<bool> g_stop_requested(false);
+
+void HandleStopSignal(int) {
+  g_stop_requested.store(true);
+}
+
+/**
+ * @brief Режим демона: stage4_optimization --numa-rebalance <pid> [interval_ms] [--dry-run]
+ */
+int RunNumaRebalancerDaemon(int argc, char** argv) {
+  using namespace hardware_analysis;
+  
+  NumaRebalancerConfig config;
+  pid_t pid = static_cast<pid_t>(std::atoi(argv[2]));
+  for (int i = 3; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--dry-run") == 0) {
+      config.dry_run = true;
+    } else {
+      config.sample_interval_ms = std::strtoull(argv[i], nullptr, 10);
+    }
+  }
+  
+  std::signal(SIGINT, HandleStopSignal);
+  std::signal(SIGTERM, HandleStopSignal);
+  
+  try {
+    OptimizationEngine engine;
+    NumaRebalancer rebalancer(pid, engine, config);
+    std::cout << "NUMA rebalancer started for pid " << pid
+              << (config.dry_run ? " (dry run)" : "") << "\n";
+    rebalancer.Run(g_stop_requested);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
   using namespace hardware_analysis;
   
+  if (argc >= 3 && std::strcmp(argv[1], "--numa-rebalance") == 0) {
+    return RunNumaRebalancerDaemon(argc, argv);
+  }
+  
   std::cout << "=== Optimization Engine Demo ===\n\n";
   
   OptimizationEngine engine;
@@ -278,6 +597,18 @@ int main() {
   
   // 4. Prefetching
   std::cout << "\n4. Prefetching Demo:\n";
+  try {
+    MachineProfile profile = MachineProfile::Load(MachineProfile::DefaultPath(),
+                                                   MachineProfile::DetectCpuModel());
+    if (engine.LoadTunedParameters(profile, MachineProfile::DetectCacheSignature()) == 0) {
+      std::cout << "No tuned parameters in profile (run stage7 prefetch-tune, autotune)\n";
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Warning: " << e.what() << "\n";
+  }
+  PrefetchSetting sequential = engine.GetPrefetchSetting(AccessPattern::kSequential);
+  std::cout << "Prefetch distance: " << sequential.distance << " elements, hint "
+            << sequential.hint << "\n";
   int* int_array = new int[SIZE];
   for (size_t i = 0; i < SIZE; ++i) {
     int_array[i] = i;
@@ -291,3 +622,4 @@ int main() {
   
   return 0;
 }
+#endif  // HARDWARE_ANALYSIS_NO_MAIN
@@ -4,8 +4,12 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <immintrin.h>  // AVX/AVX2/AVX-512
 
+#include "cache_topology.hpp"
+#include "prefetch_loops.hpp"
+
 namespace hardware_analysis {
 
 /**
@@ -18,12 +22,42 @@ struct DVFSConfig {
   double power_limit_watts;
 };
 
+/**
+ * @brief Размеры блоков GEMM (в элементах)
+ *
+ * block_k x block_n панель B должна помещаться в L2, block_m x block_k
+ * полоса A - в L1.
+ */
+struct GemmBlocking {
+  size_t block_m = 64;
+  size_t block_k = 256;
+  size_t block_n = 512;
+
+  /**
+   * @brief Блоки по размерам кэшей: строка C (block_n) - половина L1D,
+   *        панель B (block_k x block_n) - половина L2
+   */
+  static GemmBlocking ForCaches(const CacheTopology& caches);
+};
+
+/**
+ * @brief Параллельность редукции: потоки и порция работы на захват
+ */
+struct ReductionParallelism {
+  size_t threads = 1;
+  size_t chunk = 1u << 16;
+};
+
+class CpufreqActuator;
+class MachineProfile;
+
 /**
  * @brief Движок оптимизации производительности
  */
 class OptimizationEngine {
  public:
   OptimizationEngine();
+  ~OptimizationEngine();
 
   // ========== DVFS оптимизация ==========
   
@@ -46,6 +80,17 @@ class OptimizationEngine {
    */
   bool SetCpuFrequency(int cpu_id, uint64_t frequency_mhz);
 
+  /**
+   * @brief Корень sysfs для cpufreq (по умолчанию /sys/devices/system/cpu)
+   * @param root Путь (для тестов - фейковое дерево)
+   */
+  void SetSysfsCpuRoot(const std::string& root);
+
+  /**
+   * @brief Актуатор cpufreq с открытыми дескрипторами (создаётся при первом вызове)
+   */
+  CpufreqActuator& GetCpufreqActuator();
+
   // ========== NUMA оптимизация ==========
   
   /**
@@ -62,6 +107,32 @@ class OptimizationEngine {
    */
   int FindBestNumaNode();
 
+  /**
+   * @brief Определение NUMA узла, которому принадлежит процессор
+   * @param cpu_id ID процессора
+   * @return Номер узла или -1, если NUMA недоступна
+   */
+  int GetNumaNodeOfCpu(int cpu_id);
+
+  /**
+   * @brief Запрос текущего размещения страниц процесса (move_pages без миграции)
+   * @param pid ID процесса (0 = текущий)
+   * @param pages Адреса страниц
+   * @param nodes Выход: узел каждой страницы или отрицательный errno
+   * @return true если успешно
+   */
+  bool QueryPageNodes(pid_t pid, const std::vector<void*>& pages,
+                      std::vector<int>& nodes);
+
+  /**
+   * @brief Миграция страниц процесса на указанный NUMA узел (move_pages)
+   * @param pid ID процесса (0 = текущий)
+   * @param pages Адреса страниц
+   * @param numa_node Целевой узел
+   * @return Количество страниц, оказавшихся на целевом узле, или -1 при ошибке
+   */
+  long MovePagesToNode(pid_t pid, const std::vector<void*>& pages, int numa_node);
+
   // ========== Векторизация ==========
   
   /**
@@ -73,7 +144,7 @@ class OptimizationEngine {
   double VectorizedSum_AVX2(const double* array, size_t size);
 
   /**
-   * @brief Векторизованное умножение матриц (AVX2)
+   * @brief Векторизованное умножение матриц (AVX2), блочное по GetGemmBlocking()
    * @param A Матрица A (M x K)
    * @param B Матрица B (K x N)
    * @param C Результирующая матрица (M x N)
@@ -83,10 +154,52 @@ class OptimizationEngine {
       const double* A, const double* B, double* C,
       size_t M, size_t K, size_t N);
 
+  /**
+   * @brief Сумма массива в несколько потоков (GetReductionParallelism())
+   *
+   * Потоки забирают порции по chunk элементов из общего счётчика и
+   * суммируют их VectorizedSum_AVX2.
+   *
+   * @param numa_node Узел данных для потолка GetMemoryThreadCap; -1 - самый
+   *                  низкий потолок среди измеренных узлов
+   */
+  double ParallelSum(const double* array, size_t size, int numa_node = -1);
+
+  /**
+   * @brief Число потоков, которое ParallelSum запустит для size элементов:
+   *        GetReductionParallelism(), не больше порций и потолка узла
+   */
+  size_t ParallelSumThreads(size_t size, int numa_node = -1) const;
+
+  /**
+   * @brief Иерархия кэшей, по которой выбраны блоки по умолчанию
+   */
+  const CacheTopology& GetCacheTopology() const { return caches_; }
+
+  GemmBlocking GetGemmBlocking() const { return gemm_blocking_; }
+  void SetGemmBlocking(const GemmBlocking& blocking);
+
+  ReductionParallelism GetReductionParallelism() const { return reduction_; }
+  void SetReductionParallelism(const ReductionParallelism& parallelism);
+
+  /**
+   * @brief Потолок потоков потоковых ядер на узле NUMA: колено кривой насыщения
+   *
+   * Сверх колена новые потоки только делят пропускную способность узла.
+   * ParallelSum ограничивает им число потоков; вызывающий код может так же
+   * ограничивать свои пулы на узле.
+   *
+   * @return 0 если кривая узла не измерена (без ограничения)
+   */
+  size_t GetMemoryThreadCap(int numa_node) const;
+  void SetMemoryThreadCap(int numa_node, size_t threads);
+
   // ========== Cache-friendly структуры ==========
   
   /**
    * @brief Оптимизированная структура данных с выравниванием по cache line
+   *
+   * Размер линии берётся из CacheLineSize(), а не предполагается 64 байта.
    * 
    * Пример: вместо struct { int a; int b; } использовать:
    * alignas(64) struct CacheFriendly { int a; char pad1[60]; int b; char pad2[60]; }
@@ -105,7 +218,6 @@ class OptimizationEngine {
    private:
     T* data_;
     size_t size_;
-    static constexpr size_t CACHE_LINE_SIZE = 64;
   };
 
   // ========== Prefetching ==========
@@ -119,9 +231,42 @@ class OptimizationEngine {
 
   /**
    * @brief Оптимизированный цикл с prefetching
+   *
+   * Дистанция и уровень берутся из настройки kSequential
+   * (по умолчанию 16 кэш-линий вперёд, после LoadPrefetchSettings - из профиля).
    */
   void ProcessArrayWithPrefetch(int* array, size_t size);
 
+  /**
+   * @brief Предвыборка, используемая циклами движка для шаблона доступа
+   */
+  PrefetchSetting GetPrefetchSetting(AccessPattern pattern) const;
+  void SetPrefetchSetting(AccessPattern pattern, const PrefetchSetting& setting);
+
+  /**
+   * @brief Загрузка настроенной предвыборки ядра "scale" из профиля машины
+   * @return Количество шаблонов, найденных в профиле
+   */
+  size_t LoadPrefetchSettings(const MachineProfile& profile);
+
+  /**
+   * @brief Загрузка всех настроенных параметров (Autotuner, PrefetchTuner,
+   *        колени насыщения памяти)
+   *
+   * Вызывается один раз при старте: параметры копируются в поля движка,
+   * поэтому вызовы ядер не обращаются к профилю.
+   *
+   * @param cache_signature MachineProfile::DetectCacheSignature() текущей машины
+   * @return Количество загруженных ядер
+   */
+  size_t LoadTunedParameters(const MachineProfile& profile, const std::string& cache_signature);
+
+  /**
+   * @brief Колени насыщения чтения по узлам (MemoryBenchmark::StoreSaturationInProfile)
+   * @return Количество узлов с измеренным коленом
+   */
+  size_t LoadMemorySaturation(const MachineProfile& profile);
+
  private:
   /**
    * @brief Проверка поддержки AVX2
@@ -135,6 +280,14 @@ class OptimizationEngine {
 
   bool avx2_supported_;
   bool avx512_supported_;
+  std::string sysfs_cpu_root_;
+  std::unique_ptr<CpufreqActuator> cpufreq_;
+  PrefetchSetting prefetch_settings_[static_cast<size_t>(AccessPattern::kCount)];
+  CacheTopology caches_;
+  GemmBlocking gemm_blocking_;
+  ReductionParallelism reduction_;
+  std::vector<size_t> memory_thread_caps_;   // По узлам NUMA, 0 - без ограничения
+  size_t min_memory_thread_cap_;             // Наименьший ненулевой из memory_thread_caps_
 };
 
 // ========== Реализация шаблонных функций ==========
@@ -143,7 +296,7 @@ template<typename T>
 OptimizationEngine::CacheAlignedVector<T>::CacheAlignedVector(size_t size)
     : size_(size) {
   // Выделяем выровненную память
-  posix_memalign(reinterpret_cast<void**>(&data_), CACHE_LINE_SIZE, 
+  posix_memalign(reinterpret_cast<void**>(&data_), CacheLineSize(), 
                  size * sizeof(T));
 }
 
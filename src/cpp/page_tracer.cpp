@@ -0,0 +1,356 @@
+#include "page_tracer.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr uint64_t kPresentBit = 1ull << 63;
+constexpr uint64_t kSoftDirtyBit = 1ull << 55;
+constexpr uint64_t kPfnMask = (1ull << 55) - 1;
+constexpr size_t kPagemapChunk = 512;     // Записей pagemap за один pread (4 КБ)
+
+std::string ReadWholeFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return "";
+  }
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  return oss.str();
+}
+
+double ThreadCpuSeconds() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+}  // namespace
+
+// ============================================================================
+// Признак обращения
+// ============================================================================
+
+const char* PageTrackingName(PageTracking tracking) {
+  return tracking == PageTracking::kSoftDirty ? "soft-dirty" : "idle";
+}
+
+PageTracking ParsePageTracking(const std::string& name) {
+  if (name == "idle") {
+    return PageTracking::kIdlePage;
+  }
+  if (name == "soft-dirty") {
+    return PageTracking::kSoftDirty;
+  }
+  throw std::invalid_argument("Unknown page tracking mode: " + name);
+}
+
+// ============================================================================
+// PageAccessScanner
+// ============================================================================
+
+PageAccessScanner::PageAccessScanner(pid_t pid, const PageScanConfig& config)
+    : pid_(pid),
+      config_(config),
+      pagemap_fd_(-1),
+      bitmap_fd_(-1),
+      clear_refs_fd_(-1),
+      cursor_(0),
+      primed_(config.tracking == PageTracking::kSoftDirty),
+      word_index_(~0ull),
+      word_(0),
+      word_marks_(0),
+      entries_(kPagemapChunk) {
+  if (config_.max_pages_per_scan == 0) {
+    throw std::invalid_argument("Page scan budget must be positive");
+  }
+  std::string base = config_.proc_root + "/" + std::to_string(pid_);
+  pagemap_fd_ = open((base + "/pagemap").c_str(), O_RDONLY | O_CLOEXEC);
+  if (pagemap_fd_ < 0) {
+    throw std::runtime_error("Cannot open " + base + "/pagemap: " + std::strerror(errno));
+  }
+
+  if (config_.tracking == PageTracking::kIdlePage) {
+    bitmap_fd_ = open(config_.page_idle_bitmap.c_str(), O_RDWR | O_CLOEXEC);
+    if (bitmap_fd_ < 0) {
+      int error = errno;
+      close(pagemap_fd_);
+      throw std::runtime_error("Idle page tracking is unavailable (" +
+                               config_.page_idle_bitmap + ": " + std::strerror(error) +
+                               "), try soft-dirty");
+    }
+  } else {
+    clear_refs_fd_ = open((base + "/clear_refs").c_str(), O_WRONLY | O_CLOEXEC);
+    if (clear_refs_fd_ < 0) {
+      int error = errno;
+      close(pagemap_fd_);
+      throw std::runtime_error("Cannot open " + base + "/clear_refs: " + std::strerror(error));
+    }
+    // Отсчёт записей - с момента создания
+    ClearSoftDirty();
+  }
+}
+
+PageAccessScanner::~PageAccessScanner() {
+  for (int fd : {pagemap_fd_, bitmap_fd_, clear_refs_fd_}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+std::vector<PageRegion> PageAccessScanner::ParseMaps(const std::string& maps) {
+  // "start-end perms offset dev inode path"
+  std::vector<PageRegion> regions;
+  std::istringstream stream(maps);
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream fields(line);
+    std::string range, perms, offset, device, inode;
+    if (!(fields >> range >> perms >> offset >> device >> inode)) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    if (dash == std::string::npos || perms.size() < 2) {
+      continue;
+    }
+    PageRegion region;
+    try {
+      region.start = std::stoull(range.substr(0, dash), nullptr, 16);
+      region.end = std::stoull(range.substr(dash + 1), nullptr, 16);
+    } catch (const std::exception&) {
+      continue;
+    }
+    std::getline(fields >> std::ws, region.path);
+    region.readable = perms[0] == 'r';
+    region.writable = perms[1] == 'w';
+    region.anonymous =
+        region.path.empty() || region.path == "[heap]" || region.path.rfind("[stack", 0) == 0;
+    regions.push_back(region);
+  }
+  return regions;
+}
+
+std::vector<PageRegion> PageAccessScanner::Regions() const {
+  std::vector<PageRegion> regions;
+  for (const PageRegion& region :
+       ParseMaps(ReadWholeFile(config_.proc_root + "/" + std::to_string(pid_) + "/maps"))) {
+    // vsyscall лежит вне пользовательского пространства pagemap
+    if (!region.readable || region.path == "[vsyscall]" ||
+        region.end - region.start < config_.min_region_bytes ||
+        (config_.anonymous_only && !region.anonymous)) {
+      continue;
+    }
+    regions.push_back(region);
+  }
+  std::sort(regions.begin(), regions.end(),
+            [](const PageRegion& a, const PageRegion& b) { return a.start < b.start; });
+  return regions;
+}
+
+PageScanStats PageAccessScanner::Scan(std::vector<uint64_t>& accessed,
+                                      std::vector<bool>& written) {
+  PageScanStats stats;
+  double cpu_start = ThreadCpuSeconds();
+  stats.priming = !primed_;
+
+  std::string maps_path = config_.proc_root + "/" + std::to_string(pid_) + "/maps";
+  if (access(maps_path.c_str(), R_OK) != 0) {
+    stats.process_alive = false;
+    return stats;
+  }
+  std::vector<PageRegion> regions = Regions();
+
+  bool budget_left = true;
+  for (const PageRegion& region : regions) {
+    if (region.end <= cursor_) {
+      continue;
+    }
+    uint64_t page = std::max(region.start, cursor_) / kPageBytes;
+    uint64_t end_page = region.end / kPageBytes;
+    while (page < end_page) {
+      uint64_t budget = config_.max_pages_per_scan - stats.pages_examined;
+      size_t count = static_cast<size_t>(
+          std::min<uint64_t>({kPagemapChunk, end_page - page, budget}));
+      ssize_t bytes = pread(pagemap_fd_, entries_.data(), count * sizeof(uint64_t),
+                            static_cast<off_t>(page * sizeof(uint64_t)));
+      size_t valid = bytes > 0 ? static_cast<size_t>(bytes) / sizeof(uint64_t) : 0;
+
+      for (size_t i = 0; i < valid; ++i) {
+        uint64_t entry = entries_[i];
+        if ((entry & kPresentBit) == 0) {
+          continue;
+        }
+        ++stats.pages_present;
+        bool touched;
+        if (config_.tracking == PageTracking::kSoftDirty) {
+          touched = (entry & kSoftDirtyBit) != 0;
+        } else {
+          // Без CAP_SYS_ADMIN pagemap отдаёт нулевой PFN
+          uint64_t pfn = entry & kPfnMask;
+          if (pfn == 0) {
+            continue;
+          }
+          touched = !PageIdle(pfn) && primed_;
+          MarkIdle(pfn);
+        }
+        if (touched) {
+          ++stats.pages_accessed;
+          accessed.push_back((page + i) * kPageBytes);
+          written.push_back(config_.tracking == PageTracking::kSoftDirty);
+        }
+      }
+
+      stats.pages_examined += count;
+      page += count;
+      cursor_ = page * kPageBytes;
+      if (stats.pages_examined >= config_.max_pages_per_scan) {
+        budget_left = false;
+        break;
+      }
+    }
+    if (!budget_left) {
+      break;
+    }
+  }
+  // Слово перечитывается в следующем проходе: процесс мог трогать страницы
+  FlushIdleWord();
+  word_index_ = ~0ull;
+
+  // Остановка на границе последнего региона тоже завершает цикл
+  if (budget_left || regions.empty() || cursor_ >= regions.back().end) {
+    stats.cycle_complete = true;
+    cursor_ = 0;
+    if (config_.tracking == PageTracking::kSoftDirty) {
+      ClearSoftDirty();
+    }
+    primed_ = true;
+  }
+  stats.cpu_seconds = ThreadCpuSeconds() - cpu_start;
+  return stats;
+}
+
+bool PageAccessScanner::PageIdle(uint64_t pfn) {
+  uint64_t index = pfn / 64;
+  if (index != word_index_) {
+    FlushIdleWord();
+    word_index_ = index;
+    if (pread(bitmap_fd_, &word_, sizeof(word_), static_cast<off_t>(index * sizeof(word_))) !=
+        static_cast<ssize_t>(sizeof(word_))) {
+      word_ = ~0ull;   // Нечитаемое слово: страницы не считаются тронутыми
+    }
+  }
+  return (word_ >> (pfn % 64)) & 1;
+}
+
+void PageAccessScanner::MarkIdle(uint64_t pfn) {
+  // PageIdle уже загрузил слово этой страницы
+  word_marks_ |= 1ull << (pfn % 64);
+}
+
+void PageAccessScanner::FlushIdleWord() {
+  if (word_marks_ == 0) {
+    return;
+  }
+  // Единицы отмечают страницы простаивающими, нули ядро игнорирует: пишем
+  // только свои отметки, иначе страницы слова, тронутые после чтения, снова
+  // стали бы простаивающими
+  if (pwrite(bitmap_fd_, &word_marks_, sizeof(word_marks_),
+             static_cast<off_t>(word_index_ * sizeof(word_marks_))) ==
+      static_cast<ssize_t>(sizeof(word_marks_))) {
+    word_ |= word_marks_;
+  }
+  word_marks_ = 0;
+}
+
+void PageAccessScanner::ClearSoftDirty() {
+  if (pwrite(clear_refs_fd_, "4", 1, 0) != 1) {
+    throw std::runtime_error("Cannot clear soft-dirty bits of process " +
+                             std::to_string(pid_) + ": " + std::strerror(errno));
+  }
+}
+
+// ============================================================================
+// PageTracer
+// ============================================================================
+
+PageTracer::PageTracer(pid_t pid, const std::string& trace_path,
+                       const PageTracerConfig& config)
+    : config_(config),
+      scanner_(pid, config.scan),
+      writer_(trace_path),
+      scans_(0),
+      cpu_seconds_(0.0) {}
+
+PageScanStats PageTracer::Scan() {
+  accessed_.clear();
+  written_.clear();
+  PageScanStats stats = scanner_.Scan(accessed_, written_);
+  double cpu_start = ThreadCpuSeconds();
+  for (size_t i = 0; i < accessed_.size(); ++i) {
+    writer_.Write(accessed_[i], written_[i] ? AccessType::kWrite : AccessType::kRead);
+  }
+  stats.cpu_seconds += ThreadCpuSeconds() - cpu_start;
+  ++scans_;
+  cpu_seconds_ += stats.cpu_seconds;
+  return stats;
+}
+
+uint64_t PageTracer::NextDelayMs(uint64_t interval_ms, double scan_cpu_seconds,
+                                 double max_cpu_fraction) {
+  if (max_cpu_fraction <= 0.0 || max_cpu_fraction >= 1.0) {
+    return interval_ms;
+  }
+  // Обход cpu секунд на цикл (cpu + пауза) - не больше доли max_cpu_fraction
+  double pause_ms = scan_cpu_seconds * 1000.0 * (1.0 / max_cpu_fraction - 1.0);
+  return std::max(interval_ms, static_cast<uint64_t>(pause_ms + 0.5));
+}
+
+void PageTracer::Run(const std::atomic<bool>& stop, std::ostream* log) {
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed_ms = [&start]() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count());
+  };
+
+  while (!stop.load()) {
+    PageScanStats stats = Scan();
+    if (!stats.process_alive) {
+      break;
+    }
+    if (log != nullptr) {
+      *log << "scan " << scans_ << ": " << stats.pages_examined << " pages, "
+           << stats.pages_present << " present, " << stats.pages_accessed << " accessed"
+           << (stats.priming ? " (priming)" : "") << (stats.cycle_complete ? ", cycle" : "")
+           << ", " << stats.cpu_seconds * 1000.0 << " ms cpu\n";
+    }
+
+    uint64_t deadline =
+        elapsed_ms() + NextDelayMs(config_.interval_ms, stats.cpu_seconds,
+                                   config_.max_cpu_fraction);
+    if (config_.duration_ms > 0 && elapsed_ms() >= config_.duration_ms) {
+      break;
+    }
+    // Пауза кусками, чтобы быстро реагировать на stop
+    while (!stop.load() && elapsed_ms() < deadline &&
+           (config_.duration_ms == 0 || elapsed_ms() < config_.duration_ms)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(
+          std::min<uint64_t>(50, deadline - std::min(deadline, elapsed_ms()))));
+    }
+  }
+  writer_.Close();
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,203 @@
+#ifndef PAGE_TRACER_HPP
+#define PAGE_TRACER_HPP
+
+#include "memory_trace.hpp"
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Источник признака обращения к странице
+ */
+enum class PageTracking {
+  kIdlePage = 0,     // /sys/kernel/mm/page_idle/bitmap: чтения и записи, нужен root
+  kSoftDirty         // clear_refs 4 + бит 55 pagemap: только записи
+};
+
+const char* PageTrackingName(PageTracking tracking);
+
+/**
+ * @brief Разбор "idle" или "soft-dirty"
+ * @throws std::invalid_argument для неизвестного имени
+ */
+PageTracking ParsePageTracking(const std::string& name);
+
+/**
+ * @brief Регион адресного пространства из /proc/pid/maps
+ */
+struct PageRegion {
+  uint64_t start;
+  uint64_t end;
+  bool readable;
+  bool writable;
+  bool anonymous;    // Без файла, [heap] или [stack]
+  std::string path;
+};
+
+/**
+ * @brief Параметры обхода страниц
+ */
+struct PageScanConfig {
+  PageTracking tracking = PageTracking::kIdlePage;
+  uint64_t max_pages_per_scan = 1u << 18;   // Виртуальных страниц за Scan (1 ГБ по 4 КБ)
+  uint64_t min_region_bytes = 0;            // Мелкие регионы (библиотеки) пропускаются
+  bool anonymous_only = false;
+  std::string proc_root = "/proc";
+  std::string page_idle_bitmap = "/sys/kernel/mm/page_idle/bitmap";
+};
+
+/**
+ * @brief Итог одного Scan
+ */
+struct PageScanStats {
+  uint64_t pages_examined = 0;       // Записей pagemap
+  uint64_t pages_present = 0;
+  uint64_t pages_accessed = 0;
+  bool cycle_complete = false;       // Обход дошёл до конца адресного пространства
+  bool priming = false;              // Первый цикл idle: страницы только отмечались
+  bool process_alive = true;
+  double cpu_seconds = 0.0;          // Время потока на обход
+};
+
+/**
+ * @brief Обход страниц чужого процесса с признаком обращения
+ *
+ * Каждый Scan продолжает обход /proc/pid/pagemap с места, где остановился
+ * прошлый, и проверяет не больше max_pages_per_scan страниц: так стоимость
+ * одного прохода ограничена, а большой процесс обходится за несколько
+ * проходов (цикл).
+ *
+ * kIdlePage: по номеру физической страницы из pagemap читается бит
+ * page_idle; сброшенный бит значит, что страницу трогали после прошлой
+ * отметки, и её бит снова выставляется. Первый цикл только отмечает
+ * страницы. kSoftDirty: страницы с битом soft-dirty записывались после
+ * прошлой очистки; clear_refs сбрасывает биты всего процесса, поэтому
+ * очистка делается в конце цикла, и время каждой записи известно с
+ * точностью до цикла. Очистка заставляет процесс заново брать page fault
+ * на первую запись в страницу - это цена режима для наблюдаемого процесса.
+ */
+class PageAccessScanner {
+ public:
+  static constexpr uint64_t kPageBytes = 4096;
+
+  /**
+   * @throws std::runtime_error если pagemap не открывается или выбранный
+   *         признак недоступен (нет page_idle, нет прав на clear_refs)
+   */
+  PageAccessScanner(pid_t pid, const PageScanConfig& config = PageScanConfig());
+  ~PageAccessScanner();
+
+  PageAccessScanner(const PageAccessScanner&) = delete;
+  PageAccessScanner& operator=(const PageAccessScanner&) = delete;
+
+  /**
+   * @brief Обход следующей порции адресного пространства
+   * @param accessed Адреса тронутых страниц (дописываются по возрастанию)
+   * @param written Для каждого адреса - признак записи (soft-dirty)
+   */
+  PageScanStats Scan(std::vector<uint64_t>& accessed, std::vector<bool>& written);
+
+  /**
+   * @brief Регионы, которые обходятся (с учётом фильтров)
+   */
+  std::vector<PageRegion> Regions() const;
+
+  /**
+   * @brief Парсинг /proc/pid/maps
+   */
+  static std::vector<PageRegion> ParseMaps(const std::string& maps);
+
+  pid_t pid() const { return pid_; }
+  const PageScanConfig& config() const { return config_; }
+
+ private:
+  bool PageIdle(uint64_t pfn);
+  void MarkIdle(uint64_t pfn);
+  void FlushIdleWord();
+  void ClearSoftDirty();
+
+  pid_t pid_;
+  PageScanConfig config_;
+  int pagemap_fd_;
+  int bitmap_fd_;
+  int clear_refs_fd_;
+  uint64_t cursor_;                  // Адрес, с которого продолжается обход
+  bool primed_;
+  uint64_t word_index_;              // Кэш слова bitmap: номер слова
+  uint64_t word_;                    // Прочитанное значение
+  uint64_t word_marks_;              // Биты для отметки при сбросе
+  std::vector<uint64_t> entries_;
+};
+
+/**
+ * @brief Параметры трассировщика
+ */
+struct PageTracerConfig {
+  PageScanConfig scan;
+  uint64_t interval_ms = 100;
+  double max_cpu_fraction = 0.05;    // Доля CPU на обход: интервал растягивается
+  uint64_t duration_ms = 0;          // 0 - до остановки
+};
+
+/**
+ * @brief Трассировка страниц живого процесса в двоичную трассу
+ *
+ * Каждый проход PageAccessScanner пишет по записи на тронутую страницу
+ * (адрес начала страницы, kWrite для soft-dirty, иначе kRead). Порядок
+ * внутри прохода - по адресу, а не по времени, поэтому трасса годится для
+ * анализа повторного использования со строкой в страницу (mrc --line 4096,
+ * кэш TLB или страниц), но не для моделей предвыборки.
+ */
+class PageTracer {
+ public:
+  /**
+   * @throws std::runtime_error если трасса не создаётся или обход недоступен
+   */
+  PageTracer(pid_t pid, const std::string& trace_path,
+             const PageTracerConfig& config = PageTracerConfig());
+
+  /**
+   * @brief Один проход с записью тронутых страниц
+   */
+  PageScanStats Scan();
+
+  /**
+   * @brief Проходы с интервалом до stop, duration_ms или выхода процесса
+   * @param log Строка на проход (nullptr - без журнала)
+   */
+  void Run(const std::atomic<bool>& stop, std::ostream* log = nullptr);
+
+  /**
+   * @brief Сброс трассы на диск
+   */
+  void Close() { writer_.Close(); }
+
+  /**
+   * @brief Пауза до следующего прохода: не короче interval_ms и такая, чтобы
+   *        обход занимал не больше max_cpu_fraction времени
+   */
+  static uint64_t NextDelayMs(uint64_t interval_ms, double scan_cpu_seconds,
+                              double max_cpu_fraction);
+
+  uint64_t records() const { return writer_.records(); }
+  uint64_t scans() const { return scans_; }
+  double cpu_seconds() const { return cpu_seconds_; }
+
+ private:
+  PageTracerConfig config_;
+  PageAccessScanner scanner_;
+  TraceWriter writer_;
+  std::vector<uint64_t> accessed_;
+  std::vector<bool> written_;
+  uint64_t scans_;
+  double cpu_seconds_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // PAGE_TRACER_HPP
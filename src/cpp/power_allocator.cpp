@@ -0,0 +1,275 @@
+#include "power_allocator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr size_t kMinCalibrationSamples = 4;
+
+/**
+ * @brief Число шагов от min_mhz до max_mhz (последний шаг может быть неполным)
+ */
+size_t StepCount(const CoreDemand& demand, uint64_t step_mhz) {
+  if (demand.max_mhz <= demand.min_mhz) {
+    return 0;
+  }
+  return (demand.max_mhz - demand.min_mhz + step_mhz - 1) / step_mhz;
+}
+
+uint64_t FrequencyAt(const CoreDemand& demand, size_t level, uint64_t step_mhz) {
+  return std::min(demand.min_mhz + level * step_mhz, std::max(demand.min_mhz, demand.max_mhz));
+}
+
+/**
+ * @brief Прирост мощности шага level -> level + 1
+ */
+double StepPower(const CoreDemand& demand, const CorePowerModel& model,
+                 size_t level, uint64_t step_mhz) {
+  return model.Power(FrequencyAt(demand, level + 1, step_mhz), demand.load_percent) -
+         model.Power(FrequencyAt(demand, level, step_mhz), demand.load_percent);
+}
+
+/**
+ * @brief Отношение dUtility/dPower шага level -> level + 1
+ */
+double StepRatio(const CoreDemand& demand, const CorePowerModel& model,
+                 size_t level, uint64_t step_mhz) {
+  double gain = demand.weight * (demand.load_percent / 100.0) *
+      static_cast<double>(FrequencyAt(demand, level + 1, step_mhz) -
+                          FrequencyAt(demand, level, step_mhz));
+  if (gain <= 0.0) {
+    return 0.0;
+  }
+  double cost = StepPower(demand, model, level, step_mhz);
+  return cost > 0.0 ? gain / cost : std::numeric_limits<double>::max();
+}
+
+}  // namespace
+
+// ============================================================================
+// CorePowerModel
+// ============================================================================
+
+double CorePowerModel::ActivityTerm(uint64_t frequency_mhz, double load_percent) const {
+  double activity = std::max(load_percent / 100.0, idle_activity);
+  double ghz = frequency_mhz / 1000.0;
+  // Кубическая модель - горячий путь распределителя, std::pow заметно медленнее
+  return activity * (exponent == 3.0 ? ghz * ghz * ghz : std::pow(ghz, exponent));
+}
+
+double CorePowerModel::Power(uint64_t frequency_mhz, double load_percent) const {
+  return static_watts + dynamic_coeff * ActivityTerm(frequency_mhz, load_percent);
+}
+
+// ============================================================================
+// PowerModelCalibrator
+// ============================================================================
+
+PowerModelCalibrator::PowerModelCalibrator(size_t core_count, const CorePowerModel& initial,
+                                           size_t window)
+    : core_count_(std::max<size_t>(1, core_count)),
+      model_(initial),
+      samples_(std::max<size_t>(kMinCalibrationSamples, window)),
+      head_(0),
+      count_(0) {}
+
+void PowerModelCalibrator::AddSample(double package_watts,
+                                     const std::vector<uint64_t>& frequency_mhz,
+                                     const std::vector<double>& load_percent) {
+  if (!std::isfinite(package_watts) || package_watts <= 0.0) {
+    return;
+  }
+
+  double activity = 0.0;
+  size_t cores = std::min(frequency_mhz.size(), load_percent.size());
+  for (size_t i = 0; i < cores; ++i) {
+    activity += model_.ActivityTerm(frequency_mhz[i], load_percent[i]);
+  }
+
+  samples_[head_] = {activity, package_watts};
+  head_ = (head_ + 1) % samples_.size();
+  count_ = std::min(count_ + 1, samples_.size());
+}
+
+bool PowerModelCalibrator::Fit() {
+  if (count_ < kMinCalibrationSamples) {
+    return false;
+  }
+
+  // Линейная регрессия P = a + k * X
+  double mean_x = 0.0;
+  double mean_p = 0.0;
+  for (size_t i = 0; i < count_; ++i) {
+    mean_x += samples_[i].first;
+    mean_p += samples_[i].second;
+  }
+  mean_x /= count_;
+  mean_p /= count_;
+
+  double cov = 0.0;
+  double var = 0.0;
+  for (size_t i = 0; i < count_; ++i) {
+    double dx = samples_[i].first - mean_x;
+    cov += dx * (samples_[i].second - mean_p);
+    var += dx * dx;
+  }
+
+  // Без разброса активности k не определён (частоты и загрузка не менялись)
+  if (var <= 1e-9 * (mean_x * mean_x + 1.0)) {
+    return false;
+  }
+
+  double slope = cov / var;
+  if (slope <= 0.0) {
+    return false;
+  }
+
+  double intercept = std::max(0.0, mean_p - slope * mean_x);
+  model_.dynamic_coeff = slope;
+  model_.static_watts = intercept / core_count_;
+  return true;
+}
+
+// ============================================================================
+// PowerBudgetAllocator
+// ============================================================================
+
+PowerBudgetAllocator::PowerBudgetAllocator(uint64_t step_mhz)
+    : step_mhz_(std::max<uint64_t>(1, step_mhz)),
+      lambda_(std::numeric_limits<double>::infinity()) {}
+
+void PowerBudgetAllocator::Reset() {
+  lambda_ = std::numeric_limits<double>::infinity();
+}
+
+AllocationResult PowerBudgetAllocator::Allocate(const std::vector<CoreDemand>& demands,
+                                                const CorePowerModel& model,
+                                                double budget_watts,
+                                                std::vector<uint64_t>& frequency_mhz) {
+  return Solve(demands, model, budget_watts, lambda_, frequency_mhz);
+}
+
+AllocationResult PowerBudgetAllocator::AllocateFromScratch(
+    const std::vector<CoreDemand>& demands, const CorePowerModel& model,
+    double budget_watts, std::vector<uint64_t>& frequency_mhz) {
+  return Solve(demands, model, budget_watts, std::numeric_limits<double>::infinity(),
+               frequency_mhz);
+}
+
+AllocationResult PowerBudgetAllocator::Solve(const std::vector<CoreDemand>& demands,
+                                             const CorePowerModel& model,
+                                             double budget_watts, double start_lambda,
+                                             std::vector<uint64_t>& frequency_mhz) {
+  size_t n = demands.size();
+  bool warm = !std::isinf(start_lambda) && level_.size() == n;
+  level_.resize(n, 0);
+  heap_.clear();
+  heap_.reserve(n);
+
+  AllocationResult result = {};
+  result.budget_watts = budget_watts;
+
+  // Старт: все шаги с отношением > lambda. Отношение по шагам убывает,
+  // поэтому граница ищется сдвигом от уровня прошлого тика (обычно 0-2 шага)
+  double power = 0.0;
+  double baseline = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const CoreDemand& demand = demands[i];
+    size_t level = 0;
+    if (warm) {
+      size_t steps = StepCount(demand, step_mhz_);
+      level = std::min(level_[i], steps);
+      while (level > 0 && StepRatio(demand, model, level - 1, step_mhz_) <= start_lambda) {
+        --level;
+      }
+      while (level < steps && StepRatio(demand, model, level, step_mhz_) > start_lambda) {
+        ++level;
+      }
+    }
+    level_[i] = level;
+    power += model.Power(FrequencyAt(demand, level, step_mhz_), demand.load_percent);
+    baseline += model.Power(demand.min_mhz, demand.load_percent);
+  }
+  result.feasible = baseline <= budget_watts;
+
+  // Перерасход: снимаем шаги с минимальным отношением
+  if (power > budget_watts) {
+    auto min_first = std::greater<std::pair<double, size_t>>();
+    for (size_t i = 0; i < n; ++i) {
+      if (level_[i] > 0) {
+        heap_.emplace_back(StepRatio(demands[i], model, level_[i] - 1, step_mhz_), i);
+      }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), min_first);
+
+    while (power > budget_watts && !heap_.empty()) {
+      std::pop_heap(heap_.begin(), heap_.end(), min_first);
+      size_t core = heap_.back().second;
+      heap_.pop_back();
+
+      --level_[core];
+      power -= StepPower(demands[core], model, level_[core], step_mhz_);
+      ++result.steps_moved;
+      if (level_[core] > 0) {
+        heap_.emplace_back(StepRatio(demands[core], model, level_[core] - 1, step_mhz_), core);
+        std::push_heap(heap_.begin(), heap_.end(), min_first);
+      }
+    }
+    heap_.clear();
+  }
+
+  // Остаток бюджета: добавляем шаги с максимальным отношением. Шаг, не
+  // влезающий в бюджет, исключает ядро (его следующие шаги дороже)
+  double boundary = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    if (level_[i] < StepCount(demands[i], step_mhz_)) {
+      double ratio = StepRatio(demands[i], model, level_[i], step_mhz_);
+      if (ratio > 0.0) {
+        heap_.emplace_back(ratio, i);
+      }
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end());
+
+  while (!heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end());
+    double ratio = heap_.back().first;
+    size_t core = heap_.back().second;
+    heap_.pop_back();
+
+    double cost = StepPower(demands[core], model, level_[core], step_mhz_);
+    if (power + cost > budget_watts) {
+      boundary = std::max(boundary, ratio);
+      continue;
+    }
+
+    power += cost;
+    ++level_[core];
+    ++result.steps_moved;
+    if (level_[core] < StepCount(demands[core], step_mhz_)) {
+      double next = StepRatio(demands[core], model, level_[core], step_mhz_);
+      if (next > 0.0) {
+        heap_.emplace_back(next, core);
+        std::push_heap(heap_.begin(), heap_.end());
+      }
+    }
+  }
+
+  // Первый не влезший шаг задаёт границу для следующего тика
+  lambda_ = boundary;
+
+  frequency_mhz.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    frequency_mhz[i] = FrequencyAt(demands[i], level_[i], step_mhz_);
+    result.utility += demands[i].weight * (demands[i].load_percent / 100.0) * frequency_mhz[i];
+  }
+  result.power_watts = power;
+
+  return result;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,158 @@
+#ifndef POWER_ALLOCATOR_HPP
+#define POWER_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Модель мощности ядра: P(f, u) = P_static + k * max(u, u_idle) * f_GHz^alpha
+ */
+struct CorePowerModel {
+  double static_watts = 0.5;      // Утечки и uncore доля ядра
+  double dynamic_coeff = 0.2;     // Вт / ГГц^alpha при 100% активности
+  double exponent = 3.0;          // alpha: V ~ f => P_dyn ~ f^3
+  double idle_activity = 0.1;     // Доля активности простаивающего ядра
+
+  /**
+   * @brief Мощность ядра
+   * @param frequency_mhz Частота
+   * @param load_percent Загрузка (0-100)
+   * @return Мощность в Вт
+   */
+  double Power(uint64_t frequency_mhz, double load_percent) const;
+
+  /**
+   * @brief Динамический член без коэффициента: max(u, u_idle) * f_GHz^alpha
+   */
+  double ActivityTerm(uint64_t frequency_mhz, double load_percent) const;
+};
+
+/**
+ * @brief Калибровка CorePowerModel по выборкам RAPL пакета
+ *
+ * RAPL измеряет только пакет целиком, поэтому модель общая для всех ядер
+ * пакета: P_pkg = N * P_static + k * sum(activity_i). Коэффициенты P_static
+ * и k находятся методом наименьших квадратов по скользящему окну выборок.
+ */
+class PowerModelCalibrator {
+ public:
+  /**
+   * @brief Конструктор
+   * @param core_count Число ядер пакета
+   * @param initial Модель до калибровки (alpha и u_idle не калибруются)
+   * @param window Размер окна выборок
+   */
+  PowerModelCalibrator(size_t core_count, const CorePowerModel& initial = CorePowerModel(),
+                       size_t window = 256);
+
+  /**
+   * @brief Добавить выборку
+   * @param package_watts Измеренная мощность пакета за интервал
+   * @param frequency_mhz Частоты ядер пакета в течение интервала
+   * @param load_percent Загрузка ядер пакета за интервал
+   */
+  void AddSample(double package_watts, const std::vector<uint64_t>& frequency_mhz,
+                 const std::vector<double>& load_percent);
+
+  /**
+   * @brief Пересчёт коэффициентов по текущему окну
+   * @return true если модель обновлена (достаточно выборок и разброса)
+   */
+  bool Fit();
+
+  const CorePowerModel& GetModel() const { return model_; }
+  size_t SampleCount() const { return count_; }
+
+ private:
+  size_t core_count_;
+  CorePowerModel model_;
+  std::vector<std::pair<double, double>> samples_;   // (sum activity, P_pkg), кольцо
+  size_t head_;
+  size_t count_;
+};
+
+/**
+ * @brief Запрос ядра на частоту
+ */
+struct CoreDemand {
+  uint64_t min_mhz;        // Нижняя граница (всегда выделяется)
+  uint64_t max_mhz;        // Желаемая частота (потолок)
+  double load_percent;     // Загрузка: полезная работа ~ load * f
+  double weight;           // Приоритет (latency-critical ядра > 1)
+};
+
+/**
+ * @brief Результат распределения
+ */
+struct AllocationResult {
+  double budget_watts;
+  double power_watts;      // Оценка мощности по модели
+  double utility;          // sum(weight * load * f)
+  size_t steps_moved;      // Шагов снято/добавлено кучей после старта
+  bool feasible;           // false если минимальные частоты уже превышают бюджет
+};
+
+/**
+ * @brief Распределение бюджета мощности пакета между ядрами
+ *
+ * Максимизирует взвешенную производительность sum(w_i * load_i * f_i) при
+ * sum(P_i(f_i)) <= бюджет. Частоты дискретны (шаг step_mhz); полезность
+ * линейна, мощность выпукла по частоте, поэтому отношение
+ * dUtility/dPower для каждого ядра убывает и жадный выбор шага с
+ * максимальным отношением (куча) даёт оптимум с точностью до шага.
+ *
+ * Решение инкрементальное: граничное отношение lambda прошлого тика задаёт
+ * стартовую точку (все шаги с отношением > lambda), после чего куча
+ * лишь снимает или добавляет шаги у границы. При медленно меняющейся
+ * нагрузке это O(n + k log n) вместо O(шагов * log n) с нуля.
+ */
+class PowerBudgetAllocator {
+ public:
+  /**
+   * @brief Конструктор
+   * @param step_mhz Шаг частоты
+   */
+  explicit PowerBudgetAllocator(uint64_t step_mhz = 100);
+
+  /**
+   * @brief Инкрементальное распределение (старт от решения прошлого вызова)
+   * @param demands Запросы ядер
+   * @param model Модель мощности ядра
+   * @param budget_watts Бюджет пакета
+   * @param frequency_mhz [out] Частоты ядер (по индексу demands)
+   * @return Итоги распределения
+   */
+  AllocationResult Allocate(const std::vector<CoreDemand>& demands,
+                            const CorePowerModel& model, double budget_watts,
+                            std::vector<uint64_t>& frequency_mhz);
+
+  /**
+   * @brief Распределение с нуля (все ядра стартуют с min_mhz)
+   */
+  AllocationResult AllocateFromScratch(const std::vector<CoreDemand>& demands,
+                                       const CorePowerModel& model, double budget_watts,
+                                       std::vector<uint64_t>& frequency_mhz);
+
+  /**
+   * @brief Сбросить состояние прошлого тика
+   */
+  void Reset();
+
+ private:
+  AllocationResult Solve(const std::vector<CoreDemand>& demands,
+                         const CorePowerModel& model, double budget_watts,
+                         double start_lambda, std::vector<uint64_t>& frequency_mhz);
+
+  uint64_t step_mhz_;
+  double lambda_;                                // Граничное отношение прошлого тика
+  std::vector<size_t> level_;                    // Число выделенных шагов на ядро
+  std::vector<std::pair<double, size_t>> heap_;  // (отношение, ядро)
+};
+
+}  // namespace hardware_analysis
+
+#endif  // POWER_ALLOCATOR_HPP
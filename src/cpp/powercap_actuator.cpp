@@ -0,0 +1,496 @@
+#include "powercap_actuator.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "hardware_monitor.hpp"
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr uint32_t kMsrRaplPowerUnit = 0x606;
+constexpr uint32_t kMsrPkgPowerLimit = 0x610;
+constexpr uint32_t kMsrDramPowerLimit = 0x618;
+constexpr uint32_t kMsrPkgEnergyStatus = 0x611;
+constexpr uint32_t kMsrDramEnergyStatus = 0x619;
+constexpr uint64_t kMsrLockBit = 1ULL << 63;
+constexpr int kMaxConstraints = 4;
+
+// Дискрет записи мощности в powercap (единица RAPL у большинства моделей)
+constexpr double kPowercapWattsResolution = 0.125;
+// Окно кодируется как 2^Y * (1 + Z/4): ближайшее значение может отличаться на ~12%
+constexpr double kWindowTolerance = 0.25;
+
+bool ReadMsr(const std::string& path, uint32_t address, uint64_t* value) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = pread(fd, value, sizeof(*value), address) == sizeof(*value);
+  close(fd);
+  return ok;
+}
+
+bool WriteMsr(const std::string& path, uint32_t address, uint64_t value) {
+  int fd = open(path.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = pwrite(fd, &value, sizeof(value), address) == sizeof(value);
+  close(fd);
+  return ok;
+}
+
+bool WriteSysfsValue(const std::string& path, uint64_t value) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  file << value;
+  file.close();
+  return !file.fail();
+}
+
+/**
+ * @brief Единицы RAPL из MSR_RAPL_POWER_UNIT
+ */
+struct RaplUnits {
+  double watts;     // 1 / 2^PU
+  double joules;    // 1 / 2^ESU
+  double seconds;   // 1 / 2^TU
+};
+
+RaplUnits DecodeUnits(uint64_t raw) {
+  return {1.0 / static_cast<double>(1ULL << (raw & 0xF)),
+          1.0 / static_cast<double>(1ULL << ((raw >> 8) & 0x1F)),
+          1.0 / static_cast<double>(1ULL << ((raw >> 16) & 0xF))};
+}
+
+/**
+ * @brief Поле ограничения (24 бита): мощность 14:0, enable 15, clamp 16, окно 23:17
+ */
+PowerLimit DecodeLimit(uint64_t field, const RaplUnits& units) {
+  PowerLimit limit;
+  limit.watts = (field & 0x7FFF) * units.watts;
+  limit.enabled = (field >> 15) & 1;
+  uint64_t y = (field >> 17) & 0x1F;
+  uint64_t z = (field >> 22) & 0x3;
+  limit.time_window_seconds = static_cast<double>(1ULL << y) * (1.0 + z / 4.0) * units.seconds;
+  return limit;
+}
+
+uint64_t EncodeLimit(const PowerLimit& limit, const RaplUnits& units) {
+  uint64_t power = static_cast<uint64_t>(std::llround(limit.watts / units.watts));
+  power = std::min<uint64_t>(power, 0x7FFF);
+
+  // Ближайшее представимое окно
+  uint64_t best_window = 0;
+  double best_error = INFINITY;
+  for (uint64_t y = 0; y < 32; ++y) {
+    for (uint64_t z = 0; z < 4; ++z) {
+      double window = static_cast<double>(1ULL << y) * (1.0 + z / 4.0) * units.seconds;
+      double error = std::fabs(window - limit.time_window_seconds);
+      if (error < best_error) {
+        best_error = error;
+        best_window = y | (z << 5);
+      }
+    }
+  }
+
+  uint64_t enabled = limit.enabled ? 1 : 0;
+  // clamp разрешает опускаться ниже запрошенной ОС частоты - иначе PL1 не удержать
+  return power | (enabled << 15) | (enabled << 16) | (best_window << 17);
+}
+
+bool LimitMatches(const PowerLimit& requested, const PowerLimit& actual, double watts_resolution) {
+  if (requested.enabled != actual.enabled) {
+    return false;
+  }
+  if (!requested.enabled) {
+    return true;
+  }
+  double watts_tolerance = std::max(watts_resolution, 0.01 * requested.watts);
+  double window_tolerance = kWindowTolerance * requested.time_window_seconds;
+  return std::fabs(requested.watts - actual.watts) <= watts_tolerance &&
+         std::fabs(requested.time_window_seconds - actual.time_window_seconds) <=
+             window_tolerance;
+}
+
+const char* DomainName(RaplDomain domain) {
+  return domain == RaplDomain::kPackage ? "package" : "dram";
+}
+
+}  // namespace
+
+PowercapActuator::PowercapActuator(const std::string& powercap_root, const std::string& msr_root,
+                                   const std::vector<int>& package_msr_cpu)
+    : msr_root_(msr_root), package_msr_cpu_(package_msr_cpu) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  std::map<std::string, int> zone_package;   // intel-rapl:N -> package
+
+  // Сначала пакеты, затем подзоны (им нужен пакет родителя)
+  std::vector<std::string> names;
+  for (const auto& entry : fs::directory_iterator(powercap_root, error)) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, 11, "intel-rapl:") == 0) {
+      names.push_back(name);
+    }
+  }
+  auto depth = [](const std::string& name) { return std::count(name.begin(), name.end(), ':'); };
+  std::sort(names.begin(), names.end(), [&depth](const std::string& a, const std::string& b) {
+    return depth(a) != depth(b) ? depth(a) < depth(b) : a < b;
+  });
+
+  for (const std::string& name : names) {
+    Zone zone;
+    zone.path = powercap_root + "/" + name;
+    std::string zone_name;
+    try {
+      zone_name = utils::ReadSysfsString(zone.path + "/name");
+    } catch (const std::exception&) {
+      continue;
+    }
+
+    for (int i = 0; i < kMaxConstraints; ++i) {
+      try {
+        std::string constraint =
+            utils::ReadSysfsString(zone.path + "/constraint_" + std::to_string(i) + "_name");
+        if (constraint == "long_term") {
+          zone.long_term_constraint = i;
+        } else if (constraint == "short_term") {
+          zone.short_term_constraint = i;
+        }
+      } catch (const std::exception&) {
+        break;
+      }
+    }
+    if (zone.long_term_constraint < 0) {
+      continue;
+    }
+
+    size_t last_colon = name.rfind(':');
+    bool subzone = name.find(':') != last_colon;
+    if (!subzone && zone_name.compare(0, 8, "package-") == 0) {
+      int package_id = std::atoi(zone_name.c_str() + 8);
+      zone_package[name] = package_id;
+      zones_[{package_id, RaplDomain::kPackage}] = zone;
+    } else if (subzone && zone_name == "dram") {
+      auto parent = zone_package.find(name.substr(0, last_colon));
+      if (parent != zone_package.end()) {
+        zones_[{parent->second, RaplDomain::kDram}] = zone;
+      }
+    }
+  }
+}
+
+int PowercapActuator::MsrCpu(int package_id) const {
+  if (package_id < 0 || static_cast<size_t>(package_id) >= package_msr_cpu_.size()) {
+    return -1;
+  }
+  return package_msr_cpu_[package_id];
+}
+
+std::string PowercapActuator::MsrPath(int package_id) const {
+  return msr_root_ + "/" + std::to_string(MsrCpu(package_id)) + "/msr";
+}
+
+bool PowercapActuator::IsAvailable(int package_id, RaplDomain domain) const {
+  RaplLimits limits;
+  return ReadLimits(package_id, domain, &limits);
+}
+
+const char* PowercapActuator::Backend(int package_id, RaplDomain domain) const {
+  if (zones_.count({package_id, domain})) {
+    return "powercap";
+  }
+  RaplLimits limits;
+  return ReadMsrLimits(package_id, domain, &limits) ? "msr" : "none";
+}
+
+std::vector<int> PowercapActuator::Packages() const {
+  std::vector<int> packages;
+  for (const auto& entry : zones_) {
+    if (entry.first.second == RaplDomain::kPackage) {
+      packages.push_back(entry.first.first);
+    }
+  }
+  for (size_t package = 0; package < package_msr_cpu_.size(); ++package) {
+    int id = static_cast<int>(package);
+    if (!zones_.count({id, RaplDomain::kPackage}) && IsAvailable(id, RaplDomain::kPackage)) {
+      packages.push_back(id);
+    }
+  }
+  std::sort(packages.begin(), packages.end());
+  return packages;
+}
+
+bool PowercapActuator::ReadEnergy(int package_id, RaplDomain domain, double* joules,
+                                  double* range_joules) const {
+  auto zone = zones_.find({package_id, domain});
+  if (zone != zones_.end()) {
+    try {
+      *joules = utils::ReadSysfsU64(zone->second.path + "/energy_uj") / 1e6;
+      *range_joules = utils::ReadSysfsU64(zone->second.path + "/max_energy_range_uj") / 1e6;
+      return true;
+    } catch (const std::exception&) {
+      return false;   // energy_uj читается только root на новых ядрах
+    }
+  }
+
+  if (MsrCpu(package_id) < 0) {
+    return false;
+  }
+  uint64_t units_raw = 0;
+  uint64_t raw = 0;
+  uint32_t address = domain == RaplDomain::kPackage ? kMsrPkgEnergyStatus : kMsrDramEnergyStatus;
+  if (!ReadMsr(MsrPath(package_id), kMsrRaplPowerUnit, &units_raw) ||
+      !ReadMsr(MsrPath(package_id), address, &raw)) {
+    return false;
+  }
+  double unit = DecodeUnits(units_raw).joules;
+  *joules = (raw & 0xFFFFFFFF) * unit;
+  *range_joules = 4294967296.0 * unit;
+  return true;
+}
+
+// ============================================================================
+// Чтение и запись
+// ============================================================================
+
+bool PowercapActuator::ReadLimits(int package_id, RaplDomain domain, RaplLimits* limits) const {
+  auto zone = zones_.find({package_id, domain});
+  if (zone != zones_.end()) {
+    return ReadZone(zone->second, limits);
+  }
+  return ReadMsrLimits(package_id, domain, limits);
+}
+
+bool PowercapActuator::SetLimits(int package_id, RaplDomain domain, const RaplLimits& limits) {
+  RaplLimits current;
+  if (!ReadLimits(package_id, domain, &current)) {
+    std::cerr << "No RAPL " << DomainName(domain) << " domain for package " << package_id
+              << " (powercap driver or msr module required)\n";
+    return false;
+  }
+  if (current.locked) {
+    std::cerr << "RAPL " << DomainName(domain) << " limits of package " << package_id
+              << " are locked by firmware\n";
+    return false;
+  }
+  auto zone = zones_.find({package_id, domain});
+  if (zone != zones_.end()) {
+    original_.emplace(DomainKey{package_id, domain}, current);
+  } else if (!original_msr_.count({package_id, domain})) {
+    uint64_t raw = 0;
+    ReadMsr(MsrPath(package_id),
+            domain == RaplDomain::kPackage ? kMsrPkgPowerLimit : kMsrDramPowerLimit, &raw);
+    original_msr_[{package_id, domain}] = raw;
+  }
+
+  bool written = zone != zones_.end() ? WriteZone(zone->second, limits)
+                                      : WriteMsrLimits(package_id, domain, limits);
+  if (!written) {
+    std::cerr << "Failed to write RAPL " << DomainName(domain) << " limits of package "
+              << package_id << " (root required)\n";
+    return false;
+  }
+
+  // Прошивка может молча обрезать значение - проверяем чтением
+  RaplLimits actual;
+  double resolution = kPowercapWattsResolution;
+  if (zone == zones_.end()) {
+    uint64_t units_raw = 0;
+    ReadMsr(MsrPath(package_id), kMsrRaplPowerUnit, &units_raw);
+    resolution = DecodeUnits(units_raw).watts;
+  }
+  if (!ReadLimits(package_id, domain, &actual) ||
+      !LimitMatches(limits.long_term, actual.long_term, resolution) ||
+      (limits.has_short_term && actual.has_short_term &&
+       !LimitMatches(limits.short_term, actual.short_term, resolution))) {
+    std::cerr << "RAPL " << DomainName(domain) << " limit of package " << package_id
+              << " not applied as requested: PL1 " << actual.long_term.watts << " W / "
+              << actual.long_term.time_window_seconds << " s\n";
+    return false;
+  }
+  return true;
+}
+
+bool PowercapActuator::EnforcePowerLimit(int package_id, double watts,
+                                         double time_window_seconds) {
+  RaplLimits limits;
+  if (!ReadLimits(package_id, RaplDomain::kPackage, &limits)) {
+    std::cerr << "No RAPL package domain for package " << package_id << "\n";
+    return false;
+  }
+  limits.long_term = {watts, time_window_seconds, true};
+  limits.has_short_term = false;   // PL2 не трогаем
+  return SetLimits(package_id, RaplDomain::kPackage, limits);
+}
+
+bool PowercapActuator::RestoreAll() {
+  bool ok = true;
+  for (const auto& entry : original_) {
+    if (!WriteZone(zones_.at(entry.first), entry.second)) {
+      std::cerr << "Failed to restore RAPL limits of package " << entry.first.first << "\n";
+      ok = false;
+    }
+  }
+  for (const auto& entry : original_msr_) {
+    uint32_t address = entry.first.second == RaplDomain::kPackage ? kMsrPkgPowerLimit
+                                                                  : kMsrDramPowerLimit;
+    if (!WriteMsr(MsrPath(entry.first.first), address, entry.second)) {
+      std::cerr << "Failed to restore RAPL MSR of package " << entry.first.first << "\n";
+      ok = false;
+    }
+  }
+  original_.clear();
+  original_msr_.clear();
+  return ok;
+}
+
+bool PowercapActuator::ReadZone(const Zone& zone, RaplLimits* limits) const {
+  auto read_constraint = [&zone](int index, PowerLimit* limit) {
+    std::string prefix = zone.path + "/constraint_" + std::to_string(index);
+    limit->watts = utils::ReadSysfsU64(prefix + "_power_limit_uw") / 1e6;
+    limit->time_window_seconds = utils::ReadSysfsU64(prefix + "_time_window_us") / 1e6;
+  };
+
+  try {
+    *limits = RaplLimits();
+    bool enabled = true;
+    try {
+      enabled = utils::ReadSysfsU64(zone.path + "/enabled") != 0;
+    } catch (const std::exception&) {
+      // Старые ядра не экспортируют enabled
+    }
+    read_constraint(zone.long_term_constraint, &limits->long_term);
+    limits->long_term.enabled = enabled;
+    if (zone.short_term_constraint >= 0) {
+      read_constraint(zone.short_term_constraint, &limits->short_term);
+      limits->short_term.enabled = enabled;
+      limits->has_short_term = true;
+    }
+  } catch (const std::exception&) {
+    return false;
+  }
+  return true;
+}
+
+bool PowercapActuator::WriteZone(const Zone& zone, const RaplLimits& limits) {
+  auto write_constraint = [&zone](int index, const PowerLimit& limit) {
+    std::string prefix = zone.path + "/constraint_" + std::to_string(index);
+    return WriteSysfsValue(prefix + "_time_window_us",
+                           static_cast<uint64_t>(std::llround(limit.time_window_seconds * 1e6))) &&
+           WriteSysfsValue(prefix + "_power_limit_uw",
+                           static_cast<uint64_t>(std::llround(limit.watts * 1e6)));
+  };
+
+  if (!write_constraint(zone.long_term_constraint, limits.long_term)) {
+    return false;
+  }
+  if (limits.has_short_term && zone.short_term_constraint >= 0 &&
+      !write_constraint(zone.short_term_constraint, limits.short_term)) {
+    return false;
+  }
+  // В powercap включение общее для зоны
+  std::string enabled_path = zone.path + "/enabled";
+  return !std::filesystem::exists(enabled_path) ||
+         WriteSysfsValue(enabled_path, limits.long_term.enabled ? 1 : 0);
+}
+
+bool PowercapActuator::ReadMsrLimits(int package_id, RaplDomain domain,
+                                     RaplLimits* limits) const {
+  if (MsrCpu(package_id) < 0) {
+    return false;
+  }
+  std::string path = MsrPath(package_id);
+  uint64_t units_raw = 0;
+  uint64_t raw = 0;
+  uint32_t address = domain == RaplDomain::kPackage ? kMsrPkgPowerLimit : kMsrDramPowerLimit;
+  if (!ReadMsr(path, kMsrRaplPowerUnit, &units_raw) || !ReadMsr(path, address, &raw)) {
+    return false;
+  }
+
+  RaplUnits units = DecodeUnits(units_raw);
+  *limits = RaplLimits();
+  limits->long_term = DecodeLimit(raw & 0xFFFFFF, units);
+  if (domain == RaplDomain::kPackage) {
+    limits->short_term = DecodeLimit((raw >> 32) & 0xFFFFFF, units);
+    limits->has_short_term = true;
+    limits->locked = (raw & kMsrLockBit) != 0;
+  } else {
+    limits->locked = (raw & (1ULL << 31)) != 0;
+  }
+  return true;
+}
+
+bool PowercapActuator::WriteMsrLimits(int package_id, RaplDomain domain,
+                                      const RaplLimits& limits) {
+  std::string path = MsrPath(package_id);
+  uint32_t address = domain == RaplDomain::kPackage ? kMsrPkgPowerLimit : kMsrDramPowerLimit;
+  uint64_t units_raw = 0;
+  uint64_t raw = 0;
+  if (!ReadMsr(path, kMsrRaplPowerUnit, &units_raw) || !ReadMsr(path, address, &raw)) {
+    return false;
+  }
+
+  RaplUnits units = DecodeUnits(units_raw);
+  raw = (raw & ~0xFFFFFFULL) | EncodeLimit(limits.long_term, units);
+  if (domain == RaplDomain::kPackage && limits.has_short_term) {
+    raw = (raw & ~(0xFFFFFFULL << 32)) | (EncodeLimit(limits.short_term, units) << 32);
+  }
+  return WriteMsr(path, address, raw);
+}
+
+// ============================================================================
+// RaplEnergyMeter
+// ============================================================================
+
+RaplEnergyMeter::RaplEnergyMeter(const std::string& powercap_root, const std::string& msr_root,
+                                 const std::vector<int>& package_msr_cpu, RaplDomain domain)
+    : rapl_(powercap_root, msr_root, package_msr_cpu), domain_(domain) {
+  for (int package : rapl_.Packages()) {
+    Counter counter = {package, 0.0, 0.0, 0.0};
+    if (rapl_.ReadEnergy(package, domain_, &counter.last, &counter.range)) {
+      counters_.push_back(counter);
+    }
+  }
+}
+
+void RaplEnergyMeter::Start() {
+  for (auto& counter : counters_) {
+    double range = 0.0;
+    rapl_.ReadEnergy(counter.package_id, domain_, &counter.last, &range);
+    counter.total = 0.0;
+  }
+}
+
+double RaplEnergyMeter::Sample() {
+  if (counters_.empty()) {
+    return NAN;
+  }
+
+  double joules = 0.0;
+  for (auto& counter : counters_) {
+    double current = 0.0;
+    double range = 0.0;
+    if (rapl_.ReadEnergy(counter.package_id, domain_, &current, &range)) {
+      double delta = current - counter.last;
+      if (delta < 0.0) {
+        delta += counter.range;   // Переполнение счётчика
+      }
+      counter.total += delta;
+      counter.last = current;
+    }
+    joules += counter.total;
+  }
+  return joules;
+}
+
+}  // namespace hardware_analysis
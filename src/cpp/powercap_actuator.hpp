@@ -0,0 +1,183 @@
+#ifndef POWERCAP_ACTUATOR_HPP
+#define POWERCAP_ACTUATOR_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Домен RAPL
+ */
+enum class RaplDomain {
+  kPackage,
+  kDram,
+};
+
+/**
+ * @brief Одно ограничение мощности (PL1 или PL2)
+ */
+struct PowerLimit {
+  double watts = 0.0;
+  double time_window_seconds = 0.0;
+  bool enabled = false;
+};
+
+/**
+ * @brief Ограничения домена: PL1 (long term) и PL2 (short term, только пакет)
+ */
+struct RaplLimits {
+  PowerLimit long_term;
+  PowerLimit short_term;
+  bool has_short_term = false;
+  bool locked = false;          // Бит блокировки MSR: запись невозможна до сброса
+};
+
+/**
+ * @brief Аппаратное ограничение мощности через RAPL
+ *
+ * Основной путь - /sys/class/powercap/intel-rapl:N (package-N) и его
+ * подзона dram: constraint_*_power_limit_uw / constraint_*_time_window_us.
+ * Если зоны пакета нет (драйвер не загружен), используется
+ * MSR_PKG_POWER_LIMIT (0x610) / MSR_DRAM_POWER_LIMIT (0x618) первого CPU
+ * пакета в единицах MSR_RAPL_POWER_UNIT (0x606).
+ *
+ * Каждая запись перечитывается: если прошивка обрезала или проигнорировала
+ * значение, SetLimits() возвращает false. Исходные ограничения домена
+ * запоминаются при первой записи и возвращаются RestoreAll().
+ */
+class PowercapActuator {
+ public:
+  /**
+   * @brief Конструктор (поиск зон powercap)
+   * @param powercap_root Корень powercap (для тестов - фейковое дерево)
+   * @param msr_root Каталог устройств msr
+   * @param package_msr_cpu CPU для MSR доступа к пакету (индекс - package_id)
+   */
+  PowercapActuator(const std::string& powercap_root = "/sys/class/powercap",
+                   const std::string& msr_root = "/dev/cpu",
+                   const std::vector<int>& package_msr_cpu = {0});
+
+  /**
+   * @brief Доступен ли домен пакета (через powercap или MSR)
+   */
+  bool IsAvailable(int package_id, RaplDomain domain) const;
+
+  /**
+   * @brief "powercap", "msr" или "none"
+   */
+  const char* Backend(int package_id, RaplDomain domain) const;
+
+  /**
+   * @brief Текущие ограничения домена
+   * @return false если домен недоступен
+   */
+  bool ReadLimits(int package_id, RaplDomain domain, RaplLimits* limits) const;
+
+  /**
+   * @brief Запись ограничений с проверкой чтением
+   * @param limits PL1/PL2 (short_term используется при has_short_term)
+   * @return true если перечитанные значения совпали с записанными с точностью до дискрета
+   */
+  bool SetLimits(int package_id, RaplDomain domain, const RaplLimits& limits);
+
+  /**
+   * @brief Включение PL1 пакета = watts (PL2 не меняется)
+   * @param package_id ID пакета
+   * @param watts Бюджет мощности
+   * @param time_window_seconds Окно усреднения PL1
+   * @return true если ограничение установлено и подтверждено
+   */
+  bool EnforcePowerLimit(int package_id, double watts, double time_window_seconds = 1.0);
+
+  /**
+   * @brief Возврат исходных ограничений всех изменённых доменов
+   * @return true если все восстановлены
+   */
+  bool RestoreAll();
+
+  /**
+   * @brief ID пакетов с доступным доменом пакета
+   */
+  std::vector<int> Packages() const;
+
+  /**
+   * @brief Счётчик энергии домена (energy_uj или MSR_*_ENERGY_STATUS)
+   * @param joules [out] Текущее значение счётчика
+   * @param range_joules [out] Значение, после которого счётчик переполняется
+   * @return false если счётчик недоступен
+   */
+  bool ReadEnergy(int package_id, RaplDomain domain, double* joules, double* range_joules) const;
+
+ private:
+  struct Zone {
+    std::string path;
+    int long_term_constraint = -1;
+    int short_term_constraint = -1;
+  };
+
+  using DomainKey = std::pair<int, RaplDomain>;
+
+  bool ReadZone(const Zone& zone, RaplLimits* limits) const;
+  bool WriteZone(const Zone& zone, const RaplLimits& limits);
+  bool ReadMsrLimits(int package_id, RaplDomain domain, RaplLimits* limits) const;
+  bool WriteMsrLimits(int package_id, RaplDomain domain, const RaplLimits& limits);
+  std::string MsrPath(int package_id) const;
+  int MsrCpu(int package_id) const;
+
+  std::string msr_root_;
+  std::vector<int> package_msr_cpu_;
+  std::map<DomainKey, Zone> zones_;
+  std::map<DomainKey, RaplLimits> original_;         // Исходные значения зон powercap
+  std::map<DomainKey, uint64_t> original_msr_;       // Исходные регистры (восстановление бит-в-бит)
+};
+
+/**
+ * @brief Энергия пакетов за интервал по счётчикам RAPL
+ *
+ * Счётчики 32-битные и переполняются за минуты под нагрузкой, поэтому
+ * Sample() нужно вызывать чаще периода переполнения: каждое переполнение
+ * между соседними вызовами учитывается один раз.
+ */
+class RaplEnergyMeter {
+ public:
+  RaplEnergyMeter(const std::string& powercap_root = "/sys/class/powercap",
+                  const std::string& msr_root = "/dev/cpu",
+                  const std::vector<int>& package_msr_cpu = {0},
+                  RaplDomain domain = RaplDomain::kPackage);
+
+  /**
+   * @brief Есть ли хотя бы один счётчик
+   */
+  bool IsAvailable() const { return !counters_.empty(); }
+
+  /**
+   * @brief Начало интервала
+   */
+  void Start();
+
+  /**
+   * @brief Энергия всех пакетов с Start()
+   * @return Джоули или NaN если счётчики недоступны
+   */
+  double Sample();
+
+ private:
+  struct Counter {
+    int package_id;
+    double last;
+    double range;
+    double total;
+  };
+
+  PowercapActuator rapl_;
+  RaplDomain domain_;
+  std::vector<Counter> counters_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // POWERCAP_ACTUATOR_HPP
@@ -0,0 +1,178 @@
+#ifndef PREFETCH_LOOPS_HPP
+#define PREFETCH_LOOPS_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Шаблон доступа цикла
+ */
+enum class AccessPattern {
+  kSequential = 0,   // data[i]
+  kStrided,          // data[i * stride]
+  kIndirect,         // data[index[i]]
+  kCount
+};
+
+inline const char* AccessPatternName(AccessPattern pattern) {
+  switch (pattern) {
+    case AccessPattern::kSequential:
+      return "sequential";
+    case AccessPattern::kStrided:
+      return "strided";
+    case AccessPattern::kIndirect:
+      return "indirect";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * @brief Параметры программной предвыборки цикла
+ *
+ * distance - на сколько итераций цикла вперёд выбирать (0 - без предвыборки);
+ * hint - уровень как в OptimizationEngine::Prefetch (0=L1, 1=L2, 2=L3, 3=не кэшировать).
+ */
+struct PrefetchSetting {
+  size_t distance = 0;
+  int hint = 0;
+
+  bool Enabled() const { return distance > 0; }
+};
+
+namespace prefetch {
+
+constexpr size_t kCacheLineBytes = 64;
+
+/**
+ * @brief __builtin_prefetch с уровнем, известным при компиляции
+ */
+template <int Hint>
+inline void Touch(const void* ptr) {
+  __builtin_prefetch(ptr, 0, 3 - Hint);
+}
+
+template <int Hint, typename T, typename Body>
+void SequentialLoop(T* data, size_t size, size_t distance, Body& body) {
+  // Одна предвыборка на кэш-линию, а не на элемент
+  constexpr size_t kLine = std::max<size_t>(1, kCacheLineBytes / sizeof(T));
+  size_t i = 0;
+  if (distance > 0 && size > distance) {
+    size_t end = size - distance;
+    for (; i < end; i += kLine) {
+      Touch<Hint>(data + i + distance);
+      size_t stop = std::min(i + kLine, size);
+      for (size_t j = i; j < stop; ++j) {
+        body(data[j]);
+      }
+    }
+  }
+  for (; i < size; ++i) {
+    body(data[i]);
+  }
+}
+
+template <int Hint, typename T, typename Body>
+void StridedLoop(T* data, size_t count, size_t stride, size_t distance, Body& body) {
+  size_t k = 0;
+  if (distance > 0 && count > distance) {
+    for (size_t end = count - distance; k < end; ++k) {
+      Touch<Hint>(data + (k + distance) * stride);
+      body(data[k * stride]);
+    }
+  }
+  for (; k < count; ++k) {
+    body(data[k * stride]);
+  }
+}
+
+template <int Hint, typename T, typename Index, typename Body>
+void IndirectLoop(T* data, const Index* indices, size_t count, size_t distance, Body& body) {
+  size_t k = 0;
+  if (distance > 0 && count > distance) {
+    for (size_t end = count - distance; k < end; ++k) {
+      Touch<Hint>(data + indices[k + distance]);
+      body(data[indices[k]]);
+    }
+  }
+  for (; k < count; ++k) {
+    body(data[indices[k]]);
+  }
+}
+
+}  // namespace prefetch
+
+// ============================================================================
+// Циклы с настраиваемой предвыборкой
+// ============================================================================
+
+/**
+ * @brief body(data[i]) для i в [0, size) с предвыборкой data[i + distance]
+ */
+template <typename T, typename Body>
+void ForEachSequential(T* data, size_t size, const PrefetchSetting& setting, Body body) {
+  switch (setting.hint) {
+    case 0:
+      prefetch::SequentialLoop<0>(data, size, setting.distance, body);
+      break;
+    case 1:
+      prefetch::SequentialLoop<1>(data, size, setting.distance, body);
+      break;
+    case 2:
+      prefetch::SequentialLoop<2>(data, size, setting.distance, body);
+      break;
+    default:
+      prefetch::SequentialLoop<3>(data, size, setting.distance, body);
+      break;
+  }
+}
+
+/**
+ * @brief body(data[k * stride]) для k в [0, count)
+ */
+template <typename T, typename Body>
+void ForEachStrided(T* data, size_t count, size_t stride, const PrefetchSetting& setting,
+                    Body body) {
+  switch (setting.hint) {
+    case 0:
+      prefetch::StridedLoop<0>(data, count, stride, setting.distance, body);
+      break;
+    case 1:
+      prefetch::StridedLoop<1>(data, count, stride, setting.distance, body);
+      break;
+    case 2:
+      prefetch::StridedLoop<2>(data, count, stride, setting.distance, body);
+      break;
+    default:
+      prefetch::StridedLoop<3>(data, count, stride, setting.distance, body);
+      break;
+  }
+}
+
+/**
+ * @brief body(data[indices[k]]) для k в [0, count)
+ */
+template <typename T, typename Index, typename Body>
+void ForEachIndirect(T* data, const Index* indices, size_t count, const PrefetchSetting& setting,
+                     Body body) {
+  switch (setting.hint) {
+    case 0:
+      prefetch::IndirectLoop<0>(data, indices, count, setting.distance, body);
+      break;
+    case 1:
+      prefetch::IndirectLoop<1>(data, indices, count, setting.distance, body);
+      break;
+    case 2:
+      prefetch::IndirectLoop<2>(data, indices, count, setting.distance, body);
+      break;
+    default:
+      prefetch::IndirectLoop<3>(data, indices, count, setting.distance, body);
+      break;
+  }
+}
+
+}  // namespace hardware_analysis
+
+#endif  // PREFETCH_LOOPS_HPP
@@ -0,0 +1,184 @@
+#include "prefetch_tuner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+// Предвыборка ProcessArrayWithPrefetch до автонастройки: 8 int, 32 байта вперёд
+constexpr size_t kLegacyLookaheadBytes = 8 * sizeof(int);
+
+std::string ProfileKey(const std::string& kernel, AccessPattern pattern) {
+  return "prefetch." + kernel + "." + AccessPatternName(pattern);
+}
+
+}  // namespace
+
+PrefetchTuner::PrefetchTuner(const PrefetchTunerConfig& config) : config_(config) {
+  if (config_.repetitions == 0) {
+    config_.repetitions = 1;
+  }
+}
+
+std::vector<size_t> PrefetchTuner::DefaultDistances(AccessPattern pattern, size_t element_bytes) {
+  switch (pattern) {
+    case AccessPattern::kSequential: {
+      // 1..128 кэш-линий вперёд
+      std::vector<size_t> distances;
+      size_t per_line = std::max<size_t>(1, prefetch::kCacheLineBytes / element_bytes);
+      for (size_t lines = 1; lines <= 128; lines *= 2) {
+        distances.push_back(lines * per_line);
+      }
+      return distances;
+    }
+    case AccessPattern::kStrided:
+    case AccessPattern::kIndirect:
+    default:
+      // Каждая итерация - отдельная линия: хватает десятков промахов в полёте
+      return {1, 2, 4, 8, 16, 32, 64};
+  }
+}
+
+PrefetchSetting PrefetchTuner::DefaultSetting(AccessPattern pattern, size_t element_bytes) {
+  PrefetchSetting setting;
+  if (pattern == AccessPattern::kSequential) {
+    // 16 линий (1 КБ) - типичная граница пользы для потоковых циклов
+    setting.distance = 16 * std::max<size_t>(1, prefetch::kCacheLineBytes / element_bytes);
+  } else {
+    setting.distance = 16;
+  }
+  return setting;
+}
+
+PrefetchTuneResult PrefetchTuner::Tune(const std::string& kernel, AccessPattern pattern,
+                                       size_t element_bytes, const PrefetchKernel& run) const {
+  if (element_bytes == 0) {
+    throw std::invalid_argument("Prefetch tuning needs a non-zero element size");
+  }
+  auto measure = [&](const PrefetchSetting& setting) {
+    run(setting);   // Прогрев страниц и TLB
+    double best_seconds = std::numeric_limits<double>::infinity();
+    double bytes = 0.0;
+    for (size_t r = 0; r < config_.repetitions; ++r) {
+      auto started = std::chrono::steady_clock::now();
+      bytes = run(setting);
+      double seconds =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+      best_seconds = std::min(best_seconds, seconds);
+    }
+    return best_seconds > 0.0 ? bytes / best_seconds / 1e9 : 0.0;
+  };
+
+  PrefetchTuneResult result;
+  result.kernel = kernel;
+  result.pattern = pattern;
+  result.no_prefetch_gbs = measure(PrefetchSetting());
+  result.before_gbs = measure({std::max<size_t>(1, kLegacyLookaheadBytes / element_bytes), 0});
+
+  std::vector<size_t> distances = config_.distances;
+  if (distances.empty()) {
+    distances = DefaultDistances(pattern, element_bytes);
+  }
+
+  PrefetchCandidateResult best = {PrefetchSetting(), result.no_prefetch_gbs};
+  for (size_t distance : distances) {
+    for (int hint : config_.hints) {
+      PrefetchSetting setting = {distance, hint};
+      double gbs = measure(setting);
+      result.candidates.push_back({setting, gbs});
+      if (gbs > best.gbs) {
+        best = {setting, gbs};
+      }
+    }
+  }
+
+  // Предвыборка занимает слоты запросов: без заметного выигрыша отключаем
+  if (best.setting.Enabled() && best.gbs < result.no_prefetch_gbs * (1.0 + config_.min_gain)) {
+    best = {PrefetchSetting(), result.no_prefetch_gbs};
+  }
+  result.best = best.setting;
+  result.tuned_gbs = best.gbs;
+  return result;
+}
+
+PrefetchTuneResult PrefetchTuner::TuneScale(AccessPattern pattern) const {
+  // Тело ядра движка над беззнаковыми элементами: сотни проходов по одному
+  // массиву переполняют int, а переполнение uint32_t определено
+  size_t size = std::max<size_t>(1, config_.array_bytes / sizeof(uint32_t));
+  std::vector<uint32_t> data(size, 1);
+  auto scale = [](uint32_t& x) { x = x * 2 + 1; };
+
+  PrefetchKernel run;
+  switch (pattern) {
+    case AccessPattern::kSequential:
+      run = [&](const PrefetchSetting& setting) {
+        ForEachSequential(data.data(), size, setting, scale);
+        return 2.0 * sizeof(uint32_t) * size;
+      };
+      break;
+
+    case AccessPattern::kStrided: {
+      // Все линии массива в порядке шага: те же байты, что и последовательно
+      size_t stride = std::max<size_t>(1, config_.stride_bytes / sizeof(uint32_t));
+      size_t line = prefetch::kCacheLineBytes / sizeof(uint32_t);
+      run = [&, stride, line](const PrefetchSetting& setting) {
+        size_t accesses = 0;
+        for (size_t offset = 0; offset < stride && offset < size; offset += line) {
+          size_t count = (size - offset + stride - 1) / stride;
+          ForEachStrided(data.data() + offset, count, stride, setting, scale);
+          accesses += count;
+        }
+        return 2.0 * sizeof(uint32_t) * accesses;
+      };
+      break;
+    }
+
+    case AccessPattern::kIndirect:
+    default: {
+      // Случайные элементы, по одному на линию в среднем
+      size_t count = std::max<size_t>(1, size / (prefetch::kCacheLineBytes / sizeof(uint32_t)));
+      auto indices = std::make_shared<std::vector<uint32_t>>(count);
+      uint64_t state = 88172645463325252ULL;
+      for (auto& index : *indices) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        index = static_cast<uint32_t>(state % size);
+      }
+      run = [&, indices](const PrefetchSetting& setting) {
+        ForEachIndirect(data.data(), indices->data(), indices->size(), setting, scale);
+        return (2.0 * sizeof(uint32_t) + sizeof(uint32_t)) * indices->size();
+      };
+      break;
+    }
+  }
+  return Tune("scale", pattern, sizeof(uint32_t), run);
+}
+
+void PrefetchTuner::StoreInProfile(const PrefetchTuneResult& result, MachineProfile& profile) {
+  std::string key = ProfileKey(result.kernel, result.pattern);
+  profile.Put(key + ".distance", result.best.distance);
+  profile.Put(key + ".hint", result.best.hint);
+  profile.Put(key + ".no_prefetch_gbs", result.no_prefetch_gbs);
+  profile.Put(key + ".before_gbs", result.before_gbs);
+  profile.Put(key + ".tuned_gbs", result.tuned_gbs);
+}
+
+PrefetchSetting PrefetchTuner::Lookup(const MachineProfile& profile, const std::string& kernel,
+                                      AccessPattern pattern, const PrefetchSetting& fallback) {
+  std::string key = ProfileKey(kernel, pattern);
+  if (!profile.Has(key + ".distance")) {
+    return fallback;
+  }
+  PrefetchSetting setting;
+  setting.distance = profile.Get<size_t>(key + ".distance", fallback.distance);
+  setting.hint = std::min(3, std::max(0, profile.Get<int>(key + ".hint", fallback.hint)));
+  return setting;
+}
+
+}  // namespace hardware_analysis
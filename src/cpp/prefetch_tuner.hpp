@@ -0,0 +1,107 @@
+#ifndef PREFETCH_TUNER_HPP
+#define PREFETCH_TUNER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "machine_profile.hpp"
+#include "prefetch_loops.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Пропускная способность одного варианта предвыборки
+ */
+struct PrefetchCandidateResult {
+  PrefetchSetting setting;
+  double gbs;
+};
+
+/**
+ * @brief Итог настройки ядра для шаблона доступа
+ */
+struct PrefetchTuneResult {
+  std::string kernel;
+  AccessPattern pattern;
+  PrefetchSetting best;          // distance = 0 если предвыборка не помогает
+  double no_prefetch_gbs;
+  double before_gbs;             // Прежняя предвыборка: 32 байта (8 int) вперёд в L1
+  double tuned_gbs;
+  std::vector<PrefetchCandidateResult> candidates;
+};
+
+/**
+ * @brief Параметры автонастройки
+ */
+struct PrefetchTunerConfig {
+  size_t array_bytes = 64u << 20;     // Больше LLC: измеряется память, а не кэш
+  size_t stride_bytes = 2112;         // 33 линии: за пределами шага аппаратного prefetcher
+  size_t repetitions = 3;             // Лучший из повторов
+  double min_gain = 0.02;             // Предвыборка включается при выигрыше от 2%
+  std::vector<size_t> distances;      // Пусто - DefaultDistances()
+  std::vector<int> hints = {0, 1, 2, 3};
+};
+
+/**
+ * @brief Ядро для настройки: один проход с заданной предвыборкой
+ * @return Полезные байты, прочитанные и записанные за проход
+ */
+using PrefetchKernel = std::function<double(const PrefetchSetting& setting)>;
+
+/**
+ * @brief Подбор дистанции и уровня предвыборки на текущей машине
+ *
+ * Каждый вариант (distance x hint) прогоняется repetitions раз, берётся
+ * лучшее время. Результаты хранятся в MachineProfile под
+ * prefetch.<ядро>.<шаблон>.{distance,hint,before_gbs,tuned_gbs}; циклы
+ * читают их через Lookup() или OptimizationEngine::LoadPrefetchSettings().
+ */
+class PrefetchTuner {
+ public:
+  explicit PrefetchTuner(const PrefetchTunerConfig& config = {});
+
+  /**
+   * @brief Настройка произвольного ядра
+   * @param element_bytes Размер элемента ядра: переводит кандидатов и прежние
+   *        32 байта вперёд в итерации цикла
+   * @throws std::invalid_argument при element_bytes = 0
+   */
+  PrefetchTuneResult Tune(const std::string& kernel, AccessPattern pattern,
+                          size_t element_bytes, const PrefetchKernel& run) const;
+
+  /**
+   * @brief Настройка встроенного ядра "scale" (x = 2x + 1 по int, как в
+   *        OptimizationEngine::ProcessArrayWithPrefetch)
+   */
+  PrefetchTuneResult TuneScale(AccessPattern pattern) const;
+
+  /**
+   * @brief Кандидаты дистанции в итерациях цикла
+   * @param pattern Шаблон доступа
+   * @param element_bytes Размер элемента (для последовательного доступа)
+   */
+  static std::vector<size_t> DefaultDistances(AccessPattern pattern, size_t element_bytes);
+
+  /**
+   * @brief Значение по умолчанию, если профиля нет
+   */
+  static PrefetchSetting DefaultSetting(AccessPattern pattern, size_t element_bytes);
+
+  static void StoreInProfile(const PrefetchTuneResult& result, MachineProfile& profile);
+
+  /**
+   * @brief Настроенная предвыборка ядра из профиля
+   * @return fallback если ядро не настраивалось
+   */
+  static PrefetchSetting Lookup(const MachineProfile& profile, const std::string& kernel,
+                                AccessPattern pattern, const PrefetchSetting& fallback);
+
+ private:
+  PrefetchTunerConfig config_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // PREFETCH_TUNER_HPP
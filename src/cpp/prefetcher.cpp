@@ -0,0 +1,194 @@
+#include "prefetcher.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+/**
+ * @brief Число после ':' в описании модели (fallback без ':')
+ */
+size_t ParseParameter(const std::string& spec, size_t colon, size_t fallback) {
+  if (colon == std::string::npos) {
+    return fallback;
+  }
+  size_t pos = 0;
+  unsigned long value = 0;
+  try {
+    value = std::stoul(spec.substr(colon + 1), &pos);
+  } catch (const std::logic_error&) {
+    pos = 0;
+  }
+  if (pos == 0 || colon + 1 + pos != spec.size() || value == 0) {
+    throw std::invalid_argument("Invalid prefetcher parameter: " + spec);
+  }
+  return value;
+}
+
+}  // namespace
+
+// ============================================================================
+// NextLinePrefetcher
+// ============================================================================
+
+NextLinePrefetcher::NextLinePrefetcher(size_t degree) : degree_(degree) {}
+
+void NextLinePrefetcher::Observe(uint64_t line, uint32_t /*pc*/, bool trigger,
+                                 std::vector<uint64_t>& candidates) {
+  if (!trigger) {
+    return;
+  }
+  for (size_t i = 1; i <= degree_; ++i) {
+    candidates.push_back(line + i);
+  }
+}
+
+std::unique_ptr<Prefetcher> NextLinePrefetcher::Clone() const {
+  return std::make_unique<NextLinePrefetcher>(*this);
+}
+
+// ============================================================================
+// StridePrefetcher
+// ============================================================================
+
+StridePrefetcher::StridePrefetcher(size_t degree, size_t entries)
+    : degree_(degree), table_(entries) {
+  if (entries == 0) {
+    throw std::invalid_argument("Stride prefetcher needs at least one table entry");
+  }
+}
+
+void StridePrefetcher::Observe(uint64_t line, uint32_t pc, bool /*trigger*/,
+                               std::vector<uint64_t>& candidates) {
+  if (pc == 0) {
+    return;
+  }
+  Entry& entry = table_[pc % table_.size()];
+  if (entry.pc != pc) {
+    entry = Entry{pc, line, 0, 0};
+    return;
+  }
+  int64_t delta = static_cast<int64_t>(line - entry.last_line);
+  if (delta == 0) {
+    return;   // Шаг меньше строки: та же строка ещё раз
+  }
+  entry.last_line = line;
+  if (delta == entry.stride) {
+    entry.confidence = std::min(entry.confidence + 1, kMaxConfidence);
+  } else if (entry.confidence > 0) {
+    --entry.confidence;
+    return;
+  } else {
+    entry.stride = delta;
+    return;
+  }
+  if (entry.confidence < kIssueConfidence) {
+    return;
+  }
+  for (size_t i = 1; i <= degree_; ++i) {
+    candidates.push_back(line + static_cast<uint64_t>(entry.stride * static_cast<int64_t>(i)));
+  }
+}
+
+void StridePrefetcher::Reset() {
+  std::fill(table_.begin(), table_.end(), Entry{});
+}
+
+std::unique_ptr<Prefetcher> StridePrefetcher::Clone() const {
+  return std::make_unique<StridePrefetcher>(*this);
+}
+
+// ============================================================================
+// StreamPrefetcher
+// ============================================================================
+
+StreamPrefetcher::StreamPrefetcher(size_t distance, size_t degree, size_t streams)
+    : distance_(distance), degree_(degree), streams_(streams), clock_(0) {
+  if (distance == 0 || degree == 0 || streams == 0) {
+    throw std::invalid_argument("Stream prefetcher parameters must be positive");
+  }
+}
+
+void StreamPrefetcher::Observe(uint64_t line, uint32_t /*pc*/, bool trigger,
+                               std::vector<uint64_t>& candidates) {
+  if (!trigger) {
+    return;
+  }
+  ++clock_;
+  uint64_t page = line >> kPageLineShift;
+  Stream* stream = nullptr;
+  Stream* oldest = &streams_[0];
+  for (Stream& candidate : streams_) {
+    if (candidate.page == page) {
+      stream = &candidate;
+      break;
+    }
+    if (candidate.last_use < oldest->last_use) {
+      oldest = &candidate;
+    }
+  }
+  if (stream == nullptr) {
+    *oldest = Stream{page, line, line, 0, 0, clock_};
+    return;
+  }
+  stream->last_use = clock_;
+  if (line == stream->last_line) {
+    return;
+  }
+  int direction = line > stream->last_line ? 1 : -1;
+  stream->last_line = line;
+  if (direction != stream->direction) {
+    // Новое направление: указатель заново от текущей строки
+    stream->direction = direction;
+    stream->confidence = 1;
+    stream->next = line;
+    return;
+  }
+  ++stream->confidence;
+
+  // Указатель не отстаёт от обращений и не уходит дальше distance
+  uint64_t step = static_cast<uint64_t>(static_cast<int64_t>(direction));
+  bool behind = direction > 0 ? stream->next <= line : stream->next >= line;
+  if (behind) {
+    stream->next = line + step;
+  }
+  for (size_t issued = 0; issued < degree_; ++issued) {
+    uint64_t ahead = direction > 0 ? stream->next - line : line - stream->next;
+    if (ahead > distance_ || (stream->next >> kPageLineShift) != page) {
+      break;
+    }
+    candidates.push_back(stream->next);
+    stream->next += step;
+  }
+}
+
+void StreamPrefetcher::Reset() {
+  std::fill(streams_.begin(), streams_.end(), Stream{});
+  clock_ = 0;
+}
+
+std::unique_ptr<Prefetcher> StreamPrefetcher::Clone() const {
+  return std::make_unique<StreamPrefetcher>(*this);
+}
+
+// ============================================================================
+// Фабрика
+// ============================================================================
+
+std::unique_ptr<Prefetcher> MakePrefetcher(const std::string& spec) {
+  size_t colon = spec.find(':');
+  std::string name = spec.substr(0, colon);
+  if (name == "next-line") {
+    return std::make_unique<NextLinePrefetcher>(ParseParameter(spec, colon, 1));
+  }
+  if (name == "stride") {
+    return std::make_unique<StridePrefetcher>(ParseParameter(spec, colon, 2));
+  }
+  if (name == "stream") {
+    return std::make_unique<StreamPrefetcher>(ParseParameter(spec, colon, 16));
+  }
+  throw std::invalid_argument("Unknown prefetcher: " + spec);
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,183 @@
+#ifndef PREFETCHER_HPP
+#define PREFETCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Итог одной модели предвыборки (или программных подсказок трассы)
+ *
+ * Точность - доля загруженных строк, к которым потом обратились; покрытие -
+ * доля промахов уровня, которые предвыборка превратила в попадания;
+ * своевременность - доля полезных строк, запрошенных не раньше, чем они
+ * успели бы прийти (CacheHierarchy::SetPrefetchLatency).
+ */
+struct PrefetchStats {
+  uint64_t issued = 0;               // Строки, загруженные предвыборкой
+  uint64_t redundant = 0;            // Кандидаты, уже лежавшие в кэше
+  uint64_t useful = 0;               // Загруженные и затем запрошенные
+  uint64_t late = 0;                 // Из них запрошенные до прихода строки
+  uint64_t useless = 0;              // Вытесненные без обращения
+
+  double Accuracy() const {
+    return issued > 0 ? static_cast<double>(useful) / static_cast<double>(issued) : 0.0;
+  }
+  double Timeliness() const {
+    return useful > 0 ? static_cast<double>(useful - late) / static_cast<double>(useful) : 0.0;
+  }
+  /**
+   * @param misses Оставшиеся промахи уровня, к которому подключена модель
+   */
+  double Coverage(uint64_t misses) const {
+    uint64_t total = useful + misses;
+    return total > 0 ? static_cast<double>(useful) / static_cast<double>(total) : 0.0;
+  }
+};
+
+/**
+ * @brief Интерфейс модели аппаратной предвыборки
+ *
+ * Модель видит обращения, дошедшие до её уровня кэша, и возвращает номера
+ * строк для загрузки. Состояние (таблицы потоков, шагов) хранится внутри,
+ * поэтому на каждый уровень нужен свой экземпляр (см. Clone()).
+ */
+class Prefetcher {
+ public:
+  virtual ~Prefetcher() = default;
+
+  /**
+   * @brief Обращение к строке на уровне модели
+   * @param pc Младшие биты адреса инструкции (0 если неизвестен)
+   * @param trigger Промах или первое обращение к строке, загруженной
+   *        предвыборкой (так поток не обрывается, когда предвыборка успевает)
+   * @param candidates Куда дописать строки для предвыборки
+   */
+  virtual void Observe(uint64_t line, uint32_t pc, bool trigger,
+                       std::vector<uint64_t>& candidates) = 0;
+
+  virtual void Reset() = 0;
+  virtual std::unique_ptr<Prefetcher> Clone() const = 0;
+  virtual const char* Name() const = 0;
+};
+
+// ============================================================================
+// Следующая строка
+// ============================================================================
+
+/**
+ * @brief degree следующих строк после каждого срабатывания
+ */
+class NextLinePrefetcher : public Prefetcher {
+ public:
+  explicit NextLinePrefetcher(size_t degree = 1);
+
+  void Observe(uint64_t line, uint32_t pc, bool trigger,
+               std::vector<uint64_t>& candidates) override;
+  void Reset() override {}
+  std::unique_ptr<Prefetcher> Clone() const override;
+  const char* Name() const override { return "next-line"; }
+
+ private:
+  size_t degree_;
+};
+
+// ============================================================================
+// Шаг по адресу инструкции
+// ============================================================================
+
+/**
+ * @brief Таблица шагов по pc (как IP-prefetcher L1 у Intel)
+ *
+ * Запись таблицы хранит последнюю строку инструкции и шаг между её
+ * обращениями. Совпавший шаг повышает уверенность, не совпавший понижает, и
+ * на нуле запись переучивается. С уверенностью от kIssueConfidence модель
+ * загружает degree строк вперёд по шагу. Учится на всех обращениях, а не
+ * только на промахах; записи без pc пропускает.
+ */
+class StridePrefetcher : public Prefetcher {
+ public:
+  static constexpr int kMaxConfidence = 3;
+  static constexpr int kIssueConfidence = 2;
+
+  /**
+   * @throws std::invalid_argument при пустой таблице
+   */
+  explicit StridePrefetcher(size_t degree = 2, size_t entries = 256);
+
+  void Observe(uint64_t line, uint32_t pc, bool trigger,
+               std::vector<uint64_t>& candidates) override;
+  void Reset() override;
+  std::unique_ptr<Prefetcher> Clone() const override;
+  const char* Name() const override { return "stride"; }
+
+ private:
+  struct Entry {
+    uint32_t pc = 0;
+    uint64_t last_line = 0;
+    int64_t stride = 0;
+    int confidence = 0;
+  };
+
+  size_t degree_;
+  std::vector<Entry> table_;         // Прямое отображение по pc
+};
+
+// ============================================================================
+// Потоки
+// ============================================================================
+
+/**
+ * @brief Потоковая предвыборка в пределах страницы (как streamer L2)
+ *
+ * Поток открывается промахом в странице, а два срабатывания подряд в одном
+ * направлении подтверждают его. Подтверждённый поток держит указатель
+ * впереди обращений и за срабатывание продвигает его не больше чем на
+ * degree строк, не дальше distance от текущей строки и границы страницы.
+ * Потоков не больше streams, вытесняется давно не срабатывавший.
+ */
+class StreamPrefetcher : public Prefetcher {
+ public:
+  static constexpr unsigned kPageLineShift = 6;   // 64 строки - 4 КБ при строке 64 байта
+
+  /**
+   * @throws std::invalid_argument при нулевых параметрах
+   */
+  explicit StreamPrefetcher(size_t distance = 16, size_t degree = 4, size_t streams = 16);
+
+  void Observe(uint64_t line, uint32_t pc, bool trigger,
+               std::vector<uint64_t>& candidates) override;
+  void Reset() override;
+  std::unique_ptr<Prefetcher> Clone() const override;
+  const char* Name() const override { return "stream"; }
+
+ private:
+  struct Stream {
+    uint64_t page = ~0ull;
+    uint64_t last_line = 0;
+    uint64_t next = 0;               // Следующая строка для предвыборки
+    int direction = 0;
+    int confidence = 0;
+    uint64_t last_use = 0;
+  };
+
+  size_t distance_;
+  size_t degree_;
+  std::vector<Stream> streams_;
+  uint64_t clock_;
+};
+
+/**
+ * @brief Создание модели по описанию
+ * @param spec "next-line[:degree]", "stride[:degree]" или "stream[:distance]"
+ * @throws std::invalid_argument для неизвестного имени или неверного числа
+ */
+std::unique_ptr<Prefetcher> MakePrefetcher(const std::string& spec);
+
+}  // namespace hardware_analysis
+
+#endif  // PREFETCHER_HPP
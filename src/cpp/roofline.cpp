@@ -0,0 +1,539 @@
+#include "roofline.hpp"
+#include "benchmark_report.hpp"
+#include "cpu_topology.hpp"
+#include "machine_profile.hpp"
+#include "memory_benchmark.hpp"
+#include "optimization_engine.hpp"
+#include "workload_classifier.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace hardware_analysis {
+
+namespace {
+
+// Независимых цепочек FMA: латентность 4-5 тактов x 2 порта
+constexpr int kChains = 12;
+
+// Приёмник результатов, чтобы компилятор не выбросил циклы
+volatile double g_sink;
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+// ============================================================================
+// FMA-ядра: x = x * a + b сходится к 1, переполнений и денормалов нет
+// ============================================================================
+
+template <typename T>
+T FmaScalar(size_t iterations) {
+  T acc[kChains];
+  for (int c = 0; c < kChains; ++c) {
+    acc[c] = static_cast<T>(1.0 + c * 1e-3);
+  }
+  const T a = static_cast<T>(0.999), b = static_cast<T>(0.001);
+  for (size_t i = 0; i < iterations; ++i) {
+#pragma GCC unroll 12
+    for (int c = 0; c < kChains; ++c) {
+      acc[c] = std::fma(acc[c], a, b);
+    }
+  }
+  T sum = 0;
+  for (int c = 0; c < kChains; ++c) {
+    sum += acc[c];
+  }
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) double FmaAvx2Fp64(size_t iterations) {
+  __m256d acc[kChains];
+  for (int c = 0; c < kChains; ++c) {
+    acc[c] = _mm256_set1_pd(1.0 + c * 1e-3);
+  }
+  const __m256d a = _mm256_set1_pd(0.999), b = _mm256_set1_pd(0.001);
+  for (size_t i = 0; i < iterations; ++i) {
+#pragma GCC unroll 12
+    for (int c = 0; c < kChains; ++c) {
+      acc[c] = _mm256_fmadd_pd(acc[c], a, b);
+    }
+  }
+  for (int c = 1; c < kChains; ++c) {
+    acc[0] = _mm256_add_pd(acc[0], acc[c]);
+  }
+  alignas(32) double lanes[4];
+  _mm256_store_pd(lanes, acc[0]);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx2,fma"))) float FmaAvx2Fp32(size_t iterations) {
+  __m256 acc[kChains];
+  for (int c = 0; c < kChains; ++c) {
+    acc[c] = _mm256_set1_ps(1.0f + c * 1e-3f);
+  }
+  const __m256 a = _mm256_set1_ps(0.999f), b = _mm256_set1_ps(0.001f);
+  for (size_t i = 0; i < iterations; ++i) {
+#pragma GCC unroll 12
+    for (int c = 0; c < kChains; ++c) {
+      acc[c] = _mm256_fmadd_ps(acc[c], a, b);
+    }
+  }
+  for (int c = 1; c < kChains; ++c) {
+    acc[0] = _mm256_add_ps(acc[0], acc[c]);
+  }
+  alignas(32) float lanes[8];
+  _mm256_store_ps(lanes, acc[0]);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+__attribute__((target("avx512f"))) double FmaAvx512Fp64(size_t iterations) {
+  __m512d acc[kChains];
+  for (int c = 0; c < kChains; ++c) {
+    acc[c] = _mm512_set1_pd(1.0 + c * 1e-3);
+  }
+  const __m512d a = _mm512_set1_pd(0.999), b = _mm512_set1_pd(0.001);
+  for (size_t i = 0; i < iterations; ++i) {
+#pragma GCC unroll 12
+    for (int c = 0; c < kChains; ++c) {
+      acc[c] = _mm512_fmadd_pd(acc[c], a, b);
+    }
+  }
+  for (int c = 1; c < kChains; ++c) {
+    acc[0] = _mm512_add_pd(acc[0], acc[c]);
+  }
+  alignas(64) double lanes[8];
+  _mm512_store_pd(lanes, acc[0]);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+__attribute__((target("avx512f"))) float FmaAvx512Fp32(size_t iterations) {
+  __m512 acc[kChains];
+  for (int c = 0; c < kChains; ++c) {
+    acc[c] = _mm512_set1_ps(1.0f + c * 1e-3f);
+  }
+  const __m512 a = _mm512_set1_ps(0.999f), b = _mm512_set1_ps(0.001f);
+  for (size_t i = 0; i < iterations; ++i) {
+#pragma GCC unroll 12
+    for (int c = 0; c < kChains; ++c) {
+      acc[c] = _mm512_fmadd_ps(acc[c], a, b);
+    }
+  }
+  for (int c = 1; c < kChains; ++c) {
+    acc[0] = _mm512_add_ps(acc[0], acc[c]);
+  }
+  alignas(64) float lanes[16];
+  _mm512_store_ps(lanes, acc[0]);
+  float sum = 0.0f;
+  for (float lane : lanes) {
+    sum += lane;
+  }
+  return sum;
+}
+
+/**
+ * @brief Один прогон FMA-ядра
+ * @return Операций с плавающей точкой (FMA = 2)
+ */
+double RunFma(SimdIsa isa, Precision precision, size_t iterations) {
+  const bool fp64 = precision == Precision::kFp64;
+  size_t lanes = 1;
+  switch (isa) {
+    case SimdIsa::kAvx512:
+      lanes = fp64 ? 8 : 16;
+      g_sink = fp64 ? FmaAvx512Fp64(iterations) : FmaAvx512Fp32(iterations);
+      break;
+    case SimdIsa::kAvx2:
+      lanes = fp64 ? 4 : 8;
+      g_sink = fp64 ? FmaAvx2Fp64(iterations) : FmaAvx2Fp32(iterations);
+      break;
+    case SimdIsa::kScalar:
+    default:
+      g_sink = fp64 ? FmaScalar<double>(iterations) : FmaScalar<float>(iterations);
+      break;
+  }
+  return 2.0 * kChains * lanes * static_cast<double>(iterations);
+}
+
+/**
+ * @brief Лучшее время run() из repetitions после прогрева
+ */
+double BestSeconds(size_t repetitions, const std::function<void()>& run) {
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t rep = 0; rep < repetitions; ++rep) {
+    auto begin = Clock::now();
+    run();
+    best = std::min(best, Seconds(begin, Clock::now()));
+  }
+  return best;
+}
+
+}  // namespace
+
+const char* SimdIsaName(SimdIsa isa) {
+  switch (isa) {
+    case SimdIsa::kAvx2:
+      return "avx2";
+    case SimdIsa::kAvx512:
+      return "avx512";
+    case SimdIsa::kScalar:
+    default:
+      return "scalar";
+  }
+}
+
+SimdIsa BestSimdIsa() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return SimdIsa::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return SimdIsa::kAvx2;
+  }
+  return SimdIsa::kScalar;
+}
+
+const char* PrecisionName(Precision precision) {
+  return precision == Precision::kFp32 ? "fp32" : "fp64";
+}
+
+const ComputeCeiling* RooflineReport::Compute(Precision precision) const {
+  for (const auto& ceiling : compute) {
+    if (ceiling.precision == precision) {
+      return &ceiling;
+    }
+  }
+  return nullptr;
+}
+
+const BandwidthCeiling* RooflineReport::Bandwidth(const std::string& level) const {
+  for (const auto& ceiling : bandwidth) {
+    if (ceiling.level == level) {
+      return &ceiling;
+    }
+  }
+  return nullptr;
+}
+
+RooflineModel::RooflineModel(const RooflineConfig& config) : config_(config) {
+  if (config_.repetitions == 0) {
+    config_.repetitions = 1;
+  }
+  if (config_.socket_cpus.empty()) {
+    TopologySnapshot topology = TopologySnapshot::Read();
+    const CpuTopologyInfo* info = topology.Find(config_.cpu);
+    config_.socket_cpus = info ? topology.PackageCpus(info->package_id)
+                               : std::vector<int>{config_.cpu};
+  }
+}
+
+// ============================================================================
+// Потолки
+// ============================================================================
+
+ComputeCeiling RooflineModel::MeasureCompute(Precision precision, SimdIsa isa) const {
+  if (isa == SimdIsa::kAvx512 && !__builtin_cpu_supports("avx512f")) {
+    throw std::invalid_argument("AVX-512 is not supported by this CPU");
+  }
+  if (isa == SimdIsa::kAvx2 &&
+      !(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))) {
+    throw std::invalid_argument("AVX2/FMA is not supported by this CPU");
+  }
+  ComputeCeiling ceiling{precision, isa, 0.0, 0.0, config_.socket_cpus.size()};
+
+  // Ядро: число итераций удваивается, пока замер не станет дольше min_seconds
+  size_t iterations = 1u << 12;
+  double flops = 0.0;
+  {
+    ScopedAffinity affinity;
+    affinity.Pin(config_.cpu);
+    for (;;) {
+      auto begin = Clock::now();
+      flops = RunFma(isa, precision, iterations);
+      if (Seconds(begin, Clock::now()) >= config_.min_seconds || iterations >= (1ull << 40)) {
+        break;
+      }
+      iterations *= 2;
+    }
+    double best = BestSeconds(config_.repetitions, [&] { RunFma(isa, precision, iterations); });
+    ceiling.gflops_per_core = flops / best / 1e9;
+  }
+
+  // Пакет: по потоку на CPU, общий старт
+  const size_t threads = config_.socket_cpus.size();
+  double best_socket = std::numeric_limits<double>::infinity();
+  for (size_t rep = 0; rep < config_.repetitions; ++rep) {
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        ScopedAffinity affinity;
+        affinity.Pin(config_.socket_cpus[t]);
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        RunFma(isa, precision, iterations);
+      });
+    }
+    while (ready.load() < threads) {
+      std::this_thread::yield();
+    }
+    auto begin = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    best_socket = std::min(best_socket, Seconds(begin, Clock::now()));
+  }
+  ceiling.gflops_per_socket = flops * threads / best_socket / 1e9;
+  return ceiling;
+}
+
+std::vector<BandwidthCeiling> RooflineModel::MeasureBandwidth(const CacheTopology& caches) const {
+  MemoryBenchConfig memory;
+  memory.cpu = config_.cpu;
+  memory.cpus = config_.socket_cpus;
+  memory.repetitions = config_.repetitions;
+  // Кэши читаются многократно: объём замера сглаживает накладные расходы
+  memory.bandwidth_bytes = config_.bandwidth_bytes;
+  MemoryBenchmark benchmark(memory);
+
+  std::vector<BandwidthCeiling> ceilings;
+  const int last_level = caches.LastLevel();
+  for (int level = 1; level <= last_level; ++level) {
+    size_t working_set = caches.DataCacheBytes(level) / 2;
+    if (working_set == 0) {
+      continue;
+    }
+    ceilings.push_back({"L" + std::to_string(level), working_set,
+                        benchmark.ReadBandwidth(working_set), 0.0});
+  }
+
+  size_t llc = last_level > 0 ? caches.DataCacheBytes(last_level) : 0;
+  size_t dram_set = config_.dram_working_set > 0 ? config_.dram_working_set
+                                                 : std::max<size_t>(64u << 20, 4 * llc);
+  BandwidthCeiling dram{"DRAM", dram_set, benchmark.ReadBandwidth(dram_set), 0.0};
+
+  // Пакет: read по потоку на CPU, наборы потоков вместе дают рабочий набор DRAM
+  MemoryBenchConfig socket = memory;
+  socket.bandwidth_bytes = std::max(dram_set / socket.cpus.size(), size_t{4096});
+  socket.bandwidth_passes = config_.repetitions;
+  for (const auto& result : MemoryBenchmark(socket).Bandwidth()) {
+    if (result.kind == "read") {
+      dram.gbs_per_socket = result.gbs;
+    }
+  }
+  ceilings.push_back(dram);
+  return ceilings;
+}
+
+// ============================================================================
+// Ядра
+// ============================================================================
+
+KernelPoint RooflineModel::MeasureKernel(const std::string& name, Precision precision,
+                                         size_t threads, double flops, double model_bytes,
+                                         const std::function<void()>& run) const {
+  KernelPoint point{};
+  point.name = name;
+  point.precision = precision;
+  point.threads = std::max<size_t>(1, threads);
+  point.flops = flops;
+  point.bytes = model_bytes;
+  point.bytes_source = "model";
+
+  // Однопоточное ядро считается на своём CPU: промахи LLC этого потока - его трафик
+  ScopedAffinity affinity;
+  std::unique_ptr<PerfEventCounterSource> perf;
+  if (point.threads == 1) {
+    affinity.Pin(config_.cpu);
+    try {
+      perf = std::make_unique<PerfEventCounterSource>(std::vector<int>{config_.cpu}, 0);
+    } catch (const std::exception&) {
+      // Без perf - модель обязательного трафика
+    }
+  }
+
+  run();
+  // Sample пишет только в элементы с индексом CPU - вектор должен его покрывать
+  std::vector<PhaseFeatures> features;
+  features.assign(static_cast<size_t>(config_.cpu) + 1, PhaseFeatures::Unknown());
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t rep = 0; rep < config_.repetitions; ++rep) {
+    if (perf) {
+      perf->Sample(features);
+    }
+    auto begin = Clock::now();
+    run();
+    double seconds = Seconds(begin, Clock::now());
+    if (perf && perf->Sample(features) && static_cast<size_t>(config_.cpu) < features.size()) {
+      const PhaseFeatures& f = features[config_.cpu];
+      if (std::isfinite(f.llc_mpki) && std::isfinite(f.instructions_per_second) &&
+          seconds < best) {
+        double misses = f.llc_mpki / 1000.0 * f.instructions_per_second * seconds;
+        point.bytes = misses * CacheLineSize();
+        point.bytes_source = "perf";
+      }
+    }
+    best = std::min(best, seconds);
+  }
+
+  point.seconds = best;
+  // Ни одного промаха: не меньше одной линии, чтобы интенсивность была конечной
+  point.intensity = flops / std::max<double>(point.bytes, CacheLineSize());
+  point.gflops = best > 0.0 ? flops / best / 1e9 : 0.0;
+  return point;
+}
+
+std::vector<KernelPoint> RooflineModel::MeasureEngineKernels(OptimizationEngine& engine) const {
+  std::vector<KernelPoint> points;
+
+  // GEMM: обязательный трафик - чтение A и B, чтение и запись C
+  const size_t n = std::max<size_t>(config_.gemm_n, 8);
+  std::vector<double> a(n * n, 1.0), b(n * n, 0.5), c(n * n, 0.0);
+  points.push_back(MeasureKernel("gemm", Precision::kFp64, 1, 2.0 * n * n * n,
+                                 4.0 * n * n * sizeof(double), [&] {
+                                   engine.MatrixMultiply_AVX2(a.data(), b.data(), c.data(), n, n,
+                                                              n);
+                                 }));
+  a.clear();
+  a.shrink_to_fit();
+  b.clear();
+  b.shrink_to_fit();
+  c.clear();
+  c.shrink_to_fit();
+
+  // Редукции: одно сложение на 8 байт
+  const size_t count = std::max<size_t>(config_.reduce_bytes / sizeof(double), 1);
+  std::vector<double> data(count, 1.0);
+  double sum = 0.0;
+  points.push_back(MeasureKernel("reduction", Precision::kFp64, 1, count, count * sizeof(double),
+                                 [&] { sum += engine.VectorizedSum_AVX2(data.data(), count); }));
+  points.push_back(MeasureKernel("parallel_reduction", Precision::kFp64,
+                                 engine.GetReductionParallelism().threads, count,
+                                 count * sizeof(double),
+                                 [&] { sum += engine.ParallelSum(data.data(), count); }));
+  g_sink = sum;
+  data.clear();
+  data.shrink_to_fit();
+
+  // Цикл с предвыборкой: x = 2x + 1 по int - две 32-битные операции на
+  // элемент, сравниваются с потолком FP32 той же ширины вектора
+  const size_t elements = std::max<size_t>(config_.stream_bytes / sizeof(int), 1);
+  std::vector<int> stream(elements, 1);
+  points.push_back(MeasureKernel("prefetch_scale", Precision::kFp32, 1, 2.0 * elements,
+                                 2.0 * elements * sizeof(int), [&] {
+                                   engine.ProcessArrayWithPrefetch(stream.data(), elements);
+                                 }));
+  return points;
+}
+
+RooflineReport RooflineModel::Run(OptimizationEngine& engine, const CacheTopology& caches) const {
+  RooflineReport report;
+  report.cpu_model = MachineProfile::DetectCpuModel();
+  report.cache_signature = caches.Signature();
+  report.compute.push_back(MeasureCompute(Precision::kFp64));
+  report.compute.push_back(MeasureCompute(Precision::kFp32));
+  report.bandwidth = MeasureBandwidth(caches);
+  report.kernels = MeasureEngineKernels(engine);
+  for (auto& point : report.kernels) {
+    Place(point, report);
+  }
+  return report;
+}
+
+// ============================================================================
+// Размещение и вывод
+// ============================================================================
+
+double RooflineModel::Attainable(double peak_gflops, double bandwidth_gbs, double intensity) {
+  double memory = bandwidth_gbs * intensity;
+  if (peak_gflops <= 0.0) {
+    return memory;
+  }
+  if (bandwidth_gbs <= 0.0) {
+    return peak_gflops;
+  }
+  return std::min(peak_gflops, memory);
+}
+
+void RooflineModel::Place(KernelPoint& point, const RooflineReport& report) {
+  const bool socket = point.threads > 1;
+  const ComputeCeiling* compute = report.Compute(point.precision);
+  double peak = 0.0;
+  if (compute != nullptr) {
+    peak = socket ? compute->gflops_per_socket : compute->gflops_per_core;
+  }
+  // Частные кэши складываются по потокам; DRAM пакета измерена отдельно
+  auto bandwidth_of = [&](const BandwidthCeiling& ceiling) {
+    if (!socket) {
+      return ceiling.gbs_per_core;
+    }
+    return ceiling.gbs_per_socket > 0.0 ? ceiling.gbs_per_socket
+                                        : ceiling.gbs_per_core * point.threads;
+  };
+
+  const BandwidthCeiling* dram = report.Bandwidth("DRAM");
+  double dram_gbs = dram != nullptr ? bandwidth_of(*dram) : 0.0;
+  point.attainable_gflops = Attainable(peak, dram_gbs, point.intensity);
+  point.bound = dram_gbs > 0.0 && dram_gbs * point.intensity < peak ? "memory" : "compute";
+  point.efficiency = point.attainable_gflops > 0.0 ? point.gflops / point.attainable_gflops : 0.0;
+
+  point.served_from.clear();
+  for (const auto& ceiling : report.bandwidth) {
+    if (Attainable(peak, bandwidth_of(ceiling), point.intensity) >= point.gflops) {
+      point.served_from = ceiling.level;
+    }
+  }
+}
+
+void RooflineModel::WriteJson(std::ostream& out, const RooflineReport& report) {
+  out << "{\n  \"cpu_model\": " << JsonString(report.cpu_model) << ",\n"
+      << "  \"cache_signature\": " << JsonString(report.cache_signature) << ",\n"
+      << "  \"compute\": [";
+  for (size_t i = 0; i < report.compute.size(); ++i) {
+    const ComputeCeiling& ceiling = report.compute[i];
+    out << (i ? "," : "") << "\n    {\"precision\": " << JsonString(PrecisionName(ceiling.precision))
+        << ", \"isa\": " << JsonString(SimdIsaName(ceiling.isa))
+        << ", \"gflops_per_core\": " << JsonNumber(ceiling.gflops_per_core)
+        << ", \"gflops_per_socket\": " << JsonNumber(ceiling.gflops_per_socket)
+        << ", \"socket_threads\": " << ceiling.socket_threads << "}";
+  }
+  out << (report.compute.empty() ? "" : "\n  ") << "],\n  \"bandwidth\": [";
+  for (size_t i = 0; i < report.bandwidth.size(); ++i) {
+    const BandwidthCeiling& ceiling = report.bandwidth[i];
+    out << (i ? "," : "") << "\n    {\"level\": " << JsonString(ceiling.level)
+        << ", \"working_set_bytes\": " << ceiling.working_set
+        << ", \"gbs_per_core\": " << JsonNumber(ceiling.gbs_per_core)
+        << ", \"gbs_per_socket\": " << JsonNumber(ceiling.gbs_per_socket) << "}";
+  }
+  out << (report.bandwidth.empty() ? "" : "\n  ") << "],\n  \"kernels\": [";
+  for (size_t i = 0; i < report.kernels.size(); ++i) {
+    const KernelPoint& point = report.kernels[i];
+    out << (i ? "," : "") << "\n    {\"name\": " << JsonString(point.name)
+        << ", \"precision\": " << JsonString(PrecisionName(point.precision))
+        << ", \"threads\": " << point.threads << ", \"flops\": " << JsonNumber(point.flops)
+        << ", \"bytes\": " << JsonNumber(point.bytes)
+        << ", \"bytes_source\": " << JsonString(point.bytes_source)
+        << ", \"seconds\": " << JsonNumber(point.seconds)
+        << ", \"intensity\": " << JsonNumber(point.intensity)
+        << ", \"gflops\": " << JsonNumber(point.gflops)
+        << ", \"attainable_gflops\": " << JsonNumber(point.attainable_gflops)
+        << ", \"bound\": " << JsonString(point.bound)
+        << ", \"served_from\": " << JsonString(point.served_from)
+        << ", \"efficiency\": " << JsonNumber(point.efficiency) << "}";
+  }
+  out << (report.kernels.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+}  // namespace hardware_analysis
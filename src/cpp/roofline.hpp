@@ -0,0 +1,171 @@
+#ifndef ROOFLINE_HPP
+#define ROOFLINE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "cache_topology.hpp"
+
+namespace hardware_analysis {
+
+class OptimizationEngine;
+
+/**
+ * @brief Набор инструкций FMA-ядра пиковой производительности
+ */
+enum class SimdIsa {
+  kScalar = 0,
+  kAvx2,       // AVX2 + FMA3
+  kAvx512
+};
+
+const char* SimdIsaName(SimdIsa isa);
+
+/**
+ * @brief Лучший набор, поддерживаемый процессором
+ */
+SimdIsa BestSimdIsa();
+
+enum class Precision {
+  kFp64 = 0,
+  kFp32
+};
+
+const char* PrecisionName(Precision precision);
+
+/**
+ * @brief Пиковая производительность FMA
+ */
+struct ComputeCeiling {
+  Precision precision;
+  SimdIsa isa;
+  double gflops_per_core;
+  double gflops_per_socket;      // Все CPU пакета одновременно
+  size_t socket_threads;
+};
+
+/**
+ * @brief Пропускная способность чтения уровня памяти
+ */
+struct BandwidthCeiling {
+  std::string level;             // "L1", "L2", "L3", "DRAM"
+  size_t working_set;
+  double gbs_per_core;
+  double gbs_per_socket;         // Только DRAM (0 для кэшей)
+};
+
+/**
+ * @brief Ядро, размещённое на roofline
+ */
+struct KernelPoint {
+  std::string name;
+  Precision precision;
+  size_t threads;
+  double flops;                  // Операций за запуск
+  double bytes;                  // Байт из памяти за запуск
+  std::string bytes_source;      // "perf" (промахи LLC) или "model" (обязательный трафик)
+  double seconds;
+  double intensity;              // flops / bytes
+  double gflops;
+  double attainable_gflops;      // min(пик, DRAM * intensity) для своего масштаба
+  std::string bound;             // "memory" или "compute"
+  std::string served_from;       // Самый медленный уровень, чья крыша не ниже gflops
+  double efficiency;             // gflops / attainable_gflops
+};
+
+/**
+ * @brief Параметры измерения
+ */
+struct RooflineConfig {
+  int cpu = 0;                          // CPU однопоточных измерений
+  std::vector<int> socket_cpus;         // Пусто - CPU пакета config.cpu
+  double min_seconds = 0.05;            // Минимальная длительность одного замера
+  size_t repetitions = 3;               // Лучший из повторов
+  size_t bandwidth_bytes = 1u << 30;    // Прочитанных байт на замер пропускной способности
+  size_t dram_working_set = 0;          // 0 - max(64 МБ, 4x LLC)
+  size_t gemm_n = 512;
+  size_t reduce_bytes = 256u << 20;     // Больше LLC: редукция идёт из DRAM
+  size_t stream_bytes = 256u << 20;     // Массив цикла с предвыборкой
+};
+
+/**
+ * @brief Полный отчёт roofline
+ */
+struct RooflineReport {
+  std::string cpu_model;
+  std::string cache_signature;
+  std::vector<ComputeCeiling> compute;
+  std::vector<BandwidthCeiling> bandwidth;
+  std::vector<KernelPoint> kernels;
+
+  const ComputeCeiling* Compute(Precision precision) const;
+  const BandwidthCeiling* Bandwidth(const std::string& level) const;
+};
+
+/**
+ * @brief Измеренная модель roofline
+ *
+ * Вместо вручную заданных пика и пропускной способности (roofline_model в
+ * stage6_ml_prediction.py) измеряет:
+ *  - пик FMA FP64/FP32 на ядро и на пакет: независимые цепочки FMA на
+ *    лучшем доступном наборе (AVX-512, AVX2+FMA, скалярно);
+ *  - пропускную способность чтения L1/L2/L3 (набор в половину уровня) и
+ *    DRAM (набор 4x LLC) на ядро, DRAM также на весь пакет.
+ * Ядра OptimizationEngine (GEMM, редукции, цикл с предвыборкой) измеряются и
+ * ставятся на график: трафик памяти берётся из промахов LLC (perf), а без
+ * perf - по модели обязательного трафика.
+ */
+class RooflineModel {
+ public:
+  explicit RooflineModel(const RooflineConfig& config = {});
+
+  ComputeCeiling MeasureCompute(Precision precision, SimdIsa isa = BestSimdIsa()) const;
+
+  std::vector<BandwidthCeiling> MeasureBandwidth(const CacheTopology& caches) const;
+
+  /**
+   * @brief Измерение произвольного ядра
+   * @param run Один запуск ядра
+   * @param flops Операций за запуск
+   * @param model_bytes Обязательный трафик за запуск (если perf недоступен)
+   * @param threads Потоков ядра: >1 - сравнение с потолками пакета, без perf
+   */
+  KernelPoint MeasureKernel(const std::string& name, Precision precision, size_t threads,
+                            double flops, double model_bytes,
+                            const std::function<void()>& run) const;
+
+  /**
+   * @brief gemm, reduction, parallel_reduction, prefetch_scale
+   */
+  std::vector<KernelPoint> MeasureEngineKernels(OptimizationEngine& engine) const;
+
+  /**
+   * @brief Потолки, ядра движка и размещение ядер
+   */
+  RooflineReport Run(OptimizationEngine& engine, const CacheTopology& caches) const;
+
+  /**
+   * @brief Достижимая производительность: min(peak, bandwidth * intensity)
+   */
+  static double Attainable(double peak_gflops, double bandwidth_gbs, double intensity);
+
+  /**
+   * @brief attainable_gflops, bound, served_from и efficiency точки по потолкам отчёта
+   */
+  static void Place(KernelPoint& point, const RooflineReport& report);
+
+  /**
+   * @brief JSON для stage6_ml_prediction.load_roofline()
+   */
+  static void WriteJson(std::ostream& out, const RooflineReport& report);
+
+ private:
+  RooflineConfig config_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // ROOFLINE_HPP
@@ -0,0 +1,445 @@
+#include "stack_distance.hpp"
+#include "benchmark_report.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr size_t kMinTreeCapacity = 1u << 16;   // Моментов в дереве Фенвика не меньше
+
+}  // namespace
+
+// ============================================================================
+// MissRatioCurve
+// ============================================================================
+
+void MissRatioCurve::Add(uint64_t distance, double weight) {
+  uint64_t bucket = distance / bucket_lines;
+  while (max_buckets > 0 && bucket >= max_buckets) {
+    Coarsen();
+    bucket = distance / bucket_lines;
+  }
+  if (bucket >= histogram.size()) {
+    histogram.resize(static_cast<size_t>(bucket) + 1, 0.0);
+  }
+  histogram[bucket] += weight;
+  accesses += weight;
+}
+
+void MissRatioCurve::Coarsen() {
+  for (size_t b = 0; b < histogram.size(); b += 2) {
+    histogram[b / 2] = histogram[b] + (b + 1 < histogram.size() ? histogram[b + 1] : 0.0);
+  }
+  histogram.resize((histogram.size() + 1) / 2);
+  bucket_lines *= 2;
+}
+
+void MissRatioCurve::Merge(const MissRatioCurve& other) {
+  if (other.line_bytes != line_bytes) {
+    throw std::invalid_argument("Cannot merge miss ratio curves with different line sizes");
+  }
+  MissRatioCurve part = other;
+  while (part.bucket_lines < bucket_lines) {
+    part.Coarsen();
+  }
+  while (bucket_lines < part.bucket_lines) {
+    Coarsen();
+  }
+  if (part.histogram.size() > histogram.size()) {
+    histogram.resize(part.histogram.size(), 0.0);
+  }
+  for (size_t b = 0; b < part.histogram.size(); ++b) {
+    histogram[b] += part.histogram[b];
+  }
+  while (max_buckets > 0 && histogram.size() > max_buckets) {
+    Coarsen();
+  }
+  cold += part.cold;
+  accesses += part.accesses;
+}
+
+double MissRatioCurve::MissRatio(size_t lines) const {
+  return MissRatios({lines}).front();
+}
+
+std::vector<double> MissRatioCurve::MissRatios(const std::vector<size_t>& lines) const {
+  std::vector<double> ratios(lines.size(), 1.0);
+  if (accesses <= 0.0) {
+    return ratios;
+  }
+  std::vector<size_t> order(lines.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return lines[a] < lines[b]; });
+
+  // Попадания кэша на C строк - обращения с расстоянием меньше C: целые
+  // корзины ниже C и доля корзины, в которую C попадает
+  double hits = 0.0;
+  size_t bucket = 0;
+  for (size_t index : order) {
+    size_t full = std::min(lines[index] / bucket_lines, histogram.size());
+    for (; bucket < full; ++bucket) {
+      hits += histogram[bucket];
+    }
+    double partial = 0.0;
+    if (bucket < histogram.size()) {
+      partial = histogram[bucket] * static_cast<double>(lines[index] % bucket_lines) /
+                static_cast<double>(bucket_lines);
+    }
+    ratios[index] = std::min(1.0, std::max(0.0, (accesses - hits - partial) / accesses));
+  }
+  return ratios;
+}
+
+size_t MissRatioCurve::CapacityFor(double target) const {
+  if (accesses <= 0.0) {
+    return 0;
+  }
+  double hits = 0.0;
+  for (size_t b = 0; b < histogram.size(); ++b) {
+    hits += histogram[b];
+    if ((accesses - hits) / accesses <= target) {
+      return (b + 1) * bucket_lines;
+    }
+  }
+  return 0;
+}
+
+std::vector<size_t> MissRatioCurve::LogCapacities(size_t points_per_octave) const {
+  std::vector<size_t> lines;
+  size_t limit = std::max<size_t>(SpanLines(), 1);
+  double step = std::pow(2.0, 1.0 / static_cast<double>(std::max<size_t>(points_per_octave, 1)));
+  for (double capacity = 1.0; capacity < static_cast<double>(limit); capacity *= step) {
+    size_t value = static_cast<size_t>(capacity + 0.5);
+    if (lines.empty() || value > lines.back()) {
+      lines.push_back(value);
+    }
+  }
+  // Последняя точка: ёмкость, на которой остаются только холодные промахи
+  if (lines.empty() || lines.back() < limit) {
+    lines.push_back(limit);
+  }
+  return lines;
+}
+
+void MissRatioCurve::WriteJson(std::ostream& out, const std::vector<size_t>& lines) const {
+  std::vector<double> ratios = MissRatios(lines);
+  out << "{\n  \"line_bytes\": " << line_bytes << ",\n"
+      << "  \"accesses\": " << JsonNumber(accesses) << ",\n"
+      << "  \"cold_misses\": " << JsonNumber(cold) << ",\n"
+      << "  \"points\": [";
+  for (size_t i = 0; i < lines.size(); ++i) {
+    out << (i ? "," : "") << "\n    {\"lines\": " << lines[i]
+        << ", \"bytes\": " << lines[i] * line_bytes
+        << ", \"miss_ratio\": " << JsonNumber(ratios[i]) << "}";
+  }
+  out << (lines.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+// ============================================================================
+// StackDistanceAnalyzer
+// ============================================================================
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(size_t line_bytes, size_t shard, size_t shards)
+    : line_shift_(0), shard_(shard), shards_(shards), now_(0) {
+  if (line_bytes == 0 || (line_bytes & (line_bytes - 1)) != 0) {
+    throw std::invalid_argument("Line size must be a power of two");
+  }
+  if (shards == 0 || shard >= shards) {
+    throw std::invalid_argument("Shard index must be below the shard count");
+  }
+  line_shift_ = static_cast<unsigned>(__builtin_ctzll(line_bytes));
+  curve_.line_bytes = line_bytes;
+  tree_.assign(kMinTreeCapacity + 1, 0);
+}
+
+void StackDistanceAnalyzer::AccessLine(uint64_t line) {
+  if (shards_ > 1 && HashLine(line) % shards_ != shard_) {
+    return;
+  }
+  Record(line);
+}
+
+void StackDistanceAnalyzer::Record(uint64_t line) {
+  uint64_t distance = 0;
+  if (Touch(line, &distance)) {
+    curve_.Add(distance * shards_);
+  } else {
+    curve_.cold += 1.0;
+    curve_.accesses += 1.0;
+  }
+}
+
+bool StackDistanceAnalyzer::Touch(uint64_t line, uint64_t* distance) {
+  if (now_ + 1 >= tree_.size()) {
+    Compact();
+  }
+  auto found = last_access_.find(line);
+  bool reused = found != last_access_.end();
+  if (reused) {
+    uint64_t previous = found->second;
+    // Различные строки между обращениями - последние обращения в (previous, now)
+    *distance = Prefix(now_) - Prefix(previous + 1);
+    Update(previous, -1);
+    found->second = now_;
+  } else {
+    last_access_.emplace(line, now_);
+  }
+  Update(now_, 1);
+  ++now_;
+  return reused;
+}
+
+void StackDistanceAnalyzer::Forget(uint64_t line) {
+  auto found = last_access_.find(line);
+  if (found != last_access_.end()) {
+    Update(found->second, -1);
+    last_access_.erase(found);
+  }
+}
+
+uint64_t StackDistanceAnalyzer::Prefix(uint64_t end) const {
+  uint64_t sum = 0;
+  for (uint64_t i = end; i > 0; i -= i & (~i + 1)) {
+    sum += tree_[i];
+  }
+  return sum;
+}
+
+void StackDistanceAnalyzer::Update(uint64_t time, int32_t delta) {
+  const uint64_t capacity = tree_.size() - 1;
+  for (uint64_t i = time + 1; i <= capacity; i += i & (~i + 1)) {
+    tree_[i] += static_cast<uint32_t>(delta);
+  }
+}
+
+void StackDistanceAnalyzer::Compact() {
+  std::vector<std::pair<uint64_t, uint64_t>> live;   // (момент, строка)
+  live.reserve(last_access_.size());
+  for (const auto& entry : last_access_) {
+    live.emplace_back(entry.second, entry.first);
+  }
+  std::sort(live.begin(), live.end());
+
+  size_t capacity = std::max(kMinTreeCapacity, 2 * live.size());
+  tree_.assign(capacity + 1, 0);
+  for (size_t time = 0; time < live.size(); ++time) {
+    last_access_[live[time].second] = time;
+    tree_[time + 1] = 1;
+  }
+  // Построение дерева Фенвика за O(n) из массива отметок
+  for (size_t i = 1; i <= capacity; ++i) {
+    size_t parent = i + (i & (~i + 1));
+    if (parent <= capacity) {
+      tree_[parent] += tree_[i];
+    }
+  }
+  now_ = live.size();
+}
+
+void StackDistanceAnalyzer::Simulate(const TraceRecord* records, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (records[i].type == static_cast<uint8_t>(AccessType::kPrefetch)) {
+      continue;
+    }
+    uint64_t first = records[i].address >> line_shift_;
+    uint64_t last = records[i].size > 1
+                        ? (records[i].address + records[i].size - 1) >> line_shift_
+                        : first;
+    for (uint64_t line = first; line <= last; ++line) {
+      AccessLine(line);
+    }
+  }
+}
+
+MissRatioCurve StackDistanceAnalyzer::Analyze(const TraceRecord* records, size_t count,
+                                              size_t line_bytes, size_t shards,
+                                              size_t threads) {
+  if (shards == 0) {
+    throw std::invalid_argument("Shard count must be positive");
+  }
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min(threads, shards);
+
+  // Поток считает шарды t, t + threads, ...: в памяти одна таблица на поток
+  std::vector<MissRatioCurve> partial(threads);
+  auto work = [&](size_t thread) {
+    partial[thread].line_bytes = line_bytes;
+    for (size_t shard = thread; shard < shards; shard += threads) {
+      StackDistanceAnalyzer analyzer(line_bytes, shard, shards);
+      analyzer.Simulate(records, count);
+      partial[thread].Merge(analyzer.curve());
+    }
+  };
+  if (threads == 1) {
+    work(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+      workers.emplace_back(work, t);
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  MissRatioCurve curve;
+  curve.line_bytes = line_bytes;
+  for (const auto& part : partial) {
+    curve.Merge(part);
+  }
+  return curve;
+}
+
+// ============================================================================
+// ShardsAnalyzer
+// ============================================================================
+
+ShardsAnalyzer::ShardsAnalyzer(const ShardsConfig& config)
+    : config_(config),
+      line_shift_(0),
+      threshold_(0),
+      tracker_(config.line_bytes),
+      references_(0) {
+  if (!(config.rate > 0.0 && config.rate <= 1.0)) {
+    throw std::invalid_argument("Sampling rate must be in (0, 1]");
+  }
+  line_shift_ = static_cast<unsigned>(__builtin_ctzll(config.line_bytes));
+  threshold_ = config.rate >= 1.0 ? std::numeric_limits<uint64_t>::max()
+                                  : static_cast<uint64_t>(std::ldexp(config.rate, 64));
+  curve_.line_bytes = config.line_bytes;
+  curve_.max_buckets = config.max_buckets;
+}
+
+double ShardsAnalyzer::Rate() const {
+  return std::min(1.0, std::ldexp(static_cast<double>(threshold_) + 1.0, -64));
+}
+
+void ShardsAnalyzer::AccessLine(uint64_t line) {
+  ++references_;
+  uint64_t hash = HashLine(line);
+  if (hash > threshold_) {
+    return;
+  }
+  const double rate = Rate();
+  uint64_t distance = 0;
+  if (tracker_.Touch(line, &distance)) {
+    curve_.Add(static_cast<uint64_t>(static_cast<double>(distance) / rate), 1.0 / rate);
+    return;
+  }
+  curve_.cold += 1.0 / rate;
+  curve_.accesses += 1.0 / rate;
+  if (config_.max_samples > 0) {
+    samples_.emplace_back(hash, line);
+    std::push_heap(samples_.begin(), samples_.end());
+    if (samples_.size() > config_.max_samples) {
+      Shrink();
+    }
+  }
+}
+
+void ShardsAnalyzer::Shrink() {
+  // Порог опускается до наибольшего хеша в выборке, и все строки с ним уходят
+  threshold_ = samples_.front().first - 1;
+  while (!samples_.empty() && samples_.front().first > threshold_) {
+    tracker_.Forget(samples_.front().second);
+    std::pop_heap(samples_.begin(), samples_.end());
+    samples_.pop_back();
+  }
+}
+
+void ShardsAnalyzer::Simulate(const TraceRecord* records, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (records[i].type == static_cast<uint8_t>(AccessType::kPrefetch)) {
+      continue;
+    }
+    uint64_t first = records[i].address >> line_shift_;
+    uint64_t last = records[i].size > 1
+                        ? (records[i].address + records[i].size - 1) >> line_shift_
+                        : first;
+    for (uint64_t line = first; line <= last; ++line) {
+      AccessLine(line);
+    }
+  }
+}
+
+MissRatioCurve ShardsAnalyzer::Curve() const {
+  MissRatioCurve curve = curve_;
+  if (config_.adjust && references_ > 0) {
+    // SHARDS_adj: недостающие (или лишние) обращения считаются попаданиями на расстоянии 0
+    double missing = static_cast<double>(references_) - curve.accesses;
+    if (curve.histogram.empty()) {
+      curve.histogram.push_back(0.0);
+    }
+    curve.histogram[0] += missing;
+    curve.accesses += missing;
+  }
+  return curve;
+}
+
+MissRatioEstimate ShardsAnalyzer::Estimate(size_t lines, double z) const {
+  MissRatioEstimate estimate;
+  estimate.miss_ratio = Curve().MissRatio(lines);
+  double p = estimate.miss_ratio;
+  double samples = static_cast<double>(std::max<size_t>(SampledLines(), 1));
+  double margin = z * std::sqrt(std::max(p * (1.0 - p), 0.25 / samples) / samples);
+  estimate.lower = std::max(0.0, p - margin);
+  estimate.upper = std::min(1.0, p + margin);
+  return estimate;
+}
+
+// ============================================================================
+// Деление кэша
+// ============================================================================
+
+std::vector<size_t> PartitionCapacity(const std::vector<MissRatioCurve>& curves,
+                                      size_t total_units, size_t unit_lines) {
+  std::vector<size_t> allocation(curves.size(), 0);
+  if (curves.empty()) {
+    return allocation;
+  }
+  // misses[i][u] - промахи потребителя i на u единицах
+  std::vector<size_t> capacities(total_units + 1);
+  for (size_t u = 0; u <= total_units; ++u) {
+    capacities[u] = u * unit_lines;
+  }
+  std::vector<std::vector<double>> misses;
+  for (const auto& curve : curves) {
+    std::vector<double> ratios = curve.MissRatios(capacities);
+    for (double& ratio : ratios) {
+      ratio *= curve.accesses;
+    }
+    misses.push_back(std::move(ratios));
+  }
+
+  size_t remaining = total_units;
+  while (remaining > 0) {
+    double best_gain = -1.0;
+    size_t best_curve = 0;
+    size_t best_units = 1;
+    for (size_t i = 0; i < curves.size(); ++i) {
+      const double base = misses[i][allocation[i]];
+      for (size_t k = 1; k <= remaining; ++k) {
+        double gain = (base - misses[i][allocation[i] + k]) / static_cast<double>(k);
+        if (gain > best_gain) {
+          best_gain = gain;
+          best_curve = i;
+          best_units = k;
+        }
+      }
+    }
+    allocation[best_curve] += best_units;
+    remaining -= best_units;
+  }
+  return allocation;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,269 @@
+#ifndef STACK_DISTANCE_HPP
+#define STACK_DISTANCE_HPP
+
+#include "memory_trace.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Перемешивание номера строки (финализатор splitmix64)
+ *
+ * Делит адресное пространство на шарды и выбирает строки для выборки так,
+ * что соседние и выровненные по степени двойки строки расходятся равномерно.
+ */
+inline uint64_t HashLine(uint64_t line) {
+  line ^= line >> 30;
+  line *= 0xBF58476D1CE4E5B9ull;
+  line ^= line >> 27;
+  line *= 0x94D049BB133111EBull;
+  line ^= line >> 31;
+  return line;
+}
+
+/**
+ * @brief Кривая промахов LRU: гистограмма стековых расстояний
+ *
+ * Расстояние обращения - число различных строк, тронутых с прошлого
+ * обращения к той же строке. Полностью ассоциативный LRU-кэш на C строк
+ * попадает ровно в обращения с расстоянием меньше C, поэтому одна
+ * гистограмма даёт долю промахов для любой ёмкости. Веса дробные: выборка
+ * (SHARDS) учитывает обращение с весом, обратным доле выборки.
+ *
+ * Корзина гистограммы покрывает bucket_lines расстояний (степень двойки).
+ * При max_buckets > 0 корзины укрупняются вдвое, как только расстояние не
+ * помещается: память постоянна, а разрешение кривой падает с её длиной.
+ */
+struct MissRatioCurve {
+  size_t line_bytes = 64;
+  size_t bucket_lines = 1;
+  size_t max_buckets = 0;            // 0 - без ограничения
+  std::vector<double> histogram;     // [расстояние / bucket_lines] -> обращений
+  double cold = 0.0;                 // Первые обращения к строке (промах при любой ёмкости)
+  double accesses = 0.0;
+
+  void Add(uint64_t distance, double weight = 1.0);
+
+  /**
+   * @brief Укрупнение корзин вдвое
+   */
+  void Coarsen();
+
+  /**
+   * @brief Сложение кривых шардов или потоков (более мелкие корзины укрупняются)
+   * @throws std::invalid_argument при разных line_bytes
+   */
+  void Merge(const MissRatioCurve& other);
+
+  /**
+   * @brief Наибольшее расстояние, которое различает гистограмма (в строках)
+   */
+  size_t SpanLines() const { return histogram.size() * bucket_lines; }
+
+  /**
+   * @brief Доля промахов кэша на lines строк (1.0 для пустой кривой)
+   *
+   * Внутри корзины попадания интерполируются линейно.
+   */
+  double MissRatio(size_t lines) const;
+  double MissRatioAtBytes(size_t bytes) const { return MissRatio(bytes / line_bytes); }
+
+  /**
+   * @brief Доли промахов для набора ёмкостей за один проход по гистограмме
+   */
+  std::vector<double> MissRatios(const std::vector<size_t>& lines) const;
+
+  /**
+   * @brief Наименьшая ёмкость в строках с долей промахов не выше target
+   *        (с точностью до корзины, округление вверх)
+   * @return 0 если цель недостижима (холодные промахи выше target)
+   */
+  size_t CapacityFor(double target) const;
+
+  /**
+   * @brief Ёмкости от одной строки до SpanLines(), по points_per_octave на
+   *        каждое удвоение
+   */
+  std::vector<size_t> LogCapacities(size_t points_per_octave = 4) const;
+
+  /**
+   * @brief JSON {"line_bytes", "accesses", "cold_misses", "points": [...]}
+   */
+  void WriteJson(std::ostream& out, const std::vector<size_t>& lines) const;
+};
+
+/**
+ * @brief Однопроходный анализ стековых расстояний (алгоритм Olken)
+ *
+ * Время последнего обращения каждой строки хранится в хеш-таблице, а дерево
+ * Фенвика над временем отмечает, какие моменты ещё являются последним
+ * обращением своей строки: расстояние - сумма отметок после прошлого
+ * обращения, O(log n) на обращение вместо O(n) у стека Маттсона. Когда
+ * время упирается в размер дерева, живые отметки перенумеровываются подряд,
+ * так что память пропорциональна числу различных строк, а не длине трассы.
+ *
+ * С shards > 1 анализатор видит только строки своего шарда (HashLine % shards)
+ * и умножает расстояния на shards: строки шарда - равномерная выборка, и
+ * между двумя обращениями к строке в среднем проходит в shards раз больше
+ * различных строк, чем видно в шарде. Шарды независимы и считаются
+ * параллельно (Analyze), а их кривые складываются.
+ */
+class StackDistanceAnalyzer {
+ public:
+  /**
+   * @throws std::invalid_argument если line_bytes не степень двойки или shard >= shards
+   */
+  explicit StackDistanceAnalyzer(size_t line_bytes = 64, size_t shard = 0, size_t shards = 1);
+
+  /**
+   * @brief Обращение к строке line (строки чужих шардов пропускаются)
+   */
+  void AccessLine(uint64_t line);
+
+  /**
+   * @brief Обращения трассы; пересекающие границу строки дают обращение к каждой
+   *        (записи программной предвыборки пропускаются)
+   */
+  void Simulate(const TraceRecord* records, size_t count);
+
+  /**
+   * @brief Отметка обращения без записи в кривую
+   * @return false для первого обращения к строке, иначе true и *distance
+   */
+  bool Touch(uint64_t line, uint64_t* distance);
+
+  /**
+   * @brief Забыть строку: следующее обращение к ней снова холодное
+   */
+  void Forget(uint64_t line);
+
+  const MissRatioCurve& curve() const { return curve_; }
+  size_t DistinctLines() const { return last_access_.size(); }
+
+  /**
+   * @brief Кривая трассы по шардам в threads потоках
+   * @param shards 1 - точный анализ
+   * @param threads 0 - по числу доступных CPU (не больше shards)
+   */
+  static MissRatioCurve Analyze(const TraceRecord* records, size_t count, size_t line_bytes = 64,
+                                size_t shards = 1, size_t threads = 0);
+
+ private:
+  void Record(uint64_t line);
+  void Compact();
+  uint64_t Prefix(uint64_t end) const;                   // Отметок в моментах [0, end)
+  void Update(uint64_t time, int32_t delta);
+
+  unsigned line_shift_;
+  size_t shard_;
+  size_t shards_;
+  std::unordered_map<uint64_t, uint64_t> last_access_;   // Строка -> момент
+  std::vector<uint32_t> tree_;                           // Фенвик по моментам, с 1
+  uint64_t now_;
+  MissRatioCurve curve_;
+};
+
+/**
+ * @brief Параметры выборочного анализа
+ *
+ * max_samples == 0 - фиксированная доля rate; иначе фиксированный размер:
+ * выборка начинается с rate и сужается так, чтобы в ней было не больше
+ * max_samples строк.
+ */
+struct ShardsConfig {
+  double rate = 0.01;
+  size_t max_samples = 0;
+  size_t line_bytes = 64;
+  size_t max_buckets = 1u << 16;     // Корзин гистограммы (постоянная память)
+  bool adjust = false;               // Поправка SHARDS_adj на отклонение числа выборок
+};
+
+/**
+ * @brief Оценка доли промахов с доверительным интервалом
+ */
+struct MissRatioEstimate {
+  double miss_ratio = 1.0;
+  double lower = 0.0;
+  double upper = 1.0;
+};
+
+/**
+ * @brief Кривая промахов по пространственной выборке строк (SHARDS)
+ *
+ * Строка попадает в выборку, если HashLine(line) не больше порога T, так
+ * что выбираются все обращения к выбранной строке, а доля строк R = T / 2^64.
+ * Выбранные обращения проходят точный алгоритм Olken, расстояния делятся
+ * на R, веса равны 1 / R. Память - число строк в выборке плюс max_buckets
+ * корзин, независимо от длины трассы.
+ *
+ * В режиме фиксированного размера при переполнении из выборки уходит строка
+ * с наибольшим хешем, и порог опускается до её хеша: R только убывает.
+ * Поправка SHARDS_adj относит разницу между числом обращений трассы и
+ * взвешенным числом выбранных обращений к нулевому расстоянию. Она помогает,
+ * когда ошибку выборки дают несколько очень горячих строк с короткими
+ * расстояниями, и смещает кривую, когда горячий набор широкий и ровный,
+ * поэтому включается явно.
+ */
+class ShardsAnalyzer {
+ public:
+  /**
+   * @throws std::invalid_argument если rate вне (0, 1] или line_bytes не степень двойки
+   */
+  explicit ShardsAnalyzer(const ShardsConfig& config);
+
+  void AccessLine(uint64_t line);
+  void Simulate(const TraceRecord* records, size_t count);
+
+  /**
+   * @brief Кривая с поправкой (если включена)
+   */
+  MissRatioCurve Curve() const;
+
+  /**
+   * @brief Оценка доли промахов на lines строк с нормальным интервалом z сигм
+   *
+   * Единица выборки - строка, поэтому эффективный объём выборки - число строк
+   * в ней: интервал p +- z * sqrt(p (1 - p) / n) консервативен для трасс, где
+   * обращения распределены по строкам неравномерно.
+   */
+  MissRatioEstimate Estimate(size_t lines, double z = 1.96) const;
+
+  double Rate() const;
+  size_t SampledLines() const { return tracker_.DistinctLines(); }
+  uint64_t References() const { return references_; }
+  const ShardsConfig& config() const { return config_; }
+
+ private:
+  void Shrink();
+
+  ShardsConfig config_;
+  unsigned line_shift_;
+  uint64_t threshold_;                                   // Выборка: HashLine <= threshold_
+  StackDistanceAnalyzer tracker_;
+  std::vector<std::pair<uint64_t, uint64_t>> samples_;   // Куча (хеш, строка) по максимуму
+  MissRatioCurve curve_;
+  uint64_t references_;
+};
+
+/**
+ * @brief Деление общего кэша между потребителями по их кривым
+ *
+ * Жадное распределение с заглядыванием вперёд (UCP): очередная порция из
+ * нескольких единиц достаётся потребителю с наибольшим сокращением промахов
+ * на единицу, где промахи - доля промахов x число обращений кривой. Это
+ * учитывает плато кривых, на которых одна единица ничего не даёт.
+ *
+ * @param unit_lines Строк в единице (например, в одном пути LLC для CAT)
+ * @return Единиц на каждую кривую, в сумме total_units
+ */
+std::vector<size_t> PartitionCapacity(const std::vector<MissRatioCurve>& curves,
+                                      size_t total_units, size_t unit_lines);
+
+}  // namespace hardware_analysis
+
+#endif  // STACK_DISTANCE_HPP
@@ -0,0 +1,424 @@
+#include "stress_engine.hpp"
+#include "cpu_topology.hpp"
+#include "memory_benchmark.hpp"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr size_t kLineBytes = 64;
+constexpr size_t kComputeSteps = 4096;     // Шагов FMA-цепочек на блок
+constexpr size_t kStreamElements = 8192;   // Элементов triad на блок (64 КБ на массив)
+constexpr size_t kChaseLoads = 4096;       // Загрузок chase на блок
+
+// Приёмник результатов, чтобы компилятор не выбросил циклы
+volatile double g_sink;
+
+bool UsesMemory(StressKind kind) {
+  return kind == StressKind::kStream || kind == StressKind::kChase || kind == StressKind::kMixed;
+}
+
+/**
+ * @brief Состояние фазы в потоке: буфер и позиция в нём
+ */
+struct PhaseState {
+  std::unique_ptr<BenchmarkBuffer> buffer;
+  size_t elements = 0;      // Элементов в каждой трети буфера (triad)
+  size_t cursor = 0;
+  char* chase = nullptr;    // Текущий узел цепочки
+};
+
+/**
+ * @brief Блок FMA: 8 независимых цепочек
+ * @return Операций с плавающей точкой
+ */
+double ComputeBlock() {
+  double acc[8] = {1.0, 1.1, 1.2, 1.3, 1.4, 1.5, 1.6, 1.7};
+  for (size_t step = 0; step < kComputeSteps; ++step) {
+    for (double& value : acc) {
+      value = value * 0.999999 + 1e-7;
+    }
+  }
+  asm volatile("" : : "r"(acc) : "memory");
+  g_sink = acc[0];
+  return 2.0 * 8 * kComputeSteps;
+}
+
+/**
+ * @brief Блок triad c = a + s * b, для mixed - с цепочкой FMA на элемент
+ * @return Обработанных элементов
+ */
+size_t StreamBlock(PhaseState& state, size_t fma_per_element) {
+  double* a = reinterpret_cast<double*>(state.buffer->data());
+  double* b = a + state.elements;
+  double* c = b + state.elements;
+  size_t begin = state.cursor;
+  size_t end = std::min(begin + kStreamElements, state.elements);
+  if (fma_per_element == 0) {
+    for (size_t i = begin; i < end; ++i) {
+      c[i] = a[i] + 3.0 * b[i];
+    }
+  } else {
+    for (size_t i = begin; i < end; ++i) {
+      double x = a[i];
+      for (size_t k = 0; k < fma_per_element; ++k) {
+        x = x * 0.999 + b[i];
+      }
+      c[i] = x;
+    }
+  }
+  asm volatile("" : : "r"(c) : "memory");
+  state.cursor = end == state.elements ? 0 : end;
+  return end - begin;
+}
+
+size_t ChaseBlock(PhaseState& state) {
+  char* p = state.chase;
+  for (size_t i = 0; i < kChaseLoads; ++i) {
+    p = *reinterpret_cast<char**>(p);
+  }
+  state.chase = p;
+  return kChaseLoads;
+}
+
+}  // namespace
+
+const char* StressKindName(StressKind kind) {
+  switch (kind) {
+    case StressKind::kStream:
+      return "stream";
+    case StressKind::kChase:
+      return "chase";
+    case StressKind::kMixed:
+      return "mixed";
+    case StressKind::kIdle:
+      return "idle";
+    case StressKind::kCompute:
+    default:
+      return "compute";
+  }
+}
+
+StressPhase StressPhase::Parse(const std::string& spec) {
+  std::vector<std::string> fields;
+  std::stringstream stream(spec);
+  std::string field;
+  while (std::getline(stream, field, ':')) {
+    fields.push_back(field);
+  }
+  if (fields.size() < 2 || fields.size() > 4) {
+    throw std::invalid_argument(
+        "Invalid stress phase (expected kind:seconds[:duty[:period_ms]]): " + spec);
+  }
+
+  StressPhase phase;
+  bool known = false;
+  for (StressKind kind : {StressKind::kCompute, StressKind::kStream, StressKind::kChase,
+                          StressKind::kMixed, StressKind::kIdle}) {
+    if (fields[0] == StressKindName(kind)) {
+      phase.kind = kind;
+      known = true;
+    }
+  }
+  if (!known) {
+    throw std::invalid_argument("Unknown stress kind: " + fields[0]);
+  }
+  try {
+    phase.seconds = std::stod(fields[1]);
+    if (fields.size() > 2) {
+      phase.duty_cycle = std::stod(fields[2]);
+    }
+    if (fields.size() > 3) {
+      phase.period_seconds = std::stod(fields[3]) / 1000.0;
+    }
+  } catch (const std::logic_error&) {
+    throw std::invalid_argument("Invalid number in stress phase: " + spec);
+  }
+  return phase;
+}
+
+StressRates StressRates::From(const StressCounters& counters, double seconds, size_t threads,
+                              size_t phase) {
+  StressRates rates;
+  rates.seconds = seconds;
+  rates.phase = phase;
+  if (seconds > 0.0) {
+    rates.gflops = counters.flops / seconds / 1e9;
+    rates.gbs = counters.bytes / seconds / 1e9;
+    rates.maccesses_per_second = counters.accesses / seconds / 1e6;
+    rates.busy_fraction = counters.busy_seconds / (seconds * std::max<size_t>(threads, 1));
+  }
+  return rates;
+}
+
+// ============================================================================
+// StressEngine
+// ============================================================================
+
+StressEngine::StressEngine(const StressConfig& config)
+    : config_(config), cycle_seconds_(0.0), ready_(0), go_(false), stop_(false), finished_(0) {
+  if (config_.phases.empty()) {
+    throw std::invalid_argument("Stress engine needs at least one phase");
+  }
+  for (const auto& phase : config_.phases) {
+    if (!(phase.seconds > 0.0) || !(phase.period_seconds > 0.0)) {
+      throw std::invalid_argument("Stress phase duration and period must be positive");
+    }
+    if (!(phase.duty_cycle > 0.0) || phase.duty_cycle > 1.0) {
+      throw std::invalid_argument("Stress duty cycle must be in (0, 1]");
+    }
+    if (UsesMemory(phase.kind) && phase.working_set < 3 * kStreamElements * sizeof(double)) {
+      throw std::invalid_argument("Stress working set is too small");
+    }
+  }
+  if (config_.cpus.empty()) {
+    config_.cpus = {0};
+  }
+  if (config_.cycles == 0) {
+    config_.cycles = 1;
+  }
+  for (const auto& phase : config_.phases) {
+    phase_starts_.push_back(cycle_seconds_);
+    cycle_seconds_ += phase.seconds;
+  }
+  slots_.reset(new Slot[config_.cpus.size() * config_.phases.size()]);
+}
+
+StressEngine::~StressEngine() {
+  Stop();
+}
+
+double StressEngine::TotalSeconds() const {
+  return cycle_seconds_ * config_.cycles;
+}
+
+size_t StressEngine::PhaseAt(double elapsed) const {
+  if (elapsed < 0.0) {
+    return 0;
+  }
+  if (elapsed >= TotalSeconds()) {
+    return config_.phases.size();
+  }
+  double offset = std::fmod(elapsed, cycle_seconds_);
+  size_t phase = std::upper_bound(phase_starts_.begin(), phase_starts_.end(), offset) -
+                 phase_starts_.begin();
+  return phase > 0 ? phase - 1 : 0;
+}
+
+StressEngine::Slot& StressEngine::SlotOf(size_t thread, size_t phase) const {
+  return slots_[thread * config_.phases.size() + phase];
+}
+
+void StressEngine::Start() {
+  if (!threads_.empty()) {
+    return;
+  }
+  ready_ = 0;
+  finished_ = 0;
+  go_ = false;
+  stop_ = false;
+  errors_.assign(config_.cpus.size(), nullptr);
+  for (size_t t = 0; t < config_.cpus.size(); ++t) {
+    threads_.emplace_back(&StressEngine::Worker, this, t);
+  }
+  // Общий старт после заполнения буферов: расписание одно на все потоки
+  while (ready_.load() < threads_.size()) {
+    std::this_thread::yield();
+  }
+  for (const std::exception_ptr& error : errors_) {
+    if (error) {
+      Stop();
+      std::rethrow_exception(error);
+    }
+  }
+  started_ = last_sample_ = Clock::now();
+  last_totals_ = StressCounters();
+  go_.store(true, std::memory_order_release);
+}
+
+void StressEngine::Stop() {
+  stop_.store(true);
+  go_.store(true, std::memory_order_release);
+  Wait();
+}
+
+void StressEngine::Wait() {
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+bool StressEngine::Finished() const {
+  return finished_.load() == config_.cpus.size();
+}
+
+void StressEngine::Worker(size_t thread) {
+  ScopedAffinity affinity;
+  PinOrWarn(affinity, config_.cpus[thread], "stress");
+
+  // Буфер на фазу, на узле config.numa_node или first touch на своём CPU.
+  // При ошибке поток всё равно отмечается готовым: Start() остановит остальных
+  std::vector<PhaseState> states(config_.phases.size());
+  try {
+    for (size_t p = 0; p < config_.phases.size(); ++p) {
+      const StressPhase& phase = config_.phases[p];
+      if (!UsesMemory(phase.kind)) {
+        continue;
+      }
+      PhaseState& state = states[p];
+      state.buffer.reset(
+          new BenchmarkBuffer(phase.working_set, PageSize::k4K, config_.numa_node));
+      if (phase.kind == StressKind::kChase) {
+        size_t nodes = phase.working_set / kLineBytes;
+        std::vector<uint32_t> next = MemoryBenchmark::ChaseOrder(nodes, nodes + thread);
+        char* base = state.buffer->data();
+        for (size_t i = 0; i < nodes; ++i) {
+          *reinterpret_cast<char**>(base + i * kLineBytes) = base + next[i] * kLineBytes;
+        }
+        state.chase = base;
+      } else {
+        state.elements = phase.working_set / sizeof(double) / 3;
+      }
+    }
+  } catch (...) {
+    errors_[thread] = std::current_exception();
+    ready_.fetch_add(1);
+    return;
+  }
+
+  ready_.fetch_add(1);
+  while (!go_.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+
+  const double total = TotalSeconds();
+  auto nanoseconds_since = [](Clock::time_point from) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - from).count());
+  };
+  for (;;) {
+    auto begin = Clock::now();
+    double elapsed = std::chrono::duration<double>(begin - started_).count();
+    if (elapsed >= total || stop_.load(std::memory_order_relaxed)) {
+      break;
+    }
+    size_t p = PhaseAt(elapsed);
+    const StressPhase& phase = config_.phases[p];
+    double in_phase = std::fmod(elapsed, cycle_seconds_) - phase_starts_[p];
+    double phase_left = std::max(0.0, phase.seconds - in_phase);
+
+    // Пауза: фаза idle или выключенная часть периода duty cycle
+    double pause = 0.0;
+    if (phase.kind == StressKind::kIdle) {
+      pause = std::min(phase_left, 0.01);
+    } else if (phase.duty_cycle < 1.0) {
+      double position = std::fmod(in_phase, phase.period_seconds);
+      if (position >= phase.duty_cycle * phase.period_seconds) {
+        pause = std::min(phase.period_seconds - position, phase_left);
+      }
+    }
+    Slot& slot = SlotOf(thread, p);
+    if (pause > 0.0) {
+      std::this_thread::sleep_for(std::chrono::duration<double>(pause));
+      slot.elapsed_ns.fetch_add(nanoseconds_since(begin), std::memory_order_relaxed);
+      continue;
+    }
+
+    switch (phase.kind) {
+      case StressKind::kCompute:
+        slot.flops.fetch_add(static_cast<uint64_t>(ComputeBlock()), std::memory_order_relaxed);
+        break;
+      case StressKind::kStream:
+      case StressKind::kMixed: {
+        size_t fma = phase.kind == StressKind::kMixed ? phase.fma_per_element : 0;
+        size_t elements = StreamBlock(states[p], fma);
+        slot.flops.fetch_add(2 * std::max<size_t>(fma, 1) * elements, std::memory_order_relaxed);
+        // Два чтения и одна запись на элемент
+        slot.bytes.fetch_add(3 * sizeof(double) * elements, std::memory_order_relaxed);
+        break;
+      }
+      case StressKind::kChase:
+        slot.accesses.fetch_add(ChaseBlock(states[p]), std::memory_order_relaxed);
+        break;
+      case StressKind::kIdle:
+        break;
+    }
+    uint64_t block_ns = nanoseconds_since(begin);
+    slot.busy_ns.fetch_add(block_ns, std::memory_order_relaxed);
+    slot.elapsed_ns.fetch_add(block_ns, std::memory_order_relaxed);
+  }
+  finished_.fetch_add(1);
+}
+
+StressCounters StressEngine::PhaseTotals(size_t phase) const {
+  StressCounters totals;
+  if (phase >= config_.phases.size()) {
+    return totals;
+  }
+  for (size_t t = 0; t < config_.cpus.size(); ++t) {
+    const Slot& slot = SlotOf(t, phase);
+    totals.flops += slot.flops.load(std::memory_order_relaxed);
+    totals.bytes += slot.bytes.load(std::memory_order_relaxed);
+    totals.accesses += slot.accesses.load(std::memory_order_relaxed);
+    totals.busy_seconds += slot.busy_ns.load(std::memory_order_relaxed) / 1e9;
+  }
+  return totals;
+}
+
+double StressEngine::PhaseSeconds(size_t phase) const {
+  if (phase >= config_.phases.size() || config_.cpus.empty()) {
+    return 0.0;
+  }
+  uint64_t elapsed_ns = 0;
+  for (size_t t = 0; t < config_.cpus.size(); ++t) {
+    elapsed_ns += SlotOf(t, phase).elapsed_ns.load(std::memory_order_relaxed);
+  }
+  return elapsed_ns / 1e9 / config_.cpus.size();
+}
+
+StressCounters StressEngine::Totals() const {
+  StressCounters totals;
+  for (size_t p = 0; p < config_.phases.size(); ++p) {
+    StressCounters phase = PhaseTotals(p);
+    totals.flops += phase.flops;
+    totals.bytes += phase.bytes;
+    totals.accesses += phase.accesses;
+    totals.busy_seconds += phase.busy_seconds;
+  }
+  return totals;
+}
+
+StressRates StressEngine::Sample() {
+  Clock::time_point now = Clock::now();
+  StressCounters totals = Totals();
+  StressCounters delta;
+  delta.flops = totals.flops - last_totals_.flops;
+  delta.bytes = totals.bytes - last_totals_.bytes;
+  delta.accesses = totals.accesses - last_totals_.accesses;
+  delta.busy_seconds = totals.busy_seconds - last_totals_.busy_seconds;
+
+  double seconds = std::chrono::duration<double>(now - last_sample_).count();
+  size_t phase = PhaseAt(std::chrono::duration<double>(now - started_).count());
+  last_sample_ = now;
+  last_totals_ = totals;
+  return StressRates::From(delta, seconds, config_.cpus.size(), phase);
+}
+
+std::vector<StressRates> StressEngine::Run() {
+  Start();
+  Wait();
+  std::vector<StressRates> results;
+  for (size_t p = 0; p < config_.phases.size(); ++p) {
+    results.push_back(
+        StressRates::From(PhaseTotals(p), PhaseSeconds(p), config_.cpus.size(), p));
+  }
+  return results;
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,187 @@
+#ifndef STRESS_ENGINE_HPP
+#define STRESS_ENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Вид нагрузки фазы
+ */
+enum class StressKind {
+  kCompute = 0,   // Независимые цепочки FMA в регистрах
+  kStream,        // STREAM triad по рабочему набору
+  kChase,         // Pointer chasing: латентность памяти
+  kMixed,         // Triad с fma_per_element FMA на элемент
+  kIdle           // Сон
+};
+
+const char* StressKindName(StressKind kind);
+
+/**
+ * @brief Фаза нагрузки
+ *
+ * duty_cycle < 1 даёт пульсирующую нагрузку: в каждом периоде первые
+ * duty_cycle * period_seconds потоки работают, остаток спят.
+ */
+struct StressPhase {
+  StressKind kind = StressKind::kCompute;
+  double seconds = 1.0;
+  double duty_cycle = 1.0;
+  double period_seconds = 0.1;
+  size_t working_set = 64u << 20;    // Байт на поток (stream, chase, mixed)
+  size_t fma_per_element = 8;        // mixed: арифметическая интенсивность
+
+  /**
+   * @brief Разбор "kind:seconds[:duty[:period_ms]]", например "stream:5:0.5:200"
+   * @throws std::invalid_argument при неверной записи
+   */
+  static StressPhase Parse(const std::string& spec);
+};
+
+struct StressConfig {
+  std::vector<int> cpus;             // По потоку на CPU (пусто - CPU 0)
+  int numa_node = -1;                // Узел буферов (-1 - first touch)
+  std::vector<StressPhase> phases;
+  size_t cycles = 1;                 // Повторов последовательности фаз
+};
+
+/**
+ * @brief Счётчики нагрузки (накопленные или за интервал)
+ */
+struct StressCounters {
+  double flops = 0.0;
+  double bytes = 0.0;                // Байт памяти, triad: два чтения и запись
+  double accesses = 0.0;             // Зависимых загрузок chase
+  double busy_seconds = 0.0;         // Потоко-секунды под нагрузкой (без пауз duty cycle)
+};
+
+/**
+ * @brief Скорости за интервал
+ */
+struct StressRates {
+  double seconds = 0.0;              // Длина интервала
+  size_t phase = 0;                  // Фаза в конце интервала
+  double gflops = 0.0;
+  double gbs = 0.0;
+  double maccesses_per_second = 0.0;
+  double busy_fraction = 0.0;        // busy_seconds / (seconds * потоков)
+
+  static StressRates From(const StressCounters& counters, double seconds, size_t threads,
+                          size_t phase);
+};
+
+/**
+ * @brief Генератор управляемой нагрузки для проверки оптимизаций
+ *
+ * Потоки привязываются к config.cpus, буферы - к config.numa_node, и все
+ * вместе проходят фазы по общему расписанию от момента Start(): выбор
+ * частоты (DVFS) или узла (NUMA) можно сравнивать на одной и той же
+ * воспроизводимой нагрузке. Каждый поток ведёт свои счётчики по фазам,
+ * поэтому пропускная способность нагрузки видна без perf и MSR и
+ * сверяется с тем, что насчитали SystemMonitor или WorkloadClassifier.
+ */
+class StressEngine {
+ public:
+  /**
+   * @throws std::invalid_argument без фаз или при неверных параметрах фазы
+   */
+  explicit StressEngine(const StressConfig& config);
+  ~StressEngine();
+
+  StressEngine(const StressEngine&) = delete;
+  StressEngine& operator=(const StressEngine&) = delete;
+
+  /**
+   * @brief Запуск потоков; буферы заполняются до общего старта
+   * @throws std::runtime_error если буфер потока не выделился (потоки уже остановлены)
+   */
+  void Start();
+
+  /**
+   * @brief Досрочная остановка и ожидание потоков
+   */
+  void Stop();
+
+  /**
+   * @brief Ожидание конца расписания
+   */
+  void Wait();
+
+  bool Finished() const;
+
+  /**
+   * @brief Длительность расписания: сумма фаз x cycles
+   */
+  double TotalSeconds() const;
+
+  /**
+   * @brief Фаза расписания в момент elapsed от старта (phases.size() после конца)
+   */
+  size_t PhaseAt(double elapsed) const;
+
+  /**
+   * @brief Скорости с прошлого вызова Sample (или со старта)
+   */
+  StressRates Sample();
+
+  /**
+   * @brief Накопленные счётчики фазы по всем потокам и повторам
+   */
+  StressCounters PhaseTotals(size_t phase) const;
+
+  /**
+   * @brief Время, действительно проведённое в фазе (среднее по потокам, с паузами)
+   *
+   * Меньше номинальных seconds x cycles, если расписание остановлено досрочно.
+   */
+  double PhaseSeconds(size_t phase) const;
+
+  /**
+   * @brief Start + Wait; скорости каждой фазы
+   */
+  std::vector<StressRates> Run();
+
+  const StressConfig& config() const { return config_; }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> flops{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> accesses{0};
+    std::atomic<uint64_t> busy_ns{0};
+    std::atomic<uint64_t> elapsed_ns{0};   // Всё время в фазе, включая паузы
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  void Worker(size_t thread);
+  Slot& SlotOf(size_t thread, size_t phase) const;
+  StressCounters Totals() const;
+
+  StressConfig config_;
+  std::vector<double> phase_starts_;     // Начало фазы внутри одного цикла
+  double cycle_seconds_;
+  std::unique_ptr<Slot[]> slots_;        // [поток][фаза]
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> ready_;
+  std::atomic<bool> go_;
+  std::atomic<bool> stop_;
+  std::atomic<size_t> finished_;
+  std::vector<std::exception_ptr> errors_;   // Ошибки подготовки, по потоку
+  Clock::time_point started_;
+  Clock::time_point last_sample_;
+  StressCounters last_totals_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // STRESS_ENGINE_HPP
@@ -0,0 +1,90 @@
+#include "synthetic_workloads.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace hardware_analysis {
+namespace synthetic {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint64_t kComputeBlock = 4096;   // Шагов между проверками времени
+
+double Since(Clock::time_point started) {
+  return std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+bool Stopped(const std::atomic<bool>* stop) {
+  return stop != nullptr && stop->load(std::memory_order_relaxed);
+}
+
+WorkloadRun ComputeLoop(double seconds, uint64_t max_iterations,
+                        const std::atomic<bool>* stop) {
+  // 8 независимых цепочек скрывают латентность FMA
+  double acc[8] = {1.0, 1.1, 1.2, 1.3, 1.4, 1.5, 1.6, 1.7};
+  const double mul = 0.999999;
+  const double add = 1e-7;
+
+  Clock::time_point started = Clock::now();
+  uint64_t iterations = 0;
+  while (iterations < max_iterations) {
+    for (uint64_t step = 0; step < kComputeBlock; ++step) {
+      for (double& value : acc) {
+        value = value * mul + add;
+      }
+    }
+    asm volatile("" : : "r"(acc) : "memory");
+    iterations += kComputeBlock;
+    if (Since(started) >= seconds || Stopped(stop)) {
+      break;
+    }
+  }
+  return {Since(started), iterations, 0.0};
+}
+
+WorkloadRun StreamLoop(double seconds, uint64_t max_passes, size_t array_bytes,
+                       const std::atomic<bool>* stop) {
+  size_t count = std::max<size_t>(1, array_bytes / sizeof(double));
+  std::vector<double> a(count, 0.0), b(count, 1.0), c(count, 2.0);
+  const double scalar = 3.0;
+
+  Clock::time_point started = Clock::now();
+  uint64_t passes = 0;
+  while (passes < max_passes) {
+    for (size_t i = 0; i < count; ++i) {
+      a[i] = b[i] + scalar * c[i];
+    }
+    asm volatile("" : : "r"(a.data()) : "memory");
+    ++passes;
+    if (Since(started) >= seconds || Stopped(stop)) {
+      break;
+    }
+  }
+
+  // Triad: два чтения и одна запись на элемент
+  return {Since(started), passes, 3.0 * sizeof(double) * count * passes};
+}
+
+}  // namespace
+
+WorkloadRun RunCompute(double seconds, const std::atomic<bool>* stop) {
+  return ComputeLoop(seconds, UINT64_MAX, stop);
+}
+
+WorkloadRun RunComputeIterations(uint64_t iterations) {
+  return ComputeLoop(INFINITY, std::max<uint64_t>(iterations, 1), nullptr);
+}
+
+WorkloadRun RunStream(double seconds, size_t array_bytes, const std::atomic<bool>* stop) {
+  return StreamLoop(seconds, UINT64_MAX, array_bytes, stop);
+}
+
+WorkloadRun RunStreamPasses(uint64_t passes, size_t array_bytes) {
+  return StreamLoop(INFINITY, std::max<uint64_t>(passes, 1), array_bytes, nullptr);
+}
+
+}  // namespace synthetic
+}  // namespace hardware_analysis
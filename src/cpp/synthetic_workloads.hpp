@@ -0,0 +1,60 @@
+#ifndef SYNTHETIC_WORKLOADS_HPP
+#define SYNTHETIC_WORKLOADS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hardware_analysis {
+namespace synthetic {
+
+/**
+ * @brief Итог синтетической нагрузки
+ */
+struct WorkloadRun {
+  double seconds;
+  uint64_t iterations;   // Вычислительных шагов или проходов по массиву
+  double bytes;          // Переданные байты памяти (0 для вычислительной нагрузки)
+};
+
+/**
+ * @brief Вычислительная нагрузка: независимые цепочки FMA в регистрах
+ *
+ * Рабочий набор помещается в регистры, время масштабируется с частотой
+ * почти линейно (IPC высокий, промахов LLC нет).
+ *
+ * @param seconds Длительность
+ * @param stop Досрочная остановка (может быть nullptr)
+ */
+WorkloadRun RunCompute(double seconds, const std::atomic<bool>* stop = nullptr);
+
+/**
+ * @brief Вычислительная нагрузка фиксированного объёма
+ * @param iterations Шагов (округляется вверх до блока 4096)
+ */
+WorkloadRun RunComputeIterations(uint64_t iterations);
+
+/**
+ * @brief Нагрузка STREAM triad a[i] = b[i] + s * c[i] по массивам вне LLC
+ *
+ * Упирается в пропускную способность памяти: IPC низкий, много промахов
+ * LLC и циклов ожидания памяти, время слабо зависит от частоты.
+ *
+ * @param seconds Длительность
+ * @param array_bytes Размер каждого из трёх массивов (должен превышать LLC)
+ * @param stop Досрочная остановка (может быть nullptr)
+ */
+WorkloadRun RunStream(double seconds, size_t array_bytes = 64u << 20,
+                      const std::atomic<bool>* stop = nullptr);
+
+/**
+ * @brief STREAM triad фиксированного объёма
+ * @param passes Проходов по массивам
+ * @param array_bytes Размер каждого из трёх массивов
+ */
+WorkloadRun RunStreamPasses(uint64_t passes, size_t array_bytes = 64u << 20);
+
+}  // namespace synthetic
+}  // namespace hardware_analysis
+
+#endif  // SYNTHETIC_WORKLOADS_HPP
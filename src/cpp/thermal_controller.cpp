@@ -0,0 +1,311 @@
+#include "thermal_controller.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr size_t kMinFitPoints = 16;
+
+double Clamp(double value, double low, double high) {
+  return std::max(low, std::min(high, value));
+}
+
+/**
+ * @brief Решение 3x3 системы методом Гаусса с выбором главного элемента
+ * @return false если система вырождена
+ */
+bool Solve3x3(double a[3][3], double b[3], double x[3]) {
+  for (int col = 0; col < 3; ++col) {
+    int pivot = col;
+    for (int row = col + 1; row < 3; ++row) {
+      if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) {
+        pivot = row;
+      }
+    }
+    if (std::fabs(a[pivot][col]) < 1e-12) {
+      return false;
+    }
+    std::swap(a[col], a[pivot]);
+    std::swap(b[col], b[pivot]);
+
+    for (int row = col + 1; row < 3; ++row) {
+      double factor = a[row][col] / a[col][col];
+      for (int k = col; k < 3; ++k) {
+        a[row][k] -= factor * a[col][k];
+      }
+      b[row] -= factor * b[col];
+    }
+  }
+
+  for (int row = 2; row >= 0; --row) {
+    double sum = b[row];
+    for (int k = row + 1; k < 3; ++k) {
+      sum -= a[row][k] * x[k];
+    }
+    x[row] = sum / a[row][row];
+  }
+  return true;
+}
+
+}  // namespace
+
+// ============================================================================
+// LinearThrottleController
+// ============================================================================
+
+double LinearThrottleController::Update(const ThermalSample& sample, double target_celsius) {
+  if (!std::isfinite(sample.temperature_celsius) ||
+      sample.temperature_celsius <= target_celsius) {
+    return 1.0;
+  }
+  return target_celsius / sample.temperature_celsius;
+}
+
+std::unique_ptr<ThermalController> LinearThrottleController::Clone() const {
+  return std::make_unique<LinearThrottleController>(*this);
+}
+
+// ============================================================================
+// PidThermalController
+// ============================================================================
+
+PidThermalController::PidThermalController(const PidThermalConfig& config)
+    : config_(config) {
+  Reset();
+}
+
+void PidThermalController::Reset() {
+  output_ = 1.0;
+  last_error_ = 0.0;
+  last_temperature_ = 0.0;
+  derivative_ = 0.0;
+  has_last_ = false;
+}
+
+double PidThermalController::Update(const ThermalSample& sample, double target_celsius) {
+  if (!std::isfinite(sample.temperature_celsius)) {
+    return output_;
+  }
+
+  double dt = std::max(sample.dt_seconds, 1e-3);
+  double error = (target_celsius - config_.margin_celsius) - sample.temperature_celsius;
+
+  if (!has_last_) {
+    // Первое измерение: пропорциональная реакция от полного потолка
+    output_ = Clamp(1.0 + config_.kp * error, config_.min_scale, 1.0);
+    last_error_ = error;
+    last_temperature_ = sample.temperature_celsius;
+    has_last_ = true;
+    return output_;
+  }
+
+  // Производная по измерению: рост температуры снижает потолок
+  double raw = -(sample.temperature_celsius - last_temperature_) / dt;
+  double derivative = config_.derivative_filter * derivative_ +
+                      (1.0 - config_.derivative_filter) * raw;
+
+  double delta = config_.kp * (error - last_error_) + config_.ki * error * dt +
+                 config_.kd * (derivative - derivative_);
+  output_ = Clamp(output_ + delta, config_.min_scale, 1.0);
+
+  derivative_ = derivative;
+  last_error_ = error;
+  last_temperature_ = sample.temperature_celsius;
+  return output_;
+}
+
+std::unique_ptr<ThermalController> PidThermalController::Clone() const {
+  return std::make_unique<PidThermalController>(*this);
+}
+
+// ============================================================================
+// RcThermalModel
+// ============================================================================
+
+double RcThermalModel::Predict(double temperature_celsius, double power_watts,
+                               double dt_seconds) const {
+  double steady = ambient_celsius + resistance_c_per_watt * power_watts;
+  return steady + (temperature_celsius - steady) * std::exp(-dt_seconds / time_constant_seconds);
+}
+
+bool RcThermalModel::Fit(const std::vector<ThermalTracePoint>& trace, RcThermalModel& model) {
+  // Дискретная форма при постоянном шаге dt:
+  //   T[k+1] = alpha * T[k] + (1 - alpha) * (T_amb + R * P[k+1]),
+  //   alpha = exp(-dt / tau).
+  // Мощность RAPL усреднена по интервалу, закончившемуся в k+1.
+  double ata[3][3] = {};
+  double atb[3] = {};
+  double dt_sum = 0.0;
+  size_t points = 0;
+
+  for (size_t k = 0; k + 1 < trace.size(); ++k) {
+    const ThermalTracePoint& now = trace[k];
+    const ThermalTracePoint& next = trace[k + 1];
+    double dt = next.time_seconds - now.time_seconds;
+    if (dt <= 0.0 || !std::isfinite(now.temperature_celsius) ||
+        !std::isfinite(next.temperature_celsius) || !std::isfinite(next.power_watts)) {
+      continue;
+    }
+
+    double row[3] = {now.temperature_celsius, 1.0, next.power_watts};
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        ata[i][j] += row[i] * row[j];
+      }
+      atb[i] += row[i] * next.temperature_celsius;
+    }
+    dt_sum += dt;
+    ++points;
+  }
+
+  if (points < kMinFitPoints) {
+    return false;
+  }
+
+  double x[3];
+  if (!Solve3x3(ata, atb, x)) {
+    return false;
+  }
+
+  double alpha = x[0];
+  if (!(alpha > 0.0 && alpha < 1.0)) {
+    return false;
+  }
+  double resistance = x[2] / (1.0 - alpha);
+  if (!(resistance > 0.0)) {
+    return false;
+  }
+
+  model.time_constant_seconds = -(dt_sum / points) / std::log(alpha);
+  model.resistance_c_per_watt = resistance;
+  model.ambient_celsius = x[1] / (1.0 - alpha);
+  return true;
+}
+
+// ============================================================================
+// MpcThermalController
+// ============================================================================
+
+MpcThermalController::MpcThermalController(const RcThermalModel& model,
+                                           const MpcThermalConfig& config)
+    : initial_model_(model), model_(model), config_(config) {
+  config_.candidate_count = std::max<size_t>(2, config_.candidate_count);
+  window_.resize(std::max(kMinFitPoints, config_.fit_window));
+  Reset();
+}
+
+void MpcThermalController::Reset() {
+  model_ = initial_model_;
+  dynamic_power_watts_ = config_.dynamic_power_watts;
+  last_scale_ = 1.0;
+  elapsed_seconds_ = 0.0;
+  window_head_ = 0;
+  samples_since_fit_ = 0;
+  std::fill(window_.begin(), window_.end(),
+            ThermalTracePoint{0.0, 0.0, std::numeric_limits<double>::quiet_NaN(), 0.0});
+}
+
+double MpcThermalController::PredictedPower(double scale) const {
+  return config_.idle_power_watts + dynamic_power_watts_ * scale * scale * scale;
+}
+
+void MpcThermalController::Learn(const ThermalSample& sample) {
+  elapsed_seconds_ += sample.dt_seconds;
+  if (!std::isfinite(sample.power_watts)) {
+    return;
+  }
+
+  // Мощность при полной частоте по текущему потолку (EMA)
+  if (last_scale_ > 0.2 && sample.power_watts > config_.idle_power_watts) {
+    double estimate = (sample.power_watts - config_.idle_power_watts) /
+                      (last_scale_ * last_scale_ * last_scale_);
+    dynamic_power_watts_ = 0.9 * dynamic_power_watts_ + 0.1 * estimate;
+  }
+
+  window_[window_head_] = {elapsed_seconds_, 0.0, sample.temperature_celsius,
+                           sample.power_watts};
+  window_head_ = (window_head_ + 1) % window_.size();
+
+  if (++samples_since_fit_ < config_.refit_interval) {
+    return;
+  }
+  samples_since_fit_ = 0;
+
+  std::vector<ThermalTracePoint> ordered;
+  ordered.reserve(window_.size());
+  for (size_t i = 0; i < window_.size(); ++i) {
+    const ThermalTracePoint& point = window_[(window_head_ + i) % window_.size()];
+    if (std::isfinite(point.temperature_celsius)) {
+      ordered.push_back(point);
+    }
+  }
+
+  RcThermalModel fitted;
+  if (RcThermalModel::Fit(ordered, fitted)) {
+    model_ = fitted;
+  }
+}
+
+double MpcThermalController::Update(const ThermalSample& sample, double target_celsius) {
+  if (!std::isfinite(sample.temperature_celsius)) {
+    return last_scale_;
+  }
+  Learn(sample);
+
+  double decay = std::exp(-config_.step_seconds / model_.time_constant_seconds);
+  double best_scale = last_scale_;
+  double best_cost = std::numeric_limits<double>::max();
+
+  for (size_t c = 0; c < config_.candidate_count; ++c) {
+    double scale = config_.min_scale + (1.0 - config_.min_scale) * c /
+                   (config_.candidate_count - 1);
+    double cost = config_.performance_weight * (1.0 - scale) * (1.0 - scale) +
+                  config_.move_weight * (scale - last_scale_) * (scale - last_scale_);
+
+    // Постоянный потолок на горизонте: T_h = T_inf + (T_0 - T_inf) * decay^h
+    double steady = model_.ambient_celsius + model_.resistance_c_per_watt * PredictedPower(scale);
+    double deviation = sample.temperature_celsius - steady;
+    for (size_t h = 0; h < config_.horizon_steps && cost < best_cost; ++h) {
+      deviation *= decay;
+      double over = steady + deviation - target_celsius;
+      if (over > 0.0) {
+        cost += config_.violation_weight * over * over;
+      }
+    }
+
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_scale = scale;
+    }
+  }
+
+  last_scale_ = best_scale;
+  return best_scale;
+}
+
+std::unique_ptr<ThermalController> MpcThermalController::Clone() const {
+  return std::make_unique<MpcThermalController>(*this);
+}
+
+// ============================================================================
+// Фабрика
+// ============================================================================
+
+std::unique_ptr<ThermalController> MakeThermalController(const std::string& name) {
+  if (name == "linear") {
+    return std::make_unique<LinearThrottleController>();
+  }
+  if (name == "pid") {
+    return std::make_unique<PidThermalController>();
+  }
+  if (name == "mpc") {
+    return std::make_unique<MpcThermalController>();
+  }
+  throw std::invalid_argument("Unknown thermal controller: " + name);
+}
+
+}  // namespace hardware_analysis
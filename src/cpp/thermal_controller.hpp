@@ -0,0 +1,206 @@
+#ifndef THERMAL_CONTROLLER_HPP
+#define THERMAL_CONTROLLER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Выборка температуры/мощности пакета за интервал
+ */
+struct ThermalSample {
+  double temperature_celsius;
+  double power_watts;          // NaN если RAPL недоступен
+  double dt_seconds;           // Время с прошлой выборки
+};
+
+/**
+ * @brief Интерфейс терморегулятора пакета
+ *
+ * Регулятор возвращает потолок частоты как долю max_frequency_mhz:
+ * 1.0 - без ограничения. Состояние (интеграл, модель) хранится внутри,
+ * поэтому на каждый пакет нужен свой экземпляр (см. Clone()).
+ */
+class ThermalController {
+ public:
+  virtual ~ThermalController() = default;
+
+  /**
+   * @brief Шаг регулятора
+   * @param sample Текущие измерения
+   * @param target_celsius Целевая температура
+   * @return Допустимая доля максимальной частоты (0, 1]
+   */
+  virtual double Update(const ThermalSample& sample, double target_celsius) = 0;
+
+  /**
+   * @brief Сброс внутреннего состояния
+   */
+  virtual void Reset() = 0;
+
+  virtual std::unique_ptr<ThermalController> Clone() const = 0;
+  virtual const char* Name() const = 0;
+};
+
+// ============================================================================
+// Линейный троттлинг (прежнее поведение CalculateOptimalFrequency)
+// ============================================================================
+
+/**
+ * @brief Потолок target/current только после перегрева
+ *
+ * Реагирует с опозданием и колеблется около цели; оставлен для сравнения.
+ */
+class LinearThrottleController : public ThermalController {
+ public:
+  double Update(const ThermalSample& sample, double target_celsius) override;
+  void Reset() override {}
+  std::unique_ptr<ThermalController> Clone() const override;
+  const char* Name() const override { return "linear"; }
+};
+
+// ============================================================================
+// PID
+// ============================================================================
+
+/**
+ * @brief Параметры PID регулятора
+ */
+struct PidThermalConfig {
+  double kp = 0.04;             // 1/°C
+  double ki = 0.02;             // 1/(°C*с)
+  double kd = 0.02;             // с/°C
+  double margin_celsius = 2.0;  // Уставка = цель - запас (опережение)
+  double min_scale = 0.3;       // Нижняя граница потолка
+  double derivative_filter = 0.5;  // Сглаживание производной (0 - нет, ->1 - сильное)
+};
+
+/**
+ * @brief PID по ошибке (уставка - T) в скоростной форме
+ *
+ * Потолок меняется на приращение P/I/D членов и ограничивается
+ * [min_scale, 1], поэтому интеграл не накапливается в насыщении
+ * (нет windup). Производная берётся по измерению (без скачка при смене
+ * уставки) и сглаживается, чтобы шум датчика не дёргал частоту.
+ */
+class PidThermalController : public ThermalController {
+ public:
+  explicit PidThermalController(const PidThermalConfig& config = PidThermalConfig());
+
+  double Update(const ThermalSample& sample, double target_celsius) override;
+  void Reset() override;
+  std::unique_ptr<ThermalController> Clone() const override;
+  const char* Name() const override { return "pid"; }
+
+ private:
+  PidThermalConfig config_;
+  double output_;
+  double last_error_;
+  double last_temperature_;
+  double derivative_;
+  bool has_last_;
+};
+
+// ============================================================================
+// RC модель и MPC
+// ============================================================================
+
+/**
+ * @brief Точка записанного термо-трейса пакета
+ */
+struct ThermalTracePoint {
+  double time_seconds;
+  double load_percent;          // Средняя загрузка CPU пакета
+  double temperature_celsius;
+  double power_watts;
+};
+
+/**
+ * @brief RC модель пакета: tau * dT/dt = T_amb + R * P - T
+ */
+struct RcThermalModel {
+  double ambient_celsius = 35.0;
+  double resistance_c_per_watt = 0.5;   // R: установившийся нагрев на ватт
+  double time_constant_seconds = 10.0;  // tau = R * C
+
+  /**
+   * @brief Температура через dt при постоянной мощности (точное решение)
+   */
+  double Predict(double temperature_celsius, double power_watts, double dt_seconds) const;
+
+  /**
+   * @brief Оценка параметров по трейсу методом наименьших квадратов
+   * @param trace Трейс с измеренной мощностью
+   * @param model [out] Найденная модель
+   * @return false если данных мало или параметры нефизичны
+   */
+  static bool Fit(const std::vector<ThermalTracePoint>& trace, RcThermalModel& model);
+};
+
+/**
+ * @brief Параметры MPC регулятора
+ */
+struct MpcThermalConfig {
+  size_t horizon_steps = 20;         // Горизонт прогноза
+  double step_seconds = 0.5;         // Шаг прогноза
+  size_t candidate_count = 15;       // Уровни потолка от min_scale до 1
+  double min_scale = 0.3;
+  double violation_weight = 100.0;   // Штраф за (T - цель)^2 выше цели
+  double performance_weight = 10.0;  // Штраф за (1 - scale)^2
+  double move_weight = 5.0;          // Штраф за (scale - прошлый)^2
+  double idle_power_watts = 10.0;    // P(scale) = idle + dynamic * scale^3
+  double dynamic_power_watts = 60.0; // Уточняется по измерениям
+  size_t fit_window = 256;           // Окно выборок для подстройки RC модели
+  size_t refit_interval = 32;        // Переоценка модели каждые N выборок
+};
+
+/**
+ * @brief Model-predictive регулятор на RC модели пакета
+ *
+ * На каждом шаге перебирает постоянный потолок частоты на горизонте,
+ * прогнозирует температуру по RC модели и выбирает потолок с минимальной
+ * стоимостью (превышение цели + потеря производительности + рывок).
+ * Заранее снижает частоту, если прогноз упирается в цель, и не тратит
+ * производительность, если запас есть. RC модель и мощность на полной
+ * частоте подстраиваются по собственным измерениям пакета.
+ */
+class MpcThermalController : public ThermalController {
+ public:
+  explicit MpcThermalController(const RcThermalModel& model = RcThermalModel(),
+                                const MpcThermalConfig& config = MpcThermalConfig());
+
+  double Update(const ThermalSample& sample, double target_celsius) override;
+  void Reset() override;
+  std::unique_ptr<ThermalController> Clone() const override;
+  const char* Name() const override { return "mpc"; }
+
+  const RcThermalModel& GetModel() const { return model_; }
+
+ private:
+  double PredictedPower(double scale) const;
+  void Learn(const ThermalSample& sample);
+
+  RcThermalModel initial_model_;
+  RcThermalModel model_;
+  MpcThermalConfig config_;
+  double dynamic_power_watts_;              // Оценка по измерениям
+  double last_scale_;
+  double elapsed_seconds_;
+  std::vector<ThermalTracePoint> window_;   // Кольцо для подстройки модели
+  size_t window_head_;
+  size_t samples_since_fit_;
+};
+
+/**
+ * @brief Создание регулятора по имени
+ * @param name "linear", "pid" или "mpc"
+ * @throws std::invalid_argument для неизвестного имени
+ */
+std::unique_ptr<ThermalController> MakeThermalController(const std::string& name);
+
+}  // namespace hardware_analysis
+
+#endif  // THERMAL_CONTROLLER_HPP
@@ -0,0 +1,206 @@
+#include "thermal_simulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr double kScaleChangeEpsilon = 1e-3;   // Меньшие изменения потолка не считаются
+
+}  // namespace
+
+// ============================================================================
+// PackagePowerModel
+// ============================================================================
+
+double PackagePowerModel::Power(double load_percent, double scale) const {
+  return idle_watts + dynamic_watts * (load_percent / 100.0) * scale * scale * scale;
+}
+
+bool PackagePowerModel::Fit(const std::vector<ThermalTracePoint>& trace,
+                            PackagePowerModel& model) {
+  double mean_load = 0.0;
+  double mean_power = 0.0;
+  size_t count = 0;
+  for (const auto& point : trace) {
+    if (std::isfinite(point.power_watts)) {
+      mean_load += point.load_percent / 100.0;
+      mean_power += point.power_watts;
+      ++count;
+    }
+  }
+  if (count < 2) {
+    return false;
+  }
+  mean_load /= count;
+  mean_power /= count;
+
+  double cov = 0.0;
+  double var = 0.0;
+  for (const auto& point : trace) {
+    if (std::isfinite(point.power_watts)) {
+      double dx = point.load_percent / 100.0 - mean_load;
+      cov += dx * (point.power_watts - mean_power);
+      var += dx * dx;
+    }
+  }
+  if (var < 1e-9 || cov <= 0.0) {
+    return false;
+  }
+
+  model.dynamic_watts = cov / var;
+  model.idle_watts = std::max(0.0, mean_power - model.dynamic_watts * mean_load);
+  return true;
+}
+
+// ============================================================================
+// ThermalSimulator
+// ============================================================================
+
+ThermalSimulator::ThermalSimulator(const RcThermalModel& plant, const PackagePowerModel& power)
+    : plant_(plant), power_(power) {}
+
+ThermalSimulator ThermalSimulator::FromTrace(const std::vector<ThermalTracePoint>& trace) {
+  RcThermalModel plant;
+  if (!RcThermalModel::Fit(trace, plant)) {
+    throw std::runtime_error("Trace does not constrain the RC thermal model "
+                             "(need >= 16 points with varying power)");
+  }
+  PackagePowerModel power;
+  if (!PackagePowerModel::Fit(trace, power)) {
+    throw std::runtime_error("Trace does not constrain the power model (load never changes)");
+  }
+  return ThermalSimulator(plant, power);
+}
+
+ThermalScore ThermalSimulator::Run(ThermalController& controller,
+                                   const std::vector<ThermalTracePoint>& trace,
+                                   double target_celsius) const {
+  ThermalScore score = {};
+  if (trace.size() < 2) {
+    return score;
+  }
+
+  controller.Reset();
+  double temperature = std::isfinite(trace.front().temperature_celsius)
+      ? trace.front().temperature_celsius : plant_.ambient_celsius;
+  double power = power_.Power(trace.front().load_percent, 1.0);
+
+  double last_scale = 1.0;
+  int last_direction = 0;
+  double variation = 0.0;
+  double delivered = 0.0;
+  double demanded = 0.0;
+  double temperature_time = 0.0;
+  double duration = 0.0;
+
+  for (size_t k = 1; k < trace.size(); ++k) {
+    double dt = trace[k].time_seconds - trace[k - 1].time_seconds;
+    if (dt <= 0.0) {
+      continue;
+    }
+
+    // Решение на следующий интервал по измерениям прошлого
+    double scale = controller.Update({temperature, power, dt}, target_celsius);
+    scale = std::max(0.0, std::min(1.0, scale));
+
+    power = power_.Power(trace[k].load_percent, scale);
+    temperature = plant_.Predict(temperature, power, dt);
+
+    double over = temperature - target_celsius;
+    score.max_overshoot_celsius = std::max(score.max_overshoot_celsius, over);
+    if (over > 0.0) {
+      score.overshoot_integral += over * dt;
+    }
+
+    double delta = scale - last_scale;
+    if (std::fabs(delta) > kScaleChangeEpsilon) {
+      variation += std::fabs(delta);
+      int direction = delta > 0.0 ? 1 : -1;
+      if (last_direction != 0 && direction != last_direction) {
+        ++score.reversals;
+      }
+      last_direction = direction;
+    }
+    last_scale = scale;
+
+    delivered += trace[k].load_percent * scale * dt;
+    demanded += trace[k].load_percent * dt;
+    temperature_time += temperature * dt;
+    duration += dt;
+  }
+
+  if (duration > 0.0) {
+    score.oscillation = variation / duration;
+    score.mean_temperature_celsius = temperature_time / duration;
+  }
+  score.lost_performance = demanded > 0.0 ? 1.0 - delivered / demanded : 0.0;
+  return score;
+}
+
+std::vector<ThermalTracePoint> ThermalSimulator::LoadGovernorLog(const std::string& path,
+                                                                 const std::vector<int>& cpus) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open governor log " + path);
+  }
+
+  std::vector<ThermalTracePoint> trace;
+  std::string line;
+  unsigned long long current_tick = 0;
+  double first_timestamp_us = -1.0;
+  double load_sum = 0.0;
+  size_t rows = 0;
+  ThermalTracePoint point = {};
+
+  auto flush = [&]() {
+    if (rows > 0) {
+      point.load_percent = load_sum / rows;
+      trace.push_back(point);
+    }
+    load_sum = 0.0;
+    rows = 0;
+  };
+
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#' || line.compare(0, 4, "tick") == 0) {
+      continue;
+    }
+
+    // tick,timestamp_us,cpu,load_percent,temperature_c,package_power_w,...
+    std::istringstream fields(line);
+    std::string field[6];
+    for (auto& value : field) {
+      std::getline(fields, value, ',');
+    }
+    unsigned long long tick = std::strtoull(field[0].c_str(), nullptr, 10);
+    int cpu = std::atoi(field[2].c_str());
+    if (!cpus.empty() && std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+      continue;
+    }
+
+    if (tick != current_tick) {
+      flush();
+      current_tick = tick;
+      double timestamp_us = std::strtod(field[1].c_str(), nullptr);
+      if (first_timestamp_us < 0.0) {
+        first_timestamp_us = timestamp_us;
+      }
+      point.time_seconds = (timestamp_us - first_timestamp_us) / 1e6;
+      point.temperature_celsius = std::strtod(field[4].c_str(), nullptr);
+      point.power_watts = std::strtod(field[5].c_str(), nullptr);
+    }
+    load_sum += std::strtod(field[3].c_str(), nullptr);
+    ++rows;
+  }
+  flush();
+
+  return trace;
+}
+
+}  // namespace hardware_analysis
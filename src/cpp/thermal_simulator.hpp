@@ -0,0 +1,87 @@
+#ifndef THERMAL_SIMULATOR_HPP
+#define THERMAL_SIMULATOR_HPP
+
+#include <string>
+#include <vector>
+
+#include "thermal_controller.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Мощность пакета: P = idle + dynamic * (load / 100) * scale^3
+ */
+struct PackagePowerModel {
+  double idle_watts = 10.0;
+  double dynamic_watts = 60.0;   // Полная загрузка на максимальной частоте
+
+  double Power(double load_percent, double scale) const;
+
+  /**
+   * @brief Оценка по трейсу, записанному без троттлинга (scale = 1)
+   * @return false если загрузка в трейсе не менялась
+   */
+  static bool Fit(const std::vector<ThermalTracePoint>& trace, PackagePowerModel& model);
+};
+
+/**
+ * @brief Оценка терморегулятора на трейсе
+ */
+struct ThermalScore {
+  double max_overshoot_celsius;   // max(T - цель, 0)
+  double overshoot_integral;      // °C*с выше цели
+  double oscillation;             // Суммарное изменение потолка в секунду
+  size_t reversals;               // Смены направления изменения потолка
+  double lost_performance;        // 1 - sum(load * scale) / sum(load)
+  double mean_temperature_celsius;
+};
+
+/**
+ * @brief Офлайн-прогон терморегулятора на записанной нагрузке
+ *
+ * Нагрузка берётся из трейса, температура пакета моделируется RC моделью
+ * (объект управления), мощность - PackagePowerModel от нагрузки и потолка
+ * частоты. Регулятор, как и в DvfsGovernor, видит мощность прошлого
+ * интервала. Оба модели обычно калибруются по тому же трейсу (FromTrace).
+ */
+class ThermalSimulator {
+ public:
+  ThermalSimulator(const RcThermalModel& plant, const PackagePowerModel& power);
+
+  /**
+   * @brief Симулятор с моделями, подогнанными по трейсу
+   * @throws std::runtime_error если трейс не позволяет оценить модели
+   */
+  static ThermalSimulator FromTrace(const std::vector<ThermalTracePoint>& trace);
+
+  /**
+   * @brief Прогон регулятора
+   * @param controller Регулятор (сбрасывается перед прогоном)
+   * @param trace Трейс нагрузки (температура используется как начальная)
+   * @param target_celsius Целевая температура
+   * @return Оценка
+   */
+  ThermalScore Run(ThermalController& controller, const std::vector<ThermalTracePoint>& trace,
+                   double target_celsius) const;
+
+  /**
+   * @brief Загрузка трейса из журнала решений DvfsGovernor (CSV)
+   * @param path Путь к журналу
+   * @param cpus CPU одного пакета (пусто - все строки тика)
+   * @return Точка на тик: средняя загрузка, температура и мощность пакета
+   * @throws std::runtime_error если файл не открывается
+   */
+  static std::vector<ThermalTracePoint> LoadGovernorLog(const std::string& path,
+                                                        const std::vector<int>& cpus = {});
+
+  const RcThermalModel& GetPlant() const { return plant_; }
+  const PackagePowerModel& GetPowerModel() const { return power_; }
+
+ private:
+  RcThermalModel plant_;
+  PackagePowerModel power_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // THERMAL_SIMULATOR_HPP
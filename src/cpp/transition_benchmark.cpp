@@ -0,0 +1,252 @@
+#include "transition_benchmark.hpp"
+#include "cpu_topology.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace hardware_analysis {
+
+namespace {
+
+constexpr uint32_t kMsrMperf = 0xE7;
+constexpr uint32_t kMsrAperf = 0xE8;
+constexpr uint64_t kCalibrationUs = 10000;
+constexpr uint64_t kCalibrationWindows = 10;
+constexpr uint64_t kSpinChunk = 256;
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedUs(Clock::time_point since) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - since).count();
+}
+
+/**
+ * @brief Цепочка зависимых умножений-сложений (LCG): такты на итерацию постоянны
+ */
+uint64_t SpinChain(uint64_t state, uint64_t iterations) {
+  for (uint64_t i = 0; i < iterations; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    asm volatile("" : "+r"(state));   // Запрет векторизации и свёртки цикла
+  }
+  return state;
+}
+
+}  // namespace
+
+// ============================================================================
+// AperfMperfProbe
+// ============================================================================
+
+AperfMperfProbe::AperfMperfProbe(int cpu_id, const std::string& msr_root, uint64_t window_us)
+    : msr_(cpu_id, msr_root), window_us_(window_us), base_mhz_(0.0),
+      last_aperf_(msr_.Read(kMsrAperf)), last_mperf_(msr_.Read(kMsrMperf)) {}
+
+void AperfMperfProbe::Calibrate(uint64_t /*known_mhz*/) {
+  // Скорость MPERF при занятом CPU = номинальная частота
+  uint64_t mperf_start = msr_.Read(kMsrMperf);
+  Clock::time_point started = Clock::now();
+  uint64_t state = 1;
+  while (ElapsedUs(started) < kCalibrationUs) {
+    state = SpinChain(state, kSpinChunk);
+  }
+  double elapsed_us = ElapsedUs(started);
+  base_mhz_ = (msr_.Read(kMsrMperf) - mperf_start) / elapsed_us;
+
+  last_aperf_ = msr_.Read(kMsrAperf);
+  last_mperf_ = msr_.Read(kMsrMperf);
+}
+
+double AperfMperfProbe::SampleMhz() {
+  Clock::time_point started = Clock::now();
+  uint64_t state = 1;
+  while (ElapsedUs(started) < window_us_) {
+    state = SpinChain(state, kSpinChunk);
+  }
+
+  uint64_t aperf = msr_.Read(kMsrAperf);
+  uint64_t mperf = msr_.Read(kMsrMperf);
+  uint64_t delta_aperf = aperf - last_aperf_;
+  uint64_t delta_mperf = mperf - last_mperf_;
+  last_aperf_ = aperf;
+  last_mperf_ = mperf;
+  return delta_mperf > 0 ? base_mhz_ * delta_aperf / delta_mperf : 0.0;
+}
+
+// ============================================================================
+// SpinLoopProbe
+// ============================================================================
+
+SpinLoopProbe::SpinLoopProbe(uint64_t window_us)
+    : window_us_(window_us), mhz_per_iteration_rate_(0.0) {}
+
+double SpinLoopProbe::IterationsPerSecond(uint64_t window_us) {
+  Clock::time_point started = Clock::now();
+  uint64_t iterations = 0;
+  uint64_t state = 1;
+  double elapsed_us = 0.0;
+  do {
+    state = SpinChain(state, kSpinChunk);
+    iterations += kSpinChunk;
+    elapsed_us = ElapsedUs(started);
+  } while (elapsed_us < window_us);
+  return iterations / elapsed_us * 1e6;
+}
+
+void SpinLoopProbe::Calibrate(uint64_t known_mhz) {
+  // Вытеснение потока только занижает скорость: берём лучшее из коротких окон
+  double best_rate = 0.0;
+  for (uint64_t window = 0; window < kCalibrationWindows; ++window) {
+    best_rate = std::max(best_rate, IterationsPerSecond(kCalibrationUs / kCalibrationWindows));
+  }
+  mhz_per_iteration_rate_ = known_mhz / best_rate;
+}
+
+double SpinLoopProbe::SampleMhz() {
+  return mhz_per_iteration_rate_ * IterationsPerSecond(window_us_);
+}
+
+// ============================================================================
+// TransitionBenchmark
+// ============================================================================
+
+TransitionBenchmark::TransitionBenchmark(OptimizationEngine& engine, ProbeFactory probes,
+                                         const TransitionBenchmarkConfig& config)
+    : engine_(engine), probes_(std::move(probes)), config_(config) {}
+
+ProbeFactory TransitionBenchmark::DefaultProbes(const std::string& msr_root, uint64_t window_us) {
+  return [msr_root, window_us](int cpu_id) -> std::unique_ptr<EffectiveFrequencyProbe> {
+    try {
+      return std::make_unique<AperfMperfProbe>(cpu_id, msr_root, window_us);
+    } catch (const MSRException& e) {
+      std::cerr << "Warning: no APERF/MPERF on cpu" << cpu_id
+                << ", using calibrated spin loop: " << e.what() << "\n";
+      return std::make_unique<SpinLoopProbe>(window_us);
+    }
+  };
+}
+
+bool TransitionBenchmark::SettleAt(EffectiveFrequencyProbe& probe, int cpu_id, uint64_t mhz) {
+  // Без установившейся исходной частоты переход измерялся бы от неизвестной точки
+  if (WaitForFrequency(probe, cpu_id, mhz) < 0.0) {
+    return false;
+  }
+  Clock::time_point started = Clock::now();
+  while (ElapsedUs(started) < config_.settle_us) {
+    probe.SampleMhz();
+  }
+  return true;
+}
+
+double TransitionBenchmark::WaitForFrequency(EffectiveFrequencyProbe& probe, int cpu_id,
+                                             uint64_t to_mhz) {
+  const double tolerance = to_mhz * config_.tolerance_percent / 100.0;
+  Clock::time_point started = Clock::now();
+  if (!engine_.SetCpuFrequency(cpu_id, to_mhz)) {
+    return -1.0;
+  }
+
+  size_t stable = 0;
+  double stable_since_us = 0.0;
+  while (true) {
+    double mhz = probe.SampleMhz();
+    double elapsed_us = ElapsedUs(started);
+    if (std::fabs(mhz - static_cast<double>(to_mhz)) <= tolerance) {
+      if (stable == 0) {
+        stable_since_us = elapsed_us;
+      }
+      if (++stable >= config_.stable_samples) {
+        return stable_since_us;
+      }
+    } else {
+      stable = 0;
+    }
+    if (elapsed_us >= config_.timeout_us) {
+      return -1.0;
+    }
+  }
+}
+
+std::vector<TransitionResult> TransitionBenchmark::Run() {
+  std::vector<TransitionResult> results;
+  if (config_.frequencies_mhz.size() < 2) {
+    return results;
+  }
+  uint64_t calibration_mhz = *std::max_element(config_.frequencies_mhz.begin(),
+                                               config_.frequencies_mhz.end());
+
+  ScopedAffinity affinity;
+  for (int cpu_id : config_.cpus) {
+    if (!affinity.Pin(cpu_id)) {
+      std::cerr << "Failed to pin benchmark thread to cpu" << cpu_id << ", skipping\n";
+      continue;
+    }
+    std::unique_ptr<EffectiveFrequencyProbe> probe = probes_(cpu_id);
+    if (!SettleAt(*probe, cpu_id, calibration_mhz)) {
+      std::cerr << "Warning: cpu" << cpu_id << " did not settle at " << calibration_mhz
+                << " MHz, probe calibration may be off\n";
+    }
+    probe->Calibrate(calibration_mhz);
+
+    for (uint64_t from_mhz : config_.frequencies_mhz) {
+      for (uint64_t to_mhz : config_.frequencies_mhz) {
+        if (from_mhz == to_mhz) {
+          continue;
+        }
+
+        TransitionResult result{cpu_id, from_mhz, to_mhz, 0, {}};
+        std::vector<double> latencies;
+        latencies.reserve(config_.repetitions);
+        for (size_t k = 0; k < config_.repetitions; ++k) {
+          // Исходная частота не установилась: повтор отбрасывается как таймаут
+          double latency_us = SettleAt(*probe, cpu_id, from_mhz)
+                                  ? WaitForFrequency(*probe, cpu_id, to_mhz)
+                                  : -1.0;
+          if (latency_us < 0.0) {
+            ++result.timeouts;
+          } else {
+            latencies.push_back(latency_us);
+          }
+        }
+        result.latency_us = DistributionSummary::FromSamples(std::move(latencies));
+        results.push_back(result);
+      }
+    }
+  }
+  return results;
+}
+
+void TransitionBenchmark::StoreInProfile(const std::vector<TransitionResult>& results,
+                                         MachineProfile& profile) {
+  boost::property_tree::ptree section;
+  std::vector<double> p99_by_transition;
+  size_t timeouts = 0;
+
+  for (const auto& result : results) {
+    boost::property_tree::ptree entry;
+    result.latency_us.Store(entry);
+    entry.put("timeouts", result.timeouts);
+    section.put_child("cpu" + std::to_string(result.cpu_id) + "." +
+                      std::to_string(result.from_mhz) + "-" + std::to_string(result.to_mhz),
+                      entry);
+    if (result.latency_us.count > 0) {
+      p99_by_transition.push_back(result.latency_us.p99);
+    }
+    timeouts += result.timeouts;
+  }
+
+  // Сводка - распределение p99 по переходам: худший переход задаёт период
+  DistributionSummary summary = DistributionSummary::FromSamples(p99_by_transition);
+  boost::property_tree::ptree summary_tree;
+  summary.Store(summary_tree);
+  section.put_child("summary_p99_us", summary_tree);
+  section.put("timeouts", timeouts);
+  section.put("min_governor_interval_ms",
+              std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(2.0 * summary.max / 1000.0))));
+
+  profile.Data().put_child("frequency_transition", section);
+}
+
+}  // namespace hardware_analysis
@@ -0,0 +1,179 @@
+#ifndef TRANSITION_BENCHMARK_HPP
+#define TRANSITION_BENCHMARK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_report.hpp"
+#include "hardware_monitor.hpp"
+#include "machine_profile.hpp"
+#include "optimization_engine.hpp"
+
+namespace hardware_analysis {
+
+/**
+ * @brief Измеритель эффективной частоты CPU, на котором выполняется поток
+ *
+ * SampleMhz() занимает CPU на одно окно измерения (поток держится в C0) и
+ * возвращает среднюю частоту за это окно.
+ */
+class EffectiveFrequencyProbe {
+ public:
+  virtual ~EffectiveFrequencyProbe() = default;
+
+  /**
+   * @brief Калибровка на уже закреплённом за CPU потоке
+   * @param known_mhz Установленная сейчас частота (нужна измерителям без MSR)
+   */
+  virtual void Calibrate(uint64_t known_mhz) = 0;
+
+  /**
+   * @brief Эффективная частота за одно окно
+   */
+  virtual double SampleMhz() = 0;
+
+  virtual const char* Name() const = 0;
+};
+
+/**
+ * @brief Эффективная частота по IA32_APERF (0xE8) / IA32_MPERF (0xE7)
+ *
+ * MPERF тикает с номинальной частотой в C0, APERF - с фактической:
+ * f = f_base * dAPERF / dMPERF. f_base измеряется в Calibrate() по
+ * скорости MPERF.
+ */
+class AperfMperfProbe : public EffectiveFrequencyProbe {
+ public:
+  /**
+   * @throws MSRException если MSR CPU недоступен
+   */
+  AperfMperfProbe(int cpu_id, const std::string& msr_root, uint64_t window_us);
+
+  void Calibrate(uint64_t known_mhz) override;
+  double SampleMhz() override;
+  const char* Name() const override { return "aperf/mperf"; }
+
+ private:
+  MSRReader msr_;
+  uint64_t window_us_;
+  double base_mhz_;
+  uint64_t last_aperf_;
+  uint64_t last_mperf_;
+};
+
+/**
+ * @brief Эффективная частота по скорости калиброванной цепочки зависимых операций
+ *
+ * Для машин без доступа к MSR. Цепочка умножений-сложений выполняется за
+ * фиксированное число тактов на итерацию, поэтому итерации/нс
+ * пропорциональны частоте; коэффициент задаётся в Calibrate().
+ */
+class SpinLoopProbe : public EffectiveFrequencyProbe {
+ public:
+  explicit SpinLoopProbe(uint64_t window_us);
+
+  void Calibrate(uint64_t known_mhz) override;
+  double SampleMhz() override;
+  const char* Name() const override { return "spin-loop"; }
+
+ private:
+  /**
+   * @brief Итераций цепочки в секунду за window_us
+   */
+  double IterationsPerSecond(uint64_t window_us);
+
+  uint64_t window_us_;
+  double mhz_per_iteration_rate_;   // МГц на (итерация/с)
+};
+
+/**
+ * @brief Фабрика измерителя для CPU
+ */
+using ProbeFactory = std::function<std::unique_ptr<EffectiveFrequencyProbe>(int cpu_id)>;
+
+/**
+ * @brief Параметры бенчмарка переходов частоты
+ */
+struct TransitionBenchmarkConfig {
+  std::vector<int> cpus = {0};
+  std::vector<uint64_t> frequencies_mhz;   // Проверяются все упорядоченные пары
+  size_t repetitions = 10;
+  double tolerance_percent = 3.0;          // Допуск "частота установилась"
+  size_t stable_samples = 5;               // Подряд в допуске
+  uint64_t timeout_us = 50000;
+  uint64_t settle_us = 20000;              // Выдержка на исходной частоте
+};
+
+/**
+ * @brief Распределение латентности одного перехода на одном CPU
+ */
+struct TransitionResult {
+  int cpu_id;
+  uint64_t from_mhz;
+  uint64_t to_mhz;
+  size_t timeouts;                  // Повторы без установившейся исходной или целевой частоты
+  DistributionSummary latency_us;   // От записи до первой выборки устойчивого участка
+};
+
+/**
+ * @brief Бенчмарк латентности и установления переходов частоты
+ *
+ * Частота пишется через OptimizationEngine::SetCpuFrequency (как у
+ * DvfsGovernor), поток закрепляется за измеряемым CPU и опрашивает
+ * измеритель, пока stable_samples выборок подряд не попадут в допуск.
+ * p99 латентности задаёт минимальный осмысленный период губернатора.
+ */
+class TransitionBenchmark {
+ public:
+  TransitionBenchmark(OptimizationEngine& engine, ProbeFactory probes,
+                      const TransitionBenchmarkConfig& config);
+
+  /**
+   * @brief Прогон по всем CPU и парам частот
+   * @return Результаты (cpu, from, to) в порядке обхода
+   */
+  std::vector<TransitionResult> Run();
+
+  /**
+   * @brief APERF/MPERF, а без доступа к MSR - калиброванный цикл
+   * @param msr_root Каталог устройств msr
+   * @param window_us Окно одной выборки
+   */
+  static ProbeFactory DefaultProbes(const std::string& msr_root = "/dev/cpu",
+                                    uint64_t window_us = 20);
+
+  /**
+   * @brief Запись результатов в профиль (раздел frequency_transition)
+   *
+   * Пишет распределения по CPU и переходам, сводку по всем переходам и
+   * min_governor_interval_ms = 2 * max(p99 переходов): худший переход, не
+   * меньше 1 мс.
+   */
+  static void StoreInProfile(const std::vector<TransitionResult>& results,
+                             MachineProfile& profile);
+
+ private:
+  /**
+   * @brief Запись частоты и ожидание stable_samples выборок в допуске
+   * @return Мкс от записи до первой выборки устойчивого участка или -1
+   */
+  double WaitForFrequency(EffectiveFrequencyProbe& probe, int cpu_id, uint64_t to_mhz);
+
+  /**
+   * @brief Переход на исходную частоту и выдержка settle_us после установления
+   * @return false если частота не установилась за timeout_us
+   */
+  bool SettleAt(EffectiveFrequencyProbe& probe, int cpu_id, uint64_t mhz);
+
+  OptimizationEngine& engine_;
+  ProbeFactory probes_;
+  TransitionBenchmarkConfig config_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // TRANSITION_BENCHMARK_HPP
@@ -0,0 +1,357 @@
+#include "workload_classifier.hpp"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "hardware_monitor.hpp"
+
+namespace hardware_analysis {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long PerfEventOpen(perf_event_attr* attr, int pid, int cpu, int group_fd) {
+  return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+double Ratio(double numerator, double denominator) {
+  return denominator > 0.0 ? numerator / denominator
+                           : std::numeric_limits<double>::quiet_NaN();
+}
+
+}  // namespace
+
+const char* WorkloadPhaseName(WorkloadPhase phase) {
+  switch (phase) {
+    case WorkloadPhase::kIdle:
+      return "idle";
+    case WorkloadPhase::kCompute:
+      return "compute";
+    case WorkloadPhase::kMixed:
+      return "mixed";
+    case WorkloadPhase::kMemory:
+      return "memory";
+  }
+  return "unknown";
+}
+
+PhaseFeatures PhaseFeatures::Unknown() {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  return {nan, nan, nan, nan, nan};
+}
+
+// ============================================================================
+// PerfEventCounterSource
+// ============================================================================
+
+PerfEventCounterSource::PerfEventCounterSource(const std::vector<int>& cpus, int pid)
+    : last_sample_(Clock::now()) {
+  const uint64_t configs[kEventCount] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,              // Обычно LLC misses
+      PERF_COUNT_HW_STALLED_CYCLES_BACKEND,    // Есть не на всех моделях
+  };
+
+  for (int cpu : cpus) {
+    CpuCounters counters = {};
+    counters.cpu_id = cpu;
+    std::fill(std::begin(counters.fds), std::end(counters.fds), -1);
+    std::fill(std::begin(counters.slot), std::end(counters.slot), -1);
+
+    for (int event = 0; event < kEventCount; ++event) {
+      perf_event_attr attr = {};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[event];
+      attr.disabled = event == kCycles ? 1 : 0;
+      attr.exclude_hv = 1;
+      attr.exclude_kernel = pid >= 0 ? 1 : 0;   // perf_event_paranoid 2 разрешает только user
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      long fd = PerfEventOpen(&attr, pid, pid >= 0 ? -1 : cpu,
+                              event == kCycles ? -1 : counters.fds[kCycles]);
+      if (fd < 0) {
+        int error = errno;
+        if (event <= kInstructions) {
+          for (int opened : counters.fds) {
+            if (opened >= 0) {
+              close(opened);
+            }
+          }
+          for (auto& other : counters_) {
+            for (int opened : other.fds) {
+              if (opened >= 0) {
+                close(opened);
+              }
+            }
+          }
+          counters_.clear();
+          throw std::runtime_error("perf_event_open failed for cpu" + std::to_string(cpu) +
+                                   ": " + std::strerror(error) +
+                                   " (hardware PMU and perf_event_paranoid <= 0 or "
+                                   "CAP_PERFMON required)");
+        }
+        continue;
+      }
+      counters.fds[event] = static_cast<int>(fd);
+      counters.slot[event] = static_cast<int>(counters.opened++);
+    }
+
+    ioctl(counters.fds[kCycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters.fds[kCycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    counters_.push_back(counters);
+    if (pid >= 0) {
+      break;   // Счётчики потока не привязаны к CPU
+    }
+  }
+  buffer_.resize(3 + kEventCount);
+}
+
+PerfEventCounterSource::~PerfEventCounterSource() {
+  for (auto& counters : counters_) {
+    for (int fd : counters.fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+}
+
+bool PerfEventCounterSource::Sample(std::vector<PhaseFeatures>& features) {
+  Clock::time_point now = Clock::now();
+  double seconds = std::chrono::duration<double>(now - last_sample_).count();
+  last_sample_ = now;
+
+  bool ok = true;
+  for (auto& counters : counters_) {
+    // Формат группы: nr, time_enabled, time_running, значения
+    size_t bytes = (3 + counters.opened) * sizeof(uint64_t);
+    if (read(counters.fds[kCycles], buffer_.data(), bytes) != static_cast<ssize_t>(bytes)) {
+      ok = false;
+      continue;
+    }
+
+    uint64_t delta[kEventCount] = {};
+    for (int event = 0; event < kEventCount; ++event) {
+      if (counters.slot[event] >= 0) {
+        uint64_t value = buffer_[3 + counters.slot[event]];
+        delta[event] = value - counters.last[event];
+        counters.last[event] = value;
+      }
+    }
+    uint64_t enabled = buffer_[1] - counters.last_enabled;
+    uint64_t running = buffer_[2] - counters.last_running;
+    counters.last_enabled = buffer_[1];
+    counters.last_running = buffer_[2];
+
+    if (counters.cpu_id < 0 || static_cast<size_t>(counters.cpu_id) >= features.size()) {
+      continue;
+    }
+    // Отношения внутри группы не зависят от мультиплексирования, абсолютные - масштабируем
+    double scale = running > 0 ? static_cast<double>(enabled) / running : 0.0;
+    double cycles = static_cast<double>(delta[kCycles]);
+    double instructions = static_cast<double>(delta[kInstructions]);
+
+    PhaseFeatures& f = features[counters.cpu_id];
+    f = PhaseFeatures::Unknown();
+    f.instructions_per_second = seconds > 0.0 ? instructions * scale / seconds : 0.0;
+    f.ipc = Ratio(instructions, cycles);
+    if (counters.slot[kLlcMisses] >= 0) {
+      f.llc_mpki = Ratio(1000.0 * delta[kLlcMisses], instructions);
+    }
+    if (counters.slot[kBackendStalls] >= 0) {
+      f.stall_ratio = Ratio(static_cast<double>(delta[kBackendStalls]), cycles);
+    }
+  }
+  return ok;
+}
+
+// ============================================================================
+// ResctrlBandwidthSource
+// ============================================================================
+
+ResctrlBandwidthSource::ResctrlBandwidthSource(const std::string& resctrl_root,
+                                               const std::string& sysfs_cpu_root,
+                                               const std::vector<int>& cpus)
+    : last_sample_(Clock::now()) {
+  for (int cpu : cpus) {
+    uint64_t l3_id = 0;
+    try {
+      l3_id = utils::ReadSysfsU64(sysfs_cpu_root + "/cpu" + std::to_string(cpu) +
+                                  "/cache/index3/id");
+    } catch (const std::exception&) {
+      continue;
+    }
+
+    char domain_name[32];
+    std::snprintf(domain_name, sizeof(domain_name), "mon_L3_%02llu",
+                  static_cast<unsigned long long>(l3_id));
+    std::string path = resctrl_root + "/mon_data/" + domain_name + "/mbm_total_bytes";
+
+    auto domain = std::find_if(domains_.begin(), domains_.end(),
+                               [&path](const Domain& d) { return d.path == path; });
+    if (domain == domains_.end()) {
+      uint64_t bytes = 0;
+      try {
+        bytes = utils::ReadSysfsU64(path);
+      } catch (const std::exception&) {
+        continue;
+      }
+      domains_.push_back({path, {}, bytes});
+      domain = domains_.end() - 1;
+    }
+    domain->cpus.push_back(cpu);
+  }
+
+  if (domains_.empty()) {
+    throw std::runtime_error("resctrl memory bandwidth monitoring unavailable at " +
+                             resctrl_root);
+  }
+}
+
+bool ResctrlBandwidthSource::Sample(std::vector<PhaseFeatures>& features) {
+  Clock::time_point now = Clock::now();
+  double seconds = std::chrono::duration<double>(now - last_sample_).count();
+  last_sample_ = now;
+
+  bool ok = true;
+  for (auto& domain : domains_) {
+    uint64_t bytes = 0;
+    try {
+      bytes = utils::ReadSysfsU64(domain.path);
+    } catch (const std::exception&) {
+      ok = false;
+      continue;
+    }
+    double gbs = seconds > 0.0 ? (bytes - domain.last_bytes) / seconds / 1e9 : 0.0;
+    domain.last_bytes = bytes;
+
+    for (int cpu : domain.cpus) {
+      if (static_cast<size_t>(cpu) < features.size()) {
+        features[cpu] = PhaseFeatures::Unknown();
+        features[cpu].bandwidth_gbs = gbs / domain.cpus.size();
+      }
+    }
+  }
+  return ok;
+}
+
+std::unique_ptr<WorkloadCounterSource> MakeWorkloadCounterSource(
+    const std::vector<int>& cpus, const std::string& sysfs_cpu_root,
+    const std::string& resctrl_root) {
+  try {
+    return std::make_unique<PerfEventCounterSource>(cpus);
+  } catch (const std::exception& perf_error) {
+    try {
+      auto source = std::make_unique<ResctrlBandwidthSource>(resctrl_root, sysfs_cpu_root, cpus);
+      std::cerr << "Warning: " << perf_error.what()
+                << "; classifying by resctrl memory bandwidth\n";
+      return source;
+    } catch (const std::exception& resctrl_error) {
+      std::cerr << "Warning: workload classification disabled: " << perf_error.what()
+                << "; " << resctrl_error.what() << "\n";
+    }
+  }
+  return nullptr;
+}
+
+// ============================================================================
+// WorkloadClassifier
+// ============================================================================
+
+WorkloadClassifier::WorkloadClassifier(const WorkloadClassifierConfig& config)
+    : config_(config) {}
+
+WorkloadPhase WorkloadClassifier::Classify(const PhaseFeatures& f) const {
+  if (std::isfinite(f.instructions_per_second) &&
+      f.instructions_per_second < config_.idle_max_gips * 1e9) {
+    return WorkloadPhase::kIdle;
+  }
+
+  // Доля циклов ожидания - самый прямой признак
+  if (std::isfinite(f.stall_ratio)) {
+    if (f.stall_ratio >= config_.memory_min_stall_ratio) {
+      return WorkloadPhase::kMemory;
+    }
+    return f.stall_ratio <= config_.compute_max_stall_ratio ? WorkloadPhase::kCompute
+                                                            : WorkloadPhase::kMixed;
+  }
+
+  if (std::isfinite(f.llc_mpki)) {
+    if (f.llc_mpki >= config_.memory_min_mpki ||
+        (f.llc_mpki >= config_.compute_max_mpki && std::isfinite(f.ipc) &&
+         f.ipc <= config_.memory_max_ipc)) {
+      return WorkloadPhase::kMemory;
+    }
+    return f.llc_mpki < config_.compute_max_mpki ? WorkloadPhase::kCompute
+                                                 : WorkloadPhase::kMixed;
+  }
+
+  if (std::isfinite(f.bandwidth_gbs)) {
+    if (f.bandwidth_gbs >= config_.memory_min_bandwidth_gbs) {
+      return WorkloadPhase::kMemory;
+    }
+    return f.bandwidth_gbs >= config_.mixed_min_bandwidth_gbs ? WorkloadPhase::kMixed
+                                                              : WorkloadPhase::kCompute;
+  }
+
+  return WorkloadPhase::kCompute;   // Нет данных - без ограничения
+}
+
+double WorkloadClassifier::FrequencyScale(WorkloadPhase phase,
+                                          const PhaseFeatures& features) const {
+  if (phase != WorkloadPhase::kMemory) {
+    return 1.0;
+  }
+  double sensitivity = std::isfinite(features.stall_ratio)
+      ? std::max(0.0, 1.0 - features.stall_ratio)
+      : config_.memory_sensitivity;
+  double scale = sensitivity / (sensitivity + config_.max_slowdown);
+  return std::max(config_.min_scale, std::min(1.0, scale));
+}
+
+double WorkloadClassifier::Update(int cpu_id, const PhaseFeatures& features) {
+  if (cpu_id < 0) {
+    return 1.0;
+  }
+  if (static_cast<size_t>(cpu_id) >= cpus_.size()) {
+    cpus_.resize(cpu_id + 1);
+  }
+
+  CpuState& state = cpus_[cpu_id];
+  WorkloadPhase observed = Classify(features);
+  if (observed == state.phase) {
+    state.candidate_samples = 0;
+  } else {
+    if (observed != state.candidate) {
+      state.candidate = observed;
+      state.candidate_samples = 0;
+    }
+    if (++state.candidate_samples >= config_.stable_samples) {
+      state.phase = observed;
+      state.candidate_samples = 0;
+    }
+  }
+  return FrequencyScale(state.phase, features);
+}
+
+WorkloadPhase WorkloadClassifier::GetPhase(int cpu_id) const {
+  if (cpu_id < 0 || static_cast<size_t>(cpu_id) >= cpus_.size()) {
+    return WorkloadPhase::kCompute;
+  }
+  return cpus_[cpu_id].phase;
+}
+
+}  // namespace hardware_analysis
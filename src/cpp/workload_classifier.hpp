@@ -0,0 +1,212 @@
+#ifndef WORKLOAD_CLASSIFIER_HPP
+#define WORKLOAD_CLASSIFIER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Фаза нагрузки CPU
+ */
+enum class WorkloadPhase {
+  kIdle,
+  kCompute,    // Время масштабируется с частотой
+  kMixed,
+  kMemory,     // Упор в память: частоту можно снизить почти без потерь
+};
+
+const char* WorkloadPhaseName(WorkloadPhase phase);
+
+/**
+ * @brief Признаки фазы CPU за интервал (NaN - признак недоступен)
+ */
+struct PhaseFeatures {
+  double instructions_per_second;
+  double ipc;
+  double llc_mpki;           // Промахи LLC на 1000 инструкций
+  double stall_ratio;        // Доля циклов ожидания backend (памяти)
+  double bandwidth_gbs;      // Пропускная способность памяти на CPU (прокси)
+
+  static PhaseFeatures Unknown();
+};
+
+// ============================================================================
+// Источники признаков
+// ============================================================================
+
+/**
+ * @brief Источник признаков для набора CPU
+ */
+class WorkloadCounterSource {
+ public:
+  virtual ~WorkloadCounterSource() = default;
+
+  /**
+   * @brief Признаки за интервал с прошлого вызова
+   * @param features [out] Признаки по cpu_id (размер не меньше max cpu + 1)
+   * @return false если чтение не удалось
+   */
+  virtual bool Sample(std::vector<PhaseFeatures>& features) = 0;
+
+  virtual const char* Name() const = 0;
+};
+
+/**
+ * @brief Счётчики perf_event_open по CPU: cycles, instructions, LLC misses,
+ *        stalled-cycles-backend (если поддерживается)
+ *
+ * Считает весь CPU (pid = -1), поэтому требует perf_event_paranoid <= 0
+ * или CAP_PERFMON. Мультиплексирование учитывается через time_running.
+ */
+class PerfEventCounterSource : public WorkloadCounterSource {
+ public:
+  /**
+   * @param cpus CPU для измерения
+   * @param pid -1 - весь CPU; >= 0 - только процесс/поток pid (для самопроверки)
+   * @throws std::runtime_error если cycles/instructions не открываются
+   */
+  explicit PerfEventCounterSource(const std::vector<int>& cpus, int pid = -1);
+  ~PerfEventCounterSource() override;
+
+  PerfEventCounterSource(const PerfEventCounterSource&) = delete;
+  PerfEventCounterSource& operator=(const PerfEventCounterSource&) = delete;
+
+  bool Sample(std::vector<PhaseFeatures>& features) override;
+  const char* Name() const override { return "perf"; }
+
+ private:
+  enum Event { kCycles = 0, kInstructions, kLlcMisses, kBackendStalls, kEventCount };
+
+  struct CpuCounters {
+    int cpu_id;
+    int fds[kEventCount];
+    int slot[kEventCount];        // Позиция события в чтении группы, -1 = не открыто
+    uint64_t last[kEventCount];
+    uint64_t last_enabled;
+    uint64_t last_running;
+    size_t opened;
+  };
+
+  std::vector<CpuCounters> counters_;
+  std::vector<uint64_t> buffer_;
+  std::chrono::steady_clock::time_point last_sample_;
+};
+
+/**
+ * @brief Прокси по пропускной способности памяти: resctrl MBM
+ *
+ * Читает mon_data/mon_L3_XX/mbm_total_bytes корневой группы resctrl и
+ * делит пропускную способность домена L3 поровну между его CPU. IPC и
+ * промахи недоступны.
+ */
+class ResctrlBandwidthSource : public WorkloadCounterSource {
+ public:
+  /**
+   * @param resctrl_root Точка монтирования resctrl
+   * @param sysfs_cpu_root Корень sysfs cpu (cache/index3/id)
+   * @param cpus CPU для измерения
+   * @throws std::runtime_error если MBM недоступен
+   */
+  ResctrlBandwidthSource(const std::string& resctrl_root, const std::string& sysfs_cpu_root,
+                         const std::vector<int>& cpus);
+
+  bool Sample(std::vector<PhaseFeatures>& features) override;
+  const char* Name() const override { return "resctrl-mbm"; }
+
+ private:
+  struct Domain {
+    std::string path;             // .../mbm_total_bytes
+    std::vector<int> cpus;
+    uint64_t last_bytes;
+  };
+
+  std::vector<Domain> domains_;
+  std::chrono::steady_clock::time_point last_sample_;
+};
+
+/**
+ * @brief perf, иначе resctrl MBM, иначе nullptr (с предупреждением)
+ */
+std::unique_ptr<WorkloadCounterSource> MakeWorkloadCounterSource(
+    const std::vector<int>& cpus,
+    const std::string& sysfs_cpu_root = "/sys/devices/system/cpu",
+    const std::string& resctrl_root = "/sys/fs/resctrl");
+
+// ============================================================================
+// Классификатор
+// ============================================================================
+
+/**
+ * @brief Пороги классификатора
+ */
+struct WorkloadClassifierConfig {
+  double idle_max_gips = 0.05;          // Меньше 50 млн инструкций/с - простой
+  double memory_min_stall_ratio = 0.5;
+  double compute_max_stall_ratio = 0.2;
+  double memory_min_mpki = 10.0;
+  double memory_max_ipc = 0.8;          // Вместе с mpki >= compute_max_mpki
+  double compute_max_mpki = 2.0;
+  double memory_min_bandwidth_gbs = 4.0;   // Прокси: ГБ/с на CPU
+  double mixed_min_bandwidth_gbs = 1.5;
+  double memory_sensitivity = 0.3;      // Доля времени, масштабируемая частотой, без stall
+  double max_slowdown = 0.10;           // Допустимое замедление фазы памяти
+  double min_scale = 0.5;               // Нижняя граница потолка (доля max частоты)
+  size_t stable_samples = 2;            // Выборок подряд для смены фазы
+};
+
+/**
+ * @brief Классификация фаз CPU и потолок частоты для фаз памяти
+ *
+ * Время фазы моделируется как (1 - b) + b * f_max / f, где b - доля,
+ * масштабируемая частотой (1 - stall_ratio или memory_sensitivity).
+ * Потолок f / f_max = b / (b + max_slowdown) ограничивает замедление
+ * величиной max_slowdown. Фаза меняется только после stable_samples
+ * одинаковых выборок подряд.
+ */
+class WorkloadClassifier {
+ public:
+  explicit WorkloadClassifier(const WorkloadClassifierConfig& config = {});
+
+  /**
+   * @brief Фаза по признакам одного интервала (без гистерезиса)
+   */
+  WorkloadPhase Classify(const PhaseFeatures& features) const;
+
+  /**
+   * @brief Потолок частоты для фазы
+   * @return Доля max частоты в [min_scale, 1]
+   */
+  double FrequencyScale(WorkloadPhase phase, const PhaseFeatures& features) const;
+
+  /**
+   * @brief Шаг классификатора CPU с гистерезисом
+   * @return Потолок частоты (доля max) для текущей фазы
+   */
+  double Update(int cpu_id, const PhaseFeatures& features);
+
+  /**
+   * @brief Текущая (устойчивая) фаза CPU
+   */
+  WorkloadPhase GetPhase(int cpu_id) const;
+
+  const WorkloadClassifierConfig& GetConfig() const { return config_; }
+
+ private:
+  struct CpuState {
+    WorkloadPhase phase = WorkloadPhase::kCompute;
+    WorkloadPhase candidate = WorkloadPhase::kCompute;
+    size_t candidate_samples = 0;
+  };
+
+  WorkloadClassifierConfig config_;
+  std::vector<CpuState> cpus_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // WORKLOAD_CLASSIFIER_HPP
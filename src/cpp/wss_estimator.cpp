@@ -0,0 +1,67 @@
+#include "wss_estimator.hpp"
+#include <iomanip>
+
+namespace hardware_analysis {
+
+WorkingSetEstimator::WorkingSetEstimator(pid_t pid, const PageScanConfig& config,
+                                         size_t max_history)
+    : scanner_(pid, config),
+      max_history_(max_history),
+      window_accessed_(0),
+      window_present_(0),
+      start_(std::chrono::steady_clock::now()),
+      window_start_(start_),
+      alive_(true),
+      cpu_seconds_(0.0) {}
+
+bool WorkingSetEstimator::Sample(WssSample& sample) {
+  if (!alive_) {
+    return false;
+  }
+  accessed_.clear();
+  written_.clear();
+  PageScanStats stats = scanner_.Scan(accessed_, written_);
+  cpu_seconds_ += stats.cpu_seconds;
+  if (!stats.process_alive) {
+    alive_ = false;
+    return false;
+  }
+  window_accessed_ += stats.pages_accessed;
+  window_present_ += stats.pages_present;
+  if (!stats.cycle_complete) {
+    return false;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  bool priming = stats.priming;
+  WssSample window;
+  window.pid = scanner_.pid();
+  window.time_seconds = std::chrono::duration<double>(now - start_).count();
+  window.window_seconds = std::chrono::duration<double>(now - window_start_).count();
+  window.accessed_pages = window_accessed_;
+  window.present_pages = window_present_;
+  window_start_ = now;
+  window_accessed_ = 0;
+  window_present_ = 0;
+  if (priming) {
+    return false;   // Страницы только отмечены: окно начинается сейчас
+  }
+
+  if (max_history_ > 0 && history_.size() >= max_history_) {
+    history_.pop_front();
+  }
+  history_.push_back(window);
+  sample = window;
+  return true;
+}
+
+void WorkingSetEstimator::WriteCsv(std::ostream& out) const {
+  out << "pid,time_s,window_s,wss_bytes,rss_bytes\n";
+  for (const WssSample& sample : history_) {
+    out << sample.pid << "," << std::fixed << std::setprecision(3) << sample.time_seconds << ","
+        << sample.window_seconds << "," << sample.WssBytes() << "," << sample.RssBytes()
+        << "\n";
+  }
+}
+
+}  // namespace hardware_analysis
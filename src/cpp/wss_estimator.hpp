@@ -0,0 +1,84 @@
+#ifndef WSS_ESTIMATOR_HPP
+#define WSS_ESTIMATOR_HPP
+
+#include "page_tracer.hpp"
+#include <sys/types.h>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace hardware_analysis {
+
+/**
+ * @brief Рабочий набор процесса за одно окно
+ */
+struct WssSample {
+  pid_t pid = 0;
+  double time_seconds = 0.0;         // Конец окна от создания оценщика
+  double window_seconds = 0.0;       // Длина окна: время одного цикла обхода
+  uint64_t accessed_pages = 0;       // Тронутые за окно
+  uint64_t present_pages = 0;        // Резидентные (RSS по pagemap)
+
+  uint64_t WssBytes() const { return accessed_pages * PageAccessScanner::kPageBytes; }
+  uint64_t RssBytes() const { return present_pages * PageAccessScanner::kPageBytes; }
+};
+
+/**
+ * @brief Оценка рабочего набора (WSS) процесса по отметкам страниц
+ *
+ * Сборщик того же вида, что CpuLoadSampler: вызывающий опрашивает Sample()
+ * со своим интервалом. Каждый вызов - один проход PageAccessScanner в
+ * пределах max_pages_per_scan, а окно закрывается, когда обход доходит до
+ * конца адресного пространства. Каждая страница проверяется раз за цикл,
+ * поэтому WSS окна - страницы, тронутые за последний цикл, а длина окна -
+ * время цикла: интервал опроса x число проходов на процесс. Стоимость
+ * опроса ограничена бюджетом страниц, память - max_history окнами.
+ *
+ * С kSoftDirty оценивается набор записываемых страниц: чтения не видны.
+ */
+class WorkingSetEstimator {
+ public:
+  /**
+   * @param max_history Окон в истории (старые отбрасываются)
+   * @throws std::runtime_error если обход страниц процесса недоступен
+   */
+  WorkingSetEstimator(pid_t pid, const PageScanConfig& config = PageScanConfig(),
+                      size_t max_history = 3600);
+
+  /**
+   * @brief Один проход обхода
+   * @param sample Выход: окно, если оно закрылось этим проходом
+   * @return true если окно закрылось (первый цикл idle только отмечает страницы)
+   */
+  bool Sample(WssSample& sample);
+
+  /**
+   * @brief CSV "pid,time_s,window_s,wss_bytes,rss_bytes" по истории
+   */
+  void WriteCsv(std::ostream& out) const;
+
+  const std::deque<WssSample>& history() const { return history_; }
+  bool alive() const { return alive_; }
+  double cpu_seconds() const { return cpu_seconds_; }
+  pid_t pid() const { return scanner_.pid(); }
+
+ private:
+  PageAccessScanner scanner_;
+  size_t max_history_;
+  std::vector<uint64_t> accessed_;
+  std::vector<bool> written_;
+  uint64_t window_accessed_;
+  uint64_t window_present_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point window_start_;
+  std::deque<WssSample> history_;       // Окна по времени, старые уходят с начала
+  bool alive_;
+  double cpu_seconds_;
+};
+
+}  // namespace hardware_analysis
+
+#endif  // WSS_ESTIMATOR_HPP
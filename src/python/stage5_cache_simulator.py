@@ -2,6 +2,8 @@
 Симулятор кэш-памяти с различными политиками замещения
 """
 
+import json
+import struct
 from enum import Enum
 from typing import List, Dict, Optional, Tuple
 from collections import OrderedDict, deque
@@ -261,6 +263,50 @@ def generate_access_pattern(pattern_type: str, length: int) -> List[int]:
     return []
 
 
+def write_trace(path: str, blocks: List[int], block_bytes: int = 64,
+                writes: Optional[List[bool]] = None,
+                prefetches: Optional[List[bool]] = None,
+                pcs: Optional[List[int]] = None):
+    """
+    Запись паттерна в двоичную трассу для нативного симулятора
+    (stage7_integration cache-sim --trace PATH)
+
+    Args:
+        path: Файл трассы
+        blocks: Номера блоков (как для CacheSimulator.access)
+        block_bytes: Размер блока, адрес = блок * block_bytes
+        writes: Признак записи для каждого обращения (по умолчанию только чтения)
+        prefetches: Признак программной предвыборки (подсказка, а не обращение)
+        pcs: Адрес инструкции каждого обращения (для модели stride)
+    """
+    record = struct.Struct("<QIBBH")  # address, pc, type, size, reserved
+    with open(path, "wb") as f:
+        f.write(b"HATRACE1" + struct.pack("<II", 1, record.size))
+        for i, block in enumerate(blocks):
+            access_type = 0
+            if prefetches is not None and prefetches[i]:
+                access_type = 3
+            elif writes is not None and writes[i]:
+                access_type = 1
+            pc = pcs[i] & 0xFFFFFFFF if pcs is not None else 0
+            f.write(record.pack(block * block_bytes, pc, access_type, 0, 0))
+
+
+def load_miss_ratio_curve(path: str) -> List[Tuple[int, float]]:
+    """
+    Кривая промахов LRU из `stage7_integration mrc --json PATH`
+
+    Один проход по трассе даёт долю промахов для всех размеров сразу,
+    вместо прогона CacheSimulator на каждый размер, как в compare_policies.
+
+    Returns:
+        Пары (ёмкость в байтах, доля промахов 0..1) по возрастанию ёмкости
+    """
+    with open(path) as f:
+        report = json.load(f)
+    return [(point["bytes"], point["miss_ratio"]) for point in report["points"]]
+
+
 if __name__ == "__main__":
     print("═══════════════════════════════════════════════════════")
     print("           Cache Simulator (Stage 5)")
@@ -2,6 +2,8 @@
 ML-предиктор производительности компьютерных систем
 """
 
+import json
+import os
 import numpy as np
 import pandas as pd
 from sklearn.ensemble import RandomForestRegressor, IsolationForest
@@ -314,6 +316,52 @@ def roofline_model(peak_performance_gflops: float,
     return min(memory_bound, compute_bound)
 
 
+def load_roofline(path: str) -> Dict:
+    """
+    Загрузка измеренных потолков (stage7_integration roofline --json PATH)
+    
+    Args:
+        path: Путь к JSON-отчёту
+        
+    Returns:
+        Словарь с ключами cpu_model, cache_signature, compute, bandwidth, kernels
+    """
+    with open(path) as f:
+        report = json.load(f)
+    for key in ('compute', 'bandwidth', 'kernels'):
+        report.setdefault(key, [])
+    return report
+
+
+def measured_roofline(report: Dict,
+                      operational_intensity: float,
+                      precision: str = 'fp64',
+                      level: str = 'DRAM',
+                      per_socket: bool = False) -> float:
+    """
+    Roofline по измеренным пику FMA и пропускной способности уровня памяти
+    
+    Args:
+        report: Результат load_roofline()
+        operational_intensity: Операции/байт (FLOP/Byte)
+        precision: 'fp64' или 'fp32'
+        level: 'L1', 'L2', 'L3' или 'DRAM'
+        per_socket: Потолки всего пакета вместо одного ядра
+        
+    Returns:
+        Достижимая производительность (GFLOPS)
+    """
+    compute = next(c for c in report['compute'] if c['precision'] == precision)
+    bandwidth = next(b for b in report['bandwidth'] if b['level'] == level)
+    
+    peak = compute['gflops_per_socket' if per_socket else 'gflops_per_core']
+    memory = bandwidth['gbs_per_core']
+    if per_socket:
+        # Для кэшей измерено только одно ядро: частные уровни складываются
+        memory = bandwidth['gbs_per_socket'] or memory * compute['socket_threads']
+    return roofline_model(peak, memory, operational_intensity)
+
+
 if __name__ == "__main__":
     print("═══════════════════════════════════════════════════════")
     print("       ML Performance Predictor (Stage 6)")
@@ -399,6 +447,17 @@ if __name__ == "__main__":
     peak_gflops = 1000  # 1 TFLOPS
     bandwidth_gbs = 50   # 50 GB/s (DDR4-3200 dual-channel)
     
+    # Измеренные потолки, если есть отчёт stage7_integration roofline
+    roofline_path = os.environ.get('HARDWARE_ANALYSIS_ROOFLINE', 'roofline.json')
+    roofline = None
+    if os.path.exists(roofline_path):
+        roofline = load_roofline(roofline_path)
+        compute = next(c for c in roofline['compute'] if c['precision'] == 'fp64')
+        dram = next(b for b in roofline['bandwidth'] if b['level'] == 'DRAM')
+        peak_gflops = compute['gflops_per_socket']
+        bandwidth_gbs = dram['gbs_per_socket'] or dram['gbs_per_core']
+        print(f"   Measured ceilings from {roofline_path} ({roofline['cpu_model']})")
+    
     intensities = [0.1, 0.5, 1.0, 5.0, 10.0, 20.0]
     print("\n   Operational Intensity (FLOP/Byte) → Performance (GFLOPS)")
     for intensity in intensities:
@@ -406,6 +465,13 @@ if __name__ == "__main__":
         bottleneck = "Memory-bound" if perf < peak_gflops else "Compute-bound"
         print(f"   {intensity:5.1f} → {perf:7.1f} GFLOPS ({bottleneck})")
     
+    if roofline is not None:
+        print("\n   Measured kernels:")
+        for kernel in roofline['kernels']:
+            print(f"   {kernel['name']:20s} {kernel['intensity']:7.3f} FLOP/B "
+                  f"{kernel['gflops']:7.1f} GFLOPS ({kernel['bound']}-bound, "
+                  f"served from {kernel['served_from']})")
+    
     print("\n═══════════════════════════════════════════════════════")
     print("ML prediction complete!")
     print("═══════════════════════════════════════════════════════")
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include "autotuner.hpp"
+#include "optimization_engine.hpp"
+#include "test_utils.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief Ядро с известным оптимумом: время постоянно, работа падает с расстоянием
+ */
+TunableKernel PeakKernel(int64_t best_x, int64_t best_y, std::map<TuningPoint, int>* calls) {
+  TunableKernel kernel;
+  kernel.name = "peak";
+  kernel.parameters = {TunableParameter::Range("x", 0, 15, 1),
+                       TunableParameter::Range("y", 0, 6, 1)};
+  kernel.run = [=](const TuningPoint& point) {
+    ++(*calls)[point];
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+    while (std::chrono::steady_clock::now() < until) {
+    }
+    int64_t distance = std::llabs(point.at("x") - best_x) + std::llabs(point.at("y") - best_y);
+    return 1e6 / (1.0 + distance);
+  };
+  return kernel;
+}
+
+}  // namespace
+
+// ============================================================================
+// Параметры
+// ============================================================================
+
+TEST(AutotunerTest, ParameterRanges) {
+  EXPECT_EQ(TunableParameter::Range("a", 2, 9, 3).values, (std::vector<int64_t>{2, 5, 8}));
+  EXPECT_EQ(TunableParameter::PowersOfTwo("b", 3, 40).values,
+            (std::vector<int64_t>{4, 8, 16, 32}));
+}
+
+// ============================================================================
+// Поиск
+// ============================================================================
+
+TEST(AutotunerTest, GridThenRefinementFindsOffGridOptimum) {
+  std::map<TuningPoint, int> calls;
+  AutotuneConfig config;
+  config.warmup = 1;
+  config.repetitions = 3;
+  config.grid_stride = 4;   // x: 0,4,8,12,15; y: 0,4,6 - оптимум (7, 3) вне сетки
+  Autotuner tuner(config);
+
+  AutotuneResult result = tuner.Tune(PeakKernel(7, 3, &calls));
+  EXPECT_EQ(result.grid_evaluations, 15u);
+  EXPECT_GT(result.refine_evaluations, 0u);
+  EXPECT_EQ(result.best.at("x"), 7);
+  EXPECT_EQ(result.best.at("y"), 3);
+
+  // Каждая точка измерена один раз: warmup + repetitions вызовов
+  EXPECT_EQ(calls.size(), result.trials.size());
+  for (const auto& entry : calls) {
+    EXPECT_EQ(entry.second, 4);
+  }
+  EXPECT_GT(result.best_stats.median_seconds, 0.0);
+  EXPECT_LE(result.best_stats.min_seconds, result.best_stats.median_seconds);
+}
+
+TEST(AutotunerTest, RespectsBudgetConstraintsAndBaseline) {
+  std::map<TuningPoint, int> calls;
+  AutotuneConfig config;
+  config.warmup = 0;
+  config.repetitions = 3;   // Медиана переживает одно вытеснение под нагрузкой
+  config.max_evaluations = 5;
+  Autotuner tuner(config);
+
+  TunableKernel kernel = PeakKernel(15, 6, &calls);
+  kernel.valid = [](const TuningPoint& point) { return point.at("x") != 0; };
+  TuningPoint baseline = {{"x", 15}, {"y", 6}};
+  AutotuneResult result = tuner.Tune(kernel, &baseline);
+
+  EXPECT_EQ(result.trials.size(), 5u);
+  for (const auto& trial : result.trials) {
+    EXPECT_NE(trial.point.at("x"), 0);
+  }
+  // Точка по умолчанию лучше всех измеренных - она и остаётся
+  EXPECT_EQ(result.best, baseline);
+  EXPECT_GT(result.baseline_stats.throughput, 0.0);
+
+  kernel.valid = [](const TuningPoint&) { return false; };
+  EXPECT_THROW(tuner.Tune(kernel), std::invalid_argument);
+  kernel.parameters.push_back({"empty", {}});
+  EXPECT_THROW(tuner.Tune(kernel), std::invalid_argument);
+}
+
+// ============================================================================
+// Профиль
+// ============================================================================
+
+TEST(AutotunerTest, ProfileIsKeyedByCacheSignature) {
+  TempDir dir;
+  std::string path = dir.path() + "/profile.json";
+
+  AutotuneResult result;
+  result.kernel = "gemm";
+  result.best = {{"block_m", 32}, {"block_k", 128}, {"block_n", 256}};
+  result.best_stats.throughput = 5e9;
+
+  MachineProfile profile = MachineProfile::Load(path, "cpu");
+  Autotuner::StoreInProfile(result, "L1d:48K L2:2048K", profile);
+  profile.Save(path);
+
+  MachineProfile loaded = MachineProfile::Load(path, "cpu");
+  TuningPoint point;
+  ASSERT_TRUE(Autotuner::LoadFromProfile(loaded, "gemm", "L1d:48K L2:2048K", &point));
+  EXPECT_EQ(point, result.best);
+  EXPECT_FALSE(Autotuner::LoadFromProfile(loaded, "gemm", "L1d:32K L2:1024K", &point));
+  EXPECT_FALSE(Autotuner::LoadFromProfile(loaded, "reduction", "L1d:48K L2:2048K", &point));
+
+  OptimizationEngine engine;
+  EXPECT_EQ(engine.LoadTunedParameters(loaded, "L1d:48K L2:2048K"), 1u);
+  EXPECT_EQ(engine.GetGemmBlocking().block_m, 32u);
+  EXPECT_EQ(engine.GetGemmBlocking().block_k, 128u);
+  EXPECT_EQ(engine.GetGemmBlocking().block_n, 256u);
+}
+
+// ============================================================================
+// Ядра OptimizationEngine
+// ============================================================================
+
+TEST(AutotunerTest, BlockedGemmMatchesNaiveForAnyBlocking) {
+  OptimizationEngine engine;
+  // N не кратно 4: прежняя версия писала за конец строки C
+  const size_t M = 13, K = 17, N = 11;
+  std::vector<double> A(M * K), B(K * N), C(M * N, -1.0), expected(M * N, 0.0);
+  for (size_t i = 0; i < A.size(); ++i) {
+    A[i] = static_cast<double>(i % 7) - 3.0;
+  }
+  for (size_t i = 0; i < B.size(); ++i) {
+    B[i] = 0.25 * static_cast<double>(i % 5);
+  }
+  for (size_t i = 0; i < M; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      for (size_t k = 0; k < K; ++k) {
+        expected[i * N + j] += A[i * K + k] * B[k * N + j];
+      }
+    }
+  }
+
+  for (GemmBlocking blocking : {GemmBlocking{1, 1, 1}, GemmBlocking{4, 8, 4},
+                                GemmBlocking{5, 3, 7}, GemmBlocking{}}) {
+    engine.SetGemmBlocking(blocking);
+    engine.MatrixMultiply_AVX2(A.data(), B.data(), C.data(), M, K, N);
+    for (size_t i = 0; i < C.size(); ++i) {
+      ASSERT_NEAR(C[i], expected[i], 1e-9) << "block_m " << blocking.block_m << " index " << i;
+    }
+  }
+}
+
+TEST(AutotunerTest, ParallelSumMatchesSerial) {
+  OptimizationEngine engine;
+  std::vector<double> data(100003);
+  double expected = 0.0;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<double>(i % 100);
+    expected += data[i];
+  }
+  for (ReductionParallelism parallelism :
+       {ReductionParallelism{1, 1024}, ReductionParallelism{4, 1000}, ReductionParallelism{3, 1}}) {
+    engine.SetReductionParallelism(parallelism);
+    EXPECT_DOUBLE_EQ(engine.ParallelSum(data.data(), data.size()), expected)
+        << parallelism.threads << " threads";
+  }
+}
+
+TEST(AutotunerTest, EngineKernelsTune) {
+  OptimizationEngine engine;
+  AutotuneConfig config;
+  config.warmup = 0;
+  config.repetitions = 1;
+  config.max_evaluations = 6;
+  Autotuner tuner(config);
+
+  AutotuneResult gemm = tuner.Tune(MakeGemmKernel(engine, 48));
+  EXPECT_EQ(gemm.best.size(), 3u);
+  EXPECT_GT(gemm.best_stats.throughput, 0.0);
+
+  AutotuneResult reduction = tuner.Tune(MakeReductionKernel(engine, 1 << 16, 2));
+  EXPECT_EQ(reduction.best.count("threads"), 1u);
+  EXPECT_GT(reduction.best_stats.throughput, 0.0);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include "cache_simulator.hpp"
+#include "memory_trace.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+CacheLevelConfig Level(size_t size_bytes, size_t ways,
+                       ReplacementPolicy policy = ReplacementPolicy::kLru) {
+  CacheLevelConfig config;
+  config.size_bytes = size_bytes;
+  config.line_bytes = 64;
+  config.ways = ways;
+  config.policy = policy;
+  return config;
+}
+
+/**
+ * @brief Эталонный полностью ассоциативный LRU на списке
+ */
+class ReferenceLru {
+ public:
+  explicit ReferenceLru(size_t capacity) : capacity_(capacity) {}
+
+  bool Access(uint64_t line) {
+    auto it = std::find(lines_.begin(), lines_.end(), line);
+    if (it != lines_.end()) {
+      lines_.erase(it);
+      lines_.push_front(line);
+      return true;
+    }
+    if (lines_.size() == capacity_) {
+      lines_.pop_back();
+    }
+    lines_.push_front(line);
+    return false;
+  }
+
+ private:
+  size_t capacity_;
+  std::list<uint64_t> lines_;
+};
+
+}  // namespace
+
+// ============================================================================
+// Трасса
+// ============================================================================
+
+TEST(CacheSimulatorTest, TraceRoundTrip) {
+  TempDir dir;
+  std::string path = dir.path() + "/trace.bin";
+  {
+    TraceWriter writer(path);
+    writer.Write(0x1000, AccessType::kRead);
+    writer.Write(0x2040, AccessType::kWrite, 8, 0x400123);
+    writer.Write(0x3000, AccessType::kInstruction, 4);
+    EXPECT_EQ(writer.records(), 3u);
+  }
+
+  MappedTrace trace(path);
+  ASSERT_EQ(trace.size(), 3u);
+  const TraceRecord* records = trace.begin();
+  EXPECT_EQ(records[0].address, 0x1000u);
+  EXPECT_EQ(records[1].type, static_cast<uint8_t>(AccessType::kWrite));
+  EXPECT_EQ(records[1].size, 8u);
+  EXPECT_EQ(records[1].pc, 0x400123u);
+  EXPECT_EQ(records[2].type, static_cast<uint8_t>(AccessType::kInstruction));
+}
+
+TEST(CacheSimulatorTest, RejectsForeignFiles) {
+  TempDir dir;
+  EXPECT_THROW(MappedTrace(dir.WriteFile("short.bin", "HATR")), std::runtime_error);
+  EXPECT_THROW(MappedTrace(dir.WriteFile("bad.bin", "NOTATRACEFILE!!!")), std::runtime_error);
+  EXPECT_THROW(MappedTrace(dir.path() + "/missing.bin"), std::runtime_error);
+}
+
+// ============================================================================
+// Один уровень
+// ============================================================================
+
+TEST(CacheSimulatorTest, RejectsInvalidGeometry) {
+  CacheLevelConfig config = Level(32u << 10, 8);
+  config.line_bytes = 48;
+  EXPECT_THROW(SetAssociativeCache{config}, std::invalid_argument);
+  EXPECT_THROW(SetAssociativeCache{Level(1000, 8)}, std::invalid_argument);
+  EXPECT_THROW(SetAssociativeCache{Level(32u << 10, 0)}, std::invalid_argument);
+
+  // 15 путей и 3 множества: не степени двойки, но допустимо
+  SetAssociativeCache odd(Level(3 * 15 * 64, 15));
+  EXPECT_EQ(odd.sets(), 3u);
+}
+
+TEST(CacheSimulatorTest, PoliciesPickDifferentVictims) {
+  // Одно множество на 2 пути: A B A C, затем проверяем, кто остался
+  auto run = [](ReplacementPolicy policy) {
+    SetAssociativeCache cache(Level(2 * 64, 2, policy));
+    cache.Access(1, false);
+    cache.Access(2, false);
+    cache.Access(1, false);
+    cache.Access(3, false);
+    return cache;
+  };
+
+  SetAssociativeCache lru = run(ReplacementPolicy::kLru);
+  EXPECT_TRUE(lru.Contains(1));
+  EXPECT_FALSE(lru.Contains(2));
+
+  SetAssociativeCache fifo = run(ReplacementPolicy::kFifo);
+  EXPECT_FALSE(fifo.Contains(1));
+  EXPECT_TRUE(fifo.Contains(2));
+
+  SetAssociativeCache lfu = run(ReplacementPolicy::kLfu);
+  EXPECT_TRUE(lfu.Contains(1));
+  EXPECT_FALSE(lfu.Contains(2));
+  EXPECT_EQ(lfu.stats().hits, 1u);
+  EXPECT_EQ(lfu.stats().evictions, 1u);
+
+  SetAssociativeCache random = run(ReplacementPolicy::kRandom);
+  EXPECT_TRUE(random.Contains(3));
+  EXPECT_TRUE(random.Contains(1) != random.Contains(2));
+}
+
+TEST(CacheSimulatorTest, FullyAssociativeLruMatchesReference) {
+  const size_t capacity = 13;   // Не кратно группе SIMD: проверяет пути выравнивания
+  SetAssociativeCache simd(Level(capacity * 64, capacity), true);
+  SetAssociativeCache scalar(Level(capacity * 64, capacity), false);
+  ReferenceLru reference(capacity);
+
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<uint64_t> lines(0, 40);
+  for (int i = 0; i < 20000; ++i) {
+    uint64_t line = lines(rng);
+    bool expected = reference.Access(line);
+    ASSERT_EQ(simd.Access(line, false), expected) << "access " << i;
+    ASSERT_EQ(scalar.Access(line, false), expected) << "access " << i;
+  }
+  EXPECT_EQ(simd.stats().hits, scalar.stats().hits);
+  EXPECT_GT(simd.stats().hits, 0u);
+  EXPECT_GT(simd.stats().misses, 0u);
+}
+
+TEST(CacheSimulatorTest, SimdMatchesScalarForEveryPolicy) {
+  for (ReplacementPolicy policy : {ReplacementPolicy::kLru, ReplacementPolicy::kFifo,
+                                   ReplacementPolicy::kLfu, ReplacementPolicy::kRandom}) {
+    // 6 путей: два из восьми слов множества - выравнивание
+    SetAssociativeCache simd(Level(16 * 6 * 64, 6, policy), true);
+    SetAssociativeCache scalar(Level(16 * 6 * 64, 6, policy), false);
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<uint64_t> lines(0, 300);
+    for (int i = 0; i < 20000; ++i) {
+      uint64_t line = lines(rng);
+      bool write = (i % 5) == 0;
+      ASSERT_EQ(simd.Access(line, write), scalar.Access(line, write))
+          << ReplacementPolicyName(policy) << " access " << i;
+    }
+    EXPECT_EQ(simd.stats().writebacks, scalar.stats().writebacks);
+  }
+}
+
+TEST(CacheSimulatorTest, CountsDirtyWritebacks) {
+  SetAssociativeCache cache(Level(64, 1));
+  cache.Access(1, true);
+  cache.Access(2, false);   // Вытесняет грязную 1
+  cache.Access(3, false);   // Вытесняет чистую 2
+  EXPECT_EQ(cache.stats().evictions, 2u);
+  EXPECT_EQ(cache.stats().writebacks, 1u);
+}
+
+// ============================================================================
+// Иерархия
+// ============================================================================
+
+TEST(CacheSimulatorTest, HierarchyFillsLowerLevels) {
+  CacheHierarchy hierarchy({Level(1u << 10, 2), Level(8u << 10, 4)});
+  std::vector<TraceRecord> records;
+  // Два прохода по 4 КБ: больше L1 (1 КБ), меньше L2 (8 КБ)
+  for (int pass = 0; pass < 2; ++pass) {
+    for (uint64_t address = 0; address < 4096; address += 64) {
+      records.push_back(TraceRecord{address, 0, 0, 0, 0});
+    }
+  }
+  hierarchy.Simulate(records.data(), records.size());
+
+  const CacheStats& l1 = hierarchy.Level(0).stats();
+  const CacheStats& l2 = hierarchy.Level(1).stats();
+  EXPECT_EQ(hierarchy.records(), 128u);
+  EXPECT_EQ(l1.accesses, 128u);
+  EXPECT_EQ(l1.hits, 0u);
+  EXPECT_EQ(l2.accesses, 128u);
+  EXPECT_EQ(l2.misses, 64u);
+  EXPECT_EQ(l2.hits, 64u);
+}
+
+TEST(CacheSimulatorTest, SplitsLineCrossingAccesses) {
+  CacheHierarchy hierarchy({Level(1u << 10, 2)});
+  TraceRecord record{60, 0, static_cast<uint8_t>(AccessType::kWrite), 8, 0};
+  hierarchy.Access(record);
+  EXPECT_EQ(hierarchy.Level(0).stats().accesses, 2u);
+  EXPECT_TRUE(hierarchy.Level(0).Contains(0));
+  EXPECT_TRUE(hierarchy.Level(0).Contains(1));
+}
+
+TEST(CacheSimulatorTest, ParsesLevelSpecs) {
+  std::vector<CacheLevelConfig> levels =
+      CacheHierarchy::ParseLevels("48K:12,2M:16:fifo", ReplacementPolicy::kLfu);
+  ASSERT_EQ(levels.size(), 2u);
+  EXPECT_EQ(levels[0].name, "L1");
+  EXPECT_EQ(levels[0].size_bytes, 48u << 10);
+  EXPECT_EQ(levels[0].ways, 12u);
+  EXPECT_EQ(levels[0].policy, ReplacementPolicy::kLfu);
+  EXPECT_EQ(levels[1].size_bytes, 2u << 20);
+  EXPECT_EQ(levels[1].policy, ReplacementPolicy::kFifo);
+
+  EXPECT_THROW(CacheHierarchy::ParseLevels("48K", ReplacementPolicy::kLru),
+               std::invalid_argument);
+  EXPECT_THROW(CacheHierarchy::ParseLevels("48Q:8", ReplacementPolicy::kLru),
+               std::invalid_argument);
+  EXPECT_THROW(CacheHierarchy::ParseLevels("48K:8:mru", ReplacementPolicy::kLru),
+               std::invalid_argument);
+}
+
+// ============================================================================
+// Performance Benchmarks
+// ============================================================================
+
+TEST(CacheSimulatorPerformanceTest, SimulatesHundredMillionAccessesPerSecond) {
+  if (!testing_utils::PerfAssertionsEnabled()) {
+    GTEST_SKIP() << "Throughput check runs under ctest -L perf";
+  }
+  // L1 48K:12 и L2 2M:16: по 8 последовательных обращений на случайную
+  // строку в 8 МБ - попадания L1 вперемешку с промахами до L2 и мимо него
+  std::vector<TraceRecord> records(16u << 20);
+  std::mt19937_64 random(7);
+  for (size_t i = 0; i < records.size(); i += 8) {
+    uint64_t line = random() % ((8u << 20) / 64);
+    for (size_t k = 0; k < 8 && i + k < records.size(); ++k) {
+      records[i + k] = TraceRecord{line * 64 + k * 8, 0,
+                                   static_cast<uint8_t>(k % 4 == 3 ? AccessType::kWrite
+                                                                   : AccessType::kRead),
+                                   8, 0};
+    }
+  }
+  CacheHierarchy hierarchy({Level(48u << 10, 12), Level(2u << 20, 16)});
+
+  auto start = std::chrono::steady_clock::now();
+  hierarchy.Simulate(records.data(), records.size());
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double accesses_per_second = records.size() / seconds;
+  std::cout << "Cache simulator: " << records.size() << " accesses in " << seconds << " s ("
+            << accesses_per_second / 1e6 << " M accesses/s, target 100 M/s per core)\n";
+
+  EXPECT_EQ(hierarchy.records(), records.size());
+  EXPECT_GT(hierarchy.Level(0).stats().hits, 0u);
+  EXPECT_GT(hierarchy.Level(1).stats().misses, 0u);
+  // Цель - 100M обращений в секунду на современном ядре; порог ниже, чтобы
+  // проходить на виртуальной машине, но на два порядка выше Python-симулятора
+  EXPECT_GT(accesses_per_second, 15e6);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
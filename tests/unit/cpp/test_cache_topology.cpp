@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "cache_topology.hpp"
+#include "cpu_topology.hpp"
+#include "machine_profile.hpp"
+#include "optimization_engine.hpp"
+#include "test_utils.hpp"
+#include <cstdint>
+#include <string>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief Фейковый sysfs: 4 CPU, частные L1/L2, L3 на пары {0,1} и {2,3}
+ */
+void WriteFakeCaches(TempDir& dir) {
+  dir.WriteFile("system/cpu/online", "0-3\n");
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    std::string base = "system/cpu/cpu" + std::to_string(cpu);
+    dir.WriteFile(base + "/topology/physical_package_id", "0\n");
+    dir.WriteFile(base + "/topology/core_id", std::to_string(cpu) + "\n");
+
+    struct {
+      const char* level;
+      const char* type;
+      const char* size;
+      const char* ways;
+      std::string shared;
+    } caches[] = {{"1", "Data", "32K", "8", std::to_string(cpu)},
+                  {"1", "Instruction", "32K", "8", std::to_string(cpu)},
+                  {"2", "Unified", "1024K", "16", std::to_string(cpu)},
+                  {"3", "Unified", "16384K", "16", cpu < 2 ? "0-1" : "2-3"}};
+    for (int index = 0; index < 4; ++index) {
+      std::string path = base + "/cache/index" + std::to_string(index);
+      dir.WriteFile(path + "/level", std::string(caches[index].level) + "\n");
+      dir.WriteFile(path + "/type", std::string(caches[index].type) + "\n");
+      dir.WriteFile(path + "/size", std::string(caches[index].size) + "\n");
+      dir.WriteFile(path + "/ways_of_associativity", std::string(caches[index].ways) + "\n");
+      dir.WriteFile(path + "/coherency_line_size", "64\n");
+      dir.WriteFile(path + "/shared_cpu_list", caches[index].shared + "\n");
+    }
+  }
+}
+
+}  // namespace
+
+// ============================================================================
+// sysfs
+// ============================================================================
+
+TEST(CacheTopologyTest, ReadsAndDeduplicatesSysfs) {
+  TempDir dir;
+  WriteFakeCaches(dir);
+  CacheTopology topology = CacheTopology::ReadSysfs(dir.path() + "/system/cpu", {0, 1, 2, 3});
+
+  EXPECT_EQ(topology.source, "sysfs");
+  // 4 x (L1d + L1i + L2) частных + 2 общих L3
+  EXPECT_EQ(topology.caches.size(), 14u);
+  EXPECT_EQ(topology.LastLevel(), 3);
+  EXPECT_EQ(topology.DataCacheBytes(1), 32u << 10);
+  EXPECT_EQ(topology.DataCacheBytes(2), 1u << 20);
+  EXPECT_EQ(topology.LineBytes(), 64u);
+
+  const CacheInfo* l3 = topology.Find(3, 3);
+  ASSERT_NE(l3, nullptr);
+  EXPECT_EQ(l3->shared_cpus, (std::vector<int>{2, 3}));
+  EXPECT_EQ(l3->ways, 16u);
+  EXPECT_EQ(l3->sets, (16u << 20) / (16 * 64));
+  EXPECT_EQ(topology.Find(0, 4), nullptr);
+
+  EXPECT_EQ(topology.LastLevelGroups(),
+            (std::vector<std::vector<int>>{{0, 1}, {2, 3}}));
+  EXPECT_EQ(topology.LastLevelId(1), 0);
+  EXPECT_EQ(topology.LastLevelId(2), 1);
+  EXPECT_EQ(topology.LastLevelId(9), -1);
+  EXPECT_EQ(topology.Signature(), "L1d:32K L1i:32K L2:1024K L3:16384K");
+  EXPECT_EQ(MachineProfile::DetectCacheSignature(dir.path() + "/system/cpu"),
+            topology.Signature());
+}
+
+TEST(CacheTopologyTest, TopologySnapshotGroupsByLastLevelCache) {
+  TempDir dir;
+  WriteFakeCaches(dir);
+  TopologySnapshot snapshot = TopologySnapshot::Read(dir.path() + "/system");
+
+  EXPECT_EQ(snapshot.caches.source, "sysfs");
+  EXPECT_EQ(snapshot.LastLevelCacheGroups().size(), 2u);
+  EXPECT_EQ(snapshot.LastLevelCacheId(0), snapshot.LastLevelCacheId(1));
+  EXPECT_NE(snapshot.LastLevelCacheId(1), snapshot.LastLevelCacheId(2));
+
+  // Без данных о кэшах группой служит пакет
+  snapshot.caches = CacheTopology();
+  EXPECT_EQ(snapshot.LastLevelCacheGroups(),
+            (std::vector<std::vector<int>>{{0, 1, 2, 3}}));
+}
+
+TEST(CacheTopologyTest, EngineBlockingFollowsCaches) {
+  TempDir dir;
+  WriteFakeCaches(dir);
+  CacheTopology topology = CacheTopology::ReadSysfs(dir.path() + "/system/cpu", {0});
+
+  GemmBlocking blocking = GemmBlocking::ForCaches(topology);
+  // Строка C в половине L1D, панель B в половине L2
+  EXPECT_EQ(blocking.block_n, 1024u);
+  EXPECT_EQ(blocking.block_k, 64u);
+  EXPECT_LE(blocking.block_n * sizeof(double), topology.DataCacheBytes(1) / 2);
+  EXPECT_LE(blocking.block_k * blocking.block_n * sizeof(double), topology.DataCacheBytes(2) / 2);
+
+  GemmBlocking defaults = GemmBlocking::ForCaches(CacheTopology());
+  EXPECT_EQ(defaults.block_n, GemmBlocking().block_n);
+}
+
+// ============================================================================
+// CPUID
+// ============================================================================
+
+TEST(CacheTopologyTest, DecodesCpuidLeaf) {
+  // L1d: 48K, 12-way, 64 set, 64 байта, 2 логических CPU
+  uint32_t eax = 1 | (1 << 5) | (1 << 14);
+  uint32_t ebx = 63 | (0 << 12) | (11u << 22);
+  uint32_t ecx = 63;
+  CacheInfo info;
+  size_t sharing = 0;
+  ASSERT_TRUE(CacheTopology::DecodeCpuidLeaf(eax, ebx, ecx, &info, &sharing));
+  EXPECT_EQ(info.type, CacheType::kData);
+  EXPECT_EQ(info.level, 1);
+  EXPECT_EQ(info.ways, 12u);
+  EXPECT_EQ(info.line_bytes, 64u);
+  EXPECT_EQ(info.sets, 64u);
+  EXPECT_EQ(info.size_bytes, 48u << 10);
+  EXPECT_EQ(sharing, 2u);
+
+  EXPECT_FALSE(CacheTopology::DecodeCpuidLeaf(0, ebx, ecx, &info, &sharing));
+}
+
+TEST(CacheTopologyTest, FallsBackToCpuid) {
+  TempDir dir;
+  CacheTopology topology = CacheTopology::Read(dir.path(), {0, 1, 2, 3});
+  if (topology.caches.empty()) {
+    GTEST_SKIP() << "CPUID cache leaves not available";
+  }
+  EXPECT_EQ(topology.source, "cpuid");
+  EXPECT_GT(topology.DataCacheBytes(1), 0u);
+  // Каждый CPU попадает ровно в один экземпляр каждого уровня
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    EXPECT_NE(topology.Find(cpu, 1), nullptr) << cpu;
+  }
+  EXPECT_GE(CacheLineSize(), 32u);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "core_latency.hpp"
+#include "test_utils.hpp"
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief 8 CPU: SMT-пары по 20 нс, два CCX {0-3},{4-7} по 40 нс, между ними 120 нс
+ */
+CoreLatencyMatrix TwoCcxMatrix() {
+  CoreLatencyMatrix matrix;
+  matrix.cpus = {0, 1, 2, 3, 4, 5, 6, 7};
+  matrix.round_trip_ns.assign(64, 0.0);
+  for (size_t i = 0; i < 8; ++i) {
+    for (size_t j = 0; j < 8; ++j) {
+      if (i == j) {
+        continue;
+      }
+      double ns = i / 2 == j / 2 ? 20.0 : i / 4 == j / 4 ? 40.0 + (i + j) % 3 : 120.0 + i;
+      matrix.round_trip_ns[i * 8 + j] = ns;
+    }
+  }
+  // Симметрия: 120 + i зависит от порядка
+  for (size_t i = 0; i < 8; ++i) {
+    for (size_t j = i + 1; j < 8; ++j) {
+      matrix.round_trip_ns[j * 8 + i] = matrix.round_trip_ns[i * 8 + j];
+    }
+  }
+  return matrix;
+}
+
+/**
+ * @brief Топология той же машины: ядро = пара CPU, L3 на четвёрку, один пакет
+ */
+TopologySnapshot TwoCcxTopology() {
+  TopologySnapshot topology;
+  for (int cpu = 0; cpu < 8; ++cpu) {
+    topology.cpus.push_back({cpu, cpu / 2, 0, 0});
+  }
+  topology.package_count = 1;
+  topology.numa_node_count = 1;
+  CacheInfo l3{3, CacheType::kUnified, 32u << 20, 64, 16, 32768, {0, 1, 2, 3}};
+  topology.caches.caches = {l3, l3};
+  topology.caches.caches[1].shared_cpus = {4, 5, 6, 7};
+  return topology;
+}
+
+}  // namespace
+
+// ============================================================================
+// Раунды
+// ============================================================================
+
+TEST(CoreLatencyTest, PairRoundsCoverEveryPairOnce) {
+  for (size_t count : {2u, 5u, 8u}) {
+    auto rounds = CoreLatencyBenchmark::PairRounds(count);
+    EXPECT_EQ(rounds.size(), count % 2 ? count : count - 1) << count;
+
+    std::set<std::pair<size_t, size_t>> seen;
+    for (const auto& round : rounds) {
+      std::set<size_t> busy;
+      for (const auto& pair : round) {
+        EXPECT_LT(pair.first, pair.second);
+        EXPECT_TRUE(busy.insert(pair.first).second) << "CPU reused in a round";
+        EXPECT_TRUE(busy.insert(pair.second).second) << "CPU reused in a round";
+        EXPECT_TRUE(seen.insert(pair).second) << "pair measured twice";
+      }
+    }
+    EXPECT_EQ(seen.size(), count * (count - 1) / 2);
+  }
+  EXPECT_TRUE(CoreLatencyBenchmark::PairRounds(1).empty());
+}
+
+// ============================================================================
+// Кластеризация
+// ============================================================================
+
+TEST(CoreLatencyTest, ClustersIntoSmtLlcAndSocket) {
+  CoreLatencyMatrix matrix = TwoCcxMatrix();
+  EXPECT_DOUBLE_EQ(matrix.Between(0, 1), 20.0);
+  EXPECT_DOUBLE_EQ(matrix.Between(7, 0), 120.0);
+  EXPECT_LT(matrix.Between(0, 9), 0.0);
+
+  TopologySnapshot topology = TwoCcxTopology();
+  auto levels = CoreLatencyBenchmark::Cluster(matrix, &topology);
+  ASSERT_EQ(levels.size(), 3u);
+
+  EXPECT_EQ(levels[0].name, "smt");
+  EXPECT_DOUBLE_EQ(levels[0].max_round_trip_ns, 20.0);
+  EXPECT_EQ(levels[0].groups, (std::vector<std::vector<int>>{{0, 1}, {2, 3}, {4, 5}, {6, 7}}));
+
+  EXPECT_EQ(levels[1].name, "llc");
+  EXPECT_DOUBLE_EQ(levels[1].max_round_trip_ns, 42.0);
+  EXPECT_EQ(levels[1].groups, (std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}}));
+
+  // Пакет совпадает с узлом NUMA: имя "socket"
+  EXPECT_EQ(levels[2].groups, (std::vector<std::vector<int>>{{0, 1, 2, 3, 4, 5, 6, 7}}));
+  EXPECT_EQ(levels[2].name, "socket");
+
+  // Без топологии уровни безымянные
+  auto anonymous = CoreLatencyBenchmark::Cluster(matrix);
+  ASSERT_EQ(anonymous.size(), 3u);
+  EXPECT_EQ(anonymous[1].name, "tier2");
+}
+
+TEST(CoreLatencyTest, UniformMatrixIsOneLevel) {
+  CoreLatencyMatrix matrix;
+  matrix.cpus = {2, 5, 9};
+  matrix.round_trip_ns = {0, 50, 52, 50, 0, 51, 52, 51, 0};
+  auto levels = CoreLatencyBenchmark::Cluster(matrix);
+  ASSERT_EQ(levels.size(), 1u);
+  EXPECT_EQ(levels[0].groups, (std::vector<std::vector<int>>{{2, 5, 9}}));
+  EXPECT_DOUBLE_EQ(levels[0].max_round_trip_ns, 52.0);
+}
+
+// ============================================================================
+// Профиль
+// ============================================================================
+
+TEST(CoreLatencyTest, ProfileRoundTrip) {
+  TempDir dir;
+  std::string path = dir.path() + "/profile.json";
+  CoreLatencyMatrix matrix = TwoCcxMatrix();
+  TopologySnapshot topology = TwoCcxTopology();
+
+  MachineProfile profile = MachineProfile::Load(path, "cpu");
+  CoreLatencyBenchmark::StoreInProfile(matrix, CoreLatencyBenchmark::Cluster(matrix, &topology),
+                                       profile);
+  profile.Save(path);
+
+  MachineProfile loaded = MachineProfile::Load(path, "cpu");
+  EXPECT_EQ(loaded.Get<std::string>("core_to_core.domains.0.name", ""), "smt");
+  EXPECT_EQ(loaded.Get<std::string>("core_to_core.domains.1.groups", ""), "0,1,2,3;4,5,6,7");
+
+  CoreLatencyMatrix restored;
+  ASSERT_TRUE(CoreLatencyBenchmark::LoadFromProfile(loaded, &restored));
+  EXPECT_EQ(restored.cpus, matrix.cpus);
+  for (size_t i = 0; i < matrix.round_trip_ns.size(); ++i) {
+    EXPECT_DOUBLE_EQ(restored.round_trip_ns[i], matrix.round_trip_ns[i]);
+  }
+
+  MachineProfile empty("cpu");
+  EXPECT_FALSE(CoreLatencyBenchmark::LoadFromProfile(empty, &restored));
+}
+
+// ============================================================================
+// Измерение
+// ============================================================================
+
+TEST(CoreLatencyTest, MeasuresPairs) {
+  CoreLatencyConfig config;
+  config.cpus = {0, 1};
+  config.round_trips = 200;
+  config.samples = 3;
+  CoreLatencyBenchmark benchmark(config);
+  EXPECT_THROW(benchmark.MeasurePair(0, 0), std::invalid_argument);
+
+  // На одном CPU привязка к cpu1 не удаётся, потоки делят CPU через sched_yield
+  CoreLatencyMatrix matrix = benchmark.Run();
+  ASSERT_EQ(matrix.cpus.size(), 2u);
+  EXPECT_GT(matrix.At(0, 1), 0.0);
+  EXPECT_DOUBLE_EQ(matrix.At(0, 1), matrix.At(1, 0));
+  EXPECT_DOUBLE_EQ(matrix.At(0, 0), 0.0);
+}
+
+TEST(CoreLatencyTest, RejectsEmptyRuns) {
+  CoreLatencyConfig config;
+  config.cpus = {0};
+  config.samples = 0;
+  EXPECT_THROW(CoreLatencyBenchmark{config}, std::invalid_argument);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "cpufreq_actuator.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <string>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief Фейковое дерево cpufreq для N CPU
+ */
+class FakeCpufreq {
+ public:
+  explicit FakeCpufreq(int cpu_count) {
+    for (int cpu = 0; cpu < cpu_count; ++cpu) {
+      for (const char* name : {"scaling_setspeed", "scaling_max_freq", "scaling_min_freq",
+                               "energy_performance_preference"}) {
+        dir_.WriteFile(File(cpu, name), "");
+      }
+      dir_.WriteFile(File(cpu, "scaling_cur_freq"), "2000000\n");
+    }
+  }
+
+  std::string Root() const { return dir_.path() + "/cpu"; }
+
+  std::string Read(int cpu, const std::string& name) const {
+    return dir_.ReadFile(File(cpu, name));
+  }
+
+  void Write(int cpu, const std::string& name, const std::string& content) const {
+    dir_.WriteFile(File(cpu, name), content);
+  }
+
+  void Remove(int cpu, const std::string& name) const {
+    std::remove((dir_.path() + "/" + File(cpu, name)).c_str());
+  }
+
+ private:
+  static std::string File(int cpu, const std::string& name) {
+    return "cpu/cpu" + std::to_string(cpu) + "/cpufreq/" + name;
+  }
+
+  TempDir dir_;
+};
+
+}  // namespace
+
+// ============================================================================
+// Запись частоты
+// ============================================================================
+
+TEST(CpufreqActuatorTest, WritesKilohertzWithNewline) {
+  FakeCpufreq fake(2);
+  CpufreqActuator actuator(fake.Root());
+
+  EXPECT_TRUE(actuator.SetFrequency(1, 2400));
+  EXPECT_EQ(fake.Read(1, "scaling_setspeed"), "2400000\n");
+  EXPECT_TRUE(actuator.SetFrequency(0, 1800, CpufreqControl::kMaxFrequency));
+  EXPECT_EQ(fake.Read(0, "scaling_max_freq"), "1800000\n");
+  EXPECT_TRUE(actuator.SetFrequency(0, 800, CpufreqControl::kMinFrequency));
+  EXPECT_EQ(fake.Read(0, "scaling_min_freq"), "800000\n");
+}
+
+TEST(CpufreqActuatorTest, SkipsUnchangedValue) {
+  FakeCpufreq fake(1);
+  CpufreqActuator actuator(fake.Root());
+
+  EXPECT_TRUE(actuator.SetFrequency(0, 3000));
+  fake.Write(0, "scaling_setspeed", "");
+  EXPECT_TRUE(actuator.SetFrequency(0, 3000));
+  EXPECT_EQ(fake.Read(0, "scaling_setspeed"), "");
+  EXPECT_EQ(actuator.GetStats().writes, 1u);
+  EXPECT_EQ(actuator.GetStats().skipped, 1u);
+
+  // После Invalidate значение пишется снова
+  actuator.Invalidate(0);
+  EXPECT_TRUE(actuator.SetFrequency(0, 3000));
+  EXPECT_EQ(fake.Read(0, "scaling_setspeed"), "3000000\n");
+}
+
+TEST(CpufreqActuatorTest, KeepsDescriptorOpen) {
+  FakeCpufreq fake(1);
+  CpufreqActuator actuator(fake.Root());
+  ASSERT_TRUE(actuator.SetFrequency(0, 2000));
+
+  // Файл удалён после открытия: запись идёт в уже открытый дескриптор
+  fake.Remove(0, "scaling_setspeed");
+  EXPECT_TRUE(actuator.SetFrequency(0, 2100));
+  EXPECT_EQ(actuator.GetStats().failures, 0u);
+}
+
+TEST(CpufreqActuatorTest, WritesEnergyPerformancePreference) {
+  FakeCpufreq fake(1);
+  CpufreqActuator actuator(fake.Root());
+
+  EXPECT_TRUE(actuator.SetEnergyPerformancePreference(0, "balance_power"));
+  EXPECT_EQ(fake.Read(0, "energy_performance_preference"), "balance_power\n");
+  EXPECT_TRUE(actuator.SetEnergyPerformancePreference(0, "balance_power"));
+  EXPECT_EQ(actuator.GetStats().skipped, 1u);
+}
+
+// ============================================================================
+// Пакетная запись и ошибки
+// ============================================================================
+
+TEST(CpufreqActuatorTest, SetAllWritesOnlyRequestedCpus) {
+  FakeCpufreq fake(4);
+  CpufreqActuator actuator(fake.Root());
+
+  std::vector<int> failed;
+  EXPECT_EQ(actuator.SetAll({1000, 0, 3000, 4000}, &failed), 3u);
+  EXPECT_TRUE(failed.empty());
+  EXPECT_EQ(fake.Read(0, "scaling_setspeed"), "1000000\n");
+  EXPECT_EQ(fake.Read(1, "scaling_setspeed"), "");
+  EXPECT_EQ(fake.Read(3, "scaling_setspeed"), "4000000\n");
+
+  // Повтор тех же значений не трогает sysfs
+  EXPECT_EQ(actuator.SetAll({1000, 0, 3000, 4000}, &failed), 0u);
+  EXPECT_EQ(actuator.GetStats().skipped, 3u);
+}
+
+TEST(CpufreqActuatorTest, ReportsFailedCpus) {
+  FakeCpufreq fake(2);
+  CpufreqActuator actuator(fake.Root());
+
+  std::vector<int> failed;
+  EXPECT_EQ(actuator.SetAll({1000, 0, 2000}, &failed), 1u);   // cpu2 не существует
+  ASSERT_EQ(failed.size(), 1u);
+  EXPECT_EQ(failed[0], 2);
+  EXPECT_FALSE(actuator.SetFrequency(2, 2000));
+  EXPECT_EQ(actuator.GetStats().failures, 2u);
+  EXPECT_FALSE(actuator.SetFrequency(0, 1000, CpufreqControl::kEpp));
+}
+
+// ============================================================================
+// Измерения
+// ============================================================================
+
+TEST(CpufreqActuatorTest, ReadsCurrentFrequency) {
+  FakeCpufreq fake(1);
+  CpufreqActuator actuator(fake.Root());
+  EXPECT_EQ(actuator.ReadCurrentFrequency(0), 2000u);
+  fake.Write(0, "scaling_cur_freq", "3100000\n");
+  EXPECT_EQ(actuator.ReadCurrentFrequency(0), 3100u);
+  EXPECT_EQ(actuator.ReadCurrentFrequency(5), 0u);
+}
+
+TEST(CpufreqActuatorTest, MeasuresTimeToObserve) {
+  FakeCpufreq fake(1);
+  CpufreqActuator actuator(fake.Root());
+
+  // Фейковая cur_freq уже 2000 МГц: наблюдается сразу
+  EXPECT_GE(actuator.MeasureTimeToObserve(0, 2000, 50, 100000), 0);
+  // 3000 МГц не появится никогда
+  EXPECT_EQ(actuator.MeasureTimeToObserve(0, 3000, 50, 2000), -1);
+  // Потолок 2500 уже соблюдён
+  EXPECT_GE(actuator.MeasureTimeToObserve(0, 2500, 0, 100000,
+                                          CpufreqControl::kMaxFrequency), 0);
+  EXPECT_EQ(fake.Read(0, "scaling_max_freq"), "2500000\n");
+}
+
+TEST(CpufreqActuatorTest, TracksWriteLatency) {
+  FakeCpufreq fake(1);
+  CpufreqActuator actuator(fake.Root());
+  for (uint64_t mhz = 1000; mhz < 2000; mhz += 100) {
+    ASSERT_TRUE(actuator.SetFrequency(0, mhz));
+  }
+  const ActuatorStats& stats = actuator.GetStats();
+  EXPECT_EQ(stats.writes, 10u);
+  EXPECT_GT(stats.total_write_ns, 0u);
+  EXPECT_LE(stats.max_write_ns, stats.total_write_ns);
+
+  actuator.ResetStats();
+  EXPECT_EQ(actuator.GetStats().writes, 0u);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
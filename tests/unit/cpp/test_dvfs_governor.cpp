@@ -0,0 +1,487 @@
+#include <gtest/gtest.h>
+#include "dvfs_governor.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+constexpr uint32_t kMsrTemperatureTarget = 0x1A2;
+constexpr uint32_t kMsrPackageThermStatus = 0x1B1;
+constexpr uint32_t kMsrRaplPowerUnit = 0x606;
+constexpr uint32_t kMsrPkgEnergyStatus = 0x611;
+
+/**
+ * @brief Фейковые sysfs/procfs/msr для N CPU, равномерно разбитых на пакеты
+ */
+class FakeDvfsSystem {
+ public:
+  FakeDvfsSystem(int cpu_count, int package_count)
+      : cpu_count_(cpu_count), busy_(cpu_count, 0), total_(cpu_count, 0) {
+    dir_.WriteFile("sys/cpu/online", "0-" + std::to_string(cpu_count - 1) + "\n");
+    int per_package = cpu_count / package_count;
+    for (int cpu = 0; cpu < cpu_count; ++cpu) {
+      std::string base = "sys/cpu/cpu" + std::to_string(cpu);
+      dir_.WriteFile(base + "/topology/physical_package_id",
+                     std::to_string(cpu / per_package) + "\n");
+      dir_.WriteFile(base + "/topology/core_id", std::to_string(cpu % per_package) + "\n");
+      dir_.WriteFile(base + "/cpufreq/scaling_setspeed", "");
+    }
+    for (int package = 0; package < package_count; ++package) {
+      int first_cpu = package * per_package;
+      std::string msr = "dev/cpu/" + std::to_string(first_cpu) + "/msr";
+      dir_.WriteMsr(msr, kMsrTemperatureTarget, 100ULL << 16);   // Tj_max = 100
+      dir_.WriteMsr(msr, kMsrRaplPowerUnit, 14ULL << 8);         // 1/16384 Дж
+      dir_.WriteMsr(msr, kMsrPkgEnergyStatus, 1);
+      SetPackageTemperature(first_cpu, 60.0);
+    }
+    WriteProcStat();
+  }
+
+  void SetPackageTemperature(int first_cpu, double celsius) {
+    uint64_t readout = static_cast<uint64_t>(100.0 - celsius);
+    dir_.WriteMsr("dev/cpu/" + std::to_string(first_cpu) + "/msr",
+                  kMsrPackageThermStatus, readout << 16);
+  }
+
+  /**
+   * @brief Добавить 100 тиков времени каждому CPU с заданной загрузкой
+   */
+  void AdvanceLoad(const std::vector<double>& load_percent) {
+    for (int cpu = 0; cpu < cpu_count_; ++cpu) {
+      double load = load_percent[std::min<size_t>(cpu, load_percent.size() - 1)];
+      busy_[cpu] += static_cast<uint64_t>(load);
+      total_[cpu] += 100;
+    }
+    WriteProcStat();
+  }
+
+  uint64_t WrittenKhz(int cpu) const {
+    std::string value = dir_.ReadFile("sys/cpu/cpu" + std::to_string(cpu) +
+                                      "/cpufreq/scaling_setspeed");
+    return value.empty() ? 0 : std::stoull(value);
+  }
+
+  void ClearWrites() {
+    for (int cpu = 0; cpu < cpu_count_; ++cpu) {
+      dir_.WriteFile("sys/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_setspeed", "");
+    }
+  }
+
+  GovernorConfig Config() const {
+    GovernorConfig config;
+    config.dvfs = {1000, 4000, 85.0, 0.0};
+    config.hysteresis_mhz = 100;
+    config.proc_root = dir_.path() + "/proc";
+    config.sysfs_root = dir_.path() + "/sys";
+    config.msr_root = dir_.path() + "/dev/cpu";
+    config.powercap_root = dir_.path() + "/powercap";
+    return config;
+  }
+
+  /**
+   * @brief Зона powercap пакета с PL1/PL2
+   */
+  void AddPowercapZone(int package, double long_term_watts) {
+    std::string zone = "powercap/intel-rapl:" + std::to_string(package);
+    dir_.WriteFile(zone + "/name", "package-" + std::to_string(package) + "\n");
+    dir_.WriteFile(zone + "/enabled", "1\n");
+    dir_.WriteFile(zone + "/constraint_0_name", "long_term\n");
+    dir_.WriteFile(zone + "/constraint_0_power_limit_uw",
+                   std::to_string(static_cast<uint64_t>(long_term_watts * 1e6)) + "\n");
+    dir_.WriteFile(zone + "/constraint_0_time_window_us", "27983872\n");
+    dir_.WriteFile(zone + "/constraint_1_name", "short_term\n");
+    dir_.WriteFile(zone + "/constraint_1_power_limit_uw", "150000000\n");
+    dir_.WriteFile(zone + "/constraint_1_time_window_us", "2440\n");
+  }
+
+  uint64_t PowercapLimitUw(int package) const {
+    return std::stoull(dir_.ReadFile("powercap/intel-rapl:" + std::to_string(package) +
+                                     "/constraint_0_power_limit_uw"));
+  }
+
+ private:
+  void WriteProcStat() {
+    std::ostringstream stat;
+    stat << "cpu  0 0 0 0 0 0 0 0 0 0\n";
+    for (int cpu = 0; cpu < cpu_count_; ++cpu) {
+      // user nice system idle iowait irq softirq steal guest guest_nice
+      stat << "cpu" << cpu << " " << busy_[cpu] << " 0 0 "
+           << (total_[cpu] - busy_[cpu]) << " 0 0 0 0 0 0\n";
+    }
+    stat << "intr 0\nctxt 0\n";
+    dir_.WriteFile("proc/stat", stat.str());
+  }
+
+  TempDir dir_;
+  int cpu_count_;
+  std::vector<uint64_t> busy_;
+  std::vector<uint64_t> total_;
+};
+
+/**
+ * @brief Источник признаков с заданными по CPU значениями
+ */
+class FixedCounterSource : public WorkloadCounterSource {
+ public:
+  explicit FixedCounterSource(std::vector<PhaseFeatures> features)
+      : features_(std::move(features)) {}
+
+  bool Sample(std::vector<PhaseFeatures>& features) override {
+    for (size_t cpu = 0; cpu < features_.size() && cpu < features.size(); ++cpu) {
+      features[cpu] = features_[cpu];
+    }
+    return true;
+  }
+
+  const char* Name() const override { return "fixed"; }
+
+ private:
+  std::vector<PhaseFeatures> features_;
+};
+
+PhaseFeatures Features(double ipc, double llc_mpki) {
+  PhaseFeatures features = PhaseFeatures::Unknown();
+  features.instructions_per_second = 2e9;
+  features.ipc = ipc;
+  features.llc_mpki = llc_mpki;
+  return features;
+}
+
+bool EndsWith(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+// ============================================================================
+// Топология
+// ============================================================================
+
+TEST(TopologySnapshotTest, ReadsPackagesFromSysfs) {
+  FakeDvfsSystem fake(8, 2);
+  TopologySnapshot topology = TopologySnapshot::Read(fake.Config().sysfs_root);
+
+  ASSERT_EQ(topology.cpus.size(), 8u);
+  EXPECT_EQ(topology.package_count, 2);
+  EXPECT_EQ(topology.PackageCpus(1), (std::vector<int>{4, 5, 6, 7}));
+  EXPECT_EQ(topology.MaxCpuId(), 7);
+  ASSERT_NE(topology.Find(5), nullptr);
+  EXPECT_EQ(topology.Find(5)->core_id, 1);
+  EXPECT_EQ(topology.Find(42), nullptr);
+}
+
+// ============================================================================
+// Замкнутый контур
+// ============================================================================
+
+TEST(DvfsGovernorTest, AppliesLoadProportionalFrequency) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(4, 1);
+  DvfsGovernor governor(engine, fake.Config());
+
+  fake.AdvanceLoad({0.0, 50.0, 100.0, 100.0});
+  GovernorTickStats stats = governor.Tick();
+
+  EXPECT_EQ(stats.cpus, 4u);
+  EXPECT_EQ(stats.frequency_changes, 4u);
+  EXPECT_EQ(stats.apply_failures, 0u);
+  EXPECT_EQ(fake.WrittenKhz(0), 1000000u);
+  EXPECT_EQ(fake.WrittenKhz(1), 2500000u);
+  EXPECT_EQ(fake.WrittenKhz(2), 4000000u);
+  EXPECT_EQ(governor.GetAppliedFrequency(1), 2500u);
+}
+
+TEST(DvfsGovernorTest, ThrottlesHotPackageOnly) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(4, 2);
+  fake.SetPackageTemperature(2, 95.0);  // Пакет 1 (CPU 2-3) перегрет
+  DvfsGovernor governor(engine, fake.Config());
+
+  fake.AdvanceLoad({100.0});
+  governor.Tick();
+
+  EXPECT_EQ(governor.GetAppliedFrequency(0), 4000u);
+  EXPECT_LT(governor.GetAppliedFrequency(2), 4000u);
+  EXPECT_EQ(governor.GetAppliedFrequency(2), governor.GetAppliedFrequency(3));
+}
+
+TEST(DvfsGovernorTest, ThermalControllerIsSelectable) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  fake.SetPackageTemperature(0, 95.0);
+  GovernorConfig config = fake.Config();
+
+  config.thermal_controller = "linear";
+  DvfsGovernor linear(engine, config);
+  fake.AdvanceLoad({100.0});
+  linear.Tick();
+  EXPECT_DOUBLE_EQ(linear.GetThermalScale(0), 85.0 / 95.0);
+  EXPECT_EQ(linear.GetAppliedFrequency(0), static_cast<uint64_t>(4000 * 85.0 / 95.0));
+
+  config.thermal_controller = "mpc";
+  DvfsGovernor mpc(engine, config);
+  fake.AdvanceLoad({100.0});
+  mpc.Tick();
+  EXPECT_LT(mpc.GetThermalScale(0), 1.0);
+
+  config.thermal_controller = "bang-bang";
+  EXPECT_THROW(DvfsGovernor(engine, config), std::invalid_argument);
+}
+
+TEST(DvfsGovernorTest, HysteresisSuppressesSmallChanges) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  DvfsGovernor governor(engine, fake.Config());
+
+  fake.AdvanceLoad({50.0});
+  governor.Tick();
+  ASSERT_EQ(governor.GetAppliedFrequency(0), 2500u);
+  fake.ClearWrites();
+
+  // +2% загрузки = +60 МГц, меньше полосы 100 МГц
+  fake.AdvanceLoad({52.0});
+  GovernorTickStats stats = governor.Tick();
+  EXPECT_EQ(stats.frequency_changes, 0u);
+  EXPECT_EQ(fake.WrittenKhz(0), 0u);
+  EXPECT_EQ(governor.GetAppliedFrequency(0), 2500u);
+
+  // +20% загрузки выходит за полосу
+  fake.AdvanceLoad({70.0});
+  stats = governor.Tick();
+  EXPECT_EQ(stats.frequency_changes, 2u);
+  EXPECT_EQ(fake.WrittenKhz(0), 3100000u);
+}
+
+TEST(DvfsGovernorTest, LogsEveryDecisionWithInputs) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  DvfsGovernor governor(engine, fake.Config());
+
+  fake.AdvanceLoad({50.0});
+  governor.Tick();
+  fake.AdvanceLoad({51.0});
+  governor.Tick();
+  EXPECT_EQ(governor.PendingDecisions(), 4u);
+
+  std::ostringstream log;
+  EXPECT_EQ(governor.DrainDecisionLog(log), 4u);
+  EXPECT_EQ(governor.PendingDecisions(), 0u);
+
+  std::istringstream lines(log.str());
+  std::string line;
+  std::vector<std::string> rows;
+  while (std::getline(lines, line)) {
+    rows.push_back(line);
+  }
+  ASSERT_EQ(rows.size(), 4u);
+  // tick,timestamp,cpu,load,temp,power,current,target,applied
+  EXPECT_EQ(rows[0].substr(0, 2), "1,");
+  EXPECT_NE(rows[0].find(",0,50,60,"), std::string::npos);
+  EXPECT_TRUE(EndsWith(rows[0], ",0,2500,1")) << rows[0];
+  EXPECT_TRUE(EndsWith(rows[3], ",2500,2530,0")) << rows[3];
+}
+
+TEST(DvfsGovernorTest, DecisionLogOverflowKeepsNewest) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  GovernorConfig config = fake.Config();
+  config.decision_log_ticks = 2;
+  DvfsGovernor governor(engine, config);
+
+  for (int i = 0; i < 5; ++i) {
+    fake.AdvanceLoad({50.0});
+    governor.Tick();
+  }
+  EXPECT_EQ(governor.PendingDecisions(), 4u);
+
+  std::ostringstream log;
+  governor.DrainDecisionLog(log);
+  EXPECT_EQ(log.str().rfind("# dropped 6", 0), 0u);
+  EXPECT_NE(log.str().find("\n4,"), std::string::npos);
+  EXPECT_EQ(log.str().find("\n3,"), std::string::npos);
+}
+
+TEST(DvfsGovernorTest, DryRunDoesNotWrite) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  GovernorConfig config = fake.Config();
+  config.dry_run = true;
+  DvfsGovernor governor(engine, config);
+
+  fake.AdvanceLoad({100.0});
+  GovernorTickStats stats = governor.Tick();
+  EXPECT_EQ(stats.frequency_changes, 2u);
+  EXPECT_EQ(fake.WrittenKhz(0), 0u);
+  EXPECT_EQ(governor.GetAppliedFrequency(0), 4000u);
+}
+
+TEST(DvfsGovernorTest, WorksWithoutMsrAccess) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  GovernorConfig config = fake.Config();
+  config.msr_root = "/nonexistent";
+  DvfsGovernor governor(engine, config);
+
+  fake.AdvanceLoad({100.0});
+  governor.Tick();
+  EXPECT_EQ(governor.GetAppliedFrequency(0), 4000u);
+
+  std::ostringstream log;
+  governor.DrainDecisionLog(log);
+  EXPECT_NE(log.str().find("nan"), std::string::npos);
+}
+
+TEST(DvfsGovernorTest, PowerBudgetFavorsPriorityCpu) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(4, 1);
+  GovernorConfig config = fake.Config();
+  config.dvfs.power_limit_watts = 20.0;   // Меньше 4 ядер на 4 ГГц по модели
+  config.cpu_priority[2] = 4.0;
+  config.power_enforcement = "software";  // Проверяется распределитель, а не RAPL
+  DvfsGovernor governor(engine, config);
+
+  fake.AdvanceLoad({100.0});
+  GovernorTickStats stats = governor.Tick();
+  EXPECT_GT(stats.budget_capped_cpus, 0u);
+
+  const CorePowerModel& model = governor.GetPowerModel(0);
+  double power = 0.0;
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    power += model.Power(governor.GetAppliedFrequency(cpu), 100.0);
+  }
+  EXPECT_LE(power, 20.0);
+  EXPECT_GT(governor.GetAppliedFrequency(2), governor.GetAppliedFrequency(0));
+  EXPECT_LE(std::max(governor.GetAppliedFrequency(0), governor.GetAppliedFrequency(1)) -
+            std::min(governor.GetAppliedFrequency(0), governor.GetAppliedFrequency(1)), 100u);
+}
+
+TEST(DvfsGovernorTest, GenerousBudgetKeepsDesiredFrequency) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(4, 1);
+  GovernorConfig config = fake.Config();
+  config.dvfs.power_limit_watts = 1000.0;
+  config.power_enforcement = "software";
+  DvfsGovernor governor(engine, config);
+
+  fake.AdvanceLoad({0.0, 50.0, 100.0, 100.0});
+  GovernorTickStats stats = governor.Tick();
+  EXPECT_EQ(stats.budget_capped_cpus, 0u);
+  EXPECT_EQ(governor.GetAppliedFrequency(0), 1000u);
+  EXPECT_EQ(governor.GetAppliedFrequency(2), 4000u);
+}
+
+TEST(DvfsGovernorTest, PowerLimitProgrammedIntoRapl) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(4, 2);
+  fake.AddPowercapZone(0, 95.0);
+  fake.AddPowercapZone(1, 95.0);
+  GovernorConfig config = fake.Config();
+  config.dvfs.power_limit_watts = 20.0;
+
+  {
+    DvfsGovernor governor(engine, config);
+    EXPECT_TRUE(governor.IsPowerLimitInHardware());
+    EXPECT_EQ(fake.PowercapLimitUw(0), 20000000u);
+    EXPECT_EQ(fake.PowercapLimitUw(1), 20000000u);
+
+    // Бюджет держит PL1: частоты не режутся программно
+    fake.AdvanceLoad({100.0});
+    GovernorTickStats stats = governor.Tick();
+    EXPECT_EQ(stats.budget_capped_cpus, 0u);
+    EXPECT_EQ(governor.GetAppliedFrequency(3), 4000u);
+  }
+
+  // Исходные ограничения возвращаются при остановке
+  EXPECT_EQ(fake.PowercapLimitUw(0), 95000000u);
+  EXPECT_EQ(fake.PowercapLimitUw(1), 95000000u);
+}
+
+TEST(DvfsGovernorTest, RaplEnforcementRequiresRapl) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  GovernorConfig config = fake.Config();
+  config.dvfs.power_limit_watts = 20.0;
+  config.msr_root = "/nonexistent";
+  config.power_enforcement = "rapl";
+  EXPECT_THROW(DvfsGovernor(engine, config), std::runtime_error);
+
+  config.power_enforcement = "auto";
+  DvfsGovernor governor(engine, config);
+  EXPECT_FALSE(governor.IsPowerLimitInHardware());
+
+  config.power_enforcement = "firmware";
+  EXPECT_THROW(DvfsGovernor(engine, config), std::invalid_argument);
+}
+
+TEST(DvfsGovernorTest, MemoryBoundCpuIsCapped) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(2, 1);
+  GovernorConfig config = fake.Config();
+  config.classifier.stable_samples = 1;
+  DvfsGovernor governor(engine, config);
+  // CPU 0 - вычисления, CPU 1 - упор в память
+  governor.SetCounterSource(std::make_unique<FixedCounterSource>(
+      std::vector<PhaseFeatures>{Features(2.5, 0.1), Features(0.3, 25.0)}));
+
+  fake.AdvanceLoad({100.0, 100.0});
+  GovernorTickStats stats = governor.Tick();
+
+  // scale = 0.3 / (0.3 + 0.1) = 0.75
+  EXPECT_EQ(stats.memory_capped_cpus, 1u);
+  EXPECT_EQ(governor.GetWorkloadPhase(0), WorkloadPhase::kCompute);
+  EXPECT_EQ(governor.GetWorkloadPhase(1), WorkloadPhase::kMemory);
+  EXPECT_EQ(fake.WrittenKhz(0), 4000000u);
+  EXPECT_EQ(fake.WrittenKhz(1), 3000000u);
+
+  // Без источника признаков потолок снимается
+  governor.SetCounterSource(nullptr);
+  fake.AdvanceLoad({100.0, 100.0});
+  EXPECT_EQ(governor.Tick().memory_capped_cpus, 0u);
+  EXPECT_EQ(fake.WrittenKhz(1), 4000000u);
+}
+
+// ============================================================================
+// Performance Benchmarks
+// ============================================================================
+
+TEST(DvfsGovernorPerformanceTest, TickUnder100usOn128Cores) {
+  OptimizationEngine engine;
+  FakeDvfsSystem fake(128, 2);
+  DvfsGovernor governor(engine, fake.Config());
+
+  fake.AdvanceLoad({60.0});
+  governor.Tick();  // Первичная установка частот
+
+  constexpr int ITERATIONS = 200;
+  std::vector<uint64_t> durations;
+  std::ostringstream log;
+  for (int i = 0; i < ITERATIONS; ++i) {
+    durations.push_back(governor.Tick().duration_ns);
+    governor.DrainDecisionLog(log);
+  }
+
+  std::sort(durations.begin(), durations.end());
+  double median_us = durations[ITERATIONS / 2] / 1000.0;
+  std::cout << "Governor tick (128 CPUs): median " << median_us << " µs, p99 "
+            << durations[ITERATIONS * 99 / 100] / 1000.0 << " µs\n";
+
+  if (testing_utils::PerfAssertionsEnabled()) {
+    EXPECT_LT(median_us, 100.0);
+  }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "dvfs_simulator.hpp"
+#include "test_utils.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace hardware_analysis;
+
+namespace {
+
+constexpr uint64_t kReferenceMhz = 4000;
+
+SimulationModels Models() {
+  SimulationModels models;
+  models.thermal.ambient_celsius = 30.0;
+  models.thermal.resistance_c_per_watt = 0.8;
+  models.thermal.time_constant_seconds = 8.0;
+  models.power.idle_watts = 10.0;
+  models.power.dynamic_watts = 70.0;
+  models.reference_mhz = kReferenceMhz;
+  return models;
+}
+
+/**
+ * @brief Трейс 1 Гц: суточный профиль нагрузки с шумом
+ */
+std::vector<ThermalTracePoint> DayTrace(size_t seconds) {
+  SimulationModels models = Models();
+  std::mt19937 rng(11);
+  std::normal_distribution<double> noise(0.0, 8.0);
+
+  std::vector<ThermalTracePoint> trace;
+  trace.reserve(seconds);
+  double temperature = 45.0;
+  for (size_t t = 0; t < seconds; ++t) {
+    double base = 50.0 + 40.0 * std::sin(2.0 * M_PI * t / 86400.0);
+    double burst = (t / 600) % 3 == 0 ? 30.0 : 0.0;
+    double load = std::max(0.0, std::min(100.0, base + burst + noise(rng)));
+    double watts = models.power.Power(load, 1.0);
+    temperature = models.thermal.Predict(temperature, watts, 1.0);
+    trace.push_back({static_cast<double>(t), load, temperature, watts});
+  }
+  return trace;
+}
+
+PolicyCandidate Constant(uint64_t mhz) {
+  return {"constant-" + std::to_string(mhz),
+          [mhz](double, double, const DVFSConfig&) { return mhz; },
+          {mhz, mhz, 85.0, 0.0}};
+}
+
+PolicyCandidate LoadLinear(const DVFSConfig& config) {
+  // CalculateOptimalFrequency без побочных эффектов конструктора движка
+  return {"load-linear",
+          [](double load, double temperature, const DVFSConfig& c) {
+            uint64_t f = c.min_frequency_mhz + static_cast<uint64_t>(
+                (c.max_frequency_mhz - c.min_frequency_mhz) * (load / 100.0));
+            if (temperature > c.target_temperature_celsius) {
+              f = static_cast<uint64_t>(f * c.target_temperature_celsius / temperature);
+            }
+            return std::max(c.min_frequency_mhz, std::min(c.max_frequency_mhz, f));
+          },
+          config};
+}
+
+}  // namespace
+
+// ============================================================================
+// Одиночный прогон
+// ============================================================================
+
+TEST(DvfsSimulatorTest, ReferenceFrequencyReproducesTrace) {
+  std::vector<ThermalTracePoint> trace = DayTrace(3600);
+  DvfsSimulator simulator(trace, Models());
+  SimulationResult result = simulator.Run(Constant(kReferenceMhz));
+
+  double recorded_energy = 0.0;
+  for (size_t k = 1; k < trace.size(); ++k) {
+    recorded_energy += trace[k].power_watts;
+  }
+  EXPECT_DOUBLE_EQ(result.throughput, 1.0);
+  EXPECT_NEAR(result.energy_joules, recorded_energy, 1e-6 * recorded_energy);
+  EXPECT_DOUBLE_EQ(result.mean_frequency_mhz, 4000.0);
+}
+
+TEST(DvfsSimulatorTest, LowerFrequencyTradesThroughputForEnergy) {
+  DvfsSimulator simulator(DayTrace(3600), Models());
+  SimulationResult fast = simulator.Run(Constant(4000));
+  SimulationResult slow = simulator.Run(Constant(2000));
+
+  EXPECT_LT(slow.energy_joules, fast.energy_joules);
+  EXPECT_LT(slow.throughput, 0.95);
+  EXPECT_LT(slow.max_temperature_celsius, fast.max_temperature_celsius);
+}
+
+TEST(DvfsSimulatorTest, MemoryBoundWorkLosesLessAtLowFrequency) {
+  SimulationModels models = Models();
+  models.frequency_sensitivity = 0.3;
+  DvfsSimulator memory_bound(DayTrace(3600), models);
+  DvfsSimulator compute_bound(DayTrace(3600), Models());
+
+  EXPECT_GT(memory_bound.Run(Constant(2000)).throughput,
+            compute_bound.Run(Constant(2000)).throughput);
+}
+
+TEST(DvfsSimulatorTest, CountsThermalViolations) {
+  DvfsSimulator simulator(DayTrace(3600), Models());
+  PolicyCandidate hot = Constant(4000);
+  hot.config.target_temperature_celsius = 70.0;
+
+  SimulationResult result = simulator.Run(hot);
+  EXPECT_GT(result.violation_seconds, 0.0);
+  EXPECT_GT(result.max_temperature_celsius, 70.0);
+}
+
+TEST(DvfsSimulatorTest, FromTraceCalibratesModels) {
+  std::vector<ThermalTracePoint> trace = DayTrace(3600);
+  DvfsSimulator simulator = DvfsSimulator::FromTrace(trace, kReferenceMhz);
+  EXPECT_NEAR(simulator.GetModels().power.dynamic_watts, 70.0, 0.5);
+  EXPECT_NEAR(simulator.GetModels().thermal.time_constant_seconds, 8.0, 0.5);
+  EXPECT_EQ(simulator.TraceSize(), trace.size() - 1);
+}
+
+// ============================================================================
+// Перебор политик
+// ============================================================================
+
+TEST(DvfsSimulatorTest, SweepMatchesSequentialRuns) {
+  DvfsSimulator simulator(DayTrace(7200), Models());
+  std::vector<PolicyCandidate> candidates;
+  for (uint64_t min_mhz = 800; min_mhz <= 2000; min_mhz += 400) {
+    for (double target = 70.0; target <= 90.0; target += 10.0) {
+      candidates.push_back(LoadLinear({min_mhz, 4000, target, 0.0}));
+    }
+  }
+  candidates.push_back(Constant(1200));
+
+  std::vector<SimulationResult> results = simulator.Sweep(candidates, 4);
+  ASSERT_EQ(results.size(), candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    SimulationResult expected = simulator.Run(candidates[i]);
+    EXPECT_EQ(results[i].name, candidates[i].name);
+    EXPECT_DOUBLE_EQ(results[i].energy_joules, expected.energy_joules);
+    EXPECT_DOUBLE_EQ(results[i].throughput, expected.throughput);
+  }
+
+  std::vector<size_t> front = DvfsSimulator::ParetoFront(results, 1e9);
+  ASSERT_FALSE(front.empty());
+  for (size_t i = 1; i < front.size(); ++i) {
+    EXPECT_GE(results[front[i]].energy_joules, results[front[i - 1]].energy_joules);
+    EXPECT_GT(results[front[i]].throughput, results[front[i - 1]].throughput);
+  }
+}
+
+// ============================================================================
+// Performance Benchmarks
+// ============================================================================
+
+TEST(DvfsSimulatorPerformanceTest, SweepsDayOfOneHertzData) {
+  if (!testing_utils::PerfAssertionsEnabled()) {
+    GTEST_SKIP() << "Throughput check runs under ctest -L perf";
+  }
+  DvfsSimulator simulator(DayTrace(86400), Models());
+
+  std::vector<PolicyCandidate> candidates;
+  for (uint64_t min_mhz = 800; min_mhz <= 2400; min_mhz += 200) {
+    for (uint64_t max_mhz = 2400; max_mhz <= 4000; max_mhz += 200) {
+      for (double target = 70.0; target <= 90.0; target += 10.0) {
+        candidates.push_back(LoadLinear({min_mhz, max_mhz, target, 0.0}));
+      }
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<SimulationResult> results = simulator.Sweep(candidates);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double steps_per_second = candidates.size() * simulator.TraceSize() / seconds;
+  std::cout << "DVFS sweep: " << candidates.size() << " configs x " << simulator.TraceSize()
+            << " steps in " << seconds << " s (" << steps_per_second / 1e6
+            << " M steps/s, " << std::thread::hardware_concurrency() << " threads)\n";
+
+  ASSERT_EQ(results.size(), candidates.size());
+  // 1000 конфигураций x сутки 1 Гц за несколько секунд даже на одном ядре
+  EXPECT_GT(steps_per_second, 20e6);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include "energy_scheduler.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief Топология: nodes узлов по cores_per_node физических ядер, у каждого SMT сосед
+ */
+TopologySnapshot MakeTopology(int nodes, int cores_per_node) {
+  TopologySnapshot topology;
+  int cpu = 0;
+  for (int thread = 0; thread < 2; ++thread) {
+    for (int node = 0; node < nodes; ++node) {
+      for (int core = 0; core < cores_per_node; ++core) {
+        topology.cpus.push_back({cpu++, core, node, node});
+      }
+    }
+  }
+  std::sort(topology.cpus.begin(), topology.cpus.end(),
+            [](const CpuTopologyInfo& a, const CpuTopologyInfo& b) { return a.cpu_id < b.cpu_id; });
+  topology.package_count = nodes;
+  topology.numa_node_count = nodes;
+  return topology;
+}
+
+JobProfile Job(const std::string& name, double work, double sensitivity, int node = -1) {
+  JobProfile job;
+  job.name = name;
+  job.work_seconds = work;
+  job.parallel_fraction = 0.95;
+  job.frequency_sensitivity = sensitivity;
+  job.numa_node = node;
+  return job;
+}
+
+SchedulerConfig Config(double deadline) {
+  SchedulerConfig config;
+  config.deadline_seconds = deadline;
+  config.reference_mhz = 4000;
+  config.frequencies_mhz = {1000, 2000, 3000, 4000};
+  return config;
+}
+
+/**
+ * @brief Проверка, что задания не делят ядро одновременно
+ */
+void ExpectNoOverlap(const SchedulePlan& plan) {
+  std::map<int, std::vector<std::pair<double, double>>> busy;
+  for (const auto& placement : plan.placements) {
+    for (int cpu : placement.cpus) {
+      busy[cpu].push_back({placement.start_seconds,
+                           placement.start_seconds + placement.duration_seconds});
+    }
+  }
+  for (auto& entry : busy) {
+    std::sort(entry.second.begin(), entry.second.end());
+    for (size_t i = 1; i < entry.second.size(); ++i) {
+      EXPECT_LE(entry.second[i - 1].second, entry.second[i].first + 1e-9)
+          << "cpu " << entry.first;
+    }
+  }
+}
+
+}  // namespace
+
+// ============================================================================
+// Модель
+// ============================================================================
+
+TEST(EnergyAwareSchedulerTest, PredictsAmdahlAndFrequencyScaling) {
+  EnergyAwareScheduler scheduler(MakeTopology(1, 4), Config(0.0));
+  JobProfile compute = Job("compute", 10.0, 1.0);
+  JobProfile memory = Job("memory", 10.0, 0.2);
+
+  EXPECT_DOUBLE_EQ(scheduler.PredictDuration(compute, 1, 4000), 10.0);
+  EXPECT_DOUBLE_EQ(scheduler.PredictDuration(compute, 4, 4000), 10.0 * (0.05 + 0.95 / 4));
+  EXPECT_DOUBLE_EQ(scheduler.PredictDuration(compute, 1, 2000), 20.0);
+  // Половина частоты замедляет задание с упором в память только на 20%
+  EXPECT_DOUBLE_EQ(scheduler.PredictDuration(memory, 1, 2000), 12.0);
+
+  // Для задания с упором в память низкая частота экономит энергию
+  EXPECT_LT(scheduler.PredictEnergy(memory, 1, 2000), scheduler.PredictEnergy(memory, 1, 4000));
+}
+
+TEST(EnergyAwareSchedulerTest, SkipsSmtSiblingsByDefault) {
+  TopologySnapshot topology = MakeTopology(2, 4);
+  EnergyAwareScheduler scheduler(topology, Config(0.0));
+  ASSERT_EQ(scheduler.NodeCpus().size(), 2u);
+  EXPECT_EQ(scheduler.NodeCpus()[0], (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(scheduler.NodeCpus()[1], (std::vector<int>{4, 5, 6, 7}));
+
+  SchedulerConfig config = Config(0.0);
+  config.use_smt_siblings = true;
+  config.cpus = {0, 1, 8, 9};
+  EnergyAwareScheduler smt(topology, config);
+  ASSERT_EQ(smt.NodeCpus().size(), 1u);
+  EXPECT_EQ(smt.NodeCpus()[0], (std::vector<int>{0, 1, 8, 9}));
+
+  config.cpus = {100};
+  EXPECT_THROW(EnergyAwareScheduler(topology, config), std::invalid_argument);
+}
+
+// ============================================================================
+// Планирование
+// ============================================================================
+
+TEST(EnergyAwareSchedulerTest, LooseDeadlineLowersFrequency) {
+  std::vector<JobProfile> jobs = {Job("a", 4.0, 0.3), Job("b", 4.0, 0.3),
+                                  Job("c", 4.0, 1.0), Job("d", 4.0, 1.0)};
+  EnergyAwareScheduler scheduler(MakeTopology(2, 4), Config(100.0));
+  SchedulePlan baseline = scheduler.PlanBaseline(jobs);
+  SchedulePlan plan = scheduler.Plan(jobs);
+
+  ASSERT_EQ(plan.placements.size(), 4u);
+  EXPECT_TRUE(plan.meets_deadline);
+  EXPECT_LT(plan.energy_joules, baseline.energy_joules);
+  for (const auto& placement : baseline.placements) {
+    EXPECT_EQ(placement.frequency_mhz, 4000u);
+    EXPECT_EQ(placement.cpus.size(), 4u);
+  }
+  for (const auto& placement : plan.placements) {
+    EXPECT_LT(placement.frequency_mhz, 4000u) << jobs[placement.job].name;
+  }
+  ExpectNoOverlap(plan);
+}
+
+TEST(EnergyAwareSchedulerTest, TightDeadlineIsMet) {
+  std::vector<JobProfile> jobs;
+  for (int i = 0; i < 6; ++i) {
+    jobs.push_back(Job("job" + std::to_string(i), 2.0 + i, i % 2 ? 0.3 : 1.0));
+  }
+  EnergyAwareScheduler unconstrained(MakeTopology(2, 4), Config(0.0));
+  SchedulePlan cheapest = unconstrained.Plan(jobs);
+  SchedulePlan baseline = unconstrained.PlanBaseline(jobs);
+
+  double deadline = baseline.makespan_seconds +
+                    0.25 * (cheapest.makespan_seconds - baseline.makespan_seconds);
+  EnergyAwareScheduler scheduler(MakeTopology(2, 4), Config(deadline));
+  SchedulePlan plan = scheduler.Plan(jobs);
+
+  EXPECT_TRUE(plan.meets_deadline);
+  EXPECT_LE(plan.makespan_seconds, deadline);
+  EXPECT_GE(plan.energy_joules, cheapest.energy_joules - 1e-9);
+  EXPECT_LE(plan.energy_joules, baseline.energy_joules + 1e-9);
+  ExpectNoOverlap(plan);
+}
+
+TEST(EnergyAwareSchedulerTest, UnreachableDeadlineReturnsFastestPlan) {
+  std::vector<JobProfile> jobs = {Job("a", 10.0, 1.0), Job("b", 10.0, 1.0)};
+  EnergyAwareScheduler scheduler(MakeTopology(1, 2), Config(0.5));
+  SchedulePlan plan = scheduler.Plan(jobs);
+
+  EXPECT_FALSE(plan.meets_deadline);
+  EXPECT_LE(plan.makespan_seconds, scheduler.PlanBaseline(jobs).makespan_seconds);
+  // Быстрее всего - по ядру на задание на максимальной частоте
+  EXPECT_DOUBLE_EQ(plan.makespan_seconds, 10.0);
+}
+
+TEST(EnergyAwareSchedulerTest, HonoursJobNumaNode) {
+  std::vector<JobProfile> jobs = {Job("a", 2.0, 1.0, 1), Job("b", 2.0, 1.0, 1),
+                                  Job("c", 2.0, 1.0, 7)};
+  jobs[0].max_cores = 2;
+  EnergyAwareScheduler scheduler(MakeTopology(2, 4), Config(0.0));
+  SchedulePlan plan = scheduler.Plan(jobs);
+
+  for (const auto& placement : plan.placements) {
+    if (placement.job < 2) {
+      EXPECT_EQ(placement.numa_node, 1);
+      for (int cpu : placement.cpus) {
+        EXPECT_GE(cpu, 4);
+        EXPECT_LT(cpu, 8);
+      }
+    }
+    if (placement.job == 0) {
+      EXPECT_LE(placement.cpus.size(), 2u);
+    }
+  }
+  ExpectNoOverlap(plan);
+}
+
+TEST(EnergyAwareSchedulerTest, KeepsJobThreadsInOneLastLevelCache) {
+  TopologySnapshot topology = MakeTopology(1, 4);
+  // LLC чередуются по номерам: {0, 2} и {1, 3}
+  CacheInfo even;
+  even.level = 3;
+  even.shared_cpus = {0, 2, 4, 6};
+  CacheInfo odd = even;
+  odd.shared_cpus = {1, 3, 5, 7};
+  topology.caches.caches = {even, odd};
+
+  std::vector<JobProfile> jobs = {Job("a", 4.0, 1.0), Job("b", 4.0, 1.0)};
+  jobs[0].max_cores = 2;
+  jobs[1].max_cores = 2;
+  EnergyAwareScheduler scheduler(topology, Config(0.0));
+  SchedulePlan plan = scheduler.PlanBaseline(jobs);
+
+  ASSERT_EQ(plan.placements.size(), 2u);
+  for (const auto& placement : plan.placements) {
+    ASSERT_EQ(placement.cpus.size(), 2u);
+    EXPECT_EQ(topology.LastLevelCacheId(placement.cpus[0]),
+              topology.LastLevelCacheId(placement.cpus[1]))
+        << placement.cpus[0] << "," << placement.cpus[1];
+  }
+  ExpectNoOverlap(plan);
+}
+
+// ============================================================================
+// Выполнение
+// ============================================================================
+
+TEST(PinnedWorkerPoolTest, RunsEveryShardAndSetsFrequency) {
+  TempDir dir;
+  dir.WriteFile("cpu/cpu0/cpufreq/scaling_setspeed", "");
+
+  std::mutex mutex;
+  std::multiset<std::pair<size_t, size_t>> calls;
+  auto record = [&](size_t job) {
+    return [&, job](size_t shard, size_t shards) {
+      std::lock_guard<std::mutex> lock(mutex);
+      calls.insert({job, shard});
+      EXPECT_EQ(shards, 1u);
+    };
+  };
+  std::vector<BatchJob> jobs = {{Job("a", 1.0, 1.0), record(0)}, {Job("b", 1.0, 1.0), record(1)}};
+
+  SchedulePlan plan;
+  plan.placements.push_back({0, 0, {0}, 2000, 0.0, 1.0, 1.0});
+  plan.placements.push_back({1, 0, {0}, 3000, 1.0, 1.0, 1.0});
+
+  PinnedWorkerPool pool({0}, dir.path() + "/cpu");
+  EXPECT_EQ(pool.PinnedWorkers(), 1u);
+  ExecutionReport report = pool.Execute(plan, jobs, nullptr, 4000);
+
+  EXPECT_EQ(report.shards, 2u);
+  EXPECT_EQ(report.frequency_failures, 0u);
+  EXPECT_TRUE(std::isnan(report.energy_joules));
+  EXPECT_EQ(calls, (std::multiset<std::pair<size_t, size_t>>{{0, 0}, {1, 0}}));
+  // После выполнения - частота восстановления
+  EXPECT_EQ(dir.ReadFile("cpu/cpu0/cpufreq/scaling_setspeed"), "4000000\n");
+
+  // Пул переиспользуется
+  calls.clear();
+  pool.Execute(plan, jobs, nullptr);
+  EXPECT_EQ(calls.size(), 2u);
+
+  plan.placements[0].cpus = {5};
+  EXPECT_THROW(pool.Execute(plan, jobs, nullptr), std::invalid_argument);
+}
+
+TEST(PinnedWorkerPoolTest, SyntheticJobsRunToCompletion) {
+  std::vector<BatchJob> jobs = MakeSyntheticJobs(2, 0.02, 7, 1u << 20);
+  ASSERT_EQ(jobs.size(), 2u);
+  EXPECT_DOUBLE_EQ(jobs[0].profile.frequency_sensitivity, 1.0);
+  EXPECT_LT(jobs[1].profile.frequency_sensitivity, 1.0);
+
+  TopologySnapshot topology;
+  topology.cpus.push_back({0, 0, 0, 0});
+  topology.package_count = 1;
+  topology.numa_node_count = 1;
+  SchedulerConfig config = Config(0.0);
+  config.frequencies_mhz = {4000};
+  EnergyAwareScheduler scheduler(topology, config);
+
+  std::vector<JobProfile> profiles = {jobs[0].profile, jobs[1].profile};
+  SchedulePlan plan = scheduler.Plan(profiles);
+  TempDir dir;
+  PinnedWorkerPool pool({0}, dir.path());   // Записи частоты не удаются - выполнение идёт
+  ExecutionReport report = pool.Execute(plan, jobs, nullptr);
+
+  EXPECT_EQ(report.shards, 2u);
+  EXPECT_EQ(report.frequency_failures, 2u);
+  EXPECT_GT(report.wall_seconds, 0.0);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
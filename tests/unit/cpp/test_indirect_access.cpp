@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "indirect_access.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+
+namespace {
+
+const std::vector<GatherIsa> kIsas = {GatherIsa::kScalar, GatherIsa::kAvx2, GatherIsa::kAvx512,
+                                      GatherIsa::kAuto};
+const std::vector<PrefetchSetting> kSettings = {{0, 0}, {3, 1}, {16, 0}, {1000, 3}};
+
+std::vector<uint32_t> RandomIndices(size_t count, uint32_t range) {
+  std::vector<uint32_t> indices(count);
+  uint32_t state = 12345;
+  for (auto& index : indices) {
+    state = state * 1664525u + 1013904223u;
+    index = (state >> 8) % range;
+  }
+  return indices;
+}
+
+}  // namespace
+
+// ============================================================================
+// Gather
+// ============================================================================
+
+TEST(GatherTest, AllIsasMatchScalarLookup) {
+  std::vector<int32_t> table(1000);
+  std::vector<double> dtable(1000);
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i] = static_cast<int32_t>(i * 7) - 3000;
+    dtable[i] = 0.5 * static_cast<double>(i);
+  }
+
+  // Размеры не кратны ширине вектора: проверяется хвост
+  for (size_t count : {0u, 1u, 7u, 8u, 17u, 33u, 500u}) {
+    std::vector<uint32_t> indices = RandomIndices(count, 1000);
+    int64_t expected_sum = 0;
+    for (uint32_t index : indices) {
+      expected_sum += table[index];
+    }
+    for (GatherIsa isa : kIsas) {
+      for (const auto& setting : kSettings) {
+        std::vector<int32_t> out(count, -1);
+        std::vector<double> dout(count, -1.0);
+        Gather(table.data(), indices.data(), count, out.data(), setting, isa);
+        Gather(dtable.data(), indices.data(), count, dout.data(), setting, isa);
+        for (size_t i = 0; i < count; ++i) {
+          ASSERT_EQ(out[i], table[indices[i]]) << GatherIsaName(isa) << " count " << count;
+          ASSERT_DOUBLE_EQ(dout[i], dtable[indices[i]]) << GatherIsaName(isa);
+        }
+        EXPECT_EQ(GatherSum(table.data(), indices.data(), count, setting, isa), expected_sum)
+            << GatherIsaName(isa) << " count " << count;
+      }
+    }
+  }
+}
+
+TEST(GatherTest, SumDoesNotOverflowInt32) {
+  std::vector<int32_t> table = {INT32_MAX};
+  std::vector<uint32_t> indices(100, 0);
+  for (GatherIsa isa : kIsas) {
+    EXPECT_EQ(GatherSum(table.data(), indices.data(), indices.size(), {}, isa),
+              100LL * INT32_MAX)
+        << GatherIsaName(isa);
+  }
+}
+
+TEST(GatherTest, UnsupportedIsaFallsBackToScalar) {
+  EXPECT_TRUE(GatherIsaSupported(GatherIsa::kScalar));
+  EXPECT_NE(ResolveGatherIsa(GatherIsa::kAuto), GatherIsa::kAuto);
+  if (!GatherIsaSupported(GatherIsa::kAvx512)) {
+    EXPECT_EQ(ResolveGatherIsa(GatherIsa::kAvx512), GatherIsa::kScalar);
+  }
+}
+
+// ============================================================================
+// FlatHashMap
+// ============================================================================
+
+TEST(FlatHashMapTest, InsertFindAndReplace) {
+  FlatHashMap map(100);
+  EXPECT_GE(map.Capacity(), 200u);
+  for (uint64_t key = 0; key < 100; ++key) {
+    EXPECT_TRUE(map.Insert(key * 1000, key));
+  }
+  EXPECT_FALSE(map.Insert(5000, 55));
+  EXPECT_EQ(map.Size(), 100u);
+
+  uint64_t value = 0;
+  EXPECT_TRUE(map.Find(5000, &value));
+  EXPECT_EQ(value, 55u);
+  EXPECT_TRUE(map.Find(99000, &value));
+  EXPECT_EQ(value, 99u);
+  EXPECT_FALSE(map.Find(1, &value));
+  EXPECT_FALSE(map.Find(FlatHashMap::kEmptyKey, &value));
+
+  EXPECT_THROW(map.Insert(FlatHashMap::kEmptyKey, 0), std::invalid_argument);
+  EXPECT_THROW(FlatHashMap(10, 1.0), std::invalid_argument);
+}
+
+TEST(FlatHashMapTest, RejectsInsertBeyondLoadFactor) {
+  FlatHashMap map(8, 0.5);
+  size_t limit = map.Capacity() / 2;
+  for (uint64_t key = 0; key < limit; ++key) {
+    map.Insert(key, key);
+  }
+  EXPECT_THROW(map.Insert(limit, 0), std::length_error);
+}
+
+TEST(FlatHashMapTest, BatchMatchesSingleLookups) {
+  FlatHashMap map(1000);
+  for (uint64_t key = 0; key < 1000; ++key) {
+    map.Insert(key * 3, key + 1);
+  }
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 1500; key += 7) {
+    keys.push_back(key);
+  }
+
+  for (size_t group : {1u, 5u, 16u, 64u, 1000u}) {
+    std::vector<uint64_t> values(keys.size(), 0);
+    std::vector<uint8_t> found(keys.size(), 2);
+    size_t hits = map.FindBatch(keys.data(), keys.size(), values.data(), found.data(), group);
+
+    size_t expected_hits = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      uint64_t value = 0;
+      bool hit = map.Find(keys[i], &value);
+      expected_hits += hit;
+      ASSERT_EQ(found[i], hit ? 1 : 0) << "key " << keys[i];
+      if (hit) {
+        ASSERT_EQ(values[i], value);
+      }
+    }
+    EXPECT_EQ(hits, expected_hits) << "group " << group;
+  }
+}
+
+// ============================================================================
+// Микробенчмарк
+// ============================================================================
+
+TEST(IndirectBenchmarkTest, ReportsEveryVariant) {
+  IndirectBenchConfig config;
+  config.table_bytes = 1u << 20;
+  config.lookups = 10000;
+  config.repetitions = 1;
+  std::vector<IndirectBenchResult> results = RunIndirectBenchmark(config);
+
+  size_t isas = 1 + GatherIsaSupported(GatherIsa::kAvx2) + GatherIsaSupported(GatherIsa::kAvx512);
+  ASSERT_EQ(results.size(), 2 * isas + 2);
+  EXPECT_EQ(results.front().name, "gather scalar");
+  EXPECT_DOUBLE_EQ(results.front().speedup, 1.0);
+  EXPECT_EQ(results.back().name, "hash probe batch 16");
+  for (const auto& result : results) {
+    EXPECT_GT(result.ns_per_lookup, 0.0) << result.name;
+  }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "benchmark_report.hpp"
+#include "machine_profile.hpp"
+#include "test_utils.hpp"
+#include <stdexcept>
+
+#include <boost/property_tree/ptree.hpp>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+// ============================================================================
+// DistributionSummary
+// ============================================================================
+
+TEST(DistributionSummaryTest, ComputesQuantiles) {
+  std::vector<double> values;
+  for (int i = 100; i >= 1; --i) {
+    values.push_back(i);
+  }
+  DistributionSummary summary = DistributionSummary::FromSamples(values);
+  EXPECT_EQ(summary.count, 100u);
+  EXPECT_DOUBLE_EQ(summary.min, 1.0);
+  EXPECT_DOUBLE_EQ(summary.max, 100.0);
+  EXPECT_DOUBLE_EQ(summary.p50, 50.5);
+  EXPECT_NEAR(summary.p99, 99.01, 1e-9);
+  EXPECT_DOUBLE_EQ(summary.mean, 50.5);
+  EXPECT_EQ(values.front(), 100.0);   // Исходная выборка не сортируется
+}
+
+TEST(DistributionSummaryTest, EmptySampleIsZero) {
+  DistributionSummary summary = DistributionSummary::FromSamples({});
+  EXPECT_EQ(summary.count, 0u);
+  EXPECT_EQ(summary.p99, 0.0);
+}
+
+TEST(DistributionSummaryTest, RoundTripsThroughTree) {
+  DistributionSummary summary = DistributionSummary::FromSamples({1.0, 2.0, 3.0, 10.0});
+  boost::property_tree::ptree tree;
+  summary.Store(tree);
+  DistributionSummary loaded = DistributionSummary::Load(tree);
+  EXPECT_EQ(loaded.count, 4u);
+  EXPECT_DOUBLE_EQ(loaded.p90, summary.p90);
+  EXPECT_DOUBLE_EQ(loaded.max, 10.0);
+}
+
+// ============================================================================
+// MachineProfile
+// ============================================================================
+
+TEST(MachineProfileTest, DetectsCpuModel) {
+  TempDir dir;
+  dir.WriteFile("proc/cpuinfo",
+                "processor\t: 0\nvendor_id\t: GenuineIntel\n"
+                "model name\t: Intel(R) Xeon(R) Gold 6230 CPU @ 2.10GHz  \n");
+  EXPECT_EQ(MachineProfile::DetectCpuModel(dir.path() + "/proc"),
+            "Intel(R) Xeon(R) Gold 6230 CPU @ 2.10GHz");
+  EXPECT_EQ(MachineProfile::DetectCpuModel(dir.path() + "/missing"), "unknown");
+}
+
+TEST(MachineProfileTest, DetectsCacheSignature) {
+  TempDir dir;
+  const char* caches[][3] = {{"1", "Data", "48K"}, {"1", "Instruction", "32K"},
+                             {"2", "Unified", "2048K"}, {"3", "Unified", "36864K"}};
+  for (int i = 0; i < 4; ++i) {
+    std::string index = "cpu/cpu0/cache/index" + std::to_string(i);
+    dir.WriteFile(index + "/level", std::string(caches[i][0]) + "\n");
+    dir.WriteFile(index + "/type", std::string(caches[i][1]) + "\n");
+    dir.WriteFile(index + "/size", std::string(caches[i][2]) + "\n");
+  }
+  EXPECT_EQ(MachineProfile::DetectCacheSignature(dir.path() + "/cpu"),
+            "L1d:48K L1i:32K L2:2048K L3:36864K");
+  EXPECT_EQ(MachineProfile::DetectCacheSignature(dir.path() + "/missing"), "unknown");
+}
+
+TEST(MachineProfileTest, MissingFileGivesEmptyProfile) {
+  TempDir dir;
+  MachineProfile profile = MachineProfile::Load(dir.path() + "/none.json", "cpu");
+  EXPECT_FALSE(profile.Has("frequency_transition"));
+  EXPECT_EQ(profile.Get<int>("x.y", 7), 7);
+}
+
+TEST(MachineProfileTest, KeepsOtherModelsOnSave) {
+  TempDir dir;
+  std::string path = dir.path() + "/nested/profile.json";
+
+  MachineProfile first("Model A @ 3.00GHz");
+  first.Put("prefetch.distance", 16);
+  first.Save(path);
+
+  MachineProfile second("Model B @ 2.50GHz");
+  second.Put("prefetch.distance", 32);
+  second.Save(path);
+
+  EXPECT_EQ(MachineProfile::Load(path, "Model A @ 3.00GHz").Get<int>("prefetch.distance", 0), 16);
+  EXPECT_EQ(MachineProfile::Load(path, "Model B @ 2.50GHz").Get<int>("prefetch.distance", 0), 32);
+  EXPECT_FALSE(MachineProfile::Load(path, "Model C").Has("prefetch"));
+}
+
+TEST(MachineProfileTest, IgnoresOtherFormatVersion) {
+  TempDir dir;
+  std::string path = dir.WriteFile("profile.json",
+                                   "{\"version\": 99, \"machines\": {\"cpu\": {\"a\": \"1\"}}}");
+  EXPECT_FALSE(MachineProfile::Load(path, "cpu").Has("a"));
+}
+
+TEST(MachineProfileTest, RefusesToOverwriteOtherFormatVersion) {
+  TempDir dir;
+  const std::string content = "{\"version\": 99, \"machines\": {\"cpu\": {\"a\": \"1\"}}}";
+  std::string path = dir.WriteFile("profile.json", content);
+  MachineProfile profile("other");
+  profile.Put("b", 2);
+  EXPECT_THROW(profile.Save(path), std::runtime_error);
+  EXPECT_EQ(dir.ReadFile("profile.json"), content);
+}
+
+TEST(MachineProfileTest, RejectsMalformedJson) {
+  TempDir dir;
+  std::string path = dir.WriteFile("profile.json", "{ not json");
+  EXPECT_THROW(MachineProfile::Load(path, "cpu"), std::runtime_error);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
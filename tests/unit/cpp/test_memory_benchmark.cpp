@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+#include "benchmark_report.hpp"
+#include "cache_topology.hpp"
+#include "machine_profile.hpp"
+#include "memory_benchmark.hpp"
+#include "optimization_engine.hpp"
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+using namespace hardware_analysis;
+
+namespace {
+
+/**
+ * @brief Маленькие размеры: весь набор укладывается в доли секунды
+ */
+MemoryBenchConfig SmallConfig() {
+  MemoryBenchConfig config;
+  config.min_working_set = 4u << 10;
+  config.max_working_set = 64u << 10;
+  config.chase_accesses = 1u << 14;
+  config.bandwidth_bytes = 1u << 20;
+  config.bandwidth_passes = 2;
+  config.stride_buffer_bytes = 1u << 20;
+  config.strides = {8, 64, 4096};
+  config.min_tlb_pages = 16;
+  config.max_tlb_pages = 64;
+  config.repetitions = 1;
+  config.saturation_seconds = 0.02;
+  config.saturation_chase_bytes = 1u << 20;
+  return config;
+}
+
+}  // namespace
+
+// ============================================================================
+// Построение тестов
+// ============================================================================
+
+TEST(MemoryBenchmarkTest, WorkingSetSizesCoverRange) {
+  EXPECT_EQ(MemoryBenchmark::WorkingSetSizes(4096, 32768, 1),
+            (std::vector<size_t>{4096, 8192, 16384, 32768}));
+
+  std::vector<size_t> sizes = MemoryBenchmark::WorkingSetSizes(4096, 16384, 2);
+  // 4K, 5.7K, 8K, 11.3K, 16K - промежуточные точки выровнены на линию
+  ASSERT_EQ(sizes.size(), 5u);
+  EXPECT_EQ(sizes.front(), 4096u);
+  EXPECT_EQ(sizes.back(), 16384u);
+  for (size_t i = 1; i < sizes.size(); ++i) {
+    EXPECT_GT(sizes[i], sizes[i - 1]);
+    EXPECT_EQ(sizes[i] % 64, 0u);
+  }
+}
+
+TEST(MemoryBenchmarkTest, ChaseOrderIsSingleCycle) {
+  for (size_t count : {2u, 3u, 97u, 4096u}) {
+    std::vector<uint32_t> next = MemoryBenchmark::ChaseOrder(count, 42);
+    std::set<uint32_t> visited;
+    uint32_t node = 0;
+    for (size_t step = 0; step < count; ++step) {
+      ASSERT_TRUE(visited.insert(node).second) << "short cycle at " << step;
+      node = next[node];
+    }
+    EXPECT_EQ(node, 0u);
+    EXPECT_EQ(visited.size(), count);
+  }
+  EXPECT_EQ(MemoryBenchmark::ChaseOrder(100, 1), MemoryBenchmark::ChaseOrder(100, 1));
+  EXPECT_NE(MemoryBenchmark::ChaseOrder(100, 1), MemoryBenchmark::ChaseOrder(100, 2));
+}
+
+TEST(MemoryBenchmarkTest, BuffersHonourPageSize) {
+  BenchmarkBuffer small(10000, PageSize::k4K);
+  EXPECT_EQ(small.size(), 10000u);
+  EXPECT_EQ(small.backing(), "4k");
+  EXPECT_EQ(small.data()[9999], 0);
+
+  BenchmarkBuffer huge(4096, PageSize::k2M);
+  // Без пула hugetlbfs - THP на выровненной области
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(huge.data()) % (2u << 20), 0u);
+  EXPECT_NE(huge.backing(), "");
+
+  EXPECT_THROW(BenchmarkBuffer(0, PageSize::k4K), std::invalid_argument);
+}
+
+// ============================================================================
+// Измерения
+// ============================================================================
+
+TEST(MemoryBenchmarkTest, SuitesProduceRecords) {
+  MemoryBenchmark benchmark(SmallConfig());
+
+  std::vector<LatencyPoint> curve = benchmark.LatencyCurve();
+  ASSERT_EQ(curve.size(), 9u);
+  for (const auto& point : curve) {
+    EXPECT_GT(point.ns_per_access, 0.0);
+  }
+
+  std::vector<BandwidthResult> bandwidth = benchmark.Bandwidth();
+  ASSERT_EQ(bandwidth.size(), 3u);
+  EXPECT_EQ(bandwidth[0].kind, "read");
+  EXPECT_EQ(bandwidth[2].kind, "copy");
+  for (const auto& result : bandwidth) {
+    EXPECT_EQ(result.threads, 1u);
+    EXPECT_GT(result.gbs, 0.0);
+  }
+
+  std::vector<StridePoint> strides = benchmark.StrideSweep();
+  ASSERT_EQ(strides.size(), 3u);
+  EXPECT_EQ(strides[2].stride, 4096u);
+
+  std::vector<TlbPoint> tlb = benchmark.TlbReach(PageSize::k2M);
+  ASSERT_EQ(tlb.size(), 3u);
+  EXPECT_EQ(tlb.back().pages, 64u);
+
+  std::vector<BenchmarkRecord> records = benchmark.Run({"latency", "tlb"});
+  // 9 точек латентности + 2 x 3 точки TLB
+  ASSERT_EQ(records.size(), 15u);
+  EXPECT_EQ(records.front().name, "memory/latency/ws:4096");
+  EXPECT_EQ(records.back().name, "memory/tlb/pages:64/page:2m");
+  EXPECT_THROW(benchmark.Run({"cache"}), std::invalid_argument);
+}
+
+TEST(MemoryBenchmarkTest, MultiThreadedBandwidthSharesStart) {
+  MemoryBenchConfig config = SmallConfig();
+  config.cpus = {0, 0, 0};   // Больше потоков, чем CPU: барьер не должен зависнуть
+  MemoryBenchmark benchmark(config);
+  for (const auto& result : benchmark.Bandwidth()) {
+    EXPECT_EQ(result.threads, 3u);
+    EXPECT_GT(result.gbs, 0.0);
+  }
+}
+
+TEST(MemoryBenchmarkTest, ReportsWorkerAllocationFailure) {
+  MemoryBenchConfig config = SmallConfig();
+  config.cpus = {0, 0};
+  config.bandwidth_bytes = 1ull << 60;   // mmap отказывает в каждом потоке
+  MemoryBenchmark benchmark(config);
+  EXPECT_THROW(benchmark.Bandwidth(), std::runtime_error);
+  EXPECT_THROW(benchmark.SaturationCurve("read"), std::runtime_error);
+}
+
+TEST(MemoryBenchmarkTest, ReadBandwidthRepeatsSmallSets) {
+  MemoryBenchmark benchmark(SmallConfig());
+  // 16 КБ читаются 64 раза до bandwidth_bytes
+  EXPECT_GT(benchmark.ReadBandwidth(16u << 10), 0.0);
+  EXPECT_GT(benchmark.ReadBandwidth(1), 0.0);
+}
+
+TEST(MemoryBenchmarkTest, SaturationCurveSweepsThreads) {
+  MemoryBenchConfig config = SmallConfig();
+  config.cpus = {0, 0, 0};
+  MemoryBenchmark benchmark(config);
+  for (const char* kind : {"read", "mixed"}) {
+    std::vector<SaturationPoint> curve = benchmark.SaturationCurve(kind);
+    ASSERT_EQ(curve.size(), 3u);
+    for (size_t i = 0; i < curve.size(); ++i) {
+      EXPECT_EQ(curve[i].kind, kind);
+      EXPECT_EQ(curve[i].threads, i + 1);
+      EXPECT_GT(curve[i].gbs, 0.0);
+    }
+    // Зонд идёт на следующем CPU списка, для всех потоков его нет
+    EXPECT_GT(curve[0].loaded_latency_ns, 0.0);
+    EXPECT_TRUE(std::isnan(curve[2].loaded_latency_ns));
+  }
+  EXPECT_THROW(benchmark.SaturationCurve("copy"), std::invalid_argument);
+}
+
+TEST(MemoryBenchmarkTest, SaturationKneeInProfileCapsEngine) {
+  std::vector<SaturationPoint> curve = {{"read", 1, 10.0, 90.0},
+                                        {"read", 2, 19.0, 95.0},
+                                        {"read", 3, 26.0, 120.0},
+                                        {"read", 4, 28.0, 180.0},
+                                        {"read", 5, 28.5, 260.0},
+                                        {"read", 6, 28.0, std::nan("")}};
+  // 90% пика 28.5 - 25.65 GB/s
+  EXPECT_EQ(MemoryBenchmark::SaturationKnee(curve), 3u);
+  EXPECT_EQ(MemoryBenchmark::SaturationKnee(curve, 1.0), 5u);
+  EXPECT_EQ(MemoryBenchmark::SaturationKnee({}), 0u);
+
+  auto records = MemoryBenchmark::SaturationRecords(curve, 1);
+  ASSERT_EQ(records.size(), 6u);
+  EXPECT_EQ(records[2].name, "memory/saturation/read/node:1/threads:3");
+
+  MachineProfile profile("cpu");
+  MemoryBenchmark::StoreSaturationInProfile(1, curve, profile);
+  // Точка без зонда не выдаёт ноль за измеренную задержку
+  EXPECT_TRUE(profile.Has("memory_saturation.node1.read.threads.5.loaded_latency_ns"));
+  EXPECT_FALSE(profile.Has("memory_saturation.node1.read.threads.6.loaded_latency_ns"));
+  EXPECT_TRUE(profile.Has("memory_saturation.node1.read.threads.6.gbs"));
+  curve.resize(2);
+  curve[0].kind = curve[1].kind = "write";
+  MemoryBenchmark::StoreSaturationInProfile(1, curve, profile);
+  EXPECT_EQ(MemoryBenchmark::LoadSaturationKnee(profile, 1), 3u);
+  EXPECT_EQ(MemoryBenchmark::LoadSaturationKnee(profile, 1, "write"), 2u);
+  EXPECT_EQ(MemoryBenchmark::LoadSaturationKnee(profile, 0), 0u);
+  EXPECT_DOUBLE_EQ(profile.Get<double>("memory_saturation.node1.read.threads.4.gbs", 0.0), 28.0);
+
+  OptimizationEngine engine;
+  EXPECT_EQ(engine.LoadMemorySaturation(profile), 1u);
+  EXPECT_EQ(engine.GetMemoryThreadCap(1), 3u);
+  EXPECT_EQ(engine.GetMemoryThreadCap(0), 0u);
+
+  // Потоков не больше колена узла; без узла - самый низкий потолок
+  engine.SetMemoryThreadCap(0, 2);
+  ReductionParallelism parallelism;
+  parallelism.threads = 8;
+  parallelism.chunk = 1024;
+  engine.SetReductionParallelism(parallelism);
+  std::vector<double> data(100000, 0.5);
+  EXPECT_EQ(engine.ParallelSumThreads(data.size(), 1), 3u);
+  EXPECT_EQ(engine.ParallelSumThreads(data.size(), 0), 2u);
+  EXPECT_EQ(engine.ParallelSumThreads(data.size()), 2u);
+  EXPECT_EQ(engine.ParallelSumThreads(2048, 1), 2u);     // Порций меньше потолка
+  OptimizationEngine uncapped;
+  uncapped.SetReductionParallelism(parallelism);
+  EXPECT_EQ(uncapped.ParallelSumThreads(data.size()), 8u);
+
+  // Ограничение не меняет результат редукции
+  EXPECT_DOUBLE_EQ(engine.ParallelSum(data.data(), data.size()), 50000.0);
+  EXPECT_DOUBLE_EQ(engine.ParallelSum(data.data(), data.size(), 1), 50000.0);
+}
+
+TEST(MemoryBenchmarkTest, LevelLatenciesPickPlateaus) {
+  CacheTopology caches;
+  CacheInfo l1{1, CacheType::kData, 32u << 10, 64, 8, 64, {0}};
+  CacheInfo l2{2, CacheType::kUnified, 1u << 20, 64, 16, 1024, {0}};
+  caches.caches = {l1, l2};
+  std::vector<LatencyPoint> curve = {{8u << 10, PageSize::k4K, 1.0},
+                                     {16u << 10, PageSize::k4K, 1.2},
+                                     {256u << 10, PageSize::k4K, 4.0},
+                                     {4u << 20, PageSize::k4K, 80.0}};
+  auto levels = MemoryBenchmark::LevelLatencies(curve, caches);
+  ASSERT_EQ(levels.size(), 3u);
+  EXPECT_EQ(levels[0], (std::pair<std::string, double>{"L1", 1.2}));
+  EXPECT_EQ(levels[1], (std::pair<std::string, double>{"L2", 4.0}));
+  EXPECT_EQ(levels[2], (std::pair<std::string, double>{"DRAM", 80.0}));
+  EXPECT_TRUE(MemoryBenchmark::LevelLatencies(curve, CacheTopology()).empty());
+}
+
+TEST(MemoryBenchmarkTest, RejectsInvalidConfig) {
+  MemoryBenchConfig config = SmallConfig();
+  config.max_working_set = 1024;
+  EXPECT_THROW(MemoryBenchmark{config}, std::invalid_argument);
+  config = SmallConfig();
+  config.max_tlb_pages = 1;
+  EXPECT_THROW(MemoryBenchmark{config}, std::invalid_argument);
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+TEST(MemoryBenchmarkTest, JsonFollowsGoogleBenchmarkLayout) {
+  CacheTopology caches;
+  caches.caches = {CacheInfo{1, CacheType::kData, 48u << 10, 64, 12, 64, {0}},
+                   CacheInfo{3, CacheType::kUnified, 32u << 20, 64, 16, 32768, {0, 1}},
+                   CacheInfo{3, CacheType::kUnified, 32u << 20, 64, 16, 32768, {2, 3}}};
+  std::vector<BenchmarkRecord> records = {
+      {"memory/latency/ws:4096", 1024, 1.25, "ns", {{"working_set_bytes", 4096}}},
+      {"memory/bandwidth/read/threads:2", 3, 2e6, "ns", {{"bytes_per_second", 2.5e10}}},
+      {"name \"quoted\"", 1, 0.5, "ns", {}}};
+
+  std::ostringstream out;
+  WriteBenchmarkJson(out, records, caches, "stage7_integration");
+  std::istringstream in(out.str());
+  boost::property_tree::ptree root;
+  ASSERT_NO_THROW(boost::property_tree::read_json(in, root)) << out.str();
+
+  EXPECT_EQ(root.get<std::string>("context.executable"), "stage7_integration");
+  EXPECT_GT(root.get<int>("context.num_cpus"), 0);
+  // Только кэши cpu0: второй экземпляр L3 не выводится
+  EXPECT_EQ(root.get_child("context.caches").size(), 2u);
+  EXPECT_EQ(root.get_child("context.caches").back().second.get<int>("num_sharing"), 2);
+
+  const auto& benchmarks = root.get_child("benchmarks");
+  ASSERT_EQ(benchmarks.size(), 3u);
+  auto first = benchmarks.begin()->second;
+  EXPECT_EQ(first.get<std::string>("name"), "memory/latency/ws:4096");
+  EXPECT_EQ(first.get<std::string>("run_type"), "iteration");
+  EXPECT_EQ(first.get<size_t>("iterations"), 1024u);
+  EXPECT_DOUBLE_EQ(first.get<double>("real_time"), 1.25);
+  EXPECT_EQ(first.get<std::string>("time_unit"), "ns");
+  EXPECT_DOUBLE_EQ(first.get<double>("working_set_bytes"), 4096.0);
+  EXPECT_DOUBLE_EQ(std::next(benchmarks.begin())->second.get<double>("bytes_per_second"),
+                   2.5e10);
+  EXPECT_EQ(benchmarks.back().second.get<std::string>("name"), "name \"quoted\"");
+
+  std::ostringstream empty;
+  WriteBenchmarkJson(empty, {}, CacheTopology(), "x");
+  std::istringstream empty_in(empty.str());
+  EXPECT_NO_THROW(boost::property_tree::read_json(empty_in, root)) << empty.str();
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,325 @@
+#include <gtest/gtest.h>
+#include "numa_rebalancer.hpp"
+#include "test_utils.hpp"
+#include <numa.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief Строка /proc/pid/task/tid/stat с заданным полем processor
+ */
+std::string MakeStatLine(int tid, const std::string& comm, int cpu) {
+  std::string line = std::to_string(tid) + " (" + comm + ") S";
+  // Поля 4..38 после state, затем processor (поле 39)
+  for (int field = 4; field <= 38; ++field) {
+    line += " 0";
+  }
+  line += " " + std::to_string(cpu) + " 0 0\n";
+  return line;
+}
+
+/**
+ * @brief Фейковые sysfs/procfs: 2 узла по 4 CPU и процесс с потоками
+ */
+class FakeNumaSystem {
+ public:
+  static constexpr pid_t kPid = 4242;
+
+  FakeNumaSystem() {
+    dir_.WriteFile("sys/node/node0/cpulist", "0-3\n");
+    dir_.WriteFile("sys/node/node1/cpulist", "4-7\n");
+    dir_.WriteFile("proc/4242/maps",
+                   "7f0000000000-7f0000100000 rw-p 00000000 00:00 0\n"
+                   "7f0000200000-7f0000204000 rw-p 00000000 00:00 0\n");
+    dir_.WriteFile("proc/4242/numa_maps",
+                   "7f0000000000 default anon=256 dirty=256 N0=200 N1=56 "
+                   "kernelpagesize_kB=4\n"
+                   "7f0000200000 default anon=4 dirty=4 N0=4 kernelpagesize_kB=4\n");
+  }
+
+  void PlaceThreads(const std::vector<int>& cpus) {
+    std::string cmd = "rm -rf '" + dir_.path() + "/proc/4242/task'";
+    ASSERT_EQ(std::system(cmd.c_str()), 0);
+    for (size_t i = 0; i < cpus.size(); ++i) {
+      int tid = kPid + static_cast<int>(i);
+      dir_.WriteFile("proc/4242/task/" + std::to_string(tid) + "/stat",
+                     MakeStatLine(tid, "worker (x)", cpus[i]));
+    }
+  }
+
+  NumaRebalancerConfig Config() const {
+    NumaRebalancerConfig config;
+    config.proc_root = dir_.path() + "/proc";
+    config.sysfs_node_root = dir_.path() + "/sys/node";
+    config.dry_run = true;
+    config.stable_samples_required = 3;
+    config.min_remote_pages = 16;
+    return config;
+  }
+
+ private:
+  TempDir dir_;
+};
+
+}  // namespace
+
+// ============================================================================
+// Парсинг /proc
+// ============================================================================
+
+TEST(NumaRebalancerTest, ParseNumaMapsWithRegionBounds) {
+  std::string numa_maps =
+      "55dbbc9f8000 default file=/usr/bin/cat mapped=2 N0=2 kernelpagesize_kB=4\n"
+      "7f0000000000 bind:1 anon=10 dirty=10 N0=3 N1=7 kernelpagesize_kB=2048\n";
+  std::string maps =
+      "7f0000000000-7f0001400000 rw-p 00000000 00:00 0\n";
+
+  auto regions = NumaRebalancer::ParseNumaMaps(numa_maps, maps);
+  ASSERT_EQ(regions.size(), 2u);
+
+  EXPECT_FALSE(regions[0].anonymous);
+  EXPECT_EQ(regions[0].end_address, 0u);  // Нет в maps
+  EXPECT_EQ(regions[0].TotalPages(), 2u);
+
+  EXPECT_TRUE(regions[1].anonymous);
+  EXPECT_EQ(regions[1].start_address, 0x7f0000000000ULL);
+  EXPECT_EQ(regions[1].end_address, 0x7f0001400000ULL);
+  EXPECT_EQ(regions[1].page_size_bytes, 2048u * 1024u);
+  EXPECT_EQ(regions[1].TotalPages(), 10u);
+  EXPECT_EQ(regions[1].RemotePages(1), 3u);
+  EXPECT_EQ(regions[1].RemotePages(0), 7u);
+}
+
+TEST(NumaRebalancerTest, ParseNumaMapsSkipsMalformedLines) {
+  // Обрезанные строки (процесс меняет карту во время чтения) не рушат весь план
+  std::string numa_maps =
+      "7f0000000000 default anon=4 N0=4 kernelpagesize_kB=4\n"
+      "7f0000100000 default anon=4 N0=\n"
+      "7f0000200000 default anon=4 N99999999999999999999=1\n"
+      "7f0000300000 default anon=4 N1=4 kernelpagesize_kB=x\n";
+  std::string maps =
+      "7f0000000000-7f0000004000 rw-p 00000000 00:00 0\n"
+      "zzzz-7f0000104000 rw-p 00000000 00:00 0\n"
+      "7f0000200000-\n";
+
+  std::vector<NumaMapsRegion> regions;
+  ASSERT_NO_THROW(regions = NumaRebalancer::ParseNumaMaps(numa_maps, maps));
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_EQ(regions[0].start_address, 0x7f0000000000ULL);
+  EXPECT_EQ(regions[0].end_address, 0x7f0000004000ULL);
+  EXPECT_EQ(regions[0].TotalPages(), 4u);
+}
+
+TEST(NumaRebalancerTest, ParseStatProcessorHandlesParensInName) {
+  EXPECT_EQ(NumaRebalancer::ParseStatProcessor(MakeStatLine(10, "a) (b", 7)), 7);
+  EXPECT_EQ(NumaRebalancer::ParseStatProcessor("garbage"), -1);
+}
+
+// ============================================================================
+// Планирование
+// ============================================================================
+
+TEST(NumaRebalancerTest, PlanPrefersHeaviestRegionsWithinBudget) {
+  NumaMapsRegion small = {0x1000, 0x11000, 4096, true, {{0, 16}}};   // 16 страниц
+  NumaMapsRegion large = {0x100000, 0x200000, 4096, true, {{0, 200}, {1, 56}}};
+  NumaMapsRegion unknown_end = {0x300000, 0, 4096, true, {{0, 500}}};
+
+  auto plan = NumaRebalancer::PlanMigrations({small, large, unknown_end}, 1,
+                                             100, 8, {});
+  ASSERT_EQ(plan.size(), 1u);
+  EXPECT_EQ(plan[0].region_start, large.start_address);
+  EXPECT_EQ(plan[0].pages.size(), 100u);
+  EXPECT_EQ(plan[0].pages[1], reinterpret_cast<void*>(0x100000 + 4096));
+
+  // Продолжение обхода с курсора
+  auto resumed = NumaRebalancer::PlanMigrations({large}, 1, 1000, 8,
+                                                {{large.start_address, 250}});
+  ASSERT_EQ(resumed.size(), 1u);
+  EXPECT_EQ(resumed[0].first_page_index, 250u);
+  EXPECT_EQ(resumed[0].pages.size(), 6u);
+}
+
+TEST(NumaRebalancerTest, NoPlanWithoutTarget) {
+  NumaMapsRegion region = {0x1000, 0x100000, 4096, true, {{0, 100}}};
+  EXPECT_TRUE(NumaRebalancer::PlanMigrations({region}, -1, 100, 1, {}).empty());
+}
+
+// ============================================================================
+// Гистерезис на фейковом /proc
+// ============================================================================
+
+TEST(NumaRebalancerTest, TargetSwitchesOnlyAfterStableMajority) {
+  OptimizationEngine engine;
+  FakeNumaSystem fake;
+  NumaRebalancer rebalancer(FakeNumaSystem::kPid, engine, fake.Config());
+
+  fake.PlaceThreads({4, 5, 6, 0});  // 3 из 4 потоков на узле 1
+  EXPECT_EQ(rebalancer.Tick().target_node, -1);
+  EXPECT_EQ(rebalancer.Tick().target_node, -1);
+
+  RebalanceTickStats stats = rebalancer.Tick();
+  EXPECT_EQ(stats.target_node, 1);
+  EXPECT_TRUE(stats.target_changed);
+  EXPECT_EQ(stats.threads_sampled, 4u);
+  EXPECT_EQ(stats.remote_pages, 204u);
+  // Маленький регион (4 страницы) ниже min_remote_pages
+  EXPECT_EQ(stats.pages_planned, 256u);
+  EXPECT_EQ(stats.pages_migrated, 0u);  // dry run
+}
+
+TEST(NumaRebalancerTest, PingPongPlacementDoesNotFlipTarget) {
+  OptimizationEngine engine;
+  FakeNumaSystem fake;
+  NumaRebalancer rebalancer(FakeNumaSystem::kPid, engine, fake.Config());
+
+  fake.PlaceThreads({0, 1, 2, 3});
+  for (int i = 0; i < 3; ++i) {
+    rebalancer.Tick();
+  }
+  ASSERT_EQ(rebalancer.GetTargetNode(), 0);
+
+  // Потоки мигрируют туда-обратно каждые две выборки
+  for (int round = 0; round < 4; ++round) {
+    fake.PlaceThreads(round % 2 == 0 ? std::vector<int>{4, 5, 6, 7}
+                                     : std::vector<int>{0, 1, 2, 3});
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_EQ(rebalancer.Tick().target_node, 0);
+    }
+  }
+
+  // Без явного большинства цель тоже сохраняется
+  fake.PlaceThreads({0, 4});
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(rebalancer.Tick().target_node, 0);
+  }
+}
+
+TEST(NumaRebalancerTest, MissingTopologyThrows) {
+  OptimizationEngine engine;
+  NumaRebalancerConfig config;
+  config.sysfs_node_root = "/nonexistent/node";
+  EXPECT_THROW(NumaRebalancer(getpid(), engine, config), std::runtime_error);
+}
+
+// ============================================================================
+// Синтетическая многопоточная нагрузка на живом процессе
+// ============================================================================
+
+class NumaRebalancerWorkloadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (numa_available() == -1) {
+      GTEST_SKIP() << "NUMA not available";
+    }
+  }
+
+  /**
+   * @brief Запуск потоков, закреплённых на CPU, которые непрерывно пишут в буфер
+   */
+  void StartWorkers(int cpu, size_t count, char* buffer, size_t size) {
+    for (size_t i = 0; i < count; ++i) {
+      workers_.emplace_back([this, cpu, buffer, size, i, count]() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+        size_t slice = size / count;
+        char* begin = buffer + i * slice;
+        while (!stop_.load()) {
+          for (size_t offset = 0; offset < slice; offset += 4096) {
+            begin[offset]++;
+          }
+          std::this_thread::yield();
+        }
+      });
+    }
+  }
+
+  void TearDown() override {
+    stop_.store(true);
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+TEST_F(NumaRebalancerWorkloadTest, MovesRemotePagesTowardWorkerNode) {
+  OptimizationEngine engine;
+  int worker_cpu = 0;
+  int worker_node = engine.GetNumaNodeOfCpu(worker_cpu);
+  ASSERT_GE(worker_node, 0);
+
+  // На многоузловой машине память выделяется на чужом узле
+  int memory_node = worker_node;
+  for (int node = 0; node <= numa_max_node(); ++node) {
+    if (node != worker_node && numa_node_size64(node, nullptr) > 0) {
+      memory_node = node;
+      break;
+    }
+  }
+
+  constexpr size_t kBufferSize = 16 * 1024 * 1024;
+  char* buffer = static_cast<char*>(numa_alloc_onnode(kBufferSize, memory_node));
+  ASSERT_NE(buffer, nullptr);
+  std::memset(buffer, 1, kBufferSize);
+
+  StartWorkers(worker_cpu, 4, buffer, kBufferSize);
+
+  NumaRebalancerConfig config;
+  config.stable_samples_required = 2;
+  config.max_scan_pages_per_tick = kBufferSize / 4096;
+  NumaRebalancer rebalancer(getpid(), engine, config);
+
+  uint64_t migrated = 0;
+  for (int i = 0; i < 4; ++i) {
+    RebalanceTickStats stats = rebalancer.Tick();
+    migrated += stats.pages_migrated;
+    EXPECT_GE(stats.threads_sampled, 5u);  // Главный поток + 4 рабочих
+  }
+
+  EXPECT_EQ(rebalancer.GetTargetNode(), worker_node);
+
+  std::vector<void*> pages;
+  for (size_t offset = 0; offset < kBufferSize; offset += 4096) {
+    pages.push_back(buffer + offset);
+  }
+  std::vector<int> nodes;
+  ASSERT_TRUE(engine.QueryPageNodes(0, pages, nodes));
+  size_t local = std::count(nodes.begin(), nodes.end(), worker_node);
+
+  if (memory_node == worker_node) {
+    EXPECT_EQ(migrated, 0u);  // Одноузловая машина: переносить нечего
+  } else {
+    EXPECT_GT(migrated, 0u);
+  }
+  EXPECT_EQ(local, pages.size());
+
+  stop_.store(true);
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  numa_free(buffer, kBufferSize);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
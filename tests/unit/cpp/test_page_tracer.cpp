@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+#include "page_tracer.hpp"
+#include "test_utils.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::FakeProcfs;
+
+namespace {
+
+constexpr uint64_t kPresent = FakeProcfs::kPresent;
+constexpr uint64_t kSoftDirty = FakeProcfs::kSoftDirty;
+
+/**
+ * @brief Процесс с двумя регионами
+ *
+ * Регион A - 4 страницы с 0x10000 (PFN 100-103), регион B - 2 страницы с
+ * 0x20000 (PFN 200-201), плюс регион без прав.
+ */
+class FakeProcess : public FakeProcfs {
+ public:
+  static constexpr pid_t kPid = 77;
+
+  FakeProcess()
+      : FakeProcfs(kPid,
+                   "00010000-00014000 rw-p 00000000 00:00 0 \n"
+                   "00020000-00022000 r--p 00000000 08:01 1234 /usr/lib/libfake.so\n"
+                   "00030000-00031000 ---p 00000000 00:00 0 \n",
+                   8) {
+    for (uint64_t i = 0; i < 4; ++i) {
+      MapPage(0x10000 + i * 4096, 100 + i);
+    }
+    for (uint64_t i = 0; i < 2; ++i) {
+      MapPage(0x20000 + i * 4096, 200 + i);
+    }
+  }
+
+  PageScanConfig Config(PageTracking tracking) const {
+    PageScanConfig config;
+    config.tracking = tracking;
+    config.proc_root = ProcRoot();
+    config.page_idle_bitmap = IdleBitmap();
+    return config;
+  }
+};
+
+}  // namespace
+
+// ============================================================================
+// Разбор maps
+// ============================================================================
+
+TEST(PageTracerTest, ParsesMapsAndFiltersRegions) {
+  std::vector<PageRegion> regions = PageAccessScanner::ParseMaps(
+      "00400000-00452000 r-xp 00000000 08:02 173521 /usr/bin/app\n"
+      "01a00000-01a21000 rw-p 00000000 00:00 0          [heap]\n"
+      "7ffc0000-7ffe1000 rw-p 00000000 00:00 0          [stack]\n"
+      "garbage\n");
+  ASSERT_EQ(regions.size(), 3u);
+  EXPECT_EQ(regions[0].start, 0x400000u);
+  EXPECT_EQ(regions[0].path, "/usr/bin/app");
+  EXPECT_FALSE(regions[0].anonymous);
+  EXPECT_FALSE(regions[0].writable);
+  EXPECT_TRUE(regions[1].anonymous);
+  EXPECT_TRUE(regions[2].anonymous);
+
+  FakeProcess process;
+  PageScanConfig config = process.Config(PageTracking::kIdlePage);
+  config.anonymous_only = true;
+  PageAccessScanner scanner(FakeProcess::kPid, config);
+  std::vector<PageRegion> traced = scanner.Regions();
+  ASSERT_EQ(traced.size(), 1u);   // Библиотека и регион без прав отброшены
+  EXPECT_EQ(traced[0].start, 0x10000u);
+}
+
+// ============================================================================
+// Обход
+// ============================================================================
+
+TEST(PageTracerTest, IdlePagesPrimeThenReportTouchedPages) {
+  FakeProcess process;
+  PageAccessScanner scanner(FakeProcess::kPid, process.Config(PageTracking::kIdlePage));
+  std::vector<uint64_t> accessed;
+  std::vector<bool> written;
+
+  PageScanStats priming = scanner.Scan(accessed, written);
+  EXPECT_TRUE(priming.priming);
+  EXPECT_TRUE(priming.cycle_complete);
+  EXPECT_EQ(priming.pages_present, 6u);
+  EXPECT_TRUE(accessed.empty());
+  EXPECT_EQ(process.IdleWord(100) >> 36 & 0xF, 0xFu);   // PFN 100-103 отмечены
+
+  process.Touch(101);
+  process.Touch(200);
+  PageScanStats stats = scanner.Scan(accessed, written);
+  EXPECT_FALSE(stats.priming);
+  EXPECT_EQ(accessed, (std::vector<uint64_t>{0x11000, 0x20000}));
+  EXPECT_EQ(written, (std::vector<bool>{false, false}));
+
+  accessed.clear();
+  scanner.Scan(accessed, written);
+  EXPECT_TRUE(accessed.empty());   // Страницы снова отмечены
+}
+
+TEST(PageTracerTest, RereadsIdleWordEveryScan) {
+  FakeProcess process;
+  PageScanConfig config = process.Config(PageTracking::kIdlePage);
+  config.anonymous_only = true;   // Один регион - одно слово bitmap на все проходы
+  PageAccessScanner scanner(FakeProcess::kPid, config);
+  std::vector<uint64_t> accessed;
+  std::vector<bool> written;
+  scanner.Scan(accessed, written);
+
+  process.Touch(102);
+  scanner.Scan(accessed, written);
+  EXPECT_EQ(accessed, (std::vector<uint64_t>{0x12000}));
+}
+
+TEST(PageTracerTest, WritesOnlyOwnIdleMarks) {
+  FakeProcess process;
+  process.SetIdleWord(100, ~0ull);
+  PageAccessScanner scanner(FakeProcess::kPid, process.Config(PageTracking::kIdlePage));
+  std::vector<uint64_t> accessed;
+  std::vector<bool> written;
+  scanner.Scan(accessed, written);
+  // Прочие биты слова не переписываются: тронутые после чтения не станут idle
+  EXPECT_EQ(process.IdleWord(100), 0xFull << 36);
+}
+
+TEST(PageTracerTest, BudgetSplitsScanIntoCycle) {
+  FakeProcess process;
+  PageScanConfig config = process.Config(PageTracking::kIdlePage);
+  config.max_pages_per_scan = 4;
+  PageAccessScanner scanner(FakeProcess::kPid, config);
+  std::vector<uint64_t> accessed;
+  std::vector<bool> written;
+
+  PageScanStats first = scanner.Scan(accessed, written);
+  EXPECT_EQ(first.pages_examined, 4u);
+  EXPECT_FALSE(first.cycle_complete);
+  PageScanStats second = scanner.Scan(accessed, written);
+  EXPECT_EQ(second.pages_examined, 2u);
+  EXPECT_TRUE(second.cycle_complete);
+  EXPECT_TRUE(second.priming);
+
+  process.Touch(103);
+  process.Touch(201);
+  PageScanStats third = scanner.Scan(accessed, written);
+  EXPECT_FALSE(third.priming);
+  EXPECT_EQ(accessed, (std::vector<uint64_t>{0x13000}));
+  scanner.Scan(accessed, written);
+  EXPECT_EQ(accessed, (std::vector<uint64_t>{0x13000, 0x21000}));
+}
+
+TEST(PageTracerTest, SoftDirtyReportsWritesAndClearsPerCycle) {
+  FakeProcess process;
+  PageAccessScanner scanner(FakeProcess::kPid, process.Config(PageTracking::kSoftDirty));
+  EXPECT_EQ(process.ClearRefs(), "4");
+
+  process.SetEntry(0x12000, kPresent | kSoftDirty | 102);
+  std::vector<uint64_t> accessed;
+  std::vector<bool> written;
+  PageScanStats stats = scanner.Scan(accessed, written);
+  EXPECT_FALSE(stats.priming);
+  EXPECT_TRUE(stats.cycle_complete);
+  EXPECT_EQ(accessed, (std::vector<uint64_t>{0x12000}));
+  EXPECT_EQ(written, (std::vector<bool>{true}));
+}
+
+TEST(PageTracerTest, ReportsUnavailableTracking) {
+  FakeProcess process;
+  PageScanConfig config = process.Config(PageTracking::kIdlePage);
+  config.page_idle_bitmap = process.dir().path() + "/missing";
+  EXPECT_THROW(PageAccessScanner(FakeProcess::kPid, config), std::runtime_error);
+  EXPECT_THROW(PageAccessScanner(12345, process.Config(PageTracking::kIdlePage)),
+               std::runtime_error);
+  EXPECT_THROW(ParsePageTracking("accessed"), std::invalid_argument);
+}
+
+// ============================================================================
+// Трасса
+// ============================================================================
+
+TEST(PageTracerTest, WritesSimulatorTrace) {
+  FakeProcess process;
+  std::string path = process.dir().path() + "/pages.trace";
+  PageTracerConfig config;
+  config.scan = process.Config(PageTracking::kIdlePage);
+  {
+    PageTracer tracer(FakeProcess::kPid, path, config);
+    tracer.Scan();
+    process.Touch(100);
+    process.Touch(102);
+    tracer.Scan();
+    EXPECT_EQ(tracer.scans(), 2u);
+    EXPECT_EQ(tracer.records(), 2u);
+    tracer.Close();
+  }
+
+  MappedTrace trace(path);
+  ASSERT_EQ(trace.size(), 2u);
+  EXPECT_EQ(trace.begin()[0].address, 0x10000u);
+  EXPECT_EQ(trace.begin()[1].address, 0x12000u);
+  EXPECT_EQ(trace.begin()[1].type, static_cast<uint8_t>(AccessType::kRead));
+}
+
+TEST(PageTracerTest, RunStopsWhenProcessExits) {
+  FakeProcess process;
+  PageTracerConfig config;
+  config.scan = process.Config(PageTracking::kIdlePage);
+  config.interval_ms = 1;
+  PageTracer tracer(FakeProcess::kPid, process.dir().path() + "/run.trace", config);
+  process.Exit();
+  std::atomic<bool> stop(false);
+  tracer.Run(stop);
+  EXPECT_EQ(tracer.scans(), 1u);
+}
+
+TEST(PageTracerTest, PauseKeepsCpuShareBounded) {
+  EXPECT_EQ(PageTracer::NextDelayMs(100, 0.001, 0.05), 100u);
+  // 50 мс обхода при доле 5% - пауза 950 мс
+  EXPECT_EQ(PageTracer::NextDelayMs(100, 0.05, 0.05), 950u);
+  EXPECT_EQ(PageTracer::NextDelayMs(100, 0.05, 0.0), 100u);
+}
+
+TEST(PageTracerTest, TracesOwnPagesWhenIdleTrackingAvailable) {
+  if (access("/sys/kernel/mm/page_idle/bitmap", R_OK | W_OK) != 0) {
+    GTEST_SKIP() << "Idle page tracking is unavailable";
+  }
+  constexpr size_t kPages = 64;
+  char* buffer = static_cast<char*>(
+      mmap(nullptr, kPages * 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(buffer, MAP_FAILED);
+  for (size_t page = 0; page < kPages; ++page) {
+    buffer[page * 4096] = 1;
+  }
+
+  PageScanConfig config;
+  config.anonymous_only = true;
+  PageAccessScanner scanner(getpid(), config);
+  std::vector<uint64_t> accessed;
+  std::vector<bool> written;
+  while (!scanner.Scan(accessed, written).cycle_complete) {
+  }
+  accessed.clear();
+  for (size_t page = 0; page < kPages; page += 2) {
+    buffer[page * 4096] += 1;
+  }
+  while (!scanner.Scan(accessed, written).cycle_complete) {
+  }
+  uint64_t base = reinterpret_cast<uint64_t>(buffer);
+  size_t touched = 0;
+  for (uint64_t address : accessed) {
+    touched += address >= base && address < base + kPages * 4096;
+  }
+  EXPECT_GE(touched, kPages / 2);
+  munmap(buffer, kPages * 4096);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
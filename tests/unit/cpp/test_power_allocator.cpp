@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include "power_allocator.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace hardware_analysis;
+
+namespace {
+
+std::vector<CoreDemand> UniformDemands(size_t cores, double load, double weight = 1.0) {
+  return std::vector<CoreDemand>(cores, CoreDemand{1000, 4000, load, weight});
+}
+
+double ModelPower(const std::vector<CoreDemand>& demands, const CorePowerModel& model,
+                  const std::vector<uint64_t>& frequency_mhz) {
+  double power = 0.0;
+  for (size_t i = 0; i < demands.size(); ++i) {
+    power += model.Power(frequency_mhz[i], demands[i].load_percent);
+  }
+  return power;
+}
+
+}  // namespace
+
+// ============================================================================
+// Модель и калибровка
+// ============================================================================
+
+TEST(CorePowerModelTest, PowerGrowsWithFrequencyAndLoad) {
+  CorePowerModel model;
+  EXPECT_LT(model.Power(1000, 100.0), model.Power(2000, 100.0));
+  EXPECT_LT(model.Power(3000, 20.0), model.Power(3000, 80.0));
+  // Простаивающее ядро всё равно потребляет idle_activity
+  EXPECT_GT(model.Power(3000, 0.0), model.static_watts);
+}
+
+TEST(PowerModelCalibratorTest, RecoversCoefficientsFromPackageSamples) {
+  CorePowerModel truth;
+  truth.static_watts = 1.5;
+  truth.dynamic_coeff = 0.35;
+
+  PowerModelCalibrator calibrator(4);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> freq(10, 40);
+  std::uniform_real_distribution<double> load(0.0, 100.0);
+
+  for (int sample = 0; sample < 64; ++sample) {
+    std::vector<uint64_t> mhz(4);
+    std::vector<double> loads(4);
+    double package = 0.0;
+    for (int core = 0; core < 4; ++core) {
+      mhz[core] = freq(rng) * 100;
+      loads[core] = load(rng);
+      package += truth.Power(mhz[core], loads[core]);
+    }
+    calibrator.AddSample(package, mhz, loads);
+  }
+
+  ASSERT_TRUE(calibrator.Fit());
+  EXPECT_NEAR(calibrator.GetModel().static_watts, 1.5, 1e-6);
+  EXPECT_NEAR(calibrator.GetModel().dynamic_coeff, 0.35, 1e-6);
+}
+
+TEST(PowerModelCalibratorTest, KeepsModelWithoutActivitySpread) {
+  PowerModelCalibrator calibrator(2);
+  for (int sample = 0; sample < 16; ++sample) {
+    calibrator.AddSample(30.0, {3000, 3000}, {100.0, 100.0});
+  }
+  calibrator.AddSample(std::nan(""), {1000, 1000}, {0.0, 0.0});
+
+  EXPECT_EQ(calibrator.SampleCount(), 16u);
+  EXPECT_FALSE(calibrator.Fit());
+  EXPECT_DOUBLE_EQ(calibrator.GetModel().dynamic_coeff, CorePowerModel().dynamic_coeff);
+}
+
+// ============================================================================
+// Распределение бюджета
+// ============================================================================
+
+TEST(PowerBudgetAllocatorTest, GenerousBudgetGrantsDesiredFrequency) {
+  PowerBudgetAllocator allocator;
+  std::vector<CoreDemand> demands = UniformDemands(4, 100.0);
+  demands[1].max_mhz = 2450;   // Неполный последний шаг
+  std::vector<uint64_t> mhz;
+
+  AllocationResult result = allocator.Allocate(demands, CorePowerModel(), 1000.0, mhz);
+  EXPECT_TRUE(result.feasible);
+  EXPECT_EQ(mhz, (std::vector<uint64_t>{4000, 2450, 4000, 4000}));
+}
+
+TEST(PowerBudgetAllocatorTest, RespectsBudgetAndSplitsEvenly) {
+  PowerBudgetAllocator allocator;
+  CorePowerModel model;
+  std::vector<CoreDemand> demands = UniformDemands(8, 100.0);
+  std::vector<uint64_t> mhz;
+
+  AllocationResult result = allocator.Allocate(demands, model, 40.0, mhz);
+  EXPECT_TRUE(result.feasible);
+  EXPECT_LE(result.power_watts, 40.0);
+  EXPECT_NEAR(ModelPower(demands, model, mhz), result.power_watts, 1e-9);
+
+  // Одинаковые ядра: разница не больше одного шага
+  auto bounds = std::minmax_element(mhz.begin(), mhz.end());
+  EXPECT_LE(*bounds.second - *bounds.first, 100u);
+  EXPECT_LT(*bounds.second, 4000u);
+}
+
+TEST(PowerBudgetAllocatorTest, PriorityCoresGetMoreFrequency) {
+  PowerBudgetAllocator allocator;
+  std::vector<CoreDemand> demands = UniformDemands(4, 100.0);
+  demands[3].weight = 3.0;
+  std::vector<uint64_t> mhz;
+
+  allocator.Allocate(demands, CorePowerModel(), 25.0, mhz);
+  EXPECT_GT(mhz[3], std::max(mhz[0], mhz[1]) + 100);
+  EXPECT_LE(std::max(mhz[0], mhz[1]) - std::min(mhz[0], mhz[1]), 100u);
+}
+
+TEST(PowerBudgetAllocatorTest, IdleCoresStayAtMinimum) {
+  PowerBudgetAllocator allocator;
+  std::vector<CoreDemand> demands = UniformDemands(4, 100.0);
+  demands[0].load_percent = 0.0;
+  std::vector<uint64_t> mhz;
+
+  allocator.Allocate(demands, CorePowerModel(), 25.0, mhz);
+  EXPECT_EQ(mhz[0], 1000u);
+  EXPECT_GT(mhz[1], 1000u);
+}
+
+TEST(PowerBudgetAllocatorTest, InfeasibleBudgetFallsBackToMinimum) {
+  PowerBudgetAllocator allocator;
+  std::vector<CoreDemand> demands = UniformDemands(4, 100.0);
+  std::vector<uint64_t> mhz;
+
+  AllocationResult result = allocator.Allocate(demands, CorePowerModel(), 1.0, mhz);
+  EXPECT_FALSE(result.feasible);
+  EXPECT_EQ(mhz, (std::vector<uint64_t>(4, 1000)));
+}
+
+TEST(PowerBudgetAllocatorTest, IncrementalMatchesFromScratch) {
+  PowerBudgetAllocator incremental;
+  PowerBudgetAllocator scratch;
+  CorePowerModel model;
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> load(0.0, 100.0);
+  std::uniform_real_distribution<double> jitter(-10.0, 10.0);
+  std::uniform_real_distribution<double> budget(20.0, 300.0);
+
+  std::vector<CoreDemand> demands(32);
+  for (auto& demand : demands) {
+    demand = {1000, 4000, load(rng), 1.0};
+  }
+  demands[0].weight = 2.5;
+
+  std::vector<uint64_t> a;
+  std::vector<uint64_t> b;
+  for (int tick = 0; tick < 100; ++tick) {
+    for (auto& demand : demands) {
+      demand.load_percent = std::clamp(demand.load_percent + jitter(rng), 0.0, 100.0);
+      demand.max_mhz = 1000 + static_cast<uint64_t>(30.0 * demand.load_percent);
+    }
+    double limit = tick % 10 == 0 ? budget(rng) : 120.0;
+
+    AllocationResult inc = incremental.Allocate(demands, model, limit, a);
+    AllocationResult full = scratch.AllocateFromScratch(demands, model, limit, b);
+    EXPECT_EQ(a, b) << "tick " << tick;
+    EXPECT_NEAR(inc.utility, full.utility, 1e-6 * full.utility);
+    EXPECT_LE(inc.power_watts, limit);
+  }
+}
+
+// ============================================================================
+// Performance Benchmarks
+// ============================================================================
+
+TEST(PowerBudgetAllocatorPerformanceTest, IncrementalTickOn256Cores) {
+  constexpr size_t CORES = 256;
+  constexpr int ITERATIONS = 200;
+
+  CorePowerModel model;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> load(0.0, 100.0);
+  std::uniform_real_distribution<double> jitter(-3.0, 3.0);
+
+  std::vector<CoreDemand> demands(CORES);
+  for (size_t i = 0; i < CORES; ++i) {
+    demands[i] = {800, 4000, load(rng), i % 16 == 0 ? 4.0 : 1.0};
+  }
+  const double budget = 1200.0;   // ~половина потребления на максимальных частотах
+
+  PowerBudgetAllocator incremental;
+  PowerBudgetAllocator scratch;
+  std::vector<uint64_t> mhz;
+  incremental.Allocate(demands, model, budget, mhz);
+
+  std::vector<double> inc_us;
+  std::vector<double> full_us;
+  size_t inc_steps = 0;
+  size_t full_steps = 0;
+  for (int i = 0; i < ITERATIONS; ++i) {
+    for (auto& demand : demands) {
+      demand.load_percent = std::clamp(demand.load_percent + jitter(rng), 0.0, 100.0);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    AllocationResult inc = incremental.Allocate(demands, model, budget, mhz);
+    auto middle = std::chrono::steady_clock::now();
+    AllocationResult full = scratch.AllocateFromScratch(demands, model, budget, mhz);
+    auto end = std::chrono::steady_clock::now();
+
+    inc_us.push_back(std::chrono::duration<double, std::micro>(middle - start).count());
+    full_us.push_back(std::chrono::duration<double, std::micro>(end - middle).count());
+    inc_steps += inc.steps_moved;
+    full_steps += full.steps_moved;
+    ASSERT_LE(inc.power_watts, budget);
+  }
+
+  std::sort(inc_us.begin(), inc_us.end());
+  std::sort(full_us.begin(), full_us.end());
+  std::cout << "Budget allocation (256 cores): incremental median " << inc_us[ITERATIONS / 2]
+            << " µs (" << inc_steps / ITERATIONS << " heap steps), from scratch median "
+            << full_us[ITERATIONS / 2] << " µs (" << full_steps / ITERATIONS
+            << " heap steps)\n";
+
+  EXPECT_LT(inc_steps, full_steps);
+  if (testing_utils::PerfAssertionsEnabled()) {
+    EXPECT_LT(inc_us[ITERATIONS / 2], 500.0);
+  }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
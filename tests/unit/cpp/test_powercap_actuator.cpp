@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+#include "powercap_actuator.hpp"
+#include "test_utils.hpp"
+#include <cmath>
+#include <string>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+constexpr uint32_t kMsrRaplPowerUnit = 0x606;
+constexpr uint32_t kMsrPkgPowerLimit = 0x610;
+constexpr uint32_t kMsrDramPowerLimit = 0x618;
+
+// 1/8 Вт, 1/16384 Дж, 1/1024 с
+constexpr uint64_t kUnits = 0xA0E03;
+// PL1 = 95 Вт, окно 2^10/1024 = 1 с; PL2 = 125 Вт, окно 8/1024 с
+constexpr uint64_t kPl1Field = 760 | (1ULL << 15) | (1ULL << 16) | (10ULL << 17);
+constexpr uint64_t kPl2Field = 1000 | (1ULL << 15) | (3ULL << 17);
+constexpr uint64_t kPkgLimit = kPl1Field | (kPl2Field << 32);
+
+/**
+ * @brief Фейковое дерево powercap: пакеты 0 и 1, у пакета 0 подзоны core и dram
+ */
+class FakePowercap {
+ public:
+  FakePowercap() {
+    AddZone("intel-rapl:0", "package-0", 95.0, true);
+    AddZone("intel-rapl:0:0", "core", 0.0, false);
+    AddZone("intel-rapl:0:1", "dram", 30.0, false);
+    AddZone("intel-rapl:1", "package-1", 95.0, true);
+    AddZone("intel-rapl:2", "psys", 200.0, false);
+  }
+
+  void AddZone(const std::string& zone, const std::string& name, double watts,
+               bool short_term) {
+    std::string base = "powercap/" + zone;
+    dir_.WriteFile(base + "/name", name + "\n");
+    dir_.WriteFile(base + "/enabled", "1\n");
+    dir_.WriteFile(base + "/constraint_0_name", "long_term\n");
+    dir_.WriteFile(base + "/constraint_0_power_limit_uw", Uw(watts));
+    dir_.WriteFile(base + "/constraint_0_time_window_us", "999424\n");
+    if (short_term) {
+      dir_.WriteFile(base + "/constraint_1_name", "short_term\n");
+      dir_.WriteFile(base + "/constraint_1_power_limit_uw", Uw(125.0));
+      dir_.WriteFile(base + "/constraint_1_time_window_us", "2440\n");
+    }
+  }
+
+  uint64_t Read(const std::string& zone, const std::string& file) const {
+    return std::stoull(dir_.ReadFile("powercap/" + zone + "/" + file));
+  }
+
+  std::string Root() const { return dir_.path() + "/powercap"; }
+  const TempDir& dir() const { return dir_; }
+
+ private:
+  static std::string Uw(double watts) {
+    return std::to_string(static_cast<uint64_t>(watts * 1e6)) + "\n";
+  }
+
+  TempDir dir_;
+};
+
+/**
+ * @brief Фейковые MSR одного пакета без powercap
+ */
+class FakeRaplMsr {
+ public:
+  FakeRaplMsr() {
+    dir_.WriteMsr("dev/cpu/0/msr", kMsrRaplPowerUnit, kUnits);
+    dir_.WriteMsr("dev/cpu/0/msr", kMsrPkgPowerLimit, kPkgLimit);
+    dir_.WriteMsr("dev/cpu/0/msr", kMsrDramPowerLimit, 240 | (1ULL << 15));   // 30 Вт
+  }
+
+  PowercapActuator Actuator() const {
+    return PowercapActuator(dir_.path() + "/powercap", dir_.path() + "/dev/cpu", {0});
+  }
+
+  RaplEnergyMeter Meter() const {
+    return RaplEnergyMeter(dir_.path() + "/powercap", dir_.path() + "/dev/cpu", {0});
+  }
+
+  uint64_t Read(uint32_t address) const { return dir_.ReadMsr("dev/cpu/0/msr", address); }
+  void Write(uint32_t address, uint64_t value) const {
+    dir_.WriteMsr("dev/cpu/0/msr", address, value);
+  }
+
+ private:
+  TempDir dir_;
+};
+
+}  // namespace
+
+// ============================================================================
+// powercap
+// ============================================================================
+
+TEST(PowercapActuatorTest, DiscoversPackageAndDramZones) {
+  FakePowercap fake;
+  PowercapActuator actuator(fake.Root(), "/nonexistent", {});
+
+  EXPECT_EQ(actuator.Packages(), (std::vector<int>{0, 1}));
+  EXPECT_STREQ(actuator.Backend(0, RaplDomain::kPackage), "powercap");
+  EXPECT_STREQ(actuator.Backend(0, RaplDomain::kDram), "powercap");
+  EXPECT_STREQ(actuator.Backend(1, RaplDomain::kDram), "none");
+  EXPECT_FALSE(actuator.IsAvailable(2, RaplDomain::kPackage));   // psys - не пакет
+}
+
+TEST(PowercapActuatorTest, ReadsConstraints) {
+  FakePowercap fake;
+  PowercapActuator actuator(fake.Root(), "/nonexistent", {});
+
+  RaplLimits limits;
+  ASSERT_TRUE(actuator.ReadLimits(0, RaplDomain::kPackage, &limits));
+  EXPECT_DOUBLE_EQ(limits.long_term.watts, 95.0);
+  EXPECT_NEAR(limits.long_term.time_window_seconds, 1.0, 1e-3);
+  EXPECT_TRUE(limits.long_term.enabled);
+  ASSERT_TRUE(limits.has_short_term);
+  EXPECT_DOUBLE_EQ(limits.short_term.watts, 125.0);
+
+  ASSERT_TRUE(actuator.ReadLimits(0, RaplDomain::kDram, &limits));
+  EXPECT_DOUBLE_EQ(limits.long_term.watts, 30.0);
+  EXPECT_FALSE(limits.has_short_term);
+}
+
+TEST(PowercapActuatorTest, WritesBothLimitsAndRestores) {
+  FakePowercap fake;
+  PowercapActuator actuator(fake.Root(), "/nonexistent", {});
+
+  RaplLimits limits;
+  limits.long_term = {45.0, 8.0, true};
+  limits.short_term = {90.0, 0.01, true};
+  limits.has_short_term = true;
+  ASSERT_TRUE(actuator.SetLimits(1, RaplDomain::kPackage, limits));
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_0_power_limit_uw"), 45000000u);
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_0_time_window_us"), 8000000u);
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_1_power_limit_uw"), 90000000u);
+
+  // Повторная запись не подменяет сохранённый оригинал
+  ASSERT_TRUE(actuator.EnforcePowerLimit(1, 40.0));
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_1_power_limit_uw"), 90000000u);
+
+  ASSERT_TRUE(actuator.RestoreAll());
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_0_power_limit_uw"), 95000000u);
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_1_power_limit_uw"), 125000000u);
+  EXPECT_EQ(fake.Read("intel-rapl:1", "constraint_0_time_window_us"), 999424u);
+}
+
+TEST(PowercapActuatorTest, EnforcesDramLimit) {
+  FakePowercap fake;
+  PowercapActuator actuator(fake.Root(), "/nonexistent", {});
+
+  RaplLimits limits;
+  limits.long_term = {12.5, 1.0, true};
+  ASSERT_TRUE(actuator.SetLimits(0, RaplDomain::kDram, limits));
+  EXPECT_EQ(fake.Read("intel-rapl:0:1", "constraint_0_power_limit_uw"), 12500000u);
+  EXPECT_EQ(fake.Read("intel-rapl:0", "constraint_0_power_limit_uw"), 95000000u);
+}
+
+TEST(PowercapActuatorTest, FailsForMissingDomain) {
+  FakePowercap fake;
+  PowercapActuator actuator(fake.Root(), "/nonexistent", {});
+  EXPECT_FALSE(actuator.EnforcePowerLimit(5, 50.0));
+  EXPECT_FALSE(actuator.SetLimits(1, RaplDomain::kDram, RaplLimits()));
+}
+
+// ============================================================================
+// MSR fallback
+// ============================================================================
+
+TEST(PowercapActuatorTest, MsrFallbackEncodesPl1AndKeepsPl2) {
+  FakeRaplMsr fake;
+  PowercapActuator actuator = fake.Actuator();
+  EXPECT_STREQ(actuator.Backend(0, RaplDomain::kPackage), "msr");
+
+  RaplLimits limits;
+  ASSERT_TRUE(actuator.ReadLimits(0, RaplDomain::kPackage, &limits));
+  EXPECT_DOUBLE_EQ(limits.long_term.watts, 95.0);
+  EXPECT_DOUBLE_EQ(limits.long_term.time_window_seconds, 1.0);
+  EXPECT_DOUBLE_EQ(limits.short_term.watts, 125.0);
+
+  ASSERT_TRUE(actuator.EnforcePowerLimit(0, 45.0, 2.5));
+  uint64_t raw = fake.Read(kMsrPkgPowerLimit);
+  EXPECT_EQ(raw & 0x7FFF, 360u);                   // 45 Вт / (1/8 Вт)
+  EXPECT_TRUE(raw & (1ULL << 15));                 // enable
+  EXPECT_TRUE(raw & (1ULL << 16));                 // clamp
+  EXPECT_EQ(raw >> 32, kPl2Field);                 // PL2 не тронут
+
+  ASSERT_TRUE(actuator.ReadLimits(0, RaplDomain::kPackage, &limits));
+  EXPECT_NEAR(limits.long_term.time_window_seconds, 2.5, 0.25);
+
+  ASSERT_TRUE(actuator.RestoreAll());
+  EXPECT_EQ(fake.Read(kMsrPkgPowerLimit), kPkgLimit);
+}
+
+TEST(PowercapActuatorTest, MsrFallbackReadsDram) {
+  FakeRaplMsr fake;
+  PowercapActuator actuator = fake.Actuator();
+  RaplLimits limits;
+  ASSERT_TRUE(actuator.ReadLimits(0, RaplDomain::kDram, &limits));
+  EXPECT_DOUBLE_EQ(limits.long_term.watts, 30.0);
+  EXPECT_FALSE(limits.has_short_term);
+}
+
+TEST(PowercapActuatorTest, RejectsLockedMsr) {
+  FakeRaplMsr fake;
+  fake.Write(kMsrPkgPowerLimit, kPkgLimit | (1ULL << 63));
+  PowercapActuator actuator = fake.Actuator();
+
+  EXPECT_FALSE(actuator.EnforcePowerLimit(0, 45.0));
+  EXPECT_EQ(fake.Read(kMsrPkgPowerLimit), kPkgLimit | (1ULL << 63));
+}
+
+TEST(PowercapActuatorTest, DetectsLimitNotApplied) {
+  FakeRaplMsr fake;
+  PowercapActuator actuator = fake.Actuator();
+  // 5000 Вт не помещаются в 15-битное поле: перечитанное значение другое
+  EXPECT_FALSE(actuator.EnforcePowerLimit(0, 5000.0));
+  ASSERT_TRUE(actuator.RestoreAll());
+  EXPECT_EQ(fake.Read(kMsrPkgPowerLimit), kPkgLimit);
+}
+
+// ============================================================================
+// Энергия
+// ============================================================================
+
+TEST(RaplEnergyMeterTest, AccumulatesAcrossPowercapWrap) {
+  FakePowercap fake;
+  fake.dir().WriteFile("powercap/intel-rapl:0/energy_uj", "262000000\n");
+  fake.dir().WriteFile("powercap/intel-rapl:0/max_energy_range_uj", "262143328850\n");
+  fake.dir().WriteFile("powercap/intel-rapl:1/energy_uj", "1000000\n");
+  fake.dir().WriteFile("powercap/intel-rapl:1/max_energy_range_uj", "262143328850\n");
+
+  RaplEnergyMeter meter(fake.Root(), "/nonexistent", {});
+  ASSERT_TRUE(meter.IsAvailable());
+  meter.Start();
+
+  fake.dir().WriteFile("powercap/intel-rapl:0/energy_uj", "362000000\n");   // +100 Дж
+  fake.dir().WriteFile("powercap/intel-rapl:1/energy_uj", "51000000\n");    // +50 Дж
+  EXPECT_NEAR(meter.Sample(), 150.0, 1e-6);
+
+  // Переполнение: 262143.32885 - 362 + 10
+  fake.dir().WriteFile("powercap/intel-rapl:0/energy_uj", "10000000\n");
+  EXPECT_NEAR(meter.Sample(), 150.0 + 262143.32885 - 362.0 + 10.0, 1e-6);
+}
+
+TEST(RaplEnergyMeterTest, ReadsMsrEnergyStatus) {
+  FakeRaplMsr fake;
+  fake.Write(0x611, 16384);   // 1 Дж в единицах 1/16384
+  RaplEnergyMeter meter = fake.Meter();
+  ASSERT_TRUE(meter.IsAvailable());
+  meter.Start();
+  fake.Write(0x611, 16384 * 11);
+  EXPECT_NEAR(meter.Sample(), 10.0, 1e-9);
+
+  RaplEnergyMeter missing("/nonexistent", "/nonexistent", {0});
+  EXPECT_FALSE(missing.IsAvailable());
+  EXPECT_TRUE(std::isnan(missing.Sample()));
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
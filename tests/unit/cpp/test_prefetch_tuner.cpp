@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include "optimization_engine.hpp"
+#include "prefetch_tuner.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+const std::vector<PrefetchSetting> kSettings = {
+    {0, 0}, {1, 0}, {8, 1}, {16, 2}, {64, 3}, {1000, 0}};
+
+}  // namespace
+
+// ============================================================================
+// Циклы
+// ============================================================================
+
+TEST(PrefetchLoopsTest, SequentialVisitsEveryElementOnce) {
+  for (size_t size : {0u, 1u, 15u, 16u, 17u, 100u, 1025u}) {
+    for (const auto& setting : kSettings) {
+      std::vector<int> data(size, 0);
+      ForEachSequential(data.data(), size, setting, [](int& x) { ++x; });
+      EXPECT_EQ(std::accumulate(data.begin(), data.end(), 0), static_cast<int>(size))
+          << "size " << size << " distance " << setting.distance;
+      for (int x : data) {
+        ASSERT_EQ(x, 1);
+      }
+    }
+  }
+}
+
+TEST(PrefetchLoopsTest, StridedAndIndirectVisitRequestedElements) {
+  std::vector<int> data(100, 0);
+  for (const auto& setting : kSettings) {
+    std::fill(data.begin(), data.end(), 0);
+    ForEachStrided(data.data(), 10, 7, setting, [](int& x) { ++x; });
+    for (size_t i = 0; i < data.size(); ++i) {
+      ASSERT_EQ(data[i], i % 7 == 0 && i < 70 ? 1 : 0) << "index " << i;
+    }
+  }
+
+  std::vector<uint32_t> indices = {5, 99, 0, 5, 42};
+  for (const auto& setting : kSettings) {
+    std::fill(data.begin(), data.end(), 0);
+    ForEachIndirect(data.data(), indices.data(), indices.size(), setting, [](int& x) { ++x; });
+    EXPECT_EQ(data[5], 2);
+    EXPECT_EQ(data[99], 1);
+    EXPECT_EQ(data[0], 1);
+    EXPECT_EQ(data[42], 1);
+    EXPECT_EQ(std::accumulate(data.begin(), data.end(), 0), 5);
+  }
+}
+
+// ============================================================================
+// Настройка
+// ============================================================================
+
+TEST(PrefetchTunerTest, PicksFastestCandidate) {
+  PrefetchTunerConfig config;
+  config.repetitions = 1;
+  config.distances = {4, 16, 64};
+  config.hints = {0, 2};
+  PrefetchTuner tuner(config);
+
+  // "Пропускная способность" ядра задаётся объёмом байт: лучший вариант 16/2
+  auto kernel = [](const PrefetchSetting& setting) {
+    double bytes = 1e6;
+    if (setting.distance == 16 && setting.hint == 2) {
+      bytes *= 100.0;
+    }
+    return bytes;
+  };
+  PrefetchTuneResult result = tuner.Tune("fake", AccessPattern::kStrided, sizeof(int), kernel);
+
+  EXPECT_EQ(result.kernel, "fake");
+  EXPECT_EQ(result.candidates.size(), 6u);
+  EXPECT_EQ(result.best.distance, 16u);
+  EXPECT_EQ(result.best.hint, 2);
+  EXPECT_GT(result.tuned_gbs, result.no_prefetch_gbs);
+}
+
+TEST(PrefetchTunerTest, DisablesPrefetchWithoutGain) {
+  PrefetchTunerConfig config;
+  config.repetitions = 1;
+  config.distances = {8};
+  config.hints = {0};
+  config.min_gain = 1e6;   // Никакой выигрыш не проходит порог
+  PrefetchTuner tuner(config);
+
+  PrefetchTuneResult result = tuner.Tune("fake", AccessPattern::kSequential, sizeof(int),
+                                         [](const PrefetchSetting&) { return 1e6; });
+  EXPECT_FALSE(result.best.Enabled());
+  EXPECT_DOUBLE_EQ(result.tuned_gbs, result.no_prefetch_gbs);
+}
+
+TEST(PrefetchTunerTest, CandidatesFollowElementSize) {
+  PrefetchTunerConfig config;
+  config.repetitions = 1;
+  config.hints = {0};
+  PrefetchTuner tuner(config);
+
+  // Те же байты вперёд: для double вдвое меньше итераций, чем для int
+  std::vector<size_t> seen;
+  PrefetchTuneResult result =
+      tuner.Tune("fake", AccessPattern::kSequential, sizeof(double),
+                 [&](const PrefetchSetting& setting) {
+                   seen.push_back(setting.distance);
+                   return 1e6;
+                 });
+  std::vector<size_t> expected = PrefetchTuner::DefaultDistances(AccessPattern::kSequential,
+                                                                 sizeof(double));
+  ASSERT_EQ(result.candidates.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(result.candidates[i].setting.distance, expected[i]);
+  }
+  EXPECT_EQ(expected.front(), 8u);
+  // Прежние 32 байта вперёд - 4 double
+  EXPECT_NE(std::find(seen.begin(), seen.end(), 4u), seen.end());
+  EXPECT_THROW(tuner.Tune("fake", AccessPattern::kSequential, 0,
+                          [](const PrefetchSetting&) { return 1e6; }),
+               std::invalid_argument);
+}
+
+TEST(PrefetchTunerTest, DefaultsCoverDramLatency) {
+  // Последовательно - от 1 до 128 линий, одна предвыборка на линию
+  std::vector<size_t> sequential = PrefetchTuner::DefaultDistances(AccessPattern::kSequential, 4);
+  EXPECT_EQ(sequential.front(), 16u);
+  EXPECT_EQ(sequential.back(), 128u * 16u);
+  EXPECT_EQ(PrefetchTuner::DefaultSetting(AccessPattern::kSequential, 4).distance, 256u);
+  EXPECT_EQ(PrefetchTuner::DefaultSetting(AccessPattern::kSequential, 8).distance, 128u);
+  EXPECT_GT(PrefetchTuner::DefaultSetting(AccessPattern::kIndirect, 4).distance, 8u);
+}
+
+TEST(PrefetchTunerTest, RealKernelsProduceBandwidth) {
+  PrefetchTunerConfig config;
+  config.array_bytes = 1u << 20;
+  config.repetitions = 1;
+  config.distances = {16};
+  config.hints = {0};
+  PrefetchTuner tuner(config);
+
+  for (AccessPattern pattern :
+       {AccessPattern::kSequential, AccessPattern::kStrided, AccessPattern::kIndirect}) {
+    PrefetchTuneResult result = tuner.TuneScale(pattern);
+    EXPECT_EQ(result.kernel, "scale");
+    EXPECT_GT(result.no_prefetch_gbs, 0.0) << AccessPatternName(pattern);
+    EXPECT_GT(result.before_gbs, 0.0);
+    EXPECT_GT(result.tuned_gbs, 0.0);
+    EXPECT_EQ(result.candidates.size(), 1u);
+  }
+}
+
+// ============================================================================
+// Профиль
+// ============================================================================
+
+TEST(PrefetchTunerTest, ProfileRoundTripFeedsEngine) {
+  TempDir dir;
+  std::string path = dir.path() + "/profile.json";
+
+  PrefetchTuneResult result;
+  result.kernel = "scale";
+  result.pattern = AccessPattern::kSequential;
+  result.best = {512, 1};
+  result.no_prefetch_gbs = 10.0;
+  result.before_gbs = 9.5;
+  result.tuned_gbs = 12.0;
+
+  MachineProfile profile = MachineProfile::Load(path, "cpu");
+  PrefetchTuner::StoreInProfile(result, profile);
+  profile.Save(path);
+
+  MachineProfile loaded = MachineProfile::Load(path, "cpu");
+  EXPECT_DOUBLE_EQ(loaded.Get<double>("prefetch.scale.sequential.before_gbs", 0.0), 9.5);
+  EXPECT_DOUBLE_EQ(loaded.Get<double>("prefetch.scale.sequential.tuned_gbs", 0.0), 12.0);
+
+  PrefetchSetting fallback = {3, 3};
+  PrefetchSetting setting =
+      PrefetchTuner::Lookup(loaded, "scale", AccessPattern::kSequential, fallback);
+  EXPECT_EQ(setting.distance, 512u);
+  EXPECT_EQ(setting.hint, 1);
+  setting = PrefetchTuner::Lookup(loaded, "scale", AccessPattern::kIndirect, fallback);
+  EXPECT_EQ(setting.distance, 3u);
+
+  OptimizationEngine engine;
+  PrefetchSetting indirect = engine.GetPrefetchSetting(AccessPattern::kIndirect);
+  EXPECT_EQ(engine.LoadPrefetchSettings(loaded), 1u);
+  EXPECT_EQ(engine.GetPrefetchSetting(AccessPattern::kSequential).distance, 512u);
+  EXPECT_EQ(engine.GetPrefetchSetting(AccessPattern::kSequential).hint, 1);
+  EXPECT_EQ(engine.GetPrefetchSetting(AccessPattern::kIndirect).distance, indirect.distance);
+
+  std::vector<int> data(2000, 1);
+  engine.ProcessArrayWithPrefetch(data.data(), data.size());
+  for (int x : data) {
+    ASSERT_EQ(x, 3);
+  }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
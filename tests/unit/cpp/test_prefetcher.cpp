@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "cache_simulator.hpp"
+#include "prefetcher.hpp"
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+
+namespace {
+
+CacheLevelConfig Level(size_t size_bytes, size_t ways) {
+  CacheLevelConfig config;
+  config.size_bytes = size_bytes;
+  config.line_bytes = 64;
+  config.ways = ways;
+  return config;
+}
+
+TraceRecord Read(uint64_t line, uint32_t pc = 0) {
+  return TraceRecord{line * 64, pc, static_cast<uint8_t>(AccessType::kRead), 0, 0};
+}
+
+TraceRecord SoftwarePrefetch(uint64_t line) {
+  return TraceRecord{line * 64, 0, static_cast<uint8_t>(AccessType::kPrefetch), 0, 0};
+}
+
+}  // namespace
+
+// ============================================================================
+// Модели
+// ============================================================================
+
+TEST(PrefetcherTest, NextLineFiresOnTriggerOnly) {
+  NextLinePrefetcher prefetcher(2);
+  std::vector<uint64_t> candidates;
+  prefetcher.Observe(10, 0, false, candidates);
+  EXPECT_TRUE(candidates.empty());
+  prefetcher.Observe(10, 0, true, candidates);
+  EXPECT_EQ(candidates, (std::vector<uint64_t>{11, 12}));
+}
+
+TEST(PrefetcherTest, StrideNeedsConfidenceAndPc) {
+  StridePrefetcher prefetcher(2);
+  std::vector<uint64_t> candidates;
+  for (uint64_t line : {0, 3, 6}) {
+    prefetcher.Observe(line, 0x400, false, candidates);
+  }
+  EXPECT_TRUE(candidates.empty());   // Шаг выучен, уверенность ещё 1
+  prefetcher.Observe(9, 0x400, false, candidates);
+  EXPECT_EQ(candidates, (std::vector<uint64_t>{12, 15}));
+
+  // Без pc модель не учится
+  candidates.clear();
+  StridePrefetcher anonymous(2);
+  for (uint64_t line : {0, 3, 6, 9, 12}) {
+    anonymous.Observe(line, 0, false, candidates);
+  }
+  EXPECT_TRUE(candidates.empty());
+}
+
+TEST(PrefetcherTest, StreamRunsAheadWithinPage) {
+  StreamPrefetcher prefetcher(16, 4);
+  std::vector<uint64_t> candidates;
+  prefetcher.Observe(0, 0, true, candidates);
+  prefetcher.Observe(1, 0, true, candidates);
+  EXPECT_TRUE(candidates.empty());
+  prefetcher.Observe(2, 0, true, candidates);
+  EXPECT_EQ(candidates, (std::vector<uint64_t>{3, 4, 5, 6}));
+
+  // Указатель продолжается с места, где остановился
+  candidates.clear();
+  prefetcher.Observe(3, 0, true, candidates);
+  EXPECT_EQ(candidates, (std::vector<uint64_t>{7, 8, 9, 10}));
+
+  // Граница страницы (64 строки) останавливает поток
+  candidates.clear();
+  StreamPrefetcher edge(16, 4);
+  for (uint64_t line : {60, 61, 62}) {
+    edge.Observe(line, 0, true, candidates);
+  }
+  EXPECT_EQ(candidates, (std::vector<uint64_t>{63}));
+
+  // Убывающий поток
+  candidates.clear();
+  StreamPrefetcher down(16, 2);
+  for (uint64_t line : {130, 129, 128}) {
+    down.Observe(line, 0, true, candidates);
+  }
+  EXPECT_TRUE(candidates.empty());   // 128 - первая строка страницы
+  for (uint64_t line : {100, 99, 98}) {
+    down.Observe(line, 0, true, candidates);
+  }
+  EXPECT_EQ(candidates, (std::vector<uint64_t>{97, 96}));
+}
+
+TEST(PrefetcherTest, FactoryParsesSpecs) {
+  EXPECT_STREQ(MakePrefetcher("next-line")->Name(), "next-line");
+  EXPECT_STREQ(MakePrefetcher("stride:4")->Name(), "stride");
+  EXPECT_STREQ(MakePrefetcher("stream:32")->Name(), "stream");
+  EXPECT_THROW(MakePrefetcher("markov"), std::invalid_argument);
+  EXPECT_THROW(MakePrefetcher("stream:0"), std::invalid_argument);
+  EXPECT_THROW(MakePrefetcher("stride:x"), std::invalid_argument);
+}
+
+// ============================================================================
+// Предвыборка в иерархии
+// ============================================================================
+
+TEST(PrefetcherTest, NextLineCoversSequentialScan) {
+  CacheHierarchy hierarchy({Level(4u << 10, 4), Level(64u << 10, 8)});
+  hierarchy.AddPrefetcher(MakePrefetcher("next-line"));
+  std::vector<TraceRecord> records;
+  for (uint64_t line = 0; line < 4096; ++line) {
+    records.push_back(Read(line));
+  }
+  hierarchy.Simulate(records.data(), records.size());
+
+  PrefetchStats stats = hierarchy.PrefetcherStats(0);
+  const CacheStats& l1 = hierarchy.Level(0).stats();
+  EXPECT_EQ(l1.accesses, 4096u);
+  EXPECT_GT(stats.Coverage(l1.misses), 0.99);
+  EXPECT_GT(stats.Accuracy(), 0.99);
+  // Следующая строка запрашивается сразу после загрузки: предвыборка опаздывает
+  EXPECT_LT(stats.Timeliness(), 0.01);
+}
+
+TEST(PrefetcherTest, RandomAccessesWastePrefetches) {
+  CacheHierarchy hierarchy({Level(4u << 10, 4)});
+  hierarchy.AddPrefetcher(MakePrefetcher("next-line:2"));
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<uint64_t> lines(0, 1u << 20);
+  std::vector<TraceRecord> records;
+  for (int i = 0; i < 20000; ++i) {
+    records.push_back(Read(lines(rng) * 4));
+  }
+  hierarchy.Simulate(records.data(), records.size());
+
+  PrefetchStats stats = hierarchy.PrefetcherStats(0);
+  EXPECT_GT(stats.issued, 30000u);
+  EXPECT_LT(stats.Accuracy(), 0.01);
+  EXPECT_GT(stats.useless, stats.issued * 9 / 10);
+}
+
+TEST(PrefetcherTest, StridePrefetcherFollowsInstruction) {
+  CacheHierarchy hierarchy({Level(4u << 10, 4)});
+  hierarchy.AddPrefetcher(MakePrefetcher("stride:4"));
+  hierarchy.SetPrefetchLatency(2);
+  std::vector<TraceRecord> records;
+  // Две инструкции с разными шагами вперемешку
+  for (uint64_t i = 0; i < 2000; ++i) {
+    records.push_back(Read(i * 3, 0x401000));
+    records.push_back(Read((1u << 20) + i * 5, 0x401040));
+  }
+  hierarchy.Simulate(records.data(), records.size());
+
+  PrefetchStats stats = hierarchy.PrefetcherStats(0);
+  EXPECT_GT(stats.Coverage(hierarchy.Level(0).stats().misses), 0.99);
+  EXPECT_GT(stats.Accuracy(), 0.99);
+  EXPECT_GT(stats.Timeliness(), 0.99);   // Загрузки на 2-4 шага вперёд
+}
+
+TEST(PrefetcherTest, L2StreamerSeesOnlyL1Misses) {
+  CacheHierarchy hierarchy({Level(1u << 10, 2), Level(64u << 10, 8)});
+  hierarchy.AddPrefetcher(MakePrefetcher("stream"), 1);
+  EXPECT_EQ(hierarchy.PrefetcherLevel(0), 1u);
+  std::vector<TraceRecord> records;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (uint64_t line = 0; line < 512; ++line) {
+      records.push_back(Read(line));
+    }
+  }
+  hierarchy.Simulate(records.data(), records.size());
+
+  PrefetchStats stats = hierarchy.PrefetcherStats(0);
+  const CacheStats& l2 = hierarchy.Level(1).stats();
+  EXPECT_EQ(l2.accesses, hierarchy.Level(0).stats().misses);
+  EXPECT_GT(stats.Coverage(l2.misses), 0.9);
+  EXPECT_GT(stats.Accuracy(), 0.95);
+  EXPECT_EQ(hierarchy.Level(0).stats().misses, 1024u);   // L1 предвыборка L2 не трогает
+  EXPECT_THROW(hierarchy.AddPrefetcher(MakePrefetcher("stream"), 2), std::invalid_argument);
+}
+
+TEST(PrefetcherTest, SoftwareHintsAreNotDemandAccesses) {
+  CacheHierarchy hierarchy({Level(4u << 10, 4)});
+  hierarchy.SetPrefetchLatency(8);
+  std::vector<TraceRecord> records;
+  // Подсказка за 16 записей до обращения успевает, за 1 запись - нет
+  for (uint64_t line = 0; line < 16; ++line) {
+    records.push_back(SoftwarePrefetch(line));
+  }
+  for (uint64_t line = 0; line < 16; ++line) {
+    records.push_back(Read(line));
+  }
+  records.push_back(SoftwarePrefetch(100));
+  records.push_back(Read(100));
+  records.push_back(SoftwarePrefetch(200));
+  records.push_back(SoftwarePrefetch(0));   // Уже в кэше
+  hierarchy.Simulate(records.data(), records.size());
+
+  PrefetchStats stats = hierarchy.SoftwarePrefetchStats();
+  EXPECT_EQ(hierarchy.records(), records.size());
+  EXPECT_EQ(hierarchy.Level(0).stats().accesses, 17u);
+  EXPECT_EQ(hierarchy.Level(0).stats().misses, 0u);
+  EXPECT_EQ(stats.issued, 18u);
+  EXPECT_EQ(stats.redundant, 1u);
+  EXPECT_EQ(stats.useful, 17u);
+  EXPECT_EQ(stats.late, 1u);
+  EXPECT_EQ(hierarchy.PrefetcherCount(), 0u);
+
+  hierarchy.Reset();
+  EXPECT_EQ(hierarchy.SoftwarePrefetchStats().issued, 0u);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include "roofline.hpp"
+#include "test_utils.hpp"
+#include "workload_classifier.hpp"
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+using namespace hardware_analysis;
+
+namespace {
+
+/**
+ * @brief Машина на 4 CPU: 16 GFLOP/s FP64 на ядро, кэши 200/100/50 GB/s, DRAM 10 GB/s
+ */
+RooflineReport SyntheticReport() {
+  RooflineReport report;
+  report.cpu_model = "Test \"CPU\"";
+  report.cache_signature = "L1D:48K;L2:2M";
+  report.compute = {{Precision::kFp64, SimdIsa::kAvx2, 16.0, 60.0, 4},
+                    {Precision::kFp32, SimdIsa::kAvx2, 32.0, 120.0, 4}};
+  report.bandwidth = {{"L1", 24u << 10, 200.0, 0.0},
+                      {"L2", 1u << 20, 100.0, 0.0},
+                      {"L3", 8u << 20, 50.0, 0.0},
+                      {"DRAM", 64u << 20, 10.0, 25.0}};
+  return report;
+}
+
+KernelPoint Point(double intensity, double gflops, size_t threads = 1) {
+  KernelPoint point{};
+  point.name = "kernel";
+  point.precision = Precision::kFp64;
+  point.threads = threads;
+  point.intensity = intensity;
+  point.gflops = gflops;
+  return point;
+}
+
+RooflineConfig FastConfig() {
+  RooflineConfig config;
+  config.socket_cpus = {0, 0};
+  config.min_seconds = 0.002;
+  config.repetitions = 1;
+  return config;
+}
+
+}  // namespace
+
+// ============================================================================
+// Размещение
+// ============================================================================
+
+TEST(RooflineTest, AttainableIsMinOfRoofs) {
+  EXPECT_DOUBLE_EQ(RooflineModel::Attainable(16.0, 10.0, 0.5), 5.0);
+  EXPECT_DOUBLE_EQ(RooflineModel::Attainable(16.0, 10.0, 4.0), 16.0);
+  // Неизвестный потолок не ограничивает
+  EXPECT_DOUBLE_EQ(RooflineModel::Attainable(0.0, 10.0, 4.0), 40.0);
+  EXPECT_DOUBLE_EQ(RooflineModel::Attainable(16.0, 0.0, 0.5), 16.0);
+}
+
+TEST(RooflineTest, PlacesKernelsAgainstCeilings) {
+  RooflineReport report = SyntheticReport();
+  EXPECT_EQ(report.Compute(Precision::kFp32)->gflops_per_core, 32.0);
+  EXPECT_EQ(report.Bandwidth("L4"), nullptr);
+
+  // 0.125 FLOP/B, 1 GFLOP/s: ниже крыши DRAM (1.25)
+  KernelPoint streaming = Point(0.125, 1.0);
+  RooflineModel::Place(streaming, report);
+  EXPECT_EQ(streaming.bound, "memory");
+  EXPECT_DOUBLE_EQ(streaming.attainable_gflops, 1.25);
+  EXPECT_DOUBLE_EQ(streaming.efficiency, 0.8);
+  EXPECT_EQ(streaming.served_from, "DRAM");
+
+  // 5 GFLOP/s выше крыши DRAM: самый медленный уровень, чья крыша выше, - L3 (6.25)
+  KernelPoint cached = Point(0.125, 5.0);
+  RooflineModel::Place(cached, report);
+  EXPECT_EQ(cached.served_from, "L3");
+  EXPECT_GT(cached.efficiency, 1.0);
+
+  // 10 FLOP/B: упирается в пик FP64
+  KernelPoint dense = Point(10.0, 12.0);
+  RooflineModel::Place(dense, report);
+  EXPECT_EQ(dense.bound, "compute");
+  EXPECT_DOUBLE_EQ(dense.attainable_gflops, 16.0);
+  EXPECT_EQ(dense.served_from, "DRAM");
+}
+
+TEST(RooflineTest, MultiThreadedKernelsUseSocketCeilings) {
+  RooflineReport report = SyntheticReport();
+  KernelPoint parallel = Point(0.125, 3.0, 4);
+  RooflineModel::Place(parallel, report);
+  // DRAM пакета 25 GB/s, а не 10 на ядро
+  EXPECT_DOUBLE_EQ(parallel.attainable_gflops, 3.125);
+  EXPECT_EQ(parallel.bound, "memory");
+
+  KernelPoint dense = Point(10.0, 50.0, 4);
+  RooflineModel::Place(dense, report);
+  EXPECT_DOUBLE_EQ(dense.attainable_gflops, 60.0);
+  // Кэши пакета: пропускная способность на ядро x потоки
+  KernelPoint cached = Point(0.125, 20.0, 4);
+  RooflineModel::Place(cached, report);
+  EXPECT_EQ(cached.served_from, "L3");
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+TEST(RooflineTest, JsonIsParseable) {
+  RooflineReport report = SyntheticReport();
+  report.kernels.push_back(Point(0.125, 1.0));
+  report.kernels.back().bytes_source = "model";
+  RooflineModel::Place(report.kernels.back(), report);
+
+  std::stringstream json;
+  RooflineModel::WriteJson(json, report);
+  boost::property_tree::ptree root;
+  ASSERT_NO_THROW(boost::property_tree::read_json(json, root)) << json.str();
+
+  EXPECT_EQ(root.get<std::string>("cpu_model"), "Test \"CPU\"");
+  EXPECT_EQ(root.get_child("compute").size(), 2u);
+  EXPECT_EQ(root.get_child("compute").front().second.get<std::string>("precision"), "fp64");
+  EXPECT_EQ(root.get_child("bandwidth").back().second.get<std::string>("level"), "DRAM");
+  EXPECT_DOUBLE_EQ(root.get_child("bandwidth").back().second.get<double>("gbs_per_socket"), 25.0);
+  const auto& kernel = root.get_child("kernels").front().second;
+  EXPECT_EQ(kernel.get<std::string>("bound"), "memory");
+  EXPECT_EQ(kernel.get<std::string>("served_from"), "DRAM");
+
+  // Пустой отчёт - тоже корректный JSON
+  std::stringstream empty;
+  RooflineModel::WriteJson(empty, RooflineReport{});
+  EXPECT_NO_THROW(boost::property_tree::read_json(empty, root)) << empty.str();
+}
+
+// ============================================================================
+// Измерения
+// ============================================================================
+
+TEST(RooflineTest, MeasuresFmaPeaks) {
+  RooflineModel model(FastConfig());
+  ComputeCeiling scalar = model.MeasureCompute(Precision::kFp64, SimdIsa::kScalar);
+  EXPECT_GT(scalar.gflops_per_core, 0.0);
+  EXPECT_GT(scalar.gflops_per_socket, 0.0);
+  EXPECT_EQ(scalar.socket_threads, 2u);
+
+  SimdIsa best = BestSimdIsa();
+  if (best != SimdIsa::kScalar) {
+    // Вектор не медленнее скаляра: 4-16 полос против одной
+    ComputeCeiling vector = model.MeasureCompute(Precision::kFp32, best);
+    EXPECT_GT(vector.gflops_per_core, 0.0);
+    if (testing_utils::PerfAssertionsEnabled()) {
+      EXPECT_GT(vector.gflops_per_core, scalar.gflops_per_core);
+    }
+  }
+  if (best != SimdIsa::kAvx512) {
+    EXPECT_THROW(model.MeasureCompute(Precision::kFp64, SimdIsa::kAvx512),
+                 std::invalid_argument);
+  }
+}
+
+TEST(RooflineTest, MeasuresKernelIntensity) {
+  RooflineModel model(FastConfig());
+  std::vector<double> data(1u << 16, 1.0);
+  double sum = 0.0;
+  KernelPoint point = model.MeasureKernel("sum", Precision::kFp64, 1, data.size(),
+                                          data.size() * sizeof(double), [&] {
+                                            for (double value : data) {
+                                              sum += value;
+                                            }
+                                          });
+  EXPECT_GT(sum, 0.0);
+  EXPECT_EQ(point.name, "sum");
+  EXPECT_GT(point.seconds, 0.0);
+  EXPECT_GT(point.gflops, 0.0);
+  EXPECT_TRUE(point.bytes_source == "model" || point.bytes_source == "perf");
+  if (point.bytes_source == "model") {
+    EXPECT_DOUBLE_EQ(point.intensity, 0.125);
+  }
+}
+
+TEST(RooflineTest, UsesPerfTrafficWhenCountersAvailable) {
+  std::vector<double> data(1u << 16, 1.0);
+  double sum = 0.0;
+  auto kernel = [&] {
+    for (double value : data) {
+      sum += value;
+    }
+  };
+  std::unique_ptr<PerfEventCounterSource> probe;
+  try {
+    probe = std::make_unique<PerfEventCounterSource>(std::vector<int>{0}, 0);
+  } catch (const std::exception&) {
+    GTEST_SKIP() << "perf_event is unavailable";
+  }
+  std::vector<PhaseFeatures> features(1, PhaseFeatures::Unknown());
+  probe->Sample(features);
+  kernel();
+  if (!probe->Sample(features) || !std::isfinite(features[0].llc_mpki)) {
+    GTEST_SKIP() << "LLC miss counter is unavailable";
+  }
+  probe.reset();
+
+  RooflineModel model(FastConfig());
+  KernelPoint point = model.MeasureKernel("sum", Precision::kFp64, 1, data.size(),
+                                          data.size() * sizeof(double), kernel);
+  EXPECT_EQ(point.bytes_source, "perf");
+}
+
+TEST(RooflineTest, MeasuresBandwidthPerLevel) {
+  RooflineConfig config = FastConfig();
+  config.bandwidth_bytes = 4u << 20;
+  config.dram_working_set = 2u << 20;
+  RooflineModel model(config);
+
+  CacheTopology caches;
+  caches.caches = {{1, CacheType::kData, 32u << 10, 64, 8, 64, {0}},
+                   {2, CacheType::kUnified, 512u << 10, 64, 8, 1024, {0}}};
+  auto ceilings = model.MeasureBandwidth(caches);
+  ASSERT_EQ(ceilings.size(), 3u);
+  EXPECT_EQ(ceilings[0].level, "L1");
+  EXPECT_EQ(ceilings[0].working_set, 16u << 10);
+  EXPECT_EQ(ceilings[1].level, "L2");
+  EXPECT_EQ(ceilings[2].level, "DRAM");
+  EXPECT_EQ(ceilings[2].working_set, 2u << 20);
+  for (const auto& ceiling : ceilings) {
+    EXPECT_GT(ceiling.gbs_per_core, 0.0) << ceiling.level;
+  }
+  EXPECT_GT(ceilings[2].gbs_per_socket, 0.0);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
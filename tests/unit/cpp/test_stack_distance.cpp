@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include "cache_simulator.hpp"
+#include "stack_distance.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace hardware_analysis;
+
+namespace {
+
+std::vector<TraceRecord> LinesTrace(const std::vector<uint64_t>& lines) {
+  std::vector<TraceRecord> records;
+  for (uint64_t line : lines) {
+    records.push_back(TraceRecord{line * 64, 0, 0, 0, 0});
+  }
+  return records;
+}
+
+std::vector<uint64_t> RandomLines(size_t count, uint64_t distinct, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  // Смесь горячего набора и длинного хвоста: кривая без плато
+  std::uniform_int_distribution<uint64_t> hot(0, distinct / 16);
+  std::uniform_int_distribution<uint64_t> all(0, distinct - 1);
+  std::vector<uint64_t> lines(count);
+  for (size_t i = 0; i < count; ++i) {
+    lines[i] = (i % 3) ? hot(rng) : all(rng);
+  }
+  return lines;
+}
+
+double LruMissRatio(const std::vector<TraceRecord>& records, size_t lines) {
+  CacheLevelConfig config;
+  config.size_bytes = lines * 64;
+  config.ways = lines;
+  CacheHierarchy cache({config});
+  cache.Simulate(records.data(), records.size());
+  return 1.0 - cache.Level(0).stats().HitRate();
+}
+
+}  // namespace
+
+// ============================================================================
+// Точный анализ
+// ============================================================================
+
+TEST(StackDistanceTest, CountsDistinctLinesBetweenReuses) {
+  StackDistanceAnalyzer analyzer;
+  for (uint64_t line : {1, 2, 3, 2, 1, 1}) {
+    analyzer.AccessLine(line);
+  }
+  const MissRatioCurve& curve = analyzer.curve();
+  EXPECT_DOUBLE_EQ(curve.accesses, 6.0);
+  EXPECT_DOUBLE_EQ(curve.cold, 3.0);
+  ASSERT_GE(curve.histogram.size(), 3u);
+  EXPECT_DOUBLE_EQ(curve.histogram[0], 1.0);   // 1 сразу после 1
+  EXPECT_DOUBLE_EQ(curve.histogram[1], 1.0);   // 2 через 3
+  EXPECT_DOUBLE_EQ(curve.histogram[2], 1.0);   // 1 через 2 и 3
+  EXPECT_EQ(analyzer.DistinctLines(), 3u);
+
+  EXPECT_DOUBLE_EQ(curve.MissRatio(0), 1.0);
+  EXPECT_DOUBLE_EQ(curve.MissRatio(1), 5.0 / 6.0);
+  EXPECT_DOUBLE_EQ(curve.MissRatio(3), 0.5);
+  EXPECT_EQ(curve.CapacityFor(0.5), 3u);
+  EXPECT_EQ(curve.CapacityFor(0.4), 0u);
+}
+
+TEST(StackDistanceTest, MatchesLruSimulationAtEveryCapacity) {
+  // Длиннее начального дерева Фенвика: проверяет и перенумерацию моментов
+  std::vector<TraceRecord> records = LinesTrace(RandomLines(150000, 4096, 3));
+  MissRatioCurve curve = StackDistanceAnalyzer::Analyze(records.data(), records.size());
+  EXPECT_DOUBLE_EQ(curve.accesses, 150000.0);
+
+  for (size_t lines : {1, 7, 64, 256, 1000, 4096}) {
+    EXPECT_NEAR(curve.MissRatio(lines), LruMissRatio(records, lines), 1e-12)
+        << lines << " lines";
+  }
+}
+
+TEST(StackDistanceTest, SplitsLineCrossingAccesses) {
+  StackDistanceAnalyzer analyzer;
+  std::vector<TraceRecord> records = {TraceRecord{60, 0, 0, 8, 0}, TraceRecord{0, 0, 0, 0, 0}};
+  analyzer.Simulate(records.data(), records.size());
+  EXPECT_DOUBLE_EQ(analyzer.curve().accesses, 3.0);
+  EXPECT_DOUBLE_EQ(analyzer.curve().histogram[1], 1.0);
+}
+
+// ============================================================================
+// Шарды
+// ============================================================================
+
+TEST(StackDistanceTest, ShardedCurveApproximatesExact) {
+  std::vector<TraceRecord> records = LinesTrace(RandomLines(200000, 32768, 5));
+  MissRatioCurve exact = StackDistanceAnalyzer::Analyze(records.data(), records.size());
+  MissRatioCurve sharded =
+      StackDistanceAnalyzer::Analyze(records.data(), records.size(), 64, 8, 3);
+  EXPECT_DOUBLE_EQ(sharded.accesses, exact.accesses);
+
+  for (size_t lines : {512, 2048, 8192, 16384, 32768}) {
+    EXPECT_NEAR(sharded.MissRatio(lines), exact.MissRatio(lines), 0.03) << lines << " lines";
+  }
+}
+
+TEST(StackDistanceTest, RejectsInvalidConfiguration) {
+  EXPECT_THROW(StackDistanceAnalyzer(48), std::invalid_argument);
+  EXPECT_THROW(StackDistanceAnalyzer(64, 4, 4), std::invalid_argument);
+  EXPECT_THROW(StackDistanceAnalyzer::Analyze(nullptr, 0, 64, 0), std::invalid_argument);
+
+  MissRatioCurve a;
+  MissRatioCurve b;
+  b.line_bytes = 128;
+  EXPECT_THROW(a.Merge(b), std::invalid_argument);
+}
+
+// ============================================================================
+// Выборка (SHARDS)
+// ============================================================================
+
+TEST(StackDistanceTest, CoarsensBucketsWithinMemoryLimit) {
+  MissRatioCurve curve;
+  curve.max_buckets = 4;
+  for (uint64_t distance = 0; distance < 16; ++distance) {
+    curve.Add(distance);
+  }
+  EXPECT_EQ(curve.bucket_lines, 4u);
+  EXPECT_LE(curve.histogram.size(), 4u);
+  EXPECT_DOUBLE_EQ(curve.accesses, 16.0);
+  EXPECT_DOUBLE_EQ(curve.MissRatio(8), 0.5);
+  EXPECT_DOUBLE_EQ(curve.MissRatio(6), 10.0 / 16.0);   // Интерполяция внутри корзины
+  EXPECT_EQ(curve.CapacityFor(0.5), 8u);
+
+  MissRatioCurve fine;
+  fine.Add(1);
+  fine.Add(9);
+  curve.Merge(fine);
+  EXPECT_EQ(curve.bucket_lines, 4u);
+  EXPECT_DOUBLE_EQ(curve.accesses, 18.0);
+}
+
+TEST(StackDistanceTest, FixedRateSamplingTracksExactCurve) {
+  std::vector<TraceRecord> records = LinesTrace(RandomLines(400000, 65536, 13));
+  MissRatioCurve exact = StackDistanceAnalyzer::Analyze(records.data(), records.size());
+
+  ShardsConfig config;
+  config.rate = 0.1;
+  ShardsAnalyzer sampled(config);
+  sampled.Simulate(records.data(), records.size());
+  EXPECT_NEAR(sampled.Rate(), 0.1, 1e-9);
+  EXPECT_LT(sampled.SampledLines(), exact.cold * 0.15);
+
+  MissRatioCurve curve = sampled.Curve();
+  EXPECT_NEAR(curve.accesses, 400000.0, 400000.0 * 0.1);
+  double error = 0.0;
+  size_t inside = 0;
+  std::vector<size_t> capacities = {256, 1024, 4096, 16384, 32768, 65536};
+  for (size_t lines : capacities) {
+    double truth = exact.MissRatio(lines);
+    error += std::abs(curve.MissRatio(lines) - truth);
+    MissRatioEstimate estimate = sampled.Estimate(lines);
+    inside += truth >= estimate.lower && truth <= estimate.upper;
+  }
+  EXPECT_LT(error / capacities.size(), 0.02);
+  EXPECT_GE(inside, capacities.size() - 1);
+
+  // SHARDS_adj возвращает взвешенное число обращений к длине трассы
+  config.adjust = true;
+  ShardsAnalyzer adjusted(config);
+  adjusted.Simulate(records.data(), records.size());
+  EXPECT_DOUBLE_EQ(adjusted.Curve().accesses, 400000.0);
+}
+
+TEST(StackDistanceTest, FixedSizeSamplingUsesConstantMemory) {
+  std::vector<TraceRecord> records = LinesTrace(RandomLines(400000, 65536, 17));
+  MissRatioCurve exact = StackDistanceAnalyzer::Analyze(records.data(), records.size());
+
+  ShardsConfig config;
+  config.rate = 1.0;
+  config.max_samples = 4096;
+  config.max_buckets = 1024;
+  ShardsAnalyzer sampled(config);
+  sampled.Simulate(records.data(), records.size());
+  EXPECT_LE(sampled.SampledLines(), 4096u);
+  EXPECT_LT(sampled.Rate(), 0.1);
+
+  MissRatioCurve curve = sampled.Curve();
+  EXPECT_LE(curve.histogram.size(), 1024u);
+  for (size_t lines : {1024, 8192, 32768, 65536}) {
+    EXPECT_NEAR(curve.MissRatio(lines), exact.MissRatio(lines), 0.04) << lines << " lines";
+  }
+}
+
+TEST(StackDistanceTest, RejectsInvalidSamplingRate) {
+  ShardsConfig config;
+  config.rate = 0.0;
+  EXPECT_THROW(ShardsAnalyzer{config}, std::invalid_argument);
+  config.rate = 1.5;
+  EXPECT_THROW(ShardsAnalyzer{config}, std::invalid_argument);
+}
+
+// ============================================================================
+// Использование кривой
+// ============================================================================
+
+TEST(StackDistanceTest, WritesLogSpacedJson) {
+  std::vector<TraceRecord> records = LinesTrace(RandomLines(20000, 1024, 9));
+  MissRatioCurve curve = StackDistanceAnalyzer::Analyze(records.data(), records.size());
+  std::vector<size_t> lines = curve.LogCapacities(2);
+  ASSERT_GE(lines.size(), 2u);
+  EXPECT_EQ(lines.front(), 1u);
+  EXPECT_EQ(lines.back(), curve.histogram.size());
+  EXPECT_TRUE(std::is_sorted(lines.begin(), lines.end()));
+
+  std::ostringstream out;
+  curve.WriteJson(out, lines);
+  EXPECT_NE(out.str().find("\"miss_ratio\""), std::string::npos);
+  EXPECT_NE(out.str().find("\"accesses\": 20000,"), std::string::npos);
+  EXPECT_NE(out.str().find("\"points\": [\n    {\"lines\": 1, \"bytes\": 64"),
+            std::string::npos);
+}
+
+TEST(StackDistanceTest, PartitionFavoursReusingConsumer) {
+  // Цикл по 100 строкам выигрывает от 100 строк, поток без повторов - ни от чего
+  StackDistanceAnalyzer loop;
+  StackDistanceAnalyzer stream;
+  for (int pass = 0; pass < 20; ++pass) {
+    for (uint64_t line = 0; line < 100; ++line) {
+      loop.AccessLine(line);
+      stream.AccessLine(1000000 + pass * 100 + line);
+    }
+  }
+  std::vector<size_t> units = PartitionCapacity({stream.curve(), loop.curve()}, 4, 50);
+  ASSERT_EQ(units.size(), 2u);
+  EXPECT_EQ(units[0] + units[1], 4u);
+  EXPECT_GE(units[1], 2u);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "stress_engine.hpp"
+#include "test_utils.hpp"
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace hardware_analysis;
+
+namespace {
+
+StressPhase Phase(StressKind kind, double seconds, double duty = 1.0) {
+  StressPhase phase;
+  phase.kind = kind;
+  phase.seconds = seconds;
+  phase.duty_cycle = duty;
+  phase.period_seconds = 0.02;
+  phase.working_set = 1u << 20;
+  return phase;
+}
+
+}  // namespace
+
+// ============================================================================
+// Конфигурация
+// ============================================================================
+
+TEST(StressEngineTest, ParsesPhaseSpecs) {
+  StressPhase phase = StressPhase::Parse("stream:5:0.5:200");
+  EXPECT_EQ(phase.kind, StressKind::kStream);
+  EXPECT_DOUBLE_EQ(phase.seconds, 5.0);
+  EXPECT_DOUBLE_EQ(phase.duty_cycle, 0.5);
+  EXPECT_DOUBLE_EQ(phase.period_seconds, 0.2);
+
+  phase = StressPhase::Parse("idle:1.5");
+  EXPECT_EQ(phase.kind, StressKind::kIdle);
+  EXPECT_DOUBLE_EQ(phase.duty_cycle, 1.0);
+
+  EXPECT_THROW(StressPhase::Parse("compute"), std::invalid_argument);
+  EXPECT_THROW(StressPhase::Parse("spin:1"), std::invalid_argument);
+  EXPECT_THROW(StressPhase::Parse("chase:x"), std::invalid_argument);
+  EXPECT_THROW(StressPhase::Parse("chase:1:0.5:10:3"), std::invalid_argument);
+}
+
+TEST(StressEngineTest, RejectsInvalidPhases) {
+  StressConfig config;
+  EXPECT_THROW(StressEngine{config}, std::invalid_argument);
+
+  config.phases = {Phase(StressKind::kCompute, 1.0, 0.0)};
+  EXPECT_THROW(StressEngine{config}, std::invalid_argument);
+
+  config.phases = {Phase(StressKind::kStream, 1.0)};
+  config.phases[0].working_set = 4096;
+  EXPECT_THROW(StressEngine{config}, std::invalid_argument);
+}
+
+TEST(StressEngineTest, ScheduleMapsTimeToPhases) {
+  StressConfig config;
+  config.phases = {Phase(StressKind::kCompute, 1.0), Phase(StressKind::kIdle, 0.5)};
+  config.cycles = 2;
+  StressEngine engine(config);
+  EXPECT_DOUBLE_EQ(engine.TotalSeconds(), 3.0);
+  EXPECT_EQ(engine.PhaseAt(0.0), 0u);
+  EXPECT_EQ(engine.PhaseAt(1.2), 1u);
+  EXPECT_EQ(engine.PhaseAt(1.6), 0u);
+  EXPECT_EQ(engine.PhaseAt(2.9), 1u);
+  EXPECT_EQ(engine.PhaseAt(3.0), 2u);
+}
+
+// ============================================================================
+// Нагрузка
+// ============================================================================
+
+TEST(StressEngineTest, EveryKindReportsItsCounters) {
+  StressConfig config;
+  config.cpus = {0, 0};
+  config.phases = {Phase(StressKind::kCompute, 0.05), Phase(StressKind::kStream, 0.05),
+                   Phase(StressKind::kChase, 0.05), Phase(StressKind::kMixed, 0.05),
+                   Phase(StressKind::kIdle, 0.05)};
+  StressEngine engine(config);
+  std::vector<StressRates> rates = engine.Run();
+  ASSERT_EQ(rates.size(), 5u);
+  EXPECT_TRUE(engine.Finished());
+
+  EXPECT_GT(rates[0].gflops, 0.0);
+  EXPECT_DOUBLE_EQ(rates[0].gbs, 0.0);
+  EXPECT_GT(rates[1].gbs, 0.0);
+  EXPECT_GT(rates[2].maccesses_per_second, 0.0);
+  EXPECT_DOUBLE_EQ(rates[2].gflops, 0.0);
+  EXPECT_GT(rates[3].gflops, 0.0);
+  EXPECT_GT(rates[3].gbs, 0.0);
+  EXPECT_DOUBLE_EQ(rates[4].busy_fraction, 0.0);
+}
+
+TEST(StressEngineTest, DutyCycleLimitsBusyTime) {
+  StressConfig config;
+  config.phases = {Phase(StressKind::kCompute, 0.3, 0.25)};
+  StressEngine engine(config);
+  std::vector<StressRates> rates = engine.Run();
+  ASSERT_EQ(rates.size(), 1u);
+  EXPECT_GT(rates[0].busy_fraction, 0.0);
+  EXPECT_LE(rates[0].busy_fraction, 1.0);
+  if (testing_utils::PerfAssertionsEnabled()) {
+    EXPECT_GT(rates[0].busy_fraction, 0.1);
+    EXPECT_LT(rates[0].busy_fraction, 0.45);
+  }
+}
+
+TEST(StressEngineTest, SamplesWhileRunningAndStopsEarly) {
+  StressConfig config;
+  config.phases = {Phase(StressKind::kCompute, 30.0)};
+  StressEngine engine(config);
+  engine.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  StressRates rates = engine.Sample();
+  EXPECT_EQ(rates.phase, 0u);
+  EXPECT_GT(rates.seconds, 0.0);
+  EXPECT_GT(rates.gflops, 0.0);
+  engine.Stop();
+  // Остановлен задолго до конца 30-секундной фазы
+  EXPECT_GT(engine.PhaseTotals(0).busy_seconds, 0.0);
+  EXPECT_LT(engine.PhaseTotals(0).busy_seconds, 5.0);
+  // Скорость фазы считается по прожитому времени, а не по номинальным 30 с
+  EXPECT_GT(engine.PhaseSeconds(0), 0.0);
+  EXPECT_LT(engine.PhaseSeconds(0), 5.0);
+  EXPECT_GE(engine.PhaseSeconds(0), engine.PhaseTotals(0).busy_seconds * 0.99);
+}
+
+TEST(StressEngineTest, StartReportsBufferFailure) {
+  StressConfig config;
+  config.cpus = {0, 0};
+  config.phases = {Phase(StressKind::kStream, 0.05)};
+  config.phases[0].working_set = 1ull << 60;   // mmap отказывает в каждом потоке
+  StressEngine engine(config);
+  EXPECT_THROW(engine.Run(), std::runtime_error);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include "thermal_simulator.hpp"
+#include "test_utils.hpp"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+constexpr double kTarget = 85.0;
+
+RcThermalModel TruePlant() {
+  RcThermalModel plant;
+  plant.ambient_celsius = 30.0;
+  plant.resistance_c_per_watt = 0.8;
+  plant.time_constant_seconds = 8.0;
+  return plant;
+}
+
+PackagePowerModel TruePower() {
+  PackagePowerModel power;
+  power.idle_watts = 10.0;
+  power.dynamic_watts = 70.0;
+  return power;
+}
+
+/**
+ * @brief Трейс без троттлинга: 20 с полной нагрузки / 20 с 20%, шаг 0.5 с
+ *
+ * На полной нагрузке установившаяся температура 94 °C (выше цели).
+ */
+std::vector<ThermalTracePoint> BurstTrace(double duration_seconds) {
+  RcThermalModel plant = TruePlant();
+  PackagePowerModel power = TruePower();
+  std::mt19937 rng(3);
+  std::normal_distribution<double> noise(0.0, 0.05);
+
+  std::vector<ThermalTracePoint> trace;
+  double temperature = 50.0;
+  for (double t = 0.0; t <= duration_seconds; t += 0.5) {
+    double load = std::fmod(t, 40.0) < 20.0 ? 100.0 : 20.0;
+    double watts = power.Power(load, 1.0);
+    if (!trace.empty()) {
+      temperature = plant.Predict(temperature, watts, 0.5);
+    }
+    trace.push_back({t, load, temperature + noise(rng), watts});
+  }
+  return trace;
+}
+
+}  // namespace
+
+// ============================================================================
+// Регуляторы
+// ============================================================================
+
+TEST(ThermalControllerTest, FactoryKnowsAllControllers) {
+  EXPECT_STREQ(MakeThermalController("linear")->Name(), "linear");
+  EXPECT_STREQ(MakeThermalController("pid")->Name(), "pid");
+  EXPECT_STREQ(MakeThermalController("mpc")->Name(), "mpc");
+  EXPECT_THROW(MakeThermalController("bang-bang"), std::invalid_argument);
+}
+
+TEST(ThermalControllerTest, LinearMatchesLegacyThrottle) {
+  LinearThrottleController controller;
+  EXPECT_DOUBLE_EQ(controller.Update({70.0, 50.0, 0.1}, kTarget), 1.0);
+  EXPECT_DOUBLE_EQ(controller.Update({100.0, 50.0, 0.1}, kTarget), 0.85);
+  EXPECT_DOUBLE_EQ(controller.Update({std::nan(""), 50.0, 0.1}, kTarget), 1.0);
+}
+
+TEST(ThermalControllerTest, PidThrottlesBeforeTargetWhenHeatingUp) {
+  PidThermalController controller;
+  EXPECT_DOUBLE_EQ(controller.Update({70.0, 50.0, 0.5}, kTarget), 1.0);
+
+  // Быстрый рост к цели: потолок снижается ещё до 85 °C
+  double scale = 1.0;
+  for (double t = 78.0; t <= 84.0; t += 1.0) {
+    scale = controller.Update({t, 80.0, 0.5}, kTarget);
+  }
+  EXPECT_LT(scale, 1.0);
+}
+
+TEST(ThermalControllerTest, PidRecoversWithoutWindup) {
+  PidThermalController controller;
+  for (int i = 0; i < 200; ++i) {
+    controller.Update({100.0, 80.0, 0.5}, kTarget);
+  }
+  EXPECT_NEAR(controller.Update({100.0, 80.0, 0.5}, kTarget), PidThermalConfig().min_scale,
+              1e-9);
+
+  // После остывания потолок возвращается за считанные шаги
+  double scale = 0.0;
+  for (int i = 0; i < 40; ++i) {
+    scale = controller.Update({60.0, 20.0, 0.5}, kTarget);
+  }
+  EXPECT_DOUBLE_EQ(scale, 1.0);
+}
+
+TEST(ThermalControllerTest, MpcAnticipatesPredictedViolation) {
+  MpcThermalConfig config;
+  config.idle_power_watts = 10.0;
+  config.dynamic_power_watts = 70.0;
+  MpcThermalController controller(TruePlant(), config);
+
+  // 80 °C и полная мощность ведут к 94 °C - снижаем заранее
+  EXPECT_LT(controller.Update({80.0, 80.0, 0.5}, kTarget), 1.0);
+
+  // Холодный пакет с запасом - без ограничения
+  MpcThermalController cool(TruePlant(), config);
+  EXPECT_DOUBLE_EQ(cool.Update({45.0, 20.0, 0.5}, kTarget), 1.0);
+}
+
+// ============================================================================
+// RC модель
+// ============================================================================
+
+TEST(RcThermalModelTest, PredictConvergesToSteadyState) {
+  RcThermalModel plant = TruePlant();
+  EXPECT_NEAR(plant.Predict(50.0, 50.0, 1000.0), 70.0, 1e-9);
+  EXPECT_NEAR(plant.Predict(50.0, 50.0, 8.0), 70.0 - 20.0 * std::exp(-1.0), 1e-9);
+}
+
+TEST(RcThermalModelTest, FitRecoversPlantFromTrace) {
+  RcThermalModel fitted;
+  ASSERT_TRUE(RcThermalModel::Fit(BurstTrace(300.0), fitted));
+  EXPECT_NEAR(fitted.ambient_celsius, 30.0, 1.0);
+  EXPECT_NEAR(fitted.resistance_c_per_watt, 0.8, 0.03);
+  EXPECT_NEAR(fitted.time_constant_seconds, 8.0, 0.5);
+
+  // Постоянная мощность не определяет R и T_amb по отдельности
+  std::vector<ThermalTracePoint> flat(64, ThermalTracePoint{0.0, 50.0, 60.0, 40.0});
+  for (size_t i = 0; i < flat.size(); ++i) {
+    flat[i].time_seconds = i * 0.5;
+  }
+  EXPECT_FALSE(RcThermalModel::Fit(flat, fitted));
+}
+
+TEST(RcThermalModelTest, MpcLearnsPlantOnline) {
+  MpcThermalConfig config;
+  config.refit_interval = 16;
+  MpcThermalController controller(RcThermalModel(), config);
+
+  std::vector<ThermalTracePoint> trace = BurstTrace(200.0);
+  for (size_t i = 1; i < trace.size(); ++i) {
+    controller.Update({trace[i].temperature_celsius, trace[i].power_watts, 0.5}, 200.0);
+  }
+  EXPECT_NEAR(controller.GetModel().resistance_c_per_watt, 0.8, 0.05);
+  EXPECT_NEAR(controller.GetModel().time_constant_seconds, 8.0, 1.0);
+}
+
+// ============================================================================
+// Офлайн-симуляция
+// ============================================================================
+
+TEST(ThermalSimulatorTest, PredictiveControllersBeatLinearThrottle) {
+  std::vector<ThermalTracePoint> trace = BurstTrace(600.0);
+  ThermalSimulator simulator = ThermalSimulator::FromTrace(trace);
+  EXPECT_NEAR(simulator.GetPowerModel().dynamic_watts, 70.0, 1.0);
+
+  ThermalScore scores[3];
+  const char* names[3] = {"linear", "pid", "mpc"};
+  for (int i = 0; i < 3; ++i) {
+    auto controller = MakeThermalController(names[i]);
+    scores[i] = simulator.Run(*controller, trace, kTarget);
+    std::cout << names[i] << ": overshoot " << scores[i].max_overshoot_celsius
+              << " C, over " << scores[i].overshoot_integral << " C*s, oscillation "
+              << scores[i].oscillation << "/s, reversals " << scores[i].reversals
+              << ", lost " << scores[i].lost_performance * 100.0 << "%\n";
+  }
+
+  const ThermalScore& linear = scores[0];
+  for (int i = 1; i < 3; ++i) {
+    EXPECT_LT(scores[i].overshoot_integral, linear.overshoot_integral) << names[i];
+    EXPECT_LT(scores[i].max_overshoot_celsius, linear.max_overshoot_celsius) << names[i];
+    EXPECT_LT(scores[i].lost_performance, 0.25) << names[i];
+  }
+}
+
+TEST(ThermalSimulatorTest, LoadsGovernorDecisionLog) {
+  TempDir dir;
+  std::string path = dir.WriteFile("governor.csv",
+      "tick,timestamp_us,cpu,load_percent,temperature_c,package_power_w,"
+      "current_mhz,target_mhz,applied\n"
+      "1,1000000,0,50,60,30,0,2500,1\n"
+      "1,1000000,1,100,70,40,0,4000,1\n"
+      "# dropped 3 decisions (log overflow)\n"
+      "2,1500000,0,0,61,31,2500,1000,1\n"
+      "2,1500000,1,100,71,41,4000,4000,0\n");
+
+  std::vector<ThermalTracePoint> all = ThermalSimulator::LoadGovernorLog(path);
+  ASSERT_EQ(all.size(), 2u);
+  EXPECT_DOUBLE_EQ(all[0].load_percent, 75.0);
+  EXPECT_DOUBLE_EQ(all[1].time_seconds, 0.5);
+  EXPECT_DOUBLE_EQ(all[1].power_watts, 31.0);
+
+  std::vector<ThermalTracePoint> cpu1 = ThermalSimulator::LoadGovernorLog(path, {1});
+  ASSERT_EQ(cpu1.size(), 2u);
+  EXPECT_DOUBLE_EQ(cpu1[1].load_percent, 100.0);
+  EXPECT_DOUBLE_EQ(cpu1[1].temperature_celsius, 71.0);
+
+  EXPECT_THROW(ThermalSimulator::LoadGovernorLog(dir.path() + "/missing.csv"),
+               std::runtime_error);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "transition_benchmark.hpp"
+#include "test_utils.hpp"
+#include <chrono>
+#include <string>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+/**
+ * @brief Измеритель, видящий записанную в фейковый scaling_setspeed частоту
+ *        с задержкой в delay_samples выборок
+ */
+class DelayedSysfsProbe : public EffectiveFrequencyProbe {
+ public:
+  DelayedSysfsProbe(const TempDir& dir, int cpu_id, size_t delay_samples, bool converge)
+      : dir_(dir), cpu_id_(cpu_id), delay_samples_(delay_samples), converge_(converge),
+        current_mhz_(0.0), pending_mhz_(0.0), samples_since_change_(0) {}
+
+  void Calibrate(uint64_t known_mhz) override { calibrated_mhz_ = known_mhz; }
+
+  double SampleMhz() override {
+    // Окно выборки ~10 мкс
+    auto started = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - started < std::chrono::microseconds(10)) {
+    }
+
+    std::string value = dir_.ReadFile("cpu/cpu" + std::to_string(cpu_id_) +
+                                      "/cpufreq/scaling_setspeed");
+    double written = value.empty() ? 0.0 : std::stoull(value) / 1000.0;
+    if (written != pending_mhz_) {
+      pending_mhz_ = written;
+      samples_since_change_ = 0;
+    }
+    if (++samples_since_change_ > delay_samples_ && converge_) {
+      current_mhz_ = pending_mhz_;
+    }
+    return current_mhz_;
+  }
+
+  const char* Name() const override { return "fake"; }
+
+  static uint64_t calibrated_mhz_;
+
+ private:
+  const TempDir& dir_;
+  int cpu_id_;
+  size_t delay_samples_;
+  bool converge_;
+  double current_mhz_;
+  double pending_mhz_;
+  size_t samples_since_change_;
+};
+
+uint64_t DelayedSysfsProbe::calibrated_mhz_ = 0;
+
+/**
+ * @brief Измеритель, застрявший на одной частоте
+ */
+class StuckProbe : public EffectiveFrequencyProbe {
+ public:
+  explicit StuckProbe(double mhz) : mhz_(mhz) {}
+
+  void Calibrate(uint64_t) override {}
+  double SampleMhz() override { return mhz_; }
+  const char* Name() const override { return "stuck"; }
+
+ private:
+  double mhz_;
+};
+
+class TransitionBenchmarkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (int cpu = 0; cpu < 2; ++cpu) {
+      dir_.WriteFile("cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_setspeed", "");
+    }
+    engine_.SetSysfsCpuRoot(dir_.path() + "/cpu");
+  }
+
+  TransitionBenchmarkConfig Config() const {
+    TransitionBenchmarkConfig config;
+    config.cpus = {0};
+    config.frequencies_mhz = {1200, 2400, 3600};
+    config.repetitions = 4;
+    config.stable_samples = 3;
+    config.settle_us = 200;
+    config.timeout_us = 1000000;  // С запасом на вытеснение под нагрузкой
+    return config;
+  }
+
+  ProbeFactory Probes(size_t delay_samples, bool converge = true) {
+    return [this, delay_samples, converge](int cpu_id) {
+      return std::make_unique<DelayedSysfsProbe>(dir_, cpu_id, delay_samples, converge);
+    };
+  }
+
+  TempDir dir_;
+  OptimizationEngine engine_;
+};
+
+}  // namespace
+
+// ============================================================================
+// Измерение переходов
+// ============================================================================
+
+TEST_F(TransitionBenchmarkTest, MeasuresEveryOrderedPair) {
+  TransitionBenchmark benchmark(engine_, Probes(5), Config());
+  std::vector<TransitionResult> results = benchmark.Run();
+
+  ASSERT_EQ(results.size(), 6u);
+  EXPECT_EQ(DelayedSysfsProbe::calibrated_mhz_, 3600u);
+  for (const auto& result : results) {
+    EXPECT_NE(result.from_mhz, result.to_mhz);
+    EXPECT_EQ(result.timeouts, 0u);
+    EXPECT_EQ(result.latency_us.count, 4u);
+    EXPECT_GT(result.latency_us.min, 0.0);
+    EXPECT_LE(result.latency_us.p50, result.latency_us.max);
+    if (testing_utils::PerfAssertionsEnabled()) {
+      // Частота видна не раньше 5 выборок по ~10 мкс
+      EXPECT_GE(result.latency_us.min, 40.0);
+    }
+  }
+}
+
+TEST_F(TransitionBenchmarkTest, LongerDelayGivesLongerLatency) {
+  std::vector<TransitionResult> fast = TransitionBenchmark(engine_, Probes(2), Config()).Run();
+  std::vector<TransitionResult> slow = TransitionBenchmark(engine_, Probes(40), Config()).Run();
+  ASSERT_EQ(fast.size(), slow.size());
+  EXPECT_GT(slow[0].latency_us.p50, fast[0].latency_us.p50);
+}
+
+TEST_F(TransitionBenchmarkTest, CountsTimeouts) {
+  TransitionBenchmarkConfig config = Config();
+  config.frequencies_mhz = {1200, 2400};
+  config.timeout_us = 500;
+  std::vector<TransitionResult> results =
+      TransitionBenchmark(engine_, Probes(0, false), config).Run();
+
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[0].timeouts, 4u);
+  EXPECT_EQ(results[0].latency_us.count, 0u);
+}
+
+TEST_F(TransitionBenchmarkTest, DropsRepetitionsThatDidNotSettle) {
+  TransitionBenchmarkConfig config = Config();
+  config.frequencies_mhz = {1200, 2400};
+  config.timeout_us = 500;
+  ProbeFactory stuck = [](int) { return std::make_unique<StuckProbe>(2400.0); };
+  std::vector<TransitionResult> results = TransitionBenchmark(engine_, stuck, config).Run();
+
+  // 1200 -> 2400: исходная 1200 не установилась, уже стоящая 2400 не считается переходом
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(results[0].from_mhz, 1200u);
+  EXPECT_EQ(results[0].timeouts, 4u);
+  EXPECT_EQ(results[0].latency_us.count, 0u);
+}
+
+TEST_F(TransitionBenchmarkTest, NeedsTwoFrequencies) {
+  TransitionBenchmarkConfig config = Config();
+  config.frequencies_mhz = {2400};
+  EXPECT_TRUE(TransitionBenchmark(engine_, Probes(0), config).Run().empty());
+}
+
+// ============================================================================
+// Профиль и измерители
+// ============================================================================
+
+TEST_F(TransitionBenchmarkTest, StoresResultsInProfile) {
+  std::vector<TransitionResult> results = TransitionBenchmark(engine_, Probes(5), Config()).Run();
+  MachineProfile profile("test-cpu");
+  TransitionBenchmark::StoreInProfile(results, profile);
+
+  EXPECT_TRUE(profile.Has("frequency_transition.cpu0.1200-3600"));
+  EXPECT_EQ(profile.Get<size_t>("frequency_transition.cpu0.3600-2400.count", 0), 4u);
+  EXPECT_EQ(profile.Get<size_t>("frequency_transition.summary_p99_us.count", 0), 6u);
+  EXPECT_GE(profile.Get<uint64_t>("frequency_transition.min_governor_interval_ms", 0), 1u);
+}
+
+TEST(FrequencyProbeTest, SpinLoopTracksCalibratedFrequency) {
+  SpinLoopProbe probe(2000);
+  probe.Calibrate(3000);
+  double mhz = probe.SampleMhz();
+  EXPECT_GT(mhz, 0.0);
+  if (testing_utils::PerfAssertionsEnabled()) {
+    // Без смены частоты измерение остаётся около калибровочного
+    EXPECT_GT(mhz, 3000 * 0.5);
+    EXPECT_LT(mhz, 3000 * 1.5);
+  }
+}
+
+TEST(FrequencyProbeTest, DefaultProbesFallBackWithoutMsr) {
+  TempDir dir;
+  ProbeFactory factory = TransitionBenchmark::DefaultProbes(dir.path() + "/no-msr", 20);
+  std::unique_ptr<EffectiveFrequencyProbe> probe = factory(0);
+  ASSERT_NE(probe, nullptr);
+  EXPECT_STREQ(probe->Name(), "spin-loop");
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
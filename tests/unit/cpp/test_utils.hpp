@@ -0,0 +1,203 @@
+#ifndef TEST_UTILS_HPP
+#define TEST_UTILS_HPP
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace hardware_analysis {
+namespace testing_utils {
+
+/**
+ * @brief Включены ли пороги времени и пропускной способности
+ *
+ * Они зависят от загрузки машины и проверяются только в отдельных записях
+ * ctest с меткой perf (последовательно, HARDWARE_ANALYSIS_PERF_TESTS=1).
+ */
+inline bool PerfAssertionsEnabled() {
+  const char* value = std::getenv("HARDWARE_ANALYSIS_PERF_TESTS");
+  return value != nullptr && std::string(value) == "1";
+}
+
+/**
+ * @brief Временный каталог для фейковых sysfs/procfs деревьев
+ *
+ * Удаляется вместе с содержимым в деструкторе.
+ */
+class TempDir {
+ public:
+  TempDir() {
+    char pattern[] = "/tmp/hardware_analysis_test_XXXXXX";
+    if (mkdtemp(pattern) == nullptr) {
+      throw std::runtime_error("mkdtemp failed");
+    }
+    path_ = pattern;
+  }
+
+  ~TempDir() {
+    std::string cmd = "rm -rf '" + path_ + "'";
+    if (std::system(cmd.c_str()) != 0) {
+      // Мусор в /tmp не должен ронять тесты
+    }
+  }
+
+  TempDir(const TempDir&) = delete;
+  TempDir& operator=(const TempDir&) = delete;
+
+  const std::string& path() const { return path_; }
+
+  /**
+   * @brief Запись файла с созданием промежуточных каталогов
+   * @param relative_path Путь относительно корня
+   * @param content Содержимое
+   * @return Полный путь
+   */
+  std::string WriteFile(const std::string& relative_path,
+                        const std::string& content) const {
+    std::string full_path = path_ + "/" + relative_path;
+    std::string dir = full_path.substr(0, full_path.rfind('/'));
+    std::string cmd = "mkdir -p '" + dir + "'";
+    if (std::system(cmd.c_str()) != 0) {
+      throw std::runtime_error("mkdir failed: " + dir);
+    }
+
+    std::ofstream file(full_path, std::ios::trunc);
+    file << content;
+    return full_path;
+  }
+
+  /**
+   * @brief Запись 64-битного значения по смещению (фейковый /dev/cpu/N/msr)
+   * @param relative_path Путь к файлу msr
+   * @param msr_addr Адрес регистра = смещение в файле
+   * @param value Значение
+   */
+  void WriteMsr(const std::string& relative_path, uint32_t msr_addr,
+                uint64_t value) const {
+    std::string full_path = path_ + "/" + relative_path;
+    if (access(full_path.c_str(), F_OK) != 0) {
+      WriteFile(relative_path, "");
+    }
+    int fd = open(full_path.c_str(), O_WRONLY);
+    if (fd < 0 || pwrite(fd, &value, sizeof(value), msr_addr) != sizeof(value)) {
+      throw std::runtime_error("Failed to write fake MSR " + full_path);
+    }
+    close(fd);
+  }
+
+  /**
+   * @brief Чтение 64-битного значения по смещению (фейковый /dev/cpu/N/msr)
+   */
+  uint64_t ReadMsr(const std::string& relative_path, uint32_t msr_addr) const {
+    std::string full_path = path_ + "/" + relative_path;
+    uint64_t value = 0;
+    int fd = open(full_path.c_str(), O_RDONLY);
+    if (fd < 0 || pread(fd, &value, sizeof(value), msr_addr) != sizeof(value)) {
+      throw std::runtime_error("Failed to read fake MSR " + full_path);
+    }
+    close(fd);
+    return value;
+  }
+
+  /**
+   * @brief Чтение файла целиком
+   */
+  std::string ReadFile(const std::string& relative_path) const {
+    std::ifstream file(path_ + "/" + relative_path);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  }
+
+ private:
+  std::string path_;
+};
+
+/**
+ * @brief Фейковые procfs и page_idle для обхода страниц процесса
+ *
+ * proc/<pid>/{maps,pagemap,clear_refs} и page_idle в TempDir. Обращение
+ * процесса имитируется сбросом бита idle страницы. page_idle здесь обычный
+ * файл и перезаписывается словом целиком, а ядро игнорирует нулевые биты.
+ */
+class FakeProcfs {
+ public:
+  static constexpr uint64_t kPresent = 1ull << 63;
+  static constexpr uint64_t kSoftDirty = 1ull << 55;
+
+  /**
+   * @param maps Содержимое /proc/<pid>/maps
+   * @param bitmap_words Размер page_idle в 64-битных словах
+   */
+  FakeProcfs(pid_t pid, const std::string& maps, size_t bitmap_words) : pid_(pid) {
+    dir_.WriteFile(ProcessFile("maps"), maps);
+    dir_.WriteFile(ProcessFile("clear_refs"), "");
+    dir_.WriteFile(ProcessFile("pagemap"), "");
+    dir_.WriteFile("page_idle", std::string(bitmap_words * 8, '\0'));
+  }
+
+  pid_t pid() const { return pid_; }
+  const TempDir& dir() const { return dir_; }
+  std::string ProcRoot() const { return dir_.path() + "/proc"; }
+  std::string IdleBitmap() const { return dir_.path() + "/page_idle"; }
+
+  /**
+   * @brief Запись pagemap для виртуального адреса
+   */
+  void SetEntry(uint64_t address, uint64_t entry) {
+    WriteWord(ProcessFile("pagemap"), address / 4096 * 8, entry);
+  }
+
+  /**
+   * @brief Резидентная страница: адрес -> PFN
+   */
+  void MapPage(uint64_t address, uint64_t pfn) { SetEntry(address, kPresent | pfn); }
+
+  uint64_t IdleWord(uint64_t pfn) const {
+    std::ifstream file(IdleBitmap(), std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(pfn / 64 * 8));
+    uint64_t word = 0;
+    file.read(reinterpret_cast<char*>(&word), sizeof(word));
+    return word;
+  }
+
+  void SetIdleWord(uint64_t pfn, uint64_t word) { WriteWord("page_idle", pfn / 64 * 8, word); }
+
+  /**
+   * @brief Обращение процесса: ядро сбрасывает бит idle страницы
+   */
+  void Touch(uint64_t pfn) { SetIdleWord(pfn, IdleWord(pfn) & ~(1ull << (pfn % 64))); }
+
+  std::string ClearRefs() const { return dir_.ReadFile(ProcessFile("clear_refs")); }
+
+  /**
+   * @brief Завершение процесса: maps исчезает
+   */
+  void Exit() { std::remove((dir_.path() + "/" + ProcessFile("maps")).c_str()); }
+
+ private:
+  std::string ProcessFile(const std::string& name) const {
+    return "proc/" + std::to_string(pid_) + "/" + name;
+  }
+
+  void WriteWord(const std::string& relative_path, uint64_t offset, uint64_t value) {
+    std::fstream file(dir_.path() + "/" + relative_path,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  TempDir dir_;
+  pid_t pid_;
+};
+
+}  // namespace testing_utils
+}  // namespace hardware_analysis
+
+#endif  // TEST_UTILS_HPP
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "synthetic_workloads.hpp"
+#include "workload_classifier.hpp"
+#include "test_utils.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::TempDir;
+
+namespace {
+
+PhaseFeatures Counters(double ipc, double llc_mpki, double stall_ratio = NAN) {
+  PhaseFeatures features = PhaseFeatures::Unknown();
+  features.instructions_per_second = 2e9;
+  features.ipc = ipc;
+  features.llc_mpki = llc_mpki;
+  features.stall_ratio = stall_ratio;
+  return features;
+}
+
+PhaseFeatures Bandwidth(double gbs) {
+  PhaseFeatures features = PhaseFeatures::Unknown();
+  features.bandwidth_gbs = gbs;
+  return features;
+}
+
+}  // namespace
+
+// ============================================================================
+// Классификация
+// ============================================================================
+
+TEST(WorkloadClassifierTest, ClassifiesByStallRatioFirst) {
+  WorkloadClassifier classifier;
+  // Доля ожидания важнее IPC/MPKI
+  EXPECT_EQ(classifier.Classify(Counters(2.0, 0.5, 0.7)), WorkloadPhase::kMemory);
+  EXPECT_EQ(classifier.Classify(Counters(0.5, 30.0, 0.1)), WorkloadPhase::kCompute);
+  EXPECT_EQ(classifier.Classify(Counters(1.0, 5.0, 0.35)), WorkloadPhase::kMixed);
+}
+
+TEST(WorkloadClassifierTest, ClassifiesByIpcAndMpki) {
+  WorkloadClassifier classifier;
+  EXPECT_EQ(classifier.Classify(Counters(2.5, 0.2)), WorkloadPhase::kCompute);
+  EXPECT_EQ(classifier.Classify(Counters(1.5, 15.0)), WorkloadPhase::kMemory);
+  EXPECT_EQ(classifier.Classify(Counters(0.4, 4.0)), WorkloadPhase::kMemory);
+  EXPECT_EQ(classifier.Classify(Counters(1.5, 4.0)), WorkloadPhase::kMixed);
+}
+
+TEST(WorkloadClassifierTest, ClassifiesByBandwidthProxy) {
+  WorkloadClassifier classifier;
+  EXPECT_EQ(classifier.Classify(Bandwidth(8.0)), WorkloadPhase::kMemory);
+  EXPECT_EQ(classifier.Classify(Bandwidth(2.0)), WorkloadPhase::kMixed);
+  EXPECT_EQ(classifier.Classify(Bandwidth(0.2)), WorkloadPhase::kCompute);
+  // Без данных частота не ограничивается
+  EXPECT_EQ(classifier.Classify(PhaseFeatures::Unknown()), WorkloadPhase::kCompute);
+}
+
+TEST(WorkloadClassifierTest, DetectsIdle) {
+  WorkloadClassifier classifier;
+  PhaseFeatures idle = Counters(0.3, 40.0);
+  idle.instructions_per_second = 1e6;
+  EXPECT_EQ(classifier.Classify(idle), WorkloadPhase::kIdle);
+}
+
+// ============================================================================
+// Потолок частоты
+// ============================================================================
+
+TEST(WorkloadClassifierTest, CapsOnlyMemoryPhase) {
+  WorkloadClassifier classifier;
+  PhaseFeatures features = Counters(0.3, 25.0);
+  EXPECT_DOUBLE_EQ(classifier.FrequencyScale(WorkloadPhase::kCompute, features), 1.0);
+  EXPECT_DOUBLE_EQ(classifier.FrequencyScale(WorkloadPhase::kMixed, features), 1.0);
+  // Без stall: b = memory_sensitivity = 0.3 -> 0.3 / 0.4
+  EXPECT_DOUBLE_EQ(classifier.FrequencyScale(WorkloadPhase::kMemory, features), 0.75);
+
+  // stall 0.8 -> b = 0.2 -> 0.2 / 0.3
+  features.stall_ratio = 0.8;
+  EXPECT_NEAR(classifier.FrequencyScale(WorkloadPhase::kMemory, features), 2.0 / 3.0, 1e-12);
+
+  // Почти полностью в ожидании - не ниже min_scale
+  features.stall_ratio = 0.99;
+  EXPECT_DOUBLE_EQ(classifier.FrequencyScale(WorkloadPhase::kMemory, features), 0.5);
+}
+
+TEST(WorkloadClassifierTest, HysteresisDelaysPhaseChange) {
+  WorkloadClassifierConfig config;
+  config.stable_samples = 3;
+  WorkloadClassifier classifier(config);
+  PhaseFeatures memory = Counters(0.3, 25.0);
+  PhaseFeatures compute = Counters(2.5, 0.1);
+
+  EXPECT_DOUBLE_EQ(classifier.Update(0, memory), 1.0);
+  EXPECT_DOUBLE_EQ(classifier.Update(0, memory), 1.0);
+  // Одиночный выброс сбрасывает счётчик
+  classifier.Update(0, compute);
+  classifier.Update(0, memory);
+  classifier.Update(0, memory);
+  EXPECT_EQ(classifier.GetPhase(0), WorkloadPhase::kCompute);
+  EXPECT_DOUBLE_EQ(classifier.Update(0, memory), 0.75);
+  EXPECT_EQ(classifier.GetPhase(0), WorkloadPhase::kMemory);
+
+  // CPU независимы
+  EXPECT_EQ(classifier.GetPhase(5), WorkloadPhase::kCompute);
+}
+
+// ============================================================================
+// Источники признаков
+// ============================================================================
+
+TEST(ResctrlBandwidthSourceTest, SplitsDomainBandwidthAcrossCpus) {
+  TempDir dir;
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    dir.WriteFile("sys/cpu/cpu" + std::to_string(cpu) + "/cache/index3/id",
+                  std::to_string(cpu / 2) + "\n");
+  }
+  dir.WriteFile("resctrl/mon_data/mon_L3_00/mbm_total_bytes", "1000\n");
+  dir.WriteFile("resctrl/mon_data/mon_L3_01/mbm_total_bytes", "5000\n");
+
+  ResctrlBandwidthSource source(dir.path() + "/resctrl", dir.path() + "/sys/cpu",
+                                {0, 1, 2, 3});
+  EXPECT_STREQ(source.Name(), "resctrl-mbm");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  dir.WriteFile("resctrl/mon_data/mon_L3_00/mbm_total_bytes", "4000000001000\n");
+  dir.WriteFile("resctrl/mon_data/mon_L3_01/mbm_total_bytes", "5000\n");
+
+  std::vector<PhaseFeatures> features(4, PhaseFeatures::Unknown());
+  ASSERT_TRUE(source.Sample(features));
+  EXPECT_GT(features[0].bandwidth_gbs, 0.0);
+  EXPECT_DOUBLE_EQ(features[0].bandwidth_gbs, features[1].bandwidth_gbs);
+  EXPECT_DOUBLE_EQ(features[2].bandwidth_gbs, 0.0);
+  EXPECT_TRUE(std::isnan(features[0].ipc));
+}
+
+TEST(ResctrlBandwidthSourceTest, ThrowsWithoutMbm) {
+  TempDir dir;
+  dir.WriteFile("sys/cpu/cpu0/cache/index3/id", "0\n");
+  EXPECT_THROW(ResctrlBandwidthSource(dir.path() + "/resctrl", dir.path() + "/sys/cpu", {0}),
+               std::runtime_error);
+}
+
+TEST(PerfEventCounterSourceTest, SeparatesSyntheticWorkloads) {
+  std::unique_ptr<PerfEventCounterSource> source;
+  try {
+    source = std::make_unique<PerfEventCounterSource>(std::vector<int>{0}, 0);
+  } catch (const std::runtime_error& e) {
+    GTEST_SKIP() << e.what();
+  }
+
+  std::vector<PhaseFeatures> features(1, PhaseFeatures::Unknown());
+  source->Sample(features);
+  synthetic::RunCompute(0.2);
+  ASSERT_TRUE(source->Sample(features));
+  PhaseFeatures compute = features[0];
+  synthetic::RunStream(0.3);
+  ASSERT_TRUE(source->Sample(features));
+  PhaseFeatures stream = features[0];
+
+  EXPECT_GT(compute.instructions_per_second, 0.0);
+  EXPECT_GT(compute.ipc, stream.ipc);
+
+  WorkloadClassifier classifier;
+  EXPECT_EQ(classifier.Classify(compute), WorkloadPhase::kCompute);
+  EXPECT_DOUBLE_EQ(classifier.FrequencyScale(WorkloadPhase::kCompute, compute), 1.0);
+
+  // Упор stream в память зависит от LLC и DRAM машины: проверяется под меткой perf
+  if (testing_utils::PerfAssertionsEnabled()) {
+    WorkloadPhase phase = classifier.Classify(stream);
+    EXPECT_TRUE(phase == WorkloadPhase::kMemory || phase == WorkloadPhase::kMixed)
+        << "stream: ipc " << stream.ipc << ", mpki " << stream.llc_mpki << ", stall "
+        << stream.stall_ratio;
+    if (phase == WorkloadPhase::kMemory) {
+      EXPECT_LT(classifier.FrequencyScale(phase, stream), 1.0);
+    }
+  }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "test_utils.hpp"
+#include "wss_estimator.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace hardware_analysis;
+using hardware_analysis::testing_utils::FakeProcfs;
+
+namespace {
+
+/**
+ * @brief Фейковый процесс: 8 анонимных страниц с 0x40000
+ *
+ * Страница i - PFN 10 + 64 * i, по одной на слово page_idle: отметки одного
+ * прохода не затирают слово, отмеченное другим.
+ */
+class FakeProcess : public FakeProcfs {
+ public:
+  static constexpr pid_t kPid = 88;
+  static constexpr uint64_t kBase = 0x40000;
+
+  FakeProcess() : FakeProcfs(kPid, "00040000-00048000 rw-p 00000000 00:00 0 \n", 8) {
+    for (uint64_t i = 0; i < 8; ++i) {
+      MapPage(kBase + i * 4096, Pfn(i));
+    }
+  }
+
+  PageScanConfig Config() const {
+    PageScanConfig config;
+    config.proc_root = ProcRoot();
+    config.page_idle_bitmap = IdleBitmap();
+    return config;
+  }
+
+  /**
+   * @brief Обращение к страницам [first, first + count)
+   */
+  void TouchPages(uint64_t first, uint64_t count) {
+    for (uint64_t page = first; page < first + count; ++page) {
+      Touch(Pfn(page));
+    }
+  }
+
+ private:
+  static uint64_t Pfn(uint64_t page) { return 10 + 64 * page; }
+};
+
+}  // namespace
+
+TEST(WssEstimatorTest, CountsPagesTouchedPerWindow) {
+  FakeProcess process;
+  WorkingSetEstimator estimator(FakeProcess::kPid, process.Config());
+  WssSample sample;
+  EXPECT_FALSE(estimator.Sample(sample));   // Первый цикл отмечает страницы
+  EXPECT_TRUE(estimator.history().empty());
+
+  process.TouchPages(0, 3);
+  ASSERT_TRUE(estimator.Sample(sample));
+  EXPECT_EQ(sample.pid, FakeProcess::kPid);
+  EXPECT_EQ(sample.accessed_pages, 3u);
+  EXPECT_EQ(sample.present_pages, 8u);
+  EXPECT_EQ(sample.WssBytes(), 3u * 4096);
+  EXPECT_EQ(sample.RssBytes(), 8u * 4096);
+
+  process.TouchPages(2, 6);
+  ASSERT_TRUE(estimator.Sample(sample));
+  EXPECT_EQ(sample.accessed_pages, 6u);
+  ASSERT_TRUE(estimator.Sample(sample));
+  EXPECT_EQ(sample.accessed_pages, 0u);
+  EXPECT_EQ(estimator.history().size(), 3u);
+}
+
+TEST(WssEstimatorTest, WindowSpansBudgetedScans) {
+  FakeProcess process;
+  PageScanConfig config = process.Config();
+  config.max_pages_per_scan = 3;
+  WorkingSetEstimator estimator(FakeProcess::kPid, config);
+  WssSample sample;
+  for (int scan = 0; scan < 3; ++scan) {
+    EXPECT_FALSE(estimator.Sample(sample));
+  }
+
+  process.TouchPages(1, 1);
+  process.TouchPages(7, 1);
+  EXPECT_FALSE(estimator.Sample(sample));
+  EXPECT_FALSE(estimator.Sample(sample));
+  ASSERT_TRUE(estimator.Sample(sample));
+  EXPECT_EQ(sample.accessed_pages, 2u);
+  EXPECT_EQ(sample.present_pages, 8u);
+}
+
+TEST(WssEstimatorTest, KeepsBoundedHistoryAndWritesCsv) {
+  FakeProcess process;
+  WorkingSetEstimator estimator(FakeProcess::kPid, process.Config(), 2);
+  WssSample sample;
+  estimator.Sample(sample);
+  for (uint64_t pages = 1; pages <= 3; ++pages) {
+    process.TouchPages(0, pages);
+    ASSERT_TRUE(estimator.Sample(sample));
+  }
+  ASSERT_EQ(estimator.history().size(), 2u);
+  EXPECT_EQ(estimator.history().front().accessed_pages, 2u);
+
+  std::ostringstream csv;
+  estimator.WriteCsv(csv);
+  std::string text = csv.str();
+  EXPECT_EQ(text.rfind("pid,time_s,window_s,wss_bytes,rss_bytes\n", 0), 0u);
+  EXPECT_NE(text.find(",12288,32768\n"), std::string::npos);
+}
+
+TEST(WssEstimatorTest, StopsWhenProcessExits) {
+  FakeProcess process;
+  WorkingSetEstimator estimator(FakeProcess::kPid, process.Config());
+  WssSample sample;
+  estimator.Sample(sample);
+  EXPECT_TRUE(estimator.alive());
+  process.Exit();
+  EXPECT_FALSE(estimator.Sample(sample));
+  EXPECT_FALSE(estimator.alive());
+  EXPECT_THROW(WorkingSetEstimator(4321, process.Config()), std::runtime_error);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}